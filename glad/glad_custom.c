@@ -24,6 +24,18 @@ static void load_Desktop_GL(GLADloadproc load) {
     {
         GLAD_GL_ANGLE_base_vertex_base_instance_shader_builtin = 1;
     }
+
+    if (GLAD_IS_GL_VERSION_AT_LEAST(3, 3)) {
+        // ARB_timer_query is core in 3.3. (Desktop GL has no GL_GPU_DISJOINT_EXT query.)
+        GLAD_GL_EXT_disjoint_timer_query = 1;
+        glad_glGetQueryObjectui64vEXT = (PFNGLGETQUERYOBJECTUI64VEXTPROC)load("glGetQueryObjectui64v");
+    }
+
+    if (GLAD_IS_GL_VERSION_AT_LEAST(4, 4)) {
+        // ARB_buffer_storage is core in 4.4.
+        GLAD_GL_EXT_buffer_storage = 1;
+        glad_glBufferStorageEXT = (PFNGLBUFFERSTORAGEEXTPROC)load("glBufferStorage");
+    }
 }
 
 PFNGLFRAMEBUFFERMEMORYLESSPIXELLOCALSTORAGEANGLEPROC glad_glFramebufferMemorylessPixelLocalStorageANGLE = NULL;
@@ -38,9 +50,12 @@ PFNGLGETFRAMEBUFFERPIXELLOCALSTORAGEPARAMETERFVANGLEPROC glad_glGetFramebufferPi
 PFNGLGETFRAMEBUFFERPIXELLOCALSTORAGEPARAMETERIVANGLEPROC glad_glGetFramebufferPixelLocalStorageParameterivANGLE = NULL;
 PFNGLPOLYGONMODEANGLEPROC glad_glPolygonModeANGLE = NULL;
 PFNGLPROVOKINGVERTEXANGLEPROC glad_glProvokingVertexANGLE = NULL;
+PFNGLMULTIDRAWELEMENTSINSTANCEDANGLEPROC glad_glMultiDrawElementsInstancedANGLE = NULL;
 PFNGLGETTEXTUREHANDLEARB glad_glGetTextureHandleARB = NULL;
 PFNGLMAKETEXTUREHANDLERESIDENTARB glad_glMakeTextureHandleResidentARB = NULL;
 PFNGLMAKETEXTUREHANDLENONRESIDENTARB glad_glMakeTextureHandleNonResidentARB = NULL;
+PFNGLGETQUERYOBJECTUI64VEXTPROC glad_glGetQueryObjectui64vEXT = NULL;
+PFNGLBUFFERSTORAGEEXTPROC glad_glBufferStorageEXT = NULL;
 /* #ifdef RIVE_DESKTOP_GL */
 /* #endif */
 int GLAD_GL_ANGLE_base_vertex_base_instance_shader_builtin = 0;
@@ -48,7 +63,10 @@ int GLAD_GL_ANGLE_shader_pixel_local_storage = 0;
 int GLAD_GL_ANGLE_shader_pixel_local_storage_coherent = 0;
 int GLAD_GL_ANGLE_polygon_mode = 0;
 int GLAD_GL_ANGLE_provoking_vertex = 0;
+int GLAD_GL_ANGLE_multi_draw = 0;
 int GLAD_GL_ARB_bindless_texture = 0;
+int GLAD_GL_EXT_disjoint_timer_query = 0;
+int GLAD_GL_EXT_buffer_storage = 0;
 static void load_GL_ANGLE_shader_pixel_local_storage(GLADloadproc load) {
     if(!GLAD_GL_ANGLE_shader_pixel_local_storage) return;
     glad_glFramebufferMemorylessPixelLocalStorageANGLE = (PFNGLFRAMEBUFFERMEMORYLESSPIXELLOCALSTORAGEANGLEPROC)load("glFramebufferMemorylessPixelLocalStorageANGLE");
@@ -70,12 +88,25 @@ static void load_GL_ANGLE_provoking_vertex(GLADloadproc load) {
     if(!GLAD_GL_ANGLE_provoking_vertex) return;
     glad_glProvokingVertexANGLE = (PFNGLPROVOKINGVERTEXANGLEPROC)load("glProvokingVertexANGLE");
 }
+static void load_GL_ANGLE_multi_draw(GLADloadproc load) {
+    if(!GLAD_GL_ANGLE_multi_draw) return;
+    glad_glMultiDrawElementsInstancedANGLE = (PFNGLMULTIDRAWELEMENTSINSTANCEDANGLEPROC)load("glMultiDrawElementsInstancedANGLE");
+}
 static void load_GL_ARB_bindless_texture(GLADloadproc load) {
     if(!GLAD_GL_ARB_bindless_texture) return;
     glad_glGetTextureHandleARB = (PFNGLGETTEXTUREHANDLEARB)load("glGetTextureHandleARB");
     glad_glMakeTextureHandleResidentARB = (PFNGLMAKETEXTUREHANDLERESIDENTARB)load("glMakeTextureHandleResidentARB");
     glad_glMakeTextureHandleNonResidentARB = (PFNGLMAKETEXTUREHANDLENONRESIDENTARB)load("glMakeTextureHandleNonResidentARB");
 }
+static void load_GL_EXT_disjoint_timer_query(GLADloadproc load) {
+    if(!GLAD_GL_EXT_disjoint_timer_query || glad_glGetQueryObjectui64vEXT != NULL) return;
+    glad_glGetQueryObjectui64vEXT = (PFNGLGETQUERYOBJECTUI64VEXTPROC)load("glGetQueryObjectui64vEXT");
+}
+static void load_GL_EXT_buffer_storage(GLADloadproc load) {
+    if(!GLAD_GL_EXT_buffer_storage || glad_glBufferStorageEXT != NULL) return;
+    glad_glBufferStorageEXT = (PFNGLBUFFERSTORAGEEXTPROC)load(
+        GLAD_GL_version_es ? "glBufferStorageEXT" : "glBufferStorage");
+}
 int gladLoadCustomLoader(GLADloadproc load) {
     int ret = gladLoadGLES2Loader(load);
 
@@ -123,15 +154,31 @@ int gladLoadCustomLoader(GLADloadproc load) {
         {
             GLAD_GL_ANGLE_provoking_vertex = 1;
         }
+        else if (strcmp(ext, "GL_ANGLE_multi_draw") == 0)
+        {
+            GLAD_GL_ANGLE_multi_draw = 1;
+        }
         else if (strcmp(ext, "GL_ARB_bindless_texture") == 0)
         {
             GLAD_GL_ARB_bindless_texture = 1;
         }
+        else if (strcmp(ext, "GL_EXT_disjoint_timer_query") == 0)
+        {
+            GLAD_GL_EXT_disjoint_timer_query = 1;
+        }
+        else if (strcmp(ext, "GL_EXT_buffer_storage") == 0 ||
+                 strcmp(ext, "GL_ARB_buffer_storage") == 0)
+        {
+            GLAD_GL_EXT_buffer_storage = 1;
+        }
     }
     load_GL_ANGLE_shader_pixel_local_storage(load);
     load_GL_ANGLE_polygon_mode(load);
     load_GL_ANGLE_provoking_vertex(load);
+    load_GL_ANGLE_multi_draw(load);
     load_Desktop_GL(load);
     load_GL_ARB_bindless_texture(load);
+    load_GL_EXT_disjoint_timer_query(load);
+    load_GL_EXT_buffer_storage(load);
     return ret;
 }
@@ -95,6 +95,14 @@ GLAPI PFNGLPROVOKINGVERTEXANGLEPROC glad_glProvokingVertexANGLE;
 #define glProvokingVertexANGLE glad_glProvokingVertexANGLE
 #endif  /* GL_ANGLE_provoking_vertex */
 
+#ifndef GL_ANGLE_multi_draw
+#define GL_ANGLE_multi_draw 1
+GLAPI int GLAD_GL_ANGLE_multi_draw;
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINSTANCEDANGLEPROC) (GLenum mode, const GLsizei* counts, GLenum type, const GLvoid* const* indices, const GLsizei* instanceCounts, GLsizei drawcount);
+GLAPI PFNGLMULTIDRAWELEMENTSINSTANCEDANGLEPROC glad_glMultiDrawElementsInstancedANGLE;
+#define glMultiDrawElementsInstancedANGLE glad_glMultiDrawElementsInstancedANGLE
+#endif  /* GL_ANGLE_multi_draw */
+
 #ifndef GL_ARB_bindless_texture
 #define GL_ARB_bindless_texture 1
 GLAPI int GLAD_GL_ARB_bindless_texture;
@@ -109,6 +117,28 @@ GLAPI PFNGLMAKETEXTUREHANDLENONRESIDENTARB glad_glMakeTextureHandleNonResidentAR
 #define glMakeTextureHandleNonResidentARB glad_glMakeTextureHandleNonResidentARB
 #endif  /* GL_ARB_bindless_texture */
 
+#ifndef GL_EXT_disjoint_timer_query
+#define GL_EXT_disjoint_timer_query 1
+#define GL_TIME_ELAPSED_EXT 0x88BF
+#define GL_GPU_DISJOINT_EXT 0x8FBB
+GLAPI int GLAD_GL_EXT_disjoint_timer_query;
+typedef void (APIENTRYP PFNGLGETQUERYOBJECTUI64VEXTPROC) (GLuint id, GLenum pname, GLuint64* params);
+GLAPI PFNGLGETQUERYOBJECTUI64VEXTPROC glad_glGetQueryObjectui64vEXT;
+#define glGetQueryObjectui64vEXT glad_glGetQueryObjectui64vEXT
+#endif  /* GL_EXT_disjoint_timer_query */
+
+#ifndef GL_EXT_buffer_storage
+#define GL_EXT_buffer_storage 1
+#define GL_MAP_PERSISTENT_BIT_EXT 0x0040
+#define GL_MAP_COHERENT_BIT_EXT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT_EXT 0x0100
+#define GL_CLIENT_STORAGE_BIT_EXT 0x0200
+GLAPI int GLAD_GL_EXT_buffer_storage;
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEEXTPROC) (GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+GLAPI PFNGLBUFFERSTORAGEEXTPROC glad_glBufferStorageEXT;
+#define glBufferStorageEXT glad_glBufferStorageEXT
+#endif  /* GL_EXT_buffer_storage */
+
 #ifdef __cplusplus
 }
 #endif
@@ -20,10 +20,15 @@ namespace rive::pls
 class BufferRing
 {
 public:
-    BufferRing(size_t capacityInBytes) : m_capacityInBytes(capacityInBytes) {}
+    BufferRing(size_t capacityInBytes, int ringSize) :
+        m_capacityInBytes(capacityInBytes), m_ringSize(ringSize)
+    {
+        assert(1 <= m_ringSize && m_ringSize <= kMaxBufferRingSize);
+    }
     virtual ~BufferRing() {}
 
     size_t capacityInBytes() const { return m_capacityInBytes; }
+    int ringSize() const { return m_ringSize; }
     bool isMapped() const { return m_mapSizeInBytes != 0; }
 
     // Maps the next buffer in the ring.
@@ -32,7 +37,7 @@ public:
         assert(!isMapped());
         assert(mapSizeInBytes > 0);
         assert(mapSizeInBytes <= m_capacityInBytes);
-        m_submittedBufferIdx = (m_submittedBufferIdx + 1) % kBufferRingSize;
+        m_submittedBufferIdx = (m_submittedBufferIdx + 1) % m_ringSize;
         m_mapSizeInBytes = mapSizeInBytes;
         return onMapBuffer(m_submittedBufferIdx, m_mapSizeInBytes);
     }
@@ -67,6 +72,7 @@ protected:
 
 private:
     size_t m_capacityInBytes;
+    const int m_ringSize;
     size_t m_mapSizeInBytes = 0;
     int m_submittedBufferIdx = 0;
 
@@ -78,7 +84,7 @@ private:
 class HeapBufferRing : public BufferRing
 {
 public:
-    HeapBufferRing(size_t capacityInBytes) : BufferRing(capacityInBytes) {}
+    HeapBufferRing(size_t capacityInBytes) : BufferRing(capacityInBytes, 1) {}
 
     uint8_t* contents() const { return shadowBuffer(); }
 
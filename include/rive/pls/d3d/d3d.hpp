@@ -0,0 +1,35 @@
+/*
+ * Copyright 2024 Rive
+ */
+
+#pragma once
+
+#include <wrl/client.h>
+
+using Microsoft::WRL::ComPtr;
+
+#define VERIFY_OK(CODE)                                                                            \
+    {                                                                                              \
+        HRESULT hr = (CODE);                                                                       \
+        if (hr != S_OK)                                                                            \
+        {                                                                                          \
+            fprintf(stderr,                                                                        \
+                    __FILE__ ":%i: D3D error 0x%lx: %s\n",                                         \
+                    static_cast<int>(__LINE__),                                                    \
+                    hr,                                                                            \
+                    #CODE);                                                                        \
+            exit(-1);                                                                              \
+        }                                                                                          \
+    }
+
+namespace rive::pls
+{
+// Shader-related capabilities shared by the D3D11 and D3D12 backends.
+struct D3DCapabilities
+{
+    bool supportsRasterizerOrderedViews = false;
+    bool supportsTypedUAVLoadStore = false; // Can we load/store all UAV formats used by Rive?
+    bool supportsMin16Precision = false;    // Can we use minimum 16-bit types (e.g. min16int)?
+    bool isIntel = false;
+};
+} // namespace rive::pls
@@ -0,0 +1,8 @@
+/*
+ * Copyright 2024 Rive
+ */
+
+#pragma once
+
+#include <d3d12.h>
+#include "rive/pls/d3d/d3d.hpp"
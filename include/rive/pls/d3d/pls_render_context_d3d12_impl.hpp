@@ -0,0 +1,396 @@
+/*
+ * Copyright 2024 Rive
+ */
+
+#pragma once
+
+#include "rive/pls/d3d/d3d12.hpp"
+#include "rive/pls/pipeline_blob_cache.hpp"
+#include "rive/pls/pls_render_context_helper_impl.hpp"
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace rive::pls
+{
+class PLSRenderContextD3D12Impl;
+
+// D3D12 backend implementation of PLSRenderTarget.
+//
+// Barriers are explicit on D3D12, so the render target keeps track of the state of each texture it
+// renders to. The target texture begins every flush in its client-specified state, and is returned
+// to that state before the flush ends.
+class PLSRenderTargetD3D12 : public PLSRenderTarget
+{
+public:
+    PLSRenderTargetD3D12(PLSRenderContextD3D12Impl*, uint32_t width, uint32_t height);
+    ~PLSRenderTargetD3D12() override {}
+
+    void setTargetTexture(ComPtr<ID3D12Resource> tex,
+                          D3D12_RESOURCE_STATES clientState = D3D12_RESOURCE_STATE_PRESENT);
+
+    ID3D12Resource* targetTexture() const { return m_targetTexture.Get(); }
+    bool targetTextureSupportsUAV() const { return m_targetTextureSupportsUAV; }
+    D3D12_CPU_DESCRIPTOR_HANDLE targetRTV();
+    DXGI_FORMAT targetRTVFormat() const;
+
+    // Alternate rendering target when targetTextureSupportsUAV() is false.
+    ID3D12Resource* offscreenTexture();
+
+    // Non-shader-visible descriptors of the PLS planes, indexed by COLOR_PLANE_IDX, etc. (Usable
+    // as the CPU handle of ClearUnorderedAccessView*(), and as a source for CopyDescriptors().)
+    //
+    // The color plane is a UAV of targetTexture(), if targetTextureSupportsUAV() is true,
+    // otherwise it is a UAV of offscreenTexture().
+    D3D12_CPU_DESCRIPTOR_HANDLE targetUAV();
+    D3D12_CPU_DESCRIPTOR_HANDLE coverageUAV();
+    D3D12_CPU_DESCRIPTOR_HANDLE clipUAV();
+    D3D12_CPU_DESCRIPTOR_HANDLE scratchColorUAV();
+
+    // Valid once the corresponding UAV has been requested.
+    ID3D12Resource* coverageTexture() const { return m_coverageTexture.Get(); }
+    ID3D12Resource* clipTexture() const { return m_clipTexture.Get(); }
+
+    // Records a barrier that transitions the target (or offscreen) texture to 'state', if it isn't
+    // in that state already.
+    void transitionTargetTexture(ID3D12GraphicsCommandList*, D3D12_RESOURCE_STATES);
+    void transitionOffscreenTexture(ID3D12GraphicsCommandList*, D3D12_RESOURCE_STATES);
+    void restoreTargetTextureClientState(ID3D12GraphicsCommandList* cmdList)
+    {
+        transitionTargetTexture(cmdList, m_targetClientState);
+    }
+
+    // Calls 'fn' on every texture the render target owns or references, so the caller can keep
+    // them alive until the GPU is done with them.
+    template <typename Fn> void forEachTexture(Fn&& fn) const
+    {
+        for (const ComPtr<ID3D12Resource>& tex : {m_targetTexture,
+                                                   m_offscreenTexture,
+                                                   m_coverageTexture,
+                                                   m_clipTexture,
+                                                   m_scratchColorTexture})
+        {
+            if (tex != nullptr)
+            {
+                fn(tex.Get());
+            }
+        }
+    }
+
+private:
+    D3D12_CPU_DESCRIPTOR_HANDLE uavHandle(int planeIdx) const;
+
+    const ComPtr<ID3D12Device> m_gpu;
+    const bool m_gpuSupportsTypedUAVLoadStore;
+
+    ComPtr<ID3D12Resource> m_targetTexture;
+    bool m_targetTextureSupportsUAV = false;
+    DXGI_FORMAT m_targetFormat = DXGI_FORMAT_UNKNOWN;
+    D3D12_RESOURCE_STATES m_targetClientState = D3D12_RESOURCE_STATE_PRESENT;
+    D3D12_RESOURCE_STATES m_targetState = D3D12_RESOURCE_STATE_PRESENT;
+
+    ComPtr<ID3D12Resource> m_offscreenTexture;
+    D3D12_RESOURCE_STATES m_offscreenState = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+    ComPtr<ID3D12Resource> m_coverageTexture;
+    ComPtr<ID3D12Resource> m_scratchColorTexture;
+    ComPtr<ID3D12Resource> m_clipTexture;
+
+    ComPtr<ID3D12DescriptorHeap> m_rtvHeap;
+    bool m_targetRTVIsValid = false;
+    ComPtr<ID3D12DescriptorHeap> m_uavHeap; // Non-shader-visible. One UAV per PLS plane.
+    UINT m_uavDescriptorSize;
+    bool m_uavIsValid[4] = {};
+};
+
+// CommandBufferCompletionFence that signals once an ID3D12Fence reaches a specific value.
+class D3D12FrameFence : public CommandBufferCompletionFence
+{
+public:
+    D3D12FrameFence(ComPtr<ID3D12Fence> fence, uint64_t value) :
+        m_fence(std::move(fence)), m_value(value)
+    {}
+
+    ID3D12Fence* d3dFence() const { return m_fence.Get(); }
+    uint64_t value() const { return m_value; }
+
+    void wait() override;
+
+private:
+    const ComPtr<ID3D12Fence> m_fence;
+    const uint64_t m_value;
+};
+
+// D3D12 backend implementation of PLSRenderContextImpl.
+//
+// Every mappable buffer lives in a persistently-mapped upload heap, and every resource transition
+// is an explicit barrier. Flushes are recorded into the client's command list
+// (FlushResources::externalCommandBuffer) if there is one, otherwise into command lists owned by
+// the context, which it submits to its queue at the end of the frame.
+class PLSRenderContextD3D12Impl : public PLSRenderContextHelperImpl
+{
+public:
+    struct ContextOptions
+    {
+        bool disableRasterizerOrderedViews = false; // Primarily for testing.
+        bool disableTypedUAVLoadStore = false;      // Primarily for testing.
+        // If non-null, compiled shader bytecode is saved here and reloaded on subsequent runs
+        // instead of being recompiled. The cache must outlive the context.
+        PipelineBlobCache* pipelineBlobCache = nullptr;
+        // How many frames the CPU can prepare ahead of the GPU. Clamped to [kMinBufferRingSize,
+        // kMaxBufferRingSize].
+        int bufferRingSize = pls::kBufferRingSize;
+        // Number of background threads (in addition to the calling thread) that record large draw
+        // passes into separate command lists in parallel. Only used when the context records into
+        // its own command lists (i.e., FlushResources::externalCommandBuffer is null).
+        uint32_t parallelRecordingThreadCount = 0;
+    };
+
+    // 'queue' is where the context submits its own command lists. Clients that always provide
+    // FlushResources::externalCommandBuffer (an ID3D12GraphicsCommandList) may pass null, but must
+    // then also provide a FlushResources::frameCompletionFence (see makeFrameFence()).
+    static std::unique_ptr<PLSRenderContext> MakeContext(ComPtr<ID3D12Device>,
+                                                         ComPtr<ID3D12CommandQueue>,
+                                                         const ContextOptions&);
+
+    ~PLSRenderContextD3D12Impl() override;
+
+    rcp<PLSRenderTargetD3D12> makeRenderTarget(uint32_t width, uint32_t height)
+    {
+        return make_rcp<PLSRenderTargetD3D12>(this, width, height);
+    }
+
+    // Reserves the next value on the context's frame fence. Clients that record into their own
+    // command lists signal fence->value() on fence->d3dFence() after submitting a frame, and pass
+    // the fence as FlushResources::frameCompletionFence.
+    rcp<D3D12FrameFence> makeFrameFence();
+
+    const D3DCapabilities& d3dCapabilities() const { return m_d3dCapabilities; }
+    ID3D12Device* gpu() const { return m_gpu.Get(); }
+
+    // D3D12 helpers
+    ComPtr<ID3D12Resource> makeSimple2DTexture(DXGI_FORMAT,
+                                               UINT width,
+                                               UINT height,
+                                               UINT mipLevelCount,
+                                               D3D12_RESOURCE_FLAGS,
+                                               D3D12_RESOURCE_STATES initialState);
+    ComPtr<ID3D12Resource> makeUploadBuffer(size_t sizeInBytes);
+    // Creates a buffer in the default heap, whose contents get copied over from 'data' at the
+    // beginning of the next flush.
+    ComPtr<ID3D12Resource> makeSimpleImmutableBuffer(size_t sizeInBytes,
+                                                     const void* data,
+                                                     D3D12_RESOURCE_STATES finalState);
+
+    // Copies the contents of 'staging' into 'dst' at the beginning of the next flush, then
+    // transitions 'dst' from D3D12_RESOURCE_STATE_COPY_DEST to 'finalState'. If 'dst' is a texture,
+    // 'staging' must be laid out according to ID3D12Device::GetCopyableFootprints().
+    void queueUpload(ComPtr<ID3D12Resource> dst,
+                     ComPtr<ID3D12Resource> staging,
+                     D3D12_RESOURCE_STATES finalState);
+
+    // Keeps 'resource' alive until the GPU finishes the frame currently being recorded.
+    void retainUntilFrameCompletes(ComPtr<ID3D12Pageable> resource)
+    {
+        m_inFlightResources[std::max(m_bufferRingIdx, 0)].push_back(std::move(resource));
+    }
+
+private:
+    PLSRenderContextD3D12Impl(ComPtr<ID3D12Device>,
+                              ComPtr<ID3D12CommandQueue>,
+                              const D3DCapabilities&,
+                              const ContextOptions&);
+
+    rcp<RenderBuffer> makeRenderBuffer(RenderBufferType, RenderBufferFlags, size_t) override;
+
+    rcp<PLSTexture> makeImageTexture(uint32_t width,
+                                     uint32_t height,
+                                     uint32_t mipLevelCount,
+                                     const uint8_t imageDataRGBA[]) override;
+
+    std::unique_ptr<BufferRing> makeUniformBufferRing(size_t capacityInBytes) override;
+    std::unique_ptr<BufferRing> makeStorageBufferRing(size_t capacityInBytes,
+                                                      pls::StorageBufferStructure) override;
+    std::unique_ptr<BufferRing> makeVertexBufferRing(size_t capacityInBytes) override;
+    std::unique_ptr<BufferRing> makeTextureTransferBufferRing(size_t capacityInBytes) override;
+
+    void resizeGradientTexture(uint32_t width, uint32_t height) override;
+    void resizeTessellationTexture(uint32_t width, uint32_t height) override;
+
+    void prepareToMapBuffers() override;
+
+    void flush(const FlushDescriptor&) override;
+
+    void precompileShaders(Span<const pls::ShaderVariant>) override;
+
+    // Records a flush into 'cmdList'. Returns the command list that subsequent commands of the
+    // frame should be recorded into. (This differs from 'cmdList' when the draw pass was recorded
+    // into separate command lists in parallel.)
+    ID3D12GraphicsCommandList* recordFlush(const FlushDescriptor&, ID3D12GraphicsCommandList*);
+
+    // Records and clears the uploads requested by queueUpload().
+    void recordPendingUploads(ID3D12GraphicsCommandList*);
+
+    // Allocates 'count' contiguous descriptors from this frame's shader-visible CBV/SRV/UAV heap.
+    // May replace the heap with a larger one, which the caller must then bind via
+    // SetDescriptorHeaps().
+    struct DescriptorRange
+    {
+        D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle;
+        D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle;
+    };
+    DescriptorRange allocateDescriptors(UINT count);
+    ID3D12DescriptorHeap* currentDescriptorHeap() const
+    {
+        return m_descriptorHeaps[m_bufferRingIdx].heap.Get();
+    }
+
+    // Allocates persistently-mapped upload memory that lives until the current frame completes.
+    struct UploadAllocation
+    {
+        ID3D12Resource* buffer;
+        size_t offset;
+        void* data;
+    };
+    UploadAllocation allocateUploadMemory(size_t sizeInBytes, size_t alignment);
+
+    // Everything the draw pass needs bound to a command list. Parallel command lists each bind it
+    // themselves.
+    struct DrawPassState
+    {
+        const FlushDescriptor* desc;
+        PLSRenderTargetD3D12* renderTarget;
+        D3D12_CPU_DESCRIPTOR_HANDLE targetRTV;
+        bool renderDirectToRasterPipeline;
+        bool renderPassHasCoalescedResolveAndTransfer;
+        D3D12_GPU_DESCRIPTOR_HANDLE resourceTextureTable; // tess & grad textures.
+        D3D12_GPU_DESCRIPTOR_HANDLE nullImageTextureTable;
+        D3D12_GPU_DESCRIPTOR_HANDLE plsUAVTable;
+        D3D12_GPU_DESCRIPTOR_HANDLE resolveUAVTable; // (renderPassHasCoalescedResolveAndTransfer.)
+    };
+    // Binds the root signature, descriptor heap, flush uniforms, and storage buffers.
+    void bindFlushResources(ID3D12GraphicsCommandList*, const FlushDescriptor&);
+    // Binds everything else the draw pass needs.
+    void bindDrawPassState(ID3D12GraphicsCommandList*, const DrawPassState&);
+
+    // A DrawBatch whose pipeline and image texture descriptor have already been resolved, so it can
+    // be recorded on any thread.
+    struct ResolvedDrawBatch
+    {
+        const DrawBatch* batch;
+        ID3D12PipelineState* pipeline;
+        D3D12_GPU_DESCRIPTOR_HANDLE imageTextureTable;
+    };
+    void recordDrawBatches(ID3D12GraphicsCommandList*,
+                           const DrawPassState&,
+                           const ResolvedDrawBatch* begin,
+                           const ResolvedDrawBatch* end) const;
+
+    struct DrawPipelineOptions
+    {
+        DXGI_FORMAT renderTargetFormat; // DXGI_FORMAT_UNKNOWN if there is no render target.
+        bool srcOverBlend;
+        bool wireframe;
+    };
+
+    // Compiles the draw shaders for the given configuration, if they haven't been already.
+    std::pair<ID3DBlob*, ID3DBlob*> findOrCompileDrawShaders(
+        DrawType,
+        pls::ShaderFeatures,
+        pls::InterlockMode,
+        pls::ShaderMiscFlags pixelShaderMiscFlags);
+
+    ID3D12PipelineState* findOrCreateDrawPipeline(DrawType,
+                                                  pls::ShaderFeatures,
+                                                  pls::InterlockMode,
+                                                  pls::ShaderMiscFlags pixelShaderMiscFlags,
+                                                  const DrawPipelineOptions&);
+
+    ComPtr<ID3DBlob> compileSourceToBlob(const char* shaderTypeDefineName,
+                                         const std::string& commonSource,
+                                         const char* entrypoint,
+                                         const char* target);
+
+    const D3DCapabilities m_d3dCapabilities;
+    const ContextOptions m_contextOptions;
+
+    ComPtr<ID3D12Device> m_gpu;
+    ComPtr<ID3D12CommandQueue> m_queue;
+    UINT m_cbvSrvUavDescriptorSize;
+    UINT m_rtvDescriptorSize;
+
+    ComPtr<ID3D12RootSignature> m_rootSignature;
+
+    ComPtr<ID3D12Resource> m_gradTexture;
+    D3D12_RESOURCE_STATES m_gradTextureState;
+    ComPtr<ID3D12Resource> m_tessTexture;
+    D3D12_RESOURCE_STATES m_tessTextureState;
+    ComPtr<ID3D12DescriptorHeap> m_resourceTextureRTVHeap; // [gradTexture, tessTexture]
+
+    ComPtr<ID3D12PipelineState> m_colorRampPipeline;
+    ComPtr<ID3D12PipelineState> m_tessellatePipeline;
+    ComPtr<ID3D12Resource> m_tessSpanIndexBuffer;
+
+    std::map<uint32_t, ComPtr<ID3DBlob>> m_drawVertexShaders;
+    std::map<uint32_t, ComPtr<ID3DBlob>> m_drawPixelShaders;
+    std::map<uint64_t, ComPtr<ID3D12PipelineState>> m_drawPipelines;
+
+    // Vertex/index buffers for drawing path patches.
+    ComPtr<ID3D12Resource> m_patchVertexBuffer;
+    ComPtr<ID3D12Resource> m_patchIndexBuffer;
+
+    // Vertex/index buffers for drawing image rects. (pls::InterlockMode::atomics only.)
+    ComPtr<ID3D12Resource> m_imageRectVertexBuffer;
+    ComPtr<ID3D12Resource> m_imageRectIndexBuffer;
+
+    struct PendingUpload
+    {
+        ComPtr<ID3D12Resource> dst;
+        ComPtr<ID3D12Resource> staging;
+        D3D12_RESOURCE_STATES finalState;
+    };
+    std::vector<PendingUpload> m_pendingUploads;
+
+    // One shader-visible CBV/SRV/UAV heap per buffer ring slot, linearly allocated from during the
+    // frame and rewound once the slot's previous frame has finished.
+    struct DescriptorHeap
+    {
+        ComPtr<ID3D12DescriptorHeap> heap;
+        UINT capacity = 0;
+        UINT count = 0;
+    };
+    DescriptorHeap m_descriptorHeaps[pls::kMaxBufferRingSize];
+
+    struct UploadArena
+    {
+        ComPtr<ID3D12Resource> buffer;
+        uint8_t* mappedMemory = nullptr;
+        size_t capacity = 0;
+        size_t used = 0;
+    };
+    UploadArena m_uploadArenas[pls::kMaxBufferRingSize];
+
+    // Resources referenced by the frame in each ring slot, released once it completes.
+    std::vector<ComPtr<ID3D12Pageable>> m_inFlightResources[pls::kMaxBufferRingSize];
+
+    ComPtr<ID3D12Fence> m_frameFence;
+    uint64_t m_lastReservedFenceValue = 0;
+    rcp<pls::CommandBufferCompletionFence> m_frameCompletionFences[pls::kMaxBufferRingSize];
+
+    // Command lists owned by the context, for frames that don't provide an externalCommandBuffer.
+    class CommandListPool;
+    class ParallelCommandRecorder;
+    std::unique_ptr<CommandListPool> m_commandListPool;
+    ID3D12GraphicsCommandList* m_internalCommandList = nullptr; // Open while recording a frame.
+    std::vector<ID3D12CommandList*> m_pendingCommandLists;      // Submitted at the end of a frame.
+
+    // Non-null if ContextOptions::parallelRecordingThreadCount is nonzero.
+    std::unique_ptr<ParallelCommandRecorder> m_parallelCommandRecorder;
+
+    // Reused from flush to flush to avoid reallocating.
+    std::vector<ResolvedDrawBatch> m_resolvedDrawBatches;
+
+    int m_bufferRingIdx = -1;
+};
+} // namespace rive::pls
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "rive/pls/d3d/d3d11.hpp"
+#include "rive/pls/pipeline_blob_cache.hpp"
 #include "rive/pls/pls_render_context_helper_impl.hpp"
 #include <map>
 #include <string>
@@ -66,6 +67,12 @@ public:
         bool disableRasterizerOrderedViews = false; // Primarily for testing.
         bool disableTypedUAVLoadStore = false;      // Primarily for testing.
         bool isIntel = false;
+        // If non-null, compiled shader bytecode is saved here and reloaded on subsequent runs
+        // instead of being recompiled. The cache must outlive the context.
+        PipelineBlobCache* pipelineBlobCache = nullptr;
+        // How many frames the CPU can prepare ahead of the GPU. Clamped to [kMinBufferRingSize,
+        // kMaxBufferRingSize].
+        int bufferRingSize = pls::kBufferRingSize;
     };
 
     static std::unique_ptr<PLSRenderContext> MakeContext(ComPtr<ID3D11Device>,
@@ -77,13 +84,7 @@ public:
         return make_rcp<PLSRenderTargetD3D>(this, width, height);
     }
 
-    struct D3DCapabilities
-    {
-        bool supportsRasterizerOrderedViews = false;
-        bool supportsTypedUAVLoadStore = false; // Can we load/store all UAV formats used by Rive?
-        bool supportsMin16Precision = false;    // Can we use minimum 16-bit types (e.g. min16int)?
-        bool isIntel = false;
-    };
+    using D3DCapabilities = pls::D3DCapabilities;
 
     const D3DCapabilities& d3dCapabilities() const { return m_d3dCapabilities; }
     ID3D11Device* gpu() const { return m_gpu.Get(); }
@@ -108,7 +109,8 @@ public:
 private:
     PLSRenderContextD3DImpl(ComPtr<ID3D11Device>,
                             ComPtr<ID3D11DeviceContext>,
-                            const D3DCapabilities&);
+                            const D3DCapabilities&,
+                            PipelineBlobCache*);
 
     rcp<RenderBuffer> makeRenderBuffer(RenderBufferType, RenderBufferFlags, size_t) override;
 
@@ -128,6 +130,8 @@ private:
 
     void flush(const FlushDescriptor&) override;
 
+    void precompileShaders(Span<const pls::ShaderVariant>) override;
+
     template <typename HighLevelStruct>
     ID3D11ShaderResourceView* replaceStructuredBufferSRV(const BufferRing*,
                                                          UINT highLevelStructCount,
@@ -139,6 +143,7 @@ private:
                                      pls::ShaderMiscFlags pixelShaderMiscFlags);
 
     const D3DCapabilities m_d3dCapabilities;
+    PipelineBlobCache* const m_pipelineBlobCache;
 
     ComPtr<ID3D11Device> m_gpu;
     ComPtr<ID3D11DeviceContext> m_gpuContext;
@@ -171,6 +176,13 @@ private:
     std::map<uint32_t, DrawVertexShader> m_drawVertexShaders;
     std::map<uint32_t, ComPtr<ID3D11PixelShader>> m_drawPixelShaders;
 
+    // Compiles the draw shaders for the given configuration, if they haven't been already.
+    std::pair<const DrawVertexShader*, ID3D11PixelShader*> findOrCompileDrawShaders(
+        DrawType,
+        pls::ShaderFeatures,
+        pls::InterlockMode,
+        pls::ShaderMiscFlags pixelShaderMiscFlags);
+
     // Vertex/index buffers for drawing path patches.
     ComPtr<ID3D11Buffer> m_patchVertexBuffer;
     ComPtr<ID3D11Buffer> m_patchIndexBuffer;
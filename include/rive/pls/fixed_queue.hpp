@@ -32,6 +32,7 @@ public:
     }
 
     size_t pushCount() const { return m_end - m_array; }
+    const T* pushedData() const { return m_array; }
 
     T& push_back()
     {
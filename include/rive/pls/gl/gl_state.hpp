@@ -24,15 +24,51 @@ public:
     void setWriteMasks(bool colorWriteMask, bool depthWriteMask, GLuint stencilWriteMask);
     void setCullFace(GLenum);
 
+    void setViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+    void setScissor(GLint x, GLint y, GLsizei width, GLsizei height); // Also enables the test.
+    void disableScissor();
+
     void bindProgram(GLuint);
     void bindVAO(GLuint);
     void bindBuffer(GLenum target, GLuint);
+    // Only tracks GL_UNIFORM_BUFFER and GL_SHADER_STORAGE_BUFFER binding points below
+    // kMaxTrackedBufferBindings. (Also binds 'bufferID' to the generic 'target', as GL does.)
+    void bindBufferRange(GLenum target,
+                         GLuint index,
+                         GLuint bufferID,
+                         GLintptr offset,
+                         GLsizeiptr size);
+    void bindFramebuffer(GLenum target, GLuint);
+    // Makes 'textureUnit' active and binds 'textureID' to its GL_TEXTURE_2D target.
+    void bindTexture(GLenum textureUnit, GLuint textureID);
+    void setActiveTexture(GLenum textureUnit);
 
     void deleteProgram(GLuint);
     void deleteVAO(GLuint);
     void deleteBuffer(GLuint);
+    void deleteTexture(GLuint);
+
+    // Forget the cached framebuffer & texture bindings after code that doesn't go through GLState
+    // (e.g., PLSRenderTargetGL) has modified them.
+    void invalidateFramebufferBindings();
+    void invalidateTextureBindings();
+
+    // Number of GL calls that were elided because the requested state was already current. On
+    // WebGL, each of these would have been a round trip across the JS boundary.
+    uint64_t skippedCallCount() const { return m_skippedCallCount; }
+    void resetSkippedCallCount() { m_skippedCallCount = 0; }
+
+    constexpr static uint32_t kMaxTrackedTextureUnits = 16;
+    constexpr static uint32_t kMaxTrackedBufferBindings = 16;
 
 private:
+    struct BufferRange
+    {
+        GLuint bufferID;
+        GLintptr offset;
+        GLsizeiptr size;
+    };
+
     const GLCapabilities m_capabilities;
     GLenum m_blendEquation;
     bool m_colorWriteMask;
@@ -44,6 +80,16 @@ private:
     GLuint m_boundArrayBufferID;
     GLuint m_boundUniformBufferID;
     GLuint m_boundPixelUnpackBufferID;
+    GLint m_viewport[4];
+    GLint m_scissor[4];
+    bool m_scissorEnabled;
+    GLuint m_boundDrawFramebufferID;
+    GLuint m_boundReadFramebufferID;
+    GLenum m_activeTextureUnit;
+    GLuint m_boundTextureIDs[kMaxTrackedTextureUnits];
+    BufferRange m_uniformBufferRanges[kMaxTrackedBufferBindings];
+    BufferRange m_storageBufferRanges[kMaxTrackedBufferBindings];
+    uint64_t m_skippedCallCount = 0;
 
     struct
     {
@@ -55,6 +101,16 @@ private:
         bool boundArrayBufferID : 1;
         bool boundUniformBufferID : 1;
         bool boundPixelUnpackBufferID : 1;
+        bool viewport : 1;
+        bool scissor : 1;
+        bool scissorEnabled : 1;
+        bool boundDrawFramebufferID : 1;
+        bool boundReadFramebufferID : 1;
+        bool activeTextureUnit : 1;
+        // One bit per texture unit / indexed binding point.
+        uint16_t boundTextureIDs;
+        uint16_t uniformBufferRanges;
+        uint16_t storageBufferRanges;
     } m_validState;
 };
 } // namespace rive::pls
@@ -32,8 +32,14 @@ void CompileAndAttachShader(GLuint program,
 
 [[nodiscard]] GLuint CompileRawGLSL(GLuint shaderType, const char* rawGLSL);
 
+// The GLSL that CompileShader() inserts ahead of every set of sources.
+const char* ShaderPreludeSource();
+
 void LinkProgram(GLuint program);
 
+// Aborts with the info log if the program failed to link. (Debug builds only.)
+void VerifyProgramLinked(GLuint program);
+
 class GLObject
 {
 public:
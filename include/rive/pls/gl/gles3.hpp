@@ -60,6 +60,17 @@ extern void glBeginPixelLocalStorageANGLE(GLsizei n, const GLenum loadops[]);
 extern void glEndPixelLocalStorageANGLE(GLsizei n, const GLenum storeops[]);
 #endif
 
+#ifndef GL_ANGLE_multi_draw
+#define GL_ANGLE_multi_draw 1
+extern bool webgl_enable_WEBGL_multi_draw();
+extern void glMultiDrawElementsInstancedANGLE(GLenum mode,
+                                              const GLsizei* counts,
+                                              GLenum type,
+                                              const GLvoid* const* indices,
+                                              const GLsizei* instanceCounts,
+                                              GLsizei drawcount);
+#endif
+
 #ifndef GL_ANGLE_provoking_vertex
 #define GL_ANGLE_provoking_vertex 1
 #define GL_FIRST_VERTEX_CONVENTION_ANGLE 0x8E4D
@@ -86,6 +97,7 @@ extern void glProvokingVertexANGLE(GLenum provokeMode);
 #define GL_HSL_COLOR_KHR 0x92AF
 #define GL_HSL_LUMINOSITY_KHR 0x92B0
 #define GL_BLEND_ADVANCED_COHERENT_KHR 0x9285
+#define glBlendBarrierKHR(...) RIVE_UNREACHABLE()
 #endif
 
 #ifndef GL_EXT_clip_cull_distance
@@ -105,6 +117,24 @@ extern void glProvokingVertexANGLE(GLenum provokeMode);
 #define GL_MAX_VERTEX_SHADER_STORAGE_BLOCKS 0x90D6
 #endif
 
+#ifndef GL_KHR_parallel_shader_compile
+#define GL_KHR_parallel_shader_compile 1
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+#define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#endif
+
+#ifndef GL_KHR_texture_compression_astc_ldr
+#define GL_KHR_texture_compression_astc_ldr 1
+#define GL_COMPRESSED_RGBA_ASTC_4x4_KHR 0x93B0
+#endif
+
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+
 struct GLCapabilities
 {
     GLCapabilities() { memset(this, 0, sizeof(*this)); }
@@ -119,6 +149,7 @@ struct GLCapabilities
     bool isGLES : 1;
     bool isANGLEOrWebGL : 1;
     bool ANGLE_base_vertex_base_instance_shader_builtin : 1;
+    bool ANGLE_multi_draw : 1; // Also set by WEBGL_multi_draw.
     bool ANGLE_shader_pixel_local_storage : 1;
     bool ANGLE_shader_pixel_local_storage_coherent : 1;
     bool ANGLE_polygon_mode : 1;
@@ -130,13 +161,20 @@ struct GLCapabilities
     bool ARB_shader_storage_buffer_object : 1;
     bool KHR_blend_equation_advanced : 1;
     bool KHR_blend_equation_advanced_coherent : 1;
+    bool KHR_debug : 1;
+    bool KHR_parallel_shader_compile : 1;
+    bool KHR_texture_compression_astc_ldr : 1;
     bool EXT_base_instance : 1;
+    bool EXT_buffer_storage : 1; // Also set by ARB_buffer_storage.
     bool EXT_clip_cull_distance : 1;
+    bool EXT_disjoint_timer_query : 1;
     bool EXT_multisampled_render_to_texture : 1;
     bool EXT_shader_framebuffer_fetch : 1;
     bool EXT_shader_pixel_local_storage : 1;
+    bool EXT_texture_compression_bptc : 1; // Also set by ARB_texture_compression_bptc.
     bool INTEL_fragment_shader_ordering : 1;
     bool QCOM_shader_framebuffer_fetch_noncoherent : 1;
+    bool OES_EGL_image : 1;
 };
 
 #ifdef RIVE_ANDROID
@@ -148,5 +186,21 @@ extern PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXBASEINSTANCEEXTPROC
 extern PFNGLFRAMEBUFFERFETCHBARRIERQCOMPROC glFramebufferFetchBarrierQCOM;
 extern PFNGLFRAMEBUFFERTEXTURE2DMULTISAMPLEEXTPROC glFramebufferTexture2DMultisampleEXT;
 extern PFNGLRENDERBUFFERSTORAGEMULTISAMPLEEXTPROC glRenderbufferStorageMultisampleEXT;
+extern PFNGLGETQUERYOBJECTUI64VEXTPROC glGetQueryObjectui64vEXT;
+extern PFNGLBUFFERSTORAGEEXTPROC glBufferStorageEXT;
+extern PFNGLEGLIMAGETARGETTEXTURE2DOESPROC glEGLImageTargetTexture2DOES;
+extern PFNGLBLENDBARRIERKHRPROC glBlendBarrierKHR;
+extern PFNGLPUSHDEBUGGROUPKHRPROC glPushDebugGroupKHR;
+extern PFNGLPOPDEBUGGROUPKHRPROC glPopDebugGroupKHR;
+#ifndef GL_ANGLE_multi_draw
+#define GL_ANGLE_multi_draw 1
+typedef void(GL_APIENTRYP PFNGLMULTIDRAWELEMENTSINSTANCEDANGLEPROC)(GLenum mode,
+                                                                    const GLsizei* counts,
+                                                                    GLenum type,
+                                                                    const void* const* indices,
+                                                                    const GLsizei* instanceCounts,
+                                                                    GLsizei drawcount);
+#endif
+extern PFNGLMULTIDRAWELEMENTSINSTANCEDANGLEPROC glMultiDrawElementsInstancedANGLE;
 void LoadGLESExtensions(const GLCapabilities&);
 #endif
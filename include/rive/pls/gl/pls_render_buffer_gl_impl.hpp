@@ -17,7 +17,11 @@ class GLState;
 class PLSRenderBufferGLImpl : public lite_rtti_override<RenderBuffer, PLSRenderBufferGLImpl>
 {
 public:
-    PLSRenderBufferGLImpl(RenderBufferType, RenderBufferFlags, size_t, rcp<GLState>);
+    PLSRenderBufferGLImpl(RenderBufferType,
+                          RenderBufferFlags,
+                          size_t,
+                          rcp<GLState>,
+                          int bufferRingSize = pls::kBufferRingSize);
     ~PLSRenderBufferGLImpl();
 
     GLuint submittedBufferID() const { return m_bufferIDs[m_submittedBufferIdx]; }
@@ -25,10 +29,10 @@ public:
 protected:
     PLSRenderBufferGLImpl(RenderBufferType type, RenderBufferFlags flags, size_t sizeInBytes);
 
-    void init(rcp<GLState>);
+    void init(rcp<GLState>, int bufferRingSize = pls::kBufferRingSize);
 
     // Used by the android runtime to marshal buffers off to the GL thread for deletion.
-    std::array<GLuint, pls::kBufferRingSize> detachBuffers();
+    std::array<GLuint, pls::kMaxBufferRingSize> detachBuffers();
 
     void* onMap() override;
     void onUnmap() override;
@@ -36,12 +40,16 @@ protected:
     GLState* state() const { return m_state.get(); }
 
 private:
+    // Allocates the GL buffer for the given slot in the ring.
+    void createBufferAt(int bufferIdx);
+
     // Returns whether glMapBufferRange() is supported for our buffer. If not, we use
     // m_fallbackMappedMemory.
     bool canMapBuffer() const;
 
     const GLenum m_target;
-    std::array<GLuint, pls::kBufferRingSize> m_bufferIDs{};
+    std::array<GLuint, pls::kMaxBufferRingSize> m_bufferIDs{};
+    int m_bufferCount = 0;
     int m_submittedBufferIdx = -1;
     std::unique_ptr<uint8_t[]> m_fallbackMappedMemory; // Used when canMapBuffer() is false.
     rcp<GLState> m_state;
@@ -6,7 +6,9 @@
 
 #include "rive/pls/gl/gl_state.hpp"
 #include "rive/pls/gl/gl_utils.hpp"
+#include "rive/pls/pipeline_blob_cache.hpp"
 #include "rive/pls/pls_render_context_helper_impl.hpp"
+#include <deque>
 #include <map>
 
 namespace rive::pls
@@ -14,6 +16,7 @@ namespace rive::pls
 class PLSPath;
 class PLSPaint;
 class PLSRenderTargetGL;
+class GLFrameSyncs;
 
 // OpenGL backend implementation of PLSRenderContextImpl.
 class PLSRenderContextGLImpl : public PLSRenderContextHelperImpl
@@ -23,6 +26,22 @@ public:
     {
         bool disablePixelLocalStorage = false;
         bool disableFragmentShaderInterlock = false;
+        // By default, buffer rings are allocated with immutable storage and mapped once, for the
+        // lifetime of the buffer, when EXT_buffer_storage (or GL 4.4) is available. Set this to
+        // map them on every flush instead.
+        bool disablePersistentlyMappedBuffers = false;
+        // If non-null, linked draw programs are saved here via glGetProgramBinary() and reloaded
+        // on subsequent runs instead of being recompiled. (Not supported on WebGL.) The cache must
+        // outlive the context.
+        PipelineBlobCache* pipelineBlobCache = nullptr;
+        // When the driver supports KHR_parallel_shader_compile, draw programs compile in the
+        // background while a fully-featured program stands in for them. Set this to block on every
+        // compilation instead. (Primarily for testing.)
+        bool synchronousShaderCompilations = false;
+        // How many frames the CPU can prepare ahead of the GPU. 2 minimizes latency; deeper rings
+        // trade latency for more CPU/GPU overlap. Clamped to [kMinBufferRingSize,
+        // kMaxBufferRingSize].
+        int bufferRingSize = pls::kBufferRingSize;
     };
 
     static std::unique_ptr<PLSRenderContext> MakeContext(const ContextOptions&);
@@ -39,9 +58,23 @@ public:
                                      uint32_t mipLevelCount,
                                      const uint8_t imageDataRGBA[]) override;
 
+    rcp<PLSTexture> makeCompressedImageTexture(uint32_t width,
+                                               uint32_t height,
+                                               uint32_t mipLevelCount,
+                                               pls::CompressedTextureFormat,
+                                               const uint8_t data[]) override;
+
     // Takes ownership of textureID and responsibility for deleting it.
     rcp<PLSTexture> adoptImageTexture(uint32_t width, uint32_t height, GLuint textureID);
 
+    rcp<PLSRenderTarget> makeLayerRenderTarget(uint32_t width,
+                                               uint32_t height,
+                                               rcp<PLSTexture>* layerTexture) override;
+
+    void upscaleLayer(const PLSTexture* layerTexture,
+                      PLSRenderTarget*,
+                      void* externalCommandBuffer) override;
+
     // Called *after* the GL context has been modified externally.
     // Re-binds Rive internal resources and invalidates the internal cache of GL state.
     void invalidateGLState();
@@ -69,6 +102,10 @@ private:
 
         virtual bool supportsRasterOrdering(const GLCapabilities&) const = 0;
 
+        // Are all of this PLSImpl's atomic-mode clears, loads, and resolves restricted by
+        // GL_SCISSOR_TEST? (See FlushDescriptor::isTileBinPass.)
+        virtual bool supportsTileBinnedRendering() const { return false; }
+
         virtual void activatePixelLocalStorage(PLSRenderContextGLImpl*, const FlushDescriptor&) = 0;
         virtual void deactivatePixelLocalStorage(PLSRenderContextGLImpl*,
                                                  const FlushDescriptor&) = 0;
@@ -117,9 +154,13 @@ private:
 
     static std::unique_ptr<PLSRenderContext> MakeContext(const char* rendererString,
                                                          GLCapabilities,
-                                                         std::unique_ptr<PLSImpl>);
+                                                         std::unique_ptr<PLSImpl>,
+                                                         const ContextOptions&);
 
-    PLSRenderContextGLImpl(const char* rendererString, GLCapabilities, std::unique_ptr<PLSImpl>);
+    PLSRenderContextGLImpl(const char* rendererString,
+                           GLCapabilities,
+                           std::unique_ptr<PLSImpl>,
+                           const ContextOptions&);
 
     // Wraps a compiled GL shader of draw_path.glsl or draw_image_mesh.glsl, either vertex or
     // fragment, with a specific set of features enabled via #define. The set of features to enable
@@ -141,6 +182,16 @@ private:
 
         GLuint id() const { return m_id; }
 
+        // Collects the #defines and sources that DrawShader compiles for the given configuration.
+        static void GetSources(PLSRenderContextGLImpl*,
+                               GLenum shaderType,
+                               pls::DrawType,
+                               ShaderFeatures,
+                               pls::InterlockMode,
+                               pls::ShaderMiscFlags,
+                               std::vector<const char*>* defines,
+                               std::vector<const char*>* sources);
+
     private:
         GLuint m_id;
     };
@@ -160,13 +211,32 @@ private:
                     pls::ShaderMiscFlags);
         ~DrawProgram();
 
+        // Returns true once the program has finished compiling and linking, and is fully
+        // initialized. With KHR_parallel_shader_compile, this polls without blocking; otherwise it
+        // always returns true.
+        bool isReady(PLSRenderContextGLImpl*);
+
+        // Blocks until the program has finished compiling and linking, then initializes its
+        // uniforms. Must be called before the program is used for drawing.
+        void finishInitialization(PLSRenderContextGLImpl*);
+
         GLuint id() const { return m_id; }
         GLint spirvCrossBaseInstanceLocation() const { return m_spirvCrossBaseInstanceLocation; }
 
     private:
-        DrawShader m_fragmentShader;
+        // Returns true if the program was successfully loaded from the PipelineBlobCache.
+        bool loadProgramBinary(PLSRenderContextGLImpl*, const std::string& blobKey);
+        void storeProgramBinary(PLSRenderContextGLImpl*, const std::string& blobKey);
+
+        // Null if the program was loaded from a PipelineBlobCache.
+        std::unique_ptr<DrawShader> m_fragmentShader;
         GLuint m_id;
         GLint m_spirvCrossBaseInstanceLocation = -1;
+        const pls::DrawType m_drawType;
+        const pls::ShaderFeatures m_shaderFeatures;
+        const pls::InterlockMode m_interlockMode;
+        bool m_isInitialized = false;
+        std::string m_pendingBlobKey; // Stored to the PipelineBlobCache once linking finishes.
         const rcp<GLState> m_state;
     };
 
@@ -179,12 +249,44 @@ private:
     void resizeGradientTexture(uint32_t width, uint32_t height) override;
     void resizeTessellationTexture(uint32_t width, uint32_t height) override;
 
+    // Compiles and links the tessellation program, reading pls::CompactTessVertexSpans if
+    // 'compactTessVertexSpans' is true.
+    void compileTessellateProgram(glutils::Program*, bool compactTessVertexSpans);
+
+    // Returns the draw program for the given configuration if it's ready. Otherwise, while it's
+    // still compiling in the background, returns a fully-featured program that can stand in for
+    // it.
+    DrawProgram* findCompatibleDrawProgram(pls::DrawType,
+                                           pls::ShaderFeatures,
+                                           pls::InterlockMode,
+                                           pls::ShaderMiscFlags);
+
     void flush(const FlushDescriptor&) override;
 
+    void precompileShaders(Span<const pls::ShaderVariant>) override;
+
+    bool popGPUFrameTime(pls::GPUFrameTime*) override;
+
     GLCapabilities m_capabilities;
+    const bool m_synchronousShaderCompilations;
+
+    // How depthStencil mode reads the destination color for advanced blend modes.
+    enum class MSAAAdvancedBlend : uint8_t
+    {
+        khrCoherent,      // KHR_blend_equation_advanced_coherent.
+        framebufferFetch, // EXT_shader_framebuffer_fetch. Blends in the shader, with no barriers.
+        khrWithBarriers,  // KHR_blend_equation_advanced, with a blend barrier per blend phase.
+        dstColorTexture,  // Blit the framebuffer into a texture before each advanced blend batch.
+    };
+    MSAAAdvancedBlend m_msaaAdvancedBlend;
 
     std::unique_ptr<PLSImpl> m_plsImpl;
 
+    // Persistent storage for draw program binaries, and a hash of the driver and shader prelude
+    // that every blob key is seeded with.
+    PipelineBlobCache* m_pipelineBlobCache;
+    PipelineBlobKeyHash m_driverBlobKeyHash;
+
     // Gradient texture rendering.
     glutils::Program m_colorRampProgram;
     glutils::VAO m_colorRampVAO;
@@ -194,6 +296,9 @@ private:
     // Tessellation texture rendering.
     glutils::Program m_tessellateProgram;
     glutils::VAO m_tessellateVAO;
+    // FlushDescriptor::compactTessVertexSpans. The program gets compiled on first use.
+    glutils::Program m_compactTessellateProgram = glutils::Program::Zero();
+    glutils::VAO m_compactTessellateVAO;
     glutils::Buffer m_tessSpanIndexBuffer;
     glutils::Framebuffer m_tessellateFBO;
     GLuint m_tessVertexTexture = 0;
@@ -201,6 +306,16 @@ private:
     // Not all programs have a unique vertex shader, so we cache and reuse them where possible.
     std::map<uint32_t, DrawShader> m_vertexShaders;
     std::map<uint32_t, DrawProgram> m_drawPrograms;
+    std::vector<DrawProgram*> m_flushDrawPrograms; // The program chosen for each batch in a flush.
+
+    // GL_TIME_ELAPSED queries for frames that requested GPU timing, in submission order.
+    struct PendingGPUTimer
+    {
+        GLuint query;
+        uint64_t frameNumber;
+    };
+    std::deque<PendingGPUTimer> m_pendingGPUTimers;
+    std::vector<GLuint> m_availableGPUTimerQueries;
 
     // Vertex/index buffers for drawing paths.
     glutils::VAO m_drawVAO;
@@ -219,7 +334,12 @@ private:
 
     // Used for blitting non-MSAA -> MSAA, which isn't supported by glBlitFramebuffer().
     glutils::Program m_blitAsDrawProgram = glutils::Program::Zero();
+    // Stretches a layer over a render target, with bilinear filtering. (See upscaleLayer().)
+    glutils::Program m_upscaleAsDrawProgram = glutils::Program::Zero();
 
     const rcp<GLState> m_state;
+
+    // Fences for persistently mapped buffer rings. Null unless EXT_buffer_storage is supported.
+    rcp<GLFrameSyncs> m_frameSyncs;
 };
 } // namespace rive::pls
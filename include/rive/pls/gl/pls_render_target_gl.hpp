@@ -104,6 +104,14 @@ public:
         m_framebufferTargetPLSBindingDirty = true;
     }
 
+#ifdef RIVE_ANDROID
+    // Renders straight into an EGLImage, e.g., one made from an AHardwareBuffer with
+    // eglGetNativeClientBufferANDROID() and eglCreateImageKHR(). We create and own a texture that
+    // aliases the image, but the caller still owns the EGLImage, and must keep it alive until
+    // rendering to it is complete. Pass null to detach. Requires GLCapabilities::OES_EGL_image.
+    void setTargetEGLImage(GLeglImageOES);
+#endif
+
     void bindDestinationFramebuffer(GLenum target) final
     {
         bindInternalFramebuffer(target, DrawBufferMask::color);
@@ -121,6 +129,10 @@ public:
 private:
     // Not owned or deleted by us.
     GLuint m_externalTextureID = 0;
+#ifdef RIVE_ANDROID
+    // Aliases the EGLImage from setTargetEGLImage(), if any.
+    glutils::Texture m_eglImageTexture = glutils::Texture::Zero();
+#endif
 
     glutils::Framebuffer m_framebufferID = glutils::Framebuffer::Zero();
     glutils::Texture m_coverageTexture = glutils::Texture::Zero();
@@ -4,17 +4,22 @@
 
 #pragma once
 
+#include "rive/refcnt.hpp"
+#include "rive/pls/pipeline_blob_cache.hpp"
 #include "rive/pls/pls_render_context_helper_impl.hpp"
+#include <deque>
 #include <map>
 #include <mutex>
 
 #ifndef RIVE_OBJC_NOP
+#import <IOSurface/IOSurfaceRef.h>
 #import <Metal/Metal.h>
 #endif
 
 namespace rive::pls
 {
 class BackgroundShaderCompiler;
+class PLSDeviceMetal;
 
 // Metal backend implementation of PLSRenderTarget.
 class PLSRenderTargetMetal : public PLSRenderTarget
@@ -34,6 +39,23 @@ public:
     void setTargetTexture(id<MTLTexture> texture);
     id<MTLTexture> targetTexture() const { return m_targetTexture; }
 
+    // Renders straight into an IOSurface (e.g., the backing of a CVPixelBuffer from a video
+    // encoder or compositor) instead of copying out of a separate texture. The surface plane must
+    // match this render target's size and pixel format.
+    void setTargetIOSurface(IOSurfaceRef, NSUInteger plane = 0);
+
+    // Explicit synchronization with other devices or processes that share the target. When set,
+    // the first flush of each frame waits for 'event' to reach acquireValue before rendering, and
+    // the final flush signals releaseValue once rendering is complete. Pass nil to disable.
+    void setTargetSharedEvent(id<MTLSharedEvent> event,
+                              uint64_t acquireValue,
+                              uint64_t releaseValue)
+    {
+        m_targetSharedEvent = event;
+        m_targetAcquireValue = acquireValue;
+        m_targetReleaseValue = releaseValue;
+    }
+
 private:
     friend class PLSRenderContextMetalImpl;
 
@@ -67,6 +89,9 @@ private:
     const MTLPixelFormat m_pixelFormat;
 
     id<MTLTexture> m_targetTexture = nil;
+    id<MTLSharedEvent> m_targetSharedEvent = nil;
+    uint64_t m_targetAcquireValue = 0;
+    uint64_t m_targetReleaseValue = 0;
 
     id<MTLTexture> m_coverageMemorylessTexture = nil;
     id<MTLTexture> m_clipMemorylessTexture = nil;
@@ -90,10 +115,26 @@ public:
         // (macOS only -- ignored on iOS). Override m_platformFeatures.supportsRasterOrdering to
         // false, forcing us to always render in atomic mode.
         bool disableFramebufferReads = false;
+
+        // How many frames the CPU can prepare ahead of the GPU. 2 minimizes latency; deeper rings
+        // trade latency for more CPU/GPU overlap. Clamped to [kMinBufferRingSize,
+        // kMaxBufferRingSize].
+        int bufferRingSize = pls::kBufferRingSize;
+
+        // If non-null, draw pipelines are recorded in an MTLBinaryArchive that is seeded from this
+        // cache, and written back out on storeBinaryArchive() and destruction. The cache must
+        // outlive the context. (Ignored before macOS 11 and iOS 14, and for contexts made from a
+        // shared PLSDeviceMetal, which has its own cache.)
+        PipelineBlobCache* pipelineBlobCache = nullptr;
     };
 
     static std::unique_ptr<PLSRenderContext> MakeContext(id<MTLDevice>, const ContextOptions&);
 
+    // Makes a context that shares its shaders, pipelines, and static buffers with every other
+    // context made from the same PLSDeviceMetal.
+    static std::unique_ptr<PLSRenderContext> MakeContext(rcp<PLSDeviceMetal>,
+                                                         const ContextOptions&);
+
     static std::unique_ptr<PLSRenderContext> MakeContext(id<MTLDevice> gpu)
     {
         return MakeContext(gpu, ContextOptions());
@@ -102,6 +143,7 @@ public:
     ~PLSRenderContextMetalImpl() override;
 
     id<MTLDevice> gpu() const { return m_gpu; }
+    PLSDeviceMetal* device() const { return m_device.get(); }
 
     rcp<PLSRenderTargetMetal> makeRenderTarget(MTLPixelFormat, uint32_t width, uint32_t height);
 
@@ -138,8 +180,13 @@ public:
 
     const MetalFeatures& metalFeatures() const { return m_metalFeatures; }
 
+    // Serializes the device's binary archive to its pipelineBlobCache, if any pipelines have been
+    // added to it since it was last stored.
+    void storeBinaryArchive();
+
 protected:
     PLSRenderContextMetalImpl(id<MTLDevice>, const ContextOptions&);
+    PLSRenderContextMetalImpl(rcp<PLSDeviceMetal>, const ContextOptions&);
 
     std::unique_ptr<BufferRing> makeUniformBufferRing(size_t capacityInBytes) override;
     std::unique_ptr<BufferRing> makeStorageBufferRing(size_t capacityInBytes,
@@ -148,6 +195,8 @@ protected:
     std::unique_ptr<BufferRing> makeTextureTransferBufferRing(size_t capacityInBytes) override;
 
 private:
+    friend class PLSDeviceMetal;
+
     // Renders paths to the main render target.
     class DrawPipeline;
 
@@ -174,25 +223,103 @@ private:
 
     void flush(const FlushDescriptor&) override;
 
+    void precompileShaders(Span<const pls::ShaderVariant>) override;
+
+    bool popGPUFrameTime(pls::GPUFrameTime*) override;
+
     const ContextOptions m_contextOptions;
+    const rcp<PLSDeviceMetal> m_device;
     const id<MTLDevice> m_gpu;
 
     MetalFeatures m_metalFeatures;
+
+    class ColorRampPipeline;
+    id<MTLTexture> m_gradientTexture = nullptr;
+
+    class TessellatePipeline;
+    id<MTLTexture> m_tessVertexTexture = nullptr;
+
+    // Locks buffer contents until the GPU has finished rendering with them. Prevents the CPU from
+    // overriding data before the GPU is done with it.
+    std::mutex m_bufferRingLocks[kMaxBufferRingSize];
+    int m_bufferRingIdx = 0;
+
+    // Filled in by command buffer completion handlers, for frames that requested GPU timing.
+    std::deque<pls::GPUFrameTime> m_gpuFrameTimes;
+    std::mutex m_gpuFrameTimesMutex;
+};
+
+// Device-level state that any number of PLSRenderContextMetalImpls on one MTLDevice can share, so
+// that each additional context (e.g., one per window or surface) doesn't compile the same shaders
+// or allocate the same static buffers again. Buffer rings and the gradient and tessellation
+// textures are still per-context. (Image textures are plain MTLTextures, so they can already be
+// drawn by any context on the same device.)
+//
+// Contexts that share a device must not be used from multiple threads at once.
+class PLSDeviceMetal : public RefCnt<PLSDeviceMetal>
+{
+public:
+    // If pipelineBlobCache is non-null, draw pipelines are recorded in an MTLBinaryArchive that is
+    // seeded from it, and written back out on storeBinaryArchive() and destruction. The cache must
+    // outlive the device. (Ignored before macOS 11 and iOS 14.)
+    static rcp<PLSDeviceMetal> Make(id<MTLDevice>, PipelineBlobCache* pipelineBlobCache = nullptr);
+
+    ~PLSDeviceMetal();
+
+    id<MTLDevice> gpu() const { return m_gpu; }
+    const PLSRenderContextMetalImpl::MetalFeatures& metalFeatures() const
+    {
+        return m_metalFeatures;
+    }
+
+    // Serializes the binary archive to the pipelineBlobCache, if any pipelines have been added to
+    // it since it was last stored.
+    void storeBinaryArchive();
+
+private:
+    friend class PLSRenderContextMetalImpl;
+    using DrawPipeline = PLSRenderContextMetalImpl::DrawPipeline;
+    using ColorRampPipeline = PLSRenderContextMetalImpl::ColorRampPipeline;
+    using TessellatePipeline = PLSRenderContextMetalImpl::TessellatePipeline;
+
+    PLSDeviceMetal(id<MTLDevice>, PipelineBlobCache*);
+
+    // Loads the fully-featured draw pipelines for rasterOrdering mode from the precompiled
+    // library, the first time a context that supports raster ordering is created on this device.
+    void loadPrecompiledDrawPipelines();
+
+    // Returns the specific DrawPipeline for the given feature set, if it has been compiled. If it
+    // has not finished compiling yet, this method may return a (potentially slower) DrawPipeline
+    // that can draw a superset of the given features.
+    const DrawPipeline* findCompatibleDrawPipeline(pls::DrawType,
+                                                   pls::ShaderFeatures,
+                                                   pls::InterlockMode,
+                                                   pls::ShaderMiscFlags,
+                                                   bool synchronousShaderCompilations);
+
+    void precompileShaders(Span<const pls::ShaderVariant>);
+
+    const id<MTLDevice> m_gpu;
+    PipelineBlobCache* const m_pipelineBlobCache;
+
+    PLSRenderContextMetalImpl::MetalFeatures m_metalFeatures;
     std::unique_ptr<BackgroundShaderCompiler> m_backgroundShaderCompiler;
     id<MTLLibrary> m_plsPrecompiledLibrary; // Many shaders come precompiled in a static library.
 
+    // id<MTLBinaryArchive> that every DrawPipeline gets looked up in and added to. Nil if there is
+    // no pipelineBlobCache or the OS doesn't support binary archives.
+    id m_binaryArchive = nil;
+    bool m_binaryArchiveNeedsStore = false;
+
     // Renders color ramps to the gradient texture.
-    class ColorRampPipeline;
     std::unique_ptr<ColorRampPipeline> m_colorRampPipeline;
-    id<MTLTexture> m_gradientTexture = nullptr;
 
     // Renders tessellated vertices to the tessellation texture.
-    class TessellatePipeline;
     std::unique_ptr<TessellatePipeline> m_tessPipeline;
     id<MTLBuffer> m_tessSpanIndexBuffer = nullptr;
-    id<MTLTexture> m_tessVertexTexture = nullptr;
 
     std::map<uint32_t, std::unique_ptr<DrawPipeline>> m_drawPipelines;
+    bool m_precompiledDrawPipelinesLoaded = false;
 
     // Vertex/index buffers for drawing path patches.
     id<MTLBuffer> m_pathPatchVertexBuffer;
@@ -201,10 +328,5 @@ private:
     // Vertex/index buffers for drawing image rects. (pls::InterlockMode::atomics only.)
     id<MTLBuffer> m_imageRectVertexBuffer;
     id<MTLBuffer> m_imageRectIndexBuffer;
-
-    // Locks buffer contents until the GPU has finished rendering with them. Prevents the CPU from
-    // overriding data before the GPU is done with it.
-    std::mutex m_bufferRingLocks[kBufferRingSize];
-    int m_bufferRingIdx = 0;
 };
 } // namespace rive::pls
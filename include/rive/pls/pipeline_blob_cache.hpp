@@ -0,0 +1,73 @@
+/*
+ * Copyright 2024 Rive
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace rive::pls
+{
+// Client-provided persistent storage for compiled shader and pipeline blobs (GL program binaries,
+// VkPipelineCache data, D3D bytecode, etc.). Backends consult this before compiling a shader, and
+// hand back their compiled output, so that subsequent runs of the app can skip the compile step.
+//
+// Keys are short, filename-safe strings that already encode everything the blob depends on (driver
+// version, shader source, ShaderFeatures, InterlockMode, ShaderMiscFlags, etc.). Stale blobs are
+// never looked up again, so the client may evict them with any policy it likes.
+class PipelineBlobCache
+{
+public:
+    virtual ~PipelineBlobCache() {}
+
+    // Replaces the contents of 'blob' with the data stored under 'key'. Returns false if there is
+    // no data stored under 'key'.
+    virtual bool loadBlob(const std::string& key, std::vector<uint8_t>* blob) = 0;
+
+    // Stores 'sizeInBytes' bytes of 'data' under 'key', replacing any previous data.
+    virtual void storeBlob(const std::string& key, const void* data, size_t sizeInBytes) = 0;
+};
+
+// 64-bit FNV-1a hash for building PipelineBlobCache keys out of shader sources and driver strings.
+class PipelineBlobKeyHash
+{
+public:
+    PipelineBlobKeyHash& write(const void* data, size_t sizeInBytes)
+    {
+        for (size_t i = 0; i < sizeInBytes; ++i)
+        {
+            m_hash = (m_hash ^ reinterpret_cast<const uint8_t*>(data)[i]) * 0x100000001b3ull;
+        }
+        return *this;
+    }
+
+    PipelineBlobKeyHash& write(const char* str)
+    {
+        // Include the null terminator so {"ab", "c"} and {"a", "bc"} hash differently.
+        return write(str, str != nullptr ? strlen(str) + 1 : 0);
+    }
+
+    PipelineBlobKeyHash& write(uint64_t value) { return write(&value, sizeof(value)); }
+
+    uint64_t hash() const { return m_hash; }
+
+    // Returns 'prefix' followed by the hash in hex.
+    std::string key(const char* prefix) const
+    {
+        constexpr static char kHexDigits[] = "0123456789abcdef";
+        std::string key(prefix);
+        for (int shift = 60; shift >= 0; shift -= 4)
+        {
+            key.push_back(kHexDigits[(m_hash >> shift) & 0xf]);
+        }
+        return key;
+    }
+
+private:
+    uint64_t m_hash = 0xcbf29ce484222325ull;
+};
+} // namespace rive::pls
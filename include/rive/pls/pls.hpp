@@ -7,6 +7,7 @@
 #include "rive/enum_bitset.hpp"
 #include "rive/math/aabb.hpp"
 #include "rive/math/mat2d.hpp"
+#include "rive/math/math_types.hpp"
 #include "rive/math/path_types.hpp"
 #include "rive/math/vec2d.hpp"
 #include "rive/refcnt.hpp"
@@ -14,6 +15,10 @@
 #include "rive/shapes/paint/color.hpp"
 #include "rive/pls/trivial_block_allocator.hpp"
 
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
 namespace rive
 {
 class GrInnerFanTriangulator;
@@ -50,8 +55,14 @@ constexpr static uint32_t kMaxParametricSegments = 1023;
 constexpr static uint32_t kMaxPolarSegments = 1023;
 
 // We allocate all our GPU buffers in rings. This ensures the CPU can prepare frames in parallel
-// while the GPU renders them.
+// while the GPU renders them. kBufferRingSize is the default depth; backends accept any depth in
+// [kMinBufferRingSize, kMaxBufferRingSize] via their ContextOptions (see
+// PLSRenderContextImpl::bufferRingSize()). Shallower rings cut latency, deeper rings let the CPU
+// run further ahead.
 constexpr static int kBufferRingSize = 3;
+constexpr static int kMinBufferRingSize = 2;
+constexpr static int kMaxBufferRingSize = 4;
+static_assert(kMinBufferRingSize <= kBufferRingSize && kBufferRingSize <= kMaxBufferRingSize);
 
 // Every coverage value in pixel local storage has an associated 16-bit path ID. This ID enables us
 // to batch multiple paths together without having to clear the coverage buffer in between. This ID
@@ -73,11 +84,21 @@ constexpr static int MaxPathID(int granularity)
     return kLargestFP16BeforeExponentAll1s / granularity - kLargestDenormalizedFP16;
 }
 
+// Atomic mode doesn't encode path IDs as fp16. It packs them as integers into the upper 16 bits of
+// its r32ui coverage plane, so it can use every 16-bit ID, regardless of pathIDGranularity.
+constexpr static int kMaxAtomicPathID = 65535;
+static_assert(kMaxAtomicPathID >= MaxPathID(1));
+
 // Each contour has its own unique ID, which it uses to index a data record containing per-contour
-// information. This value is currently 16 bit.
+// information. The ID shares a 32-bit word with the contour flags (see constants.glsl), which
+// leaves room for 22 bits. Backends opt into the full range with
+// PlatformFeatures::supportsWideContourIDs; otherwise contour IDs are limited to 16 bits, which
+// keeps the contour buffer small enough for storage texture polyfills.
 constexpr static size_t kMaxContourID = 65535;
-constexpr static uint32_t kContourIDMask = 0xffff;
+constexpr static size_t kMaxWideContourID = (1 << 22) - 1;
+constexpr static uint32_t kContourIDMask = 0x3fffff;
 static_assert((kMaxContourID & kContourIDMask) == kMaxContourID);
+static_assert((kMaxWideContourID & kContourIDMask) == kMaxWideContourID);
 
 // Tessellation is performed by rendering vertices into a data texture. These values define the
 // dimensions of the tessellation data texture.
@@ -89,6 +110,46 @@ static_assert(1 << kTessTextureWidthLog2 == kTessTextureWidth);
 // texture.
 constexpr static size_t kGradTextureWidth = 512;
 constexpr static size_t kGradTextureWidthInSimpleRamps = kGradTextureWidth / 2;
+// Complex ramps are rendered at power-of-two widths, from 64 texels up to the full texture width.
+constexpr static uint32_t kMinComplexRampWidthLog2 = 6;
+constexpr static uint32_t kComplexRampWidthClassCount = 4;
+static_assert(1 << (kMinComplexRampWidthLog2 + kComplexRampWidthClassCount - 1) ==
+              kGradTextureWidth);
+constexpr static uint32_t kMaxComplexRampsPerRow = kGradTextureWidth >> kMinComplexRampWidthLog2;
+
+// GPU block-compressed formats that image textures can be created from, in addition to RGBA8. All
+// of them encode each 4x4 block of RGBA pixels in 16 bytes.
+enum class CompressedTextureFormat : uint8_t
+{
+    etc2RGBA8, // ETC2 + EAC alpha (VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK).
+    astc4x4,   // ASTC LDR, 4x4 blocks (VK_FORMAT_ASTC_4x4_UNORM_BLOCK).
+    bc7,       // BPTC (VK_FORMAT_BC7_UNORM_BLOCK).
+};
+constexpr static uint32_t kCompressedTextureBlockSize = 4;
+constexpr static size_t kCompressedTextureBytesPerBlock = 16;
+
+// Returns the size in bytes of a single mip level of a block-compressed texture.
+constexpr static size_t CompressedTextureLevelSizeInBytes(uint32_t width, uint32_t height)
+{
+    size_t blocksWide = (width + kCompressedTextureBlockSize - 1) / kCompressedTextureBlockSize;
+    size_t blocksTall = (height + kCompressedTextureBlockSize - 1) / kCompressedTextureBlockSize;
+    return blocksWide * blocksTall * kCompressedTextureBytesPerBlock;
+}
+
+// Returns the size in bytes of 'mipLevelCount' levels of a block-compressed texture, tightly packed
+// beginning with the base level.
+constexpr static size_t CompressedTextureSizeInBytes(uint32_t width,
+                                                     uint32_t height,
+                                                     uint32_t mipLevelCount)
+{
+    size_t sizeInBytes = 0;
+    for (uint32_t level = 0; level < mipLevelCount; ++level)
+    {
+        sizeInBytes += CompressedTextureLevelSizeInBytes(std::max(width >> level, 1u),
+                                                         std::max(height >> level, 1u));
+    }
+    return sizeInBytes;
+}
 
 // Backend-specific capabilities/workarounds and fine tuning.
 struct PlatformFeatures
@@ -96,6 +157,10 @@ struct PlatformFeatures
     bool supportsPixelLocalStorage = true;
     bool supportsRasterOrdering = true;     // Can pixel local storage accesses be raster ordered?
     bool supportsKHRBlendEquations = false; // Use KHR_blend_equation_advanced in depthStencil mode?
+    bool khrBlendEquationsNeedBarriers = false; // Are the KHR blend equations non-coherent, so a
+                                                // blend barrier is required between overlapping
+                                                // advanced blends? (See
+                                                // DrawBatch::needsBlendBarrier.)
     bool supportsClipPlanes = false;        // Required for @ENABLE_CLIP_RECT in depthStencil mode.
     bool supportsBindlessTextures = false;
     bool avoidFlatVaryings = false;
@@ -108,8 +173,48 @@ struct PlatformFeatures
     bool atomicPLSMustBeInitializedAsDraw = false; // Backend cannot initialize PLS with typical
                                                    // clear/load APIs in atomic mode. Issue a
                                                    // "DrawType::plsAtomicInitialize" draw instead.
+    bool supportsCompactTessVertexSpans = false; // Can the tessellation shader read
+                                                 // CompactTessVertexSpans?
+    bool supportsGPUTessellationSpans = false; // Can the backend expand TessCurves into
+                                               // TessVertexSpans on the GPU? (See
+                                               // FlushDescriptor::gpuTessellationSpans.)
     uint8_t pathIDGranularity = 1; // Workaround for precision issues. Determines how far apart we
                                    // space unique path IDs.
+    uint32_t maxTextureSize = 2048; // Largest 2D texture the backend can render to, in either
+                                    // dimension. (Lets the tessellation texture grow taller.)
+    bool supportsWideContourIDs = false; // Can a flush address kMaxWideContourID contours?
+                                         // (Requires native storage buffers; the contour buffer
+                                         // would outgrow a storage texture polyfill.)
+    bool supportsTileBinnedRendering = false; // Can the backend scissor an entire atomic-mode flush
+                                              // (clears, loads, stores, and draws) to its
+                                              // renderTargetUpdateBounds? (See
+                                              // FlushDescriptor::isTileBinPass.)
+    bool supportsResolutionScaling = false; // Can the backend upscale an offscreen layer into a
+                                            // render target? (See
+                                            // FrameDescriptor::resolutionScale.)
+    bool supportsPipelinedSubmission = false; // Can flush() be called on a different thread than
+                                              // the rest of the backend, and with no client
+                                              // command buffer? (See
+                                              // PLSRenderContext::setPipelinedSubmission().)
+    // Which CompressedTextureFormats can be sampled natively (without the driver decompressing
+    // them behind our back)?
+    bool supportsETC2Textures = false;
+    bool supportsASTCTextures = false;
+    bool supportsBC7Textures = false;
+
+    bool supportsCompressedTextureFormat(CompressedTextureFormat format) const
+    {
+        switch (format)
+        {
+            case CompressedTextureFormat::etc2RGBA8:
+                return supportsETC2Textures;
+            case CompressedTextureFormat::astc4x4:
+                return supportsASTCTextures;
+            case CompressedTextureFormat::bc7:
+                return supportsBC7Textures;
+        }
+        RIVE_UNREACHABLE();
+    }
 };
 
 // Gradient color stops are implemented as a horizontal span of pixels in a global gradient
@@ -236,6 +341,200 @@ static_assert(256 % sizeof(TessVertexSpan) == 0);
 // Metal requires vertex buffers to be 256-byte aligned.
 constexpr static size_t kTessVertexBufferAlignmentInElements = 256 / sizeof(TessVertexSpan);
 
+// Converts a float to the bits of the nearest fp16 (round to nearest even), saturating to the
+// largest finite fp16 instead of overflowing to infinity.
+RIVE_ALWAYS_INLINE uint32_t FloatToHalfBits(float f)
+{
+    uint32_t x = math::bit_cast<uint32_t>(f);
+    uint32_t sign = (x >> 16) & 0x8000;
+    x &= 0x7fffffff;
+    if (x >= 0x477ff000) // Rounds to >= 65520, i.e., overflows fp16. (Or is NaN.)
+    {
+        return sign | 0x7bff;
+    }
+    if (x < 0x38800000) // Rounds to a denormalized fp16 (or zero).
+    {
+        return sign | static_cast<uint32_t>(math::bit_cast<float>(x) * 0x1p24f + .5f);
+    }
+    // Rebias the exponent from 127 to 15 and round the mantissa from 23 to 10 bits.
+    x += 0xc8000fff + ((x >> 13) & 1);
+    return sign | (x >> 13);
+}
+
+// Same as GLSL packHalf2x16().
+RIVE_ALWAYS_INLINE uint32_t PackHalf2x16(Vec2D v)
+{
+    return FloatToHalfBits(v.y) << 16 | FloatToHalfBits(v.x);
+}
+
+// Optional, lossy 48-byte encoding of a TessVertexSpan, for backends that support
+// PlatformFeatures::supportsCompactTessVertexSpans (see FrameDescriptor::compactTessVertexSpans).
+//
+// The endpoints of the cubic stay fp32, so neighboring curves (and the midpoint fan triangles that
+// connect them) still meet exactly. The inner control points are stored as fp16 offsets from their
+// nearest endpoint, the join tangent is normalized and stored as fp16, and both rows are 16-bit.
+struct CompactTessVertexSpan
+{
+    RIVE_ALWAYS_INLINE void set(const Vec2D pts_[4],
+                                Vec2D joinTangent_,
+                                float y_,
+                                int32_t x0,
+                                int32_t x1,
+                                uint32_t parametricSegmentCount,
+                                uint32_t polarSegmentCount,
+                                uint32_t joinSegmentCount,
+                                uint32_t contourIDWithFlags_)
+    {
+        // Discard the reflection by giving it zero width. (There's no NaN for a 16-bit row.)
+        set(pts_,
+            joinTangent_,
+            y_,
+            x0,
+            x1,
+            0,
+            -1,
+            -1,
+            parametricSegmentCount,
+            polarSegmentCount,
+            joinSegmentCount,
+            contourIDWithFlags_);
+    }
+
+    RIVE_ALWAYS_INLINE void set(const Vec2D pts_[4],
+                                Vec2D joinTangent_,
+                                float y_,
+                                int32_t x0,
+                                int32_t x1,
+                                float reflectionY_,
+                                int32_t reflectionX0,
+                                int32_t reflectionX1,
+                                uint32_t parametricSegmentCount,
+                                uint32_t polarSegmentCount,
+                                uint32_t joinSegmentCount,
+                                uint32_t contourIDWithFlags_)
+    {
+        assert(0 <= y_ && y_ <= 0xffff);
+        assert(0 <= reflectionY_ && reflectionY_ <= 0xffff);
+        // The join tangent only needs a direction. Scale it into [-1, 1] before it goes to fp16, so
+        // it can't overflow or lose its precision to denormals.
+        float tangentScale = std::max(fabsf(joinTangent_.x), fabsf(joinTangent_.y));
+        if (tangentScale != 0)
+        {
+            joinTangent_ = joinTangent_ * (1 / tangentScale);
+        }
+        // Don't read back from write-only mapped memory; build the span locally and copy it out.
+        CompactTessVertexSpan localCopy;
+        localCopy.p0p3[0] = pts_[0].x;
+        localCopy.p0p3[1] = pts_[0].y;
+        localCopy.p0p3[2] = pts_[3].x;
+        localCopy.p0p3[3] = pts_[3].y;
+        localCopy.p1Delta = PackHalf2x16(pts_[1] - pts_[0]);
+        localCopy.p2Delta = PackHalf2x16(pts_[2] - pts_[3]);
+        localCopy.joinTangent = PackHalf2x16(joinTangent_);
+        localCopy.ys = static_cast<uint32_t>(reflectionY_) << 16 | static_cast<uint32_t>(y_);
+        localCopy.x0x1 = (x1 << 16 | (x0 & 0xffff));
+        localCopy.reflectionX0X1 = (reflectionX1 << 16 | (reflectionX0 & 0xffff));
+        localCopy.segmentCounts =
+            (joinSegmentCount << 20) | (polarSegmentCount << 10) | parametricSegmentCount;
+        localCopy.contourIDWithFlags = contourIDWithFlags_;
+        RIVE_INLINE_MEMCPY(this, &localCopy, sizeof(*this));
+    }
+
+    float p0p3[4];    // fp32 endpoints of the cubic.
+    uint32_t p1Delta; // packHalf2x16(p1 - p0)
+    uint32_t p2Delta; // packHalf2x16(p2 - p3)
+    uint32_t joinTangent;
+    uint32_t ys; // [reflectionY, y]
+    int32_t x0x1;
+    int32_t reflectionX0X1;
+    uint32_t segmentCounts;      // [joinSegmentCount, polarSegmentCount, parametricSegmentCount]
+    uint32_t contourIDWithFlags; // flags | contourID
+};
+static_assert(sizeof(CompactTessVertexSpan) == sizeof(float) * 12);
+// 256-byte alignment of the compact spans takes 16 elements (768 bytes).
+constexpr static size_t kCompactTessVertexBufferAlignmentInElements = 16;
+static_assert(kCompactTessVertexBufferAlignmentInElements * sizeof(CompactTessVertexSpan) % 256 ==
+              0);
+
+// One curve's worth of tessellation, for backends that support
+// PlatformFeatures::supportsGPUTessellationSpans (see FrameDescriptor::gpuTessellationSpans).
+//
+// The CPU still counts segments, since they determine the layout of the tessellation texture, but
+// instead of wrapping each curve into rows of TessVertexSpans it uploads a single TessCurve with
+// its locations in the texture. A compute pass then expands the curve into the same
+// TessVertexSpans the CPU would have written, starting at firstSpanIdx.
+struct TessCurve
+{
+    // The curve has no forward copy in the tessellation texture (ContourDirections::reverse).
+    constexpr static uint32_t kNoForwardLocation = ~0u;
+    // The curve has no mirrored copy in the tessellation texture. (Mirrored locations are one past
+    // the curve's rightmost vertex, so they are never 0 when used.)
+    constexpr static uint32_t kNoMirroredLocation = 0;
+
+    // Returns how many TessVertexSpans the GPU expands a TessCurve into. This matches the number
+    // of spans LogicalFlush::push*TessellationSpans() would have written on the CPU.
+    RIVE_ALWAYS_INLINE static uint32_t SpanCount(uint32_t tessLocation,
+                                                 uint32_t mirroredTessLocation,
+                                                 uint32_t totalVertexCount)
+    {
+        uint32_t spanCount = 1;
+        if (tessLocation != kNoForwardLocation)
+        {
+            uint32_t x0 = tessLocation % kTessTextureWidth;
+            spanCount = (x0 + totalVertexCount - 1) / kTessTextureWidth + 1;
+        }
+        if (mirroredTessLocation != kNoMirroredLocation)
+        {
+            uint32_t reflectionX0 = (mirroredTessLocation - 1) % kTessTextureWidth + 1;
+            if (totalVertexCount > reflectionX0)
+            {
+                uint32_t overflow = totalVertexCount - reflectionX0;
+                uint32_t mirroredSpanCount =
+                    (overflow + kTessTextureWidth - 1) / kTessTextureWidth + 1;
+                spanCount = std::max(spanCount, mirroredSpanCount);
+            }
+        }
+        return spanCount;
+    }
+
+    RIVE_ALWAYS_INLINE void set(const Vec2D pts_[4],
+                                Vec2D joinTangent_,
+                                uint32_t tessLocation_,
+                                uint32_t mirroredTessLocation_,
+                                uint32_t totalVertexCount_,
+                                uint32_t parametricSegmentCount,
+                                uint32_t polarSegmentCount,
+                                uint32_t joinSegmentCount,
+                                uint32_t contourIDWithFlags_,
+                                uint32_t firstSpanIdx_)
+    {
+        assert(tessLocation_ != kNoForwardLocation || mirroredTessLocation_ != kNoMirroredLocation);
+        // Don't read back from write-only mapped memory; build the curve locally and copy it out.
+        TessCurve localCopy;
+        RIVE_INLINE_MEMCPY(localCopy.pts, pts_, sizeof(localCopy.pts));
+        localCopy.joinTangent = joinTangent_;
+        localCopy.tessLocation = tessLocation_;
+        localCopy.mirroredTessLocation = mirroredTessLocation_;
+        localCopy.totalVertexCount = totalVertexCount_;
+        localCopy.segmentCounts =
+            (joinSegmentCount << 20) | (polarSegmentCount << 10) | parametricSegmentCount;
+        localCopy.contourIDWithFlags = contourIDWithFlags_;
+        localCopy.firstSpanIdx = firstSpanIdx_;
+        RIVE_INLINE_MEMCPY(this, &localCopy, sizeof(*this));
+    }
+
+    Vec2D pts[4];                  // Cubic bezier curve.
+    Vec2D joinTangent;             // Ending tangent of the join that follows the cubic.
+    uint32_t tessLocation;         // First vertex of the forward copy, or kNoForwardLocation.
+    uint32_t mirroredTessLocation; // One past the first vertex of the mirrored copy (which is laid
+                                   // out right to left), or kNoMirroredLocation.
+    uint32_t totalVertexCount;
+    uint32_t segmentCounts;      // [joinSegmentCount, polarSegmentCount, parametricSegmentCount]
+    uint32_t contourIDWithFlags; // flags | contourID
+    uint32_t firstSpanIdx;       // Where this curve's TessVertexSpans go, relative to the flush.
+};
+static_assert(sizeof(TessCurve) == sizeof(TessVertexSpan));
+
 // Tessellation spans are drawn as two distinct, 1px-tall rectangles: the span and its reflection.
 constexpr uint16_t kTessSpanIndices[4 * 3] = {0, 1, 2, 2, 1, 3, 4, 5, 6, 6, 5, 7};
 
@@ -281,12 +580,36 @@ enum class PaintType : uint32_t
 
 // Specifies the location of a simple or complex horizontal color ramp within the gradient texture.
 // A simple color ramp is two texels wide, beginning at the specified row and column.
-// A complex color ramp spans the entire width of the gradient texture, on the row:
+// A complex color ramp is a power-of-two number of texels wide, beginning at complexCol() on the
+// row:
 //     "GradTextureLayout::complexOffsetY + ColorRampLocation::row".
+// An analytic color ramp is not in the texture at all. The shader interpolates its two colors
+// directly.
 struct ColorRampLocation
 {
-    constexpr static uint16_t kComplexGradientMarker = 0xffff;
-    bool isComplex() const { return col == kComplexGradientMarker; }
+    // Complex ramps set the top bit of "col", store log2(width) in bits 12..14, and store their
+    // starting column in bits 0..11.
+    constexpr static uint16_t kComplexGradientMarker = 0x8000;
+    bool isComplex() const { return col & kComplexGradientMarker; }
+
+    // Analytic ramps set bit 14 of "col" (and not the top bit).
+    constexpr static uint16_t kAnalyticGradientMarker = 0x4000;
+    bool isAnalytic() const
+    {
+        return (col & (kComplexGradientMarker | kAnalyticGradientMarker)) ==
+               kAnalyticGradientMarker;
+    }
+    static ColorRampLocation MakeAnalytic() { return {0, kAnalyticGradientMarker}; }
+    uint32_t complexCol() const { return col & 0xfff; }
+    uint32_t complexWidth() const { return 1u << ((col >> 12) & 7); }
+
+    static ColorRampLocation MakeComplex(uint16_t row, uint32_t col, uint32_t widthLog2)
+    {
+        assert(col < kGradTextureWidth);
+        assert((1u << widthLog2) <= kGradTextureWidth);
+        return {row, static_cast<uint16_t>(kComplexGradientMarker | (widthLog2 << 12) | col)};
+    }
+
     uint16_t row;
     uint16_t col;
 };
@@ -314,18 +637,27 @@ public:
 
     ClipRectInverseMatrix() = default;
 
-    ClipRectInverseMatrix(const Mat2D& clipMatrix, const AABB& clipRect)
+    ClipRectInverseMatrix(const Mat2D& clipMatrix,
+                          const AABB& clipRect,
+                          Vec2D cornerRadii = {0, 0})
     {
-        reset(clipMatrix, clipRect);
+        reset(clipMatrix, clipRect, cornerRadii);
     }
 
-    void reset(const Mat2D& clipMatrix, const AABB& clipRect);
+    // 'cornerRadii' are the x and y radii of the clipRect's (identical) corner ellipses, in the
+    // same space as 'clipRect'. An ellipse is a clipRect whose corner radii are half its size.
+    void reset(const Mat2D& clipMatrix, const AABB& clipRect, Vec2D cornerRadii = {0, 0});
 
     const Mat2D& inverseMatrix() const { return m_inverseMatrix; }
 
+    // Corner radii in normalized clipRect space, where 1 is half the clipRect's width or height.
+    // {0, 0} if the clipRect has sharp corners.
+    Vec2D normalizedCornerRadii() const { return m_normalizedCornerRadii; }
+
 private:
     constexpr ClipRectInverseMatrix(const Mat2D& inverseMatrix) : m_inverseMatrix(inverseMatrix) {}
     Mat2D m_inverseMatrix;
+    Vec2D m_normalizedCornerRadii = {0, 0};
 };
 
 // Specifies the height of the gradient texture, and the row at which we transition from simple
@@ -461,6 +793,11 @@ enum class DrawType : uint8_t
     stencilClipReset,    // Clear or intersect (based on DrawContents) the stencil clip bit.
 };
 
+// In depthStencil mode, interiorTriangulation batches end with two triangles that cover the path's
+// bounding box, for the "cover" half of stencil-then-cover. (The outerCurvePatches and interior
+// triangles before them only write the stencil buffer.)
+constexpr static uint32_t kStencilCoverVertexCount = 6;
+
 constexpr static bool DrawTypeIsImageDraw(DrawType drawType)
 {
     switch (drawType)
@@ -658,6 +995,14 @@ RIVE_MAKE_ENUM_BITSET(ShaderMiscFlags)
 // Returns a unique value that can be used to key a shader.
 uint32_t ShaderUniqueKey(DrawType, ShaderFeatures, InterlockMode, ShaderMiscFlags);
 
+// Identifies one variant of a "draw" shader, for warming up shaders ahead of time.
+struct ShaderVariant
+{
+    DrawType drawType;
+    ShaderFeatures shaderFeatures;
+    InterlockMode interlockMode;
+};
+
 extern const char* GetShaderFeatureGLSLName(ShaderFeatures feature);
 
 // Flags indicating the contents of a draw. These don't affect shaders, but in depthStencil mode
@@ -703,6 +1048,15 @@ struct DrawBatch
     DrawContents drawContents = DrawContents::none;
     ShaderFeatures shaderFeatures = ShaderFeatures::NONE;
     bool needsBarrier = false; // Pixel-local-storage barrier required after submitting this batch.
+    bool needsBlendBarrier = false; // PlatformFeatures::khrBlendEquationsNeedBarriers: blend
+                                    // barrier required before submitting this batch.
+
+    // Union of the pixelBounds of every PLSDraw in the batch. Batches that aren't associated with
+    // any PLSDraws (e.g., plsAtomicResolve) cover the entire render target.
+    IAABB pixelBounds = {std::numeric_limits<int32_t>::min(),
+                         std::numeric_limits<int32_t>::min(),
+                         std::numeric_limits<int32_t>::max(),
+                         std::numeric_limits<int32_t>::max()};
 
     // DrawType::imageRect and DrawType::imageMesh.
     uint32_t imageDrawDataOffset = 0;
@@ -751,7 +1105,8 @@ public:
 //     simpleGradDataOffsetInBytes, tessDataHeight).
 //
 //  3. Render the tessellation texture from the tessVertexSpanBuffer (tessVertexSpanCount,
-//     firstTessVertexSpan).
+//     firstTessVertexSpan). If gpuTessellationSpans is true, first expand the buffer's
+//     TessCurves into TessVertexSpans with a compute pass (tessCurveCount).
 //
 //  4. Execute the drawList, reading from the newly rendered resource textures.
 //
@@ -769,6 +1124,11 @@ struct FlushDescriptor
     IAABB renderTargetUpdateBounds; // drawBounds, or renderTargetBounds if loadAction ==
                                     // LoadAction::clear.
 
+    // renderTargetUpdateBounds doesn't cover the entire render target. No draw touches the pixels
+    // outside it, so the backend may restrict the PLS plane clears, offscreen transfers, and atomic
+    // resolve to renderTargetUpdateBounds, and leave stale contents everywhere else.
+    bool hasPartialUpdateBounds = false;
+
     size_t flushUniformDataOffsetInBytes = 0;
     size_t pathCount = 0;
     size_t firstPath = 0;
@@ -780,6 +1140,7 @@ struct FlushDescriptor
     size_t firstComplexGradSpan = 0;
     size_t tessVertexSpanCount = 0;
     size_t firstTessVertexSpan = 0;
+    size_t tessCurveCount = 0; // When gpuTessellationSpans is true.
     uint32_t simpleGradTexelsWidth = 0;
     uint32_t simpleGradTexelsHeight = 0;
     size_t simpleGradDataOffsetInBytes = 0;
@@ -798,9 +1159,73 @@ struct FlushDescriptor
     // frame. (Null if isFinalFlushOfFrame is false.)
     pls::CommandBufferCompletionFence* frameCompletionFence = nullptr;
 
+    // Nonzero if the backend should measure how long the GPU spends executing this frame, from the
+    // beginning of its first flush to the end of its final flush. The backend reports the
+    // measurement later, once it's available, via PLSRenderContextImpl::popGPUFrameTime().
+    uint64_t gpuTimerFrameNumber = 0;
+
+    // FrameDescriptor::tileBinnedRendering: this is one of several passes that together render a
+    // single logical flush, one screen-space bin at a time. The backend must restrict all clears,
+    // loads, stores, and rasterization to renderTargetUpdateBounds (the bin). The drawList only
+    // contains batches that touch the bin, and only the first bin renders the gradient and
+    // tessellation textures; subsequent bins leave them intact and read from them.
+    bool isTileBinPass = false;
+    bool isFirstTileBinPass = false;
+
+    // The tessVertexSpanBuffer holds CompactTessVertexSpans instead of TessVertexSpans.
+    bool compactTessVertexSpans = false;
+
+    // The tessVertexSpanBuffer holds tessCurveCount TessCurves, starting at firstTessVertexSpan,
+    // instead of TessVertexSpans. The backend must expand them on the GPU into tessVertexSpanCount
+    // TessVertexSpans (at the same starting index, in a buffer of its own) before tessellating.
+    bool gpuTessellationSpans = false;
+
     bool hasTriangleVertices = false;
     bool wireframe = false;
+    bool isFirstFlushOfFrame = false;
     bool isFinalFlushOfFrame = false;
+
+    // PLSRenderContext::nextTarget() lets one frame render into several targets. These bracket the
+    // flushes (and, with tile binning, the passes) that render into this one.
+    bool isFirstFlushOfRenderTarget = false;
+    bool isFinalFlushOfRenderTarget = false;
+};
+
+// GPU execution time for a frame that requested FrameDescriptor::measureGPUTime.
+struct GPUFrameTime
+{
+    uint64_t frameNumber;
+    double seconds;
+};
+
+// 64-bit FNV-1a hash of a frame's draw stream, for FrameDescriptor::skipUnchangedFrames. Callers
+// write individual fields rather than whole structs, so padding bytes never get hashed.
+class DrawStreamHash
+{
+public:
+    DrawStreamHash& writeBytes(const void* data, size_t sizeInBytes)
+    {
+        for (size_t i = 0; i < sizeInBytes; ++i)
+        {
+            m_hash = (m_hash ^ reinterpret_cast<const uint8_t*>(data)[i]) * 0x100000001b3ull;
+        }
+        return *this;
+    }
+
+    template <typename T> DrawStreamHash& write(const T& value)
+    {
+        static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>);
+        return writeBytes(&value, sizeof(value));
+    }
+
+    DrawStreamHash& write(const Mat2D& m) { return writeBytes(m.values(), 6 * sizeof(float)); }
+    DrawStreamHash& write(const IAABB& r) { return writeBytes(&r, sizeof(r)); }
+    DrawStreamHash& write(const AABB& r) { return writeBytes(&r, sizeof(r)); }
+
+    uint64_t hash() const { return m_hash; }
+
+private:
+    uint64_t m_hash = 0xcbf29ce484222325ull;
 };
 
 // Returns the smallest number that can be added to 'value', such that 'value % alignment' == 0.
@@ -817,6 +1242,16 @@ template <uint32_t Alignment> RIVE_ALWAYS_INLINE uint32_t PaddingToAlignUp(uint3
 // transforming the given bounds by the given matrix.
 float FindTransformedArea(const AABB& bounds, const Mat2D&);
 
+// Sorts signed 64-bit keys in ascending order with a stable LSD radix sort, one byte per pass.
+// Passes over bytes that hold the same value in every key are skipped, which makes this
+// considerably cheaper than a comparison sort for keys with a fixed bit layout.
+//
+// The lowest 'presortedLowBits' (a multiple of 8) are never sorted on: the caller guarantees the
+// input is already in ascending order by those bits (e.g., they hold each key's own index), so the
+// stable passes above them leave them as the tiebreaker. 'scratch' must have room for 'count'
+// keys. Small inputs fall back on std::sort.
+void SortInt64Keys(int64_t* keys, int64_t* scratch, size_t count, uint32_t presortedLowBits = 0);
+
 // Convert a BlendMode to the tightly-packed range used by PLS shaders.
 uint32_t ConvertBlendModeToPLSBlendMode(BlendMode riveMode);
 
@@ -911,12 +1346,14 @@ struct PathData
 public:
     constexpr static StorageBufferStructure kBufferStructure = StorageBufferStructure::uint32x4;
 
-    void set(const Mat2D&, float strokeRadius, uint32_t zIndex);
+    void set(const Mat2D&, float strokeRadius, uint32_t zIndex, uint32_t paintAuxIdx);
 
 private:
     WRITEONLY float m_matrix[6];
     WRITEONLY float m_strokeRadius; // "0" indicates that the path is filled, not stroked.
-    WRITEONLY uint32_t m_zIndex;    // pls::InterlockMode::depthStencil only.
+    // [paintAuxIdx << 16 | zIndex]. zIndex is only used in pls::InterlockMode::depthStencil.
+    // paintAuxIdx locates the path's PaintAuxData, which may be shared with other paths.
+    WRITEONLY uint32_t m_zIndexAndPaintAuxIdx;
 };
 static_assert(sizeof(PathData) == StorageBufferElementSizeInBytes(PathData::kBufferStructure) * 2);
 static_assert(256 % sizeof(PathData) == 0);
@@ -924,7 +1361,7 @@ constexpr static size_t kPathBufferAlignmentInElements = 256 / sizeof(PathData);
 
 // High level structure of the "paint" storage buffer. Each path also has a data small record
 // describing its paint at a high level. Complex paints (gradients, images, or any path with a
-// clipRect) store additional rendering info in the PaintAuxData buffer.
+// clipRect) store additional rendering info in the PaintAuxData buffer, at PathData's paintAuxIdx.
 struct PaintData
 {
 public:
@@ -974,11 +1411,14 @@ private:
     {
         WRITEONLY float m_gradTextureHorizontalSpan[2]; // Paintype::linearGradient,
                                                         // Paintype::radialGradient
+        WRITEONLY uint32_t m_analyticGradientColors[2]; // PAINT_FLAG_ANALYTIC_GRADIENT
         WRITEONLY uint32_t m_bindlessTextureHandle[2];  // PaintType::image
     };
 
     WRITEONLY float m_clipRectInverseMatrix[6]; // Maps _fragCoord to normalized clipRect coords.
-    WRITEONLY Vec2D m_inverseFwidth; // -1 / fwidth(matrix * _fragCoord) -- for antialiasing.
+    // Radii of the clipRect's corner ellipses, in units of fwidth(clipRect coords) (~pixels), or 0
+    // if the clipRect has sharp corners.
+    WRITEONLY Vec2D m_clipRectCornerRadii;
 };
 static_assert(sizeof(PaintAuxData) ==
               StorageBufferElementSizeInBytes(PaintAuxData::kBufferStructure) * 4);
@@ -1014,6 +1454,11 @@ public:
     TriangleVertex(Vec2D point, int16_t weight, uint16_t pathID) :
         m_point(point), m_weight_pathID((static_cast<int32_t>(weight) << 16) | pathID)
     {}
+    // Copies a vertex that was written with a pathID of 0, and assigns it a new pathID.
+    TriangleVertex(const TriangleVertex& retained, uint16_t pathID) :
+        m_point(Vec2D{retained.m_point.x, retained.m_point.y}),
+        m_weight_pathID(retained.m_weight_pathID | pathID)
+    {}
 
 #ifdef TESTING
     Vec2D testing_point() const { return {m_point.x, m_point.y}; }
@@ -1037,6 +1482,16 @@ public:
                       const ClipRectInverseMatrix*,
                       uint32_t clipID,
                       BlendMode,
+                      uint32_t zIndex,
+                      const AABB& texCoordBounds);
+
+    // Solid-color imageRect (see SolidRectDraw). The shader uses 'color' instead of sampling the
+    // image texture.
+    ImageDrawUniforms(const Mat2D&,
+                      ColorInt color,
+                      const ClipRectInverseMatrix*,
+                      uint32_t clipID,
+                      BlendMode,
                       uint32_t zIndex);
 
 private:
@@ -1047,13 +1502,23 @@ private:
     WRITEONLY uint32_t m_clipID;
     WRITEONLY uint32_t m_blendMode;
     WRITEONLY uint32_t m_zIndex; // pls::InterlockMode::depthStencil only.
+    WRITEONLY uint32_t m_hasSolidColor = 0; // imageRect only.
+    WRITEONLY float m_clipRectCornerRadii[2]; // Same as PaintAuxData::m_clipRectCornerRadii.
+    // [scaleX, scaleY, translateX, translateY] from the image's [0, 0, 1, 1] texture coordinates
+    // to the region of the texture it occupies (not the identity if the image lives in an atlas).
+    WRITEONLY float m_texCoordTransform[4];
+    // Unmultiplied RGBA color of a solid-color imageRect, if m_hasSolidColor is nonzero.
+    WRITEONLY float m_solidColor[4] = {0, 0, 0, 0};
     // Uniform blocks must be multiples of 256 bytes in size.
-    WRITEONLY uint8_t m_padTo256Bytes[256 - 68];
+    WRITEONLY uint8_t m_padTo256Bytes[256 - 112];
 
     constexpr void staticChecks()
     {
         static_assert(offsetof(ImageDrawUniforms, m_matrix) % 16 == 0);
         static_assert(offsetof(ImageDrawUniforms, m_clipRectInverseMatrix) % 16 == 0);
+        static_assert(offsetof(ImageDrawUniforms, m_clipRectCornerRadii) % 8 == 0);
+        static_assert(offsetof(ImageDrawUniforms, m_texCoordTransform) == 80);
+        static_assert(offsetof(ImageDrawUniforms, m_solidColor) == 96);
         static_assert(sizeof(ImageDrawUniforms) == 256);
     }
 };
@@ -1099,6 +1564,16 @@ public:
 
     operator bool() const { return m_mappedMemory; }
 
+    // Returns a separate view of the elements [offset, offset + elementCount) in this mapping.
+    // Views of disjoint ranges may be written concurrently from different threads. Writes to a
+    // view are not reflected in this object's write position.
+    WriteOnlyMappedMemory subrange(size_t offset, size_t elementCount) const
+    {
+        assert(elementCount == 0 || m_mappedMemory + offset + elementCount <= m_mappingEnd);
+        return elementCount != 0 ? WriteOnlyMappedMemory(m_mappedMemory + offset, elementCount)
+                                 : WriteOnlyMappedMemory();
+    }
+
     // How many bytes have been written to the buffer?
     size_t bytesWritten() const
     {
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2024 Rive
+ */
+
+#pragma once
+
+#include "rive/renderer.hpp"
+#include "rive/pls/pls_render_context.hpp"
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace rive
+{
+class Factory;
+}
+
+namespace rive::pls
+{
+class PLSPath;
+class PLSPaint;
+class PLSTexture;
+
+// Binary captures of the Renderer call stream, for profiling and regression testing without the
+// .riv files (or the runtime) that produced them.
+//
+// A capture is a header followed by a flat list of ops. Paths and paints are defined once, by ID,
+// and only re-emitted when they change (paths by RawPath mutation ID, paints by value). Images are
+// recorded by texture hash and size only; their pixels stay behind, and the replay substitutes
+// images of the same size. drawImageMesh() is not captured, since the backends don't keep the
+// contents of RenderBuffers on the CPU.
+//
+// All values are written in host (little endian) byte order.
+constexpr static uint32_t kCaptureVersion = 2;
+
+// Renderer that records every call into a capture, optionally forwarding them to a real renderer
+// to draw at the same time. Frames are delimited by beginFrame() and endFrame().
+class PLSCaptureRenderer : public Renderer
+{
+public:
+    PLSCaptureRenderer(Renderer* forwardRenderer = nullptr);
+    ~PLSCaptureRenderer() override;
+
+    void beginFrame(const PLSRenderContext::FrameDescriptor&);
+    void endFrame();
+
+    void save() override;
+    void restore() override;
+    void transform(const Mat2D& matrix) override;
+    void drawPath(RenderPath*, RenderPaint*) override;
+    void clipPath(RenderPath*) override;
+    void drawImage(const RenderImage*, BlendMode, float opacity) override;
+    void drawImageMesh(const RenderImage*,
+                       rcp<RenderBuffer> vertices_f32,
+                       rcp<RenderBuffer> uvCoords_f32,
+                       rcp<RenderBuffer> indices_u16,
+                       uint32_t vertexCount,
+                       uint32_t indexCount,
+                       BlendMode,
+                       float opacity) override;
+
+    size_t frameCount() const { return m_frameCount; }
+
+    // Number of calls that were forwarded, but couldn't be captured (e.g., drawImageMesh()).
+    size_t uncapturedCallCount() const { return m_uncapturedCallCount; }
+
+    const std::vector<uint8_t>& data() const { return m_data; }
+
+private:
+    template <typename T> void write(const T&);
+
+    uint32_t definePath(const PLSPath*);
+    uint32_t definePaint(const PLSPaint*);
+    uint32_t defineImage(const void* key, uint32_t width, uint32_t height, uint32_t hash);
+
+    Renderer* const m_forwardRenderer;
+    std::vector<uint8_t> m_data;
+    size_t m_frameCount = 0;
+    size_t m_uncapturedCallCount = 0;
+    RIVE_DEBUG_CODE(bool m_isInFrame = false;)
+
+    struct PathRecord
+    {
+        uint32_t id;
+        uint64_t rawPathMutationID;
+        FillRule fillRule;
+    };
+    std::unordered_map<const PLSPath*, PathRecord> m_paths;
+
+    struct PaintRecord
+    {
+        uint32_t id;
+        std::vector<uint8_t> value; // Serialized state, for detecting changes.
+    };
+    std::unordered_map<const PLSPaint*, PaintRecord> m_paints;
+
+    // Keyed by PLSTexture (or by PLSImage, for images that don't own a texture).
+    std::unordered_map<const void*, uint32_t> m_images;
+
+    uint32_t m_nextID = 1;
+    std::vector<uint8_t> m_scratchPaintValue;
+};
+
+// Parses a capture and replays its frames into a Renderer.
+class PLSCaptureReplay
+{
+public:
+    // Returns a stand-in for an image that was recorded by hash. The contents are up to the client,
+    // but it must be a PLSImage of the given size.
+    using MakeImageFn =
+        std::function<rcp<RenderImage>(uint32_t width, uint32_t height, uint32_t hash)>;
+
+    // Returns null if 'data' is not a valid capture.
+    static std::unique_ptr<PLSCaptureReplay> Make(std::vector<uint8_t> data,
+                                                  Factory*,
+                                                  MakeImageFn);
+
+    size_t frameCount() const { return m_frames.size(); }
+
+    const PLSRenderContext::FrameDescriptor& frameDescriptor(size_t frameIdx) const
+    {
+        return m_frames[frameIdx].descriptor;
+    }
+
+    // Issues the draws recorded between beginFrame() and endFrame(). Paths and paints persist
+    // across frames, so frames must be replayed in order, although it is OK to wrap back around to
+    // frame 0 after the final frame.
+    void replayFrame(size_t frameIdx, Renderer*);
+
+private:
+    PLSCaptureReplay(std::vector<uint8_t> data, Factory*, MakeImageFn);
+
+    // Walks the ops in [begin, end). If 'renderer' is null, only validates them.
+    bool runOps(size_t begin, size_t end, Renderer*);
+
+    struct Frame
+    {
+        PLSRenderContext::FrameDescriptor descriptor;
+        size_t opsBegin;
+        size_t opsEnd;
+    };
+
+    const std::vector<uint8_t> m_data;
+    Factory* const m_factory;
+    const MakeImageFn m_makeImage;
+    std::vector<Frame> m_frames;
+    std::unordered_map<uint32_t, rcp<RenderPath>> m_paths;
+    std::unordered_map<uint32_t, rcp<RenderPaint>> m_paints;
+    std::unordered_map<uint32_t, rcp<RenderImage>> m_images;
+};
+} // namespace rive::pls
@@ -12,6 +12,8 @@
 #include "rive/shapes/paint/stroke_cap.hpp"
 #include "rive/shapes/paint/stroke_join.hpp"
 #include "rive/refcnt.hpp"
+#include "rive/span.hpp"
+#include <vector>
 
 namespace rive::pls
 {
@@ -20,6 +22,11 @@ class PLSPath;
 class PLSPaint;
 class PLSRenderContext;
 class PLSGradient;
+struct RetainedMidpointFanData;
+struct RetainedInteriorTriangulationData;
+class RetainedTriangulation;
+class AsyncTriangulator;
+struct AsyncTriangulationJob;
 
 // High level abstraction of a single object to be drawn (path, imageRect, or imageMesh). These get
 // built up for an entire frame in order to count GPU resource allocation sizes, and then sorted,
@@ -36,6 +43,7 @@ public:
         midpointFanPath,
         interiorTriangulationPath,
         imageRect,
+        solidRect,
         imageMesh,
         stencilClipReset,
     };
@@ -60,6 +68,11 @@ public:
     pls::SimplePaintValue simplePaintValue() const { return m_simplePaintValue; }
     const PLSGradient* gradient() const { return m_gradientRef; }
 
+    // Pixels this draw is guaranteed to cover with opaque, srcOver content, or empty if it isn't
+    // an occluder. Earlier draws that lie entirely inside these bounds are hidden, and get culled
+    // before the flush is laid out. (See LogicalFlush::cullOccludedDraws().)
+    const IAABB& occluderBounds() const { return m_occluderBounds; }
+
     // Clipping setup.
     void setClipID(uint32_t clipID);
     void setClipRect(const pls::ClipRectInverseMatrix* m) { m_clipRectInverseMatrix = m; }
@@ -89,6 +102,12 @@ public:
     // method before clearing the drawList to release all our held references.
     virtual void releaseRefs();
 
+    // Writes the state that determines what this draw renders into 'hash', for
+    // FrameDescriptor::skipUnchangedFrames. Returns false if the draw's output can change without
+    // any of that state changing (e.g., it reads RenderBuffers), in which case its frame can never
+    // be skipped.
+    virtual bool hashContent(DrawStreamHash*) const;
+
 protected:
     const PLSTexture* const m_imageTextureRef;
     const IAABB m_pixelBounds;
@@ -101,6 +120,9 @@ protected:
 
     pls::DrawContents m_drawContents = pls::DrawContents::none;
 
+    // Filled in by the subclass constructor, if the draw is an occluder.
+    IAABB m_occluderBounds = {0, 0, 0, 0};
+
     // Filled in by the subclass constructor.
     ResourceCounters m_resourceCounts;
 
@@ -128,6 +150,34 @@ public:
                                  const PLSPaint*,
                                  RawPath* scratchPath);
 
+    // Same as above, but allocates the draw and all of its intermediate data from the given set of
+    // allocators. This variant may be called concurrently from recording threads, as long as each
+    // thread uses its own set of allocators. (See PLSRenderContext::setRecordingThreadCount().)
+    static PLSDrawUniquePtr Make(PLSRenderContext*,
+                                 PLSRenderContext::DrawAllocators*,
+                                 const Mat2D&,
+                                 rcp<const PLSPath>,
+                                 FillRule,
+                                 const PLSPaint*);
+
+    // Creates one draw for each instance of the same path and paint, drawn with the matrix
+    // "viewMatrix * instanceMatrices[i]". If 'instanceColors' is not empty, it holds one color per
+    // instance, which replaces the color of a solid-color paint.
+    //
+    // Instances that get drawn as midpoint fans all share a single path analysis (chops and
+    // tessellation segment counts), made at the largest scale of any instance, instead of
+    // analyzing the path again for each one.
+    static void MakeInstances(PLSRenderContext*,
+                              const Mat2D& viewMatrix,
+                              Span<const Mat2D> instanceMatrices,
+                              Span<const ColorInt> instanceColors,
+                              rcp<const PLSPath>,
+                              FillRule,
+                              const PLSPaint*,
+                              RawPath* scratchPath,
+                              std::vector<PLSDrawUniquePtr>* draws);
+
+    const PLSPath* path() const { return m_pathRef; }
     FillRule fillRule() const { return m_fillRule; }
     pls::PaintType paintType() const { return m_paintType; }
     float strokeRadius() const { return m_strokeRadius; }
@@ -137,14 +187,57 @@ public:
 
     void releaseRefs() override;
 
+    bool hashContent(DrawStreamHash*) const override;
+
+#ifdef DEBUG
+    // Stops guarding the path against mutations before releaseRefs(), once nothing will read it
+    // again (see PLSRenderContext::setPipelinedSubmission()).
+    void unlockRawPathMutations();
+#endif
+
 public:
+    static PLSDrawUniquePtr Make(PLSRenderContext*,
+                                 PLSRenderContext::DrawAllocators*,
+                                 RawPath* scratchPath,
+                                 const Mat2D&,
+                                 rcp<const PLSPath>,
+                                 FillRule,
+                                 const PLSPaint*);
+
+    // If 'forceFill' is true, the path is filled even if the paint is stroked. (Used by tiny-path
+    // LOD draws, whose path has already been collapsed to a coverage-equivalent rectangle.)
     PLSPathDraw(IAABB pathBounds,
                 const Mat2D&,
                 rcp<const PLSPath>,
                 FillRule,
                 const PLSPaint*,
                 Type,
-                pls::InterlockMode);
+                pls::InterlockMode,
+                bool forceFill = false);
+
+    // Returns a single-patch, coverage-equivalent dot if the path is small enough for the frame's
+    // FrameDescriptor::tinyPathLODPixelSize (which never exceeds a pixel), otherwise null.
+    static PLSDrawUniquePtr MakeTinyPathLODDraw(PLSRenderContext*,
+                                                PLSRenderContext::DrawAllocators*,
+                                                const AABB& mappedBounds,
+                                                const Mat2D&,
+                                                const PLSPath*,
+                                                const PLSPaint*);
+
+    // Returns a draw of the given color if the path is a solid-color, axis-aligned rectangle fill,
+    // otherwise null. These skip path analysis entirely: the frame either draws them as a
+    // SolidRectDraw (no tessellation), or, if it can't, as an instance of the allocators' shared
+    // unit-rect analysis.
+    static PLSDrawUniquePtr MakeSolidRectDraw(PLSRenderContext*,
+                                              PLSRenderContext::DrawAllocators*,
+                                              const AABB& mappedBounds,
+                                              const Mat2D&,
+                                              const PLSPath*,
+                                              const PLSPaint*,
+                                              ColorInt);
+
+    // Replaces the color of a solid-color paint, e.g., for a path instance.
+    void setSolidColor(ColorInt);
 
     virtual void onPushToRenderContext(PLSRenderContext::LogicalFlush*) = 0;
 
@@ -156,21 +249,76 @@ public:
 
     // Used to guarantee m_pathRef doesn't change for the entire time we hold it.
     RIVE_DEBUG_CODE(size_t m_rawPathMutationID;)
+    RIVE_DEBUG_CODE(bool m_holdsRawPathMutationLock = true;)
 };
 
 // Draws a path by fanning tessellation patches around the midpoint of each contour.
 class MidpointFanPathDraw : public PLSPathDraw
 {
 public:
+    // If 'retainedData' is not null, the path analysis is restored from it when it matches this
+    // draw, or saved to it for future frames if the same draw has now been seen twice in a row.
     MidpointFanPathDraw(PLSRenderContext*,
+                        PLSRenderContext::DrawAllocators*,
                         IAABB pixelBounds,
                         const Mat2D&,
                         rcp<const PLSPath>,
                         FillRule,
+                        const PLSPaint*,
+                        RetainedMidpointFanData* retainedData = nullptr,
+                        bool forceFill = false);
+
+    // Creates another instance of 'prototype', with a different matrix and paint, that reuses its
+    // path analysis instead of recomputing it. The prototype's stroke and fill must match this
+    // draw's, and its matrix scale must be at least as large as this one's.
+    MidpointFanPathDraw(PLSRenderContext*,
+                        const MidpointFanPathDraw& prototype,
+                        IAABB pixelBounds,
+                        const Mat2D&,
                         const PLSPaint*);
 
+    // Only valid if the draw is stroked.
+    StrokeJoin strokeJoin() const { return m_strokeJoin; }
+    StrokeCap strokeCap() const { return m_strokeCap; }
+
+    bool hashContent(DrawStreamHash*) const override;
+
 protected:
-    void onPushToRenderContext(PLSRenderContext::LogicalFlush*) override;
+    friend struct RetainedMidpointFanData;
+
+    // Totals from the path analysis done by the constructor.
+    struct PathCounts
+    {
+        size_t lineCount;
+        size_t unpaddedCurveCount;
+        size_t unpaddedRotationCount;
+        size_t paddedCurveCount;
+        size_t paddedRotationCount;
+        size_t emptyStrokeCountForCaps;
+        size_t tessVertexCount;
+    };
+
+    // Does the key in the given retained data match this draw?
+    bool matchesRetainedData(const RetainedMidpointFanData&) const;
+
+    // Sets the key in the given retained data to match this draw and drops its analysis.
+    void rekeyRetainedData(RetainedMidpointFanData*) const;
+
+    void restoreFromRetainedData(PLSRenderContext::DrawAllocators*,
+                                 const RetainedMidpointFanData&,
+                                 size_t contourCount);
+    void saveToRetainedData(RetainedMidpointFanData*, size_t contourCount, const PathCounts&) const;
+
+    // Points this draw's analysis at the prototype's, which must have been built with the same
+    // key (path, 2x2 matrix, and stroke).
+    void referenceAnalysis(const MidpointFanPathDraw& prototype);
+
+    // Records the final counts of the path analysis in m_resourceCounts.
+    void setPathCounts(size_t contourCount, const PathCounts&);
+
+    // Totals from setPathCounts(), for instances that share this draw's analysis.
+    size_t m_contourCount;
+    PathCounts m_pathCounts;
 
     // Emulates a stroke cap before the given cubic by pushing a copy of the cubic, reversed, with 0
     // tessellation segments leading up to the join section, and a 180-degree join that looks like
@@ -180,6 +328,9 @@ protected:
                                                 uint32_t emulatedCapAsJoinFlags,
                                                 uint32_t strokeCapSegmentCount);
 
+    // PLSRenderContext::frameParametricPrecision() and framePolarPrecision().
+    float m_parametricPrecision;
+    float m_polarPrecision;
     float m_strokeMatrixMaxScale;
     StrokeJoin m_strokeJoin;
     StrokeCap m_strokeCap;
@@ -217,6 +368,36 @@ protected:
     RIVE_DEBUG_CODE(size_t m_pendingEmptyStrokeCountForCaps;)
 };
 
+// Path analysis from a MidpointFanPathDraw (chops and tessellation segment counts) that is
+// retained across frames by the render context. Static content can then skip recomputing it when
+// the same, unmutated path gets drawn again with the same stroke and matrix. (Translation is
+// ignored because it doesn't affect the analysis.)
+struct RetainedMidpointFanData
+{
+    // True if everything but the key below is valid.
+    bool hasData = false;
+    // How many frames have been flushed since this data was last used?
+    uint32_t idleFrameCount = 0;
+    // The first draw this frame that matches the key. Later matching draws in the same frame
+    // reference its analysis directly. (Cleared at the end of every frame.)
+    const MidpointFanPathDraw* framePrototype = nullptr;
+
+    // Key. (Doesn't match any draw until MidpointFanPathDraw::rekeyRetainedData().)
+    float matrix2x2[4] = {};
+    float strokeRadius = -1;
+    float parametricPrecision = 0;
+    StrokeJoin strokeJoin = StrokeJoin::miter;
+    StrokeCap strokeCap = StrokeCap::butt;
+
+    std::vector<MidpointFanPathDraw::ContourInfo> contours;
+    std::vector<uint8_t> numChops;
+    std::vector<Vec2D> chopVertices;
+    std::vector<std::array<Vec2D, 2>> tangentPairs;
+    std::vector<uint32_t> polarSegmentCounts;
+    std::vector<uint32_t> parametricSegmentCounts;
+    MidpointFanPathDraw::PathCounts counts;
+};
+
 // Draws a path by triangulating the interior into non-overlapping triangles and tessellating the
 // outer curves.
 class InteriorTriangulationDraw : public PLSPathDraw
@@ -230,15 +411,32 @@ public:
     };
 
     InteriorTriangulationDraw(PLSRenderContext*,
+                              PLSRenderContext::DrawAllocators*,
                               IAABB pixelBounds,
                               const Mat2D&,
                               rcp<const PLSPath>,
                               FillRule,
                               const PLSPaint*,
                               RawPath* scratchPath,
-                              TriangulatorAxis);
+                              TriangulatorAxis,
+                              RetainedInteriorTriangulationData* retainedData = nullptr);
+
+    // The interior may still be triangulating on a background thread. Blocks until it finishes, and
+    // then fills in the remaining resource counts. Must be called before resourceCounts() or
+    // pushInteriorTriangles() are accessed.
+    void joinTriangulation();
+
+    // Writes out the interior triangles, either from the triangulator or from a triangulation
+    // retained from a previous frame. Returns the number of vertices written.
+    size_t pushInteriorTriangles(pls::WriteOnlyMappedMemory<pls::TriangleVertex>*,
+                                 uint16_t pathID) const;
 
-    GrInnerFanTriangulator* triangulator() const { return m_triangulator; }
+    // In depthStencil mode, the outer curves and interior triangles only write the stencil buffer.
+    // The path then gets colored by covering this local-space rectangle.
+    bool usesStencilThenCover() const { return m_usesStencilThenCover; }
+    const AABB& coverBounds() const;
+
+    void releaseRefs() override;
 
 protected:
     void onPushToRenderContext(PLSRenderContext::LogicalFlush*) override;
@@ -254,10 +452,11 @@ protected:
         kPatchSegmentCountExcludingJoin;
 
     static size_t FindSubdivisionCount(const Vec2D pts[],
+                                       float parametricPrecision,
                                        const wangs_formula::VectorXform& vectorXform)
     {
         size_t numSubdivisions =
-            ceilf(wangs_formula::cubic(pts, kParametricPrecision, vectorXform) *
+            ceilf(wangs_formula::cubic(pts, parametricPrecision, vectorXform) *
                   (1.f / kPatchSegmentCountExcludingJoin));
         return std::clamp<size_t>(numSubdivisions, 1, kMaxCurveSubdivisions);
     }
@@ -278,7 +477,80 @@ protected:
                      TriangulatorAxis,
                      PLSRenderContext::LogicalFlush*);
 
-    GrInnerFanTriangulator* m_triangulator = nullptr;
+    // Triangulates the polygon that processPath() built from the path's interior, either inline or
+    // on m_asyncTriangulator. Huge paths get split into bands along the triangulator axis, each
+    // with a triangulator of its own, so the bands can triangulate in parallel.
+    void triangulateInterior(TrivialBlockAllocator*,
+                             const RawPath& interiorPolygon,
+                             TriangulatorAxis);
+
+    // Adds the grout triangles and interior triangles to m_resourceCounts, once m_triangulators (or
+    // m_retainedTriangulation) are ready.
+    void countTriangulatedResources();
+
+    // Does the key in the given retained data match this draw?
+    bool matchesRetainedData(const RetainedInteriorTriangulationData&) const;
+
+    // Sets the key in the given retained data to match this draw and drops its triangulation.
+    void rekeyRetainedData(RetainedInteriorTriangulationData*) const;
+
+    // Saves a copy of m_triangulators' output to m_retainedDataToSave, if there is one.
+    void saveToRetainedData();
+
+    // One triangulator for each band of the interior (usually just one). Allocated from the
+    // per-frame allocator, and not filled in until any background triangulation has been joined.
+    GrInnerFanTriangulator** m_triangulators = nullptr;
+    size_t m_triangulationBandCount = 0;
+
+    // Set instead of m_triangulators when the draw reuses a triangulation from a previous frame.
+    // (Ref'd until releaseRefs().)
+    const RetainedTriangulation* m_retainedTriangulation = nullptr;
+    TriangulatorAxis m_triangulatorAxis;
+    RetainedInteriorTriangulationData* m_retainedDataToSave = nullptr;
+
+    // Non-null while the interior is being triangulated in the background (one job per band).
+    AsyncTriangulator* m_asyncTriangulator = nullptr;
+    AsyncTriangulationJob** m_asyncTriangulations = nullptr;
+
+    // PLSRenderContext::frameParametricPrecision(), captured so both PathOps subdivide alike.
+    float m_parametricPrecision;
+
+    const bool m_usesStencilThenCover;
+
+    // Counted by processPath(PathOp::countDataAndTriangulate).
+    size_t m_contourCount = 0;
+    size_t m_outerCubicPatchCount = 0; // Excluding grout triangles.
+};
+
+// The output of an InteriorTriangulationDraw's triangulator, retained across frames by the render
+// context. Static large fills can then skip re-triangulating when the same, unmutated path gets
+// drawn again with the same matrix. (Translation is ignored because triangulation happens in local
+// space.) Ref counted so draws can keep using it after the retained data gets rekeyed.
+class RetainedTriangulation : public RefCnt<RetainedTriangulation>
+{
+public:
+    std::unique_ptr<pls::TriangleVertex[]> triangles; // Written with a pathID of 0.
+    size_t triangleVertexCount = 0;
+    std::vector<std::array<Vec2D, 3>> groutTriangles;
+    size_t contourCount = 0;
+    size_t outerCubicPatchCount = 0;
+};
+
+struct RetainedInteriorTriangulationData
+{
+    // How many frames have been flushed since this data was last used?
+    uint32_t idleFrameCount = 0;
+
+    // Key. (Doesn't match any draw until InteriorTriangulationDraw::rekeyRetainedData().)
+    float matrix2x2[4] = {};
+    float parametricPrecision = 0;
+    FillRule fillRule = FillRule::nonZero;
+    InteriorTriangulationDraw::TriangulatorAxis triangulatorAxis =
+        InteriorTriangulationDraw::TriangulatorAxis::dontCare;
+    bool usesStencilThenCover = false;
+
+    // Null until the same draw has been seen twice in a row.
+    rcp<const RetainedTriangulation> triangulation;
 };
 
 // Pushes an imageRect to the render context.
@@ -292,16 +564,38 @@ public:
                   const Mat2D&,
                   BlendMode,
                   rcp<const PLSTexture>,
+                  const AABB& texCoordBounds,
                   float opacity);
 
+    // Normalized region of the texture that the image occupies ([0, 0, 1, 1] unless it's atlased).
+    const AABB& texCoordBounds() const { return m_texCoordBounds; }
     float opacity() const { return m_opacity; }
 
     void pushToRenderContext(PLSRenderContext::LogicalFlush*) override;
 
+    bool hashContent(DrawStreamHash*) const override;
+
 protected:
+    const AABB m_texCoordBounds;
     const float m_opacity;
 };
 
+// Pushes a solid-color rectangle to the render context as an imageRect, whose analytic-AA quad
+// needs no tessellation. Only frames that draw imageRects support this draw (see
+// SolidRectDraw::FrameSupports()); other frames draw solid rects as paths.
+class SolidRectDraw : public PLSDraw
+{
+public:
+    static bool FrameSupports(const PLSRenderContext*);
+
+    // 'matrix' maps the rect [0, 0, 1, 1] onto the rectangle to draw.
+    SolidRectDraw(PLSRenderContext*, IAABB pixelBounds, const Mat2D&, BlendMode, ColorInt);
+
+    ColorInt color() const { return m_simplePaintValue.color; }
+
+    void pushToRenderContext(PLSRenderContext::LogicalFlush*) override;
+};
+
 // Pushes an imageMesh to the render context.
 class ImageMeshDraw : public PLSDraw
 {
@@ -310,12 +604,15 @@ public:
                   const Mat2D&,
                   BlendMode,
                   rcp<const PLSTexture>,
+                  const AABB& texCoordBounds,
                   rcp<const RenderBuffer> vertexBuffer,
                   rcp<const RenderBuffer> uvBuffer,
                   rcp<const RenderBuffer> indexBuffer,
                   uint32_t indexCount,
                   float opacity);
 
+    // The mesh's uv coordinates get mapped into this region of the texture.
+    const AABB& texCoordBounds() const { return m_texCoordBounds; }
     const RenderBuffer* vertexBuffer() const { return m_vertexBufferRef; }
     const RenderBuffer* uvBuffer() const { return m_uvBufferRef; }
     const RenderBuffer* indexBuffer() const { return m_indexBufferRef; }
@@ -326,7 +623,11 @@ public:
 
     void releaseRefs() override;
 
+    // RenderBuffer contents can change behind our back, so image meshes are never hashed.
+    bool hashContent(DrawStreamHash*) const override { return false; }
+
 protected:
+    const AABB m_texCoordBounds;
     const RenderBuffer* const m_vertexBufferRef;
     const RenderBuffer* const m_uvBufferRef;
     const RenderBuffer* const m_indexBufferRef;
@@ -351,6 +652,8 @@ public:
 
     void pushToRenderContext(PLSRenderContext::LogicalFlush*) override;
 
+    bool hashContent(DrawStreamHash*) const override;
+
 protected:
     const uint32_t m_previousClipID;
 };
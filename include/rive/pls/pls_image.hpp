@@ -6,7 +6,11 @@
 
 #include "rive/refcnt.hpp"
 #include "rive/renderer.hpp"
+#include "rive/math/aabb.hpp"
 #include "rive/pls/pls_render_context_impl.hpp"
+#include <atomic>
+#include <memory>
+#include <vector>
 
 namespace rive::pls
 {
@@ -22,7 +26,8 @@ public:
     // Quazi-unique identifier of the underlying GPU texture resource managed by this class.
     uint32_t textureResourceHash() const { return m_textureResourceHash; }
 
-    // 64-bit handle that allows shaders to sample this texture without a texture binding.
+    // 64-bit handle that allows shaders to sample this texture without a texture binding. (On
+    // Vulkan, an index into the context's bindless texture table.)
     // Only supported if PlatformFeatures::supportsBindlessTextures is set, otherwise 0.
     uint64_t bindlessTextureHandle() const { return m_bindlessTextureHandle; }
 
@@ -33,6 +38,118 @@ protected:
     uint64_t m_bindlessTextureHandle = 0;
 };
 
+// Shared texture that many small images get packed into, so consecutive draws of different images
+// can bind the same texture and land in the same DrawBatch. Pixels accumulate on the CPU until the
+// page is drawn for the first time, at which point it gets uploaded and can't accept any more
+// images. (See PLSRenderContext::setImageAtlasEnabled().)
+class PLSImageAtlasPage : public RefCnt<PLSImageAtlasPage>
+{
+public:
+    constexpr static uint32_t kSize = 1024;
+    // Largest width or height of an image that can go in an atlas.
+    constexpr static uint32_t kMaxImageSize = 256;
+    // Edge pixels are replicated this far out around each image, so bilinear filtering doesn't
+    // bleed into neighbors for the first few mip levels.
+    constexpr static uint32_t kPadding = 4;
+    // Only generate the mip levels that kPadding protects. (Atlased images are meant to be drawn
+    // near their native size.)
+    constexpr static uint32_t kMipLevelCount = 3;
+
+    PLSImageAtlasPage();
+
+    bool isFrozen() const { return m_texture != nullptr; }
+
+    // Copies 'imageDataRGBA' into the page. Returns false if there isn't room or the page is
+    // already frozen; otherwise writes the normalized region it landed in to 'texCoordBounds'.
+    bool addImage(uint32_t width,
+                  uint32_t height,
+                  const uint8_t imageDataRGBA[],
+                  AABB* texCoordBounds);
+
+    // Uploads the page and frees its CPU pixels, if it hasn't been uploaded already.
+    const PLSTexture* texture(PLSRenderContextImpl*);
+
+private:
+    struct Shelf
+    {
+        uint32_t y;
+        uint32_t height;
+        uint32_t width; // Horizontal space used so far.
+    };
+
+    std::vector<uint8_t> m_pixels;
+    std::vector<Shelf> m_shelves;
+    uint32_t m_shelvesHeight = 0;
+    rcp<PLSTexture> m_texture;
+};
+
+// Residency state for an image whose resolution is streamed in based on how large it actually gets
+// drawn. A small "thumbnail" texture stays resident at all times. PLSRenderContext decodes a
+// sharper "detail" texture in the background once the image gets drawn at a scale that needs it,
+// and drops it again under memory pressure. (See PLSRenderContext::setImageStreamingEnabled().)
+//
+// Resolutions are expressed as mip levels of the original image: level L is (width >> L, height
+// >> L).
+class PLSImageStreamingState
+{
+public:
+    // The thumbnail is the first mip level whose width and height are both within this size.
+    constexpr static uint32_t kThumbnailSize = 64;
+
+    PLSImageStreamingState(uint32_t width,
+                           uint32_t height,
+                           std::vector<uint8_t> encodedBytes,
+                           rcp<PLSTexture> thumbnailTexture,
+                           uint32_t thumbnailLevel);
+
+    uint32_t width() const { return m_width; }
+    uint32_t height() const { return m_height; }
+    // Immutable, so the decode threads may read it without any locking.
+    const std::vector<uint8_t>& encodedBytes() const { return m_encodedBytes; }
+    uint32_t thumbnailLevel() const { return m_thumbnailLevel; }
+
+    // Level of the sharpest texture currently resident.
+    uint32_t residentLevel() const
+    {
+        return m_detailTexture != nullptr ? m_detailLevel : m_thumbnailLevel;
+    }
+    const PLSTexture* texture() const
+    {
+        return m_detailTexture != nullptr ? m_detailTexture.get() : m_thumbnailTexture.get();
+    }
+    // GPU memory held by the detail texture, which is what gets evicted under memory pressure.
+    size_t detailSizeInBytes() const;
+
+    // Records that the image was drawn with the given number of screen pixels per image texel.
+    // Thread safe, so recording threads can call it concurrently.
+    void noteDraw(float pixelsPerTexel);
+
+    // Returns the sharpest level requested by noteDraw() since the previous call, or
+    // thumbnailLevel() + 1 if the image hasn't been drawn.
+    uint32_t takeRequestedLevel() { return m_requestedLevel.exchange(m_thumbnailLevel + 1); }
+
+    void setDetailTexture(rcp<PLSTexture> texture, uint32_t level)
+    {
+        m_detailTexture = std::move(texture);
+        m_detailLevel = level;
+    }
+    void evictDetailTexture() { m_detailTexture = nullptr; }
+
+    // Bookkeeping for PLSRenderContext.
+    uint64_t lastDrawnFrame = 0;
+    bool decodePending = false;
+
+private:
+    const uint32_t m_width;
+    const uint32_t m_height;
+    const std::vector<uint8_t> m_encodedBytes;
+    const rcp<PLSTexture> m_thumbnailTexture;
+    const uint32_t m_thumbnailLevel;
+    rcp<PLSTexture> m_detailTexture;
+    uint32_t m_detailLevel = 0;
+    std::atomic<uint32_t> m_requestedLevel;
+};
+
 class PLSImage : public lite_rtti_override<RenderImage, PLSImage>
 {
 public:
@@ -41,10 +158,69 @@ public:
         resetTexture(std::move(texture));
     }
 
+    // Creates an image that occupies 'texCoordBounds' (normalized) within an atlas page.
+    PLSImage(uint32_t width,
+             uint32_t height,
+             rcp<PLSImageAtlasPage> atlasPage,
+             const AABB& texCoordBounds) :
+        PLSImage(width, height)
+    {
+        m_atlasPage = std::move(atlasPage);
+        m_texCoordBounds = texCoordBounds;
+    }
+
+    // Creates an image whose resolution is streamed in as it gets drawn.
+    PLSImage(std::shared_ptr<PLSImageStreamingState> streamingState) :
+        PLSImage(streamingState->width(), streamingState->height())
+    {
+        m_streamingState = std::move(streamingState);
+    }
+
+    // Null if the image lives in an atlas page or is streamed (see drawTexture()).
     rcp<PLSTexture> refTexture() const { return m_texture; }
     const PLSTexture* getTexture() const { return m_texture.get(); }
 
+    // Returns the texture to bind when drawing this image, uploading its atlas page if needed.
+    const PLSTexture* drawTexture(PLSRenderContextImpl* impl) const
+    {
+        if (m_atlasPage != nullptr)
+        {
+            return m_atlasPage->texture(impl);
+        }
+        if (m_streamingState != nullptr)
+        {
+            return m_streamingState->texture();
+        }
+        return m_texture.get();
+    }
+
+    // Does drawTexture() still have to upload this image's atlas page?
+    bool needsUpload() const { return m_atlasPage != nullptr && !m_atlasPage->isFrozen(); }
+
+    // Informs mip streaming how many screen pixels each texel of this image covered in a draw.
+    void noteDrawScale(float pixelsPerTexel) const
+    {
+        if (m_streamingState != nullptr)
+        {
+            m_streamingState->noteDraw(pixelsPerTexel);
+        }
+    }
+
+    // Normalized region of drawTexture() that this image occupies.
+    const AABB& texCoordBounds() const { return m_texCoordBounds; }
+
+    bool isAtlased() const { return m_atlasPage != nullptr; }
+
+    // PLSRenderer draws atlased images as a rectangle in texture coordinates, so their image paint
+    // samples the right region of the page. It gets cached here.
+    RenderPath* atlasRectPath() const { return m_atlasRectPath.get(); }
+    void setAtlasRectPath(rcp<RenderPath> path) const { m_atlasRectPath = std::move(path); }
+
 protected:
+    // PLSLoaderFactory creates images before their textures, then attaches the textures later on
+    // the context's thread.
+    friend class PLSLoaderFactory;
+
     PLSImage(int width, int height)
     {
         m_Width = width;
@@ -63,5 +239,9 @@ protected:
 
 private:
     rcp<PLSTexture> m_texture;
+    rcp<PLSImageAtlasPage> m_atlasPage;
+    std::shared_ptr<PLSImageStreamingState> m_streamingState;
+    AABB m_texCoordBounds = {0, 0, 1, 1};
+    mutable rcp<RenderPath> m_atlasRectPath;
 };
 } // namespace rive::pls
@@ -11,6 +11,12 @@
 #include "rive/pls/trivial_block_allocator.hpp"
 #include "rive/shapes/paint/color.hpp"
 #include <array>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <string_view>
 #include <unordered_map>
 
 class PushRetrofittedTrianglesGMDraw;
@@ -23,19 +29,29 @@ class RawPath;
 
 namespace rive::pls
 {
+class AsyncImageDecoder;
+class AsyncTriangulator;
+class PLSLoaderFactory;
+class SubmissionThread;
+struct AsyncImageDecodeJob;
 class GradientLibrary;
 class IntersectionBoard;
 class ImageMeshDraw;
 class ImageRectDraw;
 class InteriorTriangulationDraw;
 class MidpointFanPathDraw;
+class SolidRectDraw;
 class StencilClipReset;
 class PLSDraw;
 class PLSGradient;
+class PLSImageAtlasPage;
+class PLSImageStreamingState;
 class PLSPaint;
 class PLSPath;
 class PLSPathDraw;
 class PLSRenderContextImpl;
+struct RetainedMidpointFanData;
+struct RetainedInteriorTriangulationData;
 
 // Used as a key for complex gradients.
 class GradientContentKey
@@ -109,10 +125,91 @@ public:
         bool disableRasterOrdering = false; // Use atomic mode in place of rasterOrdering, even if
                                             // rasterOrdering is supported.
 
+        // Choose between rasterOrdering and atomics on every frame, from the statistics of the
+        // previous one (see FrameStats). Atomic mode is faster when draws rarely overlap, but every
+        // group of overlapping draws costs it a barrier, and non-srcOver blend modes disable its
+        // fixed-function blending. Ignored if msaaSampleCount is nonzero, if disableRasterOrdering
+        // is set, or if the backend doesn't support rasterOrdering. (depthStencil is never chosen
+        // automatically, since it renders with MSAA.)
+        bool autoInterlockMode = false;
+
+        // If not empty, the frame only updates pixels inside this rectangle: draws that don't
+        // intersect it are culled, the rest are clipped to it, and the render target is preserved
+        // everywhere else. The client is responsible for redrawing all content that intersects it.
+        // Requires loadAction == LoadAction::preserveRenderTarget.
+        IAABB dirtyBounds = {0, 0, 0, 0};
+
+        // Skip the frame if it's identical to the previous one. The context hashes every draw as
+        // it's pushed (draw type, bounds, matrix, paint, clip, and path or texture identity), and
+        // if the hash, the FrameDescriptor, and the render target all match the previous frame,
+        // flush() drops the draws without doing any layout, uploads, or GPU work, and sets
+        // FrameStats::skippedUnchangedFrame so the client can skip its present too. (The client
+        // must still submit externalCommandBuffer, even though nothing was recorded into it, since
+        // the context waits on the frame's frameCompletionFence.) The target has to still hold the
+        // previous frame, and redrawing the frame on top of it must leave it unchanged: frames
+        // with LoadAction::clear can be skipped, but frames with LoadAction::preserveRenderTarget
+        // are only skipped if an unclipped, opaque draw covers every pixel they update (otherwise
+        // translucent and non-srcOver draws would build up on the preserved pixels). Frames with
+        // LoadAction::dontCare, frames that draw image meshes, and frames that call nextTarget()
+        // are never skipped.
+        bool skipUnchangedFrames = false;
+
+        // Measure how long the GPU spends rendering this frame? (See popGPUFrameTime().)
+        bool measureGPUTime = false;
+
+        // In atomic mode, render each flush as a sequence of scissored passes over coarse
+        // screen-space bins (multiples of the IntersectionBoard's tiles), each of which only
+        // submits the draw batches that touch it. On tiling GPUs this keeps PLS plane traffic
+        // within tile memory for large render targets. Ignored if the backend doesn't support it
+        // (PlatformFeatures::supportsTileBinnedRendering) or the frame isn't in atomic mode.
+        bool tileBinnedRendering = false;
+
+        // Upload tessellation spans in the lossy, 48-byte pls::CompactTessVertexSpan encoding
+        // instead of the 64-byte pls::TessVertexSpan. This cuts the largest per-frame upload by a
+        // quarter, at the cost of fp16 precision in the inner control points of each cubic (in
+        // local path coordinates), so it's best for content that isn't drawn heavily magnified.
+        // Ignored if the backend doesn't support it
+        // (PlatformFeatures::supportsCompactTessVertexSpans).
+        bool compactTessVertexSpans = false;
+
+        // Upload one pls::TessCurve per curve and let the GPU expand it into the (potentially
+        // wrapped and mirrored) rows of pls::TessVertexSpans, instead of writing every span on the
+        // CPU. Ignored if the backend doesn't support it
+        // (PlatformFeatures::supportsGPUTessellationSpans), or if compactTessVertexSpans is in
+        // effect.
+        bool gpuTessellationSpans = false;
+
+        // If nonzero, solid-color paths whose pixel bounds (including stroke outset) are no larger
+        // than this many pixels across draw as a dot with the same coverage area, rather than
+        // being tessellated in full. The dot always fits in a single midpoint fan patch, which
+        // saves tessellation vertices on particle-style content. Clamped to 1 pixel, since the
+        // shape of anything larger is visible; larger paths keep their full geometry.
+        float tinyPathLODPixelSize = 0;
+
+        // Scales kParametricPrecision and kPolarPrecision, in (0, 1]. Lower values tessellate
+        // curves and stroke joins with fewer segments (counts scale with roughly the square root of
+        // this value), trading smoothness for vertex throughput. Multiplied by the quality
+        // governor's current level, if one is enabled (see setTessellationQualityGovernor()).
+        float tessellationQuality = 1;
+
+        // If less than 1, the frame renders into an internal render target this fraction of the
+        // size in each dimension, and flush() upscales it into the client's render target with
+        // bilinear filtering. Coordinates stay in full-resolution pixels. This trades sharpness
+        // for fill rate, and can change on every frame. Ignored if the backend doesn't support it
+        // (PlatformFeatures::supportsResolutionScaling), or if the frame has dirtyBounds or
+        // doesn't clear the render target.
+        float resolutionScale = 1;
+
         // Testing flags.
         bool wireframe = false;
         bool fillsDisabled = false;
         bool strokesDisabled = false;
+
+        // Estimates how many fragments each draw type shades in every tile of the frame, reports
+        // it in FrameStats::overdrawHeatmap, and composites an overlay of the actual per-pixel
+        // overdraw over the frame: every draw's geometry is drawn again in translucent red, so
+        // each pixel gets more opaque the more draws cover it (~20% at 1 draw, ~80% at 8).
+        bool overdrawHeatmap = false;
     };
 
     // Called at the beginning of a frame and establishes where and how it will be rendered.
@@ -120,19 +217,131 @@ public:
     // All rendering related calls must be made between beginFrame() and flush().
     void beginFrame(const FrameDescriptor&);
 
+    // Increments on every call to beginFrame().
+    uint64_t frameNumber() const { return m_frameNumber; }
+
+    // CPU-side statistics on a flushed frame, for telemetry.
+    struct FrameStats
+    {
+        struct LogicalFlushStats
+        {
+            size_t drawBatchCount = 0;
+            size_t culledDrawCount = 0; // Draws dropped because they were hidden by occluders.
+            size_t pathCount = 0;
+            size_t contourCount = 0;
+            size_t tessVertexCount = 0;
+            size_t maxTriangleVertexCount = 0; // Upper bound reserved for interior triangulations.
+            uint32_t simpleGradientRowCount = 0;
+            uint32_t complexGradientRowCount = 0;
+            size_t drawCount = 0;
+            uint64_t drawPixelArea = 0; // Sum of the draws' pixel bounds areas.
+            size_t nonSrcOverDrawCount = 0;
+            // Groups of non-overlapping draws. In rasterOrdering, only counted while
+            // FrameDescriptor::autoInterlockMode is considering atomic mode (0 otherwise).
+            size_t drawGroupCount = 0;
+            size_t blendBarrierCount = 0; // PlatformFeatures::khrBlendEquationsNeedBarriers.
+            size_t recycledClipIDCount = 0; // See PLSRenderContext::generateClipID().
+        };
+
+        uint64_t frameNumber = 0;
+
+        // FrameDescriptor::skipUnchangedFrames: the frame matched the previous one, so nothing was
+        // rendered. The remaining stats still describe the most recently rendered frame.
+        bool skippedUnchangedFrame = false;
+
+        pls::InterlockMode interlockMode = pls::InterlockMode::rasterOrdering;
+        uint64_t renderTargetPixelArea = 0;
+
+        // A frame breaks into multiple logical flushes when its draws don't fit in the resource
+        // limits of a single flush (clip IDs, gradient texture, tessellation texture, etc.).
+        std::vector<LogicalFlushStats> logicalFlushes;
+
+        // FrameDescriptor::overdrawHeatmap: fragments shaded per draw type, estimated by binning
+        // each draw's pixel bounds into kTileSize x kTileSize tiles. (Draws that skip the
+        // interior of their bounds, like strokes and outer curve patches, are overestimated.)
+        struct OverdrawHeatmap
+        {
+            constexpr static uint32_t kTileSize = 16;
+            constexpr static size_t kDrawTypeCount =
+                static_cast<size_t>(pls::DrawType::stencilClipReset) + 1;
+
+            uint32_t tilesWide = 0;
+            uint32_t tilesTall = 0;
+
+            // Indexed by pls::DrawType. Each grid is tilesWide x tilesTall fragment counts, in
+            // row-major order, or empty if the frame had no draws of that type.
+            std::array<std::vector<uint32_t>, kDrawTypeCount> tileFragmentCounts;
+            std::array<uint64_t, kDrawTypeCount> fragmentCounts{};
+            uint64_t totalFragmentCount = 0;
+            uint32_t maxTileFragmentsPerPixel = 0; // Rounded down.
+        };
+        OverdrawHeatmap overdrawHeatmap;
+
+        // Sums over all logical flushes.
+        size_t drawBatchCount = 0;
+        size_t culledDrawCount = 0;
+        size_t tessVertexCount = 0;
+        size_t gradientRowCount = 0;
+        size_t drawCount = 0;
+        uint64_t drawPixelArea = 0;
+        size_t nonSrcOverDrawCount = 0;
+        size_t drawGroupCount = 0;
+        size_t blendBarrierCount = 0;
+        size_t recycledClipIDCount = 0;
+        float tessellationQuality = 1; // Effective quality the frame was tessellated with.
+
+        // Number of bytes mapped (and written) in each buffer ring.
+        size_t flushUniformBytes = 0;
+        size_t imageDrawUniformBytes = 0;
+        size_t pathBytes = 0;
+        size_t paintBytes = 0;
+        size_t paintAuxBytes = 0;
+        size_t contourBytes = 0;
+        size_t simpleColorRampBytes = 0;
+        size_t gradSpanBytes = 0;
+        size_t tessSpanBytes = 0;
+        size_t triangleVertexBytes = 0;
+        size_t totalMappedBytes = 0;
+    };
+
+    // Statistics on the most recently flushed frame.
+    const FrameStats& lastFrameStats() const { return m_lastFrameStats; }
+
+    // Retrieves the GPU execution time of an earlier frame that set
+    // FrameDescriptor::measureGPUTime, once the GPU has finished it. GPU times arrive in frame
+    // order, typically a few frames late. Returns false if no new measurements are available, or
+    // if the backend doesn't support GPU timers (currently GL, Vulkan, and Metal do).
+    bool popGPUFrameTime(pls::GPUFrameTime*);
+
     const FrameDescriptor& frameDescriptor() const
     {
         assert(m_didBeginFrame);
         return m_frameDescriptor;
     }
 
-    // True if bounds is empty or outside [0, 0, renderTargetWidth, renderTargetHeight].
+    // True if bounds is empty or outside [0, 0, renderTargetWidth, renderTargetHeight], or outside
+    // the frame's dirtyBounds (if any).
     bool isOutsideCurrentFrame(const IAABB& pixelBounds);
 
+    // True if the current frame only updates the pixels inside FrameDescriptor::dirtyBounds.
+    bool frameHasDirtyBounds() const
+    {
+        assert(m_didBeginFrame);
+        return !m_frameDescriptor.dirtyBounds.empty();
+    }
+
+    // Returns a screen-space clipRect for the frame's dirtyBounds, or null if the frame doesn't
+    // have dirty bounds or doesn't support clipRects.
+    const pls::ClipRectInverseMatrix* frameDirtyBoundsClipRect();
+
     // True if the current frame supports draws with clipRects (clipRectInverseMatrix != null).
     // If false, all clipping must be done with clipPaths.
     bool frameSupportsClipRects() const;
 
+    // True if the current frame's clipRects may also have rounded corners. (Hardware clip planes
+    // can't round corners off, so this is false for InterlockMode::depthStencil.)
+    bool frameSupportsRoundedClipRects() const;
+
     // If the frame doesn't support image paints, the client must draw images with pushImageRect().
     // If it DOES support image paints, the client CANNOT use pushImageRect(); it should draw images
     // as rectangular paths with an image paint.
@@ -140,9 +349,35 @@ public:
 
     const pls::InterlockMode frameInterlockMode() const { return m_frameInterlockMode; }
 
+    // Tessellation precisions for the current frame: kParametricPrecision and kPolarPrecision,
+    // scaled by FrameDescriptor::tessellationQuality and the quality governor.
+    float frameParametricPrecision() const { return m_frameParametricPrecision; }
+    float framePolarPrecision() const { return m_framePolarPrecision; }
+
+    // Maps the client's full-resolution pixels to the current frame's render target. (A scale, if
+    // the frame honors FrameDescriptor::resolutionScale; otherwise identity.)
+    bool frameIsResolutionScaled() const { return m_resolutionScaleRenderTarget != nullptr; }
+    const Mat2D& frameResolutionScaleMatrix() const { return m_frameResolutionScaleMatrix; }
+
+    // True if the current frame renders its flushes in tile bins (see
+    // FrameDescriptor::tileBinnedRendering).
+    bool frameUsesTileBinnedRendering() const;
+
+    // True if the current frame uploads pls::CompactTessVertexSpans (see
+    // FrameDescriptor::compactTessVertexSpans).
+    bool frameUsesCompactTessVertexSpans() const;
+
+    // True if the current frame uploads pls::TessCurves for the GPU to expand (see
+    // FrameDescriptor::gpuTessellationSpans).
+    bool frameUsesGPUTessellationSpans() const;
+
     // Generates a unique clip ID that is guaranteed to not exist in the current clip buffer, and
     // assigns a contentBounds to it.
     //
+    // Once every ID in the flush has been handed out, an ID may be recycled from a dead clip (one
+    // that is neither the clip content ID nor the most recently generated clip) whose footprint in
+    // the clip buffer is disjoint from 'contentBounds'.
+    //
     // Returns 0 if a unique ID could not be generated, at which point the caller must issue a
     // logical flush and try again.
     uint32_t generateClipID(const IAABB& contentBounds);
@@ -156,7 +391,11 @@ public:
     }
 
     // Mark the given clip as being read from within a screen-space bounding box.
-    void addClipReadBounds(uint32_t clipID, const IAABB& bounds)
+    //
+    // Returns false if the clip's ID was recycled and 'bounds' touch pixels where an earlier clip
+    // with the same ID might still be in the clip buffer, at which point the caller must issue a
+    // logical flush and try again.
+    [[nodiscard]] bool addClipReadBounds(uint32_t clipID, const IAABB& bounds)
     {
         assert(m_didBeginFrame);
         assert(!m_logicalFlushes.empty());
@@ -195,6 +434,12 @@ public:
     // rotate/synchronize the buffer rings.
     void logicalFlush();
 
+    // Invokes fn(threadIdx, i) for every i in [0, count), distributing the calls across
+    // recordingThreadCount() threads. threadIdx must be unique to each concurrently running thread
+    // and less than recordingThreadCount(). Must not return until every call has completed.
+    using ParallelForFn =
+        std::function<void(size_t count, const std::function<void(size_t threadIdx, size_t i)>&)>;
+
     // GPU resources required to execute the GPU commands for a frame.
     struct FlushResources
     {
@@ -208,67 +453,296 @@ public:
 
         // Fence that will be signalled once "externalCommandBuffer" finishes executing.
         pls::CommandBufferCompletionFence* frameCompletionFence = nullptr;
+
+        // Optional. When provided, and there are recording threads, frames that got split into
+        // multiple logical flushes write each flush's data into the mapped GPU buffers in
+        // parallel. (Every logical flush is assigned its own range of each buffer up front, during
+        // layout.) The draws within one logical flush are still written serially, so this does
+        // nothing for frames that fit in a single flush.
+        ParallelForFn parallelFor;
     };
 
     // Submits all GPU commands that have been built up since beginFrame().
     void flush(const FlushResources&);
 
+    // Finishes the draws made since beginFrame() (or the previous nextTarget()) into
+    // 'renderTarget', and starts drawing the next target of the same frame. This lets many small
+    // targets (e.g., thumbnails) share a single layout, buffer map/unmap, and submission, instead
+    // of paying for a full frame each. The draws made after the final nextTarget() go into the
+    // renderTarget passed to flush().
+    //
+    // Every target must match the FrameDescriptor's dimensions, and gets its loadAction and
+    // clearColor. 'renderTarget' must stay alive until flush(). Not supported with
+    // FrameDescriptor::resolutionScale or during beginLayer().
+    void nextTarget(PLSRenderTarget* renderTarget);
+
+    // Offscreen layers render a frame into a new texture instead of a client render target, so
+    // complex content that rarely changes can be rasterized once and then drawn on later frames as
+    // an image (e.g., wrapped in a PLSImage for drawImage() or an image paint).
+    //
+    // beginLayer() begins a frame whose draws go into a width x height layer, cleared to
+    // 'clearColor'. It must not be called between beginFrame() and flush(), and layers don't nest.
+    // Returns false, without beginning a frame, if the backend doesn't support layers.
+    bool beginLayer(uint32_t width, uint32_t height, ColorInt clearColor = 0);
+
+    // Flushes the frame begun by beginLayer() and returns the layer's texture, which the client can
+    // keep and draw for as many frames as it likes. 'flushResources' supplies the command buffer
+    // and fence on backends that need them; its renderTarget is ignored.
+    rcp<PLSTexture> endLayer(const FlushResources& flushResources = {});
+
     // Called when the client will stop rendering. Releases all CPU and GPU resources associated
     // with this render context.
     void releaseResources();
 
+    // Begins compiling the given shader variants ahead of time (e.g., during a splash screen), so
+    // the first frames that need them don't stall. Variants for interlock modes the platform
+    // doesn't support are ignored.
+    void precompileShaders(Span<const pls::ShaderVariant>);
+
+    // When enabled, the context records every distinct shader variant it flushes. (A warmup list
+    // for precompileShaders() can be captured this way during a representative session.)
+    void setRecordsShaderVariants(bool enabled) { m_recordsShaderVariants = enabled; }
+    std::vector<pls::ShaderVariant> recordedShaderVariants() const;
+    void clearRecordedShaderVariants() { m_recordedShaderVariants.clear(); }
+
+    // Block allocators for PLSDraws and their intermediate path processing buffers. All memory in
+    // these allocators is dropped at the end of every frame. (Memory is preserved between logical
+    // flushes.)
+    //
+    // These allocators are not thread safe. The context owns one set for the thread that calls
+    // beginFrame() and flush(), and an additional set for each recording thread (see
+    // setRecordingThreadCount()).
+    class DrawAllocators
+    {
+    public:
+        DrawAllocators();
+        ~DrawAllocators();
+
+        // Returns the TrivialBlockAllocator for PLSDraw objects and other trivially-destructible
+        // data that needs to persist until the current frame has completed.
+        TrivialBlockAllocator& perFrameAllocator() { return m_perFrameAllocator; }
+
+        // Allocators for intermediate path processing buffers.
+        TrivialArrayAllocator<uint8_t>& numChopsAllocator() { return m_numChopsAllocator; }
+        TrivialArrayAllocator<Vec2D>& chopVerticesAllocator() { return m_chopVerticesAllocator; }
+        TrivialArrayAllocator<std::array<Vec2D, 2>>& tangentPairsAllocator()
+        {
+            return m_tangentPairsAllocator;
+        }
+        TrivialArrayAllocator<uint32_t, alignof(float4)>& polarSegmentCountsAllocator()
+        {
+            return m_polarSegmentCountsAllocator;
+        }
+        TrivialArrayAllocator<uint32_t, alignof(float4)>& parametricSegmentCountsAllocator()
+        {
+            return m_parametricSegmentCountsAllocator;
+        }
+
+        // Used to build coarse path interiors for the "interior triangulation" algorithm.
+        RawPath* scratchPath() { return m_scratchPath.get(); }
+
+        // Path analysis of the context's unit rect, built lazily by PLSPathDraw and shared by
+        // every solid-color rectangle fill made with these allocators. Never pushed.
+        PLSDrawUniquePtr& unitRectPrototype() { return m_unitRectPrototype; }
+
+        // Drops all memory that was allocated for the current frame.
+        void reset();
+
+    private:
+        constexpr static size_t kPerFlushAllocatorInitialBlockSize = 1024 * 1024; // 1 MiB.
+        TrivialBlockAllocator m_perFrameAllocator{kPerFlushAllocatorInitialBlockSize};
+
+        // Allocated from m_perFrameAllocator, so it has to be declared (and destroyed) after it.
+        PLSDrawUniquePtr m_unitRectPrototype;
+
+        constexpr static size_t kIntermediateDataInitialStrokes = 8192;     // * 84 == 688 KiB.
+        constexpr static size_t kIntermediateDataInitialFillCurves = 32768; // * 4 == 128 KiB.
+        TrivialArrayAllocator<uint8_t> m_numChopsAllocator{kIntermediateDataInitialStrokes *
+                                                           4}; // 4 byte per stroke curve.
+        TrivialArrayAllocator<Vec2D> m_chopVerticesAllocator{kIntermediateDataInitialStrokes *
+                                                             4}; // 32 bytes per stroke curve.
+        TrivialArrayAllocator<std::array<Vec2D, 2>> m_tangentPairsAllocator{
+            kIntermediateDataInitialStrokes * 2}; // 32 bytes per stroke curve.
+        TrivialArrayAllocator<uint32_t, alignof(float4)> m_polarSegmentCountsAllocator{
+            kIntermediateDataInitialStrokes * 4}; // 16 bytes per stroke curve.
+        TrivialArrayAllocator<uint32_t, alignof(float4)> m_parametricSegmentCountsAllocator{
+            kIntermediateDataInitialFillCurves}; // 4 bytes per fill curve.
+
+        // Heap allocated so that RawPath only needs to be forward declared.
+        std::unique_ptr<RawPath> m_scratchPath;
+    };
+
+    // Allocators for the thread that calls beginFrame() and flush().
+    DrawAllocators& drawAllocators() { return *m_drawAllocators; }
+
     // Returns the context's TrivialBlockAllocator, which is automatically reset at the end of every
     // frame. (Memory in this allocator is preserved between logical flushes.)
     TrivialBlockAllocator& perFrameAllocator()
     {
         assert(m_didBeginFrame);
-        return m_perFrameAllocator;
+        return m_drawAllocators->perFrameAllocator();
     }
 
     // Allocators for intermediate path processing buffers.
-    TrivialArrayAllocator<uint8_t>& numChopsAllocator() { return m_numChopsAllocator; }
-    TrivialArrayAllocator<Vec2D>& chopVerticesAllocator() { return m_chopVerticesAllocator; }
+    TrivialArrayAllocator<uint8_t>& numChopsAllocator()
+    {
+        return m_drawAllocators->numChopsAllocator();
+    }
+    TrivialArrayAllocator<Vec2D>& chopVerticesAllocator()
+    {
+        return m_drawAllocators->chopVerticesAllocator();
+    }
     TrivialArrayAllocator<std::array<Vec2D, 2>>& tangentPairsAllocator()
     {
-        return m_tangentPairsAllocator;
+        return m_drawAllocators->tangentPairsAllocator();
     }
     TrivialArrayAllocator<uint32_t, alignof(float4)>& polarSegmentCountsAllocator()
     {
-        return m_polarSegmentCountsAllocator;
+        return m_drawAllocators->polarSegmentCountsAllocator();
     }
     TrivialArrayAllocator<uint32_t, alignof(float4)>& parametricSegmentCountsAllocator()
     {
-        return m_parametricSegmentCountsAllocator;
+        return m_drawAllocators->parametricSegmentCountsAllocator();
     }
 
+    // Reserves a separate set of DrawAllocators for each of 'count' recording threads. Recording
+    // threads may construct PLSDraws in parallel (e.g., PLSPathDraw::Make()) as long as each one
+    // uses its own set of allocators, but only the thread that calls beginFrame() may push the
+    // resulting draws to the context, in the order they were submitted.
+    //
+    // Must not be called between beginFrame() and flush().
+    void setRecordingThreadCount(size_t count);
+    size_t recordingThreadCount() const { return m_recordingThreadAllocators.size(); }
+    DrawAllocators& recordingThreadAllocators(size_t threadIdx)
+    {
+        assert(threadIdx < m_recordingThreadAllocators.size());
+        return *m_recordingThreadAllocators[threadIdx];
+    }
+
+    // Encodes and submits frames on a dedicated thread, so the client can record frame N+1 while
+    // the backend is still encoding frame N. flush() still lays out and writes the frame's GPU
+    // buffers, but then it hands the frozen frame (its logical flushes, plus the DrawAllocators its
+    // PLSDraws live in) to the submission thread, and the next frame records into a second set of
+    // allocators.
+    //
+    // Only takes effect if platformFeatures().supportsPipelinedSubmission, and only for flushes
+    // without an externalCommandBuffer. Until the frame has been submitted, the client must not
+    // modify the render targets or RenderBuffers it used, or access the backend directly, without
+    // calling waitForPendingSubmission() first. (The context waits on its own before it touches the
+    // backend.)
+    //
+    // Must not be called between beginFrame() and flush().
+    void setPipelinedSubmission(bool enabled);
+    bool pipelinedSubmission() const { return m_submissionThread != nullptr; }
+
+    // Blocks until the frame from the most recent flush() has been submitted, then releases its
+    // draws and allocators. Does nothing if there is no frame in flight on the submission thread.
+    void waitForPendingSubmission();
+
     // Allocates a trivially destructible object that will be automatically dropped at the end of
     // the current frame.
     template <typename T, typename... Args> T* make(Args&&... args)
     {
         assert(m_didBeginFrame);
-        return m_perFrameAllocator.make<T>(std::forward<Args>(args)...);
+        return m_drawAllocators->perFrameAllocator().make<T>(std::forward<Args>(args)...);
     }
 
     // Backend-specific PLSFactory implementation.
     rcp<RenderBuffer> makeRenderBuffer(RenderBufferType, RenderBufferFlags, size_t) override;
+    // Also accepts KTX2 files containing one of the pls::CompressedTextureFormats, if the backend
+    // supports it. (See makeCompressedImage().)
     rcp<RenderImage> decodeImage(Span<const uint8_t>) override;
 
-private:
-    friend class PLSDraw;
-    friend class PLSPathDraw;
-    friend class MidpointFanPathDraw;
-    friend class InteriorTriangulationDraw;
-    friend class ImageRectDraw;
-    friend class ImageMeshDraw;
-    friend class StencilClipReset;
-    friend class ::PushRetrofittedTrianglesGMDraw; // For testing.
-    friend class ::PLSRenderContextTest;           // For testing.
+    // Returns a Factory that may be used from any thread, e.g., to load .riv files in the
+    // background while this context keeps rendering. Paths, paints, and gradients are CPU-only
+    // objects and get created right away. Render buffers and images are returned right away too,
+    // but they only stage their contents on the CPU; their backend resources get created on this
+    // context's thread, at the start of the next beginFrame(). (Images are decoded on the calling
+    // thread, and draw nothing until then. They always get their own textures, even with the
+    // image atlas or streaming enabled. Render buffer contents get uploaded the first time they're
+    // drawn after being unmapped, so a buffer may safely be remapped while the loader still owns
+    // it.)
+    //
+    // The objects it creates are not synchronized otherwise: hand them to the rendering thread
+    // once loading is finished, and release them there. Must first be called on the context's
+    // thread, and remains owned by the context.
+    Factory* loaderFactory();
+
+    // Creates an image from pre-compressed GPU data, which stays compressed in GPU memory. 'data'
+    // contains every mip level, tightly packed beginning with the base level. Returns null if the
+    // format isn't supported by platformFeatures(), or if 'data' is the wrong size.
+    rcp<RenderImage> makeCompressedImage(uint32_t width,
+                                         uint32_t height,
+                                         uint32_t mipLevelCount,
+                                         pls::CompressedTextureFormat,
+                                         Span<const uint8_t> data);
+
+    // Decodes an image on a background thread instead of blocking the caller. Once the pixels are
+    // decoded, the texture gets created and 'onDecoded' is invoked on the rendering thread, from
+    // pollAsyncImageDecodes() (or with null if the image failed to decode). KTX2 files don't need
+    // decoding, and should go through decodeImage() instead.
+    using ImageDecodedCallback = std::function<void(rcp<RenderImage>)>;
+    void decodeImageAsync(std::vector<uint8_t> encodedBytes, ImageDecodedCallback onDecoded);
+
+    // Creates textures for images that have finished decoding and invokes their callbacks. In
+    // order to keep frame times steady, this only uploads roughly kMaxAsyncImageUploadBytesPerPoll
+    // worth of pixels, unless 'waitForAll' is true, in which case it blocks until every pending
+    // decode has been delivered. Called automatically at the start of beginFrame().
+    void pollAsyncImageDecodes(bool waitForAll = false);
+    constexpr static size_t kMaxAsyncImageUploadBytesPerPoll = 16 << 20;
+
+    // Number of decodeImageAsync() calls whose callbacks haven't been invoked yet, plus any
+    // background decodes for image streaming (see setImageStreamingEnabled()).
+    size_t pendingAsyncImageDecodeCount() const;
+
+    // When enabled, images decoded by decodeImage() or decodeImageAsync() that are no larger than
+    // PLSImageAtlasPage::kMaxImageSize get packed into shared atlas pages instead of getting their
+    // own textures. Consecutive draws of atlased images then bind the same texture, and can be
+    // combined into the same DrawBatch. This helps icon-heavy content the most, especially on
+    // backends with high per-draw overhead like WebGL.
+    //
+    // A page gets uploaded and can no longer accept images the first time one of its images is
+    // drawn, so it's most effective to load images before drawing them. Atlased images only have
+    // PLSImageAtlasPage::kMipLevelCount mip levels, and image meshes with uv coordinates outside
+    // [0, 1] sample the page's neighboring images instead of clamping.
+    void setImageAtlasEnabled(bool enabled) { m_imageAtlasEnabled = enabled; }
+
+    // When enabled, images decoded by decodeImage() or decodeImageAsync() that are larger than
+    // PLSImageStreamingState::kThumbnailSize keep their encoded bytes on the CPU and only upload a
+    // small thumbnail at first. PLSRenderer reports the scale each image gets drawn at, and
+    // beginFrame() kicks off background decodes for the resolution each one actually needs. Those
+    // arrive a frame or more later. Whenever the streamed textures exceed 'memoryBudgetInBytes',
+    // the least recently drawn ones fall back to their thumbnails.
+    //
+    // This keeps large artboards that only ever get drawn as thumbnails from holding full
+    // resolution textures, at the cost of images sharpening in after they first appear.
+    void setImageStreamingEnabled(bool enabled, size_t memoryBudgetInBytes = 256 << 20)
+    {
+        m_imageStreamingEnabled = enabled;
+        m_imageStreamingMemoryBudget = memoryBudgetInBytes;
+    }
 
-    // Resets the CPU-side STL containers so they don't have unbounded growth.
-    void resetContainers();
+    // When enabled (the default, except on WebGL), large fills drawn on the context's thread get
+    // their interiors triangulated on background threads, starting as soon as the draw is created.
+    // The triangulation is joined once the draw gets pushed.
+    void setAsyncTriangulationEnabled(bool enabled) { m_asyncTriangulationEnabled = enabled; }
+
+    // Frame pacing: limits how many flushed frames may still be executing on the GPU when the next
+    // frame begins. When more than this many are outstanding, beginFrame() blocks on the oldest
+    // FlushResources::frameCompletionFence until enough have retired. 1 gives the lowest latency;
+    // 0 (the default) means "as many as the buffer rings allow", i.e., no extra waiting. Only
+    // frames that were flushed with a frameCompletionFence are tracked.
+    void setMaxFramesInFlight(int maxFramesInFlight);
+    int maxFramesInFlight() const;
+
+    // Blocks until every frame that was flushed with a frameCompletionFence has finished on the
+    // GPU.
+    void waitForFramesInFlight() { retireFramesInFlight(0); }
 
     // Defines the exact size of each of our GPU resources. Computed during flush(), based on
-    // LogicalFlush::ResourceCounters and LogicalFlush::LayoutCounters.
+    // LogicalFlush::ResourceCounters and LogicalFlush::LayoutCounters. Clients may capture these
+    // from currentResourceAllocations() after running an asset, and hand them back to
+    // reserveResources() the next time it loads.
     struct ResourceAllocationCounts
     {
         using VecType = simd::gvec<size_t, 12>;
@@ -303,6 +777,69 @@ private:
         size_t tessTextureHeight = 0;
     };
 
+    ResourceAllocationCounts currentResourceAllocations() const
+    {
+        return m_currentResourceAllocations;
+    }
+
+    // Grows GPU resources to at least 'counts' right away, and keeps them from ever being trimmed
+    // below it, so a known workload doesn't stutter as it reallocates its way up. Must not be
+    // called between beginFrame() and flush(). Pass an empty ResourceAllocationCounts to release
+    // the reservation. (The resources themselves get trimmed back down over time.)
+    void reserveResources(const ResourceAllocationCounts& counts);
+
+    // Controls how GPU resources grow and shrink between flushes.
+    struct ResourceAllocationPolicy
+    {
+        // When a flush outgrows a resource, reallocate it to this multiple of what the flush
+        // needs, in order to create some slack for growth.
+        float growthFactor = 1.25f;
+        // How often to consider trimming resources down to their recent steady-state usage.
+        double trimIntervalInSeconds = 5;
+        // Only trim a resource if its peak usage during the last interval is at most this fraction
+        // of its current allocation.
+        float trimThreshold = 2.f / 3.f;
+        // Trim resources to this multiple of their peak usage during the last interval.
+        float trimmedSizeFactor = 1.25f;
+    };
+    void setResourceAllocationPolicy(const ResourceAllocationPolicy& policy)
+    {
+        m_resourceAllocationPolicy = policy;
+    }
+
+    // Automatically lowers the tessellation quality of upcoming frames while the time between
+    // flushes runs over budget (e.g., on a thermally throttled device), and restores it gradually
+    // once frames fit again.
+    struct TessellationQualityGovernor
+    {
+        double targetFrameSeconds = 0; // 0 disables the governor.
+        // Frames slower than targetFrameSeconds * overBudgetFactor lower the quality.
+        float overBudgetFactor = 1.15f;
+        // Frames faster than targetFrameSeconds * underBudgetFactor raise it.
+        float underBudgetFactor = .9f;
+        float decreaseFactor = .75f; // Multiplies the quality on every slow frame.
+        float increaseStep = .02f;   // Added to the quality on every fast frame.
+        float minQuality = .25f;
+    };
+    void setTessellationQualityGovernor(const TessellationQualityGovernor&);
+
+    // The governor's current quality level, in [minQuality, 1]. (1 if the governor is disabled.)
+    float governedTessellationQuality() const { return m_governedTessellationQuality; }
+
+private:
+    friend class PLSDraw;
+    friend class PLSPathDraw;
+    friend class MidpointFanPathDraw;
+    friend class InteriorTriangulationDraw;
+    friend class ImageRectDraw;
+    friend class ImageMeshDraw;
+    friend class StencilClipReset;
+    friend class ::PushRetrofittedTrianglesGMDraw; // For testing.
+    friend class ::PLSRenderContextTest;           // For testing.
+
+    // Resets the CPU-side STL containers so they don't have unbounded growth.
+    void resetContainers();
+
     // Reallocates GPU resources and updates m_currentResourceAllocations.
     // If forceRealloc is true, every GPU resource is allocated, even if the size would not change.
     void setResourceSizes(ResourceAllocationCounts, bool forceRealloc = false);
@@ -311,24 +848,43 @@ private:
     void unmapResourceBuffers();
 
     const std::unique_ptr<PLSRenderContextImpl> m_impl;
-    const size_t m_maxPathID;
+    const size_t m_maxContourID;
+    size_t m_maxPathID; // Depends on the frame's InterlockMode.
+    const size_t m_maxTessTextureHeight;
+    const size_t m_maxTessVertexCount;
 
     ResourceAllocationCounts m_currentResourceAllocations;
     ResourceAllocationCounts m_maxRecentResourceRequirements;
     double m_lastResourceTrimTimeInSeconds;
+    ResourceAllocationCounts m_reservedResourceAllocations;
+    ResourceAllocationPolicy m_resourceAllocationPolicy;
+
+    // Points the current frame at a reduced-resolution layer for FrameDescriptor::resolutionScale,
+    // unless the backend can't make one.
+    void beginResolutionScaledFrame();
+
+    // Updates m_governedTessellationQuality from the time since the previous flush.
+    void updateTessellationQualityGovernor(double flushTime);
+
+    TessellationQualityGovernor m_tessellationQualityGovernor;
+    float m_governedTessellationQuality = 1;
+    double m_lastFlushTimeInSeconds = 0;
 
     // Per-frame state.
     FrameDescriptor m_frameDescriptor;
     pls::InterlockMode m_frameInterlockMode;
+    pls::InterlockMode m_autoInterlockMode = pls::InterlockMode::rasterOrdering;
+    // Count draw groups in rasterOrdering mode, for chooseAutoInterlockMode().
+    bool m_autoInterlockEstimatesDrawGroups = false;
     pls::ShaderFeatures m_frameShaderFeaturesMask;
+    float m_frameTessellationQuality = 1;
+    float m_frameParametricPrecision = kParametricPrecision;
+    float m_framePolarPrecision = kPolarPrecision;
     RIVE_DEBUG_CODE(bool m_didBeginFrame = false;)
 
     // Clipping state.
     uint32_t m_clipContentID = 0;
-
-    // Used by LogicalFlushes for re-ordering high level draws.
-    std::vector<int64_t> m_indirectDrawList;
-    std::unique_ptr<IntersectionBoard> m_intersectionBoard;
+    const pls::ClipRectInverseMatrix* m_dirtyBoundsClipRect = nullptr;
 
     WriteOnlyMappedMemory<pls::FlushUniforms> m_flushUniformData;
     WriteOnlyMappedMemory<pls::PathData> m_pathData;
@@ -339,28 +895,175 @@ private:
     WriteOnlyMappedMemory<pls::TwoTexelRamp> m_simpleColorRampsData;
     // Complex gradients get rendered by the GPU.
     WriteOnlyMappedMemory<pls::GradientSpan> m_gradSpanData;
+    // Only one of the tessellation span mappings is used in a given frame.
     WriteOnlyMappedMemory<pls::TessVertexSpan> m_tessSpanData;
+    WriteOnlyMappedMemory<pls::CompactTessVertexSpan> m_compactTessSpanData;
+    WriteOnlyMappedMemory<pls::TessCurve> m_tessCurveData;
     WriteOnlyMappedMemory<pls::TriangleVertex> m_triangleVertexData;
     WriteOnlyMappedMemory<pls::ImageDrawUniforms> m_imageDrawUniformData;
 
-    // Simple allocator for trivially-destructible data that needs to persist until the current
-    // frame has completed. All memory in this allocator is dropped at the end of the every frame.
-    constexpr static size_t kPerFlushAllocatorInitialBlockSize = 1024 * 1024; // 1 MiB.
-    TrivialBlockAllocator m_perFrameAllocator{kPerFlushAllocatorInitialBlockSize};
+    // Returns the retained path analysis for the given PLSPath mutation, creating an empty entry if
+    // none exists yet. Mutation IDs are unique to every mutation of every path, so stale entries
+    // can never be hit; they just age out after kMaxRetainedDataIdleFrames.
+    //
+    // Only the thread that calls beginFrame() and flush() may access retained data.
+    RetainedMidpointFanData* retainedMidpointFanData(uint64_t rawPathMutationID);
+    RetainedInteriorTriangulationData* retainedInteriorTriangulationData(
+        uint64_t rawPathMutationID);
+
+    // Drops retained data that hasn't been used in the last kMaxRetainedDataIdleFrames frames.
+    void ageRetainedData();
+
+    constexpr static uint32_t kMaxRetainedDataIdleFrames = 8;
+    std::unordered_map<uint64_t, std::unique_ptr<RetainedMidpointFanData>>
+        m_retainedMidpointFanData;
+    std::unordered_map<uint64_t, std::unique_ptr<RetainedInteriorTriangulationData>>
+        m_retainedInteriorTriangulationData;
+
+    // The [0, 0, 1, 1] rectangle that tiny paths get collapsed into. (See
+    // FrameDescriptor::tinyPathLODPixelSize.) Its lazy properties are all resolved at
+    // construction, so recording threads can share it.
+    rcp<PLSPath> m_unitRectPath;
+
+    // Finds or allocates a slot for the given complex gradient in the persistent gradient atlas,
+    // and marks its row as used by the logical flush identified by 'flushID'. Sets 'needsRender' if
+    // the slot's contents are not yet in the gradient texture and still need to be rendered.
+    //
+    // Returns false if every row of the atlas is already in use by the current logical flush.
+    [[nodiscard]] bool allocateComplexGradientAtlasSlot(const PLSGradient*,
+                                                        uint64_t flushID,
+                                                        pls::ColorRampLocation*,
+                                                        bool* needsRender);
+
+    // Evicts every gradient from the atlas. Called whenever the gradient texture is reallocated.
+    void resetComplexGradientAtlas();
+
+    // Complex color ramps are expensive to render, and tend to be reused from frame to frame, so
+    // they live in a persistent atlas of rows in the gradient texture. Ramps whose stops are far
+    // apart get rendered narrower than the full texture width, and are packed side by side with
+    // other ramps of the same width. Rows are evicted as a whole, in LRU order.
+    struct ComplexGradientAtlasRow
+    {
+        uint32_t rampWidthLog2;
+        uint32_t rampCount;
+        uint64_t lastUsedFlushID;
+        std::list<uint16_t>::iterator lruIter;
+        // Keys of the ramps in this row, from left to right.
+        std::array<const GradientContentKey*, pls::kMaxComplexRampsPerRow> keys;
+    };
+    std::unordered_map<GradientContentKey, pls::ColorRampLocation, DeepHashGradient>
+        m_complexGradientAtlas;
+    std::vector<ComplexGradientAtlasRow> m_complexGradientAtlasRows;
+    std::list<uint16_t> m_complexGradientAtlasLRU; // Row indices, most recently used first.
+    // Partially filled row for each ramp width, or -1. Initialized by resetComplexGradientAtlas().
+    std::array<int32_t, pls::kComplexRampWidthClassCount> m_openComplexGradientAtlasRows;
+    uint64_t m_logicalFlushCount = 0;
+
+    // Adds the shader variants used by a flush to m_recordedShaderVariants.
+    void recordShaderVariants(const pls::FlushDescriptor&);
+
+    // Rewinds the logical flushes and drops the memory of their PLSDraws, once the backend is done
+    // with them.
+    void releaseFrameDraws();
+
+    // FrameDescriptor::skipUnchangedFrames: is the frame being flushed into 'renderTarget' a
+    // repeat of the previous one? Also records the frame's hash for the next one to compare with.
+    bool isUnchangedFrame(const PLSRenderTarget* renderTarget);
+
+    // Does the draw replace every pixel the current frame updates, regardless of what was there?
+    bool drawOverwritesRenderTarget(const PLSDraw*) const;
+
+    // FrameDescriptor::overdrawHeatmap: fills out m_lastFrameStats.overdrawHeatmap from the
+    // frame's draws, then overlays a translucent copy of each draw's coverage on top of them.
+    void drawOverdrawHeatmap();
+
+    // Fills out m_lastFrameStats after the resource buffers are written.
+    void updateFrameStats(const ResourceAllocationCounts& mapCounts);
+
+    // Updates m_autoInterlockMode from m_lastFrameStats, for FrameDescriptor::autoInterlockMode.
+    pls::InterlockMode chooseAutoInterlockMode();
+
+    // Creates an image from decoded RGBA pixels, in the image atlas if it's enabled and there's
+    // room, otherwise in its own texture.
+    rcp<RenderImage> makeImageFromRGBA(uint32_t width,
+                                       uint32_t height,
+                                       const uint8_t imageDataRGBA[]);
+
+    // Creates an image that streams its resolution in, from its encoded bytes and full resolution
+    // decoded pixels (which get downsampled to a thumbnail).
+    rcp<RenderImage> makeStreamedImage(std::vector<uint8_t> encodedBytes, AsyncImageDecodeJob*);
+
+    // Requests sharper textures for streamed images that were drawn large enough last frame, and
+    // evicts detail textures when over budget.
+    void updateStreamedImages();
+
+    AsyncImageDecoder* asyncImageDecoder();
+
+    // Returns null if async triangulation is disabled.
+    AsyncTriangulator* asyncTriangulator();
+
+    uint64_t m_frameNumber = 0;
+    FrameStats m_lastFrameStats;
+
+    // FrameDescriptor::skipUnchangedFrames. m_frameDrawStreamHash accumulates over the current
+    // frame. m_lastFrameHash is the hash of the most recent frame rendered into
+    // m_lastHashedRenderTarget, if that frame was hashable.
+    DrawStreamHash m_frameDrawStreamHash;
+    bool m_frameDrawStreamIsHashable = false;
+    // Does the frame's output not depend on what the render target held before it? True if it
+    // clears, or once it pushes a draw that opaquely covers every pixel it updates.
+    bool m_frameOverwritesRenderTarget = false;
+    const PLSRenderTarget* m_lastHashedRenderTarget = nullptr;
+    uint64_t m_lastFrameHash = 0;
+    bool m_hasLastFrameHash = false;
+
+    // Target of the frame begun by beginLayer(), until endLayer().
+    rcp<PLSRenderTarget> m_layerRenderTarget;
+    rcp<PLSTexture> m_layerTexture;
+
+    // Reduced-resolution layer for FrameDescriptor::resolutionScale. Reused until the scaled size
+    // changes. m_resolutionScaleRenderTarget is only non-null during frames that use it.
+    rcp<PLSRenderTarget> m_resolutionScaleRenderTarget;
+    rcp<PLSRenderTarget> m_cachedResolutionScaleRenderTarget;
+    rcp<PLSTexture> m_resolutionScaleTexture;
+    Mat2D m_frameResolutionScaleMatrix;
+
+    std::unique_ptr<AsyncImageDecoder> m_asyncImageDecoder; // Created on first use.
+    std::unique_ptr<PLSLoaderFactory> m_loaderFactory; // Created on first use.
+
+#ifdef RIVE_WEBGL
+    bool m_asyncTriangulationEnabled = false; // WebGL builds don't have threads.
+#else
+    bool m_asyncTriangulationEnabled = true;
+#endif
+    std::unique_ptr<AsyncTriangulator> m_asyncTriangulator; // Created on first use.
+
+    // Waits on fences from m_inFlightFrameFences until no more than 'maxFrames' remain.
+    void retireFramesInFlight(size_t maxFrames);
+
+    // Adds a flushed frame's FlushResources::frameCompletionFence, if any, to
+    // m_inFlightFrameFences.
+    void trackFrameCompletionFence(pls::CommandBufferCompletionFence*);
+
+    int m_maxFramesInFlight = 0;
+    std::deque<rcp<pls::CommandBufferCompletionFence>> m_inFlightFrameFences; // Oldest first.
+
+    bool m_imageAtlasEnabled = false;
+    rcp<PLSImageAtlasPage> m_openImageAtlasPage; // Page that new atlased images get added to.
+
+    bool m_imageStreamingEnabled = false;
+    size_t m_imageStreamingMemoryBudget = 0;
+    std::vector<std::weak_ptr<PLSImageStreamingState>> m_streamedImages;
 
-    // Allocators for intermediate path processing buffers.
-    constexpr static size_t kIntermediateDataInitialStrokes = 8192;     // * 84 == 688 KiB.
-    constexpr static size_t kIntermediateDataInitialFillCurves = 32768; // * 4 == 128 KiB.
-    TrivialArrayAllocator<uint8_t> m_numChopsAllocator{kIntermediateDataInitialStrokes *
-                                                       4}; // 4 byte per stroke curve.
-    TrivialArrayAllocator<Vec2D> m_chopVerticesAllocator{kIntermediateDataInitialStrokes *
-                                                         4}; // 32 bytes per stroke curve.
-    TrivialArrayAllocator<std::array<Vec2D, 2>> m_tangentPairsAllocator{
-        kIntermediateDataInitialStrokes * 2}; // 32 bytes per stroke curve.
-    TrivialArrayAllocator<uint32_t, alignof(float4)> m_polarSegmentCountsAllocator{
-        kIntermediateDataInitialStrokes * 4}; // 16 bytes per stroke curve.
-    TrivialArrayAllocator<uint32_t, alignof(float4)> m_parametricSegmentCountsAllocator{
-        kIntermediateDataInitialFillCurves}; // 4 bytes per fill curve.
+    bool m_recordsShaderVariants = false;
+    std::map<uint32_t, pls::ShaderVariant> m_recordedShaderVariants; // Keyed by ShaderUniqueKey.
+
+    // Allocators for the thread that calls beginFrame() and flush(). (Heap allocated so pipelined
+    // submission can trade them for the set that belonged to the previous frame.)
+    std::unique_ptr<DrawAllocators> m_drawAllocators = std::make_unique<DrawAllocators>();
+
+    // Additional allocators for recording threads that construct PLSDraws in parallel.
+    std::vector<std::unique_ptr<DrawAllocators>> m_recordingThreadAllocators;
 
     // Manages a list of high-level PLSDraws and their required resources.
     //
@@ -389,6 +1092,33 @@ private:
             return m_flushDesc;
         }
 
+        // PLSRenderContext::nextTarget(): renders this flush into 'renderTarget' instead of
+        // FlushResources::renderTarget.
+        void setRenderTarget(PLSRenderTarget* renderTarget) { m_renderTarget = renderTarget; }
+
+        // PLSRenderContext::nextTarget(): this flush loads its target with the frame's loadAction
+        // instead of preserving the previous flush's contents.
+        void setIsFirstFlushOfTarget() { m_isFirstFlushOfTarget = true; }
+
+        // Reports telemetry for this flush. Only valid after writeResources().
+        void getStats(FrameStats::LogicalFlushStats*) const;
+
+        // Bins this flush's draws into the heatmap, for FrameDescriptor::overdrawHeatmap, and
+        // appends each draw that touches the render target to 'visibleDraws'. Only valid before
+        // layoutResources().
+        void accumulateOverdrawHeatmap(FrameStats::OverdrawHeatmap*,
+                                       std::vector<const PLSDraw*>* visibleDraws) const;
+
+        // Submits this flush to the backend: either desc() as a single pass, or one pass per
+        // tile bin if the frame uses tile-binned rendering. Only valid after writeResources().
+        void submit(PLSRenderContextImpl*);
+
+#ifdef DEBUG
+        // Lets the client mutate this flush's paths again while its PLSDraws are still alive.
+        // Only valid after writeResources(), which is the last time the paths get read.
+        void unlockRawPathMutations();
+#endif
+
         // Generates a unique clip ID that is guaranteed to not exist in the current clip buffer.
         //
         // Returns 0 if a unique ID could not be generated, at which point the caller must issue a
@@ -400,7 +1130,7 @@ private:
             ClipInfo(const IAABB& contentBounds_) : contentBounds(contentBounds_) {}
 
             // Screen-space bounding box of the region inside the clip.
-            const IAABB contentBounds;
+            IAABB contentBounds;
 
             // Union of screen-space bounding boxes from all draws that read the clip.
             //
@@ -410,12 +1140,18 @@ private:
                                 std::numeric_limits<int32_t>::max(),
                                 std::numeric_limits<int32_t>::min(),
                                 std::numeric_limits<int32_t>::min()};
+
+            // If the ID was recycled, the union of contentBounds from the earlier clips that used
+            // it. The clip buffer may still hold this ID anywhere in here, so the clip can't be
+            // read in this region.
+            IAABB staleBounds = readBounds;
         };
 
         const ClipInfo& getClipInfo(uint32_t clipID) { return getWritableClipInfo(clipID); }
 
-        // Mark the given clip as being read from within a screen-space bounding box.
-        void addClipReadBounds(uint32_t clipID, const IAABB& bounds);
+        // Mark the given clip as being read from within a screen-space bounding box. Returns false
+        // if 'bounds' intersect the clip's staleBounds.
+        bool addClipReadBounds(uint32_t clipID, const IAABB& bounds);
 
         // Appends a list of high-level PLSDraws to the flush.
         // Returns false if the draws don't fit within the current resource constraints, at which
@@ -478,6 +1214,11 @@ private:
                                             ResourceCounters*,
                                             pls::ColorRampLocation*);
 
+        // Drops every draw that is entirely hidden beneath a later occluder (see
+        // PLSDraw::occluderBounds()), and removes its resources from the flush's counts. Called at
+        // the beginning of layoutResources(), once the flush's draw list is final.
+        void cullOccludedDraws();
+
         // Carves out space for this specific flush within the total frame's resource buffers and
         // lays out the flush-specific resource textures. Updates the total frame running conters
         // based on layout.
@@ -488,14 +1229,21 @@ private:
                              LayoutCounters* runningFrameLayoutCounts);
 
         // Called after all flushes in a frame have done their layout and the render context has
-        // allocated and mapped its resource buffers. Writes the GPU data for this flush to the
-        // context's actively mapped resource buffers.
-        void writeResources();
+        // allocated and mapped its resource buffers. Writes the GPU data for this flush to its own
+        // ranges of the context's actively mapped resource buffers.
+        //
+        // Different LogicalFlushes may write their resources concurrently, as long as each one
+        // uses a different set of allocators for its low-level draw list.
+        void writeResources(DrawAllocators*);
 
         // Pushes a record to the GPU for the given path, which will be referenced by future calls
         // to pushContour() and pushCubic().
         void pushPath(PLSPathDraw*, pls::PatchType, uint32_t tessVertexCount);
 
+        // Writes the PaintAuxData record for the current path, or finds an identical one that was
+        // already written this flush. Returns the record's index.
+        uint32_t pushPaintAux(const PLSPathDraw*);
+
         // Pushes a contour record to the GPU for the given contour, which references the
         // most-recently pushed path and will be referenced by future calls to pushCubic().
         //
@@ -531,6 +1279,9 @@ private:
         // images should be drawn as rectangular paths with an image paint.
         void pushImageRect(ImageRectDraw*);
 
+        // Pushes a solid-color rect to the draw list, drawn with the imageRect pipeline.
+        void pushSolidRect(SolidRectDraw*);
+
         void pushImageMesh(ImageMeshDraw*);
 
         void pushStencilClipReset(StencilClipReset*);
@@ -578,6 +1329,47 @@ private:
             uint32_t joinSegmentCount,
             uint32_t contourIDWithFlags);
 
+        // Writes a single TessVertexSpan, or CompactTessVertexSpan if the flush uses them.
+        template <typename... Args> RIVE_ALWAYS_INLINE void writeTessVertexSpan(Args&&... args)
+        {
+            if (m_flushDesc.compactTessVertexSpans)
+            {
+                m_compactTessSpanData.set_back(std::forward<Args>(args)...);
+            }
+            else
+            {
+                m_tessSpanData.set_back(std::forward<Args>(args)...);
+            }
+        }
+
+        // Elements written to the tessVertexSpanBuffer, in whichever encoding the flush uses.
+        size_t tessVertexSpansWritten() const
+        {
+            if (m_flushDesc.compactTessVertexSpans)
+            {
+                return m_compactTessSpanData.elementsWritten();
+            }
+            if (m_flushDesc.gpuTessellationSpans)
+            {
+                return m_tessCurveData.elementsWritten();
+            }
+            return m_tessSpanData.elementsWritten();
+        }
+
+        // FrameDescriptor::gpuTessellationSpans. Pushes a single TessCurve in place of the spans
+        // that push*TessellationSpans() would have written, and advances the path's tessellation
+        // locations the same way they would have. Pass TessCurve::kNoForwardLocation and/or
+        // TessCurve::kNoMirroredLocation to omit either copy of the curve.
+        void pushTessCurve(const Vec2D pts[4],
+                           Vec2D joinTangent,
+                           uint32_t tessLocation,
+                           uint32_t mirroredTessLocation,
+                           uint32_t totalVertexCount,
+                           uint32_t parametricSegmentCount,
+                           uint32_t polarSegmentCount,
+                           uint32_t joinSegmentCount,
+                           uint32_t contourIDWithFlags);
+
         // Either appends a new drawBatch to m_drawList or merges into m_drawList.tail().
         // Updates the batch's ShaderFeatures according to the passed parameters.
         DrawBatch& pushPathDraw(PLSPathDraw*, DrawType, uint32_t vertexCount, uint32_t baseVertex);
@@ -587,6 +1379,9 @@ private:
                             uint32_t elementCount,
                             uint32_t baseElement);
 
+        // Splits m_drawList into m_tileBinDrawLists and fills out a FlushDescriptor for each bin.
+        void buildTileBins();
+
         // Instance pointer to the outer parent class.
         PLSRenderContext* const m_ctx;
 
@@ -598,20 +1393,58 @@ private:
         std::unordered_map<uint64_t, uint32_t> m_simpleGradients; // [color0, color1] -> texelsIdx.
         std::vector<pls::TwoTexelRamp> m_pendingSimpleGradientWrites;
 
-        // Complex gradients have stop(s) between t=0 and t=1. In theory they should be scaled to a
-        // ramp where every stop lands exactly on a pixel center, but for now we just always scale
-        // them to the entire gradient texture width.
-        std::unordered_map<GradientContentKey, uint16_t, DeepHashGradient>
-            m_complexGradients; // [colors[0..n], stops[0..n]] -> rowIdx
-        std::vector<const PLSGradient*> m_pendingComplexColorRampDraws;
+        // Complex gradients have stop(s) between t=0 and t=1. They get scaled to a power-of-two
+        // width, chosen from the spacing of their stops, so that every interval between stops still
+        // spans plenty of texels.
+        //
+        // Complex gradients live in the render context's persistent atlas. m_complexGradients
+        // caches the atlas rows this flush references, and m_pendingComplexColorRampDraws lists the
+        // rows this flush still has to render.
+        std::unordered_map<GradientContentKey, pls::ColorRampLocation, DeepHashGradient>
+            m_complexGradients; // [colors[0..n], stops[0..n]] -> atlas slot
+        struct PendingColorRampDraw
+        {
+            const PLSGradient* gradient;
+            pls::ColorRampLocation location;
+        };
+        std::vector<PendingColorRampDraw> m_pendingComplexColorRampDraws;
+        uint16_t m_minPendingAtlasRow;
+        uint16_t m_maxPendingAtlasRow;
+
+        // Uniquely identifies this flush to the gradient atlas, so it never evicts rows that are
+        // still referenced by the flush being built.
+        uint64_t m_gradientAtlasFlushID;
 
         std::vector<ClipInfo> m_clips;
+        uint32_t m_lastGeneratedClipID;
+        uint32_t m_nextRecycledClipID; // Round-robin cursor for recycling clip IDs.
+        size_t m_recycledClipIDCount;
 
         // High-level draw list. These get built into a low-level list of pls::DrawBatch objects
         // during writeResources().
         std::vector<PLSDrawUniquePtr> m_plsDraws;
         IAABB m_combinedDrawBounds;
 
+        // Hot per-draw fields, indexed like m_plsDraws and captured in pushDrawBatch(), so culling
+        // and sort key building stream through contiguous arrays instead of dereferencing every
+        // PLSDraw in the per-frame allocator.
+        std::vector<IAABB> m_drawPixelBounds;
+        std::vector<IAABB> m_drawOccluderBounds; // Only valid until cullOccludedDraws() is done.
+        // Each draw's type, texture hash, blend mode, and drawContents, already shifted into place
+        // for the sort key in writeResources().
+        std::vector<int64_t> m_drawSortKeyBits;
+
+        // Coarse grid of kOcclusionTileSize tiles that are known to be fully covered by opaque
+        // occluders. Only valid during cullOccludedDraws().
+        std::vector<uint8_t> m_occludedTiles;
+        size_t m_culledDrawCount;
+
+        // Scene statistics for FrameStats (and FrameDescriptor::autoInterlockMode).
+        uint64_t m_drawPixelArea;
+        size_t m_nonSrcOverDrawCount;
+        size_t m_drawGroupCount;
+        size_t m_blendBarrierCount;
+
         // Layout state.
         uint32_t m_pathPaddingCount;
         uint32_t m_paintPaddingCount;
@@ -623,12 +1456,65 @@ private:
         uint32_t m_outerCubicTessVertexIdx;
         uint32_t m_midpointFanTessVertexIdx;
 
+        // Offsets of this flush's data within the render context's resource buffers that aren't
+        // stored in the FlushDescriptor. (Determined during layoutResources().)
+        size_t m_firstSimpleGrad;
+        size_t m_firstImageDraw;
+        size_t m_tessSpanRegionStart;
+        size_t m_firstTriangleVertex;
+
+        // This flush's views into the render context's mapped resource buffers. Only valid during
+        // writeResources().
+        WriteOnlyMappedMemory<pls::FlushUniforms> m_flushUniformData;
+        WriteOnlyMappedMemory<pls::PathData> m_pathData;
+        WriteOnlyMappedMemory<pls::PaintData> m_paintData;
+        WriteOnlyMappedMemory<pls::PaintAuxData> m_paintAuxData;
+        WriteOnlyMappedMemory<pls::ContourData> m_contourData;
+        WriteOnlyMappedMemory<pls::TwoTexelRamp> m_simpleColorRampsData;
+        WriteOnlyMappedMemory<pls::GradientSpan> m_gradSpanData;
+        WriteOnlyMappedMemory<pls::TessVertexSpan> m_tessSpanData;
+        WriteOnlyMappedMemory<pls::CompactTessVertexSpan> m_compactTessSpanData;
+        WriteOnlyMappedMemory<pls::TessCurve> m_tessCurveData;
+        WriteOnlyMappedMemory<pls::TriangleVertex> m_triangleVertexData;
+        WriteOnlyMappedMemory<pls::ImageDrawUniforms> m_imageDrawUniformData;
+
+        // Index of each PaintAuxData record written this flush, by contents, so paths with
+        // identical paints and clipRects can share a record. (Not used in atomic mode, where the
+        // fragment shader can only look up paint records by pathID.)
+        using PaintAuxContents =
+            std::array<uint32_t, sizeof(pls::PaintAuxData) / sizeof(uint32_t)>;
+        struct HashPaintAuxContents
+        {
+            size_t operator()(const PaintAuxContents&) const;
+        };
+        std::unordered_map<PaintAuxContents, uint32_t, HashPaintAuxContents> m_paintAuxIndices;
+
+        // Allocates the DrawBatches in m_drawList. Only valid during writeResources().
+        TrivialBlockAllocator* m_drawListAllocator = nullptr;
+
+        // Used for re-ordering high level draws.
+        std::vector<int64_t> m_indirectDrawList;
+        std::vector<int64_t> m_indirectDrawSortScratch;
+        std::unique_ptr<IntersectionBoard> m_intersectionBoard;
+
+        // PlatformFeatures::khrBlendEquationsNeedBarriers: the blend phase of each draw (see
+        // IntersectionBoard::addRectangle()), and whether the next batch starts a new phase.
+        std::unique_ptr<IntersectionBoard> m_blendPhaseBoard;
+        std::vector<int32_t> m_drawBlendPhases;
+        std::vector<int64_t> m_blendPhaseSortScratch;
+        bool m_pendingBlendBarrier = false;
+
         pls::FlushDescriptor m_flushDesc;
         pls::GradTextureLayout m_gradTextureLayout; // Not determined until writeResources().
 
         BlockAllocatedLinkedList<DrawBatch> m_drawList;
         pls::ShaderFeatures m_combinedShaderFeatures;
 
+        // Per-bin draw lists and descriptors, when the frame uses tile-binned rendering. (Empty
+        // otherwise.)
+        std::vector<BlockAllocatedLinkedList<DrawBatch>> m_tileBinDrawLists;
+        std::vector<pls::FlushDescriptor> m_tileBinFlushDescs;
+
         // Most recent path and contour state.
         bool m_currentPathIsStroked;
         pls::ContourDirections m_currentPathContourDirections;
@@ -640,14 +1526,40 @@ private:
         RIVE_DEBUG_CODE(uint32_t m_expectedPathTessLocationAtEndOfPath;)
         RIVE_DEBUG_CODE(uint32_t m_expectedPathMirroredTessLocationAtEndOfPath;)
         RIVE_DEBUG_CODE(uint32_t m_pathCurveCount;)
+        // FrameDescriptor::gpuTessellationSpans: the number of TessVertexSpans the GPU will expand
+        // this flush's TessCurves into.
+        uint32_t m_gpuTessVertexSpanCount;
 
         // Stateful Z index of the current draw being pushed. Used by depthStencil mode to avoid
         // double hits and to reverse-sort opaque paths front to back.
         uint32_t m_currentZIndex;
 
+        // Set by nextTarget(). Null means the flush renders into FlushResources::renderTarget.
+        PLSRenderTarget* m_renderTarget = nullptr;
+        bool m_isFirstFlushOfTarget = false;
+
         RIVE_DEBUG_CODE(bool m_hasDoneLayout = false;)
     };
 
     std::vector<std::unique_ptr<LogicalFlush>> m_logicalFlushes;
+
+    // Index of the first logical flush that hasn't been assigned a target by nextTarget().
+    size_t m_firstLogicalFlushOfTarget = 0;
+
+    // A frame that flush() handed off to m_submissionThread. It still owns the frame's PLSDraws
+    // (and therefore the textures and RenderBuffers its draw batches reference) until
+    // waitForPendingSubmission(). Afterward, its rewound containers are kept as spares for the next
+    // hand-off.
+    struct PipelinedFrame
+    {
+        std::unique_ptr<DrawAllocators> drawAllocators;
+        std::vector<std::unique_ptr<DrawAllocators>> recordingThreadAllocators;
+        // Declared last so the PLSDraws get released before their allocators are destroyed.
+        std::vector<std::unique_ptr<LogicalFlush>> logicalFlushes;
+    };
+
+    std::unique_ptr<SubmissionThread> m_submissionThread; // Null unless pipelined.
+    PipelinedFrame m_pipelinedFrame;
+    bool m_hasPendingSubmission = false;
 };
 } // namespace rive::pls
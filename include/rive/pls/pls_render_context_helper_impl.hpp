@@ -67,11 +67,6 @@ protected:
     const BufferRing* tessSpanBufferRing() { return m_tessSpanBuffer.get(); }
     const BufferRing* triangleBufferRing() { return m_triangleBuffer.get(); }
 
-    virtual rcp<PLSTexture> makeImageTexture(uint32_t width,
-                                             uint32_t height,
-                                             uint32_t mipLevelCount,
-                                             const uint8_t imageDataRGBA[]) = 0;
-
     virtual std::unique_ptr<BufferRing> makeUniformBufferRing(size_t capacityInBytes) = 0;
     virtual std::unique_ptr<BufferRing> makeStorageBufferRing(size_t capacityInBytes,
                                                               pls::StorageBufferStructure) = 0;
@@ -18,12 +18,55 @@ public:
 
     const PlatformFeatures& platformFeatures() const { return m_platformFeatures; }
 
+    // Number of buffers in each of our rings, i.e., how many frames the CPU can get ahead of the
+    // GPU. In [kMinBufferRingSize, kMaxBufferRingSize].
+    int bufferRingSize() const { return m_bufferRingSize; }
+
     virtual rcp<RenderBuffer> makeRenderBuffer(RenderBufferType, RenderBufferFlags, size_t) = 0;
 
     // Decodes the image bytes and creates a texture that can be bound to the draw shader for an
     // image paint.
     virtual rcp<PLSTexture> decodeImageTexture(Span<const uint8_t> encodedBytes) = 0;
 
+    // Creates a texture from pixels that have already been decoded (e.g., on a background thread
+    // by PLSRenderContext::decodeImageAsync()).
+    virtual rcp<PLSTexture> makeImageTexture(uint32_t width,
+                                             uint32_t height,
+                                             uint32_t mipLevelCount,
+                                             const uint8_t imageDataRGBA[]) = 0;
+
+    // Creates a texture from block-compressed data. 'data' contains every mip level, tightly
+    // packed beginning with the base level (see pls::CompressedTextureSizeInBytes()). Only called
+    // with formats that PlatformFeatures reports as supported.
+    virtual rcp<PLSTexture> makeCompressedImageTexture(uint32_t width,
+                                                       uint32_t height,
+                                                       uint32_t mipLevelCount,
+                                                       pls::CompressedTextureFormat,
+                                                       const uint8_t data[])
+    {
+        return nullptr;
+    }
+
+    // Creates a render target whose color attachment is a new texture, returned in 'layerTexture',
+    // that draws can sample as an image once the render target has been flushed. Returns null if
+    // the backend doesn't support offscreen layers. (See PLSRenderContext::beginLayer().)
+    virtual rcp<PLSRenderTarget> makeLayerRenderTarget(uint32_t width,
+                                                       uint32_t height,
+                                                       rcp<PLSTexture>* layerTexture)
+    {
+        return nullptr;
+    }
+
+    // Draws 'layerTexture' stretched over the entirety of 'renderTarget', with bilinear filtering.
+    // Only called if PlatformFeatures::supportsResolutionScaling is set, and only with textures
+    // from makeLayerRenderTarget() whose render targets have already been flushed.
+    virtual void upscaleLayer(const PLSTexture* layerTexture,
+                              PLSRenderTarget* renderTarget,
+                              void* externalCommandBuffer)
+    {
+        RIVE_UNREACHABLE();
+    }
+
     // Resize GPU buffers. These methods cannot fail, and must allocate the exact size requested.
     //
     // PLSRenderContext takes care to minimize how often these methods are called, while also
@@ -89,10 +132,37 @@ public:
     //
     virtual void flush(const pls::FlushDescriptor&) = 0;
 
+    // Begins compiling the given shader variants ahead of time, so the first frames that use them
+    // don't stall. Backends may finish compiling asynchronously. Variants are already filtered by
+    // interlock modes that m_platformFeatures supports.
+    virtual void precompileShaders(Span<const pls::ShaderVariant>) {}
+
+    // Returns the oldest GPU frame time that has been measured (see
+    // FlushDescriptor::gpuTimerFrameNumber) and not yet returned. Returns false if there are none,
+    // or if the backend doesn't support GPU timers.
+    virtual bool popGPUFrameTime(pls::GPUFrameTime*) { return false; }
+
+    // Checked once per flush. While true, resources get trimmed down to their recent peak usage
+    // right away, instead of waiting for the next trim interval.
+    virtual bool isOverMemoryBudget() { return false; }
+
     // Steady clock, used to determine when we should trim our resource allocations.
     virtual double secondsNow() const = 0;
 
 protected:
+    PLSRenderContextImpl() = default;
+    // For backends that size buffer rings in their constructor's initializer list.
+    PLSRenderContextImpl(int bufferRingSize) { setBufferRingSize(bufferRingSize); }
+
+    // Called from the backend's constructor, before any buffers are made.
+    void setBufferRingSize(int bufferRingSize)
+    {
+        m_bufferRingSize = std::clamp(bufferRingSize, kMinBufferRingSize, kMaxBufferRingSize);
+    }
+
     PlatformFeatures m_platformFeatures;
+
+private:
+    int m_bufferRingSize = kBufferRingSize;
 };
 } // namespace rive::pls
@@ -44,23 +44,70 @@ public:
                        BlendMode,
                        float opacity) override;
 
+    using ParallelForFn = PLSRenderContext::ParallelForFn;
+
+    // Equivalent to calling drawPath() on each path/paint pair, in order, with the current matrix
+    // and clip. The (potentially expensive) PLSPathDraw construction happens concurrently via
+    // parallelFor, using one set of PLSRenderContext::DrawAllocators per recording thread, and the
+    // resulting draws are then clipped and pushed in submission order on the calling thread.
+    //
+    // The paths and paints must not be mutated by any other thread until this method returns.
+    void drawPathsInParallel(RenderPath* const paths[],
+                             RenderPaint* const paints[],
+                             size_t count,
+                             const ParallelForFn& parallelFor);
+
+    // Equivalent to calling drawPath() once for each instance in 'matrices', with the matrix
+    // "currentMatrix * matrices[i]" and the current clip. If 'colors' is not empty, it must hold
+    // one color per instance, which replaces the paint's color (only for solid-color paints).
+    //
+    // The path is analyzed once for all of its instances, rather than once per instance. (See
+    // PLSPathDraw::MakeInstances().)
+    void drawPathInstanced(RenderPath*,
+                           RenderPaint*,
+                           Span<const Mat2D> matrices,
+                           Span<const ColorInt> colors = {});
+
     // Determines if a path is an axis-aligned rectangle that can be represented by rive::AABB.
     static bool IsAABB(const RawPath&, AABB* result);
 
+    // Determines if a path is an axis-aligned rectangle whose four corners are rounded off by
+    // identical quarter ellipses (this includes ellipses themselves). Returns the rectangle and the
+    // x and y radii of its corners.
+    static bool IsRoundedRect(const RawPath&, AABB* rect, Vec2D* cornerRadii);
+
 #ifdef TESTING
     bool hasClipRect() const { return m_stack.back().clipRectInverseMatrix != nullptr; }
     const AABB& getClipRect() const { return m_stack.back().clipRect; }
     const Mat2D& getClipRectMatrix() const { return m_stack.back().clipRectMatrix; }
+    Vec2D getClipRectCornerRadii() const { return m_stack.back().clipRectCornerRadii; }
 #endif
 
 private:
-    void clipRectImpl(AABB, const PLSPath* originalPath);
+    // 'cornerRadii' are nonzero if the rect has rounded corners.
+    void clipRectImpl(AABB, const PLSPath* originalPath, Vec2D cornerRadii = {0, 0});
     void clipPathImpl(const PLSPath*);
 
+    // Intersects the current clipBounds with 'bounds', and marks the clip empty if nothing is left.
+    void intersectClipBounds(const IAABB& bounds);
+
     // Clips and pushes the given draw to m_context. If the clipped draw is too complex to be
     // supported by the GPU buffers, even after a logical flush, then nothing is drawn.
     void clipAndPushDraw(PLSDrawUniquePtr);
 
+    // The current matrix, followed by the frame's resolution scale (see
+    // FrameDescriptor::resolutionScale).
+    Mat2D viewMatrix() const
+    {
+        return m_context->frameIsResolutionScaled()
+                   ? m_context->frameResolutionScaleMatrix() * m_stack.back().matrix
+                   : m_stack.back().matrix;
+    }
+
+    // Returns false if the given path/paint pair should not be drawn at all (e.g., empty paths,
+    // zero-width strokes, or disabled fills/strokes).
+    bool shouldDrawPath(const PLSPath*, const PLSPaint*) const;
+
     // Pushes any necessary clip updates to m_internalDrawBatch and sets the PLSDraw's clipID and
     // clipRectInverseMatrix, if any.
     // Returns false if the operation failed, at which point the caller should issue a logical flush
@@ -73,8 +120,13 @@ private:
         size_t clipStackHeight = 0;
         AABB clipRect;
         Mat2D clipRectMatrix;
+        Vec2D clipRectCornerRadii; // {0, 0} unless the clipRect has rounded corners.
         const pls::ClipRectInverseMatrix* clipRectInverseMatrix = nullptr;
         bool clipIsEmpty = false;
+        // Conservative pixel bounds of the intersection of every clip (clipRect and clip stack)
+        // in effect. Draws that don't touch them are culled before they emit any clip updates.
+        bool hasClipBounds = false;
+        IAABB clipBounds;
     };
     std::vector<RenderState> m_stack{1};
 
@@ -90,6 +142,9 @@ private:
         Mat2D matrix;
         uint64_t rawPathMutationID;
         AABB pathBounds;
+        // Conservative (antialiasing included) pixel bounds of the clip. Computed once, and
+        // retained for as long as the element can be reused, including across frames.
+        IAABB pixelBounds;
         rcp<const PLSPath> path;
         FillRule fillRule; // Bc PLSPath fillRule can mutate during the artboard draw process.
         uint32_t clipID;
@@ -100,6 +155,9 @@ private:
 
     std::vector<PLSDrawUniquePtr> m_internalDrawBatch;
 
+    // Draws built by drawPathInstanced(), waiting to be clipped and pushed.
+    std::vector<PLSDrawUniquePtr> m_instanceDraws;
+
     // Path of the rectangle [0, 0, 1, 1]. Used to draw images.
     rcp<PLSPath> m_unitRectPath;
 
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2024 Rive
+ */
+
+#pragma once
+
+// Optional trace scopes around the CPU stages of the renderer (draw construction, layout, sorting,
+// buffer mapping, and each backend's flush), plus matching GPU debug labels in the backends. They
+// are only compiled in when RIVE_PLS_TRACING is defined (premake --with-pls-tracing); otherwise
+// PLS_TRACE_SCOPE() expands to nothing.
+//
+// The renderer doesn't depend on any particular tracing library. Instead, the client installs
+// hooks that forward scopes to Perfetto, Tracy, os_signpost, etc. Scope names are string literals,
+// so they can be used as static identifiers.
+
+namespace rive::pls
+{
+struct TraceHooks
+{
+    // Called on the thread that opens or closes the scope. Scopes nest, and always close in the
+    // reverse order they were opened on any given thread.
+    void (*beginScope)(const char* name, void* userData) = nullptr;
+    void (*endScope)(const char* name, void* userData) = nullptr;
+    void* userData = nullptr;
+};
+
+#ifdef RIVE_PLS_TRACING
+// Must be installed before rendering begins, and not changed while any thread is rendering.
+void SetTraceHooks(const TraceHooks&);
+
+extern TraceHooks g_traceHooks;
+
+class TraceScope
+{
+public:
+    TraceScope(const char* name) : m_name(name)
+    {
+        if (g_traceHooks.beginScope != nullptr)
+        {
+            g_traceHooks.beginScope(m_name, g_traceHooks.userData);
+        }
+    }
+
+    ~TraceScope()
+    {
+        if (g_traceHooks.endScope != nullptr)
+        {
+            g_traceHooks.endScope(m_name, g_traceHooks.userData);
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* const m_name;
+};
+
+#define PLS_TRACE_SCOPE_CONCAT_IMPL(A, B) A##B
+#define PLS_TRACE_SCOPE_CONCAT(A, B) PLS_TRACE_SCOPE_CONCAT_IMPL(A, B)
+#define PLS_TRACE_SCOPE(NAME)                                                                      \
+    ::rive::pls::TraceScope PLS_TRACE_SCOPE_CONCAT(plsTraceScope_, __LINE__)(NAME)
+#else
+#define PLS_TRACE_SCOPE(NAME)
+#endif
+} // namespace rive::pls
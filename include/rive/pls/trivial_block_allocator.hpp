@@ -12,21 +12,43 @@
 namespace rive
 {
 // Fast block allocator for trivially-destructible types.
+//
+// Blocks are retained across resets: if the allocator had to grow since the last reset, its blocks
+// get coalesced into a single block big enough for all of them, so steady-state usage doesn't
+// malloc at all. The block only shrinks back down once usage has stayed well below it for a while.
 class TrivialBlockAllocator
 {
 public:
-    TrivialBlockAllocator(size_t initialBlockSize) : m_initialBlockSize(initialBlockSize)
+    TrivialBlockAllocator(size_t initialBlockSize) :
+        m_initialBlockSize(initialBlockSize), m_firstBlockSize(initialBlockSize)
     {
-        m_blocks.push_back(std::unique_ptr<char[]>(new char[m_initialBlockSize]));
+        m_blocks.push_back(std::unique_ptr<char[]>(new char[m_firstBlockSize]));
         reset();
     }
 
     void reset()
     {
+        size_t usage = m_retiredBlockBytes + m_currentBlockUsage;
+        m_usageHighWatermark = std::max(m_usageHighWatermark, usage);
+        if (m_blocks.size() > 1)
+        {
+            // We grew. Coalesce into a single block that fits everything at once.
+            reallocateFirstBlock(m_retiredBlockBytes + m_currentBlockSize);
+        }
+        else if (++m_resetsSinceWatermark >= kShrinkResetCount)
+        {
+            // Free memory from a past usage spike once the high watermark has stayed far below it.
+            if (m_usageHighWatermark * 4 < m_firstBlockSize)
+            {
+                reallocateFirstBlock(std::max(m_usageHighWatermark * 2, m_initialBlockSize));
+            }
+            m_usageHighWatermark = 0;
+            m_resetsSinceWatermark = 0;
+        }
         m_fibMinus2 = 0;
         m_fibMinus1 = 1;
-        m_blocks.resize(1);
-        m_currentBlockSize = m_initialBlockSize;
+        m_retiredBlockBytes = 0;
+        m_currentBlockSize = m_firstBlockSize;
         m_currentBlockUsage = 0;
     }
 
@@ -47,6 +69,7 @@ public:
             size_t blockSize =
                 std::max(fib * m_initialBlockSize, sizeInBytes + AlignmentInBytes - 1);
             m_blocks.push_back(std::unique_ptr<char[]>(new char[blockSize]));
+            m_retiredBlockBytes += m_currentBlockSize;
             m_currentBlockSize = blockSize;
             m_currentBlockUsage = 0;
 
@@ -76,15 +99,33 @@ public:
     }
 
 private:
+    // How many resets the high watermark is measured over before deciding whether to shrink.
+    constexpr static size_t kShrinkResetCount = 256;
+
+    void reallocateFirstBlock(size_t sizeInBytes)
+    {
+        m_blocks.clear();
+        m_blocks.push_back(std::unique_ptr<char[]>(new char[sizeInBytes]));
+        m_firstBlockSize = sizeInBytes;
+        m_usageHighWatermark = 0;
+        m_resetsSinceWatermark = 0;
+    }
+
     const size_t m_initialBlockSize;
+    size_t m_firstBlockSize;
 
     // Grow block sizes using a fibonacci function.
     size_t m_fibMinus2;
     size_t m_fibMinus1;
 
     std::vector<std::unique_ptr<char[]>> m_blocks;
+    size_t m_retiredBlockBytes = 0; // Total size of every block before the current one.
     size_t m_currentBlockSize;
-    size_t m_currentBlockUsage;
+    size_t m_currentBlockUsage = 0;
+
+    // Largest usage seen by reset() since the block was last reallocated or checked for shrinking.
+    size_t m_usageHighWatermark = 0;
+    size_t m_resetsSinceWatermark = 0;
 };
 
 // Basic array allocator for POD types, based on TrivialBlockAllocator.
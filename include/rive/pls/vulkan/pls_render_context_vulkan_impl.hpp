@@ -4,25 +4,80 @@
 
 #pragma once
 
+#include "rive/pls/pipeline_blob_cache.hpp"
 #include "rive/pls/pls_render_context_impl.hpp"
 #include "vkutil.hpp"
+#include "vulkan_timeline.hpp"
 #include <chrono>
+#include <functional>
 #include <map>
+#include <mutex>
 #include <vulkan/vulkan.h>
 #include <deque>
 
 namespace rive::pls
 {
 class PLSTextureVulkanImpl;
+enum class DrawPipelineOptions;
 
 // Tells the PLS context which device extensions are enabled and available to use.
 struct VulkanCapabilities
 {
     bool fillModeNonSolid = false;
     bool fragmentStoresAndAtomics = false;
+    bool textureCompressionETC2 = false;
+    bool textureCompressionASTC_LDR = false;
+    bool textureCompressionBC = false;
     // Flagging this extension implies that the GPU *also* supports rasterOrdered
     // access to color attachments. (Otherwise it must be turned off.)
     bool EXT_rasterization_order_attachment_access = false;
+    // Nanoseconds per timestamp tick (VkPhysicalDeviceLimits::timestampPeriod), or 0 if the queue
+    // doesn't support timestamps. Enables GPU frame timing.
+    float timestampPeriod = 0;
+    // VkPhysicalDeviceVulkan12Features::timelineSemaphore (or VK_KHR_timeline_semaphore). Required
+    // for ContextOptions::internalSubmitQueue.
+    bool timelineSemaphore = false;
+    // VK_KHR_push_descriptor. Image textures get pushed straight into the command buffer instead
+    // of being bound through descriptor sets.
+    bool KHR_push_descriptor = false;
+    // VkPhysicalDeviceVulkan12Features (or VK_EXT_descriptor_indexing) runtimeDescriptorArray,
+    // descriptorBindingPartiallyBound, descriptorBindingSampledImageUpdateAfterBind,
+    // descriptorBindingUpdateUnusedWhilePending, and shaderSampledImageArrayNonUniformIndexing.
+    // Atomic mode then samples image paints out of a bindless texture table, so paths with
+    // different images can share a DrawBatch (and don't need to be drawn as image rects).
+    bool descriptorIndexing = false;
+    // Largest image the tessellation texture can grow to: the smaller of
+    // VkPhysicalDeviceLimits::maxImageDimension2D and maxFramebufferHeight. Defaults to the minimum
+    // that Vulkan requires.
+    uint32_t maxRenderableImageDimension = 4096;
+    // VkPhysicalDeviceProperties::deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU. RenderBuffers
+    // flagged mappedOnceAtInitialization, and the PLS storage buffer rings, then live in
+    // device-local memory and get uploaded from staging buffers, instead of being read over PCIe.
+    bool discreteGPU = false;
+};
+
+// Offscreen PLS planes. Owned by a single render target, or shared by all of them (see
+// PLSRenderContextVulkanImpl::ContextOptions::plsPlaneSizeBucket).
+struct PLSPlanesVulkan
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    rcp<vkutil::Texture> coverageTexture; // pls::InterlockMode::rasterOrdering.
+    rcp<vkutil::Texture> clipTexture;
+    rcp<vkutil::Texture> scratchColorTexture;
+    rcp<vkutil::Texture> coverageAtomicTexture; // pls::InterlockMode::atomics.
+
+    rcp<vkutil::TextureView> coverageTextureView;
+    rcp<vkutil::TextureView> clipTextureView;
+    rcp<vkutil::TextureView> scratchColorTextureView;
+    rcp<vkutil::TextureView> coverageAtomicTextureView;
+
+    // Allocates whichever planes the interlock mode needs that don't exist yet.
+    void synchronize(vkutil::Allocator*, VkCommandBuffer, pls::InterlockMode);
+
+    // Drops all planes and sets a new size for their next allocation.
+    void reset(uint32_t newWidth, uint32_t newHeight);
 };
 
 class PLSRenderTargetVulkan : public PLSRenderTarget
@@ -33,40 +88,149 @@ public:
         m_targetTextureView = std::move(view);
     }
 
+    // Describes how to take ownership of a target image that is shared with another API, process,
+    // or Vulkan instance (e.g., one imported with vkutil::Allocator::importTexture()), and how to
+    // hand it back.
+    struct ExternalAccess
+    {
+        // VK_QUEUE_FAMILY_FOREIGN_EXT (requires VK_EXT_queue_family_foreign) for images from
+        // other APIs or processes, or VK_QUEUE_FAMILY_EXTERNAL for other Vulkan instances.
+        uint32_t queueFamilyIndex = VK_QUEUE_FAMILY_FOREIGN_EXT;
+        // Layout the producer leaves the image in. UNDEFINED discards the contents, which is only
+        // valid if the frame clears the target.
+        VkImageLayout acquireLayout = VK_IMAGE_LAYOUT_GENERAL;
+        // Layout the consumer expects the image in.
+        VkImageLayout releaseLayout = VK_IMAGE_LAYOUT_GENERAL;
+        // Binary semaphores that the next frame waits on before drawing, and signals once it's
+        // done (e.g., imported from a sync_fd with vkImportSemaphoreFdKHR). Only used when the
+        // context submits its own command buffers (see ContextOptions::internalSubmitQueue);
+        // otherwise the client waits and signals them in its own submission. Each semaphore is
+        // consumed by one frame and then reset to null.
+        VkSemaphore acquireSemaphore = VK_NULL_HANDLE;
+        VkSemaphore releaseSemaphore = VK_NULL_HANDLE;
+    };
+
+    // When set, the first flush of every frame acquires the target image from
+    // access.queueFamilyIndex, and the final flush releases it back, via queue family ownership
+    // transfer barriers.
+    void setExternalAccess(const ExternalAccess& access)
+    {
+        m_externalAccess = access;
+        m_hasExternalAccess = true;
+    }
+    void clearExternalAccess() { m_hasExternalAccess = false; }
+
 private:
     friend class PLSRenderContextVulkanImpl;
 
     PLSRenderTargetVulkan(uint32_t width, uint32_t height, VkFormat framebufferFormat) :
         PLSRenderTarget(width, height), m_framebufferFormat(framebufferFormat)
-    {}
+    {
+        m_ownPlanes.reset(width, height);
+    }
 
-    // Called during flush(). Ensures the required offscreen views are all initialized.
-    void synchronize(vkutil::Allocator*, VkCommandBuffer, pls::InterlockMode);
+    // Called during flush(). Ensures the required offscreen views are all initialized, either in
+    // this render target's own planes or, if not null, in 'sharedPlanes' (which are at least as
+    // large as this render target).
+    void synchronize(vkutil::Allocator*,
+                     VkCommandBuffer,
+                     pls::InterlockMode,
+                     PLSPlanesVulkan* sharedPlanes);
+
+    // Records the ownership transfer barriers for ExternalAccess.
+    void acquireExternalImage(VkCommandBuffer, uint32_t queueFamilyIndex);
+    void releaseExternalImage(VkCommandBuffer, uint32_t queueFamilyIndex);
 
     const VkFormat m_framebufferFormat;
     rcp<vkutil::TextureView> m_targetTextureView;
+    ExternalAccess m_externalAccess;
+    bool m_hasExternalAccess = false;
 
-    rcp<vkutil::Texture> m_coverageTexture; // pls::InterlockMode::rasterOrdering.
-    rcp<vkutil::Texture> m_clipTexture;
-    rcp<vkutil::Texture> m_scratchColorTexture;
-    rcp<vkutil::Texture> m_coverageAtomicTexture; // pls::InterlockMode::atomics.
-
-    rcp<vkutil::TextureView> m_coverageTextureView;
-    rcp<vkutil::TextureView> m_clipTextureView;
-    rcp<vkutil::TextureView> m_scratchColorTextureView;
-    rcp<vkutil::TextureView> m_coverageAtomicTextureView;
+    PLSPlanesVulkan m_ownPlanes;
+    const PLSPlanesVulkan* m_planes = &m_ownPlanes; // The planes used by the current flush.
 };
 
 class PLSRenderContextVulkanImpl : public PLSRenderContextImpl
 {
 public:
+    struct ContextOptions
+    {
+        // If non-null, the context seeds its VkPipelineCache from this cache, and writes the
+        // VkPipelineCache back out on storePipelineCache() and destruction. The cache must outlive
+        // the context.
+        PipelineBlobCache* pipelineBlobCache = nullptr;
+        // Draw pipelines are normally created on a background thread while a fully-featured
+        // pipeline stands in for them. Set this to create every pipeline synchronously instead.
+        // (Primarily for testing.)
+        bool synchronousShaderCompilations = false;
+        // How many frames the CPU can prepare ahead of the GPU. 2 minimizes latency; deeper rings
+        // trade latency for more CPU/GPU overlap. Clamped to [kMinBufferRingSize,
+        // kMaxBufferRingSize].
+        int bufferRingSize = pls::kBufferRingSize;
+        // Sub-allocate every per-flush buffer (uniforms, paths, paints, contours, gradient and
+        // tessellation spans, triangles) out of one large arena per ring slot, with 256-byte
+        // alignment. This trades a little padding for one allocation per slot and a single
+        // flushMappedContents per frame.
+        bool singleArenaBuffers = false;
+        // If set (and VulkanCapabilities::timelineSemaphore is supported), the context allocates
+        // and recycles its own command buffers, one per ring slot, and submits them to this
+        // queue itself. Clients may then leave FlushResources::externalCommandBuffer null, and
+        // synchronize with the GPU via timeline() instead of passing a frameCompletionFence.
+        VkQueue internalSubmitQueue = VK_NULL_HANDLE;
+        // Queue family of internalSubmitQueue, or of the client's primary command buffers when
+        // parallelRecordingThreadCount is nonzero.
+        uint32_t queueFamilyIndex = 0;
+        // If nonzero, large draw passes are split into chunks of DrawBatches that get recorded
+        // into secondary command buffers on this many worker threads (plus the calling thread),
+        // and then executed in order from the primary command buffer.
+        uint32_t parallelRecordingThreadCount = 0;
+        // If set (along with internalSubmitQueue), the compute work that prepares each frame's
+        // resources -- currently the expansion of TessCurves into TessVertexSpans -- is submitted
+        // to this queue instead, where it can overlap the previous frame's draw pass. The graphics
+        // submission waits on it via a timeline semaphore. Must be a queue from queueFamilyIndex,
+        // so the buffers it writes don't need queue family ownership transfers.
+        VkQueue asyncComputeQueue = VK_NULL_HANDLE;
+        // If nonzero, the context checks the device-local memory budget (see
+        // vkutil::Allocator::queryDeviceLocalMemoryBudget()) at every flush. Once usage reaches
+        // this fraction of the budget, resources are trimmed immediately rather than at the next
+        // trim interval, and onMemoryBudgetExceeded (if any) is called so the client can release
+        // memory of its own.
+        float memoryBudgetTrimThreshold = 0;
+        std::function<void(const vkutil::MemoryBudget&)> onMemoryBudgetExceeded;
+        // If nonzero, every render target draws into one set of offscreen PLS planes owned by the
+        // context. The planes are allocated in multiples of this many pixels, and only shrink
+        // (to the largest size requested) every kPLSPlaneShrinkFlushCount flushes. Interactive
+        // window resizes make a new render target on every frame, so this keeps them from
+        // reallocating the planes on every frame too. (Render targets only use the top-left
+        // corner of the planes.)
+        uint32_t plsPlaneSizeBucket = 0;
+    };
+
+    constexpr static uint32_t kPLSPlaneShrinkFlushCount = 120;
+
     static std::unique_ptr<PLSRenderContext> MakeContext(rcp<vkutil::Allocator>,
-                                                         VulkanCapabilities);
+                                                         VulkanCapabilities,
+                                                         const ContextOptions&);
+    static std::unique_ptr<PLSRenderContext> MakeContext(rcp<vkutil::Allocator> allocator,
+                                                         VulkanCapabilities capabilities)
+    {
+        return MakeContext(std::move(allocator), capabilities, ContextOptions());
+    }
 
     ~PLSRenderContextVulkanImpl();
 
+    // Writes the contents of the VkPipelineCache to the PipelineBlobCache, if there is one.
+    // Clients may call this at convenient times (e.g., after the first few frames have rendered),
+    // in addition to the automatic store on destruction.
+    void storePipelineCache();
+
     vkutil::Allocator* allocator() const { return m_allocator.get(); }
 
+    // Timeline that internally-submitted frames signal, one value per frame, or null if the
+    // context doesn't own its command buffers (see ContextOptions::internalSubmitQueue). Clients
+    // can wait on, or make their own submissions wait on, timeline()->lastReservedValue().
+    VulkanTimeline* timeline() const { return m_timeline.get(); }
+
     rcp<PLSRenderTargetVulkan> makeRenderTarget(uint32_t width,
                                                 uint32_t height,
                                                 VkFormat framebufferFormat)
@@ -77,25 +241,44 @@ public:
     rcp<RenderBuffer> makeRenderBuffer(RenderBufferType, RenderBufferFlags, size_t) override;
 
     rcp<PLSTexture> decodeImageTexture(Span<const uint8_t> encodedBytes) override;
+    rcp<PLSTexture> makeImageTexture(uint32_t width,
+                                     uint32_t height,
+                                     uint32_t mipLevelCount,
+                                     const uint8_t imageDataRGBA[]) override;
+    rcp<PLSTexture> makeCompressedImageTexture(uint32_t width,
+                                               uint32_t height,
+                                               uint32_t mipLevelCount,
+                                               pls::CompressedTextureFormat,
+                                               const uint8_t data[]) override;
 
     // Called when a vkutil::RenderingResource has been fully released (refCnt
     // reaches 0). The resource won't actually be deleted until the current frame's
     // command buffer has finished executing.
     void onRenderingResourceReleased(const vkutil::RenderingResource* resource)
     {
-        m_resourcePurgatory.emplace_back(resource, m_currentFrameIdx);
+        m_resourcePurgatory.emplace_back(resource, m_currentFrameIdx + bufferRingSize());
     }
 
 private:
-    PLSRenderContextVulkanImpl(rcp<vkutil::Allocator>, VulkanCapabilities);
+    friend class PLSTextureVulkanImpl;
+
+    PLSRenderContextVulkanImpl(rcp<vkutil::Allocator>, VulkanCapabilities, const ContextOptions&);
 
     // Called outside the constructor so we can use virtual methods.
     void initGPUObjects();
 
     void prepareToMapBuffers() override;
 
+    // ContextOptions::singleArenaBuffers. Assigns each PLS buffer ring its range of
+    // m_bufferArena, and sizes the arena to fit them all.
+    void layoutBufferArena();
+
 #define IMPLEMENT_PLS_BUFFER(Name, m_name)                                                         \
-    void resize##Name(size_t sizeInBytes) override { m_name.setTargetSize(sizeInBytes); }          \
+    void resize##Name(size_t sizeInBytes) override                                                 \
+    {                                                                                              \
+        m_name.setTargetSize(sizeInBytes);                                                         \
+        m_bufferArenaLayoutDirty = true;                                                           \
+    }                                                                                              \
     void* map##Name(size_t mapSizeInBytes) override                                                \
     {                                                                                              \
         return m_name.contentsAt(m_bufferRingIdx, mapSizeInBytes);                                 \
@@ -106,6 +289,7 @@ private:
     void resize##Name(size_t sizeInBytes, pls::StorageBufferStructure) override                    \
     {                                                                                              \
         m_name.setTargetSize(sizeInBytes);                                                         \
+        m_bufferArenaLayoutDirty = true;                                                           \
     }                                                                                              \
     void* map##Name(size_t mapSizeInBytes) override                                                \
     {                                                                                              \
@@ -155,7 +339,118 @@ private:
 
     rcp<DescriptorSetPool> makeDescriptorSetPool();
 
+    // Long-lived VkDescriptorPool for descriptor sets that are cached across flushes. Sets are
+    // freed individually, once the command buffers referencing them have finished.
+    class PersistentDescriptorPool final : public vkutil::RenderingResource
+    {
+    public:
+        constexpr static uint32_t kMaxSets = 256;
+
+        PersistentDescriptorPool(rcp<vkutil::Allocator>);
+        ~PersistentDescriptorPool() final;
+
+        bool full() const { return m_liveSetCount == kMaxSets; }
+
+        VkDescriptorSet allocateDescriptorSet(VkDescriptorSetLayout);
+        void freeDescriptorSet(VkDescriptorSet);
+
+    private:
+        VkDescriptorPool m_vkDescriptorPool;
+        uint32_t m_liveSetCount = 0;
+    };
+
+    // Descriptor set that binds a single image texture. Cached on its PLSTextureVulkanImpl for
+    // the life of the texture, so image draws don't allocate descriptors every flush.
+    class ImageDescriptorSet final : public vkutil::RenderingResource
+    {
+    public:
+        ImageDescriptorSet(rcp<vkutil::Allocator>,
+                           rcp<PersistentDescriptorPool>,
+                           VkDescriptorSetLayout,
+                           VkImageView);
+        ~ImageDescriptorSet() final;
+
+        operator VkDescriptorSet() const { return m_vkDescriptorSet; }
+
+    private:
+        const rcp<PersistentDescriptorPool> m_pool;
+        VkDescriptorSet m_vkDescriptorSet;
+    };
+
+    rcp<ImageDescriptorSet> makeImageDescriptorSet(VkDescriptorSetLayout, VkImageView);
+
+    // Descriptor array of every live image texture, which atomic-mode shaders index with the
+    // texture's bindless handle. Only exists if VulkanCapabilities::descriptorIndexing is set.
+    class BindlessTextureTable;
+
+    // Reserves an index in the BindlessTextureTable for the life of a texture. The
+    // vkutil::RenderingResource base keeps the index from being reused until any in-flight command
+    // buffers are done sampling from it.
+    class BindlessTextureSlot final : public vkutil::RenderingResource
+    {
+    public:
+        BindlessTextureSlot(rcp<vkutil::Allocator>, uint32_t index);
+        ~BindlessTextureSlot() final;
+
+        uint32_t index() const { return m_index; }
+
+    private:
+        const uint32_t m_index;
+    };
+
+    // Gives the texture a slot in m_bindlessTextureTable, if there is one.
+    void assignBindlessTextureSlot(PLSTextureVulkanImpl*);
+
+    // Non-null if VK_KHR_push_descriptor is supported. In that case, the per-draw descriptor set
+    // is a push descriptor set and ImageDescriptorSets aren't used.
+    bool usesPushDescriptors() const { return m_vkCmdPushDescriptorSetKHR != nullptr; }
+    PFN_vkCmdPushDescriptorSetKHR m_vkCmdPushDescriptorSetKHR = nullptr;
+
+    // VK_EXT_debug_utils labels around each pass of a flush, when built with RIVE_PLS_TRACING and
+    // the instance enabled the extension.
+    void beginDebugLabel(VkCommandBuffer, const char* label);
+    void endDebugLabel(VkCommandBuffer);
+#ifdef RIVE_PLS_TRACING
+    PFN_vkCmdBeginDebugUtilsLabelEXT m_vkCmdBeginDebugUtilsLabelEXT = nullptr;
+    PFN_vkCmdEndDebugUtilsLabelEXT m_vkCmdEndDebugUtilsLabelEXT = nullptr;
+#endif
+
     void flush(const FlushDescriptor&) override;
+    class DrawPipelineLayout;
+    void recordFlush(const FlushDescriptor&, VkCommandBuffer);
+
+    // Returns the current ring slot's async compute command buffer, beginning it if this is the
+    // frame's first compute work. (ContextOptions::asyncComputeQueue.)
+    VkCommandBuffer beginAsyncComputeWork();
+
+    // Everything a draw pass binds, so its DrawBatches can be recorded into any command buffer.
+    struct DrawPassState
+    {
+        const FlushDescriptor* desc;
+        DrawPipelineLayout* layout;
+        VkDescriptorSet perFlushDescriptorSet;
+        VkDescriptorSet inputAttachmentDescriptorSet;
+        VkRect2D renderTargetRect;
+        VkRect2D renderArea;
+    };
+
+    // A DrawBatch whose pipeline (and image descriptor set, if any) has already been resolved.
+    struct ResolvedDrawBatch
+    {
+        const DrawBatch* batch;
+        VkPipeline vkPipeline;
+        bool needsBarrierBeforeDraw;
+    };
+
+    // Records m_resolvedDrawBatches[begin..end) into a command buffer that is inside the draw
+    // pass's render pass.
+    void recordDrawBatches(VkCommandBuffer, const DrawPassState&, size_t begin, size_t end);
+
+    void precompileShaders(Span<const pls::ShaderVariant>) override;
+
+    bool popGPUFrameTime(pls::GPUFrameTime*) override;
+
+    bool isOverMemoryBudget() override;
 
     double secondsNow() const override
     {
@@ -166,6 +461,11 @@ private:
     const rcp<vkutil::Allocator> m_allocator;
     const VkDevice m_device;
     const VulkanCapabilities m_capabilities;
+    const ContextOptions m_contextOptions;
+
+    // Every pipeline is created through m_vkPipelineCache, which is persisted in
+    // m_contextOptions.pipelineBlobCache (if any) across runs.
+    const VkPipelineCache m_vkPipelineCache;
 
     // PLS buffers.
     vkutil::BufferRing m_flushUniformBufferRing;
@@ -178,6 +478,18 @@ private:
     vkutil::BufferRing m_gradSpanBufferRing;
     vkutil::BufferRing m_tessSpanBufferRing;
     vkutil::BufferRing m_triangleBufferRing;
+    // Backs all of the above when m_contextOptions.singleArenaBuffers is set. Otherwise empty.
+    vkutil::BufferRing m_bufferArena;
+    bool m_bufferArenaLayoutDirty = false;
+
+    // PLS planes for every render target, when m_contextOptions.plsPlaneSizeBucket is nonzero.
+    PLSPlanesVulkan m_sharedPLSPlanes;
+    uint32_t m_sharedPLSPlanesMaxRequestWidth = 0; // Over the current shrink window.
+    uint32_t m_sharedPLSPlanesMaxRequestHeight = 0;
+    uint32_t m_sharedPLSPlanesShrinkWindowFlushCount = 0;
+
+    // Grows (or lazily shrinks) m_sharedPLSPlanes to fit a render target of the given size.
+    PLSPlanesVulkan* sharedPLSPlanes(uint32_t width, uint32_t height);
     std::chrono::steady_clock::time_point m_localEpoch = std::chrono::steady_clock::now();
 
     // Renders color ramps to the gradient texture.
@@ -186,6 +498,7 @@ private:
     rcp<vkutil::Texture> m_gradientTexture;
     rcp<vkutil::TextureView> m_gradTextureView;
     rcp<vkutil::Framebuffer> m_gradTextureFramebuffer;
+    VkImageLayout m_gradTextureLayout = VK_IMAGE_LAYOUT_UNDEFINED; // Layout at the end of a flush.
 
     // Renders tessellated vertices to the tessellation texture.
     class TessellatePipeline;
@@ -195,17 +508,43 @@ private:
     rcp<vkutil::TextureView> m_tessVertexTextureView;
     rcp<vkutil::Framebuffer> m_tessTextureFramebuffer;
 
+    // Expands TessCurves into TessVertexSpans on the GPU (FlushDescriptor::gpuTessellationSpans).
+    // The expanded spans go in m_gpuTessSpanBuffers, at the same offsets the curves occupy in
+    // m_tessSpanBufferRing. Only the first buffer is used unless there is an asyncComputeQueue, in
+    // which case each ring slot needs its own: the previous frame may still be reading its spans
+    // while the next frame's expansion runs.
+    class ExpandTessSpansPipeline;
+    std::unique_ptr<ExpandTessSpansPipeline> m_expandTessSpansPipeline;
+    rcp<vkutil::Buffer> m_gpuTessSpanBuffers[pls::kMaxBufferRingSize]; // Allocated on first use.
+
     // One for pls::InterlockMode::rasterOrdering and one for pls::InterlockMode::atomics.
-    class DrawPipelineLayout;
     std::array<std::unique_ptr<DrawPipelineLayout>, 2> m_drawPipelineLayouts;
 
     class DrawShader;
     std::map<uint32_t, DrawShader> m_drawShaders;
+    std::mutex m_drawShadersMutex; // DrawPipelines are also created on a background thread.
 
     class DrawPipeline;
-    std::map<uint32_t, DrawPipeline> m_drawPipelines;
+    // A null value means the pipeline is being created on the background thread.
+    std::map<uint32_t, std::unique_ptr<DrawPipeline>> m_drawPipelines;
+
+    // Returns the draw pipeline for the given configuration if it's ready. Otherwise, while it's
+    // being created in the background, returns a fully-featured pipeline that can stand in for it.
+    const DrawPipeline* findCompatibleDrawPipeline(pls::DrawType,
+                                                   pls::InterlockMode,
+                                                   pls::ShaderFeatures,
+                                                   DrawPipelineOptions,
+                                                   int renderPassVariantIdx,
+                                                   VkPipelineLayout,
+                                                   VkRenderPass);
+
+    // Declared after m_drawPipelines and m_drawShaders so it shuts down before they are destroyed.
+    class BackgroundPipelineCompiler;
+    class ParallelCommandRecorder;
+    std::unique_ptr<BackgroundPipelineCompiler> m_backgroundPipelineCompiler;
 
     rcp<PLSTextureVulkanImpl> m_nullImageTexture; // Bound when there is not an image paint.
+    std::unique_ptr<BindlessTextureTable> m_bindlessTextureTable;
     VkSampler m_linearSampler;
     VkSampler m_mipmapSampler;
     rcp<vkutil::Buffer> m_pathPatchVertexBuffer;
@@ -213,17 +552,44 @@ private:
     rcp<vkutil::Buffer> m_imageRectVertexBuffer;
     rcp<vkutil::Buffer> m_imageRectIndexBuffer;
 
-    rcp<pls::CommandBufferCompletionFence> m_frameCompletionFences[pls::kBufferRingSize];
+    rcp<pls::CommandBufferCompletionFence> m_frameCompletionFences[pls::kMaxBufferRingSize];
+
+    // Command buffers owned by the context when ContextOptions::internalSubmitQueue is set. Each
+    // ring slot's buffer is reset and re-recorded once its previous frame signals m_timeline.
+    rcp<VulkanTimeline> m_timeline;
+    VkCommandPool m_internalCommandPool = VK_NULL_HANDLE;
+    VkCommandBuffer m_internalCommandBuffers[pls::kMaxBufferRingSize] = {};
+    rcp<VulkanTimelineFence> m_internalFrameFence; // Signaled by the frame being recorded.
+    // ExternalAccess semaphores of the targets in the frame being recorded.
+    std::vector<VkSemaphore> m_externalWaitSemaphores;
+    std::vector<VkSemaphore> m_externalSignalSemaphores;
+
+    // ContextOptions::asyncComputeQueue. Compute command buffers come from m_internalCommandPool,
+    // and get recorded lazily, the first time a frame has compute work.
+    rcp<VulkanTimeline> m_asyncComputeTimeline;
+    VkCommandBuffer m_asyncComputeCommandBuffers[pls::kMaxBufferRingSize] = {};
+    rcp<VulkanTimelineFence> m_asyncComputeFence; // Non-null once this frame has compute work.
+
     uint64_t m_currentFrameIdx = 0;
     int m_bufferRingIdx = -1;
 
+    // Two timestamps (beginning and end of frame) for each buffer ring slot, for frames that
+    // requested GPU timing. Created the first time a frame requests it.
+    VkQueryPool m_gpuTimerQueryPool = VK_NULL_HANDLE;
+    struct PendingGPUTimer
+    {
+        int bufferRingIdx;
+        uint64_t frameNumber;
+    };
+    std::deque<PendingGPUTimer> m_pendingGPUTimers; // In submission order.
+
     // A vkutil::RenderingResource that has been fully released, but whose
     // underlying Vulkan object may still be referenced by an in-flight command
     // buffer.
     template <typename T> struct ZombieResource
     {
-        ZombieResource(T* resource_, uint64_t lastFrameUsed) :
-            resource(resource_), expirationFrameIdx(lastFrameUsed + pls::kBufferRingSize)
+        ZombieResource(T* resource_, uint64_t expirationFrameIdx_) :
+            resource(resource_), expirationFrameIdx(expirationFrameIdx_)
         {
             assert(resource_->debugging_refcnt() == 0);
         }
@@ -237,6 +603,17 @@ private:
     // recycled once their expirationFrameIdx is reached.
     std::deque<ZombieResource<DescriptorSetPool>> m_descriptorSetPoolPool;
 
+    // Reused from flush to flush to avoid reallocating.
+    std::vector<ResolvedDrawBatch> m_resolvedDrawBatches;
+    std::vector<VkCommandBuffer> m_secondaryCommandBuffers;
+
+    // Non-null if ContextOptions::parallelRecordingThreadCount is nonzero.
+    std::unique_ptr<ParallelCommandRecorder> m_parallelCommandRecorder;
+
+    // Pool that new ImageDescriptorSets get allocated from. Replaced once it fills up; older
+    // pools live on until every set allocated from them is released.
+    rcp<PersistentDescriptorPool> m_persistentDescriptorPool;
+
     // Temporary storage for vkutil::RenderingResource instances that have been
     // fully released, but need to persist until in-flight command buffers have
     // finished referencing their underlying Vulkan objects.
@@ -51,10 +51,54 @@ enum class Mappability
     readWrite,
 };
 
+// What a Buffer or Texture is used for, so the Allocator can report where GPU memory is going.
+enum class MemoryCategory
+{
+    other,
+    bufferRings,      // The PLS context's per-flush buffers (all kBufferRingSize slots).
+    renderBuffers,    // Client RenderBuffers.
+    resourceTextures, // Gradient and tessellation textures.
+    plsPlanes,        // Offscreen coverage, clip, and scratch color planes of render targets.
+    imageTextures,    // Client image textures, including their upload buffers.
+};
+constexpr static size_t kMemoryCategoryCount = 6;
+
+// Device-local memory usage of this process, vs. how much it can use before the driver starts
+// evicting or the OS starts killing processes.
+struct MemoryBudget
+{
+    uint64_t usageBytes = 0;
+    uint64_t budgetBytes = 0;
+};
+
+// Memory that was allocated outside of this Allocator (e.g., by a video decoder, encoder, or
+// compositor), to be bound to an image with Allocator::importTexture().
+struct ExternalMemoryHandle
+{
+    // VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT (requires VK_EXT_external_memory_dma_buf),
+    // VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT (requires VK_KHR_external_memory_fd), or
+    // VK_EXTERNAL_MEMORY_HANDLE_TYPE_ANDROID_HARDWARE_BUFFER_BIT_ANDROID (requires
+    // VK_ANDROID_external_memory_android_hardware_buffer).
+    VkExternalMemoryHandleTypeFlagBits handleType;
+    // For the fd handle types. Vulkan takes ownership of the file descriptor once it's imported.
+    int fd = -1;
+#ifdef VK_USE_PLATFORM_ANDROID_KHR
+    // Vulkan acquires its own reference to the buffer; the caller keeps theirs.
+    AHardwareBuffer* hardwareBuffer = nullptr;
+#endif
+};
+
 class Allocator : public RefCnt<Allocator>
 {
 public:
-    Allocator(VkInstance, VkPhysicalDevice, VkDevice, uint32_t vulkanApiVersion);
+    // If EXT_memory_budget is true, the client must have enabled VK_EXT_memory_budget on the device
+    // (and, on Vulkan 1.0, VK_KHR_get_physical_device_properties2 on the instance). Otherwise,
+    // memory budgets are estimated from the heap sizes and this allocator's own usage.
+    Allocator(VkInstance,
+              VkPhysicalDevice,
+              VkDevice,
+              uint32_t vulkanApiVersion,
+              bool EXT_memory_budget = false);
     ~Allocator();
 
     VkDevice device() const { return m_device; }
@@ -78,18 +122,51 @@ public:
 
     VmaAllocator vmaAllocator() const { return m_vmaAllocator; }
 
-    rcp<Buffer> makeBuffer(const VkBufferCreateInfo&, Mappability);
+    rcp<Buffer> makeBuffer(const VkBufferCreateInfo&,
+                           Mappability,
+                           MemoryCategory = MemoryCategory::other);
+
+    rcp<Texture> makeTexture(const VkImageCreateInfo&, MemoryCategory = MemoryCategory::other);
 
-    rcp<Texture> makeTexture(const VkImageCreateInfo&);
+    // Creates a texture whose image is bound to external memory instead of memory from VMA, so
+    // Rive can render straight into buffers owned by other APIs or processes. VkImageCreateInfo
+    // must describe the external buffer exactly; DMA-BUFs with DRM format modifiers need
+    // VK_IMAGE_TILING_DRM_FORMAT_MODIFIER_EXT and a VkImageDrmFormatModifierExplicitCreateInfoEXT
+    // chained on pNext. Imported textures don't count toward allocatedBytes().
+    rcp<Texture> importTexture(const VkImageCreateInfo&, const ExternalMemoryHandle&);
 
     rcp<TextureView> makeTextureView(rcp<Texture>);
     rcp<TextureView> makeTextureView(rcp<Texture> textureRefOrNull, const VkImageViewCreateInfo&);
 
     rcp<Framebuffer> makeFramebuffer(const VkFramebufferCreateInfo&);
 
+    // Bytes currently allocated for Buffers and Textures of the given category. Transient
+    // attachments in lazily-allocated memory aren't included (see lazilyAllocatedBytes()).
+    uint64_t allocatedBytes(MemoryCategory category) const
+    {
+        return m_allocatedBytes[static_cast<size_t>(category)];
+    }
+
+    // Bytes reserved for transient attachments in lazily-allocated memory. Tiling GPUs only commit
+    // this memory if an attachment spills out of tile memory, which PLS planes never need to.
+    uint64_t lazilyAllocatedBytes() const { return m_lazilyAllocatedBytes; }
+
+    // Sums the budgets of all device-local heaps. Also advances VMA's frame index, which is when it
+    // re-fetches VK_EXT_memory_budget from the driver, so call this at most about once per frame.
+    MemoryBudget queryDeviceLocalMemoryBudget();
+
 private:
+    friend class Buffer;
+    friend class Texture;
+
+    void didAllocate(MemoryCategory, VmaAllocation, bool isLazilyAllocated = false);
+    void willFree(MemoryCategory, VmaAllocation, bool isLazilyAllocated = false);
+
     VkDevice m_device;
     VmaAllocator m_vmaAllocator;
+    uint32_t m_vmaFrameIndex = 0;
+    uint64_t m_allocatedBytes[kMemoryCategoryCount] = {};
+    uint64_t m_lazilyAllocatedBytes = 0;
     // Weak pointer back to the PLS context.
     PLSRenderContextVulkanImpl* m_plsImplVulkan = nullptr;
 };
@@ -146,11 +223,12 @@ public:
 private:
     friend class Allocator;
 
-    Buffer(rcp<Allocator>, const VkBufferCreateInfo&, Mappability);
+    Buffer(rcp<Allocator>, const VkBufferCreateInfo&, Mappability, MemoryCategory);
 
     void init();
 
     const Mappability m_mappability;
+    const MemoryCategory m_memoryCategory;
     VkBufferCreateInfo m_info;
     VmaAllocation m_vmaAllocation;
     VkBuffer m_vkBuffer;
@@ -182,26 +260,30 @@ public:
     BufferRing(rcp<vkutil::Allocator> allocator,
                VkBufferUsageFlags usage,
                Mappability mappability,
-               size_t size = 0) :
-        m_targetSize(size)
+               int ringSize,
+               size_t size = 0,
+               MemoryCategory memoryCategory = MemoryCategory::bufferRings) :
+        m_ringSize(ringSize), m_usage(usage), m_targetSize(size)
     {
+        assert(1 <= m_ringSize && m_ringSize <= pls::kMaxBufferRingSize);
         VkBufferCreateInfo bufferCreateInfo = {
             .size = size,
             .usage = usage,
         };
-        for (int i = 0; i < pls::kBufferRingSize; ++i)
+        for (int i = 0; i < m_ringSize; ++i)
         {
-            m_buffers[i] = allocator->makeBuffer(bufferCreateInfo, mappability);
+            m_buffers[i] = allocator->makeBuffer(bufferCreateInfo, mappability, memoryCategory);
         }
     }
 
+    int ringSize() const { return m_ringSize; }
     size_t size() const { return m_targetSize; }
 
     void setTargetSize(size_t size)
     {
         // Buffers always get bound, even if unused, so make sure they aren't empty
         // and we get a valid Vulkan handle.
-        if (m_buffers[0]->info().usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
+        if (m_usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
         {
             size = std::max<size_t>(size, 256);
             // Uniform blocks must be multiples of 256 bytes in size.
@@ -214,38 +296,157 @@ public:
         m_targetSize = size;
     }
 
+    // Makes this ring sub-allocate its memory from 'arena' at the given byte offset, instead of
+    // from its own buffers. The arena is responsible for synchronizing its size and flushing its
+    // mapped contents. Pass null to go back to using this ring's own buffers.
+    void setArena(BufferRing* arena, size_t offsetInArena)
+    {
+        assert(arena == nullptr || arena->m_ringSize == m_ringSize);
+        m_arena = arena;
+        m_offsetInArena = arena != nullptr ? offsetInArena : 0;
+    }
+
+    // Byte offset of this ring's data within vkBufferAt(). Nonzero when sub-allocated from an
+    // arena.
+    VkDeviceSize offset() const { return m_offsetInArena; }
+
+    // Keeps this ring's data in device-local memory that the host can't map, for GPUs that would
+    // otherwise read it over PCIe. The mapped buffers then only stage the data, and
+    // recordUploadAt() copies it into the device-local buffer that vkBufferAt() returns. Must be
+    // called while the ring is still empty, and has no effect while sub-allocated from an arena.
+    void makeDeviceLocal(Allocator* allocator, MemoryCategory memoryCategory)
+    {
+        for (int i = 0; i < m_ringSize; ++i)
+        {
+            assert(m_buffers[i]->info().size == 0);
+            m_buffers[i] = allocator->makeBuffer({.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT},
+                                                 Mappability::writeOnly,
+                                                 memoryCategory);
+            m_deviceLocalBuffers[i] =
+                allocator->makeBuffer({.usage = m_usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT},
+                                      Mappability::none,
+                                      memoryCategory);
+        }
+    }
+
+    bool isDeviceLocal() const { return m_deviceLocalBuffers[0] != nullptr; }
+
+    // Does the device-local buffer have data waiting in its staging buffer?
+    bool hasPendingUpload() const { return m_pendingUploadSize > 0; }
+
+    // Copies the data staged since the last upload into the device-local buffer. The caller is
+    // responsible for the barrier between the copy and the buffer's readers. Returns false if
+    // there was nothing to copy.
+    bool recordUploadAt(VkCommandBuffer commandBuffer, int bufferRingIdx)
+    {
+        if (!isDeviceLocal() || m_arena != nullptr || !hasPendingUpload())
+        {
+            return false;
+        }
+        VkBufferCopy bufferCopy = {.size = m_pendingUploadSize};
+        vkCmdCopyBuffer(commandBuffer,
+                        *m_buffers[bufferRingIdx],
+                        *m_deviceLocalBuffers[bufferRingIdx],
+                        1,
+                        &bufferCopy);
+        m_pendingUploadSize = 0;
+        return true;
+    }
+
+    // Frees the staging buffers of a device-local ring whose contents will never change again.
+    void releaseStagingBuffers()
+    {
+        assert(isDeviceLocal());
+        assert(!hasPendingUpload());
+        for (int i = 0; i < m_ringSize; ++i)
+        {
+            m_buffers[i] = nullptr;
+        }
+    }
+
     void synchronizeSizeAt(int bufferRingIdx)
     {
+        if (m_arena != nullptr)
+        {
+            return;
+        }
         if (m_buffers[bufferRingIdx]->info().size != m_targetSize)
         {
             m_buffers[bufferRingIdx]->resizeImmediately(m_targetSize);
         }
+        if (isDeviceLocal() && m_deviceLocalBuffers[bufferRingIdx]->info().size != m_targetSize)
+        {
+            m_deviceLocalBuffers[bufferRingIdx]->resizeImmediately(m_targetSize);
+        }
     }
 
     void* contentsAt(int bufferRingIdx, size_t dirtySize = VK_WHOLE_SIZE)
     {
+        if (m_arena != nullptr)
+        {
+            // Extend the arena's dirty range to cover ours.
+            size_t dirtyEnd = m_offsetInArena + std::min(dirtySize, m_targetSize);
+            m_arena->m_pendingFlushSize = std::max(m_arena->m_pendingFlushSize, dirtyEnd);
+            return static_cast<uint8_t*>(m_arena->m_buffers[bufferRingIdx]->contents()) +
+                   m_offsetInArena;
+        }
         m_pendingFlushSize = dirtySize;
+        if (isDeviceLocal())
+        {
+            m_pendingUploadSize = std::max(m_pendingUploadSize, std::min(dirtySize, m_targetSize));
+        }
         return m_buffers[bufferRingIdx]->contents();
     }
 
     void flushMappedContentsAt(int bufferRingIdx)
     {
+        if (m_arena != nullptr)
+        {
+            return; // The arena flushes all its sub-allocations at once.
+        }
         assert(m_pendingFlushSize > 0);
         m_buffers[bufferRingIdx]->flushMappedContents(m_pendingFlushSize);
         m_pendingFlushSize = 0;
     }
 
-    VkBuffer vkBufferAt(int bufferRingIdx) const { return *m_buffers[bufferRingIdx]; }
+    // Flushes the mapped contents of an arena, if any of its sub-allocations were written.
+    void flushPendingContentsAt(int bufferRingIdx)
+    {
+        if (m_pendingFlushSize > 0)
+        {
+            flushMappedContentsAt(bufferRingIdx);
+        }
+    }
+
+    VkBuffer vkBufferAt(int bufferRingIdx) const
+    {
+        if (m_arena != nullptr)
+        {
+            return m_arena->vkBufferAt(bufferRingIdx);
+        }
+        return isDeviceLocal() ? *m_deviceLocalBuffers[bufferRingIdx] : *m_buffers[bufferRingIdx];
+    }
 
     const VkBuffer* vkBufferAtAddressOf(int bufferRingIdx) const
     {
-        return m_buffers[bufferRingIdx]->vkBufferAddressOf();
+        if (m_arena != nullptr)
+        {
+            return m_arena->vkBufferAtAddressOf(bufferRingIdx);
+        }
+        return isDeviceLocal() ? m_deviceLocalBuffers[bufferRingIdx]->vkBufferAddressOf()
+                               : m_buffers[bufferRingIdx]->vkBufferAddressOf();
     }
 
 private:
+    const int m_ringSize;
+    const VkBufferUsageFlags m_usage;
     size_t m_targetSize;
     size_t m_pendingFlushSize = 0;
-    rcp<vkutil::Buffer> m_buffers[pls::kBufferRingSize];
+    size_t m_pendingUploadSize = 0; // Only for device-local rings.
+    BufferRing* m_arena = nullptr;
+    size_t m_offsetInArena = 0;
+    rcp<vkutil::Buffer> m_buffers[pls::kMaxBufferRingSize];
+    rcp<vkutil::Buffer> m_deviceLocalBuffers[pls::kMaxBufferRingSize]; // See makeDeviceLocal().
 };
 
 class Texture : public RenderingResource
@@ -257,14 +458,21 @@ public:
     operator VkImage() const { return m_vkImage; }
     const VkImage* vkImageAddressOf() const { return &m_vkImage; }
 
+    // True if this is a transient attachment that got lazily-allocated memory.
+    bool isLazilyAllocated() const { return m_isLazilyAllocated; }
+
 private:
     friend class Allocator;
 
-    Texture(rcp<Allocator>, const VkImageCreateInfo&);
+    Texture(rcp<Allocator>, const VkImageCreateInfo&, MemoryCategory);
+    Texture(rcp<Allocator>, const VkImageCreateInfo&, const ExternalMemoryHandle&);
 
+    const MemoryCategory m_memoryCategory;
     VkImageCreateInfo m_info;
-    VmaAllocation m_vmaAllocation;
+    VmaAllocation m_vmaAllocation = VK_NULL_HANDLE;
+    VkDeviceMemory m_importedMemory = VK_NULL_HANDLE; // Only for imported textures.
     VkImage m_vkImage;
+    bool m_isLazilyAllocated = false;
 };
 
 class TextureView : public RenderingResource
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2024 Rive
+ */
+
+#pragma once
+
+#include "rive/pls/pls.hpp"
+#include <vulkan/vulkan.h>
+
+namespace rive::pls
+{
+class VulkanTimeline;
+
+// CommandBufferCompletionFence that signals once a VulkanTimeline reaches a specific value.
+// Unlike VulkanFence, there is no VkFence behind it, so making one doesn't touch the driver.
+class VulkanTimelineFence : public CommandBufferCompletionFence
+{
+public:
+    VulkanTimelineFence(rcp<VulkanTimeline> timeline, uint64_t value) :
+        m_timeline(std::move(timeline)), m_value(value)
+    {}
+
+    uint64_t value() const { return m_value; }
+
+    void wait() override;
+
+private:
+    const rcp<VulkanTimeline> m_timeline;
+    const uint64_t m_value;
+};
+
+// Wraps a single Vulkan 1.2 timeline semaphore (VK_KHR_timeline_semaphore). Every frame reserves
+// the next value on the timeline and signals it from its submission, so one semaphore can stand in
+// for a whole pool of VkFences, and a frame can be waited on by value without any per-frame
+// driver objects.
+class VulkanTimeline : public RefCnt<VulkanTimeline>
+{
+public:
+    VulkanTimeline(VkDevice);
+    ~VulkanTimeline();
+
+    VkSemaphore vkSemaphore() const { return m_vkSemaphore; }
+
+    // Reserves the next value on the timeline and returns a fence that waits for it. The caller
+    // is responsible to signal fence->value() from a queue submission (see
+    // VkTimelineSemaphoreSubmitInfo).
+    rcp<VulkanTimelineFence> makeFence();
+
+    // Most recent value handed out by makeFence().
+    uint64_t lastReservedValue() const { return m_lastReservedValue; }
+
+    // Value the GPU has most recently signaled.
+    uint64_t completedValue() const;
+
+    // Blocks until the GPU has signaled 'value'.
+    void wait(uint64_t value) const;
+
+private:
+    const VkDevice m_device;
+    VkSemaphore m_vkSemaphore;
+    uint64_t m_lastReservedValue = 0;
+};
+} // namespace rive::pls
@@ -7,7 +7,9 @@
 #include "rive/pls/pls_render_context_helper_impl.hpp"
 #include "rive/pls/webgpu/em_js_handle.hpp"
 #include "rive/pls/gl/load_store_actions_ext.hpp"
+#include <array>
 #include <map>
+#include <vector>
 #include <webgpu/webgpu_cpp.h>
 
 namespace rive::pls
@@ -64,6 +66,12 @@ public:
     {
         PixelLocalStorageType plsType = PixelLocalStorageType::none;
         bool disableStorageBuffers = false;
+        // Don't record the draw list into a wgpu::RenderBundle for replay on subsequent frames
+        // whose draw lists and bindings are structurally identical.
+        bool disableRenderBundles = false;
+        // How many frames the CPU can prepare ahead of the GPU. Clamped to [kMinBufferRingSize,
+        // kMaxBufferRingSize].
+        int bufferRingSize = pls::kBufferRingSize;
     };
 
     static std::unique_ptr<PLSRenderContext> MakeContext(
@@ -85,6 +93,10 @@ public:
                                      uint32_t mipLevelCount,
                                      const uint8_t imageDataRGBA[]) override;
 
+    rcp<PLSRenderTarget> makeLayerRenderTarget(uint32_t width,
+                                               uint32_t height,
+                                               rcp<PLSTexture>* layerTexture) override;
+
 protected:
     PLSRenderContextWebGPUImpl(wgpu::Device device,
                                wgpu::Queue queue,
@@ -137,6 +149,21 @@ private:
 
     void flush(const FlushDescriptor&) override;
 
+    void precompileShaders(Span<const pls::ShaderVariant>) override;
+
+    // Returns a PER_FLUSH_BINDINGS_SET bind group for desc's buffers, recycling a cached one if
+    // possible. All of its buffer bindings take dynamic offsets.
+    wgpu::BindGroup findOrCreatePerFlushBindGroup(const FlushDescriptor&);
+
+    // Encodes the bindings and draw calls for desc.drawList. DrawEncoder is either a
+    // wgpu::RenderPassEncoder or a wgpu::RenderBundleEncoder.
+    template <typename DrawEncoder>
+    void encodeDrawList(DrawEncoder, const FlushDescriptor&, wgpu::TextureFormat framebufferFormat);
+
+    // Writes every handle, offset, and batch parameter that encodeDrawList() depends on into
+    // m_drawBundleKey. Two flushes with equal keys encode identical commands.
+    void buildDrawBundleKey(const FlushDescriptor&, wgpu::TextureFormat framebufferFormat);
+
     const wgpu::Device m_device;
     const wgpu::Queue m_queue;
     const ContextOptions m_contextOptions;
@@ -181,5 +208,27 @@ private:
     wgpu::Buffer m_pathPatchIndexBuffer;
     wgpu::Texture m_nullImagePaintTexture; // Bound when there is not an image paint.
     wgpu::TextureView m_nullImagePaintTextureView;
+
+    struct CachedPerFlushBindGroup
+    {
+        std::array<uint64_t, 8> key;
+        size_t pathCount;
+        size_t contourCount;
+        wgpu::BindGroup bindGroup;
+    };
+    constexpr static size_t kMaxCachedPerFlushBindGroups = pls::kMaxBufferRingSize * 2;
+    std::vector<CachedPerFlushBindGroup> m_perFlushBindGroups;
+
+    // Recorded draw lists, most recently used first. Buffers rotate through their rings, so a
+    // looping animation produces one bundle per ring slot. Each bundle holds references to the
+    // objects it binds, so the raw handles in its key can't be recycled while it is cached.
+    struct CachedDrawBundle
+    {
+        std::vector<uint64_t> key;
+        wgpu::RenderBundle bundle;
+    };
+    constexpr static size_t kMaxCachedDrawBundles = pls::kMaxBufferRingSize * 2;
+    std::vector<CachedDrawBundle> m_drawBundles;
+    std::vector<uint64_t> m_drawBundleKey;
 };
 } // namespace rive::pls
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2024 Rive
+ */
+
+#pragma once
+
+#include "rive/pls/pls_render_context.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rive::pls
+{
+// Fixed set of threads that implements PLSRenderContext::ParallelForFn, for clients that don't
+// already have a job system of their own. The thread that calls parallelFor() participates as
+// threadIdx 0, so a pool of N threads only spawns N - 1 workers. (In Emscripten builds with
+// pthreads, the workers are Web Workers.)
+//
+// Pair with PLSRenderContext::setRecordingThreadCount(threadCount()).
+class WorkerPool
+{
+public:
+    // Uses std::thread::hardware_concurrency() threads if 'threadCount' is 0.
+    explicit WorkerPool(size_t threadCount = 0);
+    ~WorkerPool();
+
+    size_t threadCount() const { return m_workers.size() + 1; }
+
+    // Invokes fn(threadIdx, i) for every i in [0, count), and returns once every call has
+    // completed. Not reentrant: only one thread may call parallelFor() at a time.
+    void parallelFor(size_t count, const std::function<void(size_t threadIdx, size_t i)>& fn);
+
+    // Returns a ParallelForFn that runs on this pool, e.g., for
+    // PLSRenderContext::FlushResources::parallelFor or PLSRenderer::drawPathsInParallel().
+    PLSRenderContext::ParallelForFn parallelForFn()
+    {
+        return [this](size_t count, const std::function<void(size_t threadIdx, size_t i)>& fn) {
+            parallelFor(count, fn);
+        };
+    }
+
+private:
+    void workerMain(size_t threadIdx);
+
+    // Claims and runs indices of the current job until there are none left.
+    void runJob(size_t threadIdx);
+
+    std::vector<std::thread> m_workers;
+
+    // The current job. Only written while no workers are running it.
+    const std::function<void(size_t threadIdx, size_t i)>* m_jobFn = nullptr;
+    size_t m_jobCount = 0;
+    std::atomic<size_t> m_nextJobIdx = 0;
+
+    // Guarded by m_mutex.
+    uint64_t m_jobID = 0;
+    size_t m_busyWorkerCount = 0;
+    bool m_shouldQuit = false;
+
+    std::mutex m_mutex;
+    std::condition_variable m_jobPostedCondition;
+    std::condition_variable m_jobFinishedCondition;
+};
+} // namespace rive::pls
@@ -352,6 +352,10 @@ public:
                 VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RASTERIZATION_ORDER_ATTACHMENT_ACCESS_FEATURES_EXT,
         };
 
+        VkPhysicalDeviceDescriptorIndexingFeaturesEXT availableDescriptorIndexingFeatures{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT,
+        };
+
 #if 0
         printf("Device extensions:\n");
         for (const VkExtensionProperties& ext : deviceAvailableExtensions)
@@ -363,6 +367,14 @@ public:
         std::vector<const char*> deviceEnabledExtensions;
 
         VulkanCapabilities capabilities;
+        if (deviceProps.limits.timestampComputeAndGraphics)
+        {
+            capabilities.timestampPeriod = deviceProps.limits.timestampPeriod;
+        }
+        capabilities.maxRenderableImageDimension =
+            std::min(deviceProps.limits.maxImageDimension2D,
+                     deviceProps.limits.maxFramebufferHeight);
+        capabilities.discreteGPU = deviceProps.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU;
         bool KHR_swapchain = false;
         for (const VkExtensionProperties& ext : deviceAvailableExtensions)
         {
@@ -391,6 +403,19 @@ public:
                 availablePhysicalDeviceFeatures2.pNext = &availableRasterOrderFeatures;
                 continue;
             }
+            if (strcmp(ext.extensionName, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME) == 0)
+            {
+                capabilities.descriptorIndexing = true;
+                availableDescriptorIndexingFeatures.pNext = availablePhysicalDeviceFeatures2.pNext;
+                availablePhysicalDeviceFeatures2.pNext = &availableDescriptorIndexingFeatures;
+                continue;
+            }
+            if (strcmp(ext.extensionName, VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME) == 0)
+            {
+                deviceEnabledExtensions.push_back(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+                capabilities.KHR_push_descriptor = true;
+                continue;
+            }
         }
 
         if (!options.allowHeadlessRendering && !KHR_swapchain)
@@ -428,6 +453,24 @@ public:
             }
         }
 
+        // Bindless image textures need every one of these descriptor indexing features.
+        if (capabilities.descriptorIndexing)
+        {
+            if (availableDescriptorIndexingFeatures.runtimeDescriptorArray &&
+                availableDescriptorIndexingFeatures.descriptorBindingPartiallyBound &&
+                availableDescriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind &&
+                availableDescriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending &&
+                availableDescriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing)
+            {
+                deviceEnabledExtensions.push_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+                deviceEnabledExtensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+            }
+            else
+            {
+                capabilities.descriptorIndexing = false;
+            }
+        }
+
         VkDeviceCreateInfo deviceCreateInfo = {
             .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
             .queueCreateInfoCount = 1,
@@ -449,6 +492,21 @@ public:
             physicalDeviceFeatures2.features.fragmentStoresAndAtomics = true;
             capabilities.fragmentStoresAndAtomics = true;
         }
+        if (availablePhysicalDeviceFeatures2.features.textureCompressionETC2)
+        {
+            physicalDeviceFeatures2.features.textureCompressionETC2 = true;
+            capabilities.textureCompressionETC2 = true;
+        }
+        if (availablePhysicalDeviceFeatures2.features.textureCompressionASTC_LDR)
+        {
+            physicalDeviceFeatures2.features.textureCompressionASTC_LDR = true;
+            capabilities.textureCompressionASTC_LDR = true;
+        }
+        if (availablePhysicalDeviceFeatures2.features.textureCompressionBC)
+        {
+            physicalDeviceFeatures2.features.textureCompressionBC = true;
+            capabilities.textureCompressionBC = true;
+        }
 
         VkPhysicalDeviceRasterizationOrderAttachmentAccessFeaturesEXT rasterOrderFeatures{
             .sType =
@@ -462,6 +520,21 @@ public:
             physicalDeviceFeatures2.pNext = &rasterOrderFeatures;
         }
 
+        VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT,
+            .shaderSampledImageArrayNonUniformIndexing = VK_TRUE,
+            .descriptorBindingSampledImageUpdateAfterBind = VK_TRUE,
+            .descriptorBindingUpdateUnusedWhilePending = VK_TRUE,
+            .descriptorBindingPartiallyBound = VK_TRUE,
+            .runtimeDescriptorArray = VK_TRUE,
+        };
+
+        if (capabilities.descriptorIndexing)
+        {
+            descriptorIndexingFeatures.pNext = physicalDeviceFeatures2.pNext;
+            physicalDeviceFeatures2.pNext = &descriptorIndexingFeatures;
+        }
+
         if (instanceExtensions.KHR_get_physical_device_properties2)
         {
             deviceCreateInfo.pNext = &physicalDeviceFeatures2;
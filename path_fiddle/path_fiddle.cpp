@@ -46,6 +46,7 @@ static bool s_forceAtomicMode = false;
 static bool s_wireframe = false;
 static bool s_disableFill = false;
 static bool s_disableStroke = false;
+static bool s_overdrawHeatmap = false;
 
 static std::unique_ptr<FiddleContext> s_fiddleContext;
 
@@ -223,6 +224,10 @@ static void key_callback(GLFWwindow* window, int key, int scancode, int action,
             case GLFW_KEY_W:
                 s_wireframe = !s_wireframe;
                 break;
+            case GLFW_KEY_V:
+                s_overdrawHeatmap = !s_overdrawHeatmap;
+                s_needsTitleUpdate = true;
+                break;
             case GLFW_KEY_C:
                 s_cap = static_cast<StrokeCap>((static_cast<int>(s_cap) + 1) % 3);
                 break;
@@ -666,6 +671,18 @@ static void update_window_title(double fps, int instances, int width, int height
         title << " (atomic)";
     }
     title << " | " << width << " x " << height;
+    rive::pls::PLSRenderContext* plsContext = s_fiddleContext->plsContextOrNull();
+    if (s_overdrawHeatmap && plsContext != nullptr)
+    {
+        const auto& stats = plsContext->lastFrameStats();
+        if (stats.renderTargetPixelArea != 0)
+        {
+            title << " | overdraw "
+                  << static_cast<double>(stats.overdrawHeatmap.totalFragmentCount) /
+                         stats.renderTargetPixelArea
+                  << "x (max " << stats.overdrawHeatmap.maxTileFragmentsPerPixel << "x)";
+        }
+    }
     glfwSetWindowTitle(s_window, title.str().c_str());
 }
 
@@ -715,6 +732,7 @@ void riveMainLoop()
         .wireframe = s_wireframe,
         .fillsDisabled = s_disableFill,
         .strokesDisabled = s_disableStroke,
+        .overdrawHeatmap = s_overdrawHeatmap,
     });
 
     int instances = 1;
@@ -0,0 +1,1255 @@
+/*
+ * Copyright 2024 Rive
+ */
+
+// Headless benchmark harness for the PLS renderer. Renders a .riv file, or a set of synthetic
+// scenes that stress specific parts of the pipeline, into an invisible window for a fixed number of
+// frames, and reports CPU and GPU frame time percentiles as JSON.
+//
+//   pls_bench [--gl|--vk|--metal|--d3d|--dawn|...] [--atomic] [--msaaN] [--size WxH]
+//             [--frames N] [--warmup N] [--scene strokes|fills|clips|gradients|imagemesh]
+//             [--out results.json] [--capture out.rcap] [--replay in.rcap | my.riv]
+//
+//   pls_bench --sortbench [--frames N] [--out results.json]
+//
+// --capture records the benchmarked Renderer calls into a pls::PLSCaptureRenderer capture, and
+// --replay benchmarks a capture instead of a .riv file (or the synthetic scenes). Captures replay
+// at the bench's --size, with stand-in checkerboards for any images.
+//
+// --sortbench skips rendering and instead compares std::sort against pls::SortInt64Keys() on
+// synthetic draw-list sort keys, laid out like the ones LogicalFlush reorders in atomic and
+// depthStencil modes.
+//
+// All synthetic content is generated from fixed seeds, so results are comparable across runs and
+// across backends.
+
+#include "fiddle_context.hpp"
+
+#include "rive/math/math_types.hpp"
+#include "rive/math/simd.hpp"
+#include "rive/artboard.hpp"
+#include "rive/file.hpp"
+#include "rive/layout.hpp"
+#include "rive/animation/state_machine_instance.hpp"
+#include "rive/static_scene.hpp"
+#include "rive/pls/pls_capture.hpp"
+#include "rive/pls/pls_render_context.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#define GLFW_INCLUDE_NONE
+#include "GLFW/glfw3.h"
+
+using namespace rive;
+using PLSRenderContext = rive::pls::PLSRenderContext;
+
+constexpr static char kMoltenVKICD[] =
+    "dependencies/MoltenVK/Package/Release/MoltenVK/dynamic/dylib/macOS/MoltenVK_icd.json";
+
+constexpr static char kSwiftShaderICD[] = "dependencies/SwiftShader/build/"
+#ifdef __APPLE__
+                                          "Darwin"
+#elif defined(_WIN32)
+                                          "Windows"
+#else
+                                          "Linux"
+#endif
+                                          "/vk_swiftshader_icd.json";
+
+// Deterministic pseudo-random numbers, so every run draws the exact same content.
+class LCG
+{
+public:
+    explicit LCG(uint32_t seed) : m_state(seed) {}
+
+    uint32_t next()
+    {
+        m_state = m_state * 1664525u + 1013904223u;
+        return m_state;
+    }
+
+    // Uniform float in [lo, hi).
+    float f(float lo, float hi) { return lo + (hi - lo) * ((next() >> 8) * (1.f / (1 << 24))); }
+
+    ColorInt color(uint8_t alpha = 0xff) { return (alpha << 24) | (next() >> 8); }
+
+private:
+    uint32_t m_state;
+};
+
+static void add_circle(RawPath* path, float cx, float cy, float r)
+{
+    constexpr static float kC = 0.5522847498f; // 4/3 * (sqrt(2) - 1)
+    float k = r * kC;
+    path->moveTo(cx + r, cy);
+    path->cubicTo(cx + r, cy + k, cx + k, cy + r, cx, cy + r);
+    path->cubicTo(cx - k, cy + r, cx - r, cy + k, cx - r, cy);
+    path->cubicTo(cx - r, cy - k, cx - k, cy - r, cx, cy - r);
+    path->cubicTo(cx + k, cy - r, cx + r, cy - k, cx + r, cy);
+    path->close();
+}
+
+static void add_rect(RawPath* path, float l, float t, float r, float b)
+{
+    path->moveTo(l, t);
+    path->lineTo(r, t);
+    path->lineTo(r, b);
+    path->lineTo(l, b);
+    path->close();
+}
+
+// A reproducible chunk of content to benchmark.
+class BenchScene
+{
+public:
+    virtual ~BenchScene() {}
+    virtual const char* name() const = 0;
+    virtual void draw(Renderer*, int frameIdx) = 0;
+
+    // Lets the scene override how each frame is rendered (e.g., to match a capture).
+    virtual void updateFrameDescriptor(PLSRenderContext::FrameDescriptor*, int frameIdx) {}
+};
+
+// Thousands of small, short-lived strokes with every cap and join. Stresses tessellation and
+// per-path CPU overhead.
+class StrokesScene : public BenchScene
+{
+public:
+    StrokesScene(Factory* factory, int width, int height)
+    {
+        constexpr static int kStrokeCount = 4000;
+        LCG rand(1);
+        for (int i = 0; i < kStrokeCount; ++i)
+        {
+            RawPath rawPath;
+            float x = rand.f(0, width), y = rand.f(0, height);
+            rawPath.moveTo(x, y);
+            rawPath.cubicTo(x + rand.f(-40, 40),
+                            y + rand.f(-40, 40),
+                            x + rand.f(-40, 40),
+                            y + rand.f(-40, 40),
+                            x + rand.f(-40, 40),
+                            y + rand.f(-40, 40));
+            rawPath.lineTo(x + rand.f(-40, 40), y + rand.f(-40, 40));
+            m_paths.push_back(factory->makeRenderPath(rawPath, FillRule::nonZero));
+
+            auto paint = factory->makeRenderPaint();
+            paint->style(RenderPaintStyle::stroke);
+            paint->color(rand.color(0xc0));
+            paint->thickness(rand.f(1, 12));
+            paint->cap(static_cast<StrokeCap>(rand.next() % 3));
+            paint->join(static_cast<StrokeJoin>(rand.next() % 3));
+            m_paints.push_back(std::move(paint));
+        }
+    }
+
+    const char* name() const override { return "strokes"; }
+
+    void draw(Renderer* renderer, int frameIdx) override
+    {
+        renderer->save();
+        renderer->translate(static_cast<float>(frameIdx % 16), 0);
+        for (size_t i = 0; i < m_paths.size(); ++i)
+        {
+            renderer->drawPath(m_paths[i].get(), m_paints[i].get());
+        }
+        renderer->restore();
+    }
+
+private:
+    std::vector<rcp<RenderPath>> m_paths;
+    std::vector<rcp<RenderPaint>> m_paints;
+};
+
+// A handful of huge, overlapping, translucent fills with many self-intersecting contours.
+// Stresses fill rate and interior triangulation.
+class FillsScene : public BenchScene
+{
+public:
+    FillsScene(Factory* factory, int width, int height)
+    {
+        constexpr static int kFillCount = 12;
+        constexpr static int kStarPoints = 97;
+        LCG rand(2);
+        float cx = width * .5f, cy = height * .5f;
+        float radius = std::max(width, height) * .75f;
+        for (int i = 0; i < kFillCount; ++i)
+        {
+            RawPath rawPath;
+            float phase = rand.f(0, 2 * math::PI);
+            for (int j = 0; j < kStarPoints; ++j)
+            {
+                // Skip 48 points each step to build a heavily self-intersecting star.
+                float theta = phase + 2 * math::PI * ((j * 48) % kStarPoints) / kStarPoints;
+                float x = cx + cosf(theta) * radius, y = cy + sinf(theta) * radius;
+                if (j == 0)
+                    rawPath.moveTo(x, y);
+                else
+                    rawPath.lineTo(x, y);
+            }
+            rawPath.close();
+            m_paths.push_back(factory->makeRenderPath(
+                rawPath,
+                (i & 1) ? FillRule::evenOdd : FillRule::nonZero));
+
+            auto paint = factory->makeRenderPaint();
+            paint->style(RenderPaintStyle::fill);
+            paint->color(rand.color(0x40));
+            m_paints.push_back(std::move(paint));
+        }
+    }
+
+    const char* name() const override { return "fills"; }
+
+    void draw(Renderer* renderer, int frameIdx) override
+    {
+        for (size_t i = 0; i < m_paths.size(); ++i)
+        {
+            renderer->drawPath(m_paths[i].get(), m_paints[i].get());
+        }
+    }
+
+private:
+    std::vector<rcp<RenderPath>> m_paths;
+    std::vector<rcp<RenderPaint>> m_paints;
+};
+
+// A grid of cells, each of which pushes a deep stack of nested clips before drawing. Stresses
+// clip updates and clip ID allocation.
+class ClipsScene : public BenchScene
+{
+public:
+    constexpr static int kGridSize = 8;
+    constexpr static int kClipDepth = 16;
+
+    ClipsScene(Factory* factory, int width, int height) :
+        m_cellWidth(static_cast<float>(width) / kGridSize),
+        m_cellHeight(static_cast<float>(height) / kGridSize)
+    {
+        LCG rand(3);
+        float w = m_cellWidth, h = m_cellHeight;
+        for (int i = 0; i < kClipDepth; ++i)
+        {
+            // Shrink toward the cell's center, alternating between circles and jittered rects.
+            float inset = (i + 1) * .5f / (kClipDepth + 1);
+            RawPath rawPath;
+            if (i & 1)
+            {
+                add_circle(&rawPath, w * .5f, h * .5f, std::min(w, h) * (.5f - inset * .5f));
+            }
+            else
+            {
+                add_rect(&rawPath,
+                         w * inset + rand.f(-2, 2),
+                         h * inset + rand.f(-2, 2),
+                         w * (1 - inset) + rand.f(-2, 2),
+                         h * (1 - inset) + rand.f(-2, 2));
+            }
+            m_clips.push_back(factory->makeRenderPath(rawPath, FillRule::nonZero));
+        }
+
+        RawPath background;
+        add_rect(&background, 0, 0, w, h);
+        m_background = factory->makeRenderPath(background, FillRule::nonZero);
+        m_paint = factory->makeRenderPaint();
+        m_paint->style(RenderPaintStyle::fill);
+        m_paint->color(0xff20a0ff);
+    }
+
+    const char* name() const override { return "clips"; }
+
+    void draw(Renderer* renderer, int frameIdx) override
+    {
+        for (int y = 0; y < kGridSize; ++y)
+        {
+            for (int x = 0; x < kGridSize; ++x)
+            {
+                renderer->save();
+                renderer->translate(x * m_cellWidth, y * m_cellHeight);
+                // Vary the stack depth per cell (and per frame) so clip content changes.
+                int depth = 1 + (x + y * kGridSize + frameIdx) % kClipDepth;
+                for (int i = 0; i < depth; ++i)
+                {
+                    renderer->clipPath(m_clips[i].get());
+                }
+                renderer->drawPath(m_background.get(), m_paint.get());
+                renderer->restore();
+            }
+        }
+    }
+
+private:
+    float m_cellWidth;
+    float m_cellHeight;
+    std::vector<rcp<RenderPath>> m_clips;
+    rcp<RenderPath> m_background;
+    rcp<RenderPaint> m_paint;
+};
+
+// Lots of rectangles filled with linear and radial gradients, with both simple (2-stop) and
+// complex (many-stop) ramps. Stresses the gradient texture.
+class GradientsScene : public BenchScene
+{
+public:
+    GradientsScene(Factory* factory, int width, int height)
+    {
+        constexpr static int kGradientCount = 400;
+        constexpr static int kMaxStops = 8;
+        LCG rand(4);
+        for (int i = 0; i < kGradientCount; ++i)
+        {
+            float l = rand.f(0, width), t = rand.f(0, height);
+            float r = l + rand.f(20, 200), b = t + rand.f(20, 200);
+            RawPath rawPath;
+            add_rect(&rawPath, l, t, r, b);
+            m_paths.push_back(factory->makeRenderPath(rawPath, FillRule::nonZero));
+
+            size_t stopCount = (i & 1) ? 2 : 2 + rand.next() % (kMaxStops - 1);
+            ColorInt colors[kMaxStops];
+            float stops[kMaxStops];
+            for (size_t j = 0; j < stopCount; ++j)
+            {
+                colors[j] = rand.color(0xff);
+                stops[j] = static_cast<float>(j) / (stopCount - 1);
+            }
+            rcp<RenderShader> shader =
+                (i % 3) ? factory->makeLinearGradient(l, t, r, b, colors, stops, stopCount)
+                        : factory->makeRadialGradient((l + r) * .5f,
+                                                      (t + b) * .5f,
+                                                      std::max(r - l, b - t) * .5f,
+                                                      colors,
+                                                      stops,
+                                                      stopCount);
+            auto paint = factory->makeRenderPaint();
+            paint->style(RenderPaintStyle::fill);
+            paint->shader(std::move(shader));
+            m_paints.push_back(std::move(paint));
+        }
+    }
+
+    const char* name() const override { return "gradients"; }
+
+    void draw(Renderer* renderer, int frameIdx) override
+    {
+        for (size_t i = 0; i < m_paths.size(); ++i)
+        {
+            renderer->drawPath(m_paths[i].get(), m_paints[i].get());
+        }
+    }
+
+private:
+    std::vector<rcp<RenderPath>> m_paths;
+    std::vector<rcp<RenderPaint>> m_paints;
+};
+
+// Encodes an uncompressed (stored-deflate) RGBA PNG, so the image mesh scene can go through the
+// normal decodeImage() path without shipping any assets.
+static std::vector<uint8_t> encode_uncompressed_png(const uint32_t* rgba, uint32_t w, uint32_t h)
+{
+    auto crc32 = [](const uint8_t* data, size_t size, uint32_t crc = 0xffffffff) {
+        for (size_t i = 0; i < size; ++i)
+        {
+            crc ^= data[i];
+            for (int k = 0; k < 8; ++k)
+            {
+                crc = (crc >> 1) ^ (0xedb88320 & (0 - (crc & 1)));
+            }
+        }
+        return crc;
+    };
+    auto push32 = [](std::vector<uint8_t>* out, uint32_t x) {
+        out->insert(out->end(), {uint8_t(x >> 24), uint8_t(x >> 16), uint8_t(x >> 8), uint8_t(x)});
+    };
+    std::vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    auto pushChunk = [&](const char type[4], const std::vector<uint8_t>& data) {
+        push32(&png, static_cast<uint32_t>(data.size()));
+        size_t typeOffset = png.size();
+        png.insert(png.end(), type, type + 4);
+        png.insert(png.end(), data.begin(), data.end());
+        push32(&png, ~crc32(png.data() + typeOffset, data.size() + 4));
+    };
+
+    std::vector<uint8_t> ihdr;
+    push32(&ihdr, w);
+    push32(&ihdr, h);
+    ihdr.insert(ihdr.end(), {8, 6, 0, 0, 0}); // 8-bit RGBA, no interlace.
+    pushChunk("IHDR", ihdr);
+
+    std::vector<uint8_t> scanlines;
+    for (uint32_t y = 0; y < h; ++y)
+    {
+        scanlines.push_back(0); // Filter type "none".
+        const uint8_t* row = reinterpret_cast<const uint8_t*>(rgba + y * w);
+        scanlines.insert(scanlines.end(), row, row + w * 4);
+    }
+    std::vector<uint8_t> zlib = {0x78, 0x01};
+    uint32_t adlerA = 1, adlerB = 0;
+    for (size_t offset = 0; offset < scanlines.size();)
+    {
+        uint16_t len = static_cast<uint16_t>(std::min<size_t>(scanlines.size() - offset, 0xffff));
+        bool isFinal = offset + len == scanlines.size();
+        zlib.insert(zlib.end(),
+                    {uint8_t(isFinal),
+                     uint8_t(len),
+                     uint8_t(len >> 8),
+                     uint8_t(~len),
+                     uint8_t(~len >> 8)});
+        for (size_t i = offset; i < offset + len; ++i)
+        {
+            adlerA = (adlerA + scanlines[i]) % 65521;
+            adlerB = (adlerB + adlerA) % 65521;
+        }
+        zlib.insert(zlib.end(), scanlines.begin() + offset, scanlines.begin() + offset + len);
+        offset += len;
+    }
+    push32(&zlib, (adlerB << 16) | adlerA);
+    pushChunk("IDAT", zlib);
+    pushChunk("IEND", {});
+    return png;
+}
+
+// A grid of textured meshes. Stresses image mesh uploads and image draws.
+class ImageMeshScene : public BenchScene
+{
+public:
+    constexpr static int kMeshCount = 64;
+    constexpr static int kSubdivisions = 16;
+    constexpr static int kVertexCount = (kSubdivisions + 1) * (kSubdivisions + 1);
+    constexpr static int kIndexCount = kSubdivisions * kSubdivisions * 6;
+    constexpr static uint32_t kTextureSize = 256;
+
+    ImageMeshScene(PLSRenderContext* plsContext, int width, int height) :
+        m_width(static_cast<float>(width)), m_height(static_cast<float>(height))
+    {
+        std::vector<uint32_t> checker(kTextureSize * kTextureSize);
+        for (uint32_t y = 0; y < kTextureSize; ++y)
+        {
+            for (uint32_t x = 0; x < kTextureSize; ++x)
+            {
+                // Little-endian RGBA.
+                checker[y * kTextureSize + x] = ((x ^ y) & 32) ? 0xff2080ff : 0xffffffff;
+            }
+        }
+        auto png = encode_uncompressed_png(checker.data(), kTextureSize, kTextureSize);
+        m_image = plsContext->decodeImage(png);
+
+        m_uvs = plsContext->makeRenderBuffer(RenderBufferType::vertex,
+                                             RenderBufferFlags::mappedOnceAtInitialization,
+                                             kVertexCount * sizeof(float) * 2);
+        auto* uvs = reinterpret_cast<float*>(m_uvs->map());
+        for (int y = 0; y <= kSubdivisions; ++y)
+        {
+            for (int x = 0; x <= kSubdivisions; ++x)
+            {
+                *uvs++ = static_cast<float>(x) / kSubdivisions;
+                *uvs++ = static_cast<float>(y) / kSubdivisions;
+            }
+        }
+        m_uvs->unmap();
+
+        m_indices = plsContext->makeRenderBuffer(RenderBufferType::index,
+                                                 RenderBufferFlags::mappedOnceAtInitialization,
+                                                 kIndexCount * sizeof(uint16_t));
+        auto* indices = reinterpret_cast<uint16_t*>(m_indices->map());
+        for (int y = 0; y < kSubdivisions; ++y)
+        {
+            for (int x = 0; x < kSubdivisions; ++x)
+            {
+                uint16_t i = static_cast<uint16_t>(y * (kSubdivisions + 1) + x);
+                uint16_t j = static_cast<uint16_t>(i + kSubdivisions + 1);
+                for (uint16_t idx : {i, uint16_t(i + 1), j, uint16_t(i + 1), uint16_t(j + 1), j})
+                {
+                    *indices++ = idx;
+                }
+            }
+        }
+        m_indices->unmap();
+
+        // The vertices get rewritten every frame, like an animated mesh deformer would.
+        for (int i = 0; i < kMeshCount; ++i)
+        {
+            m_vertices.push_back(plsContext->makeRenderBuffer(RenderBufferType::vertex,
+                                                              RenderBufferFlags::none,
+                                                              kVertexCount * sizeof(float) * 2));
+        }
+    }
+
+    const char* name() const override { return "imagemesh"; }
+
+    void draw(Renderer* renderer, int frameIdx) override
+    {
+        if (m_image == nullptr)
+        {
+            return;
+        }
+        constexpr static int kGridSize = 8;
+        float cellWidth = m_width / kGridSize, cellHeight = m_height / kGridSize;
+        for (int i = 0; i < kMeshCount; ++i)
+        {
+            float l = (i % kGridSize) * cellWidth, t = (i / kGridSize) * cellHeight;
+            auto* vertices = reinterpret_cast<float*>(m_vertices[i]->map());
+            for (int y = 0; y <= kSubdivisions; ++y)
+            {
+                for (int x = 0; x <= kSubdivisions; ++x)
+                {
+                    float wobble = sinf((x + y + frameIdx + i) * .5f) * 2;
+                    *vertices++ = l + cellWidth * x / kSubdivisions + wobble;
+                    *vertices++ = t + cellHeight * y / kSubdivisions - wobble;
+                }
+            }
+            m_vertices[i]->unmap();
+            renderer->drawImageMesh(m_image.get(),
+                                    m_vertices[i],
+                                    m_uvs,
+                                    m_indices,
+                                    kVertexCount,
+                                    kIndexCount,
+                                    BlendMode::srcOver,
+                                    1);
+        }
+    }
+
+private:
+    float m_width;
+    float m_height;
+    rcp<RenderImage> m_image;
+    rcp<RenderBuffer> m_uvs;
+    rcp<RenderBuffer> m_indices;
+    std::vector<rcp<RenderBuffer>> m_vertices;
+};
+
+// Draws the default artboard of a .riv file, advancing its first state machine or animation by a
+// fixed timestep every frame.
+class RivScene : public BenchScene
+{
+public:
+    RivScene(std::unique_ptr<File> file, int width, int height) :
+        m_file(std::move(file)), m_width(width), m_height(height)
+    {
+        m_artboard = m_file->artboardDefault();
+        m_scene = m_artboard->stateMachineAt(0);
+        if (m_scene == nullptr)
+        {
+            m_scene = m_artboard->animationAt(0);
+        }
+        if (m_scene == nullptr)
+        {
+            m_scene = std::make_unique<StaticScene>(m_artboard.get());
+        }
+    }
+
+    const char* name() const override { return "riv"; }
+
+    void draw(Renderer* renderer, int frameIdx) override
+    {
+        m_scene->advanceAndApply(1 / 120.f);
+        renderer->save();
+        renderer->transform(computeAlignment(rive::Fit::contain,
+                                             rive::Alignment::center,
+                                             rive::AABB(0, 0, m_width, m_height),
+                                             m_artboard->bounds()));
+        m_scene->draw(renderer);
+        renderer->restore();
+    }
+
+private:
+    std::unique_ptr<File> m_file;
+    int m_width;
+    int m_height;
+    std::unique_ptr<Artboard> m_artboard;
+    std::unique_ptr<Scene> m_scene;
+};
+
+// Replays a pls::PLSCaptureRenderer capture, one captured frame per frame, looping back to the
+// beginning once it runs out.
+class ReplayScene : public BenchScene
+{
+public:
+    ReplayScene(std::unique_ptr<pls::PLSCaptureReplay> replay) : m_replay(std::move(replay)) {}
+
+    const char* name() const override { return "replay"; }
+
+    void updateFrameDescriptor(PLSRenderContext::FrameDescriptor* frameDescriptor,
+                               int frameIdx) override
+    {
+        // Keep the bench's target size and GPU timer settings.
+        PLSRenderContext::FrameDescriptor captured = m_replay->frameDescriptor(frameIdx % count());
+        captured.renderTargetWidth = frameDescriptor->renderTargetWidth;
+        captured.renderTargetHeight = frameDescriptor->renderTargetHeight;
+        captured.measureGPUTime = frameDescriptor->measureGPUTime;
+        *frameDescriptor = captured;
+    }
+
+    void draw(Renderer* renderer, int frameIdx) override
+    {
+        m_replay->replayFrame(frameIdx % count(), renderer);
+    }
+
+private:
+    int count() const { return static_cast<int>(m_replay->frameCount()); }
+
+    std::unique_ptr<pls::PLSCaptureReplay> m_replay;
+};
+
+struct Percentiles
+{
+    double p50 = 0, p90 = 0, p99 = 0, mean = 0, min = 0, max = 0;
+};
+
+static Percentiles compute_percentiles(std::vector<double> samples)
+{
+    Percentiles result;
+    if (samples.empty())
+    {
+        return result;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto nearestRank = [&samples](double p) {
+        size_t rank = static_cast<size_t>(ceil(p * samples.size()));
+        return samples[std::clamp<size_t>(rank, 1, samples.size()) - 1];
+    };
+    result.p50 = nearestRank(.5);
+    result.p90 = nearestRank(.9);
+    result.p99 = nearestRank(.99);
+    double sum = 0;
+    for (double sample : samples)
+    {
+        sum += sample;
+    }
+    result.mean = sum / samples.size();
+    result.min = samples.front();
+    result.max = samples.back();
+    return result;
+}
+
+static void write_percentiles_json(std::ostream& out, const char* name, const Percentiles& p)
+{
+    out << "      \"" << name << "\": {\"p50\": " << p.p50 << ", \"p90\": " << p.p90
+        << ", \"p99\": " << p.p99 << ", \"mean\": " << p.mean << ", \"min\": " << p.min
+        << ", \"max\": " << p.max << "}";
+}
+
+struct SceneResult
+{
+    std::string name;
+    Percentiles cpuMs;
+    Percentiles gpuMs;
+    size_t gpuSampleCount = 0;
+    PLSRenderContext::FrameStats lastFrameStats;
+};
+
+// Builds keys with the same bit layout as LogicalFlush::writeResources(): [draw group, draw type,
+// texture hash, blend mode, draw contents, draw index].
+static std::vector<int64_t> make_draw_sort_keys(size_t drawCount, LCG* rand)
+{
+    std::vector<int64_t> keys(drawCount);
+    uint32_t drawGroupCount = std::max<uint32_t>(static_cast<uint32_t>(drawCount / 64), 1);
+    for (size_t i = 0; i < drawCount; ++i)
+    {
+        int64_t drawGroup = rand->next() % drawGroupCount + 1;
+        if (rand->next() % 4 == 0)
+        {
+            drawGroup = -drawGroup; // Opaque, reverse-sorted depthStencil draws.
+        }
+        int64_t key = drawGroup << 45;
+        key |= static_cast<int64_t>(rand->next() % 6) << 42;
+        key |= static_cast<int64_t>(rand->next() % 8 == 0 ? rand->next() & 0x3fff : 0) << 28;
+        key |= static_cast<int64_t>(rand->next() % 16 == 0 ? rand->next() & 0xf : 0) << 24;
+        key |= static_cast<int64_t>(rand->next() & 0x3f) << 18;
+        key |= i;
+        keys[i] = key;
+    }
+    return keys;
+}
+
+// CPU-only benchmark of the draw-list reordering sort.
+static int run_sort_benchmark(int iterationCount, const char* outPath)
+{
+    constexpr static size_t kDrawCounts[] = {1000, 8000, 32767, 100000};
+    std::vector<SceneResult> results;
+    LCG rand(7);
+    for (size_t drawCount : kDrawCounts)
+    {
+        std::vector<int64_t> keys = make_draw_sort_keys(drawCount, &rand);
+        std::vector<int64_t> work(drawCount), scratch(drawCount), expected;
+        std::vector<double> stdSortMs, radixSortMs;
+        for (int i = 0; i < iterationCount; ++i)
+        {
+            work = keys;
+            auto start = std::chrono::steady_clock::now();
+            std::sort(work.begin(), work.end());
+            auto end = std::chrono::steady_clock::now();
+            stdSortMs.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+            expected = work;
+
+            work = keys;
+            start = std::chrono::steady_clock::now();
+            pls::SortInt64Keys(work.data(), scratch.data(), work.size(), 16);
+            end = std::chrono::steady_clock::now();
+            radixSortMs.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+            if (work != expected)
+            {
+                fprintf(stderr, "pls::SortInt64Keys() disagrees with std::sort.\n");
+                return 1;
+            }
+        }
+        for (bool radix : {false, true})
+        {
+            SceneResult result;
+            result.name = (radix ? "radix_sort_" : "std_sort_") + std::to_string(drawCount);
+            result.cpuMs = compute_percentiles(radix ? radixSortMs : stdSortMs);
+            fprintf(stderr,
+                    "%-16s cpu p50 %.3fms p99 %.3fms\n",
+                    result.name.c_str(),
+                    result.cpuMs.p50,
+                    result.cpuMs.p99);
+            results.push_back(std::move(result));
+        }
+    }
+
+    if (captureRenderer != nullptr)
+    {
+        std::ofstream captureFile(capturePath, std::ios::binary);
+        const std::vector<uint8_t>& captureData = captureRenderer->data();
+        captureFile.write(reinterpret_cast<const char*>(captureData.data()), captureData.size());
+        if (!captureFile)
+        {
+            fprintf(stderr, "Failed to write capture '%s'.\n", capturePath);
+            return 1;
+        }
+        fprintf(stderr,
+                "Captured %zu frames (%zu bytes, %zu uncaptured calls) to '%s'.\n",
+                captureRenderer->frameCount(),
+                captureData.size(),
+                captureRenderer->uncapturedCallCount(),
+                capturePath);
+        captureRenderer.reset();
+    }
+
+    std::ofstream outFile;
+    if (outPath != nullptr)
+    {
+        outFile.open(outPath);
+        if (!outFile)
+        {
+            fprintf(stderr, "Failed to open '%s' for writing.\n", outPath);
+            return 1;
+        }
+    }
+    std::ostream& out = outPath != nullptr ? outFile : std::cout;
+    out << "{\n";
+    out << "  \"iterations\": " << iterationCount << ",\n";
+    out << "  \"sorts\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        out << "    {\n";
+        out << "      \"name\": \"" << results[i].name << "\",\n";
+        write_percentiles_json(out, "cpuMs", results[i].cpuMs);
+        out << "\n";
+        out << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+    return 0;
+}
+
+static void glfw_error_callback(int code, const char* message)
+{
+    fprintf(stderr, "GLFW error: %i - %s\n", code, message);
+}
+
+static void set_environment_variable(const char* name, const char* value)
+{
+#ifdef _WIN32
+    SetEnvironmentVariableA(name, value);
+#else
+    setenv(name, value, /*overwrite=*/true);
+#endif
+}
+
+enum class API
+{
+    gl,
+    metal,
+    d3d,
+    dawn,
+    vulkan,
+};
+
+static const char* api_name(API api)
+{
+    switch (api)
+    {
+        case API::gl:
+            return "gl";
+        case API::metal:
+            return "metal";
+        case API::d3d:
+            return "d3d";
+        case API::dawn:
+            return "dawn";
+        case API::vulkan:
+            return "vulkan";
+    }
+    RIVE_UNREACHABLE();
+}
+
+int main(int argc, const char** argv)
+{
+    setvbuf(stdout, NULL, _IONBF, 0);
+    setvbuf(stderr, NULL, _IONBF, 0);
+
+    API api =
+#if defined(__APPLE__)
+        API::metal
+#elif defined(_WIN32)
+        API::d3d
+#else
+        API::gl
+#endif
+        ;
+    FiddleContextOptions options;
+    options.allowHeadlessRendering = true;
+    // Compile everything up front so shader compiles don't pollute the measurements.
+    options.synchronousShaderCompilations = true;
+    bool forceAtomicMode = false;
+    int msaa = 0;
+    int width = 1920, height = 1080;
+    int frameCount = 300;
+    int warmupFrameCount = 30;
+    const char* sceneFilter = nullptr;
+    const char* outPath = nullptr;
+    const char* rivName = nullptr;
+    const char* capturePath = nullptr;
+    const char* replayPath = nullptr;
+    bool sortBenchmark = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--gl"))
+        {
+            api = API::gl;
+        }
+        else if (!strcmp(argv[i], "--glatomic"))
+        {
+            api = API::gl;
+            forceAtomicMode = true;
+        }
+        else if (!strcmp(argv[i], "--metal"))
+        {
+            api = API::metal;
+        }
+        else if (!strcmp(argv[i], "--metalatomic"))
+        {
+            api = API::metal;
+            forceAtomicMode = true;
+        }
+        else if (!strcmp(argv[i], "--mvk") || !strcmp(argv[i], "--moltenvk"))
+        {
+            set_environment_variable("VK_ICD_FILENAMES", kMoltenVKICD);
+            api = API::vulkan;
+        }
+        else if (!strcmp(argv[i], "--mvkatomic") || !strcmp(argv[i], "--moltenvkatomic"))
+        {
+            set_environment_variable("VK_ICD_FILENAMES", kMoltenVKICD);
+            api = API::vulkan;
+            forceAtomicMode = true;
+        }
+        else if (!strcmp(argv[i], "--sw") || !strcmp(argv[i], "--swiftshader"))
+        {
+            set_environment_variable("VK_ICD_FILENAMES", kSwiftShaderICD);
+            api = API::vulkan;
+        }
+        else if (!strcmp(argv[i], "--swatomic") || !strcmp(argv[i], "--swiftshaderatomic"))
+        {
+            set_environment_variable("VK_ICD_FILENAMES", kSwiftShaderICD);
+            api = API::vulkan;
+            forceAtomicMode = true;
+        }
+        else if (!strcmp(argv[i], "--dawn"))
+        {
+            api = API::dawn;
+        }
+        else if (!strcmp(argv[i], "--d3d"))
+        {
+            api = API::d3d;
+        }
+        else if (!strcmp(argv[i], "--d3datomic"))
+        {
+            api = API::d3d;
+            forceAtomicMode = true;
+        }
+        else if (!strcmp(argv[i], "--vulkan") || !strcmp(argv[i], "--vk"))
+        {
+            api = API::vulkan;
+        }
+        else if (!strcmp(argv[i], "--vulkanatomic") || !strcmp(argv[i], "--vkatomic"))
+        {
+            api = API::vulkan;
+            forceAtomicMode = true;
+        }
+        else if (!strcmp(argv[i], "--atomic"))
+        {
+            forceAtomicMode = true;
+        }
+        else if (!strncmp(argv[i], "--msaa", 6))
+        {
+            msaa = argv[i][6] - '0';
+        }
+        else if (!strcmp(argv[i], "--validation"))
+        {
+            options.enableVulkanValidationLayers = true;
+        }
+        else if ((!strcmp(argv[i], "--gpu") || !strcmp(argv[i], "-G")) && i + 1 < argc)
+        {
+            options.gpuNameFilter = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--frames") && i + 1 < argc)
+        {
+            frameCount = std::max(atoi(argv[++i]), 1);
+        }
+        else if (!strcmp(argv[i], "--warmup") && i + 1 < argc)
+        {
+            warmupFrameCount = std::max(atoi(argv[++i]), 0);
+        }
+        else if (!strcmp(argv[i], "--size") && i + 1 < argc)
+        {
+            if (sscanf(argv[++i], "%ix%i", &width, &height) != 2 || width <= 0 || height <= 0)
+            {
+                fprintf(stderr, "Invalid --size '%s'. Expected WxH.\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "--scene") && i + 1 < argc)
+        {
+            sceneFilter = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--out") && i + 1 < argc)
+        {
+            outPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--capture") && i + 1 < argc)
+        {
+            capturePath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--replay") && i + 1 < argc)
+        {
+            replayPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--sortbench"))
+        {
+            sortBenchmark = true;
+        }
+        else if (argv[i][0] == '-')
+        {
+            fprintf(stderr, "Unknown argument '%s'.\n", argv[i]);
+            return 1;
+        }
+        else
+        {
+            rivName = argv[i];
+        }
+    }
+
+    if (sortBenchmark)
+    {
+        return run_sort_benchmark(frameCount, outPath);
+    }
+
+    glfwSetErrorCallback(glfw_error_callback);
+    if (!glfwInit())
+    {
+        fprintf(stderr, "Failed to initialize glfw.\n");
+        return 1;
+    }
+
+    if (msaa > 0)
+    {
+        if (msaa > 1)
+        {
+            glfwWindowHint(GLFW_SAMPLES, msaa);
+        }
+        glfwWindowHint(GLFW_STENCIL_BITS, 8);
+        glfwWindowHint(GLFW_DEPTH_BITS, 16);
+    }
+    switch (api)
+    {
+        case API::metal:
+        case API::d3d:
+        case API::dawn:
+        case API::vulkan:
+            glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+            break;
+        case API::gl:
+            glfwWindowHint(GLFW_CLIENT_API, GLFW_OPENGL_API);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+            break;
+    }
+    // Never show the window. Render at exactly the requested size, regardless of display scale.
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_COCOA_RETINA_FRAMEBUFFER, GLFW_FALSE);
+    options.retinaDisplay = false;
+    GLFWwindow* window = glfwCreateWindow(width, height, "pls_bench", nullptr, nullptr);
+    if (!window)
+    {
+        glfwTerminate();
+        fprintf(stderr, "Failed to create window.\n");
+        return 1;
+    }
+    if (api == API::gl)
+    {
+        glfwMakeContextCurrent(window);
+        glfwSwapInterval(0);
+    }
+
+    std::unique_ptr<FiddleContext> fiddleContext;
+    switch (api)
+    {
+        case API::metal:
+            fiddleContext = FiddleContext::MakeMetalPLS(options);
+            break;
+        case API::d3d:
+            fiddleContext = FiddleContext::MakeD3DPLS(options);
+            break;
+        case API::dawn:
+            fiddleContext = FiddleContext::MakeDawnPLS(options);
+            break;
+        case API::vulkan:
+            fiddleContext = FiddleContext::MakeVulkanPLS(options);
+            break;
+        case API::gl:
+            fiddleContext = FiddleContext::MakeGLPLS();
+            break;
+    }
+    PLSRenderContext* plsContext = fiddleContext ? fiddleContext->plsContextOrNull() : nullptr;
+    if (plsContext == nullptr)
+    {
+        fprintf(stderr, "Failed to create a PLS context for %s.\n", api_name(api));
+        return 1;
+    }
+    fiddleContext->onSizeChanged(window, width, height, msaa);
+    std::unique_ptr<Renderer> renderer = fiddleContext->makeRenderer(width, height);
+
+    std::vector<std::unique_ptr<BenchScene>> scenes;
+    if (replayPath != nullptr)
+    {
+        std::ifstream captureStream(replayPath, std::ios::binary);
+        std::vector<uint8_t> captureBytes(std::istreambuf_iterator<char>(captureStream), {});
+        auto makeImage = [plsContext](uint32_t width, uint32_t height, uint32_t hash) {
+            std::vector<uint32_t> checker(width * height);
+            for (uint32_t y = 0; y < height; ++y)
+            {
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    checker[y * width + x] = ((x ^ y) & 32) ? (0xff000000 | hash) : 0xffffffff;
+                }
+            }
+            return plsContext->decodeImage(encode_uncompressed_png(checker.data(), width, height));
+        };
+        std::unique_ptr<pls::PLSCaptureReplay> replay =
+            pls::PLSCaptureReplay::Make(std::move(captureBytes),
+                                        fiddleContext->factory(),
+                                        makeImage);
+        if (replay == nullptr || replay->frameCount() == 0)
+        {
+            fprintf(stderr, "Failed to load capture '%s'.\n", replayPath);
+            return 1;
+        }
+        scenes.push_back(std::make_unique<ReplayScene>(std::move(replay)));
+    }
+    else if (rivName != nullptr)
+    {
+        std::ifstream rivStream(rivName, std::ios::binary);
+        std::vector<uint8_t> rivBytes(std::istreambuf_iterator<char>(rivStream), {});
+        std::unique_ptr<File> rivFile = File::import(rivBytes, fiddleContext->factory());
+        if (rivFile == nullptr)
+        {
+            fprintf(stderr, "Failed to import '%s'.\n", rivName);
+            return 1;
+        }
+        scenes.push_back(std::make_unique<RivScene>(std::move(rivFile), width, height));
+    }
+    else
+    {
+        Factory* factory = fiddleContext->factory();
+        scenes.push_back(std::make_unique<StrokesScene>(factory, width, height));
+        scenes.push_back(std::make_unique<FillsScene>(factory, width, height));
+        scenes.push_back(std::make_unique<ClipsScene>(factory, width, height));
+        scenes.push_back(std::make_unique<GradientsScene>(factory, width, height));
+        scenes.push_back(std::make_unique<ImageMeshScene>(plsContext, width, height));
+        if (sceneFilter != nullptr)
+        {
+            scenes.erase(std::remove_if(scenes.begin(),
+                                        scenes.end(),
+                                        [sceneFilter](const std::unique_ptr<BenchScene>& scene) {
+                                            return strcmp(scene->name(), sceneFilter) != 0;
+                                        }),
+                         scenes.end());
+            if (scenes.empty())
+            {
+                fprintf(stderr, "Unknown scene '%s'.\n", sceneFilter);
+                return 1;
+            }
+        }
+    }
+
+    PLSRenderContext::FrameDescriptor frameDescriptor = {
+        .renderTargetWidth = static_cast<uint32_t>(width),
+        .renderTargetHeight = static_cast<uint32_t>(height),
+        .clearColor = 0xff404040,
+        .msaaSampleCount = msaa,
+        .disableRasterOrdering = forceAtomicMode,
+    };
+
+    std::unique_ptr<pls::PLSCaptureRenderer> captureRenderer;
+    if (capturePath != nullptr)
+    {
+        captureRenderer = std::make_unique<pls::PLSCaptureRenderer>(renderer.get());
+    }
+
+    auto renderFrame = [&](BenchScene* scene, int frameIdx, bool measureGPUTime) {
+        PLSRenderContext::FrameDescriptor sceneFrameDescriptor = frameDescriptor;
+        sceneFrameDescriptor.measureGPUTime = measureGPUTime;
+        if (scene != nullptr)
+        {
+            scene->updateFrameDescriptor(&sceneFrameDescriptor, frameIdx);
+        }
+        fiddleContext->begin(sceneFrameDescriptor);
+        if (scene != nullptr && captureRenderer != nullptr)
+        {
+            captureRenderer->beginFrame(sceneFrameDescriptor);
+            scene->draw(captureRenderer.get(), frameIdx);
+            captureRenderer->endFrame();
+        }
+        else if (scene != nullptr)
+        {
+            scene->draw(renderer.get(), frameIdx);
+        }
+        fiddleContext->end(window);
+        fiddleContext->tick();
+        if (api == API::gl)
+        {
+            glfwSwapBuffers(window);
+        }
+        glfwPollEvents();
+    };
+
+    std::vector<SceneResult> results;
+    for (const std::unique_ptr<BenchScene>& scene : scenes)
+    {
+        for (int i = 0; i < warmupFrameCount; ++i)
+        {
+            renderFrame(scene.get(), i, false);
+        }
+        // Discard any stale GPU timings.
+        for (pls::GPUFrameTime gpuTime; plsContext->popGPUFrameTime(&gpuTime);)
+        {}
+
+        uint64_t firstMeasuredFrame = plsContext->frameNumber() + 1;
+        std::vector<double> cpuMs, gpuMs;
+        cpuMs.reserve(frameCount);
+        gpuMs.reserve(frameCount);
+        auto drainGPUTimes = [&]() {
+            for (pls::GPUFrameTime gpuTime; plsContext->popGPUFrameTime(&gpuTime);)
+            {
+                if (gpuTime.frameNumber >= firstMeasuredFrame)
+                {
+                    gpuMs.push_back(gpuTime.seconds * 1e3);
+                }
+            }
+        };
+        for (int i = 0; i < frameCount; ++i)
+        {
+            auto start = std::chrono::steady_clock::now();
+            renderFrame(scene.get(), warmupFrameCount + i, true);
+            auto end = std::chrono::steady_clock::now();
+            cpuMs.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+            drainGPUTimes();
+        }
+        SceneResult result;
+        result.name = scene->name();
+        result.lastFrameStats = plsContext->lastFrameStats();
+
+        // GPU timings lag behind by a few frames. Render empty, unmeasured frames until the rest of
+        // them come in (or the backend gives up on them).
+        for (int i = 0; i < 16 && gpuMs.size() < static_cast<size_t>(frameCount); ++i)
+        {
+            renderFrame(nullptr, 0, false);
+            drainGPUTimes();
+        }
+
+        result.cpuMs = compute_percentiles(cpuMs);
+        result.gpuMs = compute_percentiles(gpuMs);
+        result.gpuSampleCount = gpuMs.size();
+        fprintf(stderr,
+                "%-10s cpu p50 %.3fms p99 %.3fms | gpu p50 %.3fms p99 %.3fms (%zu samples)\n",
+                result.name.c_str(),
+                result.cpuMs.p50,
+                result.cpuMs.p99,
+                result.gpuMs.p50,
+                result.gpuMs.p99,
+                result.gpuSampleCount);
+        results.push_back(std::move(result));
+    }
+
+    std::ofstream outFile;
+    if (outPath != nullptr)
+    {
+        outFile.open(outPath);
+        if (!outFile)
+        {
+            fprintf(stderr, "Failed to open '%s' for writing.\n", outPath);
+            return 1;
+        }
+    }
+    std::ostream& out = outPath != nullptr ? outFile : std::cout;
+    out << "{\n";
+    out << "  \"api\": \"" << api_name(api) << "\",\n";
+    out << "  \"interlockMode\": \""
+        << (msaa ? "depthStencil" : forceAtomicMode ? "atomics" : "rasterOrdering") << "\",\n";
+    out << "  \"msaa\": " << msaa << ",\n";
+    out << "  \"width\": " << width << ",\n";
+    out << "  \"height\": " << height << ",\n";
+    out << "  \"frames\": " << frameCount << ",\n";
+    out << "  \"warmupFrames\": " << warmupFrameCount << ",\n";
+    out << "  \"scenes\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const SceneResult& result = results[i];
+        const PLSRenderContext::FrameStats& stats = result.lastFrameStats;
+        out << "    {\n";
+        out << "      \"name\": \"" << result.name << "\",\n";
+        write_percentiles_json(out, "cpuMs", result.cpuMs);
+        out << ",\n";
+        write_percentiles_json(out, "gpuMs", result.gpuMs);
+        out << ",\n";
+        out << "      \"gpuSamples\": " << result.gpuSampleCount << ",\n";
+        out << "      \"logicalFlushes\": " << stats.logicalFlushes.size() << ",\n";
+        out << "      \"drawBatches\": " << stats.drawBatchCount << ",\n";
+        out << "      \"tessVertices\": " << stats.tessVertexCount << ",\n";
+        out << "      \"gradientRows\": " << stats.gradientRowCount << ",\n";
+        out << "      \"mappedBytes\": " << stats.totalMappedBytes << "\n";
+        out << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+
+    renderer.reset();
+    scenes.clear();
+    fiddleContext.reset();
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,759 @@
+/*
+ * Copyright 2024 Rive
+ */
+
+// CPU microbenchmarks for the renderer's geometry and batching kernels. Everything runs on the
+// calling thread against a PLSRenderContext with a null backend, so no window or GPU is needed and
+// the same numbers can be compared across ARM and x86 machines.
+//
+//   pls_microbench [--filter substring] [--samples N] [--warmup N] [--out results.json]
+//
+// Each benchmark runs at several data sizes and is named "<kernel>/<size>". Every sample times one
+// full pass over the data set; results report the per-pass percentiles in microseconds, and the
+// median nanoseconds per item.
+//
+// All inputs are generated from fixed seeds, so results are comparable across runs.
+//
+// Before benchmarking, it also runs a few correctness checks that only need the null backend
+// (currently FrameDescriptor::skipUnchangedFrames), and exits with an error if any fail.
+
+#include "rive/math/math_types.hpp"
+#include "rive/math/raw_path.hpp"
+#include "rive/math/simd.hpp"
+#include "rive/pls/pls_draw.hpp"
+#include "rive/pls/pls_render_context.hpp"
+#include "rive/pls/pls_render_context_helper_impl.hpp"
+#include "rive/pls/pls_render_target.hpp"
+#include "rive/pls/pls_renderer.hpp"
+#include "rive/pls/trivial_block_allocator.hpp"
+
+#include "eval_cubic.hpp"
+#include "gr_inner_fan_triangulator.hpp"
+#include "intersection_board.hpp"
+#include "path_utils.hpp"
+#include "pls_paint.hpp"
+#include "pls_path.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace rive;
+using namespace rive::pls;
+
+// Deterministic pseudo-random numbers, so every run benchmarks the exact same data.
+class LCG
+{
+public:
+    explicit LCG(uint32_t seed) : m_state(seed) {}
+
+    uint32_t next()
+    {
+        m_state = m_state * 1664525u + 1013904223u;
+        return m_state;
+    }
+
+    // Uniform float in [lo, hi).
+    float f(float lo, float hi) { return lo + (hi - lo) * ((next() >> 8) * (1.f / (1 << 24))); }
+
+private:
+    uint32_t m_state;
+};
+
+// Results get folded in here so the compiler can't discard the work being timed.
+static volatile float g_sink;
+
+// PLSRenderContextImpl that keeps every buffer in CPU memory and discards its flushes. Lets the
+// benchmarks exercise draw construction and flush layout without a GPU.
+class NullPLSRenderContextImpl : public PLSRenderContextHelperImpl
+{
+public:
+    NullPLSRenderContextImpl() {}
+
+    rcp<RenderBuffer> makeRenderBuffer(RenderBufferType, RenderBufferFlags, size_t) override
+    {
+        return nullptr;
+    }
+
+    rcp<PLSTexture> makeImageTexture(uint32_t, uint32_t, uint32_t, const uint8_t[]) override
+    {
+        return nullptr;
+    }
+
+    void resizeGradientTexture(uint32_t width, uint32_t height) override {}
+    void resizeTessellationTexture(uint32_t width, uint32_t height) override {}
+
+    void flush(const FlushDescriptor&) override {}
+
+protected:
+    std::unique_ptr<BufferRing> makeUniformBufferRing(size_t capacityInBytes) override
+    {
+        return std::make_unique<HeapBufferRing>(capacityInBytes);
+    }
+
+    std::unique_ptr<BufferRing> makeStorageBufferRing(size_t capacityInBytes,
+                                                      StorageBufferStructure) override
+    {
+        return std::make_unique<HeapBufferRing>(capacityInBytes);
+    }
+
+    std::unique_ptr<BufferRing> makeVertexBufferRing(size_t capacityInBytes) override
+    {
+        return std::make_unique<HeapBufferRing>(capacityInBytes);
+    }
+
+    std::unique_ptr<BufferRing> makeTextureTransferBufferRing(size_t capacityInBytes) override
+    {
+        return std::make_unique<HeapBufferRing>(capacityInBytes);
+    }
+};
+
+class NullPLSRenderTarget : public PLSRenderTarget
+{
+public:
+    NullPLSRenderTarget(uint32_t width, uint32_t height) : PLSRenderTarget(width, height) {}
+};
+
+constexpr static uint32_t kTargetSize = 2048;
+
+struct Percentiles
+{
+    double p50 = 0, p90 = 0, p99 = 0, min = 0;
+};
+
+static Percentiles compute_percentiles(std::vector<double> samples)
+{
+    Percentiles result;
+    if (samples.empty())
+    {
+        return result;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto nearestRank = [&samples](double p) {
+        size_t rank = static_cast<size_t>(ceil(p * samples.size()));
+        return samples[std::clamp<size_t>(rank, 1, samples.size()) - 1];
+    };
+    result.p50 = nearestRank(.5);
+    result.p90 = nearestRank(.9);
+    result.p99 = nearestRank(.99);
+    result.min = samples.front();
+    return result;
+}
+
+struct BenchResult
+{
+    std::string name;
+    size_t itemCount;
+    Percentiles passUs;
+};
+
+// Times benchmark passes and collects their results.
+class BenchRunner
+{
+public:
+    BenchRunner(const char* filter, int sampleCount, int warmupCount) :
+        m_filter(filter), m_sampleCount(sampleCount), m_warmupCount(warmupCount)
+    {}
+
+    // True if a benchmark with the given name passes the filter. Lets callers skip expensive setup.
+    bool enabled(const std::string& name) const
+    {
+        return m_filter == nullptr || name.find(m_filter) != std::string::npos;
+    }
+
+    // Runs 'pass' once per sample. 'itemCount' is the number of kernel invocations per pass, and
+    // is only used to report the time per item. If 'untimedReset' is provided, it runs before
+    // every pass, outside the timer.
+    void run(const std::string& name,
+             size_t itemCount,
+             const std::function<void()>& pass,
+             const std::function<void()>& untimedReset = nullptr)
+    {
+        if (!enabled(name))
+        {
+            return;
+        }
+        std::vector<double> passUs;
+        for (int i = 0; i < m_warmupCount + m_sampleCount; ++i)
+        {
+            if (untimedReset)
+            {
+                untimedReset();
+            }
+            auto start = std::chrono::steady_clock::now();
+            pass();
+            auto end = std::chrono::steady_clock::now();
+            if (i >= m_warmupCount)
+            {
+                passUs.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+            }
+        }
+        BenchResult result{name, itemCount, compute_percentiles(std::move(passUs))};
+        fprintf(stderr,
+                "%-32s p50 %10.2fus  p99 %10.2fus  %9.2fns/item\n",
+                name.c_str(),
+                result.passUs.p50,
+                result.passUs.p99,
+                result.passUs.p50 * 1000 / std::max<size_t>(itemCount, 1));
+        m_results.push_back(std::move(result));
+    }
+
+    int sampleCount() const { return m_sampleCount; }
+    const std::vector<BenchResult>& results() const { return m_results; }
+
+private:
+    const char* m_filter;
+    const int m_sampleCount;
+    const int m_warmupCount;
+    std::vector<BenchResult> m_results;
+};
+
+static std::vector<Vec2D> make_random_cubics(size_t cubicCount, LCG* rand)
+{
+    std::vector<Vec2D> pts(cubicCount * 4);
+    for (Vec2D& pt : pts)
+    {
+        pt = {rand->f(0, kTargetSize), rand->f(0, kTargetSize)};
+    }
+    return pts;
+}
+
+static void bench_chop_cubic_at(BenchRunner* runner)
+{
+    LCG rand(1);
+    for (size_t cubicCount : {1024, 16384, 262144})
+    {
+        std::vector<Vec2D> pts = make_random_cubics(cubicCount, &rand);
+        std::vector<float> t(cubicCount);
+        for (float& value : t)
+        {
+            value = rand.f(0, 1);
+        }
+        runner->run("chop_cubic_at/" + std::to_string(cubicCount), cubicCount, [&]() {
+            Vec2D dst[7];
+            float sum = 0;
+            for (size_t i = 0; i < cubicCount; ++i)
+            {
+                pathutils::ChopCubicAt(pts.data() + i * 4, dst, t[i]);
+                sum += dst[3].x;
+            }
+            g_sink = sum;
+        });
+        runner->run("chop_cubic_at_2/" + std::to_string(cubicCount), cubicCount, [&]() {
+            Vec2D dst[10];
+            float sum = 0;
+            for (size_t i = 0; i < cubicCount; ++i)
+            {
+                pathutils::ChopCubicAt(pts.data() + i * 4, dst, t[i] * .5f, .5f + t[i] * .5f);
+                sum += dst[3].x + dst[6].y;
+            }
+            g_sink = sum;
+        });
+    }
+}
+
+// Evaluates each of 1024 cubics at evenly spaced T values, two at a time, the way the CPU-side
+// tessellation code that uses EvalCubic does.
+static void bench_eval_cubic(BenchRunner* runner)
+{
+    constexpr static size_t kCubicCount = 1024;
+    LCG rand(2);
+    std::vector<Vec2D> pts = make_random_cubics(kCubicCount, &rand);
+    for (uint32_t pointsPerCubic : {4, 16, 64, 256})
+    {
+        runner->run("eval_cubic_at/" + std::to_string(pointsPerCubic),
+                    kCubicCount * pointsPerCubic,
+                    [&]() {
+                        float dt = 1.f / pointsPerCubic;
+                        float4 sum = 0;
+                        for (size_t i = 0; i < kCubicCount; ++i)
+                        {
+                            EvalCubic evalCubic(pts.data() + i * 4);
+                            float4 t = float4{0, 0, dt, dt};
+                            for (uint32_t j = 0; j < pointsPerCubic; j += 2)
+                            {
+                                sum += evalCubic.at(t);
+                                t += 2 * dt;
+                            }
+                        }
+                        g_sink = sum.x + sum.y + sum.z + sum.w;
+                    });
+    }
+}
+
+// Random draw-sized rectangles: mostly small, with the occasional large one, like a typical scene.
+static std::vector<int4> make_random_rects(size_t rectCount, int viewportSize, LCG* rand)
+{
+    std::vector<int4> rects(rectCount);
+    for (int4& rect : rects)
+    {
+        float maxSize = rand->next() % 16 == 0 ? viewportSize * .5f : viewportSize * .05f;
+        int w = static_cast<int>(rand->f(1, maxSize));
+        int h = static_cast<int>(rand->f(1, maxSize));
+        int l = static_cast<int>(rand->f(0, static_cast<float>(viewportSize - w)));
+        int t = static_cast<int>(rand->f(0, static_cast<float>(viewportSize - h)));
+        rect = int4{l, t, l + w, t + h};
+    }
+    return rects;
+}
+
+static void bench_intersection_board(BenchRunner* runner)
+{
+    LCG rand(3);
+    for (size_t rectCount : {1000, 8000, 32000})
+    {
+        std::vector<int4> rects = make_random_rects(rectCount, kTargetSize, &rand);
+        IntersectionBoard board;
+        runner->run(
+            "intersection_board_add/" + std::to_string(rectCount),
+            rectCount,
+            [&]() {
+                int32_t maxGroupIndex = 0;
+                for (const int4& rect : rects)
+                {
+                    maxGroupIndex = std::max(maxGroupIndex, board.addRectangle(rect));
+                }
+                g_sink = static_cast<float>(maxGroupIndex);
+            },
+            [&]() { board.resizeAndReset(kTargetSize, kTargetSize); });
+    }
+
+    // Queries a single 255x255 tile that already holds 'rectCount' rectangles.
+    constexpr static size_t kQueryCount = 1024;
+    for (size_t rectCount : {64, 512, 4096})
+    {
+        std::vector<int4> rects = make_random_rects(rectCount, 255, &rand);
+        std::vector<int4> queries = make_random_rects(kQueryCount, 255, &rand);
+        IntersectionTile tile;
+        tile.reset(0, 0);
+        for (size_t i = 0; i < rects.size(); ++i)
+        {
+            tile.addRectangle(rects[i], static_cast<int32_t>(i + 1));
+        }
+        runner->run("intersection_tile_find/" + std::to_string(rectCount), kQueryCount, [&]() {
+            int32_t sum = 0;
+            for (const int4& query : queries)
+            {
+                int32x8 maxGroupIndices = tile.findMaxIntersectingGroupIndex(query, 0);
+                sum += simd::reduce_max(maxGroupIndices);
+            }
+            g_sink = static_cast<float>(sum);
+        });
+    }
+}
+
+static void add_polygon(RawPath* path, const std::vector<Vec2D>& pts)
+{
+    path->moveTo(pts[0].x, pts[0].y);
+    for (size_t i = 1; i < pts.size(); ++i)
+    {
+        path->lineTo(pts[i].x, pts[i].y);
+    }
+    path->close();
+}
+
+// Representative triangulator inputs with roughly 'vertexCount' vertices each.
+static std::vector<std::pair<std::string, RawPath>> make_triangulator_shapes(uint32_t vertexCount,
+                                                                             LCG* rand)
+{
+    constexpr static float kCenter = kTargetSize * .5f;
+    constexpr static float kRadius = kTargetSize * .45f;
+    std::vector<std::pair<std::string, RawPath>> shapes;
+    std::vector<Vec2D> pts(vertexCount);
+
+    // Convex: a flattened circle.
+    for (uint32_t i = 0; i < vertexCount; ++i)
+    {
+        float theta = i * 2 * math::PI / vertexCount;
+        pts[i] = {kCenter + cosf(theta) * kRadius, kCenter + sinf(theta) * kRadius};
+    }
+    add_polygon(&shapes.emplace_back("convex", RawPath()).second, pts);
+
+    // Concave: a circle with a randomly jittered radius.
+    for (uint32_t i = 0; i < vertexCount; ++i)
+    {
+        float theta = i * 2 * math::PI / vertexCount;
+        float r = kRadius * rand->f(.5f, 1);
+        pts[i] = {kCenter + cosf(theta) * r, kCenter + sinf(theta) * r};
+    }
+    add_polygon(&shapes.emplace_back("concave", RawPath()).second, pts);
+
+    // Self-intersecting: a star that skips ahead by just under half the circle at each step.
+    uint32_t step = std::max(vertexCount / 2 - 1, 1u);
+    for (uint32_t i = 0; i < vertexCount; ++i)
+    {
+        float theta = (i * step % vertexCount) * 2 * math::PI / vertexCount;
+        pts[i] = {kCenter + cosf(theta) * kRadius, kCenter + sinf(theta) * kRadius};
+    }
+    add_polygon(&shapes.emplace_back("star", RawPath()).second, pts);
+
+    // Many small contours, e.g., text.
+    RawPath& glyphs = shapes.emplace_back("contours", RawPath()).second;
+    for (uint32_t i = 0; i + 8 <= vertexCount; i += 8)
+    {
+        float cx = rand->f(kCenter - kRadius, kCenter + kRadius);
+        float cy = rand->f(kCenter - kRadius, kCenter + kRadius);
+        pts.resize(8);
+        for (uint32_t j = 0; j < 8; ++j)
+        {
+            float theta = j * 2 * math::PI / 8;
+            pts[j] = {cx + cosf(theta) * 20, cy + sinf(theta) * 20};
+        }
+        add_polygon(&glyphs, pts);
+    }
+    return shapes;
+}
+
+static void bench_triangulator(BenchRunner* runner)
+{
+    constexpr static auto kTriangulatorDirection = GrTriangulator::Comparator::Direction::kVertical;
+    LCG rand(4);
+    TrivialBlockAllocator allocator(1024 * 1024);
+    std::vector<TriangleVertex> vertices;
+    for (uint32_t vertexCount : {64, 512, 4096})
+    {
+        for (auto& [shapeName, path] : make_triangulator_shapes(vertexCount, &rand))
+        {
+            std::string name = "triangulator_" + shapeName + "/" + std::to_string(vertexCount);
+            if (!runner->enabled(name))
+            {
+                continue;
+            }
+            runner->run(
+                name,
+                vertexCount,
+                [&]() {
+                    GrInnerFanTriangulator triangulator(path,
+                                                        Mat2D(),
+                                                        kTriangulatorDirection,
+                                                        FillRule::nonZero,
+                                                        false,
+                                                        &allocator);
+                    vertices.resize(triangulator.maxVertexCount());
+                    WriteOnlyMappedMemory<TriangleVertex> mappedVertices(vertices.data(),
+                                                                         vertices.size());
+                    g_sink = static_cast<float>(triangulator.polysToTriangles(&mappedVertices, 1) +
+                                                triangulator.groutList().count());
+                },
+                [&]() { allocator.reset(); });
+        }
+    }
+}
+
+// 'curveCount' random cubics, split into contours of 16 curves each.
+static RawPath make_curvy_path(uint32_t curveCount, LCG* rand)
+{
+    RawPath path;
+    for (uint32_t i = 0; i < curveCount; ++i)
+    {
+        if (i % 16 == 0)
+        {
+            if (i != 0)
+            {
+                path.close();
+            }
+            path.moveTo(rand->f(0, kTargetSize), rand->f(0, kTargetSize));
+        }
+        path.cubicTo(rand->f(0, kTargetSize),
+                     rand->f(0, kTargetSize),
+                     rand->f(0, kTargetSize),
+                     rand->f(0, kTargetSize),
+                     rand->f(0, kTargetSize),
+                     rand->f(0, kTargetSize));
+    }
+    path.close();
+    return path;
+}
+
+// Constructs MidpointFanPathDraws directly, which runs the path analysis (chopping, segment
+// counting, join/cap preparation) without retained data or any LOD shortcuts.
+static void bench_midpoint_fan(BenchRunner* runner, PLSRenderContext* context)
+{
+    constexpr static size_t kDrawsPerPass = 16;
+    LCG rand(5);
+    for (uint32_t curveCount : {16, 256, 4096})
+    {
+        RawPath rawPath = make_curvy_path(curveCount, &rand);
+        rcp<const PLSPath> path = make_rcp<PLSPath>(FillRule::nonZero, rawPath);
+        for (bool stroked : {false, true})
+        {
+            PLSPaint paint;
+            paint.color(0xff008000);
+            if (stroked)
+            {
+                paint.style(RenderPaintStyle::stroke);
+                paint.thickness(10);
+                paint.join(StrokeJoin::round);
+                paint.cap(StrokeCap::round);
+            }
+            Mat2D matrix(.9f, .1f, -.1f, .9f, 20, 20);
+            IAABB pixelBounds = matrix.mapBoundingBox(path->getBounds()).roundOut();
+            PLSRenderContext::DrawAllocators& allocators = context->drawAllocators();
+            runner->run(
+                (stroked ? "midpoint_fan_stroke/" : "midpoint_fan_fill/") +
+                    std::to_string(curveCount),
+                kDrawsPerPass * curveCount,
+                [&]() {
+                    for (size_t i = 0; i < kDrawsPerPass; ++i)
+                    {
+                        PLSDrawUniquePtr draw(
+                            allocators.perFrameAllocator().make<MidpointFanPathDraw>(
+                                context,
+                                &allocators,
+                                pixelBounds,
+                                matrix,
+                                path,
+                                FillRule::nonZero,
+                                &paint));
+                    }
+                },
+                [&]() { allocators.reset(); });
+        }
+    }
+}
+
+// Builds keys with the same bit layout that LogicalFlush sorts in atomic and depthStencil modes:
+// [draw group, draw type, texture hash, blend mode, draw contents, draw index].
+static std::vector<int64_t> make_draw_sort_keys(size_t drawCount, LCG* rand)
+{
+    std::vector<int64_t> keys(drawCount);
+    uint32_t drawGroupCount = std::max<uint32_t>(static_cast<uint32_t>(drawCount / 64), 1);
+    for (size_t i = 0; i < drawCount; ++i)
+    {
+        int64_t drawGroup = rand->next() % drawGroupCount + 1;
+        if (rand->next() % 4 == 0)
+        {
+            drawGroup = -drawGroup; // Opaque, reverse-sorted depthStencil draws.
+        }
+        int64_t key = drawGroup << 45;
+        key |= static_cast<int64_t>(rand->next() % 6) << 42;
+        key |= static_cast<int64_t>(rand->next() % 8 == 0 ? rand->next() & 0x3fff : 0) << 28;
+        key |= static_cast<int64_t>(rand->next() % 16 == 0 ? rand->next() & 0xf : 0) << 24;
+        key |= static_cast<int64_t>(rand->next() & 0x3f) << 18;
+        key |= i;
+        keys[i] = key;
+    }
+    return keys;
+}
+
+static void bench_draw_sort(BenchRunner* runner, PLSRenderContext* context)
+{
+    LCG rand(6);
+    for (size_t drawCount : {1000, 8000, 32767})
+    {
+        std::vector<int64_t> keys = make_draw_sort_keys(drawCount, &rand);
+        std::vector<int64_t> work(drawCount), scratch(drawCount);
+        runner->run(
+            "draw_sort_keys/" + std::to_string(drawCount),
+            drawCount,
+            [&]() { SortInt64Keys(work.data(), scratch.data(), work.size(), 16); },
+            [&]() { work = keys; });
+    }
+
+    // The whole atomic-mode flush (layout, the draw-list sort, batching, and buffer writes) of
+    // 'drawCount' small overlapping paths, without the GPU work.
+    NullPLSRenderTarget renderTarget(kTargetSize, kTargetSize);
+    PLSRenderer renderer(context);
+    for (size_t drawCount : {1000, 8000, 32767})
+    {
+        std::string name = "atomic_flush/" + std::to_string(drawCount);
+        if (!runner->enabled(name))
+        {
+            continue;
+        }
+        std::vector<rcp<RenderPath>> paths;
+        std::vector<rcp<RenderPaint>> paints;
+        for (size_t i = 0; i < drawCount; ++i)
+        {
+            float x = rand.f(0, kTargetSize - 64), y = rand.f(0, kTargetSize - 64);
+            RawPath rawPath;
+            rawPath.moveTo(x, y);
+            rawPath.cubicTo(x + 64, y, x + 64, y + 64, x + 32, y + 64);
+            rawPath.lineTo(x, y + 48);
+            rawPath.close();
+            paths.push_back(context->makeRenderPath(rawPath, FillRule::nonZero));
+            paints.push_back(context->makeRenderPaint());
+            paints.back()->color(0x80000000 | (rand.next() >> 8));
+            paints.back()->blendMode(rand.next() % 4 == 0 ? BlendMode::multiply
+                                                          : BlendMode::srcOver);
+        }
+        runner->run(
+            name,
+            drawCount,
+            [&]() { context->flush({&renderTarget}); },
+            [&]() {
+                PLSRenderContext::FrameDescriptor frameDescriptor;
+                frameDescriptor.renderTargetWidth = kTargetSize;
+                frameDescriptor.renderTargetHeight = kTargetSize;
+                frameDescriptor.disableRasterOrdering = true;
+                context->beginFrame(frameDescriptor);
+                for (size_t i = 0; i < drawCount; ++i)
+                {
+                    renderer.drawPath(paths[i].get(), paints[i].get());
+                }
+            });
+    }
+}
+
+// Flushes the same frame twice and checks whether the second one got skipped.
+static bool check_skip_unchanged_frames(PLSRenderContext* context)
+{
+    constexpr static uint32_t kSize = 256;
+    NullPLSRenderTarget renderTarget(kSize, kSize);
+    PLSRenderer renderer(context);
+    auto makeRect = [context](float l, float t, float r, float b) {
+        RawPath rawPath;
+        rawPath.moveTo(l, t);
+        rawPath.lineTo(r, t);
+        rawPath.lineTo(r, b);
+        rawPath.lineTo(l, b);
+        rawPath.close();
+        return context->makeRenderPath(rawPath, FillRule::nonZero);
+    };
+    rcp<RenderPath> fullRect = makeRect(0, 0, kSize, kSize);
+    rcp<RenderPath> smallRect = makeRect(32, 32, 96, 96);
+    rcp<RenderPaint> opaquePaint = context->makeRenderPaint();
+    opaquePaint->color(0xff204080);
+    rcp<RenderPaint> translucentPaint = context->makeRenderPaint();
+    translucentPaint->color(0x80ff0000);
+
+    struct Case
+    {
+        const char* name;
+        pls::LoadAction loadAction;
+        bool coverWithOpaqueRect;
+        bool expectSkip;
+    };
+    const Case cases[] = {
+        // A translucent draw keeps blending onto the preserved pixels, so each frame differs.
+        {"translucent draw over preserved contents", pls::LoadAction::preserveRenderTarget, false,
+         false},
+        {"translucent draw over an opaque full-target rect",
+         pls::LoadAction::preserveRenderTarget, true, true},
+        {"translucent draw over a cleared target", pls::LoadAction::clear, false, true},
+    };
+    bool passed = true;
+    for (const Case& c : cases)
+    {
+        bool skipped = false;
+        for (int frame = 0; frame < 2; ++frame)
+        {
+            PLSRenderContext::FrameDescriptor frameDescriptor;
+            frameDescriptor.renderTargetWidth = kSize;
+            frameDescriptor.renderTargetHeight = kSize;
+            frameDescriptor.loadAction = c.loadAction;
+            frameDescriptor.skipUnchangedFrames = true;
+            context->beginFrame(frameDescriptor);
+            if (c.coverWithOpaqueRect)
+            {
+                renderer.drawPath(fullRect.get(), opaquePaint.get());
+            }
+            renderer.drawPath(smallRect.get(), translucentPaint.get());
+            context->flush({&renderTarget});
+            skipped = context->lastFrameStats().skippedUnchangedFrame;
+        }
+        if (skipped != c.expectSkip)
+        {
+            fprintf(stderr,
+                    "FAILED: skipUnchangedFrames, %s: the repeated frame was %sskipped.\n",
+                    c.name,
+                    skipped ? "" : "not ");
+            passed = false;
+        }
+    }
+    return passed;
+}
+
+int main(int argc, const char* argv[])
+{
+    const char* filter = nullptr;
+    const char* outPath = nullptr;
+    int sampleCount = 50;
+    int warmupCount = 5;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "--filter") && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--samples") && i + 1 < argc)
+        {
+            sampleCount = std::max(atoi(argv[++i]), 1);
+        }
+        else if (!strcmp(argv[i], "--warmup") && i + 1 < argc)
+        {
+            warmupCount = std::max(atoi(argv[++i]), 0);
+        }
+        else if (!strcmp(argv[i], "--out") && i + 1 < argc)
+        {
+            outPath = argv[++i];
+        }
+        else
+        {
+            fprintf(stderr,
+                    "usage: pls_microbench [--filter substring] [--samples N] [--warmup N] "
+                    "[--out results.json]\n");
+            return 1;
+        }
+    }
+
+    auto context = std::make_unique<PLSRenderContext>(std::make_unique<NullPLSRenderContextImpl>());
+    if (!check_skip_unchanged_frames(context.get()))
+    {
+        return 1;
+    }
+    BenchRunner runner(filter, sampleCount, warmupCount);
+
+    bench_chop_cubic_at(&runner);
+    bench_eval_cubic(&runner);
+    bench_intersection_board(&runner);
+    bench_triangulator(&runner);
+
+    // Draw construction needs an open frame to read the interlock mode and precision from.
+    PLSRenderContext::FrameDescriptor frameDescriptor;
+    frameDescriptor.renderTargetWidth = kTargetSize;
+    frameDescriptor.renderTargetHeight = kTargetSize;
+    context->beginFrame(frameDescriptor);
+    bench_midpoint_fan(&runner, context.get());
+    NullPLSRenderTarget renderTarget(kTargetSize, kTargetSize);
+    context->flush({&renderTarget});
+
+    bench_draw_sort(&runner, context.get());
+
+    std::ofstream outFile;
+    if (outPath != nullptr)
+    {
+        outFile.open(outPath);
+        if (!outFile)
+        {
+            fprintf(stderr, "Failed to open '%s' for writing.\n", outPath);
+            return 1;
+        }
+    }
+    std::ostream& out = outPath != nullptr ? outFile : std::cout;
+    const std::vector<BenchResult>& results = runner.results();
+    out << "{\n";
+    out << "  \"samples\": " << runner.sampleCount() << ",\n";
+    out << "  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchResult& result = results[i];
+        double nsPerItem = result.passUs.p50 * 1000 / std::max<size_t>(result.itemCount, 1);
+        out << "    {\"name\": \"" << result.name << "\", \"items\": " << result.itemCount
+            << ", \"passUs\": {\"p50\": " << result.passUs.p50
+            << ", \"p90\": " << result.passUs.p90 << ", \"p99\": " << result.passUs.p99
+            << ", \"min\": " << result.passUs.min << "}, \"nsPerItem\": " << nsPerItem << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+    return 0;
+}
@@ -57,7 +57,7 @@ do
         libdirs({
             RIVE_RUNTIME_DIR .. '/skia/dependencies/glfw_build/src/Release',
         })
-        links({ 'glfw3', 'opengl32', 'd3d11', 'dxgi', 'd3dcompiler' })
+        links({ 'glfw3', 'opengl32', 'd3d11', 'd3d12', 'dxgi', 'd3dcompiler' })
     end
 
     filter('system:macosx')
@@ -162,6 +162,163 @@ do
     end
 end
 
+project('pls_bench')
+do
+    dependson('rive')
+    kind('ConsoleApp')
+    includedirs({
+        'include',
+        RIVE_RUNTIME_DIR .. '/include',
+        'glad',
+        'path_fiddle',
+        RIVE_RUNTIME_DIR .. '/skia/dependencies/glfw/include',
+    })
+    flags({ 'FatalWarnings' })
+
+    defines({ 'YOGA_EXPORT=' })
+
+    files({
+        'pls_bench/pls_bench.cpp',
+        'path_fiddle/fiddle_context_*.cpp',
+    })
+
+    links({
+        'rive',
+        'rive_pls_renderer',
+        'rive_decoders',
+        'libpng',
+        'zlib',
+        'libjpeg',
+        'rive_harfbuzz',
+        'rive_sheenbidi',
+        'rive_yoga',
+    })
+
+    filter('system:windows')
+    do
+        architecture('x64')
+        defines({ 'RIVE_WINDOWS', '_CRT_SECURE_NO_WARNINGS' })
+        libdirs({
+            RIVE_RUNTIME_DIR .. '/skia/dependencies/glfw_build/src/Release',
+        })
+        links({ 'glfw3', 'opengl32', 'd3d11', 'd3d12', 'dxgi', 'd3dcompiler' })
+    end
+
+    filter('system:macosx')
+    do
+        files({ 'path_fiddle/fiddle_context_*.mm' })
+        buildoptions({ '-fobjc-arc' })
+        links({
+            'glfw3',
+            'Cocoa.framework',
+            'Metal.framework',
+            'QuartzCore.framework',
+            'IOKit.framework',
+        })
+        libdirs({ RIVE_RUNTIME_DIR .. '/skia/dependencies/glfw_build/src' })
+    end
+
+    filter('system:linux')
+    do
+        links({ 'glfw3' })
+        libdirs({ RIVE_RUNTIME_DIR .. '/skia/dependencies/glfw_build/src' })
+    end
+
+    filter('options:with_vulkan')
+    do
+        if vulkan_headers then
+            externalincludedirs({ vulkan_headers .. '/include' })
+        end
+        if vulkan_memory_allocator then
+            externalincludedirs({ vulkan_memory_allocator .. '/include' })
+        end
+    end
+
+    filter({ 'options:with_vulkan', 'system:windows' })
+    do
+        if vulkan_windows_sdk then
+            libdirs({ vulkan_windows_sdk .. '/Lib' })
+        end
+        links({ 'vulkan-1' })
+    end
+
+    filter({ 'options:with_vulkan', 'system:not windows' })
+    do
+        links({ 'vulkan' })
+    end
+
+    filter('options:with-dawn')
+    do
+        includedirs({
+            'dependencies/dawn/include',
+            'dependencies/dawn/out/release/gen/include',
+        })
+        libdirs({
+            'dependencies/dawn/out/release/obj/src/dawn',
+            'dependencies/dawn/out/release/obj/src/dawn/native',
+            'dependencies/dawn/out/release/obj/src/dawn/platform',
+            'dependencies/dawn/out/release/obj/src/dawn/platform',
+        })
+        links({
+            'dawn_native_static',
+            'webgpu_dawn',
+            'dawn_platform_static',
+            'dawn_proc_static',
+        })
+    end
+
+    filter({ 'options:with-dawn', 'system:windows' })
+    do
+        links({ 'dxguid' })
+    end
+
+    filter({ 'options:with-dawn', 'system:macosx' })
+    do
+        links({ 'IOSurface.framework' })
+    end
+
+    filter({ 'options:with_rive_layout' })
+    do
+        defines({ 'YOGA_EXPORT=' })
+        includedirs({ yoga })
+        links({
+            'rive_yoga',
+        })
+    end
+end
+
+project('pls_microbench')
+do
+    dependson('rive')
+    kind('ConsoleApp')
+    includedirs({
+        'include',
+        'renderer',
+        RIVE_RUNTIME_DIR .. '/include',
+    })
+    flags({ 'FatalWarnings' })
+
+    files({ 'pls_bench/pls_microbench.cpp' })
+
+    links({
+        'rive',
+        'rive_pls_renderer',
+        'rive_decoders',
+        'libpng',
+        'zlib',
+        'libjpeg',
+        'rive_harfbuzz',
+        'rive_sheenbidi',
+        'rive_yoga',
+    })
+
+    filter('system:windows')
+    do
+        architecture('x64')
+        defines({ 'RIVE_WINDOWS', '_CRT_SECURE_NO_WARNINGS' })
+    end
+end
+
 if _OPTIONS['with-webgpu'] or _OPTIONS['with-dawn'] then
     project('webgpu_player')
     do
@@ -227,7 +384,7 @@ if _OPTIONS['with-webgpu'] or _OPTIONS['with-dawn'] then
             libdirs({
                 RIVE_RUNTIME_DIR .. '/skia/dependencies/glfw_build/src/Release',
             })
-            links({ 'glfw3', 'opengl32', 'd3d11', 'dxgi', 'd3dcompiler' })
+            links({ 'glfw3', 'opengl32', 'd3d11', 'd3d12', 'dxgi', 'd3dcompiler' })
         end
 
         filter('system:macosx')
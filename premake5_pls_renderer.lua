@@ -78,6 +78,15 @@ do
     defines({ 'RIVE_WEBGPU' })
 end
 
+newoption({
+    trigger = 'with-pls-tracing',
+    description = 'compile in trace scopes and GPU debug labels (see pls_trace.hpp)',
+})
+filter({ 'options:with-pls-tracing' })
+do
+    defines({ 'RIVE_PLS_TRACING' })
+end
+
 filter({ 'system:ios', 'options:variant=emulator' })
 do
     defines({ 'RIVE_IOS_SIMULATOR' })
@@ -88,6 +97,22 @@ do
     defines({ 'RIVE_WEBGL' })
 end
 
+newoption({
+    trigger = 'with-wasm-threads',
+    description = 'compile emscripten builds with wasm SIMD and pthreads (see pls::WorkerPool)',
+})
+filter({ 'system:emscripten', 'options:with-wasm-threads' })
+do
+    defines({ 'RIVE_WASM_THREADS' })
+    -- Every object in a pthreads build has to be compiled with -pthread, so these are defined
+    -- outside of a project. -msimd128 lowers rive::simd's vector types to wasm SIMD instead of
+    -- scalar code.
+    buildoptions({ '-msimd128', '-pthread' })
+    -- Spawn the Web Workers up front: the main browser thread can't block while a new worker
+    -- starts up.
+    linkoptions({ '-pthread', '-sPTHREAD_POOL_SIZE=navigator.hardwareConcurrency' })
+end
+
 filter({})
 
 -- Minify and compile PLS shaders offline.
@@ -120,6 +145,14 @@ if _OPTIONS['with_vulkan'] or _OPTIONS['with-dawn'] or _OPTIONS['with-webgpu'] t
     makecommand = makecommand .. ' spirv'
 end
 
+newoption({
+    trigger = 'd3d_precompiled_shaders',
+    description = 'compile the D3D11 draw shaders offline with fxc (must be on the PATH)',
+})
+if _OPTIONS['d3d_precompiled_shaders'] then
+    makecommand = makecommand .. ' d3d'
+end
+
 function execute_and_check(cmd)
     if not os.execute(cmd) then
         error('\nError executing command:\n  ' .. cmd)
@@ -282,6 +315,11 @@ do
         files({ 'renderer/d3d/*.cpp' })
     end
 
+    filter({ 'system:windows', 'options:d3d_precompiled_shaders' })
+    do
+        defines({ 'RIVE_D3D_PRECOMPILED_SHADERS' })
+    end
+
     filter('system:emscripten')
     do
         files({ 'renderer/gl/pls_impl_webgl.cpp' })
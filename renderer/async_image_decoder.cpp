@@ -0,0 +1,170 @@
+/*
+ * Copyright 2024 Rive
+ */
+
+#include "async_image_decoder.hpp"
+
+#include "rive/pls/pls_image.hpp"
+
+#ifdef RIVE_DECODERS
+#include "rive/decoders/bitmap_decoder.hpp"
+#endif
+
+namespace rive::pls
+{
+AsyncImageDecoder::~AsyncImageDecoder()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_shouldQuit = true;
+    }
+    m_workAddedCondition.notify_all();
+    for (std::thread& thread : m_decoderThreads)
+    {
+        thread.join();
+    }
+}
+
+void AsyncImageDecoder::pushJob(AsyncImageDecodeJob&& job)
+{
+#ifdef RIVE_WEBGL
+    // WebGL builds don't have threads. Decode synchronously, but still deliver the result through
+    // popFinishedJob() so the caller sees the same behavior on every platform.
+    Decode(&job);
+    std::lock_guard lock(m_mutex);
+    m_finishedJobs.push(std::move(job));
+    ++m_jobsInFlight;
+#else
+    {
+        std::lock_guard lock(m_mutex);
+        // Spin up another thread for every job that can't be serviced by an idle thread, up to
+        // m_threadCount.
+        if (m_decoderThreads.size() < m_threadCount &&
+            m_jobsInFlight - m_finishedJobs.size() >= m_decoderThreads.size())
+        {
+            m_decoderThreads.emplace_back(&AsyncImageDecoder::threadMain, this);
+        }
+        m_pendingJobs.push(std::move(job));
+        ++m_jobsInFlight;
+    }
+    m_workAddedCondition.notify_one();
+#endif
+}
+
+bool AsyncImageDecoder::popFinishedJob(AsyncImageDecodeJob* job, bool wait)
+{
+    std::unique_lock lock(m_mutex);
+    while (m_finishedJobs.empty())
+    {
+        if (!wait || m_jobsInFlight == 0)
+        {
+            return false;
+        }
+        m_workFinishedCondition.wait(lock);
+    }
+    *job = std::move(m_finishedJobs.front());
+    m_finishedJobs.pop();
+    --m_jobsInFlight;
+    return true;
+}
+
+size_t AsyncImageDecoder::jobsInFlight() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_jobsInFlight;
+}
+
+bool AsyncImageDecoder::DecodeRGBA(Span<const uint8_t> encodedBytes, AsyncImageDecodeJob* job)
+{
+#ifdef RIVE_DECODERS
+    auto bitmap = Bitmap::decode(encodedBytes.data(), encodedBytes.size());
+    if (bitmap)
+    {
+        // For now, PLSRenderContextImpl::makeImageTexture() only accepts RGBA.
+        if (bitmap->pixelFormat() != Bitmap::PixelFormat::RGBA)
+        {
+            bitmap->pixelFormat(Bitmap::PixelFormat::RGBA);
+        }
+        job->width = bitmap->width();
+        job->height = bitmap->height();
+        job->rgbaPixels.assign(bitmap->bytes(),
+                               bitmap->bytes() + size_t(job->width) * job->height * 4);
+        return true;
+    }
+#endif
+    return false;
+}
+
+void AsyncImageDecoder::DownsampleRGBA(AsyncImageDecodeJob* job, uint32_t levels)
+{
+    for (uint32_t i = 0; i < levels && (job->width > 1 || job->height > 1); ++i)
+    {
+        uint32_t dstWidth = std::max(job->width >> 1, 1u);
+        uint32_t dstHeight = std::max(job->height >> 1, 1u);
+        const uint8_t* src = job->rgbaPixels.data();
+        size_t srcStride = size_t(job->width) * 4;
+        // Writing in place is safe because every destination pixel lands at or before the source
+        // pixels that are still left to read.
+        uint8_t* dst = job->rgbaPixels.data();
+        for (uint32_t y = 0; y < dstHeight; ++y)
+        {
+            const uint8_t* row0 = src + std::min(y * 2, job->height - 1) * srcStride;
+            const uint8_t* row1 = src + std::min(y * 2 + 1, job->height - 1) * srcStride;
+            for (uint32_t x = 0; x < dstWidth; ++x)
+            {
+                size_t x0 = std::min(x * 2, job->width - 1) * 4;
+                size_t x1 = std::min(x * 2 + 1, job->width - 1) * 4;
+                for (size_t c = 0; c < 4; ++c)
+                {
+                    *dst++ = (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2;
+                }
+            }
+        }
+        job->width = dstWidth;
+        job->height = dstHeight;
+        job->rgbaPixels.resize(size_t(dstWidth) * dstHeight * 4);
+    }
+}
+
+void AsyncImageDecoder::Decode(AsyncImageDecodeJob* job)
+{
+    const std::vector<uint8_t>& encodedBytes =
+        job->streamingState != nullptr ? job->streamingState->encodedBytes() : job->encodedBytes;
+    if (DecodeRGBA(Span<const uint8_t>(encodedBytes.data(), encodedBytes.size()), job))
+    {
+        DownsampleRGBA(job, job->downsampleLevel);
+    }
+}
+
+void AsyncImageDecoder::threadMain()
+{
+    AsyncImageDecodeJob job;
+    std::unique_lock lock(m_mutex);
+    for (;;)
+    {
+        while (m_pendingJobs.empty() && !m_shouldQuit)
+        {
+            m_workAddedCondition.wait(lock);
+        }
+
+        if (m_shouldQuit)
+        {
+            return;
+        }
+
+        job = std::move(m_pendingJobs.front());
+        m_pendingJobs.pop();
+
+        lock.unlock();
+        Decode(&job);
+        if (!job.keepEncodedBytes)
+        {
+            job.encodedBytes = {}; // Free the encoded data now that we're done with it.
+        }
+        lock.lock();
+
+        m_finishedJobs.push(std::move(job));
+        m_workFinishedCondition.notify_all();
+    }
+}
+} // namespace rive::pls
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2024 Rive
+ */
+
+#pragma once
+
+#include "rive/renderer.hpp"
+#include "rive/span.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace rive::pls
+{
+class PLSImageStreamingState;
+
+// Defines a job to decode an encoded image (PNG, JPEG, WebP, etc.) to RGBA pixels.
+struct AsyncImageDecodeJob
+{
+    std::vector<uint8_t> encodedBytes;
+    // Invoked on the rendering thread once the texture has been created (null on failure).
+    std::function<void(rcp<RenderImage>)> onDecoded;
+
+    // Set for jobs that stream in a sharper texture for an existing image. In that case the
+    // encoded bytes come from the streaming state instead, and the result is downsampled by
+    // 'downsampleLevel' mip levels before being handed back.
+    std::shared_ptr<PLSImageStreamingState> streamingState;
+    uint32_t downsampleLevel = 0;
+
+    // Hold on to encodedBytes after decoding, e.g., so the image can be streamed.
+    bool keepEncodedBytes = false;
+
+    // Filled in by the decoder thread. Empty if the image failed to decode.
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> rgbaPixels;
+};
+
+// Decodes images on a small pool of background threads, so loading a file with many embedded
+// images doesn't stall the thread that renders. The GPU upload still happens on the rendering
+// thread, after popFinishedJob().
+class AsyncImageDecoder
+{
+public:
+    AsyncImageDecoder(size_t threadCount) : m_threadCount(threadCount) {}
+    ~AsyncImageDecoder();
+
+    void pushJob(AsyncImageDecodeJob&&);
+
+    // Returns false if no jobs have finished. If 'wait' is true, blocks until a job finishes,
+    // unless there are no jobs in flight.
+    bool popFinishedJob(AsyncImageDecodeJob*, bool wait);
+
+    // Number of jobs that have been pushed but not yet popped.
+    size_t jobsInFlight() const;
+
+    // Decodes 'encodedBytes' into job->width, height, and rgbaPixels. Returns false on failure.
+    static bool DecodeRGBA(Span<const uint8_t> encodedBytes, AsyncImageDecodeJob*);
+
+    // Box filters job->rgbaPixels down by 'levels' mip levels, in place.
+    static void DownsampleRGBA(AsyncImageDecodeJob*, uint32_t levels);
+
+    // Decodes a job's image and applies its downsampleLevel.
+    static void Decode(AsyncImageDecodeJob*);
+
+private:
+    void threadMain();
+
+    const size_t m_threadCount;
+    std::queue<AsyncImageDecodeJob> m_pendingJobs;
+    std::queue<AsyncImageDecodeJob> m_finishedJobs;
+    size_t m_jobsInFlight = 0;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_workAddedCondition;
+    std::condition_variable m_workFinishedCondition;
+    bool m_shouldQuit = false;
+    std::vector<std::thread> m_decoderThreads;
+};
+} // namespace rive::pls
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2024 Rive
+ */
+
+#include "async_triangulator.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace rive::pls
+{
+AsyncTriangulator::~AsyncTriangulator()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_shouldQuit = true;
+    }
+    m_workAddedCondition.notify_all();
+    for (std::thread& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+AsyncTriangulationJob* AsyncTriangulator::makeJob()
+{
+    // Only the render context's thread creates jobs, and the worker threads never touch m_jobs
+    // directly, so this doesn't need the lock. (std::deque doesn't move existing elements when it
+    // grows at the end.)
+    if (m_jobCount == m_jobs.size())
+    {
+        m_jobs.emplace_back();
+    }
+    AsyncTriangulationJob* job = &m_jobs[m_jobCount++];
+    job->path.rewind();
+    job->triangulator = nullptr;
+    return job;
+}
+
+void AsyncTriangulator::pushJob(AsyncTriangulationJob* job)
+{
+    {
+        std::lock_guard lock(m_mutex);
+        // Spin up another thread if every existing one is busy, up to m_threadCount.
+        if (m_idleThreadCount == 0 && m_threads.size() < m_threadCount)
+        {
+            m_allocators.push_back(
+                std::make_unique<TrivialBlockAllocator>(kAllocatorInitialBlockSize));
+            m_threads.emplace_back(&AsyncTriangulator::threadMain, this, m_threads.size());
+        }
+        job->state = AsyncTriangulationJob::State::pending;
+        m_pendingJobs.push_back(job);
+    }
+    m_workAddedCondition.notify_one();
+}
+
+void AsyncTriangulator::waitForJob(AsyncTriangulationJob* job)
+{
+    std::unique_lock lock(m_mutex);
+    if (job->state == AsyncTriangulationJob::State::pending)
+    {
+        // Nobody has gotten to this job yet. It's faster to run it here than to wait for a thread.
+        m_pendingJobs.erase(std::find(m_pendingJobs.begin(), m_pendingJobs.end(), job));
+        job->state = AsyncTriangulationJob::State::running;
+        lock.unlock();
+        Triangulate(job, &m_waitingThreadAllocator);
+        lock.lock();
+        job->state = AsyncTriangulationJob::State::finished;
+        return;
+    }
+    while (job->state != AsyncTriangulationJob::State::finished)
+    {
+        m_workFinishedCondition.wait(lock);
+    }
+}
+
+void AsyncTriangulator::reset()
+{
+    std::lock_guard lock(m_mutex);
+    assert(m_pendingJobs.empty());
+    for (size_t i = 0; i < m_jobCount; ++i)
+    {
+        assert(m_jobs[i].state == AsyncTriangulationJob::State::finished);
+        m_jobs[i].triangulator = nullptr;
+    }
+    m_jobCount = 0;
+    // Every job is finished, so no thread is using its allocator.
+    for (const auto& allocator : m_allocators)
+    {
+        allocator->reset();
+    }
+    m_waitingThreadAllocator.reset();
+}
+
+void AsyncTriangulator::Triangulate(AsyncTriangulationJob* job, TrivialBlockAllocator* allocator)
+{
+    job->triangulator = allocator->make<GrInnerFanTriangulator>(job->path,
+                                                                job->matrix,
+                                                                job->direction,
+                                                                job->fillRule,
+                                                                job->emitUnitWindingTriangles,
+                                                                allocator);
+}
+
+void AsyncTriangulator::threadMain(size_t threadIdx)
+{
+    std::unique_lock lock(m_mutex);
+    TrivialBlockAllocator* allocator = m_allocators[threadIdx].get();
+    for (;;)
+    {
+        ++m_idleThreadCount;
+        while (m_pendingJobs.empty() && !m_shouldQuit)
+        {
+            m_workAddedCondition.wait(lock);
+        }
+        --m_idleThreadCount;
+
+        if (m_shouldQuit)
+        {
+            return;
+        }
+
+        AsyncTriangulationJob* job = m_pendingJobs.front();
+        m_pendingJobs.pop_front();
+        job->state = AsyncTriangulationJob::State::running;
+
+        lock.unlock();
+        Triangulate(job, allocator);
+        lock.lock();
+
+        job->state = AsyncTriangulationJob::State::finished;
+        m_workFinishedCondition.notify_all();
+    }
+}
+} // namespace rive::pls
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2024 Rive
+ */
+
+#pragma once
+
+#include "gr_inner_fan_triangulator.hpp"
+#include "rive/math/mat2d.hpp"
+#include "rive/math/raw_path.hpp"
+#include "rive/pls/trivial_block_allocator.hpp"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rive::pls
+{
+// Defines a job to triangulate the (already linearized) interior of a large fill.
+struct AsyncTriangulationJob
+{
+    RawPath path;
+    Mat2D matrix;
+    GrTriangulator::Comparator::Direction direction;
+    FillRule fillRule;
+    bool emitUnitWindingTriangles;
+
+    // Valid once AsyncTriangulator::waitForJob() returns. Lives until AsyncTriangulator::reset().
+    GrInnerFanTriangulator* triangulator = nullptr;
+
+    enum class State
+    {
+        pending,
+        running,
+        finished,
+    };
+    State state = State::finished; // Guarded by AsyncTriangulator::m_mutex.
+};
+
+// Runs GrInnerFanTriangulator on a small pool of background threads, so InteriorTriangulationDraws
+// can begin triangulating the moment they're created, instead of blocking the recording thread.
+//
+// Jobs and their triangulators are owned by the AsyncTriangulator, and stay valid until reset().
+class AsyncTriangulator
+{
+public:
+    AsyncTriangulator(size_t threadCount) : m_threadCount(threadCount) {}
+    ~AsyncTriangulator();
+
+    // Returns a job for the caller to fill in and then pass to pushJob(). Only called from the
+    // thread that owns the render context.
+    AsyncTriangulationJob* makeJob();
+    void pushJob(AsyncTriangulationJob*);
+
+    // Blocks until the job has finished. If no thread has picked the job up yet, it runs on the
+    // calling thread instead.
+    void waitForJob(AsyncTriangulationJob*);
+
+    // Releases every job and triangulator from the frame. Every job must have been waited on.
+    void reset();
+
+private:
+    constexpr static size_t kAllocatorInitialBlockSize = 64 * 1024;
+
+    static void Triangulate(AsyncTriangulationJob*, TrivialBlockAllocator*);
+    void threadMain(size_t threadIdx);
+
+    const size_t m_threadCount;
+    std::deque<AsyncTriangulationJob> m_jobs; // Recycled from frame to frame.
+    size_t m_jobCount = 0;
+    std::deque<AsyncTriangulationJob*> m_pendingJobs;
+    size_t m_idleThreadCount = 0;
+    std::mutex m_mutex;
+    std::condition_variable m_workAddedCondition;
+    std::condition_variable m_workFinishedCondition;
+    bool m_shouldQuit = false;
+    std::vector<std::thread> m_threads;
+    // One allocator per thread, plus one for jobs that run on the waiting thread.
+    std::vector<std::unique_ptr<TrivialBlockAllocator>> m_allocators;
+    TrivialBlockAllocator m_waitingThreadAllocator{kAllocatorInitialBlockSize};
+};
+} // namespace rive::pls
@@ -0,0 +1,298 @@
+/*
+ * Copyright 2024 Rive
+ */
+
+#include "d3d_shaders.hpp"
+
+#include "shaders/constants.glsl"
+
+#include <D3DCompiler.h>
+#include <sstream>
+#include <vector>
+
+#include "generated/shaders/advanced_blend.glsl.hpp"
+#include "generated/shaders/atomic_draw.glsl.hpp"
+#include "generated/shaders/constants.glsl.hpp"
+#include "generated/shaders/common.glsl.hpp"
+#include "generated/shaders/draw_image_mesh.glsl.hpp"
+#include "generated/shaders/draw_path_common.glsl.hpp"
+#include "generated/shaders/draw_path.glsl.hpp"
+#include "generated/shaders/hlsl.glsl.hpp"
+
+namespace rive::pls::d3dutil
+{
+#ifdef RIVE_D3D_PRECOMPILED_SHADERS
+namespace
+{
+// These must stay in sync with generate_precompiled_shaders.py.
+constexpr static uint32_t kCapabilityROV = 1 << 0;
+constexpr static uint32_t kCapabilityTypedUAV = 1 << 1;
+
+struct PrecompiledDrawShader
+{
+    DrawType drawType;
+    ShaderFeatures shaderFeatures;
+    InterlockMode interlockMode;
+    ShaderMiscFlags miscFlags;
+    uint32_t capabilities;
+    const BYTE* bytecode;
+    size_t bytecodeSize;
+};
+
+#include "generated/shaders/d3d/precompiled_draw_shaders.h"
+
+// min16 precision is only a hint, so the (full precision) precompiled shaders ignore it.
+uint32_t precompiled_capabilities(const D3DCapabilities& d3dCapabilities)
+{
+    uint32_t capabilities = 0;
+    if (d3dCapabilities.supportsRasterizerOrderedViews)
+    {
+        capabilities |= kCapabilityROV;
+    }
+    if (d3dCapabilities.supportsTypedUAVLoadStore)
+    {
+        capabilities |= kCapabilityTypedUAV;
+    }
+    return capabilities;
+}
+
+template <size_t N>
+PrecompiledShaderBytecode find_precompiled_shader(const PrecompiledDrawShader (&table)[N],
+                                                  uint32_t shaderKey,
+                                                  uint32_t capabilities)
+{
+    // The ShaderUniqueKey accounts for features that don't apply to a given draw type, and for
+    // outerCurvePatches sharing its shaders with midpointFanPatches.
+    for (const PrecompiledDrawShader& entry : table)
+    {
+        if (entry.capabilities == capabilities &&
+            ShaderUniqueKey(entry.drawType,
+                            entry.shaderFeatures,
+                            entry.interlockMode,
+                            entry.miscFlags) == shaderKey)
+        {
+            return {entry.bytecode, entry.bytecodeSize};
+        }
+    }
+    return {nullptr, 0};
+}
+} // namespace
+#endif
+
+PrecompiledShaderBytecode FindPrecompiledDrawVertexShader(DrawType drawType,
+                                                          pls::ShaderFeatures shaderFeatures,
+                                                          pls::InterlockMode interlockMode,
+                                                          const D3DCapabilities& d3dCapabilities)
+{
+#ifdef RIVE_D3D_PRECOMPILED_SHADERS
+    return find_precompiled_shader(kPrecompiledDrawVertexShaders,
+                                   ShaderUniqueKey(drawType,
+                                                   shaderFeatures & kVertexShaderFeaturesMask,
+                                                   interlockMode,
+                                                   ShaderMiscFlags::none),
+                                   precompiled_capabilities(d3dCapabilities));
+#else
+    return {nullptr, 0};
+#endif
+}
+
+PrecompiledShaderBytecode FindPrecompiledDrawPixelShader(DrawType drawType,
+                                                         pls::ShaderFeatures shaderFeatures,
+                                                         pls::InterlockMode interlockMode,
+                                                         pls::ShaderMiscFlags pixelShaderMiscFlags,
+                                                         const D3DCapabilities& d3dCapabilities)
+{
+#ifdef RIVE_D3D_PRECOMPILED_SHADERS
+    return find_precompiled_shader(
+        kPrecompiledDrawPixelShaders,
+        ShaderUniqueKey(drawType, shaderFeatures, interlockMode, pixelShaderMiscFlags),
+        precompiled_capabilities(d3dCapabilities));
+#else
+    return {nullptr, 0};
+#endif
+}
+
+ComPtr<ID3DBlob> CompileSourceToBlob(PipelineBlobCache* pipelineBlobCache,
+                                     const char* shaderTypeDefineName,
+                                     const std::string& commonSource,
+                                     const char* entrypoint,
+                                     const char* target)
+{
+    std::ostringstream source;
+    source << "#define " << shaderTypeDefineName << '\n';
+    source << commonSource;
+
+    const std::string& sourceStr = source.str();
+    ComPtr<ID3DBlob> blob;
+
+    // DXBC is independent of the GPU and driver, so the bytecode only depends on the source, the
+    // entrypoint & target, and the compiler version.
+    std::string blobKey;
+    if (pipelineBlobCache != nullptr)
+    {
+        blobKey = PipelineBlobKeyHash()
+                      .write(sourceStr.c_str(), sourceStr.length())
+                      .write(entrypoint)
+                      .write(target)
+                      .write(D3D_COMPILER_VERSION)
+                      .key("rive_d3d_shader_");
+        std::vector<uint8_t> cachedBytecode;
+        if (pipelineBlobCache->loadBlob(blobKey, &cachedBytecode) && !cachedBytecode.empty() &&
+            SUCCEEDED(D3DCreateBlob(cachedBytecode.size(), blob.ReleaseAndGetAddressOf())))
+        {
+            memcpy(blob->GetBufferPointer(), cachedBytecode.data(), cachedBytecode.size());
+            return blob;
+        }
+    }
+
+    ComPtr<ID3DBlob> errors;
+    HRESULT hr = D3DCompile(sourceStr.c_str(),
+                            sourceStr.length(),
+                            nullptr,
+                            nullptr,
+                            nullptr,
+                            entrypoint,
+                            target,
+                            D3DCOMPILE_ENABLE_STRICTNESS,
+                            0,
+                            &blob,
+                            &errors);
+    if (errors && errors->GetBufferPointer())
+    {
+        fprintf(stderr, "Errors or warnings compiling shader.\n");
+        int l = 1;
+        std::stringstream stream(sourceStr);
+        std::string lineStr;
+        while (std::getline(stream, lineStr, '\n'))
+        {
+            fprintf(stderr, "%4i| %s\n", l++, lineStr.c_str());
+        }
+        fprintf(stderr, "%s\n", reinterpret_cast<char*>(errors->GetBufferPointer()));
+        exit(-1);
+    }
+    if (FAILED(hr))
+    {
+        fprintf(stderr, "Failed to compile shader.\n");
+        exit(-1);
+    }
+    if (pipelineBlobCache != nullptr)
+    {
+        pipelineBlobCache->storeBlob(blobKey, blob->GetBufferPointer(), blob->GetBufferSize());
+    }
+    return blob;
+}
+
+std::string BuildDrawShaderSource(DrawType drawType,
+                                  pls::ShaderFeatures shaderFeatures,
+                                  pls::InterlockMode interlockMode,
+                                  pls::ShaderMiscFlags pixelShaderMiscFlags,
+                                  const D3DCapabilities& d3dCapabilities)
+{
+    std::ostringstream s;
+    for (size_t i = 0; i < kShaderFeatureCount; ++i)
+    {
+        ShaderFeatures feature = static_cast<ShaderFeatures>(1 << i);
+        if (shaderFeatures & feature)
+        {
+            s << "#define " << GetShaderFeatureGLSLName(feature) << " 1\n";
+        }
+    }
+    if (d3dCapabilities.supportsRasterizerOrderedViews)
+    {
+        if ((interlockMode == pls::InterlockMode::rasterOrdering &&
+             drawType != DrawType::interiorTriangulation) ||
+            drawType == DrawType::imageMesh)
+        {
+            s << "#define " << GLSL_ENABLE_RASTERIZER_ORDERED_VIEWS << '\n';
+        }
+    }
+    if (d3dCapabilities.supportsTypedUAVLoadStore)
+    {
+        s << "#define " << GLSL_ENABLE_TYPED_UAV_LOAD_STORE << '\n';
+    }
+    if (d3dCapabilities.supportsMin16Precision)
+    {
+        s << "#define " << GLSL_ENABLE_MIN_16_PRECISION << '\n';
+    }
+    if (interlockMode == pls::InterlockMode::atomics &&
+        !(shaderFeatures & ShaderFeatures::ENABLE_ADVANCED_BLEND))
+    {
+        s << "#define " << GLSL_FIXED_FUNCTION_COLOR_BLEND << '\n';
+    }
+    if (pixelShaderMiscFlags & pls::ShaderMiscFlags::coalescedResolveAndTransfer)
+    {
+        s << "#define " << GLSL_COALESCED_PLS_RESOLVE_AND_TRANSFER << '\n';
+        s << "#define " << GLSL_COLOR_PLANE_IDX_OVERRIDE << ' '
+          << COALESCED_OFFSCREEN_COLOR_PLANE_IDX << '\n';
+    }
+    switch (drawType)
+    {
+        case DrawType::midpointFanPatches:
+        case DrawType::outerCurvePatches:
+            s << "#define " << GLSL_DRAW_PATH << '\n';
+            break;
+        case DrawType::interiorTriangulation:
+            s << "#define " << GLSL_DRAW_INTERIOR_TRIANGLES << '\n';
+            break;
+        case DrawType::imageRect:
+            assert(interlockMode == pls::InterlockMode::atomics);
+            s << "#define " << GLSL_DRAW_IMAGE << '\n';
+            s << "#define " << GLSL_DRAW_IMAGE_RECT << '\n';
+            break;
+        case DrawType::imageMesh:
+            s << "#define " << GLSL_DRAW_IMAGE << '\n';
+            s << "#define " << GLSL_DRAW_IMAGE_MESH << '\n';
+            break;
+        case DrawType::plsAtomicResolve:
+            assert(interlockMode == pls::InterlockMode::atomics);
+            s << "#define " << GLSL_DRAW_RENDER_TARGET_UPDATE_BOUNDS << '\n';
+            s << "#define " << GLSL_RESOLVE_PLS << '\n';
+            break;
+        case DrawType::plsAtomicInitialize:
+        case DrawType::stencilClipReset:
+            RIVE_UNREACHABLE();
+    }
+    s << glsl::constants << '\n';
+    s << glsl::hlsl << '\n';
+    s << glsl::common << '\n';
+    if (shaderFeatures & ShaderFeatures::ENABLE_ADVANCED_BLEND)
+    {
+        s << glsl::advanced_blend << '\n';
+    }
+    switch (drawType)
+    {
+        case DrawType::midpointFanPatches:
+        case DrawType::outerCurvePatches:
+            s << pls::glsl::draw_path_common << '\n';
+            s << (interlockMode == pls::InterlockMode::rasterOrdering ? pls::glsl::draw_path
+                                                                      : pls::glsl::atomic_draw)
+              << '\n';
+            break;
+        case DrawType::interiorTriangulation:
+            s << pls::glsl::draw_path_common << '\n';
+            s << (interlockMode == pls::InterlockMode::rasterOrdering ? pls::glsl::draw_path
+                                                                      : pls::glsl::atomic_draw)
+              << '\n';
+            break;
+        case DrawType::imageRect:
+            assert(interlockMode == pls::InterlockMode::atomics);
+            s << pls::glsl::atomic_draw << '\n';
+            break;
+        case DrawType::imageMesh:
+            s << (interlockMode == pls::InterlockMode::rasterOrdering
+                      ? pls::glsl::draw_image_mesh
+                      : pls::glsl::atomic_draw)
+              << '\n';
+            break;
+        case DrawType::plsAtomicResolve:
+        case DrawType::stencilClipReset:
+            assert(interlockMode == pls::InterlockMode::atomics);
+            s << pls::glsl::atomic_draw << '\n';
+            break;
+        case DrawType::plsAtomicInitialize:
+            RIVE_UNREACHABLE();
+    }
+
+    return s.str();
+}
+} // namespace rive::pls::d3dutil
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2024 Rive
+ */
+
+#pragma once
+
+#include "rive/pls/d3d/d3d.hpp"
+#include "rive/pls/pipeline_blob_cache.hpp"
+#include "rive/pls/pls.hpp"
+#include <d3dcommon.h>
+#include <string>
+
+// D3D doesn't let us bind the framebuffer UAV to slot 0 when there is a color output. Use the
+// (unused in this case) SCRATCH_COLOR_PLANE_IDX instead when we are doing a coalesced resolve
+// and transfer.
+#define COALESCED_OFFSCREEN_COLOR_PLANE_IDX SCRATCH_COLOR_PLANE_IDX
+
+// HLSL compilation shared by the D3D11 and D3D12 backends.
+namespace rive::pls::d3dutil
+{
+// Prepends "#define <shaderTypeDefineName>" to commonSource and compiles it. If pipelineBlobCache
+// is non-null, the bytecode is loaded from it when possible, and stored in it otherwise.
+ComPtr<ID3DBlob> CompileSourceToBlob(PipelineBlobCache*,
+                                     const char* shaderTypeDefineName,
+                                     const std::string& commonSource,
+                                     const char* entrypoint,
+                                     const char* target);
+
+// Returns the HLSL source (minus the GLSL_VERTEX/GLSL_FRAGMENT define) for the draw shaders of the
+// given configuration.
+std::string BuildDrawShaderSource(DrawType,
+                                  pls::ShaderFeatures,
+                                  pls::InterlockMode,
+                                  pls::ShaderMiscFlags pixelShaderMiscFlags,
+                                  const D3DCapabilities&);
+
+// vs_5_0/ps_5_0 bytecode that was compiled offline by generate_precompiled_shaders.py.
+struct PrecompiledShaderBytecode
+{
+    const void* data;
+    size_t size;
+};
+
+// Returns the offline-compiled bytecode for the given draw shader configuration, or {nullptr, 0}
+// if it wasn't precompiled (or if the build doesn't define RIVE_D3D_PRECOMPILED_SHADERS).
+PrecompiledShaderBytecode FindPrecompiledDrawVertexShader(DrawType,
+                                                          pls::ShaderFeatures,
+                                                          pls::InterlockMode,
+                                                          const D3DCapabilities&);
+PrecompiledShaderBytecode FindPrecompiledDrawPixelShader(DrawType,
+                                                         pls::ShaderFeatures,
+                                                         pls::InterlockMode,
+                                                         pls::ShaderMiscFlags pixelShaderMiscFlags,
+                                                         const D3DCapabilities&);
+} // namespace rive::pls::d3dutil
@@ -0,0 +1,2462 @@
+/*
+ * Copyright 2024 Rive
+ */
+
+#include "rive/pls/d3d/pls_render_context_d3d12_impl.hpp"
+
+#include "d3d_shaders.hpp"
+#include "rive/pls/pls_image.hpp"
+#include "shaders/constants.glsl"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include "generated/shaders/color_ramp.glsl.hpp"
+#include "generated/shaders/constants.glsl.hpp"
+#include "generated/shaders/common.glsl.hpp"
+#include "generated/shaders/hlsl.glsl.hpp"
+#include "generated/shaders/tessellate.glsl.hpp"
+
+constexpr static UINT kPatchVertexDataSlot = 0;
+constexpr static UINT kTriangleVertexDataSlot = 1;
+constexpr static UINT kImageRectVertexDataSlot = 2;
+constexpr static UINT kImageMeshVertexDataSlot = 3;
+constexpr static UINT kImageMeshUVDataSlot = 4;
+
+// Every pipeline in the context shares a single root signature, laid out to match the registers
+// that hlsl.glsl assigns.
+constexpr static UINT kFlushUniformsRootParam = 0;     // CBV (b FLUSH_UNIFORM_BUFFER_IDX).
+constexpr static UINT kDrawUniformsRootParam = 1;      // Constants (b PATH_BASE_INSTANCE_...).
+constexpr static UINT kImageDrawUniformsRootParam = 2; // CBV (b IMAGE_DRAW_UNIFORM_BUFFER_IDX).
+constexpr static UINT kPathBufferRootParam = 3;        // SRV (t PATH_BUFFER_IDX).
+constexpr static UINT kPaintBufferRootParam = 4;       // SRV (t PAINT_BUFFER_IDX).
+constexpr static UINT kPaintAuxBufferRootParam = 5;    // SRV (t PAINT_AUX_BUFFER_IDX).
+constexpr static UINT kContourBufferRootParam = 6;     // SRV (t CONTOUR_BUFFER_IDX).
+constexpr static UINT kResourceTexturesRootParam = 7;  // Table: tess & grad textures.
+constexpr static UINT kImageTextureRootParam = 8;      // Table: image texture.
+constexpr static UINT kPLSPlanesRootParam = 9;         // Table: PLS plane UAVs.
+constexpr static UINT kRootParamCount = 10;
+constexpr static UINT kPLSPlaneCount = 4;
+
+// Layout of the descriptors that every flush allocates up front. Image texture SRVs follow.
+constexpr static UINT kTessTextureDescriptorIdx = 0;
+constexpr static UINT kGradTextureDescriptorIdx = 1;
+constexpr static UINT kNullImageTextureDescriptorIdx = 2;
+constexpr static UINT kPLSPlaneDescriptorsIdx = 3;
+constexpr static UINT kResolvePLSPlaneDescriptorsIdx = kPLSPlaneDescriptorsIdx + kPLSPlaneCount;
+constexpr static UINT kFlushDescriptorCount = kResolvePLSPlaneDescriptorsIdx + kPLSPlaneCount;
+
+// Indices in m_resourceTextureRTVHeap.
+constexpr static UINT kGradTextureRTVIdx = 0;
+constexpr static UINT kTessTextureRTVIdx = 1;
+
+constexpr static UINT kInitialDescriptorHeapCapacity = 256;
+constexpr static size_t kInitialUploadArenaSizeInBytes = 256 * 1024;
+
+// Don't split draw passes with fewer batches than this per thread; the cost of binding state to
+// another command list would outweigh the benefit.
+constexpr static size_t kMinBatchesPerParallelChunk = 64;
+
+namespace rive::pls
+{
+static D3D12_HEAP_PROPERTIES heap_properties(D3D12_HEAP_TYPE type)
+{
+    D3D12_HEAP_PROPERTIES heapProperties{};
+    heapProperties.Type = type;
+    heapProperties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+    heapProperties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+    heapProperties.CreationNodeMask = 1;
+    heapProperties.VisibleNodeMask = 1;
+    return heapProperties;
+}
+
+static ComPtr<ID3D12Resource> make_buffer(ID3D12Device* gpu,
+                                          D3D12_HEAP_TYPE heapType,
+                                          size_t sizeInBytes,
+                                          D3D12_RESOURCE_STATES initialState)
+{
+    D3D12_HEAP_PROPERTIES heapProperties = heap_properties(heapType);
+    D3D12_RESOURCE_DESC desc{};
+    desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+    desc.Width = std::max<size_t>(sizeInBytes, 1);
+    desc.Height = 1;
+    desc.DepthOrArraySize = 1;
+    desc.MipLevels = 1;
+    desc.Format = DXGI_FORMAT_UNKNOWN;
+    desc.SampleDesc.Count = 1;
+    desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+    ComPtr<ID3D12Resource> buffer;
+    VERIFY_OK(gpu->CreateCommittedResource(&heapProperties,
+                                           D3D12_HEAP_FLAG_NONE,
+                                           &desc,
+                                           initialState,
+                                           nullptr,
+                                           IID_PPV_ARGS(buffer.ReleaseAndGetAddressOf())));
+    return buffer;
+}
+
+static ComPtr<ID3D12Resource> make_simple_2d_texture(ID3D12Device* gpu,
+                                                     DXGI_FORMAT format,
+                                                     UINT width,
+                                                     UINT height,
+                                                     UINT mipLevelCount,
+                                                     D3D12_RESOURCE_FLAGS flags,
+                                                     D3D12_RESOURCE_STATES initialState)
+{
+    D3D12_HEAP_PROPERTIES heapProperties = heap_properties(D3D12_HEAP_TYPE_DEFAULT);
+    D3D12_RESOURCE_DESC desc{};
+    desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    desc.Width = width;
+    desc.Height = height;
+    desc.DepthOrArraySize = 1;
+    desc.MipLevels = mipLevelCount;
+    desc.Format = format;
+    desc.SampleDesc.Count = 1;
+    desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+    desc.Flags = flags;
+
+    ComPtr<ID3D12Resource> tex;
+    VERIFY_OK(gpu->CreateCommittedResource(&heapProperties,
+                                           D3D12_HEAP_FLAG_NONE,
+                                           &desc,
+                                           initialState,
+                                           nullptr,
+                                           IID_PPV_ARGS(tex.ReleaseAndGetAddressOf())));
+    return tex;
+}
+
+static void make_simple_2d_uav(ID3D12Device* gpu,
+                               ID3D12Resource* tex,
+                               DXGI_FORMAT format,
+                               D3D12_CPU_DESCRIPTOR_HANDLE handle)
+{
+    D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc{};
+    uavDesc.Format = format;
+    uavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
+    gpu->CreateUnorderedAccessView(tex, nullptr, &uavDesc, handle);
+}
+
+static ComPtr<ID3D12DescriptorHeap> make_descriptor_heap(ID3D12Device* gpu,
+                                                         D3D12_DESCRIPTOR_HEAP_TYPE type,
+                                                         UINT count,
+                                                         D3D12_DESCRIPTOR_HEAP_FLAGS flags)
+{
+    D3D12_DESCRIPTOR_HEAP_DESC desc{};
+    desc.Type = type;
+    desc.NumDescriptors = count;
+    desc.Flags = flags;
+
+    ComPtr<ID3D12DescriptorHeap> heap;
+    VERIFY_OK(gpu->CreateDescriptorHeap(&desc, IID_PPV_ARGS(heap.ReleaseAndGetAddressOf())));
+    return heap;
+}
+
+static D3D12_CPU_DESCRIPTOR_HANDLE offset_handle(D3D12_CPU_DESCRIPTOR_HANDLE handle,
+                                                 UINT idx,
+                                                 UINT descriptorSize)
+{
+    handle.ptr += static_cast<SIZE_T>(idx) * descriptorSize;
+    return handle;
+}
+
+static D3D12_GPU_DESCRIPTOR_HANDLE offset_handle(D3D12_GPU_DESCRIPTOR_HANDLE handle,
+                                                 UINT idx,
+                                                 UINT descriptorSize)
+{
+    handle.ptr += static_cast<UINT64>(idx) * descriptorSize;
+    return handle;
+}
+
+static void transition_resource(ID3D12GraphicsCommandList* cmdList,
+                                ID3D12Resource* resource,
+                                D3D12_RESOURCE_STATES* currentState,
+                                D3D12_RESOURCE_STATES newState)
+{
+    if (*currentState == newState)
+    {
+        return;
+    }
+    D3D12_RESOURCE_BARRIER barrier{};
+    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barrier.Transition.pResource = resource;
+    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    barrier.Transition.StateBefore = *currentState;
+    barrier.Transition.StateAfter = newState;
+    cmdList->ResourceBarrier(1, &barrier);
+    *currentState = newState;
+}
+
+// Orders every UAV access before the barrier with every UAV access after it. (D3D11 did this
+// implicitly between draws; D3D12 leaves it to us.)
+static void uav_barrier(ID3D12GraphicsCommandList* cmdList)
+{
+    D3D12_RESOURCE_BARRIER barrier{};
+    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+    barrier.UAV.pResource = nullptr;
+    cmdList->ResourceBarrier(1, &barrier);
+}
+
+static void copy_sub_rect(ID3D12GraphicsCommandList* cmdList,
+                          ID3D12Resource* dst,
+                          ID3D12Resource* src,
+                          const IAABB& rect)
+{
+    D3D12_TEXTURE_COPY_LOCATION dstLocation{};
+    dstLocation.pResource = dst;
+    dstLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    dstLocation.SubresourceIndex = 0;
+
+    D3D12_TEXTURE_COPY_LOCATION srcLocation{};
+    srcLocation.pResource = src;
+    srcLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    srcLocation.SubresourceIndex = 0;
+
+    D3D12_BOX box = {
+        static_cast<UINT>(rect.left),
+        static_cast<UINT>(rect.top),
+        0,
+        static_cast<UINT>(rect.right),
+        static_cast<UINT>(rect.bottom),
+        1,
+    };
+    cmdList->CopyTextureRegion(&dstLocation, box.left, box.top, 0, &srcLocation, &box);
+}
+
+void D3D12FrameFence::wait()
+{
+    if (m_fence->GetCompletedValue() < m_value)
+    {
+        // With a null event, SetEventOnCompletion() blocks until the fence reaches the value.
+        VERIFY_OK(m_fence->SetEventOnCompletion(m_value, nullptr));
+    }
+}
+
+// Command allocator for each buffer ring slot, plus the command lists allocated from them. A slot's
+// allocator is only reset once the frame that last used it has finished.
+class PLSRenderContextD3D12Impl::CommandListPool
+{
+public:
+    CommandListPool(ID3D12Device* gpu, int bufferRingSize) :
+        m_gpu(gpu), m_bufferRingSize(bufferRingSize)
+    {
+        for (int i = 0; i < m_bufferRingSize; ++i)
+        {
+            VERIFY_OK(m_gpu->CreateCommandAllocator(
+                D3D12_COMMAND_LIST_TYPE_DIRECT,
+                IID_PPV_ARGS(m_allocators[i].ReleaseAndGetAddressOf())));
+        }
+    }
+
+    // The frame that last used the slot must have finished.
+    void reset(int bufferRingIdx)
+    {
+        VERIFY_OK(m_allocators[bufferRingIdx]->Reset());
+        m_nextCommandListIdx[bufferRingIdx] = 0;
+    }
+
+    // Returns a command list, open for recording, whose commands are allocated from the given
+    // slot. Command lists can be reset as soon as they've been submitted, so lists from every slot
+    // share one pool.
+    ID3D12GraphicsCommandList* beginCommandList(int bufferRingIdx)
+    {
+        ID3D12CommandAllocator* allocator = m_allocators[bufferRingIdx].Get();
+        size_t& nextIdx = m_nextCommandListIdx[bufferRingIdx];
+        std::vector<ComPtr<ID3D12GraphicsCommandList>>& commandLists =
+            m_commandLists[bufferRingIdx];
+        if (nextIdx == commandLists.size())
+        {
+            VERIFY_OK(m_gpu->CreateCommandList(
+                0,
+                D3D12_COMMAND_LIST_TYPE_DIRECT,
+                allocator,
+                nullptr,
+                IID_PPV_ARGS(commandLists.emplace_back().ReleaseAndGetAddressOf())));
+            return commandLists[nextIdx++].Get();
+        }
+        ID3D12GraphicsCommandList* commandList = commandLists[nextIdx++].Get();
+        VERIFY_OK(commandList->Reset(allocator, nullptr));
+        return commandList;
+    }
+
+private:
+    ID3D12Device* const m_gpu;
+    const int m_bufferRingSize;
+    ComPtr<ID3D12CommandAllocator> m_allocators[pls::kMaxBufferRingSize];
+    // Command lists stay tied to the slot they were last recorded for, so a list is never reset
+    // while the GPU might still be executing it.
+    std::vector<ComPtr<ID3D12GraphicsCommandList>> m_commandLists[pls::kMaxBufferRingSize];
+    size_t m_nextCommandListIdx[pls::kMaxBufferRingSize] = {};
+};
+
+// Records chunks of a draw pass into separate command lists, on a small pool of worker threads.
+// The calling thread records chunk 0 (and every workerCount()'th chunk after that) itself.
+//
+// Each worker owns a CommandListPool, since command allocators can only be used by one thread at a
+// time.
+class PLSRenderContextD3D12Impl::ParallelCommandRecorder
+{
+public:
+    ParallelCommandRecorder(ID3D12Device* gpu, int bufferRingSize, uint32_t threadCount)
+    {
+        m_workers.reserve(threadCount + 1);
+        for (uint32_t i = 0; i <= threadCount; ++i)
+        {
+            m_workers.push_back(std::make_unique<CommandListPool>(gpu, bufferRingSize));
+        }
+        for (uint32_t i = 1; i <= threadCount; ++i)
+        {
+            m_threads.emplace_back(&ParallelCommandRecorder::threadMain, this, i);
+        }
+    }
+
+    ~ParallelCommandRecorder()
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_shouldQuit = true;
+        }
+        m_workAddedCondition.notify_all();
+        for (std::thread& thread : m_threads)
+        {
+            thread.join();
+        }
+    }
+
+    size_t workerCount() const { return m_workers.size(); }
+
+    // The frame that last used the slot must have finished.
+    void reset(int bufferRingIdx)
+    {
+        for (auto& worker : m_workers)
+        {
+            worker->reset(bufferRingIdx);
+        }
+    }
+
+    // Records 'chunkCount' command lists, in parallel, calling recordChunk() for each, and appends
+    // them (closed) to 'commandLists' in chunk order. Blocks until every chunk has been recorded.
+    void record(int bufferRingIdx,
+                size_t chunkCount,
+                const std::function<void(ID3D12GraphicsCommandList*, size_t chunkIdx)>& recordChunk,
+                std::vector<ID3D12CommandList*>* commandLists)
+    {
+        size_t firstChunkIdx = commandLists->size();
+        commandLists->resize(firstChunkIdx + chunkCount);
+        {
+            std::lock_guard lock(m_mutex);
+            m_job = {
+                .bufferRingIdx = bufferRingIdx,
+                .chunkCount = chunkCount,
+                .recordChunk = &recordChunk,
+                .commandLists = commandLists->data() + firstChunkIdx,
+            };
+            ++m_jobID;
+            m_busyThreadCount = m_threads.size();
+        }
+        m_workAddedCondition.notify_all();
+
+        recordChunks(0);
+
+        std::unique_lock lock(m_mutex);
+        while (m_busyThreadCount != 0)
+        {
+            m_workFinishedCondition.wait(lock);
+        }
+    }
+
+private:
+    struct Job
+    {
+        int bufferRingIdx;
+        size_t chunkCount;
+        const std::function<void(ID3D12GraphicsCommandList*, size_t)>* recordChunk;
+        ID3D12CommandList** commandLists;
+    };
+
+    // Records this worker's share of the current job's chunks. m_job doesn't change until every
+    // worker has finished, so it's safe to read without the lock.
+    void recordChunks(size_t workerIdx)
+    {
+        CommandListPool* pool = m_workers[workerIdx].get();
+        for (size_t chunkIdx = workerIdx; chunkIdx < m_job.chunkCount;
+             chunkIdx += m_workers.size())
+        {
+            ID3D12GraphicsCommandList* commandList = pool->beginCommandList(m_job.bufferRingIdx);
+            (*m_job.recordChunk)(commandList, chunkIdx);
+            VERIFY_OK(commandList->Close());
+            m_job.commandLists[chunkIdx] = commandList;
+        }
+    }
+
+    void threadMain(size_t workerIdx)
+    {
+        uint64_t lastJobID = 0;
+        std::unique_lock lock(m_mutex);
+        for (;;)
+        {
+            while (m_jobID == lastJobID && !m_shouldQuit)
+            {
+                m_workAddedCondition.wait(lock);
+            }
+            if (m_shouldQuit)
+            {
+                return;
+            }
+            lastJobID = m_jobID;
+
+            lock.unlock();
+            recordChunks(workerIdx);
+            lock.lock();
+
+            if (--m_busyThreadCount == 0)
+            {
+                m_workFinishedCondition.notify_one();
+            }
+        }
+    }
+
+    // m_workers[0] belongs to the calling thread.
+    std::vector<std::unique_ptr<CommandListPool>> m_workers;
+    std::vector<std::thread> m_threads;
+    Job m_job = {};
+    uint64_t m_jobID = 0;
+    size_t m_busyThreadCount = 0;
+    std::mutex m_mutex;
+    std::condition_variable m_workAddedCondition;
+    std::condition_variable m_workFinishedCondition;
+    bool m_shouldQuit = false;
+};
+
+std::unique_ptr<PLSRenderContext> PLSRenderContextD3D12Impl::MakeContext(
+    ComPtr<ID3D12Device> gpu,
+    ComPtr<ID3D12CommandQueue> queue,
+    const ContextOptions& contextOptions)
+{
+    D3DCapabilities d3dCapabilities;
+    D3D12_FEATURE_DATA_D3D12_OPTIONS d3d12Options{};
+    if (SUCCEEDED(gpu->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS,
+                                           &d3d12Options,
+                                           sizeof(d3d12Options))))
+    {
+        d3dCapabilities.supportsRasterizerOrderedViews = d3d12Options.ROVsSupported;
+        if (d3d12Options.TypedUAVLoadAdditionalFormats)
+        {
+            // TypedUAVLoadAdditionalFormats is true. Now check if we can both load and store all
+            // formats used by Rive (currently only RGBA8).
+            D3D12_FEATURE_DATA_FORMAT_SUPPORT d3d12Format{};
+            d3d12Format.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+            if (SUCCEEDED(gpu->CheckFeatureSupport(D3D12_FEATURE_FORMAT_SUPPORT,
+                                                   &d3d12Format,
+                                                   sizeof(d3d12Format))))
+            {
+                constexpr UINT loadStoreFlags =
+                    D3D12_FORMAT_SUPPORT2_UAV_TYPED_LOAD | D3D12_FORMAT_SUPPORT2_UAV_TYPED_STORE;
+                d3dCapabilities.supportsTypedUAVLoadStore =
+                    (d3d12Format.Support2 & loadStoreFlags) == loadStoreFlags;
+            }
+        }
+        d3dCapabilities.supportsMin16Precision =
+            (d3d12Options.MinPrecisionSupport & D3D12_SHADER_MIN_PRECISION_SUPPORT_16_BIT) != 0;
+    }
+
+    if (contextOptions.disableRasterizerOrderedViews)
+    {
+        d3dCapabilities.supportsRasterizerOrderedViews = false;
+    }
+    if (contextOptions.disableTypedUAVLoadStore)
+    {
+        d3dCapabilities.supportsTypedUAVLoadStore = false;
+    }
+
+    auto plsContextImpl = std::unique_ptr<PLSRenderContextD3D12Impl>(
+        new PLSRenderContextD3D12Impl(std::move(gpu),
+                                      std::move(queue),
+                                      d3dCapabilities,
+                                      contextOptions));
+    return std::make_unique<PLSRenderContext>(std::move(plsContextImpl));
+}
+
+PLSRenderContextD3D12Impl::PLSRenderContextD3D12Impl(ComPtr<ID3D12Device> gpu,
+                                                     ComPtr<ID3D12CommandQueue> queue,
+                                                     const D3DCapabilities& d3dCapabilities,
+                                                     const ContextOptions& contextOptions) :
+    m_d3dCapabilities(d3dCapabilities),
+    m_contextOptions(contextOptions),
+    m_gpu(std::move(gpu)),
+    m_queue(std::move(queue))
+{
+    setBufferRingSize(contextOptions.bufferRingSize);
+
+    m_platformFeatures.invertOffscreenY = true;
+    m_platformFeatures.supportsRasterOrdering = d3dCapabilities.supportsRasterizerOrderedViews;
+    m_platformFeatures.supportsWideContourIDs = true;
+    m_platformFeatures.maxTextureSize = D3D12_REQ_TEXTURE2D_U_OR_V_DIMENSION;
+
+    m_cbvSrvUavDescriptorSize =
+        m_gpu->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    m_rtvDescriptorSize = m_gpu->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+
+    // Create the root signature.
+    {
+        D3D12_DESCRIPTOR_RANGE resourceTexturesRange{};
+        resourceTexturesRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+        resourceTexturesRange.NumDescriptors = 2;
+        resourceTexturesRange.BaseShaderRegister = TESS_VERTEX_TEXTURE_IDX;
+        resourceTexturesRange.OffsetInDescriptorsFromTableStart = 0;
+        static_assert(GRAD_TEXTURE_IDX == TESS_VERTEX_TEXTURE_IDX + 1);
+        static_assert(kGradTextureDescriptorIdx == kTessTextureDescriptorIdx + 1);
+
+        D3D12_DESCRIPTOR_RANGE imageTextureRange{};
+        imageTextureRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+        imageTextureRange.NumDescriptors = 1;
+        imageTextureRange.BaseShaderRegister = IMAGE_TEXTURE_IDX;
+        imageTextureRange.OffsetInDescriptorsFromTableStart = 0;
+
+        D3D12_DESCRIPTOR_RANGE plsPlanesRange{};
+        plsPlanesRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
+        plsPlanesRange.NumDescriptors = kPLSPlaneCount;
+        plsPlanesRange.BaseShaderRegister = COLOR_PLANE_IDX;
+        plsPlanesRange.OffsetInDescriptorsFromTableStart = 0;
+        static_assert(COLOR_PLANE_IDX == 0);
+        static_assert(SCRATCH_COLOR_PLANE_IDX == kPLSPlaneCount - 1);
+
+        D3D12_ROOT_PARAMETER params[kRootParamCount]{};
+        auto setRootDescriptor = [&params](UINT paramIdx,
+                                           D3D12_ROOT_PARAMETER_TYPE type,
+                                           UINT shaderRegister) {
+            params[paramIdx].ParameterType = type;
+            params[paramIdx].Descriptor.ShaderRegister = shaderRegister;
+            params[paramIdx].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+        };
+        auto setDescriptorTable = [&params](UINT paramIdx,
+                                            const D3D12_DESCRIPTOR_RANGE* range,
+                                            D3D12_SHADER_VISIBILITY visibility) {
+            params[paramIdx].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+            params[paramIdx].DescriptorTable.NumDescriptorRanges = 1;
+            params[paramIdx].DescriptorTable.pDescriptorRanges = range;
+            params[paramIdx].ShaderVisibility = visibility;
+        };
+        setRootDescriptor(kFlushUniformsRootParam,
+                          D3D12_ROOT_PARAMETER_TYPE_CBV,
+                          FLUSH_UNIFORM_BUFFER_IDX);
+        params[kDrawUniformsRootParam].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+        params[kDrawUniformsRootParam].Constants.ShaderRegister =
+            PATH_BASE_INSTANCE_UNIFORM_BUFFER_IDX;
+        params[kDrawUniformsRootParam].Constants.Num32BitValues = 4; // baseInstance + padding.
+        params[kDrawUniformsRootParam].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
+        setRootDescriptor(kImageDrawUniformsRootParam,
+                          D3D12_ROOT_PARAMETER_TYPE_CBV,
+                          IMAGE_DRAW_UNIFORM_BUFFER_IDX);
+        setRootDescriptor(kPathBufferRootParam, D3D12_ROOT_PARAMETER_TYPE_SRV, PATH_BUFFER_IDX);
+        setRootDescriptor(kPaintBufferRootParam, D3D12_ROOT_PARAMETER_TYPE_SRV, PAINT_BUFFER_IDX);
+        setRootDescriptor(kPaintAuxBufferRootParam,
+                          D3D12_ROOT_PARAMETER_TYPE_SRV,
+                          PAINT_AUX_BUFFER_IDX);
+        setRootDescriptor(kContourBufferRootParam,
+                          D3D12_ROOT_PARAMETER_TYPE_SRV,
+                          CONTOUR_BUFFER_IDX);
+        setDescriptorTable(kResourceTexturesRootParam,
+                           &resourceTexturesRange,
+                           D3D12_SHADER_VISIBILITY_ALL);
+        setDescriptorTable(kImageTextureRootParam,
+                           &imageTextureRange,
+                           D3D12_SHADER_VISIBILITY_PIXEL);
+        setDescriptorTable(kPLSPlanesRootParam, &plsPlanesRange, D3D12_SHADER_VISIBILITY_PIXEL);
+
+        // A linear sampler for the gradient texture, and a mipmap sampler for image textures.
+        D3D12_STATIC_SAMPLER_DESC samplers[2]{};
+        for (D3D12_STATIC_SAMPLER_DESC& sampler : samplers)
+        {
+            sampler.AddressU = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+            sampler.AddressV = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+            sampler.AddressW = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+            sampler.MipLODBias = 0;
+            sampler.MaxAnisotropy = 1;
+            sampler.ComparisonFunc = D3D12_COMPARISON_FUNC_NEVER;
+            sampler.MinLOD = 0;
+            sampler.ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+        }
+        samplers[0].Filter = D3D12_FILTER_MIN_MAG_LINEAR_MIP_POINT;
+        samplers[0].MaxLOD = 0;
+        samplers[0].ShaderRegister = GRAD_TEXTURE_IDX;
+        samplers[1].Filter = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
+        samplers[1].MaxLOD = D3D12_FLOAT32_MAX;
+        samplers[1].ShaderRegister = IMAGE_TEXTURE_IDX;
+
+        D3D12_ROOT_SIGNATURE_DESC rootSignatureDesc{};
+        rootSignatureDesc.NumParameters = kRootParamCount;
+        rootSignatureDesc.pParameters = params;
+        rootSignatureDesc.NumStaticSamplers = std::size(samplers);
+        rootSignatureDesc.pStaticSamplers = samplers;
+        rootSignatureDesc.Flags = D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT;
+
+        ComPtr<ID3DBlob> signatureBlob;
+        ComPtr<ID3DBlob> errors;
+        VERIFY_OK(D3D12SerializeRootSignature(&rootSignatureDesc,
+                                              D3D_ROOT_SIGNATURE_VERSION_1,
+                                              &signatureBlob,
+                                              &errors));
+        VERIFY_OK(m_gpu->CreateRootSignature(
+            0,
+            signatureBlob->GetBufferPointer(),
+            signatureBlob->GetBufferSize(),
+            IID_PPV_ARGS(m_rootSignature.ReleaseAndGetAddressOf())));
+    }
+
+    m_resourceTextureRTVHeap = make_descriptor_heap(m_gpu.Get(),
+                                                    D3D12_DESCRIPTOR_HEAP_TYPE_RTV,
+                                                    2,
+                                                    D3D12_DESCRIPTOR_HEAP_FLAG_NONE);
+
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC resourcePipelineDesc{};
+    resourcePipelineDesc.pRootSignature = m_rootSignature.Get();
+    resourcePipelineDesc.BlendState.RenderTarget[0].RenderTargetWriteMask =
+        D3D12_COLOR_WRITE_ENABLE_ALL;
+    resourcePipelineDesc.SampleMask = UINT_MAX;
+    resourcePipelineDesc.RasterizerState.FillMode = D3D12_FILL_MODE_SOLID;
+    resourcePipelineDesc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+    resourcePipelineDesc.RasterizerState.DepthClipEnable = TRUE;
+    resourcePipelineDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+    resourcePipelineDesc.NumRenderTargets = 1;
+    resourcePipelineDesc.SampleDesc.Count = 1;
+
+    // Compile the shaders that render gradient color ramps.
+    {
+        std::ostringstream s;
+        s << glsl::hlsl << '\n';
+        s << glsl::constants << '\n';
+        s << glsl::common << '\n';
+        s << glsl::color_ramp << '\n';
+        ComPtr<ID3DBlob> vertexBlob =
+            compileSourceToBlob(GLSL_VERTEX, s.str().c_str(), GLSL_colorRampVertexMain, "vs_5_1");
+        ComPtr<ID3DBlob> pixelBlob = compileSourceToBlob(GLSL_FRAGMENT,
+                                                         s.str().c_str(),
+                                                         GLSL_colorRampFragmentMain,
+                                                         "ps_5_1");
+        D3D12_INPUT_ELEMENT_DESC spanDesc = {GLSL_a_span,
+                                             0,
+                                             DXGI_FORMAT_R32G32B32A32_UINT,
+                                             0,
+                                             0,
+                                             D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA,
+                                             1};
+        D3D12_GRAPHICS_PIPELINE_STATE_DESC pipelineDesc = resourcePipelineDesc;
+        pipelineDesc.VS = {vertexBlob->GetBufferPointer(), vertexBlob->GetBufferSize()};
+        pipelineDesc.PS = {pixelBlob->GetBufferPointer(), pixelBlob->GetBufferSize()};
+        pipelineDesc.InputLayout = {&spanDesc, 1};
+        pipelineDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
+        VERIFY_OK(m_gpu->CreateGraphicsPipelineState(
+            &pipelineDesc,
+            IID_PPV_ARGS(m_colorRampPipeline.ReleaseAndGetAddressOf())));
+    }
+
+    // Compile the tessellation shaders.
+    {
+        std::ostringstream s;
+        s << glsl::hlsl << '\n';
+        s << glsl::constants << '\n';
+        s << glsl::common << '\n';
+        s << glsl::tessellate << '\n';
+        ComPtr<ID3DBlob> vertexBlob =
+            compileSourceToBlob(GLSL_VERTEX, s.str().c_str(), GLSL_tessellateVertexMain, "vs_5_1");
+        ComPtr<ID3DBlob> pixelBlob = compileSourceToBlob(GLSL_FRAGMENT,
+                                                         s.str().c_str(),
+                                                         GLSL_tessellateFragmentMain,
+                                                         "ps_5_1");
+        // Draw two instances per TessVertexSpan: one normal and one optional reflection.
+        D3D12_INPUT_ELEMENT_DESC attribsDesc[] = {{GLSL_a_p0p1_,
+                                                   0,
+                                                   DXGI_FORMAT_R32G32B32A32_FLOAT,
+                                                   0,
+                                                   D3D12_APPEND_ALIGNED_ELEMENT,
+                                                   D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA,
+                                                   1},
+                                                  {GLSL_a_p2p3_,
+                                                   0,
+                                                   DXGI_FORMAT_R32G32B32A32_FLOAT,
+                                                   0,
+                                                   D3D12_APPEND_ALIGNED_ELEMENT,
+                                                   D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA,
+                                                   1},
+                                                  {GLSL_a_joinTan_and_ys,
+                                                   0,
+                                                   DXGI_FORMAT_R32G32B32A32_FLOAT,
+                                                   0,
+                                                   D3D12_APPEND_ALIGNED_ELEMENT,
+                                                   D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA,
+                                                   1},
+                                                  {GLSL_a_args,
+                                                   0,
+                                                   DXGI_FORMAT_R32G32B32A32_UINT,
+                                                   0,
+                                                   D3D12_APPEND_ALIGNED_ELEMENT,
+                                                   D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA,
+                                                   1}};
+        D3D12_GRAPHICS_PIPELINE_STATE_DESC pipelineDesc = resourcePipelineDesc;
+        pipelineDesc.VS = {vertexBlob->GetBufferPointer(), vertexBlob->GetBufferSize()};
+        pipelineDesc.PS = {pixelBlob->GetBufferPointer(), pixelBlob->GetBufferSize()};
+        pipelineDesc.InputLayout = {attribsDesc, static_cast<UINT>(std::size(attribsDesc))};
+        pipelineDesc.RTVFormats[0] = DXGI_FORMAT_R32G32B32A32_UINT;
+        VERIFY_OK(m_gpu->CreateGraphicsPipelineState(
+            &pipelineDesc,
+            IID_PPV_ARGS(m_tessellatePipeline.ReleaseAndGetAddressOf())));
+
+        m_tessSpanIndexBuffer = makeSimpleImmutableBuffer(sizeof(pls::kTessSpanIndices),
+                                                          pls::kTessSpanIndices,
+                                                          D3D12_RESOURCE_STATE_INDEX_BUFFER);
+    }
+
+    // Set up the path patch rendering buffers.
+    PatchVertex patchVertices[kPatchVertexBufferCount];
+    uint16_t patchIndices[kPatchIndexBufferCount];
+    GeneratePatchBufferData(patchVertices, patchIndices);
+    m_patchVertexBuffer =
+        makeSimpleImmutableBuffer(sizeof(patchVertices),
+                                  patchVertices,
+                                  D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
+    m_patchIndexBuffer = makeSimpleImmutableBuffer(sizeof(patchIndices),
+                                                   patchIndices,
+                                                   D3D12_RESOURCE_STATE_INDEX_BUFFER);
+
+    // Set up the imageRect rendering buffers. (pls::InterlockMode::atomics only.)
+    m_imageRectVertexBuffer =
+        makeSimpleImmutableBuffer(sizeof(pls::kImageRectVertices),
+                                  pls::kImageRectVertices,
+                                  D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
+    m_imageRectIndexBuffer = makeSimpleImmutableBuffer(sizeof(pls::kImageRectIndices),
+                                                       pls::kImageRectIndices,
+                                                       D3D12_RESOURCE_STATE_INDEX_BUFFER);
+
+    VERIFY_OK(m_gpu->CreateFence(0,
+                                 D3D12_FENCE_FLAG_NONE,
+                                 IID_PPV_ARGS(m_frameFence.ReleaseAndGetAddressOf())));
+
+    if (m_queue != nullptr)
+    {
+        m_commandListPool = std::make_unique<CommandListPool>(m_gpu.Get(), bufferRingSize());
+        if (m_contextOptions.parallelRecordingThreadCount > 0)
+        {
+            m_parallelCommandRecorder = std::make_unique<ParallelCommandRecorder>(
+                m_gpu.Get(),
+                bufferRingSize(),
+                m_contextOptions.parallelRecordingThreadCount);
+        }
+    }
+}
+
+PLSRenderContextD3D12Impl::~PLSRenderContextD3D12Impl()
+{
+    // Wait for every in-flight frame before releasing the resources it references.
+    for (rcp<pls::CommandBufferCompletionFence>& fence : m_frameCompletionFences)
+    {
+        if (fence != nullptr)
+        {
+            fence->wait();
+            fence = nullptr;
+        }
+    }
+}
+
+rcp<D3D12FrameFence> PLSRenderContextD3D12Impl::makeFrameFence()
+{
+    return make_rcp<D3D12FrameFence>(m_frameFence, ++m_lastReservedFenceValue);
+}
+
+ComPtr<ID3D12Resource> PLSRenderContextD3D12Impl::makeSimple2DTexture(
+    DXGI_FORMAT format,
+    UINT width,
+    UINT height,
+    UINT mipLevelCount,
+    D3D12_RESOURCE_FLAGS flags,
+    D3D12_RESOURCE_STATES initialState)
+{
+    return make_simple_2d_texture(m_gpu.Get(),
+                                  format,
+                                  width,
+                                  height,
+                                  mipLevelCount,
+                                  flags,
+                                  initialState);
+}
+
+ComPtr<ID3D12Resource> PLSRenderContextD3D12Impl::makeUploadBuffer(size_t sizeInBytes)
+{
+    return make_buffer(m_gpu.Get(),
+                       D3D12_HEAP_TYPE_UPLOAD,
+                       sizeInBytes,
+                       D3D12_RESOURCE_STATE_GENERIC_READ);
+}
+
+ComPtr<ID3D12Resource> PLSRenderContextD3D12Impl::makeSimpleImmutableBuffer(
+    size_t sizeInBytes,
+    const void* data,
+    D3D12_RESOURCE_STATES finalState)
+{
+    ComPtr<ID3D12Resource> staging = makeUploadBuffer(sizeInBytes);
+    void* stagingData;
+    D3D12_RANGE noReadRange = {0, 0};
+    VERIFY_OK(staging->Map(0, &noReadRange, &stagingData));
+    memcpy(stagingData, data, sizeInBytes);
+    staging->Unmap(0, nullptr);
+
+    // Buffers are always created in the common state, and implicitly promoted to COPY_DEST.
+    ComPtr<ID3D12Resource> buffer =
+        make_buffer(m_gpu.Get(), D3D12_HEAP_TYPE_DEFAULT, sizeInBytes, D3D12_RESOURCE_STATE_COMMON);
+    queueUpload(buffer, std::move(staging), finalState);
+    return buffer;
+}
+
+void PLSRenderContextD3D12Impl::queueUpload(ComPtr<ID3D12Resource> dst,
+                                            ComPtr<ID3D12Resource> staging,
+                                            D3D12_RESOURCE_STATES finalState)
+{
+    m_pendingUploads.push_back({std::move(dst), std::move(staging), finalState});
+}
+
+void PLSRenderContextD3D12Impl::recordPendingUploads(ID3D12GraphicsCommandList* cmdList)
+{
+    if (m_pendingUploads.empty())
+    {
+        return;
+    }
+    std::vector<D3D12_RESOURCE_BARRIER> barriers;
+    barriers.reserve(m_pendingUploads.size());
+    for (PendingUpload& upload : m_pendingUploads)
+    {
+        D3D12_RESOURCE_DESC dstDesc = upload.dst->GetDesc();
+        if (dstDesc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+        {
+            cmdList->CopyBufferRegion(upload.dst.Get(), 0, upload.staging.Get(), 0, dstDesc.Width);
+        }
+        else
+        {
+            std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> footprints(dstDesc.MipLevels);
+            m_gpu->GetCopyableFootprints(&dstDesc,
+                                         0,
+                                         dstDesc.MipLevels,
+                                         0,
+                                         footprints.data(),
+                                         nullptr,
+                                         nullptr,
+                                         nullptr);
+            for (UINT level = 0; level < dstDesc.MipLevels; ++level)
+            {
+                D3D12_TEXTURE_COPY_LOCATION dstLocation{};
+                dstLocation.pResource = upload.dst.Get();
+                dstLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+                dstLocation.SubresourceIndex = level;
+
+                D3D12_TEXTURE_COPY_LOCATION srcLocation{};
+                srcLocation.pResource = upload.staging.Get();
+                srcLocation.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+                srcLocation.PlacedFootprint = footprints[level];
+
+                cmdList->CopyTextureRegion(&dstLocation, 0, 0, 0, &srcLocation, nullptr);
+            }
+        }
+
+        D3D12_RESOURCE_BARRIER& barrier = barriers.emplace_back();
+        barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+        barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+        barrier.Transition.pResource = upload.dst.Get();
+        barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+        barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+        barrier.Transition.StateAfter = upload.finalState;
+
+        retainUntilFrameCompletes(std::move(upload.staging));
+        retainUntilFrameCompletes(upload.dst);
+    }
+    cmdList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+    m_pendingUploads.clear();
+}
+
+ComPtr<ID3DBlob> PLSRenderContextD3D12Impl::compileSourceToBlob(const char* shaderTypeDefineName,
+                                                                const std::string& commonSource,
+                                                                const char* entrypoint,
+                                                                const char* target)
+{
+    return d3dutil::CompileSourceToBlob(m_contextOptions.pipelineBlobCache,
+                                        shaderTypeDefineName,
+                                        commonSource,
+                                        entrypoint,
+                                        target);
+}
+
+class RenderBufferD3D12Impl : public lite_rtti_override<RenderBuffer, RenderBufferD3D12Impl>
+{
+public:
+    RenderBufferD3D12Impl(RenderBufferType renderBufferType,
+                          RenderBufferFlags renderBufferFlags,
+                          size_t sizeInBytes,
+                          PLSRenderContextD3D12Impl* plsImpl) :
+        lite_rtti_override(renderBufferType, renderBufferFlags, sizeInBytes), m_plsImpl(plsImpl)
+    {
+        if (flags() & RenderBufferFlags::mappedOnceAtInitialization)
+        {
+            // Stage the contents in an upload buffer, and copy them into the default heap at the
+            // beginning of the next flush.
+            m_ringSize = 1;
+            m_buffers[0] = m_plsImpl->makeUploadBuffer(sizeInBytes);
+        }
+        else
+        {
+            // Rotate through one persistently-mapped upload buffer per frame in flight, so we
+            // never write a buffer the GPU might still be reading.
+            m_ringSize = m_plsImpl->bufferRingSize();
+            D3D12_RANGE noReadRange = {0, 0};
+            for (int i = 0; i < m_ringSize; ++i)
+            {
+                m_buffers[i] = m_plsImpl->makeUploadBuffer(sizeInBytes);
+                VERIFY_OK(m_buffers[i]->Map(0, &noReadRange, &m_mappedMemory[i]));
+            }
+        }
+    }
+
+    ID3D12Resource* buffer() const { return m_buffers[m_submittedBufferIdx].Get(); }
+
+protected:
+    void* onMap() override
+    {
+        if (flags() & RenderBufferFlags::mappedOnceAtInitialization)
+        {
+            void* stagingData;
+            D3D12_RANGE noReadRange = {0, 0};
+            VERIFY_OK(m_buffers[0]->Map(0, &noReadRange, &stagingData));
+            return stagingData;
+        }
+        m_submittedBufferIdx = (m_submittedBufferIdx + 1) % m_ringSize;
+        return m_mappedMemory[m_submittedBufferIdx];
+    }
+
+    void onUnmap() override
+    {
+        if (flags() & RenderBufferFlags::mappedOnceAtInitialization)
+        {
+            ComPtr<ID3D12Resource> staging = std::move(m_buffers[0]);
+            staging->Unmap(0, nullptr);
+            m_buffers[0] = make_buffer(m_plsImpl->gpu(),
+                                       D3D12_HEAP_TYPE_DEFAULT,
+                                       sizeInBytes(),
+                                       D3D12_RESOURCE_STATE_COMMON);
+            m_plsImpl->queueUpload(m_buffers[0],
+                                   std::move(staging),
+                                   type() == RenderBufferType::vertex
+                                       ? D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER
+                                       : D3D12_RESOURCE_STATE_INDEX_BUFFER);
+            m_plsImpl = nullptr; // This buffer will only be mapped once.
+        }
+    }
+
+private:
+    PLSRenderContextD3D12Impl* m_plsImpl;
+    int m_ringSize;
+    int m_submittedBufferIdx = 0;
+    ComPtr<ID3D12Resource> m_buffers[kMaxBufferRingSize];
+    void* m_mappedMemory[kMaxBufferRingSize] = {};
+};
+
+rcp<RenderBuffer> PLSRenderContextD3D12Impl::makeRenderBuffer(RenderBufferType type,
+                                                              RenderBufferFlags flags,
+                                                              size_t sizeInBytes)
+{
+    return make_rcp<RenderBufferD3D12Impl>(type, flags, sizeInBytes, this);
+}
+
+// Box-filters one RGBA8 mip level down to the next.
+static void downsample_rgba8(const uint8_t* src,
+                             UINT srcWidth,
+                             UINT srcHeight,
+                             uint8_t* dst,
+                             UINT dstWidth,
+                             UINT dstHeight)
+{
+    for (UINT y = 0; y < dstHeight; ++y)
+    {
+        UINT y0 = std::min(y * 2, srcHeight - 1);
+        UINT y1 = std::min(y * 2 + 1, srcHeight - 1);
+        for (UINT x = 0; x < dstWidth; ++x)
+        {
+            UINT x0 = std::min(x * 2, srcWidth - 1);
+            UINT x1 = std::min(x * 2 + 1, srcWidth - 1);
+            for (UINT c = 0; c < 4; ++c)
+            {
+                UINT sum = src[(y0 * srcWidth + x0) * 4 + c] + src[(y0 * srcWidth + x1) * 4 + c] +
+                           src[(y1 * srcWidth + x0) * 4 + c] + src[(y1 * srcWidth + x1) * 4 + c];
+                dst[(y * dstWidth + x) * 4 + c] = static_cast<uint8_t>((sum + 2) / 4);
+            }
+        }
+    }
+}
+
+class PLSTextureD3D12Impl : public PLSTexture
+{
+public:
+    PLSTextureD3D12Impl(PLSRenderContextD3D12Impl* plsImpl,
+                        UINT width,
+                        UINT height,
+                        UINT mipLevelCount,
+                        const uint8_t imageDataRGBA[]) :
+        PLSTexture(width, height)
+    {
+        m_texture = plsImpl->makeSimple2DTexture(DXGI_FORMAT_R8G8B8A8_UNORM,
+                                                 width,
+                                                 height,
+                                                 mipLevelCount,
+                                                 D3D12_RESOURCE_FLAG_NONE,
+                                                 D3D12_RESOURCE_STATE_COPY_DEST);
+
+        D3D12_RESOURCE_DESC desc = m_texture->GetDesc();
+        std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> footprints(mipLevelCount);
+        UINT64 stagingSizeInBytes;
+        plsImpl->gpu()->GetCopyableFootprints(&desc,
+                                              0,
+                                              mipLevelCount,
+                                              0,
+                                              footprints.data(),
+                                              nullptr,
+                                              nullptr,
+                                              &stagingSizeInBytes);
+        ComPtr<ID3D12Resource> staging = plsImpl->makeUploadBuffer(stagingSizeInBytes);
+        uint8_t* stagingData;
+        D3D12_RANGE noReadRange = {0, 0};
+        VERIFY_OK(staging->Map(0, &noReadRange, reinterpret_cast<void**>(&stagingData)));
+
+        // D3D12 doesn't have an equivalent to GenerateMips(). Downsample the mipmaps on the CPU
+        // while we fill in the staging buffer. (Upload memory is write-combined, so build each
+        // level in regular memory instead of reading back from the staging buffer.)
+        std::vector<uint8_t> levelPixels(imageDataRGBA, imageDataRGBA + width * height * 4);
+        std::vector<uint8_t> nextLevelPixels;
+        UINT levelWidth = width;
+        UINT levelHeight = height;
+        for (UINT level = 0; level < mipLevelCount; ++level)
+        {
+            if (level > 0)
+            {
+                UINT nextWidth = std::max(levelWidth / 2, 1u);
+                UINT nextHeight = std::max(levelHeight / 2, 1u);
+                nextLevelPixels.resize(nextWidth * nextHeight * 4);
+                downsample_rgba8(levelPixels.data(),
+                                 levelWidth,
+                                 levelHeight,
+                                 nextLevelPixels.data(),
+                                 nextWidth,
+                                 nextHeight);
+                std::swap(levelPixels, nextLevelPixels);
+                levelWidth = nextWidth;
+                levelHeight = nextHeight;
+            }
+            const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& footprint = footprints[level];
+            for (UINT y = 0; y < levelHeight; ++y)
+            {
+                memcpy(stagingData + footprint.Offset + y * footprint.Footprint.RowPitch,
+                       levelPixels.data() + y * levelWidth * 4,
+                       levelWidth * 4);
+            }
+        }
+        staging->Unmap(0, nullptr);
+
+        plsImpl->queueUpload(m_texture,
+                             std::move(staging),
+                             D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    }
+
+    ID3D12Resource* texture() const { return m_texture.Get(); }
+
+private:
+    ComPtr<ID3D12Resource> m_texture;
+};
+
+rcp<PLSTexture> PLSRenderContextD3D12Impl::makeImageTexture(uint32_t width,
+                                                            uint32_t height,
+                                                            uint32_t mipLevelCount,
+                                                            const uint8_t imageDataRGBA[])
+{
+    return make_rcp<PLSTextureD3D12Impl>(this, width, height, mipLevelCount, imageDataRGBA);
+}
+
+// BufferRing of persistently-mapped buffers in the upload heap. Each buffer is mapped once, when
+// it's created, and the GPU reads it in place, so mapping and unmapping are free.
+class BufferRingD3D12 : public BufferRing
+{
+public:
+    BufferRingD3D12(PLSRenderContextD3D12Impl* plsImpl, size_t capacityInBytes) :
+        BufferRing(capacityInBytes, plsImpl->bufferRingSize())
+    {
+        D3D12_RANGE noReadRange = {0, 0};
+        for (int i = 0; i < ringSize(); ++i)
+        {
+            m_buffers[i] = plsImpl->makeUploadBuffer(capacityInBytes);
+            VERIFY_OK(m_buffers[i]->Map(0, &noReadRange, &m_mappedMemory[i]));
+        }
+    }
+
+    ID3D12Resource* submittedBuffer() const { return m_buffers[submittedBufferIdx()].Get(); }
+
+    D3D12_GPU_VIRTUAL_ADDRESS submittedGPUAddress(size_t offsetInBytes = 0) const
+    {
+        return submittedBuffer()->GetGPUVirtualAddress() + offsetInBytes;
+    }
+
+protected:
+    void* onMapBuffer(int bufferIdx, size_t mapSizeInBytes) override
+    {
+        return m_mappedMemory[bufferIdx];
+    }
+
+    // Upload heaps are coherent, so there's nothing to flush.
+    void onUnmapAndSubmitBuffer(int bufferIdx, size_t mapSizeInBytes) override {}
+
+private:
+    ComPtr<ID3D12Resource> m_buffers[kMaxBufferRingSize];
+    void* m_mappedMemory[kMaxBufferRingSize] = {};
+};
+
+std::unique_ptr<BufferRing> PLSRenderContextD3D12Impl::makeUniformBufferRing(
+    size_t capacityInBytes)
+{
+    // FlushUniforms and ImageDrawUniforms are each 256 bytes, so every element of these rings can
+    // be bound directly as a root CBV.
+    static_assert(sizeof(pls::FlushUniforms) % D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT == 0);
+    static_assert(sizeof(pls::ImageDrawUniforms) % D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT ==
+                  0);
+    return capacityInBytes != 0 ? std::make_unique<BufferRingD3D12>(this, capacityInBytes)
+                                : nullptr;
+}
+
+std::unique_ptr<BufferRing> PLSRenderContextD3D12Impl::makeStorageBufferRing(
+    size_t capacityInBytes,
+    pls::StorageBufferStructure)
+{
+    // Storage buffers are bound as root SRVs, which don't need a view of any particular structure.
+    return capacityInBytes != 0 ? std::make_unique<BufferRingD3D12>(this, capacityInBytes)
+                                : nullptr;
+}
+
+std::unique_ptr<BufferRing> PLSRenderContextD3D12Impl::makeVertexBufferRing(size_t capacityInBytes)
+{
+    return capacityInBytes != 0 ? std::make_unique<BufferRingD3D12>(this, capacityInBytes)
+                                : nullptr;
+}
+
+std::unique_ptr<BufferRing> PLSRenderContextD3D12Impl::makeTextureTransferBufferRing(
+    size_t capacityInBytes)
+{
+    // Texture copies need their source rows at 512-byte aligned offsets, which the simple color
+    // ramps of a logical flush aren't. Store this data on the heap and stage it in aligned upload
+    // memory at flush time.
+    return std::make_unique<HeapBufferRing>(capacityInBytes);
+}
+
+PLSRenderTargetD3D12::PLSRenderTargetD3D12(PLSRenderContextD3D12Impl* plsImpl,
+                                           uint32_t width,
+                                           uint32_t height) :
+    PLSRenderTarget(width, height),
+    m_gpu(plsImpl->gpu()),
+    m_gpuSupportsTypedUAVLoadStore(plsImpl->d3dCapabilities().supportsTypedUAVLoadStore)
+{
+    m_rtvHeap = make_descriptor_heap(m_gpu.Get(),
+                                     D3D12_DESCRIPTOR_HEAP_TYPE_RTV,
+                                     1,
+                                     D3D12_DESCRIPTOR_HEAP_FLAG_NONE);
+    m_uavHeap = make_descriptor_heap(m_gpu.Get(),
+                                     D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+                                     std::size(m_uavIsValid),
+                                     D3D12_DESCRIPTOR_HEAP_FLAG_NONE);
+    m_uavDescriptorSize =
+        m_gpu->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+}
+
+void PLSRenderTargetD3D12::setTargetTexture(ComPtr<ID3D12Resource> tex,
+                                            D3D12_RESOURCE_STATES clientState)
+{
+    if (tex != nullptr)
+    {
+        D3D12_RESOURCE_DESC desc = tex->GetDesc();
+#ifdef DEBUG
+        assert(desc.Width == width());
+        assert(desc.Height == height());
+        assert(desc.Format == DXGI_FORMAT_R8G8B8A8_UNORM ||
+               desc.Format == DXGI_FORMAT_B8G8R8A8_UNORM ||
+               desc.Format == DXGI_FORMAT_R8G8B8A8_TYPELESS);
+#endif
+        m_targetTextureSupportsUAV =
+            (desc.Flags & D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS) &&
+            (m_gpuSupportsTypedUAVLoadStore || desc.Format == DXGI_FORMAT_R8G8B8A8_TYPELESS);
+        m_targetFormat = desc.Format;
+    }
+    else
+    {
+        m_targetTextureSupportsUAV = false;
+    }
+    m_targetTexture = std::move(tex);
+    m_targetClientState = clientState;
+    m_targetState = clientState;
+    m_targetRTVIsValid = false;
+    m_uavIsValid[COLOR_PLANE_IDX] = false;
+}
+
+DXGI_FORMAT PLSRenderTargetD3D12::targetRTVFormat() const
+{
+    switch (m_targetFormat)
+    {
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+            return m_targetFormat;
+        case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+            return DXGI_FORMAT_R8G8B8A8_UNORM;
+        default:
+            RIVE_UNREACHABLE();
+    }
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE PLSRenderTargetD3D12::targetRTV()
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE handle = m_rtvHeap->GetCPUDescriptorHandleForHeapStart();
+    if (!m_targetRTVIsValid && m_targetTexture != nullptr)
+    {
+        D3D12_RENDER_TARGET_VIEW_DESC desc{};
+        desc.Format = targetRTVFormat();
+        desc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE2D;
+        m_gpu->CreateRenderTargetView(m_targetTexture.Get(), &desc, handle);
+        m_targetRTVIsValid = true;
+    }
+    return handle;
+}
+
+ID3D12Resource* PLSRenderTargetD3D12::offscreenTexture()
+{
+    assert(!m_targetTextureSupportsUAV);
+    if (m_offscreenTexture == nullptr)
+    {
+        m_offscreenTexture = make_simple_2d_texture(m_gpu.Get(),
+                                                    DXGI_FORMAT_R8G8B8A8_TYPELESS,
+                                                    width(),
+                                                    height(),
+                                                    1,
+                                                    D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS,
+                                                    D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+        m_offscreenState = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+    }
+    return m_offscreenTexture.Get();
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE PLSRenderTargetD3D12::uavHandle(int planeIdx) const
+{
+    return offset_handle(m_uavHeap->GetCPUDescriptorHandleForHeapStart(),
+                         planeIdx,
+                         m_uavDescriptorSize);
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE PLSRenderTargetD3D12::targetUAV()
+{
+    if (!m_uavIsValid[COLOR_PLANE_IDX])
+    {
+        if (auto* uavTexture =
+                m_targetTextureSupportsUAV ? m_targetTexture.Get() : offscreenTexture())
+        {
+            DXGI_FORMAT targetUavFormat;
+            if (m_gpuSupportsTypedUAVLoadStore)
+            {
+                switch (m_targetFormat)
+                {
+                    case DXGI_FORMAT_R8G8B8A8_UNORM:
+                    case DXGI_FORMAT_B8G8R8A8_UNORM:
+                        targetUavFormat = m_targetFormat;
+                        break;
+                    case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+                        targetUavFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
+                        break;
+                    default:
+                        RIVE_UNREACHABLE();
+                }
+            }
+            else
+            {
+                targetUavFormat = DXGI_FORMAT_R32_UINT;
+            }
+            make_simple_2d_uav(m_gpu.Get(),
+                               uavTexture,
+                               targetUavFormat,
+                               uavHandle(COLOR_PLANE_IDX));
+            m_uavIsValid[COLOR_PLANE_IDX] = true;
+        }
+    }
+    return uavHandle(COLOR_PLANE_IDX);
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE PLSRenderTargetD3D12::coverageUAV()
+{
+    if (m_coverageTexture == nullptr)
+    {
+        m_coverageTexture = make_simple_2d_texture(m_gpu.Get(),
+                                                   DXGI_FORMAT_R32_UINT,
+                                                   width(),
+                                                   height(),
+                                                   1,
+                                                   D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS,
+                                                   D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    }
+    if (!m_uavIsValid[COVERAGE_PLANE_IDX])
+    {
+        make_simple_2d_uav(m_gpu.Get(),
+                           m_coverageTexture.Get(),
+                           DXGI_FORMAT_R32_UINT,
+                           uavHandle(COVERAGE_PLANE_IDX));
+        m_uavIsValid[COVERAGE_PLANE_IDX] = true;
+    }
+    return uavHandle(COVERAGE_PLANE_IDX);
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE PLSRenderTargetD3D12::clipUAV()
+{
+    if (m_clipTexture == nullptr)
+    {
+        m_clipTexture = make_simple_2d_texture(m_gpu.Get(),
+                                               DXGI_FORMAT_R32_UINT,
+                                               width(),
+                                               height(),
+                                               1,
+                                               D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS,
+                                               D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    }
+    if (!m_uavIsValid[CLIP_PLANE_IDX])
+    {
+        make_simple_2d_uav(m_gpu.Get(),
+                           m_clipTexture.Get(),
+                           DXGI_FORMAT_R32_UINT,
+                           uavHandle(CLIP_PLANE_IDX));
+        m_uavIsValid[CLIP_PLANE_IDX] = true;
+    }
+    return uavHandle(CLIP_PLANE_IDX);
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE PLSRenderTargetD3D12::scratchColorUAV()
+{
+    if (m_scratchColorTexture == nullptr)
+    {
+        m_scratchColorTexture = make_simple_2d_texture(m_gpu.Get(),
+                                                       DXGI_FORMAT_R8G8B8A8_TYPELESS,
+                                                       width(),
+                                                       height(),
+                                                       1,
+                                                       D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS,
+                                                       D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    }
+    if (!m_uavIsValid[SCRATCH_COLOR_PLANE_IDX])
+    {
+        make_simple_2d_uav(m_gpu.Get(),
+                           m_scratchColorTexture.Get(),
+                           m_gpuSupportsTypedUAVLoadStore ? DXGI_FORMAT_R8G8B8A8_UNORM
+                                                          : DXGI_FORMAT_R32_UINT,
+                           uavHandle(SCRATCH_COLOR_PLANE_IDX));
+        m_uavIsValid[SCRATCH_COLOR_PLANE_IDX] = true;
+    }
+    return uavHandle(SCRATCH_COLOR_PLANE_IDX);
+}
+
+void PLSRenderTargetD3D12::transitionTargetTexture(ID3D12GraphicsCommandList* cmdList,
+                                                   D3D12_RESOURCE_STATES state)
+{
+    transition_resource(cmdList, m_targetTexture.Get(), &m_targetState, state);
+}
+
+void PLSRenderTargetD3D12::transitionOffscreenTexture(ID3D12GraphicsCommandList* cmdList,
+                                                      D3D12_RESOURCE_STATES state)
+{
+    transition_resource(cmdList, offscreenTexture(), &m_offscreenState, state);
+}
+
+void PLSRenderContextD3D12Impl::resizeGradientTexture(uint32_t width, uint32_t height)
+{
+    if (m_gradTexture != nullptr)
+    {
+        // The previous frame may still be sampling the old texture.
+        retainUntilFrameCompletes(std::move(m_gradTexture));
+    }
+    if (width != 0 && height != 0)
+    {
+        m_gradTexture = makeSimple2DTexture(DXGI_FORMAT_R8G8B8A8_UNORM,
+                                            width,
+                                            height,
+                                            1,
+                                            D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET,
+                                            D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+        m_gradTextureState = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+        m_gpu->CreateRenderTargetView(
+            m_gradTexture.Get(),
+            nullptr,
+            offset_handle(m_resourceTextureRTVHeap->GetCPUDescriptorHandleForHeapStart(),
+                          kGradTextureRTVIdx,
+                          m_rtvDescriptorSize));
+    }
+}
+
+void PLSRenderContextD3D12Impl::resizeTessellationTexture(uint32_t width, uint32_t height)
+{
+    if (m_tessTexture != nullptr)
+    {
+        // The previous frame may still be reading the old texture.
+        retainUntilFrameCompletes(std::move(m_tessTexture));
+    }
+    if (width != 0 && height != 0)
+    {
+        m_tessTexture = makeSimple2DTexture(DXGI_FORMAT_R32G32B32A32_UINT,
+                                            width,
+                                            height,
+                                            1,
+                                            D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET,
+                                            D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+        m_tessTextureState = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+        m_gpu->CreateRenderTargetView(
+            m_tessTexture.Get(),
+            nullptr,
+            offset_handle(m_resourceTextureRTVHeap->GetCPUDescriptorHandleForHeapStart(),
+                          kTessTextureRTVIdx,
+                          m_rtvDescriptorSize));
+    }
+}
+
+std::pair<ID3DBlob*, ID3DBlob*> PLSRenderContextD3D12Impl::findOrCompileDrawShaders(
+    DrawType drawType,
+    pls::ShaderFeatures shaderFeatures,
+    pls::InterlockMode interlockMode,
+    pls::ShaderMiscFlags pixelShaderMiscFlags)
+{
+    uint32_t vertexShaderKey = pls::ShaderUniqueKey(drawType,
+                                                    shaderFeatures & kVertexShaderFeaturesMask,
+                                                    interlockMode,
+                                                    pls::ShaderMiscFlags::none);
+    auto vertexEntry = m_drawVertexShaders.find(vertexShaderKey);
+
+    uint32_t pixelShaderKey =
+        ShaderUniqueKey(drawType, shaderFeatures, interlockMode, pixelShaderMiscFlags);
+    auto pixelEntry = m_drawPixelShaders.find(pixelShaderKey);
+
+    if (vertexEntry == m_drawVertexShaders.end() || pixelEntry == m_drawPixelShaders.end())
+    {
+        const std::string shader = d3dutil::BuildDrawShaderSource(drawType,
+                                                                   shaderFeatures,
+                                                                   interlockMode,
+                                                                   pixelShaderMiscFlags,
+                                                                   m_d3dCapabilities);
+        if (vertexEntry == m_drawVertexShaders.end())
+        {
+            ComPtr<ID3DBlob> blob =
+                compileSourceToBlob(GLSL_VERTEX, shader.c_str(), GLSL_drawVertexMain, "vs_5_1");
+            vertexEntry = m_drawVertexShaders.insert({vertexShaderKey, std::move(blob)}).first;
+        }
+        if (pixelEntry == m_drawPixelShaders.end())
+        {
+            ComPtr<ID3DBlob> blob =
+                compileSourceToBlob(GLSL_FRAGMENT, shader.c_str(), GLSL_drawFragmentMain, "ps_5_1");
+            pixelEntry = m_drawPixelShaders.insert({pixelShaderKey, std::move(blob)}).first;
+        }
+    }
+
+    return {vertexEntry->second.Get(), pixelEntry->second.Get()};
+}
+
+ID3D12PipelineState* PLSRenderContextD3D12Impl::findOrCreateDrawPipeline(
+    DrawType drawType,
+    pls::ShaderFeatures shaderFeatures,
+    pls::InterlockMode interlockMode,
+    pls::ShaderMiscFlags pixelShaderMiscFlags,
+    const DrawPipelineOptions& options)
+{
+    // The pixel shader key also determines the vertex shader.
+    uint64_t pipelineKey =
+        static_cast<uint64_t>(
+            ShaderUniqueKey(drawType, shaderFeatures, interlockMode, pixelShaderMiscFlags))
+            << 32 |
+        static_cast<uint64_t>(options.renderTargetFormat) << 2 |
+        static_cast<uint64_t>(options.srcOverBlend) << 1 | static_cast<uint64_t>(options.wireframe);
+    auto pipelineEntry = m_drawPipelines.find(pipelineKey);
+    if (pipelineEntry != m_drawPipelines.end())
+    {
+        return pipelineEntry->second.Get();
+    }
+
+    auto [vertexShader, pixelShader] =
+        findOrCompileDrawShaders(drawType, shaderFeatures, interlockMode, pixelShaderMiscFlags);
+
+    D3D12_INPUT_ELEMENT_DESC layoutDesc[2];
+    UINT vertexAttribCount;
+    D3D12_CULL_MODE cullMode;
+    switch (drawType)
+    {
+        case DrawType::midpointFanPatches:
+        case DrawType::outerCurvePatches:
+            layoutDesc[0] = {GLSL_a_patchVertexData,
+                             0,
+                             DXGI_FORMAT_R32G32B32A32_FLOAT,
+                             kPatchVertexDataSlot,
+                             D3D12_APPEND_ALIGNED_ELEMENT,
+                             D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
+                             0};
+            layoutDesc[1] = {GLSL_a_mirroredVertexData,
+                             0,
+                             DXGI_FORMAT_R32G32B32A32_FLOAT,
+                             kPatchVertexDataSlot,
+                             D3D12_APPEND_ALIGNED_ELEMENT,
+                             D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
+                             0};
+            vertexAttribCount = 2;
+            cullMode = D3D12_CULL_MODE_BACK;
+            break;
+        case DrawType::interiorTriangulation:
+            layoutDesc[0] = {GLSL_a_triangleVertex,
+                             0,
+                             DXGI_FORMAT_R32G32B32_FLOAT,
+                             kTriangleVertexDataSlot,
+                             0,
+                             D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
+                             0};
+            vertexAttribCount = 1;
+            cullMode = D3D12_CULL_MODE_BACK;
+            break;
+        case DrawType::imageRect:
+            layoutDesc[0] = {GLSL_a_imageRectVertex,
+                             0,
+                             DXGI_FORMAT_R32G32B32A32_FLOAT,
+                             kImageRectVertexDataSlot,
+                             0,
+                             D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
+                             0};
+            vertexAttribCount = 1;
+            cullMode = D3D12_CULL_MODE_NONE;
+            break;
+        case DrawType::imageMesh:
+            layoutDesc[0] = {GLSL_a_position,
+                             0,
+                             DXGI_FORMAT_R32G32_FLOAT,
+                             kImageMeshVertexDataSlot,
+                             D3D12_APPEND_ALIGNED_ELEMENT,
+                             D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
+                             0};
+            layoutDesc[1] = {GLSL_a_texCoord,
+                             0,
+                             DXGI_FORMAT_R32G32_FLOAT,
+                             kImageMeshUVDataSlot,
+                             D3D12_APPEND_ALIGNED_ELEMENT,
+                             D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,
+                             0};
+            vertexAttribCount = 2;
+            cullMode = D3D12_CULL_MODE_NONE;
+            break;
+        case DrawType::plsAtomicResolve:
+            vertexAttribCount = 0;
+            cullMode = D3D12_CULL_MODE_BACK;
+            break;
+        case DrawType::plsAtomicInitialize:
+        case DrawType::stencilClipReset:
+            RIVE_UNREACHABLE();
+    }
+
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC pipelineDesc{};
+    pipelineDesc.pRootSignature = m_rootSignature.Get();
+    pipelineDesc.VS = {vertexShader->GetBufferPointer(), vertexShader->GetBufferSize()};
+    pipelineDesc.PS = {pixelShader->GetBufferPointer(), pixelShader->GetBufferSize()};
+
+    D3D12_RENDER_TARGET_BLEND_DESC& blendDesc = pipelineDesc.BlendState.RenderTarget[0];
+    if (options.srcOverBlend)
+    {
+        // When rendering directly to the target RTV, we use the built-in blend hardware for opacity
+        // and antialiasing.
+        blendDesc.BlendEnable = TRUE;
+        blendDesc.SrcBlend = D3D12_BLEND_ONE;
+        blendDesc.DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
+        blendDesc.BlendOp = D3D12_BLEND_OP_ADD;
+        blendDesc.SrcBlendAlpha = D3D12_BLEND_ONE;
+        blendDesc.DestBlendAlpha = D3D12_BLEND_INV_SRC_ALPHA;
+        blendDesc.BlendOpAlpha = D3D12_BLEND_OP_ADD;
+    }
+    blendDesc.LogicOp = D3D12_LOGIC_OP_NOOP;
+    blendDesc.RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
+    pipelineDesc.SampleMask = UINT_MAX;
+
+    pipelineDesc.RasterizerState.FillMode =
+        options.wireframe ? D3D12_FILL_MODE_WIREFRAME : D3D12_FILL_MODE_SOLID;
+    pipelineDesc.RasterizerState.CullMode = cullMode;
+    pipelineDesc.RasterizerState.FrontCounterClockwise = FALSE; // FrontCounterClockwise must be
+                                                                // FALSE in order to match the
+                                                                // winding sense of interior
+                                                                // triangulations.
+    pipelineDesc.RasterizerState.DepthClipEnable = TRUE;
+
+    pipelineDesc.InputLayout = {layoutDesc, vertexAttribCount};
+    pipelineDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+    if (options.renderTargetFormat != DXGI_FORMAT_UNKNOWN)
+    {
+        pipelineDesc.NumRenderTargets = 1;
+        pipelineDesc.RTVFormats[0] = options.renderTargetFormat;
+    }
+    pipelineDesc.SampleDesc.Count = 1;
+
+    ComPtr<ID3D12PipelineState> pipeline;
+    VERIFY_OK(m_gpu->CreateGraphicsPipelineState(&pipelineDesc,
+                                                 IID_PPV_ARGS(pipeline.ReleaseAndGetAddressOf())));
+    return m_drawPipelines.insert({pipelineKey, std::move(pipeline)}).first->second.Get();
+}
+
+void PLSRenderContextD3D12Impl::precompileShaders(Span<const pls::ShaderVariant> variants)
+{
+    // Pipelines also depend on the render target format, which isn't known yet, so only compile
+    // the shaders. Bytecode is still stored in the pipelineBlobCache (if any) for subsequent runs.
+    for (const pls::ShaderVariant& variant : variants)
+    {
+        if (variant.interlockMode == pls::InterlockMode::depthStencil ||
+            variant.drawType == DrawType::plsAtomicInitialize ||
+            variant.drawType == DrawType::stencilClipReset)
+        {
+            continue;
+        }
+        findOrCompileDrawShaders(variant.drawType,
+                                 variant.shaderFeatures,
+                                 variant.interlockMode,
+                                 pls::ShaderMiscFlags::none);
+    }
+}
+
+void PLSRenderContextD3D12Impl::prepareToMapBuffers()
+{
+    m_bufferRingIdx = (m_bufferRingIdx + 1) % bufferRingSize();
+
+    // Wait for the existing resources to finish before we release/recycle them.
+    if (rcp<pls::CommandBufferCompletionFence> fence =
+            std::move(m_frameCompletionFences[m_bufferRingIdx]))
+    {
+        fence->wait();
+    }
+
+    m_inFlightResources[m_bufferRingIdx].clear();
+    m_descriptorHeaps[m_bufferRingIdx].count = 0;
+    m_uploadArenas[m_bufferRingIdx].used = 0;
+    if (m_commandListPool != nullptr)
+    {
+        m_commandListPool->reset(m_bufferRingIdx);
+    }
+    if (m_parallelCommandRecorder != nullptr)
+    {
+        m_parallelCommandRecorder->reset(m_bufferRingIdx);
+    }
+}
+
+PLSRenderContextD3D12Impl::DescriptorRange PLSRenderContextD3D12Impl::allocateDescriptors(
+    UINT count)
+{
+    DescriptorHeap& descriptorHeap = m_descriptorHeaps[m_bufferRingIdx];
+    if (descriptorHeap.count + count > descriptorHeap.capacity)
+    {
+        if (descriptorHeap.heap != nullptr)
+        {
+            // Earlier flushes in this frame may still reference the old heap.
+            retainUntilFrameCompletes(std::move(descriptorHeap.heap));
+        }
+        descriptorHeap.capacity =
+            std::max(std::max(descriptorHeap.capacity * 2, kInitialDescriptorHeapCapacity), count);
+        descriptorHeap.heap = make_descriptor_heap(m_gpu.Get(),
+                                                   D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+                                                   descriptorHeap.capacity,
+                                                   D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE);
+        descriptorHeap.count = 0;
+    }
+    DescriptorRange range = {
+        offset_handle(descriptorHeap.heap->GetCPUDescriptorHandleForHeapStart(),
+                      descriptorHeap.count,
+                      m_cbvSrvUavDescriptorSize),
+        offset_handle(descriptorHeap.heap->GetGPUDescriptorHandleForHeapStart(),
+                      descriptorHeap.count,
+                      m_cbvSrvUavDescriptorSize),
+    };
+    descriptorHeap.count += count;
+    return range;
+}
+
+PLSRenderContextD3D12Impl::UploadAllocation PLSRenderContextD3D12Impl::allocateUploadMemory(
+    size_t sizeInBytes,
+    size_t alignment)
+{
+    UploadArena& arena = m_uploadArenas[m_bufferRingIdx];
+    size_t offset = (arena.used + alignment - 1) / alignment * alignment;
+    if (offset + sizeInBytes > arena.capacity)
+    {
+        if (arena.buffer != nullptr)
+        {
+            // Earlier flushes in this frame may still be copying out of the old buffer.
+            retainUntilFrameCompletes(std::move(arena.buffer));
+        }
+        arena.capacity = std::max(std::max(arena.capacity * 2, kInitialUploadArenaSizeInBytes),
+                                  sizeInBytes);
+        arena.buffer = makeUploadBuffer(arena.capacity);
+        D3D12_RANGE noReadRange = {0, 0};
+        VERIFY_OK(
+            arena.buffer->Map(0, &noReadRange, reinterpret_cast<void**>(&arena.mappedMemory)));
+        offset = 0;
+    }
+    arena.used = offset + sizeInBytes;
+    return {arena.buffer.Get(), offset, arena.mappedMemory + offset};
+}
+
+static const BufferRingD3D12* ring_d3d12(const BufferRing* bufferRing)
+{
+    assert(bufferRing != nullptr);
+    return static_cast<const BufferRingD3D12*>(bufferRing);
+}
+
+static const char* heap_buffer_contents(const BufferRing* bufferRing)
+{
+    assert(bufferRing != nullptr);
+    auto heapBuffer = static_cast<const HeapBufferRing*>(bufferRing);
+    return reinterpret_cast<const char*>(heapBuffer->contents());
+}
+
+void PLSRenderContextD3D12Impl::bindFlushResources(ID3D12GraphicsCommandList* cmdList,
+                                                   const FlushDescriptor& desc)
+{
+    ID3D12DescriptorHeap* descriptorHeap = currentDescriptorHeap();
+    cmdList->SetDescriptorHeaps(1, &descriptorHeap);
+    cmdList->SetGraphicsRootSignature(m_rootSignature.Get());
+
+    // All programs use the same set of per-flush uniforms.
+    cmdList->SetGraphicsRootConstantBufferView(
+        kFlushUniformsRootParam,
+        ring_d3d12(flushUniformBufferRing())
+            ->submittedGPUAddress(desc.flushUniformDataOffsetInBytes));
+
+    // All programs use the same storage buffers. Root SRVs are raw addresses, so unlike D3D11, we
+    // can bind each buffer at the first element of this flush without creating a new view.
+    if (desc.pathCount > 0)
+    {
+        cmdList->SetGraphicsRootShaderResourceView(
+            kPathBufferRootParam,
+            ring_d3d12(pathBufferRing())
+                ->submittedGPUAddress(desc.firstPath * sizeof(pls::PathData)));
+        cmdList->SetGraphicsRootShaderResourceView(
+            kPaintBufferRootParam,
+            ring_d3d12(paintBufferRing())
+                ->submittedGPUAddress(desc.firstPaint * sizeof(pls::PaintData)));
+        cmdList->SetGraphicsRootShaderResourceView(
+            kPaintAuxBufferRootParam,
+            ring_d3d12(paintAuxBufferRing())
+                ->submittedGPUAddress(desc.firstPaintAux * sizeof(pls::PaintAuxData)));
+    }
+    if (desc.contourCount > 0)
+    {
+        cmdList->SetGraphicsRootShaderResourceView(
+            kContourBufferRootParam,
+            ring_d3d12(contourBufferRing())
+                ->submittedGPUAddress(desc.firstContour * sizeof(pls::ContourData)));
+    }
+}
+
+void PLSRenderContextD3D12Impl::bindDrawPassState(ID3D12GraphicsCommandList* cmdList,
+                                                  const DrawPassState& state)
+{
+    const FlushDescriptor& desc = *state.desc;
+
+    D3D12_VERTEX_BUFFER_VIEW vertexBufferViews[3] = {
+        {m_patchVertexBuffer->GetGPUVirtualAddress(),
+         static_cast<UINT>(sizeof(pls::PatchVertex) * kPatchVertexBufferCount),
+         sizeof(pls::PatchVertex)},
+        {},
+        {m_imageRectVertexBuffer->GetGPUVirtualAddress(),
+         static_cast<UINT>(sizeof(pls::kImageRectVertices)),
+         sizeof(pls::ImageRectVertex)},
+    };
+    if (desc.hasTriangleVertices)
+    {
+        const BufferRingD3D12* triangleBuffer = ring_d3d12(triangleBufferRing());
+        vertexBufferViews[kTriangleVertexDataSlot] = {
+            triangleBuffer->submittedGPUAddress(),
+            static_cast<UINT>(triangleBuffer->capacityInBytes()),
+            sizeof(pls::TriangleVertex),
+        };
+    }
+    static_assert(kPatchVertexDataSlot == 0);
+    static_assert(kTriangleVertexDataSlot == 1);
+    static_assert(kImageRectVertexDataSlot == 2);
+    cmdList->IASetVertexBuffers(0, std::size(vertexBufferViews), vertexBufferViews);
+
+    PLSRenderTargetD3D12* renderTarget = state.renderTarget;
+    D3D12_VIEWPORT viewport = {0,
+                               0,
+                               static_cast<float>(renderTarget->width()),
+                               static_cast<float>(renderTarget->height()),
+                               0,
+                               1};
+    cmdList->RSSetViewports(1, &viewport);
+    D3D12_RECT scissor = {0,
+                          0,
+                          static_cast<LONG>(renderTarget->width()),
+                          static_cast<LONG>(renderTarget->height())};
+    cmdList->RSSetScissorRects(1, &scissor);
+
+    if (state.renderDirectToRasterPipeline)
+    {
+        cmdList->OMSetRenderTargets(1, &state.targetRTV, FALSE, nullptr);
+    }
+    else
+    {
+        cmdList->OMSetRenderTargets(0, nullptr, FALSE, nullptr);
+    }
+
+    cmdList->SetGraphicsRootDescriptorTable(kResourceTexturesRootParam,
+                                            state.resourceTextureTable);
+    cmdList->SetGraphicsRootDescriptorTable(kImageTextureRootParam, state.nullImageTextureTable);
+    cmdList->SetGraphicsRootDescriptorTable(kPLSPlanesRootParam, state.plsUAVTable);
+}
+
+void PLSRenderContextD3D12Impl::recordDrawBatches(ID3D12GraphicsCommandList* cmdList,
+                                                  const DrawPassState& state,
+                                                  const ResolvedDrawBatch* begin,
+                                                  const ResolvedDrawBatch* end) const
+{
+    D3D12_GPU_VIRTUAL_ADDRESS imageDrawUniformsAddress =
+        imageDrawUniformBufferRing() != nullptr
+            ? ring_d3d12(imageDrawUniformBufferRing())->submittedGPUAddress()
+            : 0;
+    D3D12_INDEX_BUFFER_VIEW patchIndexBufferView = {m_patchIndexBuffer->GetGPUVirtualAddress(),
+                                                    sizeof(uint16_t) * kPatchIndexBufferCount,
+                                                    DXGI_FORMAT_R16_UINT};
+    D3D12_INDEX_BUFFER_VIEW imageRectIndexBufferView = {
+        m_imageRectIndexBuffer->GetGPUVirtualAddress(),
+        sizeof(pls::kImageRectIndices),
+        DXGI_FORMAT_R16_UINT};
+
+    D3D12_GPU_DESCRIPTOR_HANDLE boundImageTextureTable = state.nullImageTextureTable;
+    for (const ResolvedDrawBatch* resolvedBatch = begin; resolvedBatch != end; ++resolvedBatch)
+    {
+        const DrawBatch& batch = *resolvedBatch->batch;
+        cmdList->SetPipelineState(resolvedBatch->pipeline);
+
+        if (resolvedBatch->imageTextureTable.ptr != boundImageTextureTable.ptr)
+        {
+            cmdList->SetGraphicsRootDescriptorTable(kImageTextureRootParam,
+                                                    resolvedBatch->imageTextureTable);
+            boundImageTextureTable = resolvedBatch->imageTextureTable;
+        }
+
+        switch (batch.drawType)
+        {
+            case DrawType::midpointFanPatches:
+            case DrawType::outerCurvePatches:
+            {
+                cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+                cmdList->IASetIndexBuffer(&patchIndexBufferView);
+                cmdList->SetGraphicsRoot32BitConstant(kDrawUniformsRootParam, batch.baseElement, 0);
+                cmdList->DrawIndexedInstanced(PatchIndexCount(batch.drawType),
+                                              batch.elementCount,
+                                              PatchBaseIndex(batch.drawType),
+                                              0,
+                                              batch.baseElement);
+                break;
+            }
+            case DrawType::interiorTriangulation:
+            {
+                cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+                cmdList->DrawInstanced(batch.elementCount, 1, batch.baseElement, 0);
+                break;
+            }
+            case DrawType::imageRect:
+                cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+                cmdList->IASetIndexBuffer(&imageRectIndexBufferView);
+                cmdList->SetGraphicsRootConstantBufferView(kImageDrawUniformsRootParam,
+                                                           imageDrawUniformsAddress +
+                                                               batch.imageDrawDataOffset);
+                cmdList->DrawIndexedInstanced(std::size(pls::kImageRectIndices), 1, 0, 0, 0);
+                break;
+            case DrawType::imageMesh:
+            {
+                LITE_RTTI_CAST_OR_BREAK(vertexBuffer,
+                                        const RenderBufferD3D12Impl*,
+                                        batch.vertexBuffer);
+                LITE_RTTI_CAST_OR_BREAK(uvBuffer, const RenderBufferD3D12Impl*, batch.uvBuffer);
+                LITE_RTTI_CAST_OR_BREAK(indexBuffer,
+                                        const RenderBufferD3D12Impl*,
+                                        batch.indexBuffer);
+                D3D12_VERTEX_BUFFER_VIEW imageMeshBufferViews[] = {
+                    {vertexBuffer->buffer()->GetGPUVirtualAddress(),
+                     static_cast<UINT>(vertexBuffer->sizeInBytes()),
+                     sizeof(Vec2D)},
+                    {uvBuffer->buffer()->GetGPUVirtualAddress(),
+                     static_cast<UINT>(uvBuffer->sizeInBytes()),
+                     sizeof(Vec2D)},
+                };
+                static_assert(kImageMeshUVDataSlot == kImageMeshVertexDataSlot + 1);
+                cmdList->IASetVertexBuffers(kImageMeshVertexDataSlot, 2, imageMeshBufferViews);
+                D3D12_INDEX_BUFFER_VIEW indexBufferView = {
+                    indexBuffer->buffer()->GetGPUVirtualAddress(),
+                    static_cast<UINT>(indexBuffer->sizeInBytes()),
+                    DXGI_FORMAT_R16_UINT};
+                cmdList->IASetIndexBuffer(&indexBufferView);
+                cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+                cmdList->SetGraphicsRootConstantBufferView(kImageDrawUniformsRootParam,
+                                                           imageDrawUniformsAddress +
+                                                               batch.imageDrawDataOffset);
+                cmdList->DrawIndexedInstanced(batch.elementCount, 1, batch.baseElement, 0, 0);
+                break;
+            }
+            case DrawType::plsAtomicResolve:
+                assert(state.desc->interlockMode == pls::InterlockMode::atomics);
+                cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+                if (state.renderPassHasCoalescedResolveAndTransfer)
+                {
+                    // Bind the actual target texture as the render target for the PLS resolve, so
+                    // we don't have to copy to it after the render pass. The offscreen color
+                    // plane moves to COALESCED_OFFSCREEN_COLOR_PLANE_IDX, matching D3D11, so the
+                    // same shader works on both backends.
+                    assert(&batch == &state.desc->drawList->tail());
+                    assert(!state.renderDirectToRasterPipeline);
+                    cmdList->OMSetRenderTargets(1, &state.targetRTV, FALSE, nullptr);
+                    cmdList->SetGraphicsRootDescriptorTable(kPLSPlanesRootParam,
+                                                            state.resolveUAVTable);
+                }
+                cmdList->DrawInstanced(4, 1, 0, 0);
+                break;
+            case DrawType::plsAtomicInitialize:
+            case DrawType::stencilClipReset:
+                RIVE_UNREACHABLE();
+        }
+
+        if (batch.needsBarrier)
+        {
+            // D3D11 implicitly ordered UAV accesses between draws. D3D12 requires an explicit
+            // barrier.
+            uav_barrier(cmdList);
+        }
+    }
+}
+
+ID3D12GraphicsCommandList* PLSRenderContextD3D12Impl::recordFlush(
+    const FlushDescriptor& desc,
+    ID3D12GraphicsCommandList* cmdList)
+{
+    auto renderTarget = static_cast<PLSRenderTargetD3D12*>(desc.renderTarget);
+
+    recordPendingUploads(cmdList);
+
+    // Keep the render target alive until the GPU is done with it, in case the client releases it
+    // before the frame completes.
+    renderTarget->forEachTexture(
+        [this](ID3D12Resource* tex) { retainUntilFrameCompletes(ComPtr<ID3D12Pageable>(tex)); });
+
+    // Allocate every descriptor this flush needs at once, so they all land in the same heap.
+    UINT imageDescriptorCount = 0;
+    for (const DrawBatch& batch : *desc.drawList)
+    {
+        if (batch.elementCount != 0 && batch.imageTexture != nullptr)
+        {
+            ++imageDescriptorCount;
+        }
+    }
+    DescriptorRange descriptors = allocateDescriptors(kFlushDescriptorCount + imageDescriptorCount);
+    auto cpuDescriptor = [&descriptors, this](UINT idx) {
+        return offset_handle(descriptors.cpuHandle, idx, m_cbvSrvUavDescriptorSize);
+    };
+    auto gpuDescriptor = [&descriptors, this](UINT idx) {
+        return offset_handle(descriptors.gpuHandle, idx, m_cbvSrvUavDescriptorSize);
+    };
+
+    // Resource texture SRVs. D3D12 requires every descriptor in a bound table to be initialized,
+    // so textures that don't exist yet get null descriptors.
+    {
+        D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{};
+        srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+        srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+        srvDesc.Texture2D.MipLevels = 1;
+        srvDesc.Format = DXGI_FORMAT_R32G32B32A32_UINT;
+        m_gpu->CreateShaderResourceView(m_tessTexture.Get(),
+                                        &srvDesc,
+                                        cpuDescriptor(kTessTextureDescriptorIdx));
+        srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        m_gpu->CreateShaderResourceView(m_gradTexture.Get(),
+                                        &srvDesc,
+                                        cpuDescriptor(kGradTextureDescriptorIdx));
+        m_gpu->CreateShaderResourceView(nullptr,
+                                        &srvDesc,
+                                        cpuDescriptor(kNullImageTextureDescriptorIdx));
+    }
+
+    bool renderDirectToRasterPipeline =
+        desc.interlockMode == InterlockMode::atomics &&
+        !(desc.combinedShaderFeatures & ShaderFeatures::ENABLE_ADVANCED_BLEND);
+    bool renderPassHasCoalescedResolveAndTransfer =
+        desc.interlockMode == pls::InterlockMode::atomics && !renderDirectToRasterPipeline &&
+        !renderTarget->targetTextureSupportsUAV();
+
+    // PLS plane UAVs. Copy them into the shader-visible heap from the render target's
+    // non-shader-visible heap.
+    {
+        D3D12_UNORDERED_ACCESS_VIEW_DESC nullUAVDesc{};
+        nullUAVDesc.Format = DXGI_FORMAT_R32_UINT;
+        nullUAVDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
+        auto copyOrNullUAV = [&](UINT dstIdx, D3D12_CPU_DESCRIPTOR_HANDLE* src) {
+            if (src != nullptr)
+            {
+                m_gpu->CopyDescriptorsSimple(1,
+                                             cpuDescriptor(dstIdx),
+                                             *src,
+                                             D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+            }
+            else
+            {
+                m_gpu->CreateUnorderedAccessView(nullptr,
+                                                 nullptr,
+                                                 &nullUAVDesc,
+                                                 cpuDescriptor(dstIdx));
+            }
+        };
+        D3D12_CPU_DESCRIPTOR_HANDLE targetUAV = renderTarget->targetUAV();
+        D3D12_CPU_DESCRIPTOR_HANDLE coverageUAV = renderTarget->coverageUAV();
+        D3D12_CPU_DESCRIPTOR_HANDLE clipUAV = renderTarget->clipUAV();
+        D3D12_CPU_DESCRIPTOR_HANDLE scratchColorUAV;
+        if (desc.interlockMode == pls::InterlockMode::rasterOrdering)
+        {
+            // Atomic mode doesn't use the scratchColor.
+            scratchColorUAV = renderTarget->scratchColorUAV();
+        }
+        copyOrNullUAV(kPLSPlaneDescriptorsIdx + COLOR_PLANE_IDX,
+                      renderDirectToRasterPipeline ? nullptr : &targetUAV);
+        copyOrNullUAV(kPLSPlaneDescriptorsIdx + COVERAGE_PLANE_IDX, &coverageUAV);
+        copyOrNullUAV(kPLSPlaneDescriptorsIdx + CLIP_PLANE_IDX, &clipUAV);
+        copyOrNullUAV(kPLSPlaneDescriptorsIdx + SCRATCH_COLOR_PLANE_IDX,
+                      desc.interlockMode == pls::InterlockMode::rasterOrdering ? &scratchColorUAV
+                                                                               : nullptr);
+        if (renderPassHasCoalescedResolveAndTransfer)
+        {
+            // Bind the target UAV (for reading) to a different slot for the resolve, matching the
+            // D3D11 coalesced resolve shader.
+            static_assert(COALESCED_OFFSCREEN_COLOR_PLANE_IDX == SCRATCH_COLOR_PLANE_IDX);
+            copyOrNullUAV(kResolvePLSPlaneDescriptorsIdx + COLOR_PLANE_IDX, nullptr);
+            copyOrNullUAV(kResolvePLSPlaneDescriptorsIdx + COVERAGE_PLANE_IDX, &coverageUAV);
+            copyOrNullUAV(kResolvePLSPlaneDescriptorsIdx + CLIP_PLANE_IDX, &clipUAV);
+            copyOrNullUAV(kResolvePLSPlaneDescriptorsIdx + COALESCED_OFFSCREEN_COLOR_PLANE_IDX,
+                          &targetUAV);
+        }
+        else
+        {
+            for (UINT i = 0; i < kPLSPlaneCount; ++i)
+            {
+                copyOrNullUAV(kResolvePLSPlaneDescriptorsIdx + i, nullptr);
+            }
+        }
+    }
+
+    bindFlushResources(cmdList, desc);
+
+    // Render the complex color ramps to the gradient texture.
+    if (desc.complexGradSpanCount > 0)
+    {
+        transition_resource(cmdList,
+                            m_gradTexture.Get(),
+                            &m_gradTextureState,
+                            D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+        D3D12_VERTEX_BUFFER_VIEW gradSpanBufferView = {
+            ring_d3d12(gradSpanBufferRing())->submittedGPUAddress(),
+            static_cast<UINT>(gradSpanBufferRing()->capacityInBytes()),
+            sizeof(GradientSpan)};
+        cmdList->IASetVertexBuffers(0, 1, &gradSpanBufferView);
+        cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+        cmdList->SetPipelineState(m_colorRampPipeline.Get());
+
+        D3D12_VIEWPORT viewport = {0,
+                                   static_cast<float>(desc.complexGradRowsTop),
+                                   static_cast<float>(kGradTextureWidth),
+                                   static_cast<float>(desc.complexGradRowsHeight),
+                                   0,
+                                   1};
+        cmdList->RSSetViewports(1, &viewport);
+        D3D12_RECT scissor = {0,
+                              static_cast<LONG>(desc.complexGradRowsTop),
+                              static_cast<LONG>(kGradTextureWidth),
+                              static_cast<LONG>(desc.complexGradRowsTop +
+                                                desc.complexGradRowsHeight)};
+        cmdList->RSSetScissorRects(1, &scissor);
+
+        D3D12_CPU_DESCRIPTOR_HANDLE gradTextureRTV =
+            offset_handle(m_resourceTextureRTVHeap->GetCPUDescriptorHandleForHeapStart(),
+                          kGradTextureRTVIdx,
+                          m_rtvDescriptorSize);
+        cmdList->OMSetRenderTargets(1, &gradTextureRTV, FALSE, nullptr);
+
+        cmdList->DrawInstanced(4, desc.complexGradSpanCount, 0, desc.firstComplexGradSpan);
+    }
+
+    // Copy the simple color ramps to the gradient texture.
+    if (desc.simpleGradTexelsHeight > 0)
+    {
+        assert(desc.simpleGradTexelsHeight * desc.simpleGradTexelsWidth * 4 <=
+               simpleColorRampsBufferRing()->capacityInBytes());
+        constexpr static UINT kGradRowPitch = kGradTextureWidth * 4;
+        static_assert(kGradRowPitch % D3D12_TEXTURE_DATA_PITCH_ALIGNMENT == 0);
+        size_t simpleGradDataSize = (desc.simpleGradTexelsHeight - 1) * kGradRowPitch +
+                                    desc.simpleGradTexelsWidth * 4;
+        UploadAllocation upload =
+            allocateUploadMemory(simpleGradDataSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+        memcpy(upload.data,
+               heap_buffer_contents(simpleColorRampsBufferRing()) +
+                   desc.simpleGradDataOffsetInBytes,
+               simpleGradDataSize);
+
+        transition_resource(cmdList,
+                            m_gradTexture.Get(),
+                            &m_gradTextureState,
+                            D3D12_RESOURCE_STATE_COPY_DEST);
+
+        D3D12_TEXTURE_COPY_LOCATION dstLocation{};
+        dstLocation.pResource = m_gradTexture.Get();
+        dstLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        dstLocation.SubresourceIndex = 0;
+
+        D3D12_TEXTURE_COPY_LOCATION srcLocation{};
+        srcLocation.pResource = upload.buffer;
+        srcLocation.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+        srcLocation.PlacedFootprint.Offset = upload.offset;
+        srcLocation.PlacedFootprint.Footprint.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        srcLocation.PlacedFootprint.Footprint.Width = desc.simpleGradTexelsWidth;
+        srcLocation.PlacedFootprint.Footprint.Height = desc.simpleGradTexelsHeight;
+        srcLocation.PlacedFootprint.Footprint.Depth = 1;
+        srcLocation.PlacedFootprint.Footprint.RowPitch = kGradRowPitch;
+
+        cmdList->CopyTextureRegion(&dstLocation, 0, 0, 0, &srcLocation, nullptr);
+    }
+
+    // Tessellate all curves into vertices in the tessellation texture.
+    if (desc.tessVertexSpanCount > 0)
+    {
+        transition_resource(cmdList,
+                            m_tessTexture.Get(),
+                            &m_tessTextureState,
+                            D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+        D3D12_VERTEX_BUFFER_VIEW tessSpanBufferView = {
+            ring_d3d12(tessSpanBufferRing())->submittedGPUAddress(),
+            static_cast<UINT>(tessSpanBufferRing()->capacityInBytes()),
+            sizeof(TessVertexSpan)};
+        cmdList->IASetVertexBuffers(0, 1, &tessSpanBufferView);
+        D3D12_INDEX_BUFFER_VIEW tessSpanIndexBufferView = {
+            m_tessSpanIndexBuffer->GetGPUVirtualAddress(),
+            sizeof(pls::kTessSpanIndices),
+            DXGI_FORMAT_R16_UINT};
+        cmdList->IASetIndexBuffer(&tessSpanIndexBufferView);
+        cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        cmdList->SetPipelineState(m_tessellatePipeline.Get());
+
+        D3D12_VIEWPORT viewport = {0,
+                                   0,
+                                   static_cast<float>(kTessTextureWidth),
+                                   static_cast<float>(desc.tessDataHeight),
+                                   0,
+                                   1};
+        cmdList->RSSetViewports(1, &viewport);
+        D3D12_RECT scissor = {0,
+                              0,
+                              static_cast<LONG>(kTessTextureWidth),
+                              static_cast<LONG>(desc.tessDataHeight)};
+        cmdList->RSSetScissorRects(1, &scissor);
+
+        D3D12_CPU_DESCRIPTOR_HANDLE tessTextureRTV =
+            offset_handle(m_resourceTextureRTVHeap->GetCPUDescriptorHandleForHeapStart(),
+                          kTessTextureRTVIdx,
+                          m_rtvDescriptorSize);
+        cmdList->OMSetRenderTargets(1, &tessTextureRTV, FALSE, nullptr);
+
+        cmdList->DrawIndexedInstanced(std::size(pls::kTessSpanIndices),
+                                      desc.tessVertexSpanCount,
+                                      0,
+                                      0,
+                                      desc.firstTessVertexSpan);
+    }
+
+    // Transition the resource textures for reading in the draw pass.
+    if (m_gradTexture != nullptr)
+    {
+        transition_resource(cmdList,
+                            m_gradTexture.Get(),
+                            &m_gradTextureState,
+                            D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    }
+    if (m_tessTexture != nullptr)
+    {
+        transition_resource(cmdList,
+                            m_tessTexture.Get(),
+                            &m_tessTextureState,
+                            D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+    }
+
+    // Setup and clear the PLS textures.
+    ID3D12Resource* colorPlaneTexture = nullptr;
+    if (renderDirectToRasterPipeline)
+    {
+        renderTarget->transitionTargetTexture(cmdList, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    }
+    else if (renderTarget->targetTextureSupportsUAV())
+    {
+        renderTarget->transitionTargetTexture(cmdList, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+        colorPlaneTexture = renderTarget->targetTexture();
+    }
+    else
+    {
+        if (desc.colorLoadAction == pls::LoadAction::preserveRenderTarget)
+        {
+            // We're rendering to an offscreen UAV and preserving the target. Copy the target
+            // texture over.
+            renderTarget->transitionOffscreenTexture(cmdList, D3D12_RESOURCE_STATE_COPY_DEST);
+            renderTarget->transitionTargetTexture(cmdList, D3D12_RESOURCE_STATE_COPY_SOURCE);
+            copy_sub_rect(cmdList,
+                          renderTarget->offscreenTexture(),
+                          renderTarget->targetTexture(),
+                          desc.renderTargetUpdateBounds);
+        }
+        renderTarget->transitionOffscreenTexture(cmdList, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+        colorPlaneTexture = renderTarget->offscreenTexture();
+    }
+    if (renderPassHasCoalescedResolveAndTransfer)
+    {
+        // The resolve writes the target texture as a render target.
+        renderTarget->transitionTargetTexture(cmdList, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    }
+
+    // The previous flush's draws may still be accessing the PLS planes.
+    uav_barrier(cmdList);
+
+    // Only clear the pixels this flush updates. (See FlushDescriptor::hasPartialUpdateBounds.)
+    const IAABB& updateBounds = desc.renderTargetUpdateBounds;
+    D3D12_RECT updateRect = {updateBounds.left,
+                             updateBounds.top,
+                             updateBounds.right,
+                             updateBounds.bottom};
+    UINT clearRectCount = desc.hasPartialUpdateBounds ? 1 : 0;
+    const D3D12_RECT* clearRects = desc.hasPartialUpdateBounds ? &updateRect : nullptr;
+
+    D3D12_CPU_DESCRIPTOR_HANDLE targetRTV = renderTarget->targetRTV();
+    if (desc.colorLoadAction == pls::LoadAction::clear)
+    {
+        if (renderDirectToRasterPipeline)
+        {
+            float clearColor4f[4];
+            UnpackColorToRGBA32F(desc.clearColor, clearColor4f);
+            cmdList->ClearRenderTargetView(targetRTV, clearColor4f, clearRectCount, clearRects);
+        }
+        else if (m_d3dCapabilities.supportsTypedUAVLoadStore)
+        {
+            float clearColor4f[4];
+            UnpackColorToRGBA32F(desc.clearColor, clearColor4f);
+            cmdList->ClearUnorderedAccessViewFloat(
+                gpuDescriptor(kPLSPlaneDescriptorsIdx + COLOR_PLANE_IDX),
+                renderTarget->targetUAV(),
+                colorPlaneTexture,
+                clearColor4f,
+                clearRectCount,
+                clearRects);
+        }
+        else
+        {
+            UINT clearColorui[4] = {pls::SwizzleRiveColorToRGBA(desc.clearColor)};
+            cmdList->ClearUnorderedAccessViewUint(
+                gpuDescriptor(kPLSPlaneDescriptorsIdx + COLOR_PLANE_IDX),
+                renderTarget->targetUAV(),
+                colorPlaneTexture,
+                clearColorui,
+                clearRectCount,
+                clearRects);
+        }
+    }
+    {
+        UINT coverageClear[4]{desc.coverageClearValue};
+        cmdList->ClearUnorderedAccessViewUint(
+            gpuDescriptor(kPLSPlaneDescriptorsIdx + COVERAGE_PLANE_IDX),
+            renderTarget->coverageUAV(),
+            renderTarget->coverageTexture(),
+            coverageClear,
+            clearRectCount,
+            clearRects);
+    }
+    if (desc.combinedShaderFeatures & pls::ShaderFeatures::ENABLE_CLIPPING)
+    {
+        constexpr static UINT kZero[4]{};
+        cmdList->ClearUnorderedAccessViewUint(
+            gpuDescriptor(kPLSPlaneDescriptorsIdx + CLIP_PLANE_IDX),
+            renderTarget->clipUAV(),
+            renderTarget->clipTexture(),
+            kZero,
+            clearRectCount,
+            clearRects);
+    }
+
+    // Order the clears before the draws.
+    uav_barrier(cmdList);
+
+    // Resolve every batch's pipeline and image texture descriptor up front, on this thread, so
+    // the draw pass can be recorded on any thread.
+    m_resolvedDrawBatches.clear();
+    UINT nextImageDescriptorIdx = kFlushDescriptorCount;
+    for (const DrawBatch& batch : *desc.drawList)
+    {
+        if (batch.elementCount == 0)
+        {
+            continue;
+        }
+
+        DrawType drawType = batch.drawType;
+        auto shaderFeatures = desc.interlockMode == pls::InterlockMode::atomics
+                                  ? desc.combinedShaderFeatures
+                                  : batch.shaderFeatures;
+        bool isCoalescedResolve =
+            drawType == pls::DrawType::plsAtomicResolve && renderPassHasCoalescedResolveAndTransfer;
+        auto pixelShaderMiscFlags = isCoalescedResolve
+                                        ? pls::ShaderMiscFlags::coalescedResolveAndTransfer
+                                        : pls::ShaderMiscFlags::none;
+        DrawPipelineOptions pipelineOptions = {
+            .renderTargetFormat = renderDirectToRasterPipeline || isCoalescedResolve
+                                      ? renderTarget->targetRTVFormat()
+                                      : DXGI_FORMAT_UNKNOWN,
+            .srcOverBlend = renderDirectToRasterPipeline,
+            .wireframe = desc.wireframe && drawType != pls::DrawType::plsAtomicResolve,
+        };
+
+        ResolvedDrawBatch& resolvedBatch = m_resolvedDrawBatches.emplace_back();
+        resolvedBatch.batch = &batch;
+        resolvedBatch.pipeline = findOrCreateDrawPipeline(drawType,
+                                                          shaderFeatures,
+                                                          desc.interlockMode,
+                                                          pixelShaderMiscFlags,
+                                                          pipelineOptions);
+        resolvedBatch.imageTextureTable = gpuDescriptor(kNullImageTextureDescriptorIdx);
+        if (auto imageTextureD3D12 = static_cast<const PLSTextureD3D12Impl*>(batch.imageTexture))
+        {
+            m_gpu->CreateShaderResourceView(imageTextureD3D12->texture(),
+                                            nullptr,
+                                            cpuDescriptor(nextImageDescriptorIdx));
+            resolvedBatch.imageTextureTable = gpuDescriptor(nextImageDescriptorIdx);
+            ++nextImageDescriptorIdx;
+            retainUntilFrameCompletes(ComPtr<ID3D12Pageable>(imageTextureD3D12->texture()));
+        }
+        if (batch.drawType == DrawType::imageMesh)
+        {
+            for (const RenderBuffer* buffer :
+                 {batch.vertexBuffer, batch.uvBuffer, batch.indexBuffer})
+            {
+                if (auto bufferD3D12 = lite_rtti_cast<const RenderBufferD3D12Impl*>(buffer))
+                {
+                    retainUntilFrameCompletes(ComPtr<ID3D12Pageable>(bufferD3D12->buffer()));
+                }
+            }
+        }
+    }
+    assert(nextImageDescriptorIdx == kFlushDescriptorCount + imageDescriptorCount);
+
+    DrawPassState drawPassState = {
+        .desc = &desc,
+        .renderTarget = renderTarget,
+        .targetRTV = targetRTV,
+        .renderDirectToRasterPipeline = renderDirectToRasterPipeline,
+        .renderPassHasCoalescedResolveAndTransfer = renderPassHasCoalescedResolveAndTransfer,
+        .resourceTextureTable = gpuDescriptor(kTessTextureDescriptorIdx),
+        .nullImageTextureTable = gpuDescriptor(kNullImageTextureDescriptorIdx),
+        .plsUAVTable = gpuDescriptor(kPLSPlaneDescriptorsIdx),
+        .resolveUAVTable = gpuDescriptor(kResolvePLSPlaneDescriptorsIdx),
+    };
+
+    // Execute the DrawList.
+    const ResolvedDrawBatch* batchesBegin = m_resolvedDrawBatches.data();
+    const ResolvedDrawBatch* batchesEnd = batchesBegin + m_resolvedDrawBatches.size();
+    size_t chunkCount =
+        m_parallelCommandRecorder != nullptr && desc.externalCommandBuffer == nullptr
+            ? std::min(m_parallelCommandRecorder->workerCount(),
+                       m_resolvedDrawBatches.size() / kMinBatchesPerParallelChunk)
+            : 0;
+    if (chunkCount > 1)
+    {
+        // Record the draw pass into separate command lists in parallel. They execute in order,
+        // between everything this list has recorded so far and everything it records next.
+        VERIFY_OK(cmdList->Close());
+        m_pendingCommandLists.push_back(cmdList);
+
+        size_t batchesPerChunk = (m_resolvedDrawBatches.size() + chunkCount - 1) / chunkCount;
+        m_parallelCommandRecorder->record(
+            m_bufferRingIdx,
+            chunkCount,
+            [&](ID3D12GraphicsCommandList* chunkCmdList, size_t chunkIdx) {
+                const ResolvedDrawBatch* chunkBegin = batchesBegin + chunkIdx * batchesPerChunk;
+                const ResolvedDrawBatch* chunkEnd =
+                    std::min(chunkBegin + batchesPerChunk, batchesEnd);
+                bindFlushResources(chunkCmdList, desc);
+                bindDrawPassState(chunkCmdList, drawPassState);
+                recordDrawBatches(chunkCmdList, drawPassState, chunkBegin, chunkEnd);
+            },
+            &m_pendingCommandLists);
+
+        cmdList = m_commandListPool->beginCommandList(m_bufferRingIdx);
+        bindFlushResources(cmdList, desc);
+    }
+    else
+    {
+        bindDrawPassState(cmdList, drawPassState);
+        recordDrawBatches(cmdList, drawPassState, batchesBegin, batchesEnd);
+    }
+
+    if (desc.interlockMode == pls::InterlockMode::rasterOrdering &&
+        !renderTarget->targetTextureSupportsUAV())
+    {
+        // We rendered to an offscreen UAV and did not resolve to the renderTarget. Copy back to the
+        // main target.
+        assert(!renderDirectToRasterPipeline);
+        assert(!renderPassHasCoalescedResolveAndTransfer);
+        renderTarget->transitionOffscreenTexture(cmdList, D3D12_RESOURCE_STATE_COPY_SOURCE);
+        renderTarget->transitionTargetTexture(cmdList, D3D12_RESOURCE_STATE_COPY_DEST);
+        copy_sub_rect(cmdList,
+                      renderTarget->targetTexture(),
+                      renderTarget->offscreenTexture(),
+                      desc.renderTargetUpdateBounds);
+    }
+
+    renderTarget->restoreTargetTextureClientState(cmdList);
+    return cmdList;
+}
+
+void PLSRenderContextD3D12Impl::flush(const FlushDescriptor& desc)
+{
+    if (desc.externalCommandBuffer != nullptr)
+    {
+        // Record into the client's command list, which the client submits itself.
+        auto cmdList = static_cast<ID3D12GraphicsCommandList*>(desc.externalCommandBuffer);
+        ID3D12GraphicsCommandList* finalCmdList = recordFlush(desc, cmdList);
+        assert(finalCmdList == cmdList); // We only record in parallel into our own command lists.
+        (void)finalCmdList;
+        if (desc.isFinalFlushOfFrame)
+        {
+            assert(desc.frameCompletionFence != nullptr);
+            m_frameCompletionFences[m_bufferRingIdx] = ref_rcp(desc.frameCompletionFence);
+        }
+        return;
+    }
+
+    assert(m_commandListPool != nullptr); // The context needs a queue to record on its own.
+    if (m_internalCommandList == nullptr)
+    {
+        assert(desc.isFirstFlushOfFrame);
+        m_internalCommandList = m_commandListPool->beginCommandList(m_bufferRingIdx);
+    }
+    m_internalCommandList = recordFlush(desc, m_internalCommandList);
+
+    if (desc.isFinalFlushOfFrame)
+    {
+        VERIFY_OK(m_internalCommandList->Close());
+        m_pendingCommandLists.push_back(m_internalCommandList);
+        m_internalCommandList = nullptr;
+        m_queue->ExecuteCommandLists(static_cast<UINT>(m_pendingCommandLists.size()),
+                                     m_pendingCommandLists.data());
+        m_pendingCommandLists.clear();
+
+        rcp<D3D12FrameFence> frameFence = makeFrameFence();
+        VERIFY_OK(m_queue->Signal(frameFence->d3dFence(), frameFence->value()));
+        m_frameCompletionFences[m_bufferRingIdx] = std::move(frameFence);
+    }
+}
+} // namespace rive::pls
@@ -4,28 +4,18 @@
 
 #include "rive/pls/d3d/pls_render_context_d3d_impl.hpp"
 
+#include "d3d_shaders.hpp"
 #include "rive/pls/pls_image.hpp"
 #include "shaders/constants.glsl"
 
-#include <D3DCompiler.h>
 #include <sstream>
 
-#include "generated/shaders/advanced_blend.glsl.hpp"
-#include "generated/shaders/atomic_draw.glsl.hpp"
 #include "generated/shaders/color_ramp.glsl.hpp"
 #include "generated/shaders/constants.glsl.hpp"
 #include "generated/shaders/common.glsl.hpp"
-#include "generated/shaders/draw_image_mesh.glsl.hpp"
-#include "generated/shaders/draw_path_common.glsl.hpp"
-#include "generated/shaders/draw_path.glsl.hpp"
 #include "generated/shaders/hlsl.glsl.hpp"
 #include "generated/shaders/tessellate.glsl.hpp"
 
-// D3D11 doesn't let us bind the framebuffer UAV to slot 0 when there is a color output. Use the
-// (unused in this case) SCRATCH_COLOR_PLANE_IDX instead when we are doing a coalesced resolve
-// and transfer.
-#define COALESCED_OFFSCREEN_COLOR_PLANE_IDX SCRATCH_COLOR_PLANE_IDX
-
 constexpr static UINT kPatchVertexDataSlot = 0;
 constexpr static UINT kTriangleVertexDataSlot = 1;
 constexpr static UINT kImageRectVertexDataSlot = 2;
@@ -133,17 +123,27 @@ std::unique_ptr<PLSRenderContext> PLSRenderContextD3DImpl::MakeContext(
     d3dCapabilities.isIntel = contextOptions.isIntel;
 
     auto plsContextImpl = std::unique_ptr<PLSRenderContextD3DImpl>(
-        new PLSRenderContextD3DImpl(std::move(gpu), std::move(gpuContext), d3dCapabilities));
+        new PLSRenderContextD3DImpl(std::move(gpu),
+                                    std::move(gpuContext),
+                                    d3dCapabilities,
+                                    contextOptions.pipelineBlobCache));
+    plsContextImpl->setBufferRingSize(contextOptions.bufferRingSize);
     return std::make_unique<PLSRenderContext>(std::move(plsContextImpl));
 }
 
 PLSRenderContextD3DImpl::PLSRenderContextD3DImpl(ComPtr<ID3D11Device> gpu,
                                                  ComPtr<ID3D11DeviceContext> gpuContext,
-                                                 const D3DCapabilities& d3dCapabilities) :
-    m_d3dCapabilities(d3dCapabilities), m_gpu(std::move(gpu)), m_gpuContext(std::move(gpuContext))
+                                                 const D3DCapabilities& d3dCapabilities,
+                                                 PipelineBlobCache* pipelineBlobCache) :
+    m_d3dCapabilities(d3dCapabilities),
+    m_pipelineBlobCache(pipelineBlobCache),
+    m_gpu(std::move(gpu)),
+    m_gpuContext(std::move(gpuContext))
 {
     m_platformFeatures.invertOffscreenY = true;
     m_platformFeatures.supportsRasterOrdering = d3dCapabilities.supportsRasterizerOrderedViews;
+    m_platformFeatures.supportsWideContourIDs = true;
+    m_platformFeatures.maxTextureSize = D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION;
 
     // Create a default raster state for path and offscreen draws.
     D3D11_RASTERIZER_DESC rasterDesc;
@@ -398,43 +398,11 @@ ComPtr<ID3DBlob> PLSRenderContextD3DImpl::compileSourceToBlob(const char* shader
                                                               const char* entrypoint,
                                                               const char* target)
 {
-    std::ostringstream source;
-    source << "#define " << shaderTypeDefineName << '\n';
-    source << commonSource;
-
-    const std::string& sourceStr = source.str();
-    ComPtr<ID3DBlob> blob;
-    ComPtr<ID3DBlob> errors;
-    HRESULT hr = D3DCompile(sourceStr.c_str(),
-                            sourceStr.length(),
-                            nullptr,
-                            nullptr,
-                            nullptr,
-                            entrypoint,
-                            target,
-                            D3DCOMPILE_ENABLE_STRICTNESS,
-                            0,
-                            &blob,
-                            &errors);
-    if (errors && errors->GetBufferPointer())
-    {
-        fprintf(stderr, "Errors or warnings compiling shader.\n");
-        int l = 1;
-        std::stringstream stream(sourceStr);
-        std::string lineStr;
-        while (std::getline(stream, lineStr, '\n'))
-        {
-            fprintf(stderr, "%4i| %s\n", l++, lineStr.c_str());
-        }
-        fprintf(stderr, "%s\n", reinterpret_cast<char*>(errors->GetBufferPointer()));
-        exit(-1);
-    }
-    if (FAILED(hr))
-    {
-        fprintf(stderr, "Failed to compile shader.\n");
-        exit(-1);
-    }
-    return blob;
+    return d3dutil::CompileSourceToBlob(m_pipelineBlobCache,
+                                        shaderTypeDefineName,
+                                        commonSource,
+                                        entrypoint,
+                                        target);
 }
 
 class RenderBufferD3DImpl : public lite_rtti_override<RenderBuffer, RenderBufferD3DImpl>
@@ -583,7 +551,7 @@ protected:
                   UINT bindFlags,
                   UINT elementSizeInBytes,
                   UINT miscFlags) :
-        BufferRing(capacityInBytes), m_gpuContext(plsImpl->gpuContext())
+        BufferRing(capacityInBytes, plsImpl->bufferRingSize()), m_gpuContext(plsImpl->gpuContext())
     {
         D3D11_BUFFER_DESC desc{};
         desc.ByteWidth = capacityInBytes;
@@ -593,7 +561,7 @@ protected:
         desc.StructureByteStride = elementSizeInBytes;
         desc.MiscFlags = miscFlags;
 
-        for (size_t i = 0; i < kBufferRingSize; ++i)
+        for (int i = 0; i < ringSize(); ++i)
         {
             VERIFY_OK(plsImpl->gpu()->CreateBuffer(&desc,
                                                    nullptr,
@@ -631,7 +599,7 @@ protected:
     }
 
     ComPtr<ID3D11DeviceContext> m_gpuContext;
-    ComPtr<ID3D11Buffer> m_buffers[kBufferRingSize];
+    ComPtr<ID3D11Buffer> m_buffers[kMaxBufferRingSize];
 };
 
 class StructuredBufferRingD3D : public BufferRingD3D
@@ -937,10 +905,11 @@ ID3D11ShaderResourceView* PLSRenderContextD3DImpl::replaceStructuredBufferSRV(
                      firstHighLevelStruct * kStructIndexMultiplier);
 }
 
-void PLSRenderContextD3DImpl::setPipelineLayoutAndShaders(DrawType drawType,
-                                                          pls::ShaderFeatures shaderFeatures,
-                                                          pls::InterlockMode interlockMode,
-                                                          pls::ShaderMiscFlags pixelShaderMiscFlags)
+std::pair<const PLSRenderContextD3DImpl::DrawVertexShader*, ID3D11PixelShader*>
+PLSRenderContextD3DImpl::findOrCompileDrawShaders(DrawType drawType,
+                                                  pls::ShaderFeatures shaderFeatures,
+                                                  pls::InterlockMode interlockMode,
+                                                  pls::ShaderMiscFlags pixelShaderMiscFlags)
 {
     uint32_t vertexShaderKey = pls::ShaderUniqueKey(drawType,
                                                     shaderFeatures & kVertexShaderFeaturesMask,
@@ -954,118 +923,43 @@ void PLSRenderContextD3DImpl::setPipelineLayoutAndShaders(DrawType drawType,
 
     if (vertexEntry == m_drawVertexShaders.end() || pixelEntry == m_drawPixelShaders.end())
     {
-        std::ostringstream s;
-        for (size_t i = 0; i < kShaderFeatureCount; ++i)
-        {
-            ShaderFeatures feature = static_cast<ShaderFeatures>(1 << i);
-            if (shaderFeatures & feature)
+        // Only build the source if one of the shaders wasn't precompiled offline.
+        std::string shader;
+        auto findOrCompileBytecode = [&](d3dutil::PrecompiledShaderBytecode precompiled,
+                                         const char* shaderTypeDefineName,
+                                         const char* entrypoint,
+                                         const char* target,
+                                         ComPtr<ID3DBlob>* compiledBlob) {
+            if (precompiled.data != nullptr)
             {
-                s << "#define " << GetShaderFeatureGLSLName(feature) << " 1\n";
+                return precompiled;
             }
-        }
-        if (m_d3dCapabilities.supportsRasterizerOrderedViews)
-        {
-            if ((interlockMode == pls::InterlockMode::rasterOrdering &&
-                 drawType != DrawType::interiorTriangulation) ||
-                drawType == DrawType::imageMesh)
+            if (shader.empty())
             {
-                s << "#define " << GLSL_ENABLE_RASTERIZER_ORDERED_VIEWS << '\n';
+                shader = d3dutil::BuildDrawShaderSource(drawType,
+                                                        shaderFeatures,
+                                                        interlockMode,
+                                                        pixelShaderMiscFlags,
+                                                        m_d3dCapabilities);
             }
-        }
-        if (m_d3dCapabilities.supportsTypedUAVLoadStore)
-        {
-            s << "#define " << GLSL_ENABLE_TYPED_UAV_LOAD_STORE << '\n';
-        }
-        if (m_d3dCapabilities.supportsMin16Precision)
-        {
-            s << "#define " << GLSL_ENABLE_MIN_16_PRECISION << '\n';
-        }
-        if (interlockMode == pls::InterlockMode::atomics &&
-            !(shaderFeatures & ShaderFeatures::ENABLE_ADVANCED_BLEND))
-        {
-            s << "#define " << GLSL_FIXED_FUNCTION_COLOR_BLEND << '\n';
-        }
-        if (pixelShaderMiscFlags & pls::ShaderMiscFlags::coalescedResolveAndTransfer)
-        {
-            s << "#define " << GLSL_COALESCED_PLS_RESOLVE_AND_TRANSFER << '\n';
-            s << "#define " << GLSL_COLOR_PLANE_IDX_OVERRIDE << ' '
-              << COALESCED_OFFSCREEN_COLOR_PLANE_IDX << '\n';
-        }
-        switch (drawType)
-        {
-            case DrawType::midpointFanPatches:
-            case DrawType::outerCurvePatches:
-                s << "#define " << GLSL_DRAW_PATH << '\n';
-                break;
-            case DrawType::interiorTriangulation:
-                s << "#define " << GLSL_DRAW_INTERIOR_TRIANGLES << '\n';
-                break;
-            case DrawType::imageRect:
-                assert(interlockMode == pls::InterlockMode::atomics);
-                s << "#define " << GLSL_DRAW_IMAGE << '\n';
-                s << "#define " << GLSL_DRAW_IMAGE_RECT << '\n';
-                break;
-            case DrawType::imageMesh:
-                s << "#define " << GLSL_DRAW_IMAGE << '\n';
-                s << "#define " << GLSL_DRAW_IMAGE_MESH << '\n';
-                break;
-            case DrawType::plsAtomicResolve:
-                assert(interlockMode == pls::InterlockMode::atomics);
-                s << "#define " << GLSL_DRAW_RENDER_TARGET_UPDATE_BOUNDS << '\n';
-                s << "#define " << GLSL_RESOLVE_PLS << '\n';
-                break;
-            case DrawType::plsAtomicInitialize:
-            case DrawType::stencilClipReset:
-                RIVE_UNREACHABLE();
-        }
-        s << glsl::constants << '\n';
-        s << glsl::hlsl << '\n';
-        s << glsl::common << '\n';
-        if (shaderFeatures & ShaderFeatures::ENABLE_ADVANCED_BLEND)
-        {
-            s << glsl::advanced_blend << '\n';
-        }
-        switch (drawType)
-        {
-            case DrawType::midpointFanPatches:
-            case DrawType::outerCurvePatches:
-                s << pls::glsl::draw_path_common << '\n';
-                s << (interlockMode == pls::InterlockMode::rasterOrdering ? pls::glsl::draw_path
-                                                                          : pls::glsl::atomic_draw)
-                  << '\n';
-                break;
-            case DrawType::interiorTriangulation:
-                s << pls::glsl::draw_path_common << '\n';
-                s << (interlockMode == pls::InterlockMode::rasterOrdering ? pls::glsl::draw_path
-                                                                          : pls::glsl::atomic_draw)
-                  << '\n';
-                break;
-            case DrawType::imageRect:
-                assert(interlockMode == pls::InterlockMode::atomics);
-                s << pls::glsl::atomic_draw << '\n';
-                break;
-            case DrawType::imageMesh:
-                s << (interlockMode == pls::InterlockMode::rasterOrdering
-                          ? pls::glsl::draw_image_mesh
-                          : pls::glsl::atomic_draw)
-                  << '\n';
-                break;
-            case DrawType::plsAtomicResolve:
-            case DrawType::stencilClipReset:
-                assert(interlockMode == pls::InterlockMode::atomics);
-                s << pls::glsl::atomic_draw << '\n';
-                break;
-            case DrawType::plsAtomicInitialize:
-                RIVE_UNREACHABLE();
-        }
-
-        const std::string shader = s.str();
+            *compiledBlob = compileSourceToBlob(shaderTypeDefineName, shader, entrypoint, target);
+            return d3dutil::PrecompiledShaderBytecode{(*compiledBlob)->GetBufferPointer(),
+                                                      (*compiledBlob)->GetBufferSize()};
+        };
 
         if (vertexEntry == m_drawVertexShaders.end())
         {
             DrawVertexShader drawVertexShader;
-            ComPtr<ID3DBlob> blob =
-                compileSourceToBlob(GLSL_VERTEX, shader.c_str(), GLSL_drawVertexMain, "vs_5_0");
+            ComPtr<ID3DBlob> blob;
+            d3dutil::PrecompiledShaderBytecode bytecode = findOrCompileBytecode(
+                d3dutil::FindPrecompiledDrawVertexShader(drawType,
+                                                         shaderFeatures,
+                                                         interlockMode,
+                                                         m_d3dCapabilities),
+                GLSL_VERTEX,
+                GLSL_drawVertexMain,
+                "vs_5_0",
+                &blob);
             D3D11_INPUT_ELEMENT_DESC layoutDesc[2];
             size_t vertexAttribCount;
             switch (drawType)
@@ -1134,11 +1028,11 @@ void PLSRenderContextD3DImpl::setPipelineLayoutAndShaders(DrawType drawType,
             }
             VERIFY_OK(m_gpu->CreateInputLayout(layoutDesc,
                                                vertexAttribCount,
-                                               blob->GetBufferPointer(),
-                                               blob->GetBufferSize(),
+                                               bytecode.data,
+                                               bytecode.size,
                                                &drawVertexShader.layout));
-            VERIFY_OK(m_gpu->CreateVertexShader(blob->GetBufferPointer(),
-                                                blob->GetBufferSize(),
+            VERIFY_OK(m_gpu->CreateVertexShader(bytecode.data,
+                                                bytecode.size,
                                                 nullptr,
                                                 &drawVertexShader.shader));
             vertexEntry = m_drawVertexShaders.insert({vertexShaderKey, drawVertexShader}).first;
@@ -1147,19 +1041,55 @@ void PLSRenderContextD3DImpl::setPipelineLayoutAndShaders(DrawType drawType,
         if (pixelEntry == m_drawPixelShaders.end())
         {
             ComPtr<ID3D11PixelShader> pixelShader;
-            ComPtr<ID3DBlob> blob =
-                compileSourceToBlob(GLSL_FRAGMENT, shader.c_str(), GLSL_drawFragmentMain, "ps_5_0");
-            VERIFY_OK(m_gpu->CreatePixelShader(blob->GetBufferPointer(),
-                                               blob->GetBufferSize(),
-                                               nullptr,
-                                               &pixelShader));
+            ComPtr<ID3DBlob> blob;
+            d3dutil::PrecompiledShaderBytecode bytecode = findOrCompileBytecode(
+                d3dutil::FindPrecompiledDrawPixelShader(drawType,
+                                                        shaderFeatures,
+                                                        interlockMode,
+                                                        pixelShaderMiscFlags,
+                                                        m_d3dCapabilities),
+                GLSL_FRAGMENT,
+                GLSL_drawFragmentMain,
+                "ps_5_0",
+                &blob);
+            VERIFY_OK(
+                m_gpu->CreatePixelShader(bytecode.data, bytecode.size, nullptr, &pixelShader));
             pixelEntry = m_drawPixelShaders.insert({pixelShaderKey, pixelShader}).first;
         }
     }
 
-    m_gpuContext->IASetInputLayout(vertexEntry->second.layout.Get());
-    m_gpuContext->VSSetShader(vertexEntry->second.shader.Get(), NULL, 0);
-    m_gpuContext->PSSetShader(pixelEntry->second.Get(), NULL, 0);
+    return {&vertexEntry->second, pixelEntry->second.Get()};
+}
+
+void PLSRenderContextD3DImpl::setPipelineLayoutAndShaders(DrawType drawType,
+                                                          pls::ShaderFeatures shaderFeatures,
+                                                          pls::InterlockMode interlockMode,
+                                                          pls::ShaderMiscFlags pixelShaderMiscFlags)
+{
+    auto [vertexShader, pixelShader] =
+        findOrCompileDrawShaders(drawType, shaderFeatures, interlockMode, pixelShaderMiscFlags);
+    m_gpuContext->IASetInputLayout(vertexShader->layout.Get());
+    m_gpuContext->VSSetShader(vertexShader->shader.Get(), NULL, 0);
+    m_gpuContext->PSSetShader(pixelShader, NULL, 0);
+}
+
+void PLSRenderContextD3DImpl::precompileShaders(Span<const pls::ShaderVariant> variants)
+{
+    // D3D11 has no background compilation, so this compiles synchronously. Bytecode is still
+    // stored in m_pipelineBlobCache (if any) for subsequent runs.
+    for (const pls::ShaderVariant& variant : variants)
+    {
+        if (variant.interlockMode == pls::InterlockMode::depthStencil ||
+            variant.drawType == DrawType::plsAtomicInitialize ||
+            variant.drawType == DrawType::stencilClipReset)
+        {
+            continue;
+        }
+        findOrCompileDrawShaders(variant.drawType,
+                                 variant.shaderFeatures,
+                                 variant.interlockMode,
+                                 pls::ShaderMiscFlags::none);
+    }
 }
 
 static ID3D11Buffer* submitted_buffer(const BufferRing* bufferRing)
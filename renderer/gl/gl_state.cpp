@@ -8,6 +8,9 @@
 
 namespace rive::pls
 {
+static_assert(GLState::kMaxTrackedTextureUnits <= 16, "m_validState.boundTextureIDs is 16 bits");
+static_assert(GLState::kMaxTrackedBufferBindings <= 16, "m_validState.*BufferRanges are 16 bits");
+
 void GLState::invalidate()
 {
     // Invalidate all cached state.
@@ -116,6 +119,10 @@ void GLState::setBlendEquation(BlendMode blendMode)
         m_blendEquation = blendEquation;
         m_validState.blendEquation = true;
     }
+    else
+    {
+        ++m_skippedCallCount;
+    }
 }
 
 void GLState::disableBlending()
@@ -126,6 +133,10 @@ void GLState::disableBlending()
         m_blendEquation = GL_NONE;
         m_validState.blendEquation = true;
     }
+    else
+    {
+        ++m_skippedCallCount;
+    }
 }
 
 void GLState::setWriteMasks(bool colorWriteMask, bool depthWriteMask, GLuint stencilWriteMask)
@@ -147,16 +158,28 @@ void GLState::setWriteMasks(bool colorWriteMask, bool depthWriteMask, GLuint ste
             glColorMask(colorWriteMask, colorWriteMask, colorWriteMask, colorWriteMask);
             m_colorWriteMask = colorWriteMask;
         }
+        else
+        {
+            ++m_skippedCallCount;
+        }
         if (depthWriteMask != m_depthWriteMask)
         {
             glDepthMask(depthWriteMask);
             m_depthWriteMask = depthWriteMask;
         }
+        else
+        {
+            ++m_skippedCallCount;
+        }
         if (stencilWriteMask != m_stencilWriteMask)
         {
             glStencilMask(stencilWriteMask);
             m_stencilWriteMask = stencilWriteMask;
         }
+        else
+        {
+            ++m_skippedCallCount;
+        }
     }
 }
 
@@ -179,6 +202,70 @@ void GLState::setCullFace(GLenum cullFace)
         m_cullFace = cullFace;
         m_validState.cullFace = true;
     }
+    else
+    {
+        ++m_skippedCallCount;
+    }
+}
+
+void GLState::setViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    if (!m_validState.viewport || x != m_viewport[0] || y != m_viewport[1] ||
+        width != m_viewport[2] || height != m_viewport[3])
+    {
+        glViewport(x, y, width, height);
+        m_viewport[0] = x;
+        m_viewport[1] = y;
+        m_viewport[2] = width;
+        m_viewport[3] = height;
+        m_validState.viewport = true;
+    }
+    else
+    {
+        ++m_skippedCallCount;
+    }
+}
+
+void GLState::setScissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    if (!m_validState.scissorEnabled || !m_scissorEnabled)
+    {
+        glEnable(GL_SCISSOR_TEST);
+        m_scissorEnabled = true;
+        m_validState.scissorEnabled = true;
+    }
+    else
+    {
+        ++m_skippedCallCount;
+    }
+    if (!m_validState.scissor || x != m_scissor[0] || y != m_scissor[1] ||
+        width != m_scissor[2] || height != m_scissor[3])
+    {
+        glScissor(x, y, width, height);
+        m_scissor[0] = x;
+        m_scissor[1] = y;
+        m_scissor[2] = width;
+        m_scissor[3] = height;
+        m_validState.scissor = true;
+    }
+    else
+    {
+        ++m_skippedCallCount;
+    }
+}
+
+void GLState::disableScissor()
+{
+    if (!m_validState.scissorEnabled || m_scissorEnabled)
+    {
+        glDisable(GL_SCISSOR_TEST);
+        m_scissorEnabled = false;
+        m_validState.scissorEnabled = true;
+    }
+    else
+    {
+        ++m_skippedCallCount;
+    }
 }
 
 void GLState::bindProgram(GLuint programID)
@@ -189,6 +276,10 @@ void GLState::bindProgram(GLuint programID)
         m_boundProgramID = programID;
         m_validState.boundProgramID = true;
     }
+    else
+    {
+        ++m_skippedCallCount;
+    }
 }
 
 void GLState::bindVAO(GLuint vao)
@@ -199,6 +290,10 @@ void GLState::bindVAO(GLuint vao)
         m_boundVAO = vao;
         m_validState.boundVAO = true;
     }
+    else
+    {
+        ++m_skippedCallCount;
+    }
 }
 
 void GLState::bindBuffer(GLenum target, GLuint bufferID)
@@ -216,6 +311,10 @@ void GLState::bindBuffer(GLenum target, GLuint bufferID)
                 m_boundArrayBufferID = bufferID;
                 m_validState.boundArrayBufferID = true;
             }
+            else
+            {
+                ++m_skippedCallCount;
+            }
             break;
         case GL_UNIFORM_BUFFER:
             if (!m_validState.boundUniformBufferID || bufferID != m_boundUniformBufferID)
@@ -224,6 +323,10 @@ void GLState::bindBuffer(GLenum target, GLuint bufferID)
                 m_boundUniformBufferID = bufferID;
                 m_validState.boundUniformBufferID = true;
             }
+            else
+            {
+                ++m_skippedCallCount;
+            }
             break;
         case GL_PIXEL_UNPACK_BUFFER:
             if (!m_validState.boundPixelUnpackBufferID || bufferID != m_boundPixelUnpackBufferID)
@@ -232,10 +335,123 @@ void GLState::bindBuffer(GLenum target, GLuint bufferID)
                 m_boundPixelUnpackBufferID = bufferID;
                 m_validState.boundPixelUnpackBufferID = true;
             }
+            else
+            {
+                ++m_skippedCallCount;
+            }
             break;
     }
 }
 
+void GLState::bindBufferRange(GLenum target,
+                              GLuint index,
+                              GLuint bufferID,
+                              GLintptr offset,
+                              GLsizeiptr size)
+{
+    BufferRange* ranges;
+    uint16_t* validRanges;
+    switch (target)
+    {
+        case GL_UNIFORM_BUFFER:
+            ranges = m_uniformBufferRanges;
+            validRanges = &m_validState.uniformBufferRanges;
+            break;
+        case GL_SHADER_STORAGE_BUFFER:
+            ranges = m_storageBufferRanges;
+            validRanges = &m_validState.storageBufferRanges;
+            break;
+        default:
+            ranges = nullptr;
+            validRanges = nullptr;
+            break;
+    }
+    if (ranges == nullptr || index >= kMaxTrackedBufferBindings)
+    {
+        glBindBufferRange(target, index, bufferID, offset, size);
+    }
+    else if (!(*validRanges & (1 << index)) || bufferID != ranges[index].bufferID ||
+             offset != ranges[index].offset || size != ranges[index].size)
+    {
+        glBindBufferRange(target, index, bufferID, offset, size);
+        ranges[index] = {bufferID, offset, size};
+        *validRanges |= 1 << index;
+    }
+    else
+    {
+        ++m_skippedCallCount;
+        return;
+    }
+    // glBindBufferRange() also binds the buffer to the generic binding point.
+    if (target == GL_UNIFORM_BUFFER)
+    {
+        m_boundUniformBufferID = bufferID;
+        m_validState.boundUniformBufferID = true;
+    }
+}
+
+void GLState::bindFramebuffer(GLenum target, GLuint framebufferID)
+{
+    bool needsDraw = target != GL_READ_FRAMEBUFFER;
+    bool needsRead = target != GL_DRAW_FRAMEBUFFER;
+    if ((needsDraw && (!m_validState.boundDrawFramebufferID ||
+                       framebufferID != m_boundDrawFramebufferID)) ||
+        (needsRead &&
+         (!m_validState.boundReadFramebufferID || framebufferID != m_boundReadFramebufferID)))
+    {
+        glBindFramebuffer(target, framebufferID);
+        if (needsDraw)
+        {
+            m_boundDrawFramebufferID = framebufferID;
+            m_validState.boundDrawFramebufferID = true;
+        }
+        if (needsRead)
+        {
+            m_boundReadFramebufferID = framebufferID;
+            m_validState.boundReadFramebufferID = true;
+        }
+    }
+    else
+    {
+        ++m_skippedCallCount;
+    }
+}
+
+void GLState::bindTexture(GLenum textureUnit, GLuint textureID)
+{
+    setActiveTexture(textureUnit);
+    uint32_t unitIdx = textureUnit - GL_TEXTURE0;
+    if (unitIdx >= kMaxTrackedTextureUnits)
+    {
+        glBindTexture(GL_TEXTURE_2D, textureID);
+    }
+    else if (!(m_validState.boundTextureIDs & (1 << unitIdx)) ||
+             textureID != m_boundTextureIDs[unitIdx])
+    {
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        m_boundTextureIDs[unitIdx] = textureID;
+        m_validState.boundTextureIDs |= 1 << unitIdx;
+    }
+    else
+    {
+        ++m_skippedCallCount;
+    }
+}
+
+void GLState::setActiveTexture(GLenum textureUnit)
+{
+    if (!m_validState.activeTextureUnit || textureUnit != m_activeTextureUnit)
+    {
+        glActiveTexture(textureUnit);
+        m_activeTextureUnit = textureUnit;
+        m_validState.activeTextureUnit = true;
+    }
+    else
+    {
+        ++m_skippedCallCount;
+    }
+}
+
 void GLState::deleteProgram(GLuint programID)
 {
     glDeleteProgram(programID);
@@ -259,5 +475,36 @@ void GLState::deleteBuffer(GLuint bufferID)
         m_boundUniformBufferID = 0;
     if (m_validState.boundPixelUnpackBufferID && m_boundPixelUnpackBufferID == bufferID)
         m_boundPixelUnpackBufferID = 0;
+    for (uint32_t i = 0; i < kMaxTrackedBufferBindings; ++i)
+    {
+        if ((m_validState.uniformBufferRanges & (1 << i)) &&
+            m_uniformBufferRanges[i].bufferID == bufferID)
+            m_uniformBufferRanges[i] = {0, 0, 0};
+        if ((m_validState.storageBufferRanges & (1 << i)) &&
+            m_storageBufferRanges[i].bufferID == bufferID)
+            m_storageBufferRanges[i] = {0, 0, 0};
+    }
+}
+
+void GLState::deleteTexture(GLuint textureID)
+{
+    glDeleteTextures(1, &textureID);
+    for (uint32_t i = 0; i < kMaxTrackedTextureUnits; ++i)
+    {
+        if ((m_validState.boundTextureIDs & (1 << i)) && m_boundTextureIDs[i] == textureID)
+            m_boundTextureIDs[i] = 0;
+    }
+}
+
+void GLState::invalidateFramebufferBindings()
+{
+    m_validState.boundDrawFramebufferID = false;
+    m_validState.boundReadFramebufferID = false;
+}
+
+void GLState::invalidateTextureBindings()
+{
+    m_validState.activeTextureUnit = false;
+    m_validState.boundTextureIDs = 0;
 }
 } // namespace rive::pls
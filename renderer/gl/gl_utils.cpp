@@ -95,6 +95,8 @@ GLuint CompileShader(GLuint type,
     return CompileRawGLSL(type, shaderSource.str().c_str());
 }
 
+const char* ShaderPreludeSource() { return rive::pls::glsl::glsl; }
+
 [[nodiscard]] GLuint CompileRawGLSL(GLuint shaderType, const char* rawGLSL)
 {
     GLuint shader = glCreateShader(shaderType);
@@ -139,6 +141,11 @@ GLuint CompileShader(GLuint type,
 void LinkProgram(GLuint program)
 {
     glLinkProgram(program);
+    VerifyProgramLinked(program);
+}
+
+void VerifyProgramLinked(GLuint program)
+{
 #ifdef DEBUG
     GLint isLinked = 0;
     glGetProgramiv(program, GL_LINK_STATUS, &isLinked);
@@ -13,6 +13,13 @@ glDrawElementsInstancedBaseVertexBaseInstanceEXT = nullptr;
 PFNGLFRAMEBUFFERFETCHBARRIERQCOMPROC glFramebufferFetchBarrierQCOM = nullptr;
 PFNGLFRAMEBUFFERTEXTURE2DMULTISAMPLEEXTPROC glFramebufferTexture2DMultisampleEXT = nullptr;
 PFNGLRENDERBUFFERSTORAGEMULTISAMPLEEXTPROC glRenderbufferStorageMultisampleEXT = nullptr;
+PFNGLGETQUERYOBJECTUI64VEXTPROC glGetQueryObjectui64vEXT = nullptr;
+PFNGLBUFFERSTORAGEEXTPROC glBufferStorageEXT = nullptr;
+PFNGLEGLIMAGETARGETTEXTURE2DOESPROC glEGLImageTargetTexture2DOES = nullptr;
+PFNGLMULTIDRAWELEMENTSINSTANCEDANGLEPROC glMultiDrawElementsInstancedANGLE = nullptr;
+PFNGLBLENDBARRIERKHRPROC glBlendBarrierKHR = nullptr;
+PFNGLPUSHDEBUGGROUPKHRPROC glPushDebugGroupKHR = nullptr;
+PFNGLPOPDEBUGGROUPKHRPROC glPopDebugGroupKHR = nullptr;
 
 void LoadGLESExtensions(const GLCapabilities& extensions)
 {
@@ -48,4 +55,40 @@ void LoadGLESExtensions(const GLCapabilities& extensions)
                 "glRenderbufferStorageMultisampleEXT");
         loadedExtensions.EXT_multisampled_render_to_texture = true;
     }
+    if (extensions.EXT_disjoint_timer_query && !loadedExtensions.EXT_disjoint_timer_query)
+    {
+        glGetQueryObjectui64vEXT =
+            (PFNGLGETQUERYOBJECTUI64VEXTPROC)eglGetProcAddress("glGetQueryObjectui64vEXT");
+        loadedExtensions.EXT_disjoint_timer_query = true;
+    }
+    if (extensions.EXT_buffer_storage && !loadedExtensions.EXT_buffer_storage)
+    {
+        glBufferStorageEXT = (PFNGLBUFFERSTORAGEEXTPROC)eglGetProcAddress("glBufferStorageEXT");
+        loadedExtensions.EXT_buffer_storage = true;
+    }
+    if (extensions.OES_EGL_image && !loadedExtensions.OES_EGL_image)
+    {
+        glEGLImageTargetTexture2DOES =
+            (PFNGLEGLIMAGETARGETTEXTURE2DOESPROC)eglGetProcAddress("glEGLImageTargetTexture2DOES");
+        loadedExtensions.OES_EGL_image = true;
+    }
+    if (extensions.ANGLE_multi_draw && !loadedExtensions.ANGLE_multi_draw)
+    {
+        glMultiDrawElementsInstancedANGLE =
+            (PFNGLMULTIDRAWELEMENTSINSTANCEDANGLEPROC)eglGetProcAddress(
+                "glMultiDrawElementsInstancedANGLE");
+        loadedExtensions.ANGLE_multi_draw = true;
+    }
+    if (extensions.KHR_blend_equation_advanced && !loadedExtensions.KHR_blend_equation_advanced)
+    {
+        glBlendBarrierKHR = (PFNGLBLENDBARRIERKHRPROC)eglGetProcAddress("glBlendBarrierKHR");
+        loadedExtensions.KHR_blend_equation_advanced = true;
+    }
+    if (extensions.KHR_debug && !loadedExtensions.KHR_debug)
+    {
+        glPushDebugGroupKHR =
+            (PFNGLPUSHDEBUGGROUPKHRPROC)eglGetProcAddress("glPushDebugGroupKHR");
+        glPopDebugGroupKHR = (PFNGLPOPDEBUGGROUPKHRPROC)eglGetProcAddress("glPopDebugGroupKHR");
+        loadedExtensions.KHR_debug = true;
+    }
 }
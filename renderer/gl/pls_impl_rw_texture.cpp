@@ -29,6 +29,10 @@ class PLSRenderContextGLImpl::PLSImplRWTexture : public PLSRenderContextGLImpl::
                capabilities.INTEL_fragment_shader_ordering;
     }
 
+    // All clears and blits below are glClearBuffer*() and glBlitFramebuffer(), which respect the
+    // scissor.
+    bool supportsTileBinnedRendering() const override { return true; }
+
     void activatePixelLocalStorage(PLSRenderContextGLImpl* plsContextImpl,
                                    const FlushDescriptor& desc) override
     {
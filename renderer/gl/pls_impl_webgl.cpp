@@ -90,6 +90,38 @@ EM_JS(void, provokingVertexWEBGL, (EMSCRIPTEN_WEBGL_CONTEXT_HANDLE gl, GLenum pr
     }
 });
 
+EM_JS(bool, enable_WEBGL_multi_draw, (EMSCRIPTEN_WEBGL_CONTEXT_HANDLE gl), {
+    gl = GL.getContext(gl).GLctx;
+    gl.md = gl["getExtension"]("WEBGL_multi_draw");
+    return Boolean(gl.md);
+});
+
+EM_JS(void,
+      multiDrawElementsInstancedWEBGL,
+      (EMSCRIPTEN_WEBGL_CONTEXT_HANDLE gl,
+       GLenum mode,
+       uint32_t countsIdx,
+       GLenum type,
+       uint32_t offsetsIdx,
+       uint32_t instanceCountsIdx,
+       GLsizei drawcount),
+      {
+          const md = GL.getContext(gl).GLctx.md;
+          if (md)
+          {
+              const heap = Module["HEAP32"];
+              md["multiDrawElementsInstancedWEBGL"](mode,
+                                                    heap,
+                                                    countsIdx,
+                                                    type,
+                                                    heap,
+                                                    offsetsIdx,
+                                                    heap,
+                                                    instanceCountsIdx,
+                                                    drawcount);
+          }
+      });
+
 bool webgl_enable_WEBGL_shader_pixel_local_storage_coherent()
 {
     return enable_WEBGL_shader_pixel_local_storage_coherent(emscripten_webgl_get_current_context());
@@ -100,6 +132,11 @@ bool webgl_enable_WEBGL_provoking_vertex()
     return enable_WEBGL_provoking_vertex(emscripten_webgl_get_current_context());
 }
 
+bool webgl_enable_WEBGL_multi_draw()
+{
+    return enable_WEBGL_multi_draw(emscripten_webgl_get_current_context());
+}
+
 void glFramebufferTexturePixelLocalStorageANGLE(GLint plane,
                                                 GLuint backingtexture,
                                                 GLint level,
@@ -140,6 +177,25 @@ void glProvokingVertexANGLE(GLenum provokeMode)
 {
     provokingVertexWEBGL(emscripten_webgl_get_current_context(), provokeMode);
 }
+
+void glMultiDrawElementsInstancedANGLE(GLenum mode,
+                                       const GLsizei* counts,
+                                       GLenum type,
+                                       const GLvoid* const* indices,
+                                       const GLsizei* instanceCounts,
+                                       GLsizei drawcount)
+{
+    // WebGL takes byte offsets into the element array buffer, which are the same 32-bit values as
+    // the "pointers" in 'indices' on wasm32.
+    static_assert(sizeof(const GLvoid*) == sizeof(int32_t));
+    multiDrawElementsInstancedWEBGL(emscripten_webgl_get_current_context(),
+                                    mode,
+                                    reinterpret_cast<uintptr_t>(counts) / sizeof(int32_t),
+                                    type,
+                                    reinterpret_cast<uintptr_t>(indices) / sizeof(int32_t),
+                                    reinterpret_cast<uintptr_t>(instanceCounts) / sizeof(int32_t),
+                                    drawcount);
+}
 #endif // RIVE_WEBGL
 
 namespace rive::pls
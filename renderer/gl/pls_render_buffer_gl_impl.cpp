@@ -18,10 +18,11 @@ PLSRenderBufferGLImpl::PLSRenderBufferGLImpl(RenderBufferType type,
 PLSRenderBufferGLImpl::PLSRenderBufferGLImpl(RenderBufferType RenderBufferType,
                                              RenderBufferFlags renderBufferFlags,
                                              size_t sizeInBytes,
-                                             rcp<GLState> state) :
+                                             rcp<GLState> state,
+                                             int bufferRingSize) :
     PLSRenderBufferGLImpl(RenderBufferType, renderBufferFlags, sizeInBytes)
 {
-    init(std::move(state));
+    init(std::move(state), bufferRingSize);
 }
 
 PLSRenderBufferGLImpl::~PLSRenderBufferGLImpl()
@@ -35,27 +36,34 @@ PLSRenderBufferGLImpl::~PLSRenderBufferGLImpl()
     }
 }
 
-void PLSRenderBufferGLImpl::init(rcp<GLState> state)
+void PLSRenderBufferGLImpl::init(rcp<GLState> state, int bufferRingSize)
 {
     assert(!m_state);
     assert(!m_bufferIDs[0]);
+    assert(pls::kMinBufferRingSize <= bufferRingSize && bufferRingSize <= pls::kMaxBufferRingSize);
     m_state = std::move(state);
-    int bufferCount =
-        (flags() & RenderBufferFlags::mappedOnceAtInitialization) ? 1 : pls::kBufferRingSize;
-    glGenBuffers(bufferCount, m_bufferIDs.data());
+    m_bufferCount =
+        (flags() & RenderBufferFlags::mappedOnceAtInitialization) ? 1 : bufferRingSize;
+    // The buffers in the ring get created the first time they're mapped. Content that is only
+    // written once or twice, like the UVs and indices of a deforming mesh, then never allocates
+    // the whole ring.
+    createBufferAt(0);
+}
+
+void PLSRenderBufferGLImpl::createBufferAt(int bufferIdx)
+{
+    assert(m_bufferIDs[bufferIdx] == 0);
+    glGenBuffers(1, &m_bufferIDs[bufferIdx]);
     m_state->bindVAO(0);
-    for (int i = 0; i < bufferCount; ++i)
-    {
-        m_state->bindBuffer(m_target, m_bufferIDs[i]);
-        glBufferData(m_target,
-                     sizeInBytes(),
-                     nullptr,
-                     (flags() & RenderBufferFlags::mappedOnceAtInitialization) ? GL_STATIC_DRAW
-                                                                               : GL_DYNAMIC_DRAW);
-    }
+    m_state->bindBuffer(m_target, m_bufferIDs[bufferIdx]);
+    glBufferData(m_target,
+                 sizeInBytes(),
+                 nullptr,
+                 (flags() & RenderBufferFlags::mappedOnceAtInitialization) ? GL_STATIC_DRAW
+                                                                           : GL_DYNAMIC_DRAW);
 }
 
-std::array<GLuint, pls::kBufferRingSize> PLSRenderBufferGLImpl::detachBuffers()
+std::array<GLuint, pls::kMaxBufferRingSize> PLSRenderBufferGLImpl::detachBuffers()
 {
     auto detachedBuffers = m_bufferIDs;
     m_bufferIDs.fill(0);
@@ -64,7 +72,11 @@ std::array<GLuint, pls::kBufferRingSize> PLSRenderBufferGLImpl::detachBuffers()
 
 void* PLSRenderBufferGLImpl::onMap()
 {
-    m_submittedBufferIdx = (m_submittedBufferIdx + 1) % pls::kBufferRingSize;
+    m_submittedBufferIdx = (m_submittedBufferIdx + 1) % m_bufferCount;
+    if (m_bufferIDs[m_submittedBufferIdx] == 0)
+    {
+        createBufferAt(m_submittedBufferIdx);
+    }
     if (!canMapBuffer())
     {
         if (!m_fallbackMappedMemory)
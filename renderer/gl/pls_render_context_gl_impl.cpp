@@ -8,6 +8,7 @@
 #include "rive/pls/gl/pls_render_target_gl.hpp"
 #include "rive/pls/pls_draw.hpp"
 #include "rive/pls/pls_image.hpp"
+#include "rive/pls/pls_trace.hpp"
 #include "shaders/constants.glsl"
 
 #include "generated/shaders/advanced_blend.glsl.hpp"
@@ -65,18 +66,82 @@ namespace rive::pls
 {
 PLSRenderContextGLImpl::PLSRenderContextGLImpl(const char* rendererString,
                                                GLCapabilities capabilities,
-                                               std::unique_ptr<PLSImpl> plsImpl) :
+                                               std::unique_ptr<PLSImpl> plsImpl,
+                                               const ContextOptions& contextOptions) :
     m_capabilities(capabilities),
+    m_synchronousShaderCompilations(contextOptions.synchronousShaderCompilations),
     m_plsImpl(std::move(plsImpl)),
+    m_pipelineBlobCache(contextOptions.pipelineBlobCache),
     m_state(make_rcp<GLState>(m_capabilities))
 
 {
+    setBufferRingSize(contextOptions.bufferRingSize);
+
+#ifndef RIVE_WEBGL
+    if (m_capabilities.EXT_buffer_storage)
+    {
+        m_frameSyncs = make_rcp<GLFrameSyncs>();
+    }
+#endif
+
+#ifdef RIVE_WEBGL
+    // WebGL doesn't have program binaries.
+    m_pipelineBlobCache = nullptr;
+#else
+    if (m_pipelineBlobCache != nullptr)
+    {
+        GLint programBinaryFormatCount = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &programBinaryFormatCount);
+        if (programBinaryFormatCount <= 0)
+        {
+            // The driver can't give us program binaries.
+            m_pipelineBlobCache = nullptr;
+        }
+    }
+    if (m_pipelineBlobCache != nullptr)
+    {
+        // Program binaries are only valid on the exact driver that produced them. Every program we
+        // compile also depends on the context version and the shader prelude.
+        m_driverBlobKeyHash.write(reinterpret_cast<const char*>(glGetString(GL_VENDOR)))
+            .write(rendererString)
+            .write(reinterpret_cast<const char*>(glGetString(GL_VERSION)))
+            .write(m_capabilities.contextVersionMajor)
+            .write(m_capabilities.contextVersionMinor)
+            .write(glutils::ShaderPreludeSource());
+    }
+#endif
+
     m_platformFeatures.supportsPixelLocalStorage = m_plsImpl != nullptr;
     m_platformFeatures.supportsRasterOrdering = m_platformFeatures.supportsPixelLocalStorage &&
                                                 m_plsImpl->supportsRasterOrdering(m_capabilities);
+    m_platformFeatures.supportsTileBinnedRendering =
+        m_platformFeatures.supportsPixelLocalStorage && m_plsImpl->supportsTileBinnedRendering();
+    // Pick how depthStencil mode reads the destination color for advanced blend modes, from
+    // cheapest to most expensive.
     if (m_capabilities.KHR_blend_equation_advanced_coherent)
+    {
+        m_msaaAdvancedBlend = MSAAAdvancedBlend::khrCoherent;
+    }
+    else if (m_capabilities.EXT_shader_framebuffer_fetch &&
+             strstr(rendererString, "Adreno") == nullptr)
+    {
+        // EXT_shader_framebuffer_fetch is costly on Qualcomm. Prefer barriers there.
+        m_msaaAdvancedBlend = MSAAAdvancedBlend::framebufferFetch;
+    }
+    else if (m_capabilities.KHR_blend_equation_advanced)
+    {
+        m_msaaAdvancedBlend = MSAAAdvancedBlend::khrWithBarriers;
+    }
+    else
+    {
+        m_msaaAdvancedBlend = MSAAAdvancedBlend::dstColorTexture;
+    }
+    if (m_msaaAdvancedBlend == MSAAAdvancedBlend::khrCoherent ||
+        m_msaaAdvancedBlend == MSAAAdvancedBlend::khrWithBarriers)
     {
         m_platformFeatures.supportsKHRBlendEquations = true;
+        m_platformFeatures.khrBlendEquationsNeedBarriers =
+            m_msaaAdvancedBlend == MSAAAdvancedBlend::khrWithBarriers;
     }
     if (m_capabilities.EXT_clip_cull_distance)
     {
@@ -86,6 +151,13 @@ PLSRenderContextGLImpl::PLSRenderContextGLImpl(const char* rendererString,
     {
         m_platformFeatures.supportsBindlessTextures = true;
     }
+    // ETC2 is core in GLES 3.0, but WebGL (and ANGLE on desktop) may decompress it in software.
+    m_platformFeatures.supportsETC2Textures =
+        m_capabilities.isGLES && !m_capabilities.isANGLEOrWebGL;
+    m_platformFeatures.supportsASTCTextures = m_capabilities.KHR_texture_compression_astc_ldr;
+    m_platformFeatures.supportsBC7Textures =
+        m_capabilities.EXT_texture_compression_bptc ||
+        (!m_capabilities.isGLES && m_capabilities.isContextVersionAtLeast(4, 2));
     if (strstr(rendererString, "Apple") && strstr(rendererString, "Metal"))
     {
         // In Metal, non-flat varyings preserve their exact value if all vertices in the triangle
@@ -94,6 +166,15 @@ PLSRenderContextGLImpl::PLSRenderContextGLImpl(const char* rendererString,
         m_platformFeatures.avoidFlatVaryings = true;
     }
     m_platformFeatures.fragCoordBottomUp = true;
+    // ES 3.0 has unpackHalf2x16().
+    m_platformFeatures.supportsCompactTessVertexSpans = true;
+    m_platformFeatures.supportsResolutionScaling = true;
+    // Without storage buffers, the contour buffer is polyfilled by a size-limited texture.
+    m_platformFeatures.supportsWideContourIDs = m_capabilities.ARB_shader_storage_buffer_object;
+    GLint maxTextureSize, maxViewportDims[2];
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    glGetIntegerv(GL_MAX_VIEWPORT_DIMS, maxViewportDims);
+    m_platformFeatures.maxTextureSize = std::min(maxTextureSize, maxViewportDims[1]);
 
     std::vector<const char*> generalDefines;
     if (!m_capabilities.ARB_shader_storage_buffer_object)
@@ -123,32 +204,7 @@ PLSRenderContextGLImpl::PLSRenderContextGLImpl(const char* rendererString,
     glEnableVertexAttribArray(0);
     glVertexAttribDivisor(0, 1);
 
-    const char* tessellateSources[] = {glsl::constants, glsl::common, glsl::tessellate};
-    m_tessellateProgram.compileAndAttachShader(GL_VERTEX_SHADER,
-                                               generalDefines.data(),
-                                               generalDefines.size(),
-                                               tessellateSources,
-                                               std::size(tessellateSources),
-                                               m_capabilities);
-    m_tessellateProgram.compileAndAttachShader(GL_FRAGMENT_SHADER,
-                                               generalDefines.data(),
-                                               generalDefines.size(),
-                                               tessellateSources,
-                                               std::size(tessellateSources),
-                                               m_capabilities);
-    m_tessellateProgram.link();
-    m_state->bindProgram(m_tessellateProgram);
-    glUniformBlockBinding(m_tessellateProgram,
-                          glGetUniformBlockIndex(m_tessellateProgram, GLSL_FlushUniforms),
-                          FLUSH_UNIFORM_BUFFER_IDX);
-    if (!m_capabilities.ARB_shader_storage_buffer_object)
-    {
-        // Our GL driver doesn't support storage buffers. We polyfill these buffers as textures.
-        glUniform1i(glGetUniformLocation(m_tessellateProgram, GLSL_pathBuffer),
-                    kPLSTexIdxOffset + PATH_BUFFER_IDX);
-        glUniform1i(glGetUniformLocation(m_tessellateProgram, GLSL_contourBuffer),
-                    kPLSTexIdxOffset + CONTOUR_BUFFER_IDX);
-    }
+    compileTessellateProgram(&m_tessellateProgram, /*compactTessVertexSpans=*/false);
 
     m_state->bindVAO(m_tessellateVAO);
     for (int i = 0; i < 4; ++i)
@@ -164,6 +220,15 @@ PLSRenderContextGLImpl::PLSRenderContextGLImpl(const char* rendererString,
                  pls::kTessSpanIndices,
                  GL_STATIC_DRAW);
 
+    // CompactTessVertexSpans only have 3 attributes.
+    m_state->bindVAO(m_compactTessellateVAO);
+    for (int i = 0; i < 3; ++i)
+    {
+        glEnableVertexAttribArray(i);
+        glVertexAttribDivisor(i, 1);
+    }
+    m_state->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_tessSpanIndexBuffer);
+
     m_state->bindVAO(m_drawVAO);
 
     PatchVertex patchVertices[kPatchVertexBufferCount];
@@ -224,8 +289,16 @@ PLSRenderContextGLImpl::PLSRenderContextGLImpl(const char* rendererString,
 
 PLSRenderContextGLImpl::~PLSRenderContextGLImpl()
 {
-    glDeleteTextures(1, &m_gradientTexture);
-    glDeleteTextures(1, &m_tessVertexTexture);
+    m_state->deleteTexture(m_gradientTexture);
+    m_state->deleteTexture(m_tessVertexTexture);
+    for (const PendingGPUTimer& timer : m_pendingGPUTimers)
+    {
+        glDeleteQueries(1, &timer.query);
+    }
+    if (!m_availableGPUTimerQueries.empty())
+    {
+        glDeleteQueries(m_availableGPUTimerQueries.size(), m_availableGPUTimerQueries.data());
+    }
 
     // Because glutils wrappers delete GL objects that might affect bindings.
     m_state->invalidate();
@@ -233,13 +306,11 @@ PLSRenderContextGLImpl::~PLSRenderContextGLImpl()
 
 void PLSRenderContextGLImpl::invalidateGLState()
 {
-    glActiveTexture(GL_TEXTURE0 + kPLSTexIdxOffset + TESS_VERTEX_TEXTURE_IDX);
-    glBindTexture(GL_TEXTURE_2D, m_tessVertexTexture);
-
-    glActiveTexture(GL_TEXTURE0 + kPLSTexIdxOffset + GRAD_TEXTURE_IDX);
-    glBindTexture(GL_TEXTURE_2D, m_gradientTexture);
-
     m_state->invalidate();
+
+    m_state->bindTexture(GL_TEXTURE0 + kPLSTexIdxOffset + TESS_VERTEX_TEXTURE_IDX,
+                         m_tessVertexTexture);
+    m_state->bindTexture(GL_TEXTURE0 + kPLSTexIdxOffset + GRAD_TEXTURE_IDX, m_gradientTexture);
 }
 
 void PLSRenderContextGLImpl::unbindGLInternalResources()
@@ -249,11 +320,10 @@ void PLSRenderContextGLImpl::unbindGLInternalResources()
     m_state->bindBuffer(GL_ARRAY_BUFFER, 0);
     m_state->bindBuffer(GL_UNIFORM_BUFFER, 0);
     m_state->bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    m_state->bindFramebuffer(GL_FRAMEBUFFER, 0);
     for (int i = 0; i <= CONTOUR_BUFFER_IDX; ++i)
     {
-        glActiveTexture(GL_TEXTURE0 + kPLSTexIdxOffset + i);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        m_state->bindTexture(GL_TEXTURE0 + kPLSTexIdxOffset + i, 0);
     }
 }
 
@@ -261,7 +331,7 @@ rcp<RenderBuffer> PLSRenderContextGLImpl::makeRenderBuffer(RenderBufferType type
                                                            RenderBufferFlags flags,
                                                            size_t sizeInBytes)
 {
-    return make_rcp<PLSRenderBufferGLImpl>(type, flags, sizeInBytes, m_state);
+    return make_rcp<PLSRenderBufferGLImpl>(type, flags, sizeInBytes, m_state, bufferRingSize());
 }
 
 class PLSTextureGLImpl : public PLSTexture
@@ -307,8 +377,7 @@ rcp<PLSTexture> PLSRenderContextGLImpl::makeImageTexture(uint32_t width,
 {
     GLuint textureID;
     glGenTextures(1, &textureID);
-    glActiveTexture(GL_TEXTURE0 + kPLSTexIdxOffset + IMAGE_TEXTURE_IDX);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    m_state->bindTexture(GL_TEXTURE0 + kPLSTexIdxOffset + IMAGE_TEXTURE_IDX, textureID);
     glTexStorage2D(GL_TEXTURE_2D, mipLevelCount, GL_RGBA8, width, height);
     m_state->bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
     glTexSubImage2D(GL_TEXTURE_2D,
@@ -325,6 +394,56 @@ rcp<PLSTexture> PLSRenderContextGLImpl::makeImageTexture(uint32_t width,
     return adoptImageTexture(width, height, textureID);
 }
 
+rcp<PLSTexture> PLSRenderContextGLImpl::makeCompressedImageTexture(
+    uint32_t width,
+    uint32_t height,
+    uint32_t mipLevelCount,
+    pls::CompressedTextureFormat format,
+    const uint8_t data[])
+{
+    assert(m_platformFeatures.supportsCompressedTextureFormat(format));
+    GLenum internalformat;
+    switch (format)
+    {
+        case pls::CompressedTextureFormat::etc2RGBA8:
+            internalformat = GL_COMPRESSED_RGBA8_ETC2_EAC;
+            break;
+        case pls::CompressedTextureFormat::astc4x4:
+            internalformat = GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
+            break;
+        case pls::CompressedTextureFormat::bc7:
+            internalformat = GL_COMPRESSED_RGBA_BPTC_UNORM;
+            break;
+    }
+
+    GLuint textureID;
+    glGenTextures(1, &textureID);
+    m_state->bindTexture(GL_TEXTURE0 + kPLSTexIdxOffset + IMAGE_TEXTURE_IDX, textureID);
+    glTexStorage2D(GL_TEXTURE_2D, mipLevelCount, internalformat, width, height);
+    m_state->bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    // Compressed formats can't glGenerateMipmap(). Every level comes from the client, packed
+    // contiguously, base level first.
+    for (uint32_t level = 0; level < mipLevelCount; ++level)
+    {
+        uint32_t levelWidth = std::max(width >> level, 1u);
+        uint32_t levelHeight = std::max(height >> level, 1u);
+        size_t levelSizeInBytes = pls::CompressedTextureLevelSizeInBytes(levelWidth, levelHeight);
+        glCompressedTexSubImage2D(GL_TEXTURE_2D,
+                                  level,
+                                  0,
+                                  0,
+                                  levelWidth,
+                                  levelHeight,
+                                  internalformat,
+                                  static_cast<GLsizei>(levelSizeInBytes),
+                                  data);
+        data += levelSizeInBytes;
+    }
+    glutils::SetTexture2DSamplingParams(mipLevelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR,
+                                        GL_LINEAR);
+    return adoptImageTexture(width, height, textureID);
+}
+
 rcp<PLSTexture> PLSRenderContextGLImpl::adoptImageTexture(uint32_t width,
                                                           uint32_t height,
                                                           GLuint textureID)
@@ -332,24 +451,107 @@ rcp<PLSTexture> PLSRenderContextGLImpl::adoptImageTexture(uint32_t width,
     return make_rcp<PLSTextureGLImpl>(width, height, textureID, m_capabilities);
 }
 
+rcp<PLSRenderTarget> PLSRenderContextGLImpl::makeLayerRenderTarget(uint32_t width,
+                                                                   uint32_t height,
+                                                                   rcp<PLSTexture>* layerTexture)
+{
+    GLuint textureID;
+    glGenTextures(1, &textureID);
+    m_state->bindTexture(GL_TEXTURE0 + kPLSTexIdxOffset + IMAGE_TEXTURE_IDX, textureID);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+    glutils::SetTexture2DSamplingParams(GL_LINEAR, GL_LINEAR);
+    *layerTexture = adoptImageTexture(width, height, textureID);
+
+    auto renderTarget = make_rcp<TextureRenderTargetGL>(width, height);
+    renderTarget->setTargetTexture(textureID);
+    return ref_rcp<PLSRenderTarget>(renderTarget.get());
+}
+
 // BufferRingImpl in GL on a given buffer target. In order to support WebGL2, we don't do hardware
 // mapping.
+// Inserts a GLsync at the end of every frame, so persistently mapped buffers can tell when the GPU
+// is done reading them.
+class GLFrameSyncs : public RefCnt<GLFrameSyncs>
+{
+public:
+    ~GLFrameSyncs()
+    {
+        for (const PendingSync& pending : m_pendingSyncs)
+        {
+            glDeleteSync(pending.sync);
+        }
+    }
+
+    // Index of the frame currently being prepared.
+    uint64_t currentFrameIdx() const { return m_currentFrameIdx; }
+
+    // Called once the final flush of a frame has been issued.
+    void endFrame()
+    {
+        GLsync sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        m_pendingSyncs.push_back({m_currentFrameIdx, sync});
+        ++m_currentFrameIdx;
+        // Retire the syncs that have already signaled, so the queue doesn't grow when no buffer
+        // needs to wait.
+        while (m_pendingSyncs.size() > 1 &&
+               glClientWaitSync(m_pendingSyncs.front().sync, 0, 0) != GL_TIMEOUT_EXPIRED)
+        {
+            glDeleteSync(m_pendingSyncs.front().sync);
+            m_pendingSyncs.pop_front();
+        }
+    }
+
+    // Blocks until the GPU has finished every frame with an index less than 'frameCount'.
+    void waitForFrames(uint64_t frameCount)
+    {
+        while (!m_pendingSyncs.empty() && m_pendingSyncs.front().frameIdx < frameCount)
+        {
+            GLsync sync = m_pendingSyncs.front().sync;
+            GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+            while (glClientWaitSync(sync, flags, kSyncTimeoutNanoseconds) == GL_TIMEOUT_EXPIRED)
+            {
+                flags = 0; // Only flush the first time.
+            }
+            glDeleteSync(sync);
+            m_pendingSyncs.pop_front();
+        }
+    }
+
+private:
+    constexpr static GLuint64 kSyncTimeoutNanoseconds = 1000000000;
+
+    struct PendingSync
+    {
+        uint64_t frameIdx;
+        GLsync sync;
+    };
+    std::deque<PendingSync> m_pendingSyncs;
+    uint64_t m_currentFrameIdx = 0;
+};
+
 class BufferRingGLImpl : public BufferRing
 {
 public:
+    // If 'frameSyncs' is non-null, the buffers are allocated with immutable storage
+    // (EXT_buffer_storage) and mapped persistently.
     static std::unique_ptr<BufferRingGLImpl> Make(size_t capacityInBytes,
+                                                  int ringSize,
                                                   GLenum target,
-                                                  rcp<GLState> state)
+                                                  rcp<GLState> state,
+                                                  rcp<GLFrameSyncs> frameSyncs)
     {
-        return capacityInBytes != 0
-                   ? std::unique_ptr<BufferRingGLImpl>(
-                         new BufferRingGLImpl(target, capacityInBytes, std::move(state)))
-                   : nullptr;
+        return capacityInBytes != 0 ? std::unique_ptr<BufferRingGLImpl>(
+                                          new BufferRingGLImpl(target,
+                                                               capacityInBytes,
+                                                               ringSize,
+                                                               std::move(state),
+                                                               std::move(frameSyncs)))
+                                    : nullptr;
     }
 
     ~BufferRingGLImpl()
     {
-        for (int i = 0; i < kBufferRingSize; ++i)
+        for (int i = 0; i < ringSize(); ++i)
         {
             m_state->deleteBuffer(m_ids[i]);
         }
@@ -358,13 +560,32 @@ public:
     GLuint submittedBufferID() const { return m_ids[submittedBufferIdx()]; }
 
 protected:
-    BufferRingGLImpl(GLenum target, size_t capacityInBytes, rcp<GLState> state) :
-        BufferRing(capacityInBytes), m_target(target), m_state(std::move(state))
-    {
-        glGenBuffers(kBufferRingSize, m_ids);
-        for (int i = 0; i < kBufferRingSize; ++i)
+    BufferRingGLImpl(GLenum target,
+                     size_t capacityInBytes,
+                     int ringSize,
+                     rcp<GLState> state,
+                     rcp<GLFrameSyncs> frameSyncs) :
+        BufferRing(capacityInBytes, ringSize),
+        m_target(target),
+        m_state(std::move(state)),
+        m_frameSyncs(std::move(frameSyncs))
+    {
+        glGenBuffers(ringSize, m_ids);
+        for (int i = 0; i < ringSize; ++i)
         {
             m_state->bindBuffer(m_target, m_ids[i]);
+#ifndef RIVE_WEBGL
+            if (m_frameSyncs != nullptr)
+            {
+                // Coherent, so we don't need to flush or unmap before the GPU reads.
+                constexpr static GLbitfield kPersistentFlags =
+                    GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT_EXT | GL_MAP_COHERENT_BIT_EXT;
+                glBufferStorageEXT(m_target, capacityInBytes, nullptr, kPersistentFlags);
+                m_persistentContents[i] =
+                    glMapBufferRange(m_target, 0, capacityInBytes, kPersistentFlags);
+                continue;
+            }
+#endif
             glBufferData(m_target, capacityInBytes, nullptr, GL_DYNAMIC_DRAW);
         }
     }
@@ -375,6 +596,13 @@ protected:
         // WebGL doesn't support buffer mapping.
         return shadowBuffer();
 #else
+        if (m_frameSyncs != nullptr)
+        {
+            // Don't overwrite the buffer until the GPU is done with the frame that last used it.
+            m_frameSyncs->waitForFrames(m_frameCountWhenLastMapped[bufferIdx]);
+            m_frameCountWhenLastMapped[bufferIdx] = m_frameSyncs->currentFrameIdx() + 1;
+            return m_persistentContents[bufferIdx];
+        }
         m_state->bindBuffer(m_target, m_ids[bufferIdx]);
         return glMapBufferRange(m_target,
                                 0,
@@ -386,18 +614,28 @@ protected:
 
     void onUnmapAndSubmitBuffer(int bufferIdx, size_t mapSizeInBytes) override
     {
-        m_state->bindBuffer(m_target, m_ids[bufferIdx]);
 #ifdef RIVE_WEBGL
         // WebGL doesn't support buffer mapping.
+        m_state->bindBuffer(m_target, m_ids[bufferIdx]);
         glBufferSubData(m_target, 0, mapSizeInBytes, shadowBuffer());
 #else
+        if (m_frameSyncs != nullptr)
+        {
+            return; // Persistent and coherent: the data is already visible to the GPU.
+        }
+        m_state->bindBuffer(m_target, m_ids[bufferIdx]);
         glUnmapBuffer(m_target);
 #endif
     }
 
     const GLenum m_target;
-    GLuint m_ids[kBufferRingSize];
+    GLuint m_ids[kMaxBufferRingSize];
     const rcp<GLState> m_state;
+    const rcp<GLFrameSyncs> m_frameSyncs;
+#ifndef RIVE_WEBGL
+    void* m_persistentContents[kMaxBufferRingSize]{};
+    uint64_t m_frameCountWhenLastMapped[kMaxBufferRingSize]{};
+#endif
 };
 
 // GL internalformat to use for a texture that polyfills a storage buffer.
@@ -449,14 +687,18 @@ class StorageBufferRingGLImpl : public BufferRingGLImpl
 {
 public:
     StorageBufferRingGLImpl(size_t capacityInBytes,
+                            int ringSize,
                             pls::StorageBufferStructure bufferStructure,
-                            rcp<GLState> state) :
+                            rcp<GLState> state,
+                            rcp<GLFrameSyncs> frameSyncs) :
         BufferRingGLImpl(
             // If we don't support storage buffers, instead make a pixel-unpack buffer that
             // will be used to copy data into the polyfill texture.
             GL_SHADER_STORAGE_BUFFER,
             capacityInBytes,
-            std::move(state)),
+            ringSize,
+            std::move(state),
+            std::move(frameSyncs)),
         m_bufferStructure(bufferStructure)
     {}
 
@@ -464,11 +706,11 @@ public:
                              size_t bindingSizeInBytes,
                              size_t offsetSizeInBytes) const
     {
-        glBindBufferRange(GL_SHADER_STORAGE_BUFFER,
-                          bindingIdx,
-                          submittedBufferID(),
-                          offsetSizeInBytes,
-                          bindingSizeInBytes);
+        m_state->bindBufferRange(GL_SHADER_STORAGE_BUFFER,
+                                 bindingIdx,
+                                 submittedBufferID(),
+                                 offsetSizeInBytes,
+                                 bindingSizeInBytes);
     }
 
 protected:
@@ -479,26 +721,32 @@ class TexelBufferRingWebGL : public BufferRing
 {
 public:
     TexelBufferRingWebGL(size_t capacityInBytes,
+                         int ringSize,
                          pls::StorageBufferStructure bufferStructure,
                          rcp<GLState> state) :
-        BufferRing(pls::StorageTextureBufferSize(capacityInBytes, bufferStructure)),
+        BufferRing(pls::StorageTextureBufferSize(capacityInBytes, bufferStructure), ringSize),
         m_bufferStructure(bufferStructure),
         m_state(std::move(state))
     {
         auto [width, height] = pls::StorageTextureSize(capacityInBytes, m_bufferStructure);
         GLenum internalformat = storage_texture_internalformat(m_bufferStructure);
-        glGenTextures(pls::kBufferRingSize, m_textures);
-        glActiveTexture(GL_TEXTURE0);
-        for (size_t i = 0; i < pls::kBufferRingSize; ++i)
+        glGenTextures(ringSize, m_textures);
+        for (int i = 0; i < ringSize; ++i)
         {
-            glBindTexture(GL_TEXTURE_2D, m_textures[i]);
+            m_state->bindTexture(GL_TEXTURE0, m_textures[i]);
             glTexStorage2D(GL_TEXTURE_2D, 1, internalformat, width, height);
             glutils::SetTexture2DSamplingParams(GL_NEAREST, GL_NEAREST);
         }
-        glBindTexture(GL_TEXTURE_2D, 0);
+        m_state->bindTexture(GL_TEXTURE0, 0);
     }
 
-    ~TexelBufferRingWebGL() { glDeleteTextures(pls::kBufferRingSize, m_textures); }
+    ~TexelBufferRingWebGL()
+    {
+        for (int i = 0; i < ringSize(); ++i)
+        {
+            m_state->deleteTexture(m_textures[i]);
+        }
+    }
 
     void* onMapBuffer(int bufferIdx, size_t mapSizeInBytes) override { return shadowBuffer(); }
     void onUnmapAndSubmitBuffer(int bufferIdx, size_t mapSizeInBytes) override {}
@@ -510,8 +758,8 @@ public:
         auto [updateWidth, updateHeight] =
             pls::StorageTextureSize(bindingSizeInBytes, m_bufferStructure);
         m_state->bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
-        glActiveTexture(GL_TEXTURE0 + kPLSTexIdxOffset + bindingIdx);
-        glBindTexture(GL_TEXTURE_2D, m_textures[submittedBufferIdx()]);
+        m_state->bindTexture(GL_TEXTURE0 + kPLSTexIdxOffset + bindingIdx,
+                             m_textures[submittedBufferIdx()]);
         glTexSubImage2D(GL_TEXTURE_2D,
                         0,
                         0,
@@ -526,12 +774,16 @@ public:
 protected:
     const pls::StorageBufferStructure m_bufferStructure;
     const rcp<GLState> m_state;
-    GLuint m_textures[pls::kBufferRingSize];
+    GLuint m_textures[pls::kMaxBufferRingSize];
 };
 
 std::unique_ptr<BufferRing> PLSRenderContextGLImpl::makeUniformBufferRing(size_t capacityInBytes)
 {
-    return BufferRingGLImpl::Make(capacityInBytes, GL_UNIFORM_BUFFER, m_state);
+    return BufferRingGLImpl::Make(capacityInBytes,
+                                  bufferRingSize(),
+                                  GL_UNIFORM_BUFFER,
+                                  m_state,
+                                  m_frameSyncs);
 }
 
 std::unique_ptr<BufferRing> PLSRenderContextGLImpl::makeStorageBufferRing(
@@ -544,28 +796,43 @@ std::unique_ptr<BufferRing> PLSRenderContextGLImpl::makeStorageBufferRing(
     }
     else if (m_capabilities.ARB_shader_storage_buffer_object)
     {
-        return std::make_unique<StorageBufferRingGLImpl>(capacityInBytes, bufferStructure, m_state);
+        return std::make_unique<StorageBufferRingGLImpl>(capacityInBytes,
+                                                         bufferRingSize(),
+                                                         bufferStructure,
+                                                         m_state,
+                                                         m_frameSyncs);
     }
     else
     {
-        return std::make_unique<TexelBufferRingWebGL>(capacityInBytes, bufferStructure, m_state);
+        return std::make_unique<TexelBufferRingWebGL>(capacityInBytes,
+                                                      bufferRingSize(),
+                                                      bufferStructure,
+                                                      m_state);
     }
 }
 
 std::unique_ptr<BufferRing> PLSRenderContextGLImpl::makeVertexBufferRing(size_t capacityInBytes)
 {
-    return BufferRingGLImpl::Make(capacityInBytes, GL_ARRAY_BUFFER, m_state);
+    return BufferRingGLImpl::Make(capacityInBytes,
+                                  bufferRingSize(),
+                                  GL_ARRAY_BUFFER,
+                                  m_state,
+                                  m_frameSyncs);
 }
 
 std::unique_ptr<BufferRing> PLSRenderContextGLImpl::makeTextureTransferBufferRing(
     size_t capacityInBytes)
 {
-    return BufferRingGLImpl::Make(capacityInBytes, GL_PIXEL_UNPACK_BUFFER, m_state);
+    return BufferRingGLImpl::Make(capacityInBytes,
+                                  bufferRingSize(),
+                                  GL_PIXEL_UNPACK_BUFFER,
+                                  m_state,
+                                  m_frameSyncs);
 }
 
 void PLSRenderContextGLImpl::resizeGradientTexture(uint32_t width, uint32_t height)
 {
-    glDeleteTextures(1, &m_gradientTexture);
+    m_state->deleteTexture(m_gradientTexture);
     if (width == 0 || height == 0)
     {
         m_gradientTexture = 0;
@@ -573,12 +840,11 @@ void PLSRenderContextGLImpl::resizeGradientTexture(uint32_t width, uint32_t heig
     }
 
     glGenTextures(1, &m_gradientTexture);
-    glActiveTexture(GL_TEXTURE0 + kPLSTexIdxOffset + GRAD_TEXTURE_IDX);
-    glBindTexture(GL_TEXTURE_2D, m_gradientTexture);
+    m_state->bindTexture(GL_TEXTURE0 + kPLSTexIdxOffset + GRAD_TEXTURE_IDX, m_gradientTexture);
     glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
     glutils::SetTexture2DSamplingParams(GL_LINEAR, GL_LINEAR);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, m_colorRampFBO);
+    m_state->bindFramebuffer(GL_FRAMEBUFFER, m_colorRampFBO);
     glFramebufferTexture2D(GL_FRAMEBUFFER,
                            GL_COLOR_ATTACHMENT0,
                            GL_TEXTURE_2D,
@@ -588,7 +854,7 @@ void PLSRenderContextGLImpl::resizeGradientTexture(uint32_t width, uint32_t heig
 
 void PLSRenderContextGLImpl::resizeTessellationTexture(uint32_t width, uint32_t height)
 {
-    glDeleteTextures(1, &m_tessVertexTexture);
+    m_state->deleteTexture(m_tessVertexTexture);
     if (width == 0 || height == 0)
     {
         m_tessVertexTexture = 0;
@@ -596,12 +862,12 @@ void PLSRenderContextGLImpl::resizeTessellationTexture(uint32_t width, uint32_t
     }
 
     glGenTextures(1, &m_tessVertexTexture);
-    glActiveTexture(GL_TEXTURE0 + kPLSTexIdxOffset + TESS_VERTEX_TEXTURE_IDX);
-    glBindTexture(GL_TEXTURE_2D, m_tessVertexTexture);
+    m_state->bindTexture(GL_TEXTURE0 + kPLSTexIdxOffset + TESS_VERTEX_TEXTURE_IDX,
+                         m_tessVertexTexture);
     glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA32UI, width, height);
     glutils::SetTexture2DSamplingParams(GL_NEAREST, GL_NEAREST);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, m_tessellateFBO);
+    m_state->bindFramebuffer(GL_FRAMEBUFFER, m_tessellateFBO);
     glFramebufferTexture2D(GL_FRAMEBUFFER,
                            GL_COLOR_ATTACHMENT0,
                            GL_TEXTURE_2D,
@@ -609,6 +875,47 @@ void PLSRenderContextGLImpl::resizeTessellationTexture(uint32_t width, uint32_t
                            0);
 }
 
+void PLSRenderContextGLImpl::compileTessellateProgram(glutils::Program* program,
+                                                      bool compactTessVertexSpans)
+{
+    std::vector<const char*> defines;
+    if (!m_capabilities.ARB_shader_storage_buffer_object)
+    {
+        defines.push_back(GLSL_DISABLE_SHADER_STORAGE_BUFFERS);
+    }
+    if (compactTessVertexSpans)
+    {
+        defines.push_back(GLSL_COMPACT_TESS_VERTEX_SPANS);
+    }
+
+    const char* tessellateSources[] = {glsl::constants, glsl::common, glsl::tessellate};
+    program->compileAndAttachShader(GL_VERTEX_SHADER,
+                                    defines.data(),
+                                    defines.size(),
+                                    tessellateSources,
+                                    std::size(tessellateSources),
+                                    m_capabilities);
+    program->compileAndAttachShader(GL_FRAGMENT_SHADER,
+                                    defines.data(),
+                                    defines.size(),
+                                    tessellateSources,
+                                    std::size(tessellateSources),
+                                    m_capabilities);
+    program->link();
+    m_state->bindProgram(*program);
+    glUniformBlockBinding(*program,
+                          glGetUniformBlockIndex(*program, GLSL_FlushUniforms),
+                          FLUSH_UNIFORM_BUFFER_IDX);
+    if (!m_capabilities.ARB_shader_storage_buffer_object)
+    {
+        // Our GL driver doesn't support storage buffers. We polyfill these buffers as textures.
+        glUniform1i(glGetUniformLocation(*program, GLSL_pathBuffer),
+                    kPLSTexIdxOffset + PATH_BUFFER_IDX);
+        glUniform1i(glGetUniformLocation(*program, GLSL_contourBuffer),
+                    kPLSTexIdxOffset + CONTOUR_BUFFER_IDX);
+    }
+}
+
 PLSRenderContextGLImpl::DrawShader::DrawShader(PLSRenderContextGLImpl* plsContextImpl,
                                                GLenum shaderType,
                                                pls::DrawType drawType,
@@ -625,6 +932,35 @@ PLSRenderContextGLImpl::DrawShader::DrawShader(PLSRenderContextGLImpl* plsContex
 #endif
 
     std::vector<const char*> defines;
+    std::vector<const char*> sources;
+    GetSources(plsContextImpl,
+               shaderType,
+               drawType,
+               shaderFeatures,
+               interlockMode,
+               shaderMiscFlags,
+               &defines,
+               &sources);
+
+    m_id = glutils::CompileShader(shaderType,
+                                  defines.data(),
+                                  defines.size(),
+                                  sources.data(),
+                                  sources.size(),
+                                  plsContextImpl->m_capabilities);
+}
+
+void PLSRenderContextGLImpl::DrawShader::GetSources(PLSRenderContextGLImpl* plsContextImpl,
+                                                    GLenum shaderType,
+                                                    pls::DrawType drawType,
+                                                    ShaderFeatures shaderFeatures,
+                                                    pls::InterlockMode interlockMode,
+                                                    pls::ShaderMiscFlags shaderMiscFlags,
+                                                    std::vector<const char*>* definesPtr,
+                                                    std::vector<const char*>* sourcesPtr)
+{
+    std::vector<const char*>& defines = *definesPtr;
+    std::vector<const char*>& sources = *sourcesPtr;
     if (plsContextImpl->m_plsImpl != nullptr)
     {
         plsContextImpl->m_plsImpl->pushShaderDefines(interlockMode, &defines);
@@ -647,7 +983,7 @@ PLSRenderContextGLImpl::DrawShader::DrawShader(PLSRenderContextGLImpl* plsContex
             assert((kVertexShaderFeaturesMask & feature) || shaderType == GL_FRAGMENT_SHADER);
             if (interlockMode == pls::InterlockMode::depthStencil &&
                 feature == pls::ShaderFeatures::ENABLE_ADVANCED_BLEND &&
-                plsContextImpl->m_capabilities.KHR_blend_equation_advanced_coherent)
+                plsContextImpl->platformFeatures().supportsKHRBlendEquations)
             {
                 defines.push_back(GLSL_ENABLE_KHR_BLEND);
             }
@@ -657,12 +993,17 @@ PLSRenderContextGLImpl::DrawShader::DrawShader(PLSRenderContextGLImpl* plsContex
             }
         }
     }
+    if (interlockMode == pls::InterlockMode::depthStencil && shaderType == GL_FRAGMENT_SHADER &&
+        (shaderFeatures & ShaderFeatures::ENABLE_ADVANCED_BLEND) &&
+        plsContextImpl->m_msaaAdvancedBlend == MSAAAdvancedBlend::framebufferFetch)
+    {
+        defines.push_back(GLSL_FRAMEBUFFER_FETCH_DST_COLOR);
+    }
     if (interlockMode == pls::InterlockMode::depthStencil)
     {
         defines.push_back(GLSL_USING_DEPTH_STENCIL);
     }
 
-    std::vector<const char*> sources;
     sources.push_back(glsl::constants);
     sources.push_back(glsl::common);
     if (shaderType == GL_FRAGMENT_SHADER &&
@@ -688,6 +1029,10 @@ PLSRenderContextGLImpl::DrawShader::DrawShader(PLSRenderContextGLImpl* plsContex
                 if (!plsContextImpl->m_capabilities.ANGLE_base_vertex_base_instance_shader_builtin)
                 {
                     defines.push_back(GLSL_ENABLE_SPIRV_CROSS_BASE_INSTANCE);
+                    if (plsContextImpl->m_capabilities.ANGLE_multi_draw)
+                    {
+                        defines.push_back(GLSL_ENABLE_MULTI_DRAW);
+                    }
                 }
             }
             defines.push_back(GLSL_DRAW_PATH);
@@ -741,13 +1086,6 @@ PLSRenderContextGLImpl::DrawShader::DrawShader(PLSRenderContextGLImpl* plsContex
     {
         defines.push_back(GLSL_DISABLE_SHADER_STORAGE_BUFFERS);
     }
-
-    m_id = glutils::CompileShader(shaderType,
-                                  defines.data(),
-                                  defines.size(),
-                                  sources.data(),
-                                  sources.size(),
-                                  plsContextImpl->m_capabilities);
 }
 
 PLSRenderContextGLImpl::DrawProgram::DrawProgram(PLSRenderContextGLImpl* plsContextImpl,
@@ -755,36 +1093,128 @@ PLSRenderContextGLImpl::DrawProgram::DrawProgram(PLSRenderContextGLImpl* plsCont
                                                  pls::ShaderFeatures shaderFeatures,
                                                  pls::InterlockMode interlockMode,
                                                  pls::ShaderMiscFlags fragmentShaderMiscFlags) :
-    m_fragmentShader(plsContextImpl,
-                     GL_FRAGMENT_SHADER,
-                     drawType,
-                     shaderFeatures,
-                     interlockMode,
-                     fragmentShaderMiscFlags),
+    m_drawType(drawType),
+    m_shaderFeatures(shaderFeatures),
+    m_interlockMode(interlockMode),
     m_state(plsContextImpl->m_state)
 {
-    // Not every vertex shader is unique. Cache them by just the vertex features and reuse when
-    // possible.
     ShaderFeatures vertexShaderFeatures = shaderFeatures & kVertexShaderFeaturesMask;
-    uint32_t vertexShaderKey = pls::ShaderUniqueKey(drawType,
-                                                    vertexShaderFeatures,
-                                                    interlockMode,
-                                                    pls::ShaderMiscFlags::none);
-    const DrawShader& vertexShader = plsContextImpl->m_vertexShaders
-                                         .try_emplace(vertexShaderKey,
-                                                      plsContextImpl,
-                                                      GL_VERTEX_SHADER,
-                                                      drawType,
-                                                      vertexShaderFeatures,
-                                                      interlockMode,
-                                                      pls::ShaderMiscFlags::none)
-                                         .first->second;
 
-    m_id = glCreateProgram();
-    glAttachShader(m_id, vertexShader.id());
-    glAttachShader(m_id, m_fragmentShader.id());
-    glutils::LinkProgram(m_id);
+    std::string blobKey;
+    if (plsContextImpl->m_pipelineBlobCache != nullptr)
+    {
+        // Key the program binary on the full text of both shaders, so it gets invalidated by any
+        // change in their sources or #defines.
+        PipelineBlobKeyHash hash = plsContextImpl->m_driverBlobKeyHash;
+        for (GLenum shaderType : {GL_VERTEX_SHADER, GL_FRAGMENT_SHADER})
+        {
+            std::vector<const char*> defines;
+            std::vector<const char*> sources;
+            DrawShader::GetSources(plsContextImpl,
+                                   shaderType,
+                                   drawType,
+                                   shaderType == GL_VERTEX_SHADER ? vertexShaderFeatures
+                                                                  : shaderFeatures,
+                                   interlockMode,
+                                   shaderType == GL_VERTEX_SHADER ? pls::ShaderMiscFlags::none
+                                                                  : fragmentShaderMiscFlags,
+                                   &defines,
+                                   &sources);
+            hash.write(shaderType).write(defines.size()).write(sources.size());
+            for (const char* define : defines)
+            {
+                hash.write(define);
+            }
+            for (const char* source : sources)
+            {
+                hash.write(source);
+            }
+        }
+        blobKey = hash.key("rive_gl_program_");
+    }
+
+    if (!blobKey.empty() && loadProgramBinary(plsContextImpl, blobKey))
+    {
+        finishInitialization(plsContextImpl);
+    }
+    else
+    {
+        m_fragmentShader = std::make_unique<DrawShader>(plsContextImpl,
+                                                        GL_FRAGMENT_SHADER,
+                                                        drawType,
+                                                        shaderFeatures,
+                                                        interlockMode,
+                                                        fragmentShaderMiscFlags);
+
+        // Not every vertex shader is unique. Cache them by just the vertex features and reuse when
+        // possible.
+        uint32_t vertexShaderKey = pls::ShaderUniqueKey(drawType,
+                                                        vertexShaderFeatures,
+                                                        interlockMode,
+                                                        pls::ShaderMiscFlags::none);
+        const DrawShader& vertexShader = plsContextImpl->m_vertexShaders
+                                             .try_emplace(vertexShaderKey,
+                                                          plsContextImpl,
+                                                          GL_VERTEX_SHADER,
+                                                          drawType,
+                                                          vertexShaderFeatures,
+                                                          interlockMode,
+                                                          pls::ShaderMiscFlags::none)
+                                             .first->second;
+
+        m_id = glCreateProgram();
+        glAttachShader(m_id, vertexShader.id());
+        glAttachShader(m_id, m_fragmentShader->id());
+        if (!blobKey.empty())
+        {
+            glProgramParameteri(m_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+        // With KHR_parallel_shader_compile, this returns immediately and the driver compiles and
+        // links in the background. Don't query anything about the program until isReady().
+        glLinkProgram(m_id);
+        m_pendingBlobKey = std::move(blobKey);
+    }
+}
+
+bool PLSRenderContextGLImpl::DrawProgram::isReady(PLSRenderContextGLImpl* plsContextImpl)
+{
+    if (m_isInitialized)
+    {
+        return true;
+    }
+    if (plsContextImpl->m_capabilities.KHR_parallel_shader_compile)
+    {
+        GLint isComplete = GL_FALSE;
+        glGetProgramiv(m_id, GL_COMPLETION_STATUS_KHR, &isComplete);
+        if (isComplete == GL_FALSE)
+        {
+            return false;
+        }
+    }
+    finishInitialization(plsContextImpl);
+    return true;
+}
+
+void PLSRenderContextGLImpl::DrawProgram::finishInitialization(
+    PLSRenderContextGLImpl* plsContextImpl)
+{
+    if (m_isInitialized)
+    {
+        return;
+    }
+    m_isInitialized = true;
 
+    glutils::VerifyProgramLinked(m_id);
+    if (!m_pendingBlobKey.empty())
+    {
+        storeProgramBinary(plsContextImpl, m_pendingBlobKey);
+        m_pendingBlobKey.clear();
+    }
+
+    // Uniform state is not part of a program binary, so this runs for loaded programs too.
+    const pls::DrawType drawType = m_drawType;
+    const pls::ShaderFeatures shaderFeatures = m_shaderFeatures;
+    const pls::InterlockMode interlockMode = m_interlockMode;
     m_state->bindProgram(m_id);
     glUniformBlockBinding(m_id,
                           glGetUniformBlockIndex(m_id, GLSL_FlushUniforms),
@@ -814,7 +1244,7 @@ PLSRenderContextGLImpl::DrawProgram::DrawProgram(PLSRenderContextGLImpl* plsCont
                 kPLSTexIdxOffset + IMAGE_TEXTURE_IDX);
     if (interlockMode == pls::InterlockMode::depthStencil &&
         (shaderFeatures & pls::ShaderFeatures::ENABLE_ADVANCED_BLEND) &&
-        !plsContextImpl->m_capabilities.KHR_blend_equation_advanced_coherent)
+        plsContextImpl->m_msaaAdvancedBlend == MSAAAdvancedBlend::dstColorTexture)
     {
         glUniform1i(glGetUniformLocation(m_id, GLSL_dstColorTexture),
                     kPLSTexIdxOffset + DST_COLOR_TEXTURE_IDX);
@@ -829,6 +1259,140 @@ PLSRenderContextGLImpl::DrawProgram::DrawProgram(PLSRenderContextGLImpl* plsCont
 
 PLSRenderContextGLImpl::DrawProgram::~DrawProgram() { m_state->deleteProgram(m_id); }
 
+// Program blobs are stored as the GLenum binary format, followed by the binary itself.
+bool PLSRenderContextGLImpl::DrawProgram::loadProgramBinary(PLSRenderContextGLImpl* plsContextImpl,
+                                                            const std::string& blobKey)
+{
+#ifdef RIVE_WEBGL
+    RIVE_UNREACHABLE();
+#else
+    std::vector<uint8_t> blob;
+    if (!plsContextImpl->m_pipelineBlobCache->loadBlob(blobKey, &blob) ||
+        blob.size() <= sizeof(GLenum))
+    {
+        return false;
+    }
+    GLenum binaryFormat;
+    memcpy(&binaryFormat, blob.data(), sizeof(GLenum));
+    m_id = glCreateProgram();
+    glProgramBinary(m_id,
+                    binaryFormat,
+                    blob.data() + sizeof(GLenum),
+                    static_cast<GLsizei>(blob.size() - sizeof(GLenum)));
+    GLint isLinked = GL_FALSE;
+    glGetProgramiv(m_id, GL_LINK_STATUS, &isLinked);
+    if (isLinked == GL_FALSE)
+    {
+        // The driver rejected the binary (e.g., it was produced by an older driver version).
+        glDeleteProgram(m_id);
+        m_id = 0;
+        return false;
+    }
+    return true;
+#endif
+}
+
+void PLSRenderContextGLImpl::DrawProgram::storeProgramBinary(PLSRenderContextGLImpl* plsContextImpl,
+                                                             const std::string& blobKey)
+{
+#ifdef RIVE_WEBGL
+    RIVE_UNREACHABLE();
+#else
+    GLint binaryLength = 0;
+    glGetProgramiv(m_id, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+    if (binaryLength <= 0)
+    {
+        return;
+    }
+    std::vector<uint8_t> blob(sizeof(GLenum) + binaryLength);
+    GLenum binaryFormat = 0;
+    GLsizei writtenLength = 0;
+    glGetProgramBinary(m_id,
+                       binaryLength,
+                       &writtenLength,
+                       &binaryFormat,
+                       blob.data() + sizeof(GLenum));
+    if (writtenLength <= 0)
+    {
+        return;
+    }
+    memcpy(blob.data(), &binaryFormat, sizeof(GLenum));
+    plsContextImpl->m_pipelineBlobCache->storeBlob(blobKey,
+                                                   blob.data(),
+                                                   sizeof(GLenum) + writtenLength);
+#endif
+}
+
+PLSRenderContextGLImpl::DrawProgram* PLSRenderContextGLImpl::findCompatibleDrawProgram(
+    pls::DrawType drawType,
+    pls::ShaderFeatures shaderFeatures,
+    pls::InterlockMode interlockMode,
+    pls::ShaderMiscFlags fragmentShaderMiscFlags)
+{
+    uint32_t fragmentShaderKey =
+        pls::ShaderUniqueKey(drawType, shaderFeatures, interlockMode, fragmentShaderMiscFlags);
+    DrawProgram& drawProgram = m_drawPrograms
+                                   .try_emplace(fragmentShaderKey,
+                                                this,
+                                                drawType,
+                                                shaderFeatures,
+                                                interlockMode,
+                                                fragmentShaderMiscFlags)
+                                   .first->second;
+    if (drawProgram.isReady(this))
+    {
+        return &drawProgram;
+    }
+
+    // The program is still compiling in the background. Find a fully-featured superset of features
+    // whose program we can fall back on while waiting for it.
+    ShaderFeatures fullyFeaturedProgramFeatures =
+        pls::ShaderFeaturesMaskFor(drawType, interlockMode);
+    if (interlockMode == pls::InterlockMode::atomics)
+    {
+        // Never add ENABLE_ADVANCED_BLEND to an atomic program that doesn't use advanced blend,
+        // since in atomic mode, the shaders behave differently depending on whether advanced blend
+        // is enabled.
+        fullyFeaturedProgramFeatures &= shaderFeatures | ~ShaderFeatures::ENABLE_ADVANCED_BLEND;
+        // Never add ENABLE_CLIPPING to an atomic program that doesn't use clipping, since the
+        // clip plane may not be set up.
+        fullyFeaturedProgramFeatures &= shaderFeatures | ~ShaderFeatures::ENABLE_CLIPPING;
+    }
+
+    // Only wait if this already is the fully-featured program. (depthStencil mode changes fixed
+    // function state based on ShaderFeatures, so it can't use a stand-in either.)
+    if ((shaderFeatures & fullyFeaturedProgramFeatures) == fullyFeaturedProgramFeatures ||
+        interlockMode == pls::InterlockMode::depthStencil || m_synchronousShaderCompilations)
+    {
+        drawProgram.finishInitialization(this);
+        return &drawProgram;
+    }
+
+    return findCompatibleDrawProgram(drawType,
+                                     fullyFeaturedProgramFeatures,
+                                     interlockMode,
+                                     fragmentShaderMiscFlags);
+}
+
+void PLSRenderContextGLImpl::precompileShaders(Span<const pls::ShaderVariant> variants)
+{
+    for (const pls::ShaderVariant& variant : variants)
+    {
+        // Creating the DrawProgram kicks off its compile and link. With
+        // KHR_parallel_shader_compile, these finish in the background.
+        uint32_t fragmentShaderKey = pls::ShaderUniqueKey(variant.drawType,
+                                                          variant.shaderFeatures,
+                                                          variant.interlockMode,
+                                                          pls::ShaderMiscFlags::none);
+        m_drawPrograms.try_emplace(fragmentShaderKey,
+                                   this,
+                                   variant.drawType,
+                                   variant.shaderFeatures,
+                                   variant.interlockMode,
+                                   pls::ShaderMiscFlags::none);
+    }
+}
+
 static GLuint gl_buffer_id(const BufferRing* bufferRing)
 {
     return static_cast<const BufferRingGLImpl*>(bufferRing)->submittedBufferID();
@@ -945,19 +1509,134 @@ private:
     const void* m_indexOffset = nullptr;
 };
 
+// Accumulates consecutive patch batches that share a program and image texture, and submits them
+// together with a single glMultiDrawElementsInstancedANGLE(). Each sub-draw reads its base instance
+// from SPIRV_Cross_BaseInstance[gl_DrawID].
+class MultiDrawPatchesHelper
+{
+public:
+    bool empty() const { return m_drawCount == 0; }
+
+    bool canCombine(GLuint programID, const PLSTexture* imageTexture) const
+    {
+        return m_drawCount == 0 || (programID == m_programID && imageTexture == m_imageTexture);
+    }
+
+    void push(GLuint programID,
+              GLint spirvCrossBaseInstanceLocation,
+              const PLSTexture* imageTexture,
+              uint32_t indexCount,
+              uint32_t baseIndex,
+              uint32_t instanceCount,
+              uint32_t baseInstance)
+    {
+        assert(canCombine(programID, imageTexture));
+        assert(spirvCrossBaseInstanceLocation >= 0);
+        m_programID = programID;
+        m_spirvCrossBaseInstanceLocation = spirvCrossBaseInstanceLocation;
+        m_imageTexture = imageTexture;
+        m_counts[m_drawCount] = indexCount;
+        m_offsets[m_drawCount] = reinterpret_cast<const void*>(baseIndex * sizeof(uint16_t));
+        m_instanceCounts[m_drawCount] = instanceCount;
+        m_baseInstances[m_drawCount] = baseInstance;
+        if (++m_drawCount == MAX_MULTI_DRAW_COUNT)
+        {
+            submit();
+        }
+    }
+
+    // Must be called while the accumulated draws' program and VAO are still bound.
+    void submit()
+    {
+        if (m_drawCount == 0)
+        {
+            return;
+        }
+        glUniform1iv(m_spirvCrossBaseInstanceLocation, m_drawCount, m_baseInstances);
+        glMultiDrawElementsInstancedANGLE(GL_TRIANGLES,
+                                          m_counts,
+                                          GL_UNSIGNED_SHORT,
+                                          m_offsets,
+                                          m_instanceCounts,
+                                          m_drawCount);
+        m_drawCount = 0;
+    }
+
+private:
+    GLuint m_programID = 0;
+    GLint m_spirvCrossBaseInstanceLocation = -1;
+    const PLSTexture* m_imageTexture = nullptr;
+    GLsizei m_drawCount = 0;
+    GLsizei m_counts[MAX_MULTI_DRAW_COUNT];
+    const void* m_offsets[MAX_MULTI_DRAW_COUNT];
+    GLsizei m_instanceCounts[MAX_MULTI_DRAW_COUNT];
+    GLint m_baseInstances[MAX_MULTI_DRAW_COUNT];
+};
+
+#if defined(RIVE_PLS_TRACING) && !defined(RIVE_WEBGL)
+// Brackets a stage of the flush in a KHR_debug group, so it shows up by name in GPU debuggers.
+class ScopedDebugGroupGL
+{
+public:
+    ScopedDebugGroupGL(const GLCapabilities& capabilities, const char* name) :
+        m_enabled(capabilities.KHR_debug)
+    {
+        if (m_enabled)
+        {
+            glPushDebugGroupKHR(GL_DEBUG_SOURCE_APPLICATION_KHR, 0, -1, name);
+        }
+    }
+
+    ~ScopedDebugGroupGL()
+    {
+        if (m_enabled)
+        {
+            glPopDebugGroupKHR();
+        }
+    }
+
+private:
+    const bool m_enabled;
+};
+#define PLS_GL_DEBUG_GROUP(NAME) ScopedDebugGroupGL plsDebugGroup(m_capabilities, NAME)
+#else
+#define PLS_GL_DEBUG_GROUP(NAME)
+#endif
+
 void PLSRenderContextGLImpl::flush(const FlushDescriptor& desc)
 {
+    PLS_TRACE_SCOPE("PLSRenderContextGLImpl::flush");
     auto renderTarget = static_cast<PLSRenderTargetGL*>(desc.renderTarget);
 
+#ifndef RIVE_WEBGL
+    // Time the entire frame with a single query. (GL_TIME_ELAPSED queries can't be nested.)
+    bool timesGPUFrame = desc.gpuTimerFrameNumber != 0 && m_capabilities.EXT_disjoint_timer_query;
+    if (timesGPUFrame && desc.isFirstFlushOfFrame)
+    {
+        GLuint query;
+        if (!m_availableGPUTimerQueries.empty())
+        {
+            query = m_availableGPUTimerQueries.back();
+            m_availableGPUTimerQueries.pop_back();
+        }
+        else
+        {
+            glGenQueries(1, &query);
+        }
+        glBeginQuery(GL_TIME_ELAPSED_EXT, query);
+        m_pendingGPUTimers.push_back({query, desc.gpuTimerFrameNumber});
+    }
+#endif
+
     m_state->setWriteMasks(true, true, 0xff);
     m_state->disableBlending();
 
     // All programs use the same set of per-flush uniforms.
-    glBindBufferRange(GL_UNIFORM_BUFFER,
-                      FLUSH_UNIFORM_BUFFER_IDX,
-                      gl_buffer_id(flushUniformBufferRing()),
-                      desc.flushUniformDataOffsetInBytes,
-                      sizeof(pls::FlushUniforms));
+    m_state->bindBufferRange(GL_UNIFORM_BUFFER,
+                             FLUSH_UNIFORM_BUFFER_IDX,
+                             gl_buffer_id(flushUniformBufferRing()),
+                             desc.flushUniformDataOffsetInBytes,
+                             sizeof(pls::FlushUniforms));
 
     // All programs use the same storage buffers.
     if (desc.pathCount > 0)
@@ -993,6 +1672,7 @@ void PLSRenderContextGLImpl::flush(const FlushDescriptor& desc)
     // Render the complex color ramps into the gradient texture.
     if (desc.complexGradSpanCount > 0)
     {
+        PLS_GL_DEBUG_GROUP("PLS color ramps");
         m_state->bindBuffer(GL_ARRAY_BUFFER, gl_buffer_id(gradSpanBufferRing()));
         m_state->bindVAO(m_colorRampVAO);
         m_state->setCullFace(GL_BACK);
@@ -1002,11 +1682,14 @@ void PLSRenderContextGLImpl::flush(const FlushDescriptor& desc)
             GL_UNSIGNED_INT,
             0,
             reinterpret_cast<const void*>(desc.firstComplexGradSpan * sizeof(pls::GradientSpan)));
-        glViewport(0, desc.complexGradRowsTop, kGradTextureWidth, desc.complexGradRowsHeight);
-        glBindFramebuffer(GL_FRAMEBUFFER, m_colorRampFBO);
+        m_state->setViewport(0,
+                             desc.complexGradRowsTop,
+                             kGradTextureWidth,
+                             desc.complexGradRowsHeight);
+        m_state->bindFramebuffer(GL_FRAMEBUFFER, m_colorRampFBO);
         m_state->bindProgram(m_colorRampProgram);
-        GLenum colorAttachment0 = GL_COLOR_ATTACHMENT0;
-        glInvalidateFramebuffer(GL_FRAMEBUFFER, 1, &colorAttachment0);
+        // Don't invalidate the framebuffer: the gradient atlas keeps color ramps from previous
+        // flushes in the rows outside these spans.
         glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, desc.complexGradSpanCount);
     }
 
@@ -1014,7 +1697,7 @@ void PLSRenderContextGLImpl::flush(const FlushDescriptor& desc)
     if (desc.simpleGradTexelsHeight > 0)
     {
         m_state->bindBuffer(GL_PIXEL_UNPACK_BUFFER, gl_buffer_id(simpleColorRampsBufferRing()));
-        glActiveTexture(GL_TEXTURE0 + kPLSTexIdxOffset + GRAD_TEXTURE_IDX);
+        m_state->bindTexture(GL_TEXTURE0 + kPLSTexIdxOffset + GRAD_TEXTURE_IDX, m_gradientTexture);
 #ifdef RIVE_WEBGL
         // Emscripten has a bug with glTexSubImage2D when a PIXEL_UNPACK_BUFFER is bound. Make the
         // call ourselves directly.
@@ -1044,28 +1727,66 @@ void PLSRenderContextGLImpl::flush(const FlushDescriptor& desc)
     // Tessellate all curves into vertices in the tessellation texture.
     if (desc.tessVertexSpanCount > 0)
     {
+        PLS_GL_DEBUG_GROUP("PLS tessellate");
         m_state->bindBuffer(GL_ARRAY_BUFFER, gl_buffer_id(tessSpanBufferRing()));
-        m_state->bindVAO(m_tessellateVAO);
         m_state->setCullFace(GL_BACK);
-        size_t tessSpanOffsetInBytes = desc.firstTessVertexSpan * sizeof(pls::TessVertexSpan);
-        for (uintptr_t i = 0; i < 3; ++i)
+        if (desc.compactTessVertexSpans)
         {
-            glVertexAttribPointer(i,
+            if (m_compactTessellateProgram == 0)
+            {
+                m_compactTessellateProgram = glutils::Program();
+                compileTessellateProgram(&m_compactTessellateProgram,
+                                         /*compactTessVertexSpans=*/true);
+            }
+            m_state->bindVAO(m_compactTessellateVAO);
+            size_t tessSpanOffsetInBytes =
+                desc.firstTessVertexSpan * sizeof(pls::CompactTessVertexSpan);
+            glVertexAttribPointer(0,
                                   4,
                                   GL_FLOAT,
                                   GL_FALSE,
-                                  sizeof(TessVertexSpan),
-                                  reinterpret_cast<const void*>(tessSpanOffsetInBytes + i * 4 * 4));
+                                  sizeof(CompactTessVertexSpan),
+                                  reinterpret_cast<const void*>(tessSpanOffsetInBytes));
+            glVertexAttribIPointer(1,
+                                   4,
+                                   GL_UNSIGNED_INT,
+                                   sizeof(CompactTessVertexSpan),
+                                   reinterpret_cast<const void*>(
+                                       tessSpanOffsetInBytes +
+                                       offsetof(CompactTessVertexSpan, p1Delta)));
+            glVertexAttribIPointer(2,
+                                   4,
+                                   GL_UNSIGNED_INT,
+                                   sizeof(CompactTessVertexSpan),
+                                   reinterpret_cast<const void*>(
+                                       tessSpanOffsetInBytes +
+                                       offsetof(CompactTessVertexSpan, x0x1)));
+            m_state->bindProgram(m_compactTessellateProgram);
         }
-        glVertexAttribIPointer(
-            3,
-            4,
-            GL_UNSIGNED_INT,
-            sizeof(TessVertexSpan),
-            reinterpret_cast<const void*>(tessSpanOffsetInBytes + offsetof(TessVertexSpan, x0x1)));
-        glViewport(0, 0, pls::kTessTextureWidth, desc.tessDataHeight);
-        glBindFramebuffer(GL_FRAMEBUFFER, m_tessellateFBO);
-        m_state->bindProgram(m_tessellateProgram);
+        else
+        {
+            m_state->bindVAO(m_tessellateVAO);
+            size_t tessSpanOffsetInBytes = desc.firstTessVertexSpan * sizeof(pls::TessVertexSpan);
+            for (uintptr_t i = 0; i < 3; ++i)
+            {
+                glVertexAttribPointer(
+                    i,
+                    4,
+                    GL_FLOAT,
+                    GL_FALSE,
+                    sizeof(TessVertexSpan),
+                    reinterpret_cast<const void*>(tessSpanOffsetInBytes + i * 4 * 4));
+            }
+            glVertexAttribIPointer(3,
+                                   4,
+                                   GL_UNSIGNED_INT,
+                                   sizeof(TessVertexSpan),
+                                   reinterpret_cast<const void*>(
+                                       tessSpanOffsetInBytes + offsetof(TessVertexSpan, x0x1)));
+            m_state->bindProgram(m_tessellateProgram);
+        }
+        m_state->setViewport(0, 0, pls::kTessTextureWidth, desc.tessDataHeight);
+        m_state->bindFramebuffer(GL_FRAMEBUFFER, m_tessellateFBO);
         GLenum colorAttachment0 = GL_COLOR_ATTACHMENT0;
         glInvalidateFramebuffer(GL_FRAMEBUFFER, 1, &colorAttachment0);
         glDrawElementsInstanced(GL_TRIANGLES,
@@ -1078,6 +1799,7 @@ void PLSRenderContextGLImpl::flush(const FlushDescriptor& desc)
     // Compile the draw programs before activating pixel local storage.
     // Cache specific compilations by DrawType and ShaderFeatures.
     // (ANGLE_shader_pixel_local_storage doesn't allow shader compilation while active.)
+    m_flushDrawPrograms.clear();
     for (const DrawBatch& batch : *desc.drawList)
     {
         auto shaderFeatures = desc.interlockMode == pls::InterlockMode::atomics
@@ -1090,12 +1812,10 @@ void PLSRenderContextGLImpl::flush(const FlushDescriptor& desc)
                                                           shaderFeatures,
                                                           desc.interlockMode,
                                                           fragmentShaderMiscFlags);
-        m_drawPrograms.try_emplace(fragmentShaderKey,
-                                   this,
-                                   batch.drawType,
-                                   shaderFeatures,
-                                   desc.interlockMode,
-                                   fragmentShaderMiscFlags);
+        m_flushDrawPrograms.push_back(findCompatibleDrawProgram(batch.drawType,
+                                                                shaderFeatures,
+                                                                desc.interlockMode,
+                                                                fragmentShaderMiscFlags));
     }
 
     // Bind the currently-submitted buffer in the triangleBufferRing to its vertex array.
@@ -1106,7 +1826,7 @@ void PLSRenderContextGLImpl::flush(const FlushDescriptor& desc)
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
     }
 
-    glViewport(0, 0, renderTarget->width(), renderTarget->height());
+    m_state->setViewport(0, 0, renderTarget->width(), renderTarget->height());
 
 #ifdef RIVE_DESKTOP_GL
     if (m_capabilities.ANGLE_polygon_mode && desc.wireframe)
@@ -1116,11 +1836,27 @@ void PLSRenderContextGLImpl::flush(const FlushDescriptor& desc)
     }
 #endif
 
+    // Tile bin passes, and atomic flushes that only touch part of the render target, restrict
+    // every clear, blit, and draw to renderTargetUpdateBounds. (The PLSImpl has already promised to
+    // respect the scissor via PlatformFeatures::supportsTileBinnedRendering.)
+    bool scissorsUpdateBounds = desc.interlockMode == pls::InterlockMode::atomics &&
+                                m_platformFeatures.supportsTileBinnedRendering &&
+                                (desc.isTileBinPass || desc.hasPartialUpdateBounds);
+
     auto msaaResolveAction = PLSRenderTargetGL::MSAAResolveAction::automatic;
     std::array<GLenum, 3> msaaDepthStencilColor;
     if (desc.interlockMode != pls::InterlockMode::depthStencil)
     {
         assert(desc.msaaSampleCount == 0);
+        assert(!desc.isTileBinPass || scissorsUpdateBounds);
+        if (scissorsUpdateBounds)
+        {
+            const IAABB& bounds = desc.renderTargetUpdateBounds;
+            m_state->setScissor(bounds.left,
+                                renderTarget->height() - bounds.bottom,
+                                bounds.width(),
+                                bounds.height());
+        }
         m_plsImpl->activatePixelLocalStorage(this, desc);
     }
     else
@@ -1165,11 +1901,11 @@ void PLSRenderContextGLImpl::flush(const FlushDescriptor& desc)
 
         if (desc.combinedShaderFeatures & pls::ShaderFeatures::ENABLE_ADVANCED_BLEND)
         {
-            if (m_capabilities.KHR_blend_equation_advanced_coherent)
+            if (m_msaaAdvancedBlend == MSAAAdvancedBlend::khrCoherent)
             {
                 glEnable(GL_BLEND_ADVANCED_COHERENT_KHR);
             }
-            else
+            else if (m_msaaAdvancedBlend == MSAAAdvancedBlend::dstColorTexture)
             {
                 // Set up an internal texture to copy the framebuffer into, for in-shader blending.
                 renderTarget->bindInternalDstTexture(GL_TEXTURE0 + kPLSTexIdxOffset +
@@ -1178,11 +1914,29 @@ void PLSRenderContextGLImpl::flush(const FlushDescriptor& desc)
         }
     }
 
+    // The render target and PLS impl bind their own framebuffers and textures without going through
+    // m_state.
+    m_state->invalidateFramebufferBindings();
+    m_state->invalidateTextureBindings();
+
     bool clipPlanesEnabled = false;
 
-    // Execute the DrawList.
+    // Consecutive patch batches only differ by index range and base instance when they share a
+    // program and texture, so merge them into multi-draws where we can. (On WebGL, every GL call
+    // pays for validation on the JS side.) This requires the SPIRV_Cross_BaseInstance polyfill,
+    // since there is no way to specify a base instance per sub-draw in the shader builtin.
+    const bool multiDrawPatches =
+        m_capabilities.ANGLE_multi_draw &&
+        !m_capabilities.ANGLE_base_vertex_base_instance_shader_builtin &&
+        desc.interlockMode != pls::InterlockMode::depthStencil;
+    MultiDrawPatchesHelper multiDrawHelper;
+
+    // Execute the DrawList. (The debug group stays open through the end of the flush.)
+    PLS_GL_DEBUG_GROUP("PLS draw");
+    size_t batchIdx = 0;
     for (const DrawBatch& batch : *desc.drawList)
     {
+        const DrawProgram& drawProgram = *m_flushDrawPrograms[batchIdx++];
         if (batch.elementCount == 0)
         {
             continue;
@@ -1191,29 +1945,36 @@ void PLSRenderContextGLImpl::flush(const FlushDescriptor& desc)
         auto shaderFeatures = desc.interlockMode == pls::InterlockMode::atomics
                                   ? desc.combinedShaderFeatures
                                   : batch.shaderFeatures;
-        auto fragmentShaderMiscFlags = batch.drawType == pls::DrawType::plsAtomicResolve
-                                           ? m_plsImpl->atomicResolveShaderMiscFlags(desc)
-                                           : pls::ShaderMiscFlags::none;
-        uint32_t fragmentShaderKey = pls::ShaderUniqueKey(batch.drawType,
-                                                          shaderFeatures,
-                                                          desc.interlockMode,
-                                                          fragmentShaderMiscFlags);
-        const DrawProgram& drawProgram = m_drawPrograms.find(fragmentShaderKey)->second;
         if (drawProgram.id() == 0)
         {
             fprintf(stderr, "WARNING: skipping draw due to missing GL program.\n");
             continue;
         }
+        if (!multiDrawHelper.empty() &&
+            ((batch.drawType != DrawType::midpointFanPatches &&
+              batch.drawType != DrawType::outerCurvePatches) ||
+             !multiDrawHelper.canCombine(drawProgram.id(), batch.imageTexture)))
+        {
+            // Submit the pending multi-draw before changing any state.
+            multiDrawHelper.submit();
+        }
         m_state->bindProgram(drawProgram.id());
 
         if (auto imageTextureGL = static_cast<const PLSTextureGLImpl*>(batch.imageTexture))
         {
-            glActiveTexture(GL_TEXTURE0 + kPLSTexIdxOffset + IMAGE_TEXTURE_IDX);
-            glBindTexture(GL_TEXTURE_2D, imageTextureGL->textureID());
+            m_state->bindTexture(GL_TEXTURE0 + kPLSTexIdxOffset + IMAGE_TEXTURE_IDX,
+                                 imageTextureGL->textureID());
         }
 
         if (desc.interlockMode == pls::InterlockMode::depthStencil)
         {
+            if (batch.needsBlendBarrier)
+            {
+                // Make everything drawn so far visible to the advanced blends in this phase.
+                assert(m_msaaAdvancedBlend == MSAAAdvancedBlend::khrWithBarriers);
+                glBlendBarrierKHR();
+            }
+
             // Set up the next blend.
             if (batch.drawContents & pls::DrawContents::opaquePaint)
             {
@@ -1224,12 +1985,16 @@ void PLSRenderContextGLImpl::flush(const FlushDescriptor& desc)
                 assert(batch.internalDrawList->blendMode() == BlendMode::srcOver);
                 m_state->setBlendEquation(BlendMode::srcOver);
             }
-            else if (m_capabilities.KHR_blend_equation_advanced_coherent)
+            else if (m_platformFeatures.supportsKHRBlendEquations)
             {
                 // When m_platformFeatures.supportsKHRBlendEquations is true in depthStencil mode,
                 // the renderContext does not combine draws when they have different blend modes.
                 m_state->setBlendEquation(batch.internalDrawList->blendMode());
             }
+            else if (m_msaaAdvancedBlend == MSAAAdvancedBlend::framebufferFetch)
+            {
+                m_state->disableBlending(); // Blend in the shader instead.
+            }
             else
             {
                 // Read back the framebuffer where we need a dstColor for blending.
@@ -1277,9 +2042,20 @@ void PLSRenderContextGLImpl::flush(const FlushDescriptor& desc)
                                                            desc,
                                                            desc.interlockMode ==
                                                                pls::InterlockMode::rasterOrdering);
+                    m_state->setCullFace(GL_BACK);
+                    if (multiDrawPatches)
+                    {
+                        multiDrawHelper.push(drawProgram.id(),
+                                             drawProgram.spirvCrossBaseInstanceLocation(),
+                                             batch.imageTexture,
+                                             pls::PatchIndexCount(drawType),
+                                             pls::PatchBaseIndex(drawType),
+                                             batch.elementCount,
+                                             batch.baseElement);
+                        break;
+                    }
                     drawHelper.setIndexRange(pls::PatchIndexCount(drawType),
                                              pls::PatchBaseIndex(drawType));
-                    m_state->setCullFace(GL_BACK);
                     drawHelper.draw();
                     break;
                 }
@@ -1314,6 +2090,21 @@ void PLSRenderContextGLImpl::flush(const FlushDescriptor& desc)
                 drawHelper.setIndexRange(pls::PatchFanIndexCount(drawType),
                                          pls::PatchFanBaseIndex(drawType));
 
+                if (drawType == pls::DrawType::outerCurvePatches)
+                {
+                    // Interior triangulations use stencil-then-cover. The outer curves only count
+                    // their windings in the stencil buffer; the interiorTriangulation batch that
+                    // follows adds the interior triangles and then covers the path.
+                    assert(!isClipUpdate);
+                    glStencilFunc(hasActiveClip ? GL_LEQUAL : GL_ALWAYS, 0x80, 0xff);
+                    glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_KEEP, GL_INCR_WRAP);
+                    glStencilOpSeparate(GL_BACK, GL_KEEP, GL_KEEP, GL_DECR_WRAP);
+                    m_state->setWriteMasks(false, false, isEvenOddFill ? 0x1 : 0x7f);
+                    m_state->setCullFace(GL_NONE);
+                    drawHelper.draw();
+                    break;
+                }
+
                 // "nonZero" fill rules (that aren't nested clip updates) can be optimized to render
                 // directly instead of using a "stencil then cover" approach.
                 if (!isEvenOddFill && !isNestedClipUpdate)
@@ -1406,11 +2197,38 @@ void PLSRenderContextGLImpl::flush(const FlushDescriptor& desc)
             }
             case pls::DrawType::interiorTriangulation:
             {
-                assert(desc.interlockMode != pls::InterlockMode::depthStencil); // TODO!
-                m_plsImpl->ensureRasterOrderingEnabled(this, desc, false);
                 m_state->bindVAO(m_trianglesVAO);
-                m_state->setCullFace(GL_BACK);
-                glDrawArrays(GL_TRIANGLES, batch.baseElement, batch.elementCount);
+                if (desc.interlockMode != pls::InterlockMode::depthStencil)
+                {
+                    m_plsImpl->ensureRasterOrderingEnabled(this, desc, false);
+                    m_state->setCullFace(GL_BACK);
+                    glDrawArrays(GL_TRIANGLES, batch.baseElement, batch.elementCount);
+                    break;
+                }
+
+                // Add the interior triangles to the windings that the outer curves already
+                // counted in the stencil buffer. (Each triangle counts +/-1 by its orientation.)
+                assert(!(batch.drawContents & pls::DrawContents::clipUpdate));
+                assert(batch.elementCount >= pls::kStencilCoverVertexCount);
+                bool hasActiveClip = ((batch.drawContents & pls::DrawContents::activeClip));
+                bool isEvenOddFill = (batch.drawContents & pls::DrawContents::evenOddFill);
+                GLuint stencilWriteMask = isEvenOddFill ? 0x1 : 0x7f;
+                uint32_t stencilVertexCount = batch.elementCount - pls::kStencilCoverVertexCount;
+                glStencilFunc(hasActiveClip ? GL_LEQUAL : GL_ALWAYS, 0x80, 0xff);
+                glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_KEEP, GL_INCR_WRAP);
+                glStencilOpSeparate(GL_BACK, GL_KEEP, GL_KEEP, GL_DECR_WRAP);
+                m_state->setWriteMasks(false, false, stencilWriteMask);
+                m_state->setCullFace(GL_NONE);
+                glDrawArrays(GL_TRIANGLES, batch.baseElement, stencilVertexCount);
+
+                // Cover the path's bounding box wherever the winding number is nonzero (or odd),
+                // and reset the stencil buffer for the next path.
+                m_state->setWriteMasks(true, true, stencilWriteMask);
+                glStencilFunc(GL_NOTEQUAL, 0x80, 0x7f);
+                glStencilOp(GL_KEEP, GL_KEEP, GL_ZERO);
+                glDrawArrays(GL_TRIANGLES,
+                             batch.baseElement + stencilVertexCount,
+                             pls::kStencilCoverVertexCount);
                 break;
             }
             case pls::DrawType::imageRect:
@@ -1420,11 +2238,11 @@ void PLSRenderContextGLImpl::flush(const FlushDescriptor& desc)
                 assert(m_imageRectVAO != 0); // Should have gotten lazily allocated by now.
                 m_plsImpl->ensureRasterOrderingEnabled(this, desc, false);
                 m_state->bindVAO(m_imageRectVAO);
-                glBindBufferRange(GL_UNIFORM_BUFFER,
-                                  IMAGE_DRAW_UNIFORM_BUFFER_IDX,
-                                  gl_buffer_id(imageDrawUniformBufferRing()),
-                                  batch.imageDrawDataOffset,
-                                  sizeof(pls::ImageDrawUniforms));
+                m_state->bindBufferRange(GL_UNIFORM_BUFFER,
+                                         IMAGE_DRAW_UNIFORM_BUFFER_IDX,
+                                         gl_buffer_id(imageDrawUniformBufferRing()),
+                                         batch.imageDrawDataOffset,
+                                         sizeof(pls::ImageDrawUniforms));
                 m_state->setCullFace(GL_NONE);
                 glDrawElements(GL_TRIANGLES,
                                std::size(pls::kImageRectIndices),
@@ -1447,11 +2265,11 @@ void PLSRenderContextGLImpl::flush(const FlushDescriptor& desc)
                 m_state->bindBuffer(GL_ARRAY_BUFFER, uvBuffer->submittedBufferID());
                 glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
                 m_state->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer->submittedBufferID());
-                glBindBufferRange(GL_UNIFORM_BUFFER,
-                                  IMAGE_DRAW_UNIFORM_BUFFER_IDX,
-                                  gl_buffer_id(imageDrawUniformBufferRing()),
-                                  batch.imageDrawDataOffset,
-                                  sizeof(pls::ImageDrawUniforms));
+                m_state->bindBufferRange(GL_UNIFORM_BUFFER,
+                                         IMAGE_DRAW_UNIFORM_BUFFER_IDX,
+                                         gl_buffer_id(imageDrawUniformBufferRing()),
+                                         batch.imageDrawDataOffset,
+                                         sizeof(pls::ImageDrawUniforms));
                 if (desc.interlockMode != pls::InterlockMode::depthStencil)
                 {
                     // Try to enable raster ordering for image meshes in rasterOrdering and atomic
@@ -1494,20 +2312,26 @@ void PLSRenderContextGLImpl::flush(const FlushDescriptor& desc)
         if (desc.interlockMode != pls::InterlockMode::depthStencil && batch.needsBarrier &&
             batch.drawType != pls::DrawType::imageMesh /*EW!*/)
         {
+            multiDrawHelper.submit();
             m_plsImpl->barrier(desc);
         }
     }
+    multiDrawHelper.submit();
 
     if (desc.interlockMode != pls::InterlockMode::depthStencil)
     {
         m_plsImpl->deactivatePixelLocalStorage(this, desc);
+        if (scissorsUpdateBounds)
+        {
+            m_state->disableScissor();
+        }
     }
     else
     {
         // Depth/stencil don't need to be written out.
         glInvalidateFramebuffer(GL_DRAW_FRAMEBUFFER, 2, msaaDepthStencilColor.data());
         if ((desc.combinedShaderFeatures & pls::ShaderFeatures::ENABLE_ADVANCED_BLEND) &&
-            m_capabilities.KHR_blend_equation_advanced_coherent)
+            m_msaaAdvancedBlend == MSAAAdvancedBlend::khrCoherent)
         {
             glDisable(GL_BLEND_ADVANCED_COHERENT_KHR);
         }
@@ -1535,6 +2359,55 @@ void PLSRenderContextGLImpl::flush(const FlushDescriptor& desc)
         glPolygonModeANGLE(GL_FRONT_AND_BACK, GL_FILL_ANGLE);
     }
 #endif
+
+#ifndef RIVE_WEBGL
+    if (timesGPUFrame && desc.isFinalFlushOfFrame)
+    {
+        glEndQuery(GL_TIME_ELAPSED_EXT);
+    }
+#endif
+
+    if (m_frameSyncs != nullptr && desc.isFinalFlushOfFrame)
+    {
+        m_frameSyncs->endFrame();
+    }
+}
+
+bool PLSRenderContextGLImpl::popGPUFrameTime(pls::GPUFrameTime* gpuFrameTime)
+{
+#ifndef RIVE_WEBGL
+    while (!m_pendingGPUTimers.empty())
+    {
+        PendingGPUTimer timer = m_pendingGPUTimers.front();
+        GLuint isAvailable = GL_FALSE;
+        glGetQueryObjectuiv(timer.query, GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+        if (!isAvailable)
+        {
+            return false;
+        }
+        m_pendingGPUTimers.pop_front();
+        m_availableGPUTimerQueries.push_back(timer.query);
+
+        // On GLES, a disjoint event (e.g., a change in GPU frequency) invalidates all in-flight
+        // timer queries.
+        GLint disjoint = GL_FALSE;
+        if (m_capabilities.isGLES)
+        {
+            glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+        }
+        if (disjoint)
+        {
+            continue;
+        }
+
+        GLuint64 elapsedNanoseconds;
+        glGetQueryObjectui64vEXT(timer.query, GL_QUERY_RESULT, &elapsedNanoseconds);
+        gpuFrameTime->frameNumber = timer.frameNumber;
+        gpuFrameTime->seconds = static_cast<double>(elapsedNanoseconds) * 1e-9;
+        return true;
+    }
+#endif
+    return false;
 }
 
 void PLSRenderContextGLImpl::blitTextureToFramebufferAsDraw(GLuint textureID,
@@ -1567,12 +2440,54 @@ void PLSRenderContextGLImpl::blitTextureToFramebufferAsDraw(GLuint textureID,
     m_state->setWriteMasks(true, true, 0xff);
     m_state->disableBlending();
     m_state->setCullFace(GL_NONE);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glEnable(GL_SCISSOR_TEST);
-    glScissor(bounds.left, renderTargetHeight - bounds.bottom, bounds.width(), bounds.height());
+    m_state->bindTexture(GL_TEXTURE0, textureID);
+    m_state->setScissor(bounds.left,
+                        renderTargetHeight - bounds.bottom,
+                        bounds.width(),
+                        bounds.height());
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    m_state->disableScissor();
+}
+
+void PLSRenderContextGLImpl::upscaleLayer(const PLSTexture* layerTexture,
+                                          PLSRenderTarget* renderTarget,
+                                          void* externalCommandBuffer)
+{
+    if (m_upscaleAsDrawProgram == 0)
+    {
+        const char* upscaleDefines[] = {GLSL_ENABLE_UPSCALE};
+        const char* upscaleSources[] = {glsl::constants, glsl::common, glsl::blit_texture_as_draw};
+        m_upscaleAsDrawProgram = glutils::Program();
+        m_upscaleAsDrawProgram.compileAndAttachShader(GL_VERTEX_SHADER,
+                                                      upscaleDefines,
+                                                      std::size(upscaleDefines),
+                                                      upscaleSources,
+                                                      std::size(upscaleSources),
+                                                      m_capabilities);
+        m_upscaleAsDrawProgram.compileAndAttachShader(GL_FRAGMENT_SHADER,
+                                                      upscaleDefines,
+                                                      std::size(upscaleDefines),
+                                                      upscaleSources,
+                                                      std::size(upscaleSources),
+                                                      m_capabilities);
+        m_upscaleAsDrawProgram.link();
+        m_state->bindProgram(m_upscaleAsDrawProgram);
+        glUniform1i(glGetUniformLocation(m_upscaleAsDrawProgram, GLSL_blitTextureSource), 0);
+    }
+
+    auto renderTargetGL = static_cast<PLSRenderTargetGL*>(renderTarget);
+    renderTargetGL->bindDestinationFramebuffer(GL_DRAW_FRAMEBUFFER);
+    m_state->invalidateFramebufferBindings();
+    m_state->setViewport(0, 0, renderTarget->width(), renderTarget->height());
+    m_state->disableScissor();
+    m_state->bindProgram(m_upscaleAsDrawProgram);
+    m_state->bindVAO(m_emptyVAO);
+    m_state->setWriteMasks(true, true, 0xff);
+    m_state->disableBlending();
+    m_state->setCullFace(GL_NONE);
+    m_state->bindTexture(GL_TEXTURE0,
+                         static_cast<const PLSTextureGLImpl*>(layerTexture)->textureID());
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-    glDisable(GL_SCISSOR_TEST);
 }
 
 std::unique_ptr<PLSRenderContext> PLSRenderContextGLImpl::MakeContext(
@@ -1677,6 +2592,10 @@ std::unique_ptr<PLSRenderContext> PLSRenderContextGLImpl::MakeContext(
         {
             capabilities.ANGLE_base_vertex_base_instance_shader_builtin = true;
         }
+        else if (strcmp(ext, "GL_ANGLE_multi_draw") == 0)
+        {
+            capabilities.ANGLE_multi_draw = true;
+        }
         else if (strcmp(ext, "GL_ANGLE_shader_pixel_local_storage") == 0)
         {
             capabilities.ANGLE_shader_pixel_local_storage = true;
@@ -1717,14 +2636,26 @@ std::unique_ptr<PLSRenderContext> PLSRenderContextGLImpl::MakeContext(
         {
             capabilities.KHR_blend_equation_advanced_coherent = true;
         }
+        else if (strcmp(ext, "GL_KHR_parallel_shader_compile") == 0)
+        {
+            capabilities.KHR_parallel_shader_compile = true;
+        }
         else if (strcmp(ext, "GL_EXT_base_instance") == 0)
         {
             capabilities.EXT_base_instance = true;
         }
+        else if (strcmp(ext, "GL_EXT_buffer_storage") == 0)
+        {
+            capabilities.EXT_buffer_storage = true;
+        }
         else if (strcmp(ext, "GL_EXT_clip_cull_distance") == 0)
         {
             capabilities.EXT_clip_cull_distance = true;
         }
+        else if (strcmp(ext, "GL_EXT_disjoint_timer_query") == 0)
+        {
+            capabilities.EXT_disjoint_timer_query = true;
+        }
         else if (strcmp(ext, "GL_EXT_multisampled_render_to_texture") == 0)
         {
             capabilities.EXT_multisampled_render_to_texture = true;
@@ -1749,6 +2680,23 @@ std::unique_ptr<PLSRenderContext> PLSRenderContextGLImpl::MakeContext(
         {
             capabilities.QCOM_shader_framebuffer_fetch_noncoherent = true;
         }
+        else if (strcmp(ext, "GL_OES_EGL_image") == 0)
+        {
+            capabilities.OES_EGL_image = true;
+        }
+        else if (strcmp(ext, "GL_KHR_debug") == 0)
+        {
+            capabilities.KHR_debug = true;
+        }
+        else if (strcmp(ext, "GL_KHR_texture_compression_astc_ldr") == 0)
+        {
+            capabilities.KHR_texture_compression_astc_ldr = true;
+        }
+        else if (strcmp(ext, "GL_EXT_texture_compression_bptc") == 0 ||
+                 strcmp(ext, "GL_ARB_texture_compression_bptc") == 0)
+        {
+            capabilities.EXT_texture_compression_bptc = true;
+        }
     }
 #else  // !RIVE_WEBGL -> RIVE_WEBGL
     if (webgl_enable_WEBGL_shader_pixel_local_storage_coherent())
@@ -1760,11 +2708,25 @@ std::unique_ptr<PLSRenderContext> PLSRenderContextGLImpl::MakeContext(
     {
         capabilities.ANGLE_provoking_vertex = true;
     }
+    if (webgl_enable_WEBGL_multi_draw())
+    {
+        capabilities.ANGLE_multi_draw = true;
+    }
     if (emscripten_webgl_enable_extension(emscripten_webgl_get_current_context(),
                                           "WEBGL_clip_cull_distance"))
     {
         capabilities.EXT_clip_cull_distance = true;
     }
+    if (emscripten_webgl_enable_extension(emscripten_webgl_get_current_context(),
+                                          "WEBGL_compressed_texture_astc"))
+    {
+        capabilities.KHR_texture_compression_astc_ldr = true;
+    }
+    if (emscripten_webgl_enable_extension(emscripten_webgl_get_current_context(),
+                                          "EXT_texture_compression_bptc"))
+    {
+        capabilities.EXT_texture_compression_bptc = true;
+    }
 #endif // RIVE_WEBGL
 
 #ifdef RIVE_DESKTOP_GL
@@ -1785,6 +2747,14 @@ std::unique_ptr<PLSRenderContext> PLSRenderContextGLImpl::MakeContext(
     {
         capabilities.EXT_base_instance = true;
     }
+    if (GLAD_GL_EXT_disjoint_timer_query)
+    {
+        capabilities.EXT_disjoint_timer_query = true;
+    }
+    if (GLAD_GL_EXT_buffer_storage)
+    {
+        capabilities.EXT_buffer_storage = true;
+    }
 #endif
 
     // We need four storage buffers in the vertex shader. Disable the extension if this isn't
@@ -1805,6 +2775,10 @@ std::unique_ptr<PLSRenderContext> PLSRenderContextGLImpl::MakeContext(
         capabilities.ARB_fragment_shader_interlock = false;
         capabilities.INTEL_fragment_shader_ordering = false;
     }
+    if (contextOptions.disablePersistentlyMappedBuffers)
+    {
+        capabilities.EXT_buffer_storage = false;
+    }
 
     GLenum rendererToken = GL_RENDERER;
 #ifdef RIVE_WEBGL
@@ -1835,7 +2809,10 @@ std::unique_ptr<PLSRenderContext> PLSRenderContextGLImpl::MakeContext(
             (capabilities.ARM_shader_framebuffer_fetch ||
              capabilities.EXT_shader_framebuffer_fetch))
         {
-            return MakeContext(rendererString, capabilities, MakePLSImplEXTNative(capabilities));
+            return MakeContext(rendererString,
+                               capabilities,
+                               MakePLSImplEXTNative(capabilities),
+                               contextOptions);
         }
 
         if (capabilities.EXT_shader_framebuffer_fetch)
@@ -1846,7 +2823,8 @@ std::unique_ptr<PLSRenderContext> PLSRenderContextGLImpl::MakeContext(
             {
                 return MakeContext(rendererString,
                                    capabilities,
-                                   MakePLSImplFramebufferFetch(capabilities));
+                                   MakePLSImplFramebufferFetch(capabilities),
+                                   contextOptions);
             }
         }
 #else
@@ -1856,7 +2834,10 @@ std::unique_ptr<PLSRenderContext> PLSRenderContextGLImpl::MakeContext(
             // extension. Use MSAA on Adreno.
             if (strstr(rendererString, "Adreno") == nullptr)
             {
-                return MakeContext(rendererString, capabilities, MakePLSImplWebGL());
+                return MakeContext(rendererString,
+                                   capabilities,
+                                   MakePLSImplWebGL(),
+                                   contextOptions);
             }
         }
 #endif
@@ -1864,21 +2845,25 @@ std::unique_ptr<PLSRenderContext> PLSRenderContextGLImpl::MakeContext(
 #ifdef RIVE_DESKTOP_GL
         if (capabilities.ARB_shader_image_load_store)
         {
-            return MakeContext(rendererString, capabilities, MakePLSImplRWTexture());
+            return MakeContext(rendererString,
+                               capabilities,
+                               MakePLSImplRWTexture(),
+                               contextOptions);
         }
 #endif
     }
 
-    return MakeContext(rendererString, capabilities, nullptr);
+    return MakeContext(rendererString, capabilities, nullptr, contextOptions);
 }
 
 std::unique_ptr<PLSRenderContext> PLSRenderContextGLImpl::MakeContext(
     const char* rendererString,
     GLCapabilities capabilities,
-    std::unique_ptr<PLSImpl> plsImpl)
+    std::unique_ptr<PLSImpl> plsImpl,
+    const ContextOptions& contextOptions)
 {
-    auto plsContextImpl = std::unique_ptr<PLSRenderContextGLImpl>(
-        new PLSRenderContextGLImpl(rendererString, capabilities, std::move(plsImpl)));
+    auto plsContextImpl = std::unique_ptr<PLSRenderContextGLImpl>(new PLSRenderContextGLImpl(
+        rendererString, capabilities, std::move(plsImpl), contextOptions));
     return std::make_unique<PLSRenderContext>(std::move(plsContextImpl));
 }
 } // namespace rive::pls
@@ -12,6 +12,23 @@ namespace rive::pls
 {
 TextureRenderTargetGL::~TextureRenderTargetGL() {}
 
+#ifdef RIVE_ANDROID
+void TextureRenderTargetGL::setTargetEGLImage(GLeglImageOES eglImage)
+{
+    if (eglImage == nullptr)
+    {
+        m_eglImageTexture = glutils::Texture::Zero();
+        setTargetTexture(0);
+        return;
+    }
+    m_eglImageTexture = glutils::Texture();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_eglImageTexture);
+    glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, eglImage);
+    setTargetTexture(m_eglImageTexture);
+}
+#endif
+
 static glutils::Texture make_backing_texture(GLenum internalformat, uint32_t width, uint32_t height)
 {
     glutils::Texture texture;
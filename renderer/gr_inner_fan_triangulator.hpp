@@ -17,6 +17,9 @@ namespace rive
 // Triangulates the inner polygon(s) of a path (i.e., the triangle fan for a Redbook rendering
 // method). When combined with the outer curves and grout triangles, these produce a complete path.
 // If a groutCollector is not provided, pathToPolys fails upon self intersection.
+//
+// If 'emitUnitWindingTriangles' is true, the triangles are emitted for stencil-then-cover instead
+// of with winding weights. (See GrTriangulator::fEmitUnitWindingTriangles.)
 class GrInnerFanTriangulator : private GrTriangulator
 {
 public:
@@ -26,12 +29,14 @@ public:
                            const Mat2D& viewMatrix,
                            Comparator::Direction direction,
                            FillRule fillRule,
+                           bool emitUnitWindingTriangles,
                            TrivialBlockAllocator* alloc) :
         GrTriangulator(direction, fillRule, alloc),
         m_shouldReverseTriangles(viewMatrix[0] * viewMatrix[3] - viewMatrix[2] * viewMatrix[1] < 0)
     {
         fPreserveCollinearVertices = true;
         fCollectBreadcrumbTriangles = true;
+        fEmitUnitWindingTriangles = emitUnitWindingTriangles;
         bool isLinear;
         auto [polys, success] = GrTriangulator::pathToPolys(path, 0, AABB{}, &isLinear);
         if (success)
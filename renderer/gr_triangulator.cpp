@@ -13,6 +13,7 @@
 #include "gr_triangulator.hpp"
 
 #include <algorithm>
+#include <memory>
 
 #if !defined(SK_ENABLE_OPTIMIZE_SIZE)
 
@@ -496,6 +497,22 @@ void GrTriangulator::emitTriangle(
     bool reverseTriangles,
     pls::WriteOnlyMappedMemory<pls::TriangleVertex>* mappedMemory) const
 {
+    if (fEmitUnitWindingTriangles)
+    {
+        // Orient each copy clockwise in pixel space when its pls weight (-winding, negated again
+        // by left-handed view matrices) is positive, and counterclockwise when it's negative. The
+        // left-handed flip and the weight's flip cancel out, so only the winding sign matters.
+        if (winding > 0)
+        {
+            std::swap(prev, next);
+        }
+        int unitWinding = winding > 0 ? 1 : -1;
+        for (int i = std::abs(winding); i > 1; --i)
+        {
+            emit_triangle(prev, curr, next, unitWinding, pathID, mappedMemory);
+        }
+        return emit_triangle(prev, curr, next, unitWinding, pathID, mappedMemory);
+    }
     if (reverseTriangles)
     {
         std::swap(prev, next);
@@ -2341,10 +2358,14 @@ std::tuple<Poly*, bool> GrTriangulator::pathToPolys(const RawPath& path,
         contourCnt++;
     }
 #endif
-    std::unique_ptr<VertexList[]> contours(new VertexList[contourCnt]);
+    // The contour lists live on fAlloc with the rest of the mesh, so a triangulation doesn't touch
+    // the heap once the (reused) allocator has grown to fit it.
+    VertexList* contours = static_cast<VertexList*>(
+        fAlloc->alloc<alignof(VertexList)>(sizeof(VertexList) * contourCnt));
+    std::uninitialized_fill_n(contours, contourCnt, VertexList());
 
-    this->pathToContours(path, tolerance, clipBounds, contours.get(), isLinear);
-    return this->contoursToPolys(contours.get(), contourCnt);
+    this->pathToContours(path, tolerance, clipBounds, contours, isLinear);
+    return this->contoursToPolys(contours, contourCnt);
 }
 
 int64_t GrTriangulator::CountPoints(Poly* polys, FillRule overrideFillType)
@@ -2364,7 +2385,20 @@ int64_t GrTriangulator::CountPoints(Poly* polys, FillRule overrideFillType)
 
 size_t GrTriangulator::countMaxTriangleVertices(Poly* polys) const
 {
-    return CountPoints(polys, fFillRule);
+    if (!fEmitUnitWindingTriangles)
+    {
+        return CountPoints(polys, fFillRule);
+    }
+    int64_t count = 0;
+    for (Poly* poly = polys; poly; poly = poly->fNext)
+    {
+        if (apply_fill_type(fFillRule, poly) && poly->fCount >= 3)
+        {
+            count += (poly->fCount - 2) * (TRIANGULATOR_WIREFRAME ? 6 : 3) *
+                     std::abs(poly->fWinding);
+        }
+    }
+    return count;
 }
 
 size_t GrTriangulator::polysToTriangles(
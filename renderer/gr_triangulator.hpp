@@ -280,6 +280,10 @@ protected:
 #endif
     bool fPreserveCollinearVertices = false;
     bool fCollectBreadcrumbTriangles = false;
+    // Instead of emitting each triangle once, clockwise, with its winding number as a weight, emit
+    // abs(winding) copies whose orientation carries the sign. (For counting windings in the stencil
+    // buffer, where each triangle can only increment or decrement.)
+    bool fEmitUnitWindingTriangles = false;
 
     // The breadcrumb triangles serve as a glue that erases T-junctions between a path's outer
     // curves and its inner polygon triangulation. Drawing a path's outer curves, breadcrumb
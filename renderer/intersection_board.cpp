@@ -9,13 +9,14 @@
 #if !SIMD_NATIVE_GVEC && (defined(__SSE2__) || defined(_M_AMD64) || defined(_M_X64))
 // MSVC doesn't get codegen for the inner loop. Provide direct SSE intrinsics.
 #include <emmintrin.h>
+#include <array>
 #define FALLBACK_ON_SSE2_INTRINSICS
 #else
 #endif
 
 namespace rive::pls
 {
-void IntersectionTile::reset(int left, int top, int16_t baselineGroupIndex)
+void IntersectionTile::reset(int left, int top, int32_t baselineGroupIndex)
 {
     // Since we mask non-intersecting groupIndices to zero, the "mask and max" algorithm is only
     // correct for positive values. (baselineGroupIndex is only signed because SSE doesn't have an
@@ -29,7 +30,7 @@ void IntersectionTile::reset(int left, int top, int16_t baselineGroupIndex)
     m_rectangleCount = 0;
 }
 
-void IntersectionTile::addRectangle(int4 ltrb, int16_t groupIndex)
+void IntersectionTile::addRectangle(int4 ltrb, int32_t groupIndex)
 {
     assert(simd::all(ltrb.xy < ltrb.zw)); // Ensure ltrb isn't zero or negative.
     // Ensure this rectangle preserves the integrity of our list.
@@ -79,8 +80,8 @@ void IntersectionTile::addRectangle(int4 ltrb, int16_t groupIndex)
     ++m_rectangleCount;
 }
 
-int16x8 IntersectionTile::findMaxIntersectingGroupIndex(int4 ltrb,
-                                                        int16x8 runningMaxGroupIndices) const
+int32x8 IntersectionTile::findMaxIntersectingGroupIndex(int4 ltrb,
+                                                        int32x8 runningMaxGroupIndices) const
 {
     assert(simd::all(ltrb.xy < ltrb.zw)); // Ensure ltrb isn't zero or negative.
 
@@ -138,12 +139,13 @@ int16x8 IntersectionTile::findMaxIntersectingGroupIndex(int4 ltrb,
         // Each element of isectMasks8 is 0xff if we intersect with the corresponding rectangle,
         // otherwise 0.
         int8x8 isectMasks8 = math::bit_cast<int8x8>(isectMask);
-        // Widen isectMasks8 to 16 bits per mask, where each element of isectMasks16 is 0xffff if we
-        // intersect with the rectangle, otherwise 0.
+        // Widen isectMasks8 to 32 bits per mask, where each element of isectMasks32 is 0xffffffff
+        // if we intersect with the rectangle, otherwise 0.
         int16x8 isectMasks16 = math::bit_cast<int16x8>(simd::zip(isectMasks8, isectMasks8));
+        int32x8 isectMasks32 = math::bit_cast<int32x8>(simd::zip(isectMasks16, isectMasks16));
         // Mask out any groupIndices we don't intersect with so they don't participate in the test
         // for maximum groupIndex.
-        int16x8 maskedGroupIndices = isectMasks16 & *groupIndices;
+        int32x8 maskedGroupIndices = isectMasks32 & *groupIndices;
         runningMaxGroupIndices = simd::max(maskedGroupIndices, runningMaxGroupIndices);
     }
 #else
@@ -152,7 +154,15 @@ int16x8 IntersectionTile::findMaxIntersectingGroupIndex(int4 ltrb,
     const __m128i* groupIndices = reinterpret_cast<const __m128i*>(m_groupIndices.data());
     __m128i complementLO = math::bit_cast<__m128i>(simd::join(r, b));
     __m128i complementHI = math::bit_cast<__m128i>(simd::join(_l, _t));
-    __m128i localMaxGroupIndices = math::bit_cast<__m128i>(runningMaxGroupIndices);
+    // SSE2 doesn't have _mm_max_epi32. Since the masked group indices are never negative, a
+    // compare and select works just as well.
+    auto max_epi32 = [](__m128i a, __m128i b) {
+        __m128i aIsGreater = _mm_cmpgt_epi32(a, b);
+        return _mm_or_si128(_mm_and_si128(aIsGreater, a), _mm_andnot_si128(aIsGreater, b));
+    };
+    auto localMaxGroupIndices = math::bit_cast<std::array<__m128i, 2>>(runningMaxGroupIndices);
+    __m128i localMaxGroupIndicesLO = localMaxGroupIndices[0];
+    __m128i localMaxGroupIndicesHI = localMaxGroupIndices[1];
     for (size_t i = 0; i < m_groupIndices.size(); ++i)
     {
         __m128i edgesLO = edgeData[i * 2];
@@ -167,12 +177,19 @@ int16x8 IntersectionTile::findMaxIntersectingGroupIndex(int4 ltrb,
         __m128i partialIsectMasksLR16 = _mm_unpacklo_epi8(partialIsectMasks, partialIsectMasks);
         // AND LR masks with TB masks for a full LTRB intersection mask.
         __m128i isectMasks16 = _mm_and_si128(partialIsectMasksLR16, partialIsectMasksTB16);
+        // Widen the masks again to 32 bits.
+        __m128i isectMasks32LO = _mm_unpacklo_epi16(isectMasks16, isectMasks16);
+        __m128i isectMasks32HI = _mm_unpackhi_epi16(isectMasks16, isectMasks16);
         // Mask out the groupIndices that don't intersect.
-        __m128i intersectingGroupIndices = _mm_and_si128(isectMasks16, groupIndices[i]);
+        __m128i intersectingGroupIndicesLO = _mm_and_si128(isectMasks32LO, groupIndices[i * 2]);
+        __m128i intersectingGroupIndicesHI =
+            _mm_and_si128(isectMasks32HI, groupIndices[i * 2 + 1]);
         // Accumulate max intersecting groupIndices.
-        localMaxGroupIndices = _mm_max_epi16(intersectingGroupIndices, localMaxGroupIndices);
+        localMaxGroupIndicesLO = max_epi32(intersectingGroupIndicesLO, localMaxGroupIndicesLO);
+        localMaxGroupIndicesHI = max_epi32(intersectingGroupIndicesHI, localMaxGroupIndicesHI);
     }
-    runningMaxGroupIndices = math::bit_cast<int16x8>(localMaxGroupIndices);
+    localMaxGroupIndices = {localMaxGroupIndicesLO, localMaxGroupIndicesHI};
+    runningMaxGroupIndices = math::bit_cast<int32x8>(localMaxGroupIndices);
 #endif // !FALLBACK_ON_SSE2_INTRINSICS
 
     // Ensure we never drop below our baseline index.
@@ -203,7 +220,7 @@ void IntersectionBoard::resizeAndReset(uint32_t viewportWidth, uint32_t viewport
     }
 }
 
-int16_t IntersectionBoard::addRectangle(int4 ltrb)
+int32_t IntersectionBoard::addRectangle(int4 ltrb, int32_t groupIndexIncrement)
 {
     // Discard empty, negative, or offscreen rectangles.
     if (simd::any(ltrb.xy >= m_viewportSize || ltrb.zw <= 0 || ltrb.xy >= ltrb.zw))
@@ -221,7 +238,7 @@ int16_t IntersectionBoard::addRectangle(int4 ltrb)
     assert(simd::all(span.xy <= span.zw));
 
     // Accumulate the max groupIndex from each tile the rectangle touches.
-    int16x8 maxGroupIndices = 0;
+    int32x8 maxGroupIndices = 0;
     for (int y = span.y; y <= span.w; ++y)
     {
         auto tileIter = m_tiles.begin() + y * m_cols + span.x;
@@ -233,13 +250,14 @@ int16_t IntersectionBoard::addRectangle(int4 ltrb)
     }
 
     // Find the absolute max group index this rectangle intersects with.
-    int16_t maxGroupIndex = simd::reduce_max(maxGroupIndices);
+    int32_t maxGroupIndex = simd::reduce_max(maxGroupIndices);
     // It is the caller's responsibility to not insert more rectangles than can fit in a signed
-    // 16-bit integer.
-    assert(maxGroupIndex < std::numeric_limits<int16_t>::max());
+    // 32-bit integer.
+    assert(maxGroupIndex < std::numeric_limits<int32_t>::max());
 
     // Add the rectangle and its newly-found groupIndex to each tile it touches.
-    int16_t nextGroupIndex = maxGroupIndex + 1;
+    assert(groupIndexIncrement == 0 || groupIndexIncrement == 1);
+    int32_t nextGroupIndex = std::max(maxGroupIndex + groupIndexIncrement, 1);
     for (int y = span.y; y <= span.w; ++y)
     {
         auto tileIter = m_tiles.begin() + y * m_cols + span.x;
@@ -9,28 +9,30 @@
 
 namespace rive::pls
 {
+using int32x8 = simd::gvec<int32_t, 8>;
+
 // 255 x 255 tile that manages a set of rectangles and their groupIndex.
 // From a given rectangle, finds the max groupIndex in the set of internal rectangles it intersects.
 // The size is 255 so we can store bounding box coordinates in 8 bits.
 class IntersectionTile
 {
 public:
-    void reset(int left, int top, int16_t baselineGroupIndex = 0);
+    void reset(int left, int top, int32_t baselineGroupIndex = 0);
 
-    void addRectangle(int4 ltrb, int16_t groupIndex);
+    void addRectangle(int4 ltrb, int32_t groupIndex);
 
     // Accumulate local maximum intersecting group indices for the given rectangle in each channel
-    // of a int16x8.
+    // of a int32x8.
     // "runningMaxGroupIndices" is a running set of local maximums if the IntersectionBoard also ran
     // this same test on other tile(s) that the rectangle touched.
     // The absolute maximum group index that this rectangle intersects with will be
     // simd::reduce_max(returnValue).
-    int16x8 findMaxIntersectingGroupIndex(int4 ltrb, int16x8 runningMaxGroupIndices) const;
+    int32x8 findMaxIntersectingGroupIndex(int4 ltrb, int32x8 runningMaxGroupIndices) const;
 
 private:
     int4 m_topLeft;
-    int16_t m_baselineGroupIndex;
-    int16_t m_maxGroupIndex;
+    int32_t m_baselineGroupIndex;
+    int32_t m_maxGroupIndex;
     size_t m_rectangleCount = 0;
 
     // How many rectangles/groupIndices are in each chunk of data?
@@ -41,9 +43,10 @@ private:
     std::vector<int8x32> m_edges;
     static_assert(sizeof(m_edges[0]) == kChunkSize * 4);
 
-    // Chunk of 8 groupIndices corresponding to the above edges.
-    std::vector<int16x8> m_groupIndices;
-    static_assert(sizeof(m_groupIndices[0]) == kChunkSize * 2);
+    // Chunk of 8 groupIndices corresponding to the above edges. These are 32 bits so a single
+    // board can order more than 32767 draws.
+    std::vector<int32x8> m_groupIndices;
+    static_assert(sizeof(m_groupIndices[0]) == kChunkSize * 4);
 };
 
 // Manages a set of rectangles and their groupIndex across a variable-sized viewport.
@@ -61,8 +64,12 @@ public:
     // If it does not intersect with any other rectangles, this groupIndex is 1.
     //
     // It is the caller's responsibility to not insert more rectangles than can fit in a signed
-    // 16-bit integer. (The result is signed because SSE doesn't have an unsigned max instruction.)
-    int16_t addRectangle(int4 ltrb);
+    // 32-bit integer. (The result is signed because SSE doesn't have an unsigned max instruction.)
+    //
+    // With a groupIndexIncrement of 0, the rectangle joins the max group it intersects instead (or
+    // group 1 if it doesn't intersect anything). This partitions rectangles into "phases" that
+    // only advance at whichever rectangles need a barrier.
+    int32_t addRectangle(int4 ltrb, int32_t groupIndexIncrement = 1);
 
 private:
     int2 m_viewportSize;
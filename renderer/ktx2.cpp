@@ -0,0 +1,113 @@
+/*
+ * Copyright 2024 Rive
+ */
+
+#include "ktx2.hpp"
+
+#include <cstring>
+
+namespace rive::pls
+{
+constexpr static uint8_t kKTX2Identifier[12] =
+    {0xab, 'K', 'T', 'X', ' ', '2', '0', 0xbb, '\r', '\n', 0x1a, '\n'};
+
+// Byte offsets of the fields we read out of the KTX2 header.
+constexpr static size_t kVkFormatOffset = 12;
+constexpr static size_t kPixelWidthOffset = 20;
+constexpr static size_t kPixelHeightOffset = 24;
+constexpr static size_t kPixelDepthOffset = 28;
+constexpr static size_t kLayerCountOffset = 32;
+constexpr static size_t kFaceCountOffset = 36;
+constexpr static size_t kLevelCountOffset = 40;
+constexpr static size_t kSupercompressionSchemeOffset = 44;
+constexpr static size_t kLevelIndexOffset = 80;
+constexpr static size_t kLevelIndexEntrySize = 24; // byteOffset, byteLength, uncompressedLength.
+
+// VkFormat values for the formats we support.
+constexpr static uint32_t kVkFormatBC7UnormBlock = 145;
+constexpr static uint32_t kVkFormatETC2R8G8B8A8UnormBlock = 151;
+constexpr static uint32_t kVkFormatASTC4x4UnormBlock = 157;
+
+template <typename T> static T read_le(const uint8_t* data)
+{
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i)
+    {
+        value |= static_cast<T>(data[i]) << (i * 8);
+    }
+    return value;
+}
+
+bool IsKTX2(Span<const uint8_t> encodedBytes)
+{
+    return encodedBytes.size() >= sizeof(kKTX2Identifier) &&
+           memcmp(encodedBytes.data(), kKTX2Identifier, sizeof(kKTX2Identifier)) == 0;
+}
+
+bool ParseKTX2(Span<const uint8_t> encodedBytes, KTX2Image* image)
+{
+    if (!IsKTX2(encodedBytes) || encodedBytes.size() < kLevelIndexOffset)
+    {
+        return false;
+    }
+    const uint8_t* header = encodedBytes.data();
+
+    switch (read_le<uint32_t>(header + kVkFormatOffset))
+    {
+        case kVkFormatBC7UnormBlock:
+            image->format = CompressedTextureFormat::bc7;
+            break;
+        case kVkFormatETC2R8G8B8A8UnormBlock:
+            image->format = CompressedTextureFormat::etc2RGBA8;
+            break;
+        case kVkFormatASTC4x4UnormBlock:
+            image->format = CompressedTextureFormat::astc4x4;
+            break;
+        default:
+            return false;
+    }
+
+    image->width = read_le<uint32_t>(header + kPixelWidthOffset);
+    image->height = read_le<uint32_t>(header + kPixelHeightOffset);
+    if (image->width == 0 || image->height == 0 ||
+        read_le<uint32_t>(header + kPixelDepthOffset) != 0 ||
+        read_le<uint32_t>(header + kLayerCountOffset) > 1 ||
+        read_le<uint32_t>(header + kFaceCountOffset) != 1 ||
+        read_le<uint32_t>(header + kSupercompressionSchemeOffset) != 0)
+    {
+        return false;
+    }
+
+    // A levelCount of 0 asks the loader to generate mipmaps, which we can't do for compressed
+    // formats. Just use the base level.
+    uint32_t levelCount = std::max(read_le<uint32_t>(header + kLevelCountOffset), 1u);
+    if (levelCount > 32 ||
+        encodedBytes.size() < kLevelIndexOffset + levelCount * kLevelIndexEntrySize)
+    {
+        return false;
+    }
+
+    image->mipLevelCount = levelCount;
+    image->data.resize(
+        CompressedTextureSizeInBytes(image->width, image->height, image->mipLevelCount));
+    size_t dstOffset = 0;
+    for (uint32_t level = 0; level < levelCount; ++level)
+    {
+        const uint8_t* entry = header + kLevelIndexOffset + level * kLevelIndexEntrySize;
+        uint64_t byteOffset = read_le<uint64_t>(entry);
+        uint64_t byteLength = read_le<uint64_t>(entry + 8);
+        size_t expectedLength =
+            CompressedTextureLevelSizeInBytes(std::max(image->width >> level, 1u),
+                                              std::max(image->height >> level, 1u));
+        if (byteLength != expectedLength || byteOffset > encodedBytes.size() ||
+            byteLength > encodedBytes.size() - byteOffset)
+        {
+            return false;
+        }
+        memcpy(image->data.data() + dstOffset, header + byteOffset, byteLength);
+        dstOffset += byteLength;
+    }
+    assert(dstOffset == image->data.size());
+    return true;
+}
+} // namespace rive::pls
@@ -0,0 +1,32 @@
+/*
+ * Copyright 2024 Rive
+ */
+
+#pragma once
+
+#include "rive/pls/pls.hpp"
+#include "rive/span.hpp"
+#include <vector>
+
+namespace rive::pls
+{
+// Pre-compressed image parsed out of a KTX2 container. Only single-layer, single-face 2D textures
+// in one of the CompressedTextureFormats, without supercompression, are supported. (Basis
+// Universal payloads need a transcoder, which the client is expected to run before handing us the
+// data.)
+struct KTX2Image
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t mipLevelCount;
+    CompressedTextureFormat format;
+    // Every mip level, tightly packed beginning with the base level.
+    std::vector<uint8_t> data;
+};
+
+// Returns true if 'encodedBytes' begins with the KTX2 file identifier.
+bool IsKTX2(Span<const uint8_t> encodedBytes);
+
+// Returns false if 'encodedBytes' is not a KTX2 file we know how to load.
+bool ParseKTX2(Span<const uint8_t> encodedBytes, KTX2Image*);
+} // namespace rive::pls
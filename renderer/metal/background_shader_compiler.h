@@ -7,8 +7,12 @@
 #include "rive/pls/pls.hpp"
 #include "rive/pls/metal/pls_render_context_metal_impl.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
 #include <queue>
 #include <thread>
+#include <vector>
 
 #import <Metal/Metal.h>
 
@@ -25,8 +29,11 @@ struct BackgroundCompileJob
     id<MTLLibrary> compiledLibrary;
 };
 
-// Compiles "draw" shaders in a background thread. A "draw" shaders is either draw_path.glsl or
-// draw_image_mesh.glsl, with a specific set of features enabled.
+// Compiles "draw" shaders on a pool of background threads. A "draw" shaders is either
+// draw_path.glsl or draw_image_mesh.glsl, with a specific set of features enabled.
+//
+// Threads are spawned as needed, up to one fewer than the number of CPU cores, so a backed-up queue
+// on first launch compiles in parallel without starving the render thread.
 class BackgroundShaderCompiler
 {
 public:
@@ -34,7 +41,9 @@ public:
     using MetalFeatures = PLSRenderContextMetalImpl::MetalFeatures;
 
     BackgroundShaderCompiler(id<MTLDevice> gpu, MetalFeatures metalFeatures) :
-        m_gpu(gpu), m_metalFeatures(metalFeatures)
+        m_gpu(gpu),
+        m_metalFeatures(metalFeatures),
+        m_maxThreadCount(std::max(std::thread::hardware_concurrency(), 2u) - 1)
     {}
 
     ~BackgroundShaderCompiler();
@@ -52,7 +61,9 @@ private:
     std::mutex m_mutex;
     std::condition_variable m_workAddedCondition;
     std::condition_variable m_workFinishedCondition;
-    bool m_shouldQuit;
-    std::thread m_compilerThread;
+    bool m_shouldQuit = false;
+    const size_t m_maxThreadCount;
+    size_t m_idleThreadCount = 0;
+    std::vector<std::thread> m_compilerThreads;
 };
 } // namespace rive::pls
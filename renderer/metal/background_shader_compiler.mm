@@ -23,11 +23,14 @@ namespace rive::pls
 {
 BackgroundShaderCompiler::~BackgroundShaderCompiler()
 {
-    if (m_compilerThread.joinable())
     {
+        std::lock_guard lock(m_mutex);
         m_shouldQuit = true;
-        m_workAddedCondition.notify_all();
-        m_compilerThread.join();
+    }
+    m_workAddedCondition.notify_all();
+    for (std::thread& thread : m_compilerThreads)
+    {
+        thread.join();
     }
 }
 
@@ -35,13 +38,14 @@ void BackgroundShaderCompiler::pushJob(const BackgroundCompileJob& job)
 {
     {
         std::lock_guard lock(m_mutex);
-        if (!m_compilerThread.joinable())
+        // Spin up another thread if every existing one is busy, up to m_maxThreadCount.
+        if (m_idleThreadCount == 0 && m_compilerThreads.size() < m_maxThreadCount)
         {
-            m_compilerThread = std::thread(&BackgroundShaderCompiler::threadMain, this);
+            m_compilerThreads.emplace_back(&BackgroundShaderCompiler::threadMain, this);
         }
         m_pendingJobs.push(std::move(job));
     }
-    m_workAddedCondition.notify_all();
+    m_workAddedCondition.notify_one();
 }
 
 bool BackgroundShaderCompiler::popFinishedJob(BackgroundCompileJob* job, bool wait)
@@ -68,7 +72,9 @@ void BackgroundShaderCompiler::threadMain()
     {
         while (m_pendingJobs.empty() && !m_shouldQuit)
         {
+            ++m_idleThreadCount;
             m_workAddedCondition.wait(lock);
+            --m_idleThreadCount;
         }
 
         if (m_shouldQuit)
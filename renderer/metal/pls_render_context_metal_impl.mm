@@ -7,6 +7,7 @@
 #include "background_shader_compiler.h"
 #include "rive/pls/buffer_ring.hpp"
 #include "rive/pls/pls_image.hpp"
+#include "rive/pls/pls_trace.hpp"
 #include "shaders/constants.glsl"
 #include <sstream>
 
@@ -141,7 +142,8 @@ public:
                  NSString* fragmentFunctionName,
                  pls::DrawType drawType,
                  pls::InterlockMode interlockMode,
-                 pls::ShaderFeatures shaderFeatures)
+                 pls::ShaderFeatures shaderFeatures,
+                 id binaryArchive)
     {
         auto makePipelineState = [=](id<MTLFunction> vertexMain,
                                      id<MTLFunction> fragmentMain,
@@ -195,7 +197,20 @@ public:
                 case pls::InterlockMode::depthStencil:
                     RIVE_UNREACHABLE();
             }
-            return make_pipeline_state(gpu, desc);
+            if (binaryArchive == nil)
+            {
+                return make_pipeline_state(gpu, desc);
+            }
+            if (@available(macOS 11, iOS 14, *))
+            {
+                // Skip the backend compile if the archive already has this pipeline, and record it
+                // for next time if not.
+                desc.binaryArchives = @[ binaryArchive ];
+                id<MTLRenderPipelineState> state = make_pipeline_state(gpu, desc);
+                [binaryArchive addRenderPipelineFunctionsWithDescriptor:desc error:nil];
+                return state;
+            }
+            RIVE_UNREACHABLE();
         };
         id<MTLFunction> vertexMain = [library newFunctionWithName:vertexFunctionName];
         id<MTLFunction> fragmentMain = [library newFunctionWithName:fragmentFunctionName];
@@ -243,15 +258,19 @@ static bool is_apple_ios_silicon(id<MTLDevice> gpu)
 class BufferRingMetalImpl : public BufferRing
 {
 public:
-    static std::unique_ptr<BufferRingMetalImpl> Make(id<MTLDevice> gpu, size_t capacityInBytes)
+    static std::unique_ptr<BufferRingMetalImpl> Make(id<MTLDevice> gpu,
+                                                     size_t capacityInBytes,
+                                                     int ringSize)
     {
-        return capacityInBytes != 0 ? std::make_unique<BufferRingMetalImpl>(gpu, capacityInBytes)
-                                    : nullptr;
+        return capacityInBytes != 0
+                   ? std::make_unique<BufferRingMetalImpl>(gpu, capacityInBytes, ringSize)
+                   : nullptr;
     }
 
-    BufferRingMetalImpl(id<MTLDevice> gpu, size_t capacityInBytes) : BufferRing(capacityInBytes)
+    BufferRingMetalImpl(id<MTLDevice> gpu, size_t capacityInBytes, int ringSize) :
+        BufferRing(capacityInBytes, ringSize)
     {
-        for (int i = 0; i < kBufferRingSize; ++i)
+        for (int i = 0; i < ringSize; ++i)
         {
             m_buffers[i] = [gpu newBufferWithLength:capacityInBytes
                                             options:MTLResourceStorageModeShared];
@@ -269,7 +288,7 @@ protected:
     void onUnmapAndSubmitBuffer(int bufferIdx, size_t mapSizeInBytes) override {}
 
 private:
-    id<MTLBuffer> m_buffers[kBufferRingSize];
+    id<MTLBuffer> m_buffers[kMaxBufferRingSize];
 };
 
 std::unique_ptr<PLSRenderContext> PLSRenderContextMetalImpl::MakeContext(
@@ -280,31 +299,76 @@ std::unique_ptr<PLSRenderContext> PLSRenderContextMetalImpl::MakeContext(
     return std::make_unique<PLSRenderContext>(std::move(plsContextImpl));
 }
 
-PLSRenderContextMetalImpl::PLSRenderContextMetalImpl(id<MTLDevice> gpu,
-                                                     const ContextOptions& contextOptions) :
-    m_contextOptions(contextOptions), m_gpu(gpu)
+std::unique_ptr<PLSRenderContext> PLSRenderContextMetalImpl::MakeContext(
+    rcp<PLSDeviceMetal> device, const ContextOptions& contextOptions)
 {
-    // It appears, so far, that we don't need to use flat interpolation for path IDs on any Apple
-    // device, and it's faster not to.
-    m_platformFeatures.avoidFlatVaryings = true;
-    m_platformFeatures.invertOffscreenY = true;
-#ifdef RIVE_IOS
-    m_platformFeatures.supportsRasterOrdering = true;
-    if (!is_apple_ios_silicon(m_gpu))
+    auto plsContextImpl = std::unique_ptr<PLSRenderContextMetalImpl>(
+        new PLSRenderContextMetalImpl(std::move(device), contextOptions));
+    return std::make_unique<PLSRenderContext>(std::move(plsContextImpl));
+}
+
+// Binary archives are only valid for the device and OS build that produced them.
+static std::string binary_archive_blob_key(id<MTLDevice> gpu)
+{
+    return PipelineBlobKeyHash()
+        .write(gpu.name.UTF8String)
+        .write([NSProcessInfo processInfo].operatingSystemVersionString.UTF8String)
+        .key("rive_metal_binary_archive_");
+}
+
+static NSURL* make_temporary_archive_url()
+{
+    NSString* filename =
+        [NSString stringWithFormat:@"rive_pls_%@.metalar", [NSUUID UUID].UUIDString];
+    return [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:filename]];
+}
+
+// Creates an MTLBinaryArchive seeded with the archive stored in 'pipelineBlobCache', if any.
+static id make_binary_archive(id<MTLDevice> gpu, PipelineBlobCache* pipelineBlobCache)
+{
+    if (@available(macOS 11, iOS 14, *))
     {
-        // The PowerVR GPU, at least on A10, has fp16 precision issues. We can't use the the bottom
-        // 3 bits of the path and clip IDs in order for our equality testing to work.
-        m_platformFeatures.pathIDGranularity = 8;
+        MTLBinaryArchiveDescriptor* desc = [MTLBinaryArchiveDescriptor new];
+        std::vector<uint8_t> blob;
+        NSURL* url = nil;
+        if (pipelineBlobCache->loadBlob(binary_archive_blob_key(gpu), &blob) && !blob.empty())
+        {
+            // Metal only loads archives from files.
+            url = make_temporary_archive_url();
+            NSData* data = [NSData dataWithBytesNoCopy:blob.data()
+                                                length:blob.size()
+                                          freeWhenDone:NO];
+            if ([data writeToURL:url atomically:NO])
+            {
+                desc.url = url;
+            }
+        }
+        NSError* err = nil;
+        id<MTLBinaryArchive> archive = [gpu newBinaryArchiveWithDescriptor:desc error:&err];
+        if (archive == nil && desc.url != nil)
+        {
+            // The stored archive was unreadable. Start over with an empty one.
+            desc.url = nil;
+            archive = [gpu newBinaryArchiveWithDescriptor:desc error:&err];
+        }
+        if (url != nil)
+        {
+            [[NSFileManager defaultManager] removeItemAtURL:url error:nil];
+        }
+        return archive;
     }
-#elif defined(RIVE_IOS_SIMULATOR)
-    // The simulator does not support framebuffer reads. Fall back on atomic mode.
-    m_platformFeatures.supportsRasterOrdering = false;
-#else
-    m_platformFeatures.supportsRasterOrdering =
-        [m_gpu supportsFamily:MTLGPUFamilyApple1] && !contextOptions.disableFramebufferReads;
-#endif
-    m_platformFeatures.atomicPLSMustBeInitializedAsDraw = true;
+    return nil;
+}
 
+rcp<PLSDeviceMetal> PLSDeviceMetal::Make(id<MTLDevice> gpu, PipelineBlobCache* pipelineBlobCache)
+{
+    return rcp(new PLSDeviceMetal(gpu, pipelineBlobCache));
+}
+
+PLSDeviceMetal::PLSDeviceMetal(id<MTLDevice> gpu, PipelineBlobCache* pipelineBlobCache) :
+    m_gpu(gpu), m_pipelineBlobCache(pipelineBlobCache)
+{
+    using AtomicBarrierType = PLSRenderContextMetalImpl::AtomicBarrierType;
 #ifdef RIVE_IOS
     // Atomic barriers are never used on iOS, but if we ever did need them, we would use
     // rasterOrderGroups.
@@ -343,6 +407,10 @@ PLSRenderContextMetalImpl::PLSRenderContextMetalImpl(id<MTLDevice> gpu,
 #endif
 
     m_backgroundShaderCompiler = std::make_unique<BackgroundShaderCompiler>(m_gpu, m_metalFeatures);
+    if (m_pipelineBlobCache != nullptr)
+    {
+        m_binaryArchive = make_binary_archive(m_gpu, m_pipelineBlobCache);
+    }
 
     // Load the precompiled shaders.
     dispatch_data_t metallibData = dispatch_data_create(
@@ -373,36 +441,6 @@ PLSRenderContextMetalImpl::PLSRenderContextMetalImpl(id<MTLDevice> gpu,
                                                length:sizeof(pls::kTessSpanIndices)
                                               options:MTLResourceStorageModeShared];
 
-    // The precompiled static library has a fully-featured shader for each drawType in
-    // "rasterOrdering" mode. We load these at initialization and use them while waiting for the
-    // background compiler to generate more specialized, higher performance shaders.
-    if (m_platformFeatures.supportsRasterOrdering)
-    {
-        for (auto drawType :
-             {DrawType::midpointFanPatches, DrawType::interiorTriangulation, DrawType::imageMesh})
-        {
-            pls::ShaderFeatures allShaderFeatures =
-                pls::ShaderFeaturesMaskFor(drawType, pls::InterlockMode::rasterOrdering);
-            uint32_t pipelineKey = ShaderUniqueKey(drawType,
-                                                   allShaderFeatures,
-                                                   pls::InterlockMode::rasterOrdering,
-                                                   pls::ShaderMiscFlags::none);
-            m_drawPipelines[pipelineKey] = std::make_unique<DrawPipeline>(
-                m_gpu,
-                m_plsPrecompiledLibrary,
-                DrawPipeline::GetPrecompiledFunctionName(drawType,
-                                                         allShaderFeatures &
-                                                             pls::kVertexShaderFeaturesMask,
-                                                         m_plsPrecompiledLibrary,
-                                                         GLSL_drawVertexMain),
-                DrawPipeline::GetPrecompiledFunctionName(
-                    drawType, allShaderFeatures, m_plsPrecompiledLibrary, GLSL_drawFragmentMain),
-                drawType,
-                pls::InterlockMode::rasterOrdering,
-                allShaderFeatures);
-        }
-    }
-
     // Create vertex and index buffers for the different PLS patches.
     m_pathPatchVertexBuffer =
         [m_gpu newBufferWithLength:kPatchVertexBufferCount * sizeof(PatchVertex)
@@ -421,7 +459,126 @@ PLSRenderContextMetalImpl::PLSRenderContextMetalImpl(id<MTLDevice> gpu,
                                                options:MTLResourceStorageModeShared];
 }
 
-PLSRenderContextMetalImpl::~PLSRenderContextMetalImpl() {}
+PLSDeviceMetal::~PLSDeviceMetal() { storeBinaryArchive(); }
+
+void PLSDeviceMetal::loadPrecompiledDrawPipelines()
+{
+    if (m_precompiledDrawPipelinesLoaded)
+    {
+        return;
+    }
+    // The precompiled static library has a fully-featured shader for each drawType in
+    // "rasterOrdering" mode. We load these at initialization and use them while waiting for the
+    // background compiler to generate more specialized, higher performance shaders.
+    for (auto drawType :
+         {DrawType::midpointFanPatches, DrawType::interiorTriangulation, DrawType::imageMesh})
+    {
+        pls::ShaderFeatures allShaderFeatures =
+            pls::ShaderFeaturesMaskFor(drawType, pls::InterlockMode::rasterOrdering);
+        uint32_t pipelineKey = ShaderUniqueKey(drawType,
+                                               allShaderFeatures,
+                                               pls::InterlockMode::rasterOrdering,
+                                               pls::ShaderMiscFlags::none);
+        m_drawPipelines[pipelineKey] = std::make_unique<DrawPipeline>(
+            m_gpu,
+            m_plsPrecompiledLibrary,
+            DrawPipeline::GetPrecompiledFunctionName(drawType,
+                                                     allShaderFeatures &
+                                                         pls::kVertexShaderFeaturesMask,
+                                                     m_plsPrecompiledLibrary,
+                                                     GLSL_drawVertexMain),
+            DrawPipeline::GetPrecompiledFunctionName(
+                drawType, allShaderFeatures, m_plsPrecompiledLibrary, GLSL_drawFragmentMain),
+            drawType,
+            pls::InterlockMode::rasterOrdering,
+            allShaderFeatures,
+            m_binaryArchive);
+        m_binaryArchiveNeedsStore |= m_binaryArchive != nil;
+    }
+    m_precompiledDrawPipelinesLoaded = true;
+}
+
+void PLSDeviceMetal::storeBinaryArchive()
+{
+    if (!m_binaryArchiveNeedsStore)
+    {
+        return;
+    }
+    assert(m_binaryArchive != nil);
+    assert(m_pipelineBlobCache != nullptr);
+    if (@available(macOS 11, iOS 14, *))
+    {
+        // Metal only serializes archives to files.
+        NSURL* url = make_temporary_archive_url();
+        NSError* err = nil;
+        if ([m_binaryArchive serializeToURL:url error:&err])
+        {
+            NSData* data = [NSData dataWithContentsOfURL:url];
+            if (data != nil)
+            {
+                m_pipelineBlobCache->storeBlob(binary_archive_blob_key(m_gpu),
+                                               data.bytes,
+                                               data.length);
+            }
+            [[NSFileManager defaultManager] removeItemAtURL:url error:nil];
+        }
+        else
+        {
+            fprintf(stderr,
+                    "Failed to serialize Metal binary archive: %s\n",
+                    err.localizedDescription.UTF8String);
+        }
+    }
+    m_binaryArchiveNeedsStore = false;
+}
+
+PLSRenderContextMetalImpl::PLSRenderContextMetalImpl(id<MTLDevice> gpu,
+                                                     const ContextOptions& contextOptions) :
+    PLSRenderContextMetalImpl(PLSDeviceMetal::Make(gpu, contextOptions.pipelineBlobCache),
+                              contextOptions)
+{}
+
+PLSRenderContextMetalImpl::PLSRenderContextMetalImpl(rcp<PLSDeviceMetal> device,
+                                                     const ContextOptions& contextOptions) :
+    m_contextOptions(contextOptions),
+    m_device(std::move(device)),
+    m_gpu(m_device->gpu()),
+    m_metalFeatures(m_device->metalFeatures())
+{
+    setBufferRingSize(m_contextOptions.bufferRingSize);
+    // It appears, so far, that we don't need to use flat interpolation for path IDs on any Apple
+    // device, and it's faster not to.
+    m_platformFeatures.avoidFlatVaryings = true;
+    m_platformFeatures.invertOffscreenY = true;
+#ifdef RIVE_IOS
+    m_platformFeatures.supportsRasterOrdering = true;
+    if (!is_apple_ios_silicon(m_gpu))
+    {
+        // The PowerVR GPU, at least on A10, has fp16 precision issues. We can't use the the bottom
+        // 3 bits of the path and clip IDs in order for our equality testing to work.
+        m_platformFeatures.pathIDGranularity = 8;
+    }
+#elif defined(RIVE_IOS_SIMULATOR)
+    // The simulator does not support framebuffer reads. Fall back on atomic mode.
+    m_platformFeatures.supportsRasterOrdering = false;
+#else
+    m_platformFeatures.supportsRasterOrdering =
+        [m_gpu supportsFamily:MTLGPUFamilyApple1] && !contextOptions.disableFramebufferReads;
+#endif
+    m_platformFeatures.atomicPLSMustBeInitializedAsDraw = true;
+    m_platformFeatures.supportsWideContourIDs = true;
+    // Every Metal GPU family supports 8192x8192 textures.
+    m_platformFeatures.maxTextureSize = 8192;
+
+    if (m_platformFeatures.supportsRasterOrdering)
+    {
+        m_device->loadPrecompiledDrawPipelines();
+    }
+}
+
+PLSRenderContextMetalImpl::~PLSRenderContextMetalImpl() { storeBinaryArchive(); }
+
+void PLSRenderContextMetalImpl::storeBinaryArchive() { m_device->storeBinaryArchive(); }
 
 // If the GPU supports framebuffer reads (called "programmable blending" in the feature tables), PLS
 // planes besides the main framebuffer can exist in ephemeral "memoryless" storage. This means their
@@ -467,6 +624,22 @@ void PLSRenderTargetMetal::setTargetTexture(id<MTLTexture> texture)
     m_targetTexture = texture;
 }
 
+void PLSRenderTargetMetal::setTargetIOSurface(IOSurfaceRef surface, NSUInteger plane)
+{
+    if (surface == nullptr)
+    {
+        m_targetTexture = nil;
+        return;
+    }
+    MTLTextureDescriptor* desc = [[MTLTextureDescriptor alloc] init];
+    desc.pixelFormat = m_pixelFormat;
+    desc.width = IOSurfaceGetWidthOfPlane(surface, plane);
+    desc.height = IOSurfaceGetHeightOfPlane(surface, plane);
+    // Leave the default storage mode; IOSurface-backed textures can't be private.
+    desc.usage = MTLTextureUsageRenderTarget | MTLTextureUsageShaderRead;
+    setTargetTexture([m_gpu newTextureWithDescriptor:desc iosurface:surface plane:plane]);
+}
+
 rcp<PLSRenderTargetMetal> PLSRenderContextMetalImpl::makeRenderTarget(MTLPixelFormat pixelFormat,
                                                                       uint32_t width,
                                                                       uint32_t height)
@@ -480,12 +653,13 @@ public:
     RenderBufferMetalImpl(RenderBufferType renderBufferType,
                           RenderBufferFlags renderBufferFlags,
                           size_t sizeInBytes,
-                          id<MTLDevice> gpu) :
-        lite_rtti_override(renderBufferType, renderBufferFlags, sizeInBytes), m_gpu(gpu)
+                          id<MTLDevice> gpu,
+                          int bufferRingSize) :
+        lite_rtti_override(renderBufferType, renderBufferFlags, sizeInBytes),
+        m_gpu(gpu),
+        m_bufferCount(flags() & RenderBufferFlags::mappedOnceAtInitialization ? 1 : bufferRingSize)
     {
-        int bufferCount =
-            flags() & RenderBufferFlags::mappedOnceAtInitialization ? 1 : pls::kBufferRingSize;
-        for (int i = 0; i < bufferCount; ++i)
+        for (int i = 0; i < m_bufferCount; ++i)
         {
             m_buffers[i] = [gpu newBufferWithLength:sizeInBytes
                                             options:MTLResourceStorageModeShared];
@@ -497,7 +671,7 @@ public:
 protected:
     void* onMap() override
     {
-        m_submittedBufferIdx = (m_submittedBufferIdx + 1) % pls::kBufferRingSize;
+        m_submittedBufferIdx = (m_submittedBufferIdx + 1) % m_bufferCount;
         assert(m_buffers[m_submittedBufferIdx] != nil);
         return m_buffers[m_submittedBufferIdx].contents;
     }
@@ -506,7 +680,8 @@ protected:
 
 private:
     id<MTLDevice> m_gpu;
-    id<MTLBuffer> m_buffers[pls::kBufferRingSize];
+    const int m_bufferCount;
+    id<MTLBuffer> m_buffers[pls::kMaxBufferRingSize];
     int m_submittedBufferIdx = -1;
 };
 
@@ -514,7 +689,7 @@ rcp<RenderBuffer> PLSRenderContextMetalImpl::makeRenderBuffer(RenderBufferType t
                                                               RenderBufferFlags flags,
                                                               size_t sizeInBytes)
 {
-    return make_rcp<RenderBufferMetalImpl>(type, flags, sizeInBytes, m_gpu);
+    return make_rcp<RenderBufferMetalImpl>(type, flags, sizeInBytes, m_gpu, bufferRingSize());
 }
 
 class PLSTextureMetalImpl : public PLSTexture
@@ -575,24 +750,24 @@ rcp<PLSTexture> PLSRenderContextMetalImpl::makeImageTexture(uint32_t width,
 
 std::unique_ptr<BufferRing> PLSRenderContextMetalImpl::makeUniformBufferRing(size_t capacityInBytes)
 {
-    return BufferRingMetalImpl::Make(m_gpu, capacityInBytes);
+    return BufferRingMetalImpl::Make(m_gpu, capacityInBytes, bufferRingSize());
 }
 
 std::unique_ptr<BufferRing> PLSRenderContextMetalImpl::makeStorageBufferRing(
     size_t capacityInBytes, pls::StorageBufferStructure)
 {
-    return BufferRingMetalImpl::Make(m_gpu, capacityInBytes);
+    return BufferRingMetalImpl::Make(m_gpu, capacityInBytes, bufferRingSize());
 }
 
 std::unique_ptr<BufferRing> PLSRenderContextMetalImpl::makeVertexBufferRing(size_t capacityInBytes)
 {
-    return BufferRingMetalImpl::Make(m_gpu, capacityInBytes);
+    return BufferRingMetalImpl::Make(m_gpu, capacityInBytes, bufferRingSize());
 }
 
 std::unique_ptr<BufferRing> PLSRenderContextMetalImpl::makeTextureTransferBufferRing(
     size_t capacityInBytes)
 {
-    return BufferRingMetalImpl::Make(m_gpu, capacityInBytes);
+    return BufferRingMetalImpl::Make(m_gpu, capacityInBytes, bufferRingSize());
 }
 
 void PLSRenderContextMetalImpl::resizeGradientTexture(uint32_t width, uint32_t height)
@@ -636,6 +811,20 @@ const PLSRenderContextMetalImpl::DrawPipeline* PLSRenderContextMetalImpl::
                                pls::ShaderFeatures shaderFeatures,
                                pls::InterlockMode interlockMode,
                                pls::ShaderMiscFlags shaderMiscFlags)
+{
+    return m_device->findCompatibleDrawPipeline(drawType,
+                                                shaderFeatures,
+                                                interlockMode,
+                                                shaderMiscFlags,
+                                                m_contextOptions.synchronousShaderCompilations);
+}
+
+const PLSDeviceMetal::DrawPipeline* PLSDeviceMetal::findCompatibleDrawPipeline(
+    pls::DrawType drawType,
+    pls::ShaderFeatures shaderFeatures,
+    pls::InterlockMode interlockMode,
+    pls::ShaderMiscFlags shaderMiscFlags,
+    bool synchronousShaderCompilations)
 {
     uint32_t pipelineKey =
         pls::ShaderUniqueKey(drawType, shaderFeatures, interlockMode, shaderMiscFlags);
@@ -685,8 +874,8 @@ const PLSRenderContextMetalImpl::DrawPipeline* PLSRenderContextMetalImpl::
     // pipeline. Otherwise, we can fall back on the fully-featured pipeline while we wait for
     // compilation.
     BackgroundCompileJob job;
-    bool shouldWaitForBackgroundCompilation = shaderFeatures == fullyFeaturedPipelineFeatures ||
-                                              m_contextOptions.synchronousShaderCompilations;
+    bool shouldWaitForBackgroundCompilation =
+        shaderFeatures == fullyFeaturedPipelineFeatures || synchronousShaderCompilations;
     while (m_backgroundShaderCompiler->popFinishedJob(&job, shouldWaitForBackgroundCompilation))
     {
         uint32_t jobKey = pls::ShaderUniqueKey(
@@ -697,7 +886,9 @@ const PLSRenderContextMetalImpl::DrawPipeline* PLSRenderContextMetalImpl::
                                                                  @GLSL_drawFragmentMain,
                                                                  job.drawType,
                                                                  job.interlockMode,
-                                                                 job.shaderFeatures);
+                                                                 job.shaderFeatures,
+                                                                 m_binaryArchive);
+        m_binaryArchiveNeedsStore |= m_binaryArchive != nil;
         if (jobKey == pipelineKey)
         {
             // The shader we wanted was actually done compiling and pending being built into a
@@ -709,15 +900,50 @@ const PLSRenderContextMetalImpl::DrawPipeline* PLSRenderContextMetalImpl::
     // The shader for this feature set hasn't finished compiling. Use the pipeline that has
     // all features enabled while we wait for it to finish.
     assert(shaderFeatures != fullyFeaturedPipelineFeatures);
-    return findCompatibleDrawPipeline(
-        drawType, fullyFeaturedPipelineFeatures, interlockMode, shaderMiscFlags);
+    return findCompatibleDrawPipeline(drawType,
+                                      fullyFeaturedPipelineFeatures,
+                                      interlockMode,
+                                      shaderMiscFlags,
+                                      synchronousShaderCompilations);
+}
+
+void PLSRenderContextMetalImpl::precompileShaders(Span<const pls::ShaderVariant> variants)
+{
+    m_device->precompileShaders(variants);
+}
+
+void PLSDeviceMetal::precompileShaders(Span<const pls::ShaderVariant> variants)
+{
+    for (const pls::ShaderVariant& variant : variants)
+    {
+        if (variant.interlockMode == pls::InterlockMode::depthStencil ||
+            variant.drawType == DrawType::plsAtomicInitialize ||
+            variant.drawType == DrawType::stencilClipReset)
+        {
+            continue;
+        }
+        uint32_t pipelineKey = pls::ShaderUniqueKey(variant.drawType,
+                                                    variant.shaderFeatures,
+                                                    variant.interlockMode,
+                                                    pls::ShaderMiscFlags::none);
+        if (m_drawPipelines.insert({pipelineKey, nullptr}).second)
+        {
+            // findCompatibleDrawPipeline() collects the compiled shader once it's needed.
+            m_backgroundShaderCompiler->pushJob({
+                .drawType = variant.drawType,
+                .shaderFeatures = variant.shaderFeatures,
+                .interlockMode = variant.interlockMode,
+                .shaderMiscFlags = pls::ShaderMiscFlags::none,
+            });
+        }
+    }
 }
 
 void PLSRenderContextMetalImpl::prepareToMapBuffers()
 {
-    // Wait until the GPU finishes rendering flush "N + 1 - kBufferRingSize". This ensures it
+    // Wait until the GPU finishes rendering flush "N + 1 - bufferRingSize()". This ensures it
     // is safe for the CPU to begin modifying the next buffers in our rings.
-    m_bufferRingIdx = (m_bufferRingIdx + 1) % kBufferRingSize;
+    m_bufferRingIdx = (m_bufferRingIdx + 1) % bufferRingSize();
     m_bufferRingLocks[m_bufferRingIdx].lock();
 }
 
@@ -748,6 +974,9 @@ id<MTLRenderCommandEncoder> PLSRenderContextMetalImpl::makeRenderPassForDraws(
 
     id<MTLRenderCommandEncoder> encoder =
         [commandBuffer renderCommandEncoderWithDescriptor:passDesc];
+#ifdef RIVE_PLS_TRACING
+    encoder.label = flushDesc.isTileBinPass ? @"PLS draw (tile bin)" : @"PLS draw";
+#endif
 
     [encoder setViewport:make_viewport(0, 0, renderTarget->width(), renderTarget->height())];
     [encoder setVertexBuffer:mtl_buffer(flushUniformBufferRing())
@@ -818,26 +1047,41 @@ id<MTLRenderCommandEncoder> PLSRenderContextMetalImpl::makeRenderPassForDraws(
 
 void PLSRenderContextMetalImpl::flush(const FlushDescriptor& desc)
 {
+    PLS_TRACE_SCOPE("PLSRenderContextMetalImpl::flush");
     auto* renderTarget = static_cast<PLSRenderTargetMetal*>(desc.renderTarget);
     id<MTLCommandBuffer> commandBuffer = (__bridge id<MTLCommandBuffer>)desc.externalCommandBuffer;
 
+#ifdef RIVE_PLS_TRACING
+    [commandBuffer pushDebugGroup:@"PLS flush"];
+#endif
+
+    if (desc.isFirstFlushOfRenderTarget && renderTarget->m_targetSharedEvent != nil)
+    {
+        [commandBuffer encodeWaitForEvent:renderTarget->m_targetSharedEvent
+                                    value:renderTarget->m_targetAcquireValue];
+    }
+
     // Render the complex color ramps to the gradient texture.
     if (desc.complexGradSpanCount > 0)
     {
         MTLRenderPassDescriptor* gradPass = [MTLRenderPassDescriptor renderPassDescriptor];
         gradPass.renderTargetWidth = kGradTextureWidth;
         gradPass.renderTargetHeight = desc.complexGradRowsTop + desc.complexGradRowsHeight;
-        gradPass.colorAttachments[0].loadAction = MTLLoadActionDontCare;
+        // Load the existing contents so the rest of the gradient atlas survives this pass.
+        gradPass.colorAttachments[0].loadAction = MTLLoadActionLoad;
         gradPass.colorAttachments[0].storeAction = MTLStoreActionStore;
         gradPass.colorAttachments[0].texture = m_gradientTexture;
 
         id<MTLRenderCommandEncoder> gradEncoder =
             [commandBuffer renderCommandEncoderWithDescriptor:gradPass];
+#ifdef RIVE_PLS_TRACING
+        gradEncoder.label = @"PLS color ramps";
+#endif
         [gradEncoder setViewport:make_viewport(0,
                                                static_cast<double>(desc.complexGradRowsTop),
                                                kGradTextureWidth,
                                                static_cast<float>(desc.complexGradRowsHeight))];
-        [gradEncoder setRenderPipelineState:m_colorRampPipeline->pipelineState()];
+        [gradEncoder setRenderPipelineState:m_device->m_colorRampPipeline->pipelineState()];
         [gradEncoder setVertexBuffer:mtl_buffer(flushUniformBufferRing())
                               offset:desc.flushUniformDataOffsetInBytes
                              atIndex:FLUSH_UNIFORM_BUFFER_IDX];
@@ -882,8 +1126,11 @@ void PLSRenderContextMetalImpl::flush(const FlushDescriptor& desc)
 
         id<MTLRenderCommandEncoder> tessEncoder =
             [commandBuffer renderCommandEncoderWithDescriptor:tessPass];
+#ifdef RIVE_PLS_TRACING
+        tessEncoder.label = @"PLS tessellate";
+#endif
         [tessEncoder setViewport:make_viewport(0, 0, kTessTextureWidth, desc.tessDataHeight)];
-        [tessEncoder setRenderPipelineState:m_tessPipeline->pipelineState()];
+        [tessEncoder setRenderPipelineState:m_device->m_tessPipeline->pipelineState()];
         [tessEncoder setVertexBuffer:mtl_buffer(flushUniformBufferRing())
                               offset:desc.flushUniformDataOffsetInBytes
                              atIndex:FLUSH_UNIFORM_BUFFER_IDX];
@@ -902,7 +1149,7 @@ void PLSRenderContextMetalImpl::flush(const FlushDescriptor& desc)
         [tessEncoder drawIndexedPrimitives:MTLPrimitiveTypeTriangle
                                 indexCount:std::size(pls::kTessSpanIndices)
                                  indexType:MTLIndexTypeUInt16
-                               indexBuffer:m_tessSpanIndexBuffer
+                               indexBuffer:m_device->m_tessSpanIndexBuffer
                          indexBufferOffset:0
                              instanceCount:desc.tessVertexSpanCount];
         [tessEncoder endEncoding];
@@ -1004,6 +1251,42 @@ void PLSRenderContextMetalImpl::flush(const FlushDescriptor& desc)
 
     // Execute the DrawList.
     id<MTLRenderCommandEncoder> encoder = makeRenderPassForDraws(desc, pass, commandBuffer);
+
+    // Consecutive batches tend to share their pipeline, cull mode, vertex buffer, and image.
+    // Metal doesn't filter redundant state changes, which are a measurable share of encoding
+    // time on older A-series chips, so track what's bound to the encoder and only set state that
+    // changes. (Reset whenever we start a new encoder.)
+    struct
+    {
+        id<MTLRenderPipelineState> pipelineState = nil;
+        id<MTLBuffer> vertexBuffer = nil;
+        id<MTLTexture> imageTexture = nil;
+        MTLCullMode cullMode;
+        bool hasCullMode = false;
+    } boundState;
+    auto setPipelineState = [&](id<MTLRenderPipelineState> pipelineState) {
+        if (pipelineState != boundState.pipelineState)
+        {
+            [encoder setRenderPipelineState:pipelineState];
+            boundState.pipelineState = pipelineState;
+        }
+    };
+    auto setVertexBuffer = [&](id<MTLBuffer> vertexBuffer) {
+        if (vertexBuffer != boundState.vertexBuffer)
+        {
+            [encoder setVertexBuffer:vertexBuffer offset:0 atIndex:0];
+            boundState.vertexBuffer = vertexBuffer;
+        }
+    };
+    auto setCullMode = [&](MTLCullMode cullMode) {
+        if (!boundState.hasCullMode || cullMode != boundState.cullMode)
+        {
+            [encoder setCullMode:cullMode];
+            boundState.cullMode = cullMode;
+            boundState.hasCullMode = true;
+        }
+    };
+
     for (const DrawBatch& batch : *desc.drawList)
     {
         if (batch.elementCount == 0)
@@ -1047,7 +1330,12 @@ void PLSRenderContextMetalImpl::flush(const FlushDescriptor& desc)
         // Bind the appropriate image texture, if any.
         if (auto imageTextureMetal = static_cast<const PLSTextureMetalImpl*>(batch.imageTexture))
         {
-            [encoder setFragmentTexture:imageTextureMetal->texture() atIndex:IMAGE_TEXTURE_IDX];
+            if (imageTextureMetal->texture() != boundState.imageTexture)
+            {
+                [encoder setFragmentTexture:imageTextureMetal->texture()
+                                    atIndex:IMAGE_TEXTURE_IDX];
+                boundState.imageTexture = imageTextureMetal->texture();
+            }
         }
 
         DrawType drawType = batch.drawType;
@@ -1057,9 +1345,9 @@ void PLSRenderContextMetalImpl::flush(const FlushDescriptor& desc)
             case DrawType::outerCurvePatches:
             {
                 // Draw PLS patches that connect the tessellation vertices.
-                [encoder setRenderPipelineState:drawPipelineState];
-                [encoder setVertexBuffer:m_pathPatchVertexBuffer offset:0 atIndex:0];
-                [encoder setCullMode:MTLCullModeBack];
+                setPipelineState(drawPipelineState);
+                setVertexBuffer(m_device->m_pathPatchVertexBuffer);
+                setCullMode(MTLCullModeBack);
                 // Don't use baseInstance in order to run on Apple GPU Family 2.
                 // TODO: Use baseInstance instead once we deprecate Apple2.
                 [encoder setVertexBytes:&batch.baseElement
@@ -1068,16 +1356,16 @@ void PLSRenderContextMetalImpl::flush(const FlushDescriptor& desc)
                 [encoder drawIndexedPrimitives:MTLPrimitiveTypeTriangle
                                     indexCount:PatchIndexCount(drawType)
                                      indexType:MTLIndexTypeUInt16
-                                   indexBuffer:m_pathPatchIndexBuffer
+                                   indexBuffer:m_device->m_pathPatchIndexBuffer
                              indexBufferOffset:PatchBaseIndex(drawType) * sizeof(uint16_t)
                                  instanceCount:batch.elementCount];
                 break;
             }
             case DrawType::interiorTriangulation:
             {
-                [encoder setRenderPipelineState:drawPipelineState];
-                [encoder setVertexBuffer:mtl_buffer(triangleBufferRing()) offset:0 atIndex:0];
-                [encoder setCullMode:MTLCullModeBack];
+                setPipelineState(drawPipelineState);
+                setVertexBuffer(mtl_buffer(triangleBufferRing()));
+                setCullMode(MTLCullModeBack);
                 [encoder drawPrimitives:MTLPrimitiveTypeTriangle
                             vertexStart:batch.baseElement
                             vertexCount:batch.elementCount];
@@ -1086,22 +1374,22 @@ void PLSRenderContextMetalImpl::flush(const FlushDescriptor& desc)
             case DrawType::imageRect:
             case DrawType::imageMesh:
             {
-                [encoder setRenderPipelineState:drawPipelineState];
+                setPipelineState(drawPipelineState);
                 [encoder setVertexBuffer:mtl_buffer(imageDrawUniformBufferRing())
                                   offset:batch.imageDrawDataOffset
                                  atIndex:IMAGE_DRAW_UNIFORM_BUFFER_IDX];
                 [encoder setFragmentBuffer:mtl_buffer(imageDrawUniformBufferRing())
                                     offset:batch.imageDrawDataOffset
                                    atIndex:IMAGE_DRAW_UNIFORM_BUFFER_IDX];
-                [encoder setCullMode:MTLCullModeNone];
+                setCullMode(MTLCullModeNone);
                 if (drawType == DrawType::imageRect)
                 {
                     assert(desc.interlockMode == pls::InterlockMode::atomics);
-                    [encoder setVertexBuffer:m_imageRectVertexBuffer offset:0 atIndex:0];
+                    setVertexBuffer(m_device->m_imageRectVertexBuffer);
                     [encoder drawIndexedPrimitives:MTLPrimitiveTypeTriangle
                                         indexCount:std::size(pls::kImageRectIndices)
                                          indexType:MTLIndexTypeUInt16
-                                       indexBuffer:m_imageRectIndexBuffer
+                                       indexBuffer:m_device->m_imageRectIndexBuffer
                                  indexBufferOffset:0];
                 }
                 else
@@ -1111,7 +1399,7 @@ void PLSRenderContextMetalImpl::flush(const FlushDescriptor& desc)
                     LITE_RTTI_CAST_OR_BREAK(uvBuffer, const RenderBufferMetalImpl*, batch.uvBuffer);
                     LITE_RTTI_CAST_OR_BREAK(
                         indexBuffer, const RenderBufferMetalImpl*, batch.indexBuffer);
-                    [encoder setVertexBuffer:vertexBuffer->submittedBuffer() offset:0 atIndex:0];
+                    setVertexBuffer(vertexBuffer->submittedBuffer());
                     [encoder setVertexBuffer:uvBuffer->submittedBuffer() offset:0 atIndex:1];
                     [encoder drawIndexedPrimitives:MTLPrimitiveTypeTriangle
                                         indexCount:batch.elementCount
@@ -1125,7 +1413,7 @@ void PLSRenderContextMetalImpl::flush(const FlushDescriptor& desc)
             case DrawType::plsAtomicResolve:
             {
                 assert(desc.interlockMode == pls::InterlockMode::atomics);
-                [encoder setRenderPipelineState:drawPipelineState];
+                setPipelineState(drawPipelineState);
                 [encoder drawPrimitives:MTLPrimitiveTypeTriangleStrip vertexStart:0 vertexCount:4];
                 break;
             }
@@ -1162,12 +1450,23 @@ void PLSRenderContextMetalImpl::flush(const FlushDescriptor& desc)
                     [encoder endEncoding];
                     pass.colorAttachments[COLOR_PLANE_IDX].loadAction = MTLLoadActionLoad;
                     encoder = makeRenderPassForDraws(desc, pass, commandBuffer);
+                    boundState = {};
                     break;
             }
         }
     }
     [encoder endEncoding];
 
+    if (desc.isFinalFlushOfRenderTarget && renderTarget->m_targetSharedEvent != nil)
+    {
+        [commandBuffer encodeSignalEvent:renderTarget->m_targetSharedEvent
+                                   value:renderTarget->m_targetReleaseValue];
+    }
+
+#ifdef RIVE_PLS_TRACING
+    [commandBuffer popDebugGroup];
+#endif
+
     if (desc.isFinalFlushOfFrame)
     {
         // Schedule a callback that will unlock the buffers used by this flush, after the GPU has
@@ -1177,6 +1476,31 @@ void PLSRenderContextMetalImpl::flush(const FlushDescriptor& desc)
           assert(!thisFlushLock.try_lock()); // The mutex should already be locked.
           thisFlushLock.unlock();
         }];
+
+        if (desc.gpuTimerFrameNumber != 0)
+        {
+            // Metal reports GPU execution time per command buffer, so this measures the entire
+            // command buffer the frame was rendered into.
+            uint64_t frameNumber = desc.gpuTimerFrameNumber;
+            [commandBuffer addCompletedHandler:^(id<MTLCommandBuffer> completedCommandBuffer) {
+              std::unique_lock lock(m_gpuFrameTimesMutex);
+              m_gpuFrameTimes.push_back(
+                  {frameNumber,
+                   completedCommandBuffer.GPUEndTime - completedCommandBuffer.GPUStartTime});
+            }];
+        }
+    }
+}
+
+bool PLSRenderContextMetalImpl::popGPUFrameTime(pls::GPUFrameTime* gpuFrameTime)
+{
+    std::unique_lock lock(m_gpuFrameTimesMutex);
+    if (m_gpuFrameTimes.empty())
+    {
+        return false;
     }
+    *gpuFrameTime = m_gpuFrameTimes.front();
+    m_gpuFrameTimes.pop_front();
+    return true;
 }
 } // namespace rive::pls
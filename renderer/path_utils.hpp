@@ -20,12 +20,17 @@ namespace rive::pathutils
 // Decides the number of polar segments the tessellator adds for each curve. (Uniform steps in
 // tangent angle.) The tessellator will add this number of polar segments for each radian of
 // rotation in local path space.
-template <int Precision> float CalcPolarSegmentsPerRadian(float approxDevStrokeRadius)
+inline float CalcPolarSegmentsPerRadian(float approxDevStrokeRadius, float precision)
 {
-    float cosTheta = 1.f - (1.f / Precision) / approxDevStrokeRadius;
+    float cosTheta = 1.f - (1.f / precision) / approxDevStrokeRadius;
     return .5f / acosf(std::max(cosTheta, -1.f));
 }
 
+template <int Precision> float CalcPolarSegmentsPerRadian(float approxDevStrokeRadius)
+{
+    return CalcPolarSegmentsPerRadian(approxDevStrokeRadius, Precision);
+}
+
 Vec2D EvalCubicAt(const Vec2D p[4], float t);
 
 // Given a src cubic bezier, chop it at the specified t value,
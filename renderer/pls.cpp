@@ -7,10 +7,13 @@
 #include "rive/pls/pls_render_target.hpp"
 #include "shaders/constants.glsl"
 #include "rive/pls/pls_image.hpp"
+#include "rive/pls/pls_trace.hpp"
 #include "pls_paint.hpp"
 
 #include "generated/shaders/draw_path.exports.h"
 
+#include <string.h>
+
 namespace rive::pls
 {
 static_assert(kGradTextureWidth == GRAD_TEXTURE_WIDTH);
@@ -275,7 +278,9 @@ void GeneratePatchBufferData(PatchVertex vertices[kPatchVertexBufferCount],
                                         kMidpointFanPatchVertexCount);
 }
 
-void ClipRectInverseMatrix::reset(const Mat2D& clipMatrix, const AABB& clipRect)
+void ClipRectInverseMatrix::reset(const Mat2D& clipMatrix,
+                                  const AABB& clipRect,
+                                  Vec2D cornerRadii)
 {
     // Find the matrix that transforms from pixel space to "normalized clipRect space", where the
     // clipRect is the normalized rectangle: [-1, -1, +1, +1].
@@ -290,7 +295,31 @@ void ClipRectInverseMatrix::reset(const Mat2D& clipMatrix, const AABB& clipRect)
         // If the width or height went zero or negative, or if "m" is non-invertible, clip away
         // everything.
         *this = Empty();
+        return;
+    }
+    m_normalizedCornerRadii = {0, 0};
+    if (cornerRadii.x > 0 && cornerRadii.y > 0)
+    {
+        m_normalizedCornerRadii.x = std::min(cornerRadii.x / (clipRect.width() * .5f), 1.f);
+        m_normalizedCornerRadii.y = std::min(cornerRadii.y / (clipRect.height() * .5f), 1.f);
+    }
+}
+
+// Converts the normalized corner radii of a clipRect to units of fwidth(clipRect coords), which is
+// the space the shaders measure edge distances in.
+static Vec2D clip_rect_corner_radii(const ClipRectInverseMatrix* clipRectInverseMatrix)
+{
+    if (clipRectInverseMatrix == nullptr)
+    {
+        return {0, 0};
+    }
+    Vec2D radii = clipRectInverseMatrix->normalizedCornerRadii();
+    if (radii.x == 0 || radii.y == 0)
+    {
+        return {0, 0};
     }
+    const Mat2D& m = clipRectInverseMatrix->inverseMatrix();
+    return {radii.x / (fabsf(m.xx()) + fabsf(m.yx())), radii.y / (fabsf(m.xy()) + fabsf(m.yy()))};
 }
 
 static uint32_t paint_type_to_glsl_id(PaintType paintType)
@@ -385,11 +414,13 @@ static void write_matrix(volatile float* dst, const Mat2D& matrix)
     }
 }
 
-void PathData::set(const Mat2D& m, float strokeRadius, uint32_t zIndex)
+void PathData::set(const Mat2D& m, float strokeRadius, uint32_t zIndex, uint32_t paintAuxIdx)
 {
+    assert(zIndex <= 0xffff);
+    assert(paintAuxIdx <= 0xffff);
     write_matrix(m_matrix, m);
     m_strokeRadius = strokeRadius; // 0 if the path is filled.
-    m_zIndex = zIndex;
+    m_zIndexAndPaintAuxIdx = (paintAuxIdx << 16) | zIndex;
 }
 
 void PaintData::set(FillRule fillRule,
@@ -415,13 +446,21 @@ void PaintData::set(FillRule fillRule,
         case PaintType::linearGradient:
         case PaintType::radialGradient:
         {
-            uint32_t row = simplePaintValue.colorRampLocation.row;
-            if (simplePaintValue.colorRampLocation.isComplex())
+            if (simplePaintValue.colorRampLocation.isAnalytic())
             {
-                // Complex gradients rows are offset after the simple gradients.
-                row += gradTextureLayout.complexOffsetY;
+                m_gradTextureY = 0;
+                localParams |= PAINT_FLAG_ANALYTIC_GRADIENT;
+            }
+            else
+            {
+                uint32_t row = simplePaintValue.colorRampLocation.row;
+                if (simplePaintValue.colorRampLocation.isComplex())
+                {
+                    // Complex gradients rows are offset after the simple gradients.
+                    row += gradTextureLayout.complexOffsetY;
+                }
+                m_gradTextureY = (static_cast<float>(row) + .5f) * gradTextureLayout.inverseHeight;
             }
-            m_gradTextureY = (static_cast<float>(row) + .5f) * gradTextureLayout.inverseHeight;
             localParams |= shiftedClipID | shiftedBlendMode;
             break;
         }
@@ -497,19 +536,29 @@ void PaintAuxData::set(const Mat2D& viewMatrix,
                     paintMatrix =
                         Mat2D(w, 0, 0, w, -gradCoeffs[0] * w, -gradCoeffs[1] * w) * paintMatrix;
                 }
-                float left, right;
-                if (simplePaintValue.colorRampLocation.isComplex())
+                if (simplePaintValue.colorRampLocation.isAnalytic())
                 {
-                    left = 0;
-                    right = kGradTextureWidth;
+                    const ColorInt* colors = gradient->colors();
+                    m_analyticGradientColors[0] = SwizzleRiveColorToRGBA(colors[0]);
+                    m_analyticGradientColors[1] = SwizzleRiveColorToRGBA(colors[1]);
                 }
                 else
                 {
-                    left = simplePaintValue.colorRampLocation.col;
-                    right = left + 2;
+                    float left, right;
+                    if (simplePaintValue.colorRampLocation.isComplex())
+                    {
+                        left = simplePaintValue.colorRampLocation.complexCol();
+                        right = left + simplePaintValue.colorRampLocation.complexWidth();
+                    }
+                    else
+                    {
+                        left = simplePaintValue.colorRampLocation.col;
+                        right = left + 2;
+                    }
+                    m_gradTextureHorizontalSpan[0] =
+                        (right - left - 1) * GRAD_TEXTURE_INVERSE_WIDTH;
+                    m_gradTextureHorizontalSpan[1] = (left + .5f) * GRAD_TEXTURE_INVERSE_WIDTH;
                 }
-                m_gradTextureHorizontalSpan[0] = (right - left - 1) * GRAD_TEXTURE_INVERSE_WIDTH;
-                m_gradTextureHorizontalSpan[1] = (left + .5f) * GRAD_TEXTURE_INVERSE_WIDTH;
             }
             write_matrix(m_matrix, paintMatrix);
             break;
@@ -529,15 +578,12 @@ void PaintAuxData::set(const Mat2D& viewMatrix,
             m = m * Mat2D(1, 0, 0, -1, 0, renderTarget->height());
         }
         write_matrix(m_clipRectInverseMatrix, m);
-        m_inverseFwidth.x = -1.f / (fabsf(m.xx()) + fabsf(m.xy()));
-        m_inverseFwidth.y = -1.f / (fabsf(m.yx()) + fabsf(m.yy()));
     }
     else
     {
         write_matrix(m_clipRectInverseMatrix, ClipRectInverseMatrix::WideOpen().inverseMatrix());
-        m_inverseFwidth.x = 0;
-        m_inverseFwidth.y = 0;
     }
+    m_clipRectCornerRadii = clip_rect_corner_radii(clipRectInverseMatrix);
 }
 
 ImageDrawUniforms::ImageDrawUniforms(const Mat2D& matrix,
@@ -545,7 +591,8 @@ ImageDrawUniforms::ImageDrawUniforms(const Mat2D& matrix,
                                      const ClipRectInverseMatrix* clipRectInverseMatrix,
                                      uint32_t clipID,
                                      BlendMode blendMode,
-                                     uint32_t zIndex)
+                                     uint32_t zIndex,
+                                     const AABB& texCoordBounds)
 {
     write_matrix(m_matrix, matrix);
     m_opacity = opacity;
@@ -553,9 +600,39 @@ ImageDrawUniforms::ImageDrawUniforms(const Mat2D& matrix,
                  clipRectInverseMatrix != nullptr
                      ? clipRectInverseMatrix->inverseMatrix()
                      : ClipRectInverseMatrix::WideOpen().inverseMatrix());
+    Vec2D cornerRadii = clip_rect_corner_radii(clipRectInverseMatrix);
+    m_clipRectCornerRadii[0] = cornerRadii.x;
+    m_clipRectCornerRadii[1] = cornerRadii.y;
     m_clipID = clipID;
     m_blendMode = ConvertBlendModeToPLSBlendMode(blendMode);
     m_zIndex = zIndex;
+    m_texCoordTransform[0] = texCoordBounds.width();
+    m_texCoordTransform[1] = texCoordBounds.height();
+    m_texCoordTransform[2] = texCoordBounds.left();
+    m_texCoordTransform[3] = texCoordBounds.top();
+}
+
+ImageDrawUniforms::ImageDrawUniforms(const Mat2D& matrix,
+                                     ColorInt color,
+                                     const ClipRectInverseMatrix* clipRectInverseMatrix,
+                                     uint32_t clipID,
+                                     BlendMode blendMode,
+                                     uint32_t zIndex) :
+    ImageDrawUniforms(matrix,
+                      1,
+                      clipRectInverseMatrix,
+                      clipID,
+                      blendMode,
+                      zIndex,
+                      AABB{0, 0, 1, 1})
+{
+    m_hasSolidColor = 1;
+    float solidColor[4];
+    UnpackColorToRGBA32F(color, solidColor);
+    for (size_t i = 0; i < 4; ++i)
+    {
+        m_solidColor[i] = solidColor[i];
+    }
 }
 
 std::tuple<uint32_t, uint32_t> StorageTextureSize(size_t bufferSizeInBytes,
@@ -594,4 +671,73 @@ float FindTransformedArea(const AABB& bounds, const Mat2D& matrix)
                   screenSpacePts[3] - screenSpacePts[0]};
     return (fabsf(Vec2D::cross(v[0], v[1])) + fabsf(Vec2D::cross(v[1], v[2]))) * .5f;
 }
+
+void SortInt64Keys(int64_t* keys, int64_t* scratch, size_t count, uint32_t presortedLowBits)
+{
+    assert(presortedLowBits % 8 == 0 && presortedLowBits <= 64);
+    assert(count <= std::numeric_limits<uint32_t>::max());
+    // Below this size, the histogram setup costs more than std::sort.
+    constexpr static size_t kMinRadixSortCount = 256;
+    if (count < kMinRadixSortCount)
+    {
+        std::sort(keys, keys + count);
+        return;
+    }
+
+    // Flip the sign bit so the keys sort as unsigned integers.
+    constexpr static uint64_t kSignBit = 1llu << 63;
+    constexpr static uint32_t kPassCount = 8;
+
+    // Build the histograms for every pass at once, in a single trip over the keys.
+    uint32_t firstPass = presortedLowBits / 8;
+    uint32_t histograms[kPassCount][256] = {};
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint64_t key = static_cast<uint64_t>(keys[i]) ^ kSignBit;
+        for (uint32_t pass = firstPass; pass < kPassCount; ++pass)
+        {
+            ++histograms[pass][(key >> (pass * 8)) & 0xff];
+        }
+    }
+
+    int64_t* src = keys;
+    int64_t* dst = scratch;
+    uint64_t key0 = static_cast<uint64_t>(keys[0]) ^ kSignBit;
+    for (uint32_t pass = firstPass; pass < kPassCount; ++pass)
+    {
+        uint32_t shift = pass * 8;
+        uint32_t* histogram = histograms[pass];
+        if (histogram[(key0 >> shift) & 0xff] == count)
+        {
+            continue; // Every key has the same value in this byte.
+        }
+
+        // Convert the histogram to starting offsets.
+        uint32_t offset = 0;
+        for (uint32_t digit = 0; digit < 256; ++digit)
+        {
+            uint32_t bucketCount = histogram[digit];
+            histogram[digit] = offset;
+            offset += bucketCount;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint64_t key = static_cast<uint64_t>(src[i]) ^ kSignBit;
+            dst[histogram[(key >> shift) & 0xff]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+
+    if (src != keys)
+    {
+        memcpy(keys, src, count * sizeof(int64_t));
+    }
+}
+
+#ifdef RIVE_PLS_TRACING
+TraceHooks g_traceHooks;
+
+void SetTraceHooks(const TraceHooks& hooks) { g_traceHooks = hooks; }
+#endif
 } // namespace rive::pls
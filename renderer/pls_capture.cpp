@@ -0,0 +1,732 @@
+/*
+ * Copyright 2024 Rive
+ */
+
+#include "rive/pls/pls_capture.hpp"
+
+#include "pls_paint.hpp"
+#include "pls_path.hpp"
+#include "rive/factory.hpp"
+#include "rive/pls/pls_image.hpp"
+#include <algorithm>
+
+namespace rive::pls
+{
+namespace
+{
+constexpr static char kCaptureMagic[4] = {'R', 'C', 'A', 'P'};
+
+enum class CaptureOp : uint8_t
+{
+    beginFrame,
+    endFrame,
+    save,
+    restore,
+    transform,
+    definePath,
+    definePaint,
+    defineImage,
+    drawPath,
+    clipPath,
+    drawImage,
+};
+
+template <typename T> void append(std::vector<uint8_t>* data, const T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    size_t offset = data->size();
+    data->resize(offset + sizeof(T));
+    memcpy(data->data() + offset, &value, sizeof(T));
+}
+
+void append_bytes(std::vector<uint8_t>* data, const void* bytes, size_t byteCount)
+{
+    size_t offset = data->size();
+    data->resize(offset + byteCount);
+    memcpy(data->data() + offset, bytes, byteCount);
+}
+
+// Bounds-checked reads from a capture. Every read fails once any read has run past the end.
+class CaptureReader
+{
+public:
+    CaptureReader(const std::vector<uint8_t>& data, size_t begin, size_t end) :
+        m_data(data), m_pos(begin), m_end(end)
+    {
+        assert(end <= data.size());
+    }
+
+    size_t pos() const { return m_pos; }
+    bool atEnd() const { return m_pos == m_end; }
+    bool ok() const { return m_ok; }
+
+    template <typename T> T read()
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value{};
+        readBytes(&value, sizeof(T));
+        return value;
+    }
+
+    bool readBytes(void* bytes, size_t byteCount)
+    {
+        if (!m_ok || m_end - m_pos < byteCount)
+        {
+            m_ok = false;
+            return false;
+        }
+        memcpy(bytes, m_data.data() + m_pos, byteCount);
+        m_pos += byteCount;
+        return true;
+    }
+
+private:
+    const std::vector<uint8_t>& m_data;
+    size_t m_pos;
+    const size_t m_end;
+    bool m_ok = true;
+};
+
+void write_frame_descriptor(std::vector<uint8_t>* data,
+                            const PLSRenderContext::FrameDescriptor& desc)
+{
+    append<uint32_t>(data, desc.renderTargetWidth);
+    append<uint32_t>(data, desc.renderTargetHeight);
+    append<uint8_t>(data, static_cast<uint8_t>(desc.loadAction));
+    append<uint32_t>(data, desc.clearColor);
+    append<int32_t>(data, desc.msaaSampleCount);
+    append<uint8_t>(data, desc.disableRasterOrdering);
+    append<IAABB>(data, desc.dirtyBounds);
+    append<uint8_t>(data, desc.tileBinnedRendering);
+    append<uint8_t>(data, desc.compactTessVertexSpans);
+    append<uint8_t>(data, desc.gpuTessellationSpans);
+    append<float>(data, desc.tinyPathLODPixelSize);
+    append<float>(data, desc.tessellationQuality);
+    append<float>(data, desc.resolutionScale);
+    append<uint8_t>(data, desc.wireframe);
+    append<uint8_t>(data, desc.fillsDisabled);
+    append<uint8_t>(data, desc.strokesDisabled);
+    append<uint8_t>(data, desc.overdrawHeatmap);
+}
+
+PLSRenderContext::FrameDescriptor read_frame_descriptor(CaptureReader* reader)
+{
+    PLSRenderContext::FrameDescriptor desc;
+    desc.renderTargetWidth = reader->read<uint32_t>();
+    desc.renderTargetHeight = reader->read<uint32_t>();
+    desc.loadAction = static_cast<LoadAction>(
+        std::min<uint8_t>(reader->read<uint8_t>(), static_cast<uint8_t>(LoadAction::dontCare)));
+    desc.clearColor = reader->read<uint32_t>();
+    desc.msaaSampleCount = reader->read<int32_t>();
+    desc.disableRasterOrdering = reader->read<uint8_t>();
+    desc.dirtyBounds = reader->read<IAABB>();
+    desc.tileBinnedRendering = reader->read<uint8_t>();
+    desc.compactTessVertexSpans = reader->read<uint8_t>();
+    desc.gpuTessellationSpans = reader->read<uint8_t>();
+    desc.tinyPathLODPixelSize = reader->read<float>();
+    desc.tessellationQuality = reader->read<float>();
+    desc.resolutionScale = reader->read<float>();
+    desc.wireframe = reader->read<uint8_t>();
+    desc.fillsDisabled = reader->read<uint8_t>();
+    desc.strokesDisabled = reader->read<uint8_t>();
+    desc.overdrawHeatmap = reader->read<uint8_t>();
+    return desc;
+}
+} // namespace
+
+PLSCaptureRenderer::PLSCaptureRenderer(Renderer* forwardRenderer) :
+    m_forwardRenderer(forwardRenderer)
+{
+    append_bytes(&m_data, kCaptureMagic, sizeof(kCaptureMagic));
+    append<uint32_t>(&m_data, kCaptureVersion);
+}
+
+PLSCaptureRenderer::~PLSCaptureRenderer() {}
+
+template <typename T> void PLSCaptureRenderer::write(const T& value) { append(&m_data, value); }
+
+void PLSCaptureRenderer::beginFrame(const PLSRenderContext::FrameDescriptor& frameDescriptor)
+{
+    assert(!m_isInFrame);
+    RIVE_DEBUG_CODE(m_isInFrame = true;)
+    write(CaptureOp::beginFrame);
+    write_frame_descriptor(&m_data, frameDescriptor);
+}
+
+void PLSCaptureRenderer::endFrame()
+{
+    assert(m_isInFrame);
+    RIVE_DEBUG_CODE(m_isInFrame = false;)
+    write(CaptureOp::endFrame);
+    ++m_frameCount;
+}
+
+void PLSCaptureRenderer::save()
+{
+    write(CaptureOp::save);
+    if (m_forwardRenderer != nullptr)
+    {
+        m_forwardRenderer->save();
+    }
+}
+
+void PLSCaptureRenderer::restore()
+{
+    write(CaptureOp::restore);
+    if (m_forwardRenderer != nullptr)
+    {
+        m_forwardRenderer->restore();
+    }
+}
+
+void PLSCaptureRenderer::transform(const Mat2D& matrix)
+{
+    write(CaptureOp::transform);
+    for (int i = 0; i < 6; ++i)
+    {
+        write<float>(matrix[i]);
+    }
+    if (m_forwardRenderer != nullptr)
+    {
+        m_forwardRenderer->transform(matrix);
+    }
+}
+
+void PLSCaptureRenderer::drawPath(RenderPath* renderPath, RenderPaint* renderPaint)
+{
+    auto path = lite_rtti_cast<PLSPath*>(renderPath);
+    auto paint = lite_rtti_cast<PLSPaint*>(renderPaint);
+    if (path != nullptr && paint != nullptr)
+    {
+        uint32_t pathID = definePath(path);
+        uint32_t paintID = definePaint(paint);
+        write(CaptureOp::drawPath);
+        write(pathID);
+        write(paintID);
+    }
+    else
+    {
+        ++m_uncapturedCallCount;
+    }
+    if (m_forwardRenderer != nullptr)
+    {
+        m_forwardRenderer->drawPath(renderPath, renderPaint);
+    }
+}
+
+void PLSCaptureRenderer::clipPath(RenderPath* renderPath)
+{
+    if (auto path = lite_rtti_cast<PLSPath*>(renderPath))
+    {
+        uint32_t pathID = definePath(path);
+        write(CaptureOp::clipPath);
+        write(pathID);
+    }
+    else
+    {
+        ++m_uncapturedCallCount;
+    }
+    if (m_forwardRenderer != nullptr)
+    {
+        m_forwardRenderer->clipPath(renderPath);
+    }
+}
+
+void PLSCaptureRenderer::drawImage(const RenderImage* renderImage,
+                                   BlendMode blendMode,
+                                   float opacity)
+{
+    if (auto image = lite_rtti_cast<const PLSImage*>(renderImage))
+    {
+        const PLSTexture* texture = image->getTexture();
+        uint32_t imageID = texture != nullptr
+                               ? defineImage(texture,
+                                             texture->width(),
+                                             texture->height(),
+                                             texture->textureResourceHash())
+                               : defineImage(image, image->width(), image->height(), 0);
+        write(CaptureOp::drawImage);
+        write(imageID);
+        write(static_cast<uint8_t>(blendMode));
+        write(opacity);
+    }
+    else
+    {
+        ++m_uncapturedCallCount;
+    }
+    if (m_forwardRenderer != nullptr)
+    {
+        m_forwardRenderer->drawImage(renderImage, blendMode, opacity);
+    }
+}
+
+void PLSCaptureRenderer::drawImageMesh(const RenderImage* renderImage,
+                                       rcp<RenderBuffer> vertices_f32,
+                                       rcp<RenderBuffer> uvCoords_f32,
+                                       rcp<RenderBuffer> indices_u16,
+                                       uint32_t vertexCount,
+                                       uint32_t indexCount,
+                                       BlendMode blendMode,
+                                       float opacity)
+{
+    ++m_uncapturedCallCount;
+    if (m_forwardRenderer != nullptr)
+    {
+        m_forwardRenderer->drawImageMesh(renderImage,
+                                         std::move(vertices_f32),
+                                         std::move(uvCoords_f32),
+                                         std::move(indices_u16),
+                                         vertexCount,
+                                         indexCount,
+                                         blendMode,
+                                         opacity);
+    }
+}
+
+uint32_t PLSCaptureRenderer::definePath(const PLSPath* path)
+{
+    uint64_t mutationID = path->getRawPathMutationID();
+    auto [iter, isNew] = m_paths.try_emplace(path);
+    PathRecord& record = iter->second;
+    if (!isNew && record.rawPathMutationID == mutationID && record.fillRule == path->getFillRule())
+    {
+        return record.id;
+    }
+    if (isNew)
+    {
+        record.id = m_nextID++;
+    }
+    record.rawPathMutationID = mutationID;
+    record.fillRule = path->getFillRule();
+
+    const RawPath& rawPath = path->getRawPath();
+    write(CaptureOp::definePath);
+    write(record.id);
+    write(static_cast<uint8_t>(record.fillRule));
+    write(static_cast<uint32_t>(rawPath.verbs().size()));
+    write(static_cast<uint32_t>(rawPath.points().size()));
+    for (PathVerb verb : rawPath.verbs())
+    {
+        write(static_cast<uint8_t>(verb));
+    }
+    append_bytes(&m_data, rawPath.points().data(), rawPath.points().size() * sizeof(Vec2D));
+    return record.id;
+}
+
+uint32_t PLSCaptureRenderer::definePaint(const PLSPaint* paint)
+{
+    std::vector<uint8_t>& value = m_scratchPaintValue;
+    value.clear();
+    append<uint8_t>(&value, paint->getIsStroked());
+    append<uint8_t>(&value, static_cast<uint8_t>(paint->getJoin()));
+    append<uint8_t>(&value, static_cast<uint8_t>(paint->getCap()));
+    append<uint8_t>(&value, static_cast<uint8_t>(paint->getBlendMode()));
+    append<float>(&value, paint->getThickness());
+    append<uint8_t>(&value, static_cast<uint8_t>(paint->getType()));
+    switch (paint->getType())
+    {
+        case PaintType::linearGradient:
+        case PaintType::radialGradient:
+        {
+            const PLSGradient* gradient = paint->getGradient();
+            append_bytes(&value, gradient->coeffs(), 3 * sizeof(float));
+            append<uint32_t>(&value, gradient->count());
+            append_bytes(&value, gradient->colors(), gradient->count() * sizeof(ColorInt));
+            append_bytes(&value, gradient->stops(), gradient->count() * sizeof(float));
+            break;
+        }
+        case PaintType::image:
+        {
+            // Writes the image's definition, if needed, ahead of the paint's.
+            const PLSTexture* texture = paint->getImageTexture();
+            append<uint32_t>(&value,
+                             defineImage(texture,
+                                         texture->width(),
+                                         texture->height(),
+                                         texture->textureResourceHash()));
+            append<float>(&value, paint->getImageOpacity());
+            break;
+        }
+        case PaintType::solidColor:
+        case PaintType::clipUpdate:
+            append<uint32_t>(&value, paint->getColor());
+            break;
+    }
+
+    auto [iter, isNew] = m_paints.try_emplace(paint);
+    PaintRecord& record = iter->second;
+    if (!isNew && record.value == value)
+    {
+        return record.id;
+    }
+    if (isNew)
+    {
+        record.id = m_nextID++;
+    }
+    record.value = value;
+
+    write(CaptureOp::definePaint);
+    write(record.id);
+    write(static_cast<uint32_t>(value.size()));
+    append_bytes(&m_data, value.data(), value.size());
+    return record.id;
+}
+
+uint32_t PLSCaptureRenderer::defineImage(const void* key,
+                                         uint32_t width,
+                                         uint32_t height,
+                                         uint32_t hash)
+{
+    auto [iter, isNew] = m_images.try_emplace(key);
+    if (isNew)
+    {
+        iter->second = m_nextID++;
+        write(CaptureOp::defineImage);
+        write(iter->second);
+        write(width);
+        write(height);
+        write(hash);
+    }
+    return iter->second;
+}
+
+std::unique_ptr<PLSCaptureReplay> PLSCaptureReplay::Make(std::vector<uint8_t> data,
+                                                         Factory* factory,
+                                                         MakeImageFn makeImage)
+{
+    std::unique_ptr<PLSCaptureReplay> replay(
+        new PLSCaptureReplay(std::move(data), factory, std::move(makeImage)));
+    CaptureReader reader(replay->m_data, 0, replay->m_data.size());
+    char magic[sizeof(kCaptureMagic)];
+    if (!reader.readBytes(magic, sizeof(magic)) ||
+        memcmp(magic, kCaptureMagic, sizeof(magic)) != 0 ||
+        reader.read<uint32_t>() != kCaptureVersion)
+    {
+        return nullptr;
+    }
+    if (!replay->runOps(reader.pos(), replay->m_data.size(), nullptr))
+    {
+        return nullptr;
+    }
+    return replay;
+}
+
+PLSCaptureReplay::PLSCaptureReplay(std::vector<uint8_t> data,
+                                   Factory* factory,
+                                   MakeImageFn makeImage) :
+    m_data(std::move(data)), m_factory(factory), m_makeImage(std::move(makeImage))
+{}
+
+void PLSCaptureReplay::replayFrame(size_t frameIdx, Renderer* renderer)
+{
+    assert(renderer != nullptr);
+    const Frame& frame = m_frames[frameIdx];
+    RIVE_DEBUG_CODE(bool success =) runOps(frame.opsBegin, frame.opsEnd, renderer);
+    assert(success); // Make() already validated the ops.
+}
+
+bool PLSCaptureReplay::runOps(size_t begin, size_t end, Renderer* renderer)
+{
+    // Without a renderer, this is the initial pass from Make(), which also finds the frames.
+    const bool isValidating = renderer == nullptr;
+    bool isInFrame = false;
+    CaptureReader reader(m_data, begin, end);
+    std::vector<uint8_t> verbs;
+    std::vector<Vec2D> points;
+    std::vector<uint8_t> paintValue;
+    while (reader.ok() && !reader.atEnd())
+    {
+        auto op = reader.read<CaptureOp>();
+        switch (op)
+        {
+            case CaptureOp::beginFrame:
+            {
+                PLSRenderContext::FrameDescriptor desc = read_frame_descriptor(&reader);
+                if (!isValidating || isInFrame)
+                {
+                    return false;
+                }
+                m_frames.push_back({desc, reader.pos(), 0});
+                isInFrame = true;
+                break;
+            }
+            case CaptureOp::endFrame:
+                if (!isValidating || !isInFrame)
+                {
+                    return false;
+                }
+                m_frames.back().opsEnd = reader.pos() - sizeof(CaptureOp);
+                isInFrame = false;
+                break;
+            case CaptureOp::save:
+                if (!isValidating)
+                {
+                    renderer->save();
+                }
+                break;
+            case CaptureOp::restore:
+                if (!isValidating)
+                {
+                    renderer->restore();
+                }
+                break;
+            case CaptureOp::transform:
+            {
+                float m[6];
+                reader.readBytes(m, sizeof(m));
+                if (!isValidating)
+                {
+                    renderer->transform(Mat2D(m[0], m[1], m[2], m[3], m[4], m[5]));
+                }
+                break;
+            }
+            case CaptureOp::definePath:
+            {
+                auto id = reader.read<uint32_t>();
+                auto fillRule = static_cast<FillRule>(reader.read<uint8_t>());
+                auto verbCount = reader.read<uint32_t>();
+                auto pointCount = reader.read<uint32_t>();
+                if (!reader.ok() || verbCount > end - reader.pos())
+                {
+                    return false;
+                }
+                verbs.resize(verbCount);
+                reader.readBytes(verbs.data(), verbCount);
+                if (!reader.ok() || pointCount > (end - reader.pos()) / sizeof(Vec2D))
+                {
+                    return false;
+                }
+                points.resize(pointCount);
+                reader.readBytes(points.data(), pointCount * sizeof(Vec2D));
+
+                RawPath rawPath;
+                const Vec2D* pts = points.data();
+                const Vec2D* ptsEnd = pts + points.size();
+                for (uint8_t verb : verbs)
+                {
+                    switch (static_cast<PathVerb>(verb))
+                    {
+                        case PathVerb::move:
+                            if (ptsEnd - pts < 1)
+                                return false;
+                            rawPath.move(pts[0]);
+                            pts += 1;
+                            break;
+                        case PathVerb::line:
+                            if (ptsEnd - pts < 1)
+                                return false;
+                            rawPath.line(pts[0]);
+                            pts += 1;
+                            break;
+                        case PathVerb::quad:
+                            if (ptsEnd - pts < 2)
+                                return false;
+                            rawPath.quad(pts[0], pts[1]);
+                            pts += 2;
+                            break;
+                        case PathVerb::cubic:
+                            if (ptsEnd - pts < 3)
+                                return false;
+                            rawPath.cubic(pts[0], pts[1], pts[2]);
+                            pts += 3;
+                            break;
+                        case PathVerb::close:
+                            rawPath.close();
+                            break;
+                        default:
+                            return false;
+                    }
+                }
+                if (pts != ptsEnd)
+                {
+                    return false;
+                }
+                if (!isValidating)
+                {
+                    m_paths[id] = m_factory->makeRenderPath(rawPath, fillRule);
+                }
+                break;
+            }
+            case CaptureOp::definePaint:
+            {
+                auto id = reader.read<uint32_t>();
+                auto valueSize = reader.read<uint32_t>();
+                if (!reader.ok() || valueSize > end - reader.pos())
+                {
+                    return false;
+                }
+                paintValue.resize(valueSize);
+                reader.readBytes(paintValue.data(), valueSize);
+                CaptureReader valueReader(paintValue, 0, paintValue.size());
+                bool stroked = valueReader.read<uint8_t>();
+                auto join = static_cast<StrokeJoin>(valueReader.read<uint8_t>());
+                auto cap = static_cast<StrokeCap>(valueReader.read<uint8_t>());
+                auto blendMode = static_cast<BlendMode>(valueReader.read<uint8_t>());
+                auto thickness = valueReader.read<float>();
+                auto paintType = static_cast<PaintType>(valueReader.read<uint8_t>());
+                rcp<RenderPaint> paint;
+                if (!isValidating)
+                {
+                    paint = m_factory->makeRenderPaint();
+                }
+                auto plsPaint = lite_rtti_cast<PLSPaint*>(paint.get());
+                switch (paintType)
+                {
+                    case PaintType::linearGradient:
+                    case PaintType::radialGradient:
+                    {
+                        float coeffs[3];
+                        valueReader.readBytes(coeffs, sizeof(coeffs));
+                        auto count = valueReader.read<uint32_t>();
+                        if (!valueReader.ok() || count == 0 ||
+                            count > valueSize / (sizeof(ColorInt) + sizeof(float)))
+                        {
+                            return false;
+                        }
+                        std::vector<ColorInt> colors(count);
+                        std::vector<float> stops(count);
+                        valueReader.readBytes(colors.data(), count * sizeof(ColorInt));
+                        valueReader.readBytes(stops.data(), count * sizeof(float));
+                        if (paint == nullptr)
+                        {
+                            break;
+                        }
+                        if (paintType == PaintType::linearGradient)
+                        {
+                            // The stops were already normalized to [0, 1], so recover endpoints
+                            // that put t=0 and t=1 at the same places as the recorded
+                            // coefficients: dot(v, start) == -coeffs[2], end - start == v/|v|^2.
+                            Vec2D v = {coeffs[0], coeffs[1]};
+                            float lengthSquared = Vec2D::dot(v, v);
+                            Vec2D d = lengthSquared > 0 ? v * (1 / lengthSquared) : Vec2D{0, 0};
+                            Vec2D start = d * -coeffs[2];
+                            Vec2D endpoint = start + d;
+                            paint->shader(m_factory->makeLinearGradient(start.x,
+                                                                        start.y,
+                                                                        endpoint.x,
+                                                                        endpoint.y,
+                                                                        colors.data(),
+                                                                        stops.data(),
+                                                                        count));
+                        }
+                        else
+                        {
+                            paint->shader(m_factory->makeRadialGradient(coeffs[0],
+                                                                        coeffs[1],
+                                                                        coeffs[2],
+                                                                        colors.data(),
+                                                                        stops.data(),
+                                                                        count));
+                        }
+                        break;
+                    }
+                    case PaintType::image:
+                    {
+                        auto imageID = valueReader.read<uint32_t>();
+                        auto opacity = valueReader.read<float>();
+                        if (plsPaint == nullptr)
+                        {
+                            break;
+                        }
+                        auto iter = m_images.find(imageID);
+                        auto image = iter != m_images.end()
+                                         ? lite_rtti_cast<PLSImage*>(iter->second.get())
+                                         : nullptr;
+                        if (image != nullptr && image->getTexture() != nullptr)
+                        {
+                            plsPaint->image(ref_rcp(image->getTexture()), opacity);
+                        }
+                        break;
+                    }
+                    case PaintType::solidColor:
+                    case PaintType::clipUpdate:
+                    {
+                        auto color = valueReader.read<uint32_t>();
+                        if (paint != nullptr)
+                        {
+                            paint->color(color);
+                        }
+                        break;
+                    }
+                    default:
+                        return false;
+                }
+                if (!valueReader.ok())
+                {
+                    return false;
+                }
+                if (paint != nullptr)
+                {
+                    paint->style(stroked ? RenderPaintStyle::stroke : RenderPaintStyle::fill);
+                    paint->join(join);
+                    paint->cap(cap);
+                    paint->thickness(thickness);
+                    paint->blendMode(blendMode);
+                    m_paints[id] = std::move(paint);
+                }
+                break;
+            }
+            case CaptureOp::defineImage:
+            {
+                auto id = reader.read<uint32_t>();
+                auto width = reader.read<uint32_t>();
+                auto height = reader.read<uint32_t>();
+                auto hash = reader.read<uint32_t>();
+                if (!isValidating && m_images.find(id) == m_images.end())
+                {
+                    // Images never change, so they only have to be made once.
+                    m_images[id] = m_makeImage != nullptr ? m_makeImage(width, height, hash)
+                                                          : nullptr;
+                }
+                break;
+            }
+            case CaptureOp::drawPath:
+            {
+                auto pathID = reader.read<uint32_t>();
+                auto paintID = reader.read<uint32_t>();
+                if (!isValidating)
+                {
+                    auto path = m_paths.find(pathID);
+                    auto paint = m_paints.find(paintID);
+                    if (path != m_paths.end() && paint != m_paints.end())
+                    {
+                        renderer->drawPath(path->second.get(), paint->second.get());
+                    }
+                }
+                break;
+            }
+            case CaptureOp::clipPath:
+            {
+                auto pathID = reader.read<uint32_t>();
+                if (!isValidating)
+                {
+                    auto path = m_paths.find(pathID);
+                    if (path != m_paths.end())
+                    {
+                        renderer->clipPath(path->second.get());
+                    }
+                }
+                break;
+            }
+            case CaptureOp::drawImage:
+            {
+                auto imageID = reader.read<uint32_t>();
+                auto blendMode = static_cast<BlendMode>(reader.read<uint8_t>());
+                auto opacity = reader.read<float>();
+                if (!isValidating)
+                {
+                    auto image = m_images.find(imageID);
+                    if (image != m_images.end() && image->second != nullptr)
+                    {
+                        renderer->drawImage(image->second.get(), blendMode, opacity);
+                    }
+                }
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return reader.ok() && !isInFrame;
+}
+} // namespace rive::pls
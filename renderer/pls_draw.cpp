@@ -4,12 +4,15 @@
 
 #include "rive/pls/pls_draw.hpp"
 
+#include "async_triangulator.hpp"
 #include "gr_inner_fan_triangulator.hpp"
 #include "path_utils.hpp"
 #include "pls_path.hpp"
 #include "pls_paint.hpp"
 #include "rive/math/wangs_formula.hpp"
 #include "rive/pls/pls_image.hpp"
+#include "rive/pls/pls_renderer.hpp"
+#include "rive/pls/pls_trace.hpp"
 #include "shaders/constants.glsl"
 
 namespace rive::pls
@@ -107,12 +110,14 @@ RIVE_ALWAYS_INLINE void find_cubic_tangents(const Vec2D p[4], Vec2D tangents[2])
 // visually equivalent to the original when stroked, but the cusp won't have artifacts when rendered
 // using the parametric/polar sorting algorithm.
 //
-// The size of dst[] must be 6 * n + 4 Vec2Ds.
+// The size of dst[] must be 6 * n + 4 Vec2Ds. 'polarPrecision' is the frame's polar precision (see
+// PLSRenderContext::framePolarPrecision()), which sizes the pivot to stay sub-segment.
 static void chop_cubic_around_cusps(const Vec2D p[4],
                                     Vec2D dst[/*6 * n + 4*/],
                                     const float cuspT[],
                                     int n,
-                                    float matrixMaxScale)
+                                    float matrixMaxScale,
+                                    float polarPrecision)
 {
     float t[4];
     assert(n * 2 <= std::size(t));
@@ -137,7 +142,7 @@ static void chop_cubic_around_cusps(const Vec2D p[4],
         // The only purpose of the middle cubic is to capture the cusp's 180-degree rotation.
         // Implement it as a sub-pixel 180-degree pivot.
         Vec2D pivot = (chops[2] + chops[7]) * .5f;
-        pivot = (cusp - pivot).normalized() / (matrixMaxScale * kPolarPrecision * 2) + cusp;
+        pivot = (cusp - pivot).normalized() / (matrixMaxScale * polarPrecision * 2) + cusp;
         chops[4] = chops[5] = pivot;
     }
 }
@@ -273,6 +278,124 @@ RIVE_ALWAYS_INLINE uint32_t join_type_flags(StrokeJoin join)
     }
     RIVE_UNREACHABLE();
 }
+
+// Evaluates Wang's formula (raised to the 4th power, like wangs_formula::cubic_pow4()) on batches
+// of 4 cubics at a time, with one cubic in each SIMD lane.
+//
+// Curves get pushed in the order of their curveIdx. Since each contour's curves begin on a multiple
+// of 4, the results of every batch can be written out with a single aligned float4 store.
+class CubicSegmentCounter4
+{
+public:
+    CubicSegmentCounter4(const Mat2D& matrix, float parametricPrecision) :
+        m_matrix(matrix), m_lengthTerm(3 * 2 / 8.f * parametricPrecision)
+    {}
+
+    // Queues the cubic 'p', whose result goes in dst[curveIdx]. Writes the batch out once the final
+    // lane of a group of 4 is filled.
+    RIVE_ALWAYS_INLINE void push(const Vec2D p[4], size_t curveIdx, uint32_t* dst)
+    {
+        size_t lane = curveIdx & 3;
+        for (size_t i = 0; i < 4; ++i)
+        {
+            m_x[i][lane] = p[i].x;
+            m_y[i][lane] = p[i].y;
+        }
+        if (lane == 3)
+        {
+            flush(dst + curveIdx - 3);
+        }
+    }
+
+    // Writes out a partially filled batch at the end of a contour. The unused lanes still hold
+    // finite values from prior curves, which the caller ignores.
+    void flushPartialBatch(size_t endCurveIdx, uint32_t* dst)
+    {
+        if ((endCurveIdx & 3) != 0)
+        {
+            flush(dst + (endCurveIdx & ~size_t(3)));
+        }
+    }
+
+private:
+    void flush(uint32_t* dst)
+    {
+        float4 x0 = simd::load4f(m_x[0]), y0 = simd::load4f(m_y[0]);
+        float4 x1 = simd::load4f(m_x[1]), y1 = simd::load4f(m_y[1]);
+        float4 x2 = simd::load4f(m_x[2]), y2 = simd::load4f(m_y[2]);
+        float4 x3 = simd::load4f(m_x[3]), y3 = simd::load4f(m_y[3]);
+        // Second differences of the control points.
+        float4 ux = -2.f * x1 + x0 + x2, uy = -2.f * y1 + y0 + y2;
+        float4 vx = -2.f * x2 + x1 + x3, vy = -2.f * y2 + y1 + y3;
+        // Wang's formula is measured after the view matrix (only its linear part matters for
+        // vectors).
+        float4 ux_ = m_matrix.xx() * ux + m_matrix.yx() * uy;
+        float4 uy_ = m_matrix.xy() * ux + m_matrix.yy() * uy;
+        float4 vx_ = m_matrix.xx() * vx + m_matrix.yx() * vy;
+        float4 vy_ = m_matrix.xy() * vx + m_matrix.yy() * vy;
+        // n^4 = ((degree * (degree - 1) / 8) * precision)^2 * max(|u|^2, |v|^2)
+        float4 n4 = simd::max(ux_ * ux_ + uy_ * uy_, vx_ * vx_ + vy_ * vy_) *
+                    (m_lengthTerm * m_lengthTerm);
+        simd::store(dst, n4);
+    }
+
+    const Mat2D m_matrix;
+    const float m_lengthTerm;
+    alignas(16) float m_x[4][4] = {};
+    alignas(16) float m_y[4][4] = {};
+};
+
+// Estimates how many pixels a tiny path covers: the area of its fill, or, if strokeThickness is
+// nonzero, the length of its stroke times the thickness (in pixels).
+float find_tiny_path_coverage_area(const RawPath& rawPath,
+                                   const Mat2D& matrix,
+                                   float strokeThickness)
+{
+    float doubleArea = 0;
+    float length = 0;
+    Vec2D contourP0 = {0, 0}, lastPt = {0, 0};
+    for (auto [verb, pts] : rawPath)
+    {
+        switch (verb)
+        {
+            case PathVerb::move:
+                doubleArea += Vec2D::cross(lastPt, contourP0);
+                contourP0 = lastPt = matrix * pts[0];
+                break;
+            case PathVerb::close:
+                length += (contourP0 - lastPt).length();
+                break;
+            case PathVerb::line:
+            {
+                Vec2D p1 = matrix * pts[1];
+                doubleArea += Vec2D::cross(lastPt, p1);
+                length += (p1 - lastPt).length();
+                lastPt = p1;
+                break;
+            }
+            case PathVerb::quad:
+                RIVE_UNREACHABLE();
+            case PathVerb::cubic:
+            {
+                Vec2D p[4] = {lastPt, matrix * pts[1], matrix * pts[2], matrix * pts[3]};
+                // Green's theorem gives the exact (doubled) signed area swept by the cubic.
+                doubleArea += (6 * Vec2D::cross(p[0], p[1]) + 3 * Vec2D::cross(p[0], p[2]) +
+                               Vec2D::cross(p[0], p[3]) + 3 * Vec2D::cross(p[1], p[2]) +
+                               3 * Vec2D::cross(p[1], p[3]) + 6 * Vec2D::cross(p[2], p[3])) *
+                              .1f;
+                // The average of the chord and control polygon lengths approximates arc length.
+                float chordLength = (p[3] - p[0]).length();
+                float polygonLength =
+                    (p[1] - p[0]).length() + (p[2] - p[1]).length() + (p[3] - p[2]).length();
+                length += (chordLength + polygonLength) * .5f;
+                lastPt = p[3];
+                break;
+            }
+        }
+    }
+    doubleArea += Vec2D::cross(lastPt, contourP0);
+    return strokeThickness != 0 ? length * strokeThickness : fabsf(doubleArea) * .5f;
+}
 } // namespace
 
 PLSDraw::PLSDraw(IAABB pixelBounds,
@@ -324,6 +447,37 @@ void PLSDraw::releaseRefs()
     safe_unref(m_gradientRef);
 }
 
+bool PLSDraw::hashContent(DrawStreamHash* hash) const
+{
+    hash->write(m_type)
+        .write(m_pixelBounds)
+        .write(m_matrix)
+        .write(m_blendMode)
+        .write(m_clipID)
+        .write(m_drawContents)
+        .write(m_simplePaintValue.color);
+    // Texture resource hashes are never reused, unlike pointers.
+    hash->write(m_imageTextureRef != nullptr ? m_imageTextureRef->textureResourceHash() : 0);
+    hash->write(m_clipRectInverseMatrix != nullptr);
+    if (m_clipRectInverseMatrix != nullptr)
+    {
+        Vec2D cornerRadii = m_clipRectInverseMatrix->normalizedCornerRadii();
+        hash->write(m_clipRectInverseMatrix->inverseMatrix())
+            .write(cornerRadii.x)
+            .write(cornerRadii.y);
+    }
+    hash->write(m_gradientRef != nullptr);
+    if (m_gradientRef != nullptr)
+    {
+        hash->write(m_gradientRef->paintType())
+            .writeBytes(m_gradientRef->coeffs(), 3 * sizeof(float))
+            .write(m_gradientRef->count())
+            .writeBytes(m_gradientRef->stops(), m_gradientRef->count() * sizeof(float))
+            .writeBytes(m_gradientRef->colors(), m_gradientRef->count() * sizeof(ColorInt));
+    }
+    return true;
+}
+
 PLSDrawUniquePtr PLSPathDraw::Make(PLSRenderContext* context,
                                    const Mat2D& matrix,
                                    rcp<const PLSPath> path,
@@ -331,8 +485,39 @@ PLSDrawUniquePtr PLSPathDraw::Make(PLSRenderContext* context,
                                    const PLSPaint* paint,
                                    RawPath* scratchPath)
 {
-    assert(path != nullptr);
-    assert(paint != nullptr);
+    return Make(context,
+                &context->drawAllocators(),
+                scratchPath,
+                matrix,
+                std::move(path),
+                fillRule,
+                paint);
+}
+
+PLSDrawUniquePtr PLSPathDraw::Make(PLSRenderContext* context,
+                                   PLSRenderContext::DrawAllocators* allocators,
+                                   const Mat2D& matrix,
+                                   rcp<const PLSPath> path,
+                                   FillRule fillRule,
+                                   const PLSPaint* paint)
+{
+    return Make(context,
+                allocators,
+                allocators->scratchPath(),
+                matrix,
+                std::move(path),
+                fillRule,
+                paint);
+}
+
+namespace
+{
+// Returns the pixel-space bounding box of the given path draw, including its stroke outset.
+AABB find_mapped_path_bounds(const PLSRenderContext* context,
+                             const Mat2D& matrix,
+                             const PLSPath* path,
+                             const PLSPaint* paint)
+{
     AABB mappedBounds;
     if (context->frameInterlockMode() == pls::InterlockMode::atomics)
     {
@@ -362,36 +547,401 @@ PLSDrawUniquePtr PLSPathDraw::Make(PLSRenderContext* context,
         AABB strokePixelOutset = matrix.mapBoundingBox({0, 0, strokeOutset, strokeOutset});
         mappedBounds = mappedBounds.inset(-strokePixelOutset.width(), -strokePixelOutset.height());
     }
+    return mappedBounds;
+}
+
+// Use interior triangulation to draw filled paths if they're large enough to benefit from it.
+bool uses_interior_triangulation(const PLSRenderContext* context,
+                                 const Mat2D& matrix,
+                                 const PLSPath* path,
+                                 const PLSPaint* paint)
+{
+    // depthStencil mode draws interior triangulations with stencil-then-cover, which doesn't
+    // support the stencil operations of clip updates yet.
+    return !paint->getIsStroked() &&
+           (context->frameInterlockMode() != pls::InterlockMode::depthStencil ||
+            paint->getType() != pls::PaintType::clipUpdate) &&
+           pls::FindTransformedArea(path->getBounds(), matrix) > 512 * 512;
+}
+
+// Paths with at least this many verbs are too slow to triangulate as a single polygon, so their
+// interiors get split into bands of roughly kTriangulationBandVertexCount vertices each.
+constexpr static size_t kMinBandedTriangulationVerbCount = 1000;
+constexpr static size_t kTriangulationBandVertexCount = 1024;
+constexpr static size_t kMaxTriangulationBandCount = 32;
+
+RIVE_ALWAYS_INLINE float& axis_coord(Vec2D& p, int axis) { return axis == 0 ? p.x : p.y; }
+RIVE_ALWAYS_INLINE float axis_coord(const Vec2D& p, int axis) { return axis == 0 ? p.x : p.y; }
+
+// Returns the point where the segment pq crosses 'c' on the given axis. The result only depends on
+// the segment, not on its direction, so neighboring bands clip to identical vertices along their
+// shared boundary.
+Vec2D band_crossing_point(Vec2D p, Vec2D q, int axis, float c)
+{
+    if (axis_coord(q, axis) < axis_coord(p, axis))
+    {
+        std::swap(p, q);
+    }
+    float t = (c - axis_coord(p, axis)) / (axis_coord(q, axis) - axis_coord(p, axis));
+    Vec2D crossing = {p.x + (q.x - p.x) * t, p.y + (q.y - p.y) * t};
+    axis_coord(crossing, axis) = c;
+    return crossing;
+}
+
+// Sutherland-Hodgman clips a closed contour to the half plane where "p[axis] * sign >= c * sign".
+// Points in the half plane keep the winding number they had in the original contour.
+void clip_contour_to_half_plane(const std::vector<Vec2D>& contour,
+                                int axis,
+                                float c,
+                                float sign,
+                                std::vector<Vec2D>* clipped)
+{
+    clipped->clear();
+    if (contour.empty())
+    {
+        return;
+    }
+    Vec2D prev = contour.back();
+    bool prevInside = (axis_coord(prev, axis) - c) * sign >= 0;
+    for (Vec2D pt : contour)
+    {
+        bool inside = (axis_coord(pt, axis) - c) * sign >= 0;
+        if (inside != prevInside)
+        {
+            clipped->push_back(band_crossing_point(prev, pt, axis, c));
+        }
+        if (inside)
+        {
+            clipped->push_back(pt);
+        }
+        prev = pt;
+        prevInside = inside;
+    }
+}
+
+// Replaces 'band' with the portion of 'polygon' (closed contours of lines, as built by
+// InteriorTriangulationDraw::processPath()) that lies between 'lo' and 'hi' on the given axis.
+// Infinite bounds don't clip.
+void clip_polygon_to_band(const RawPath& polygon, int axis, float lo, float hi, RawPath* band)
+{
+    std::vector<Vec2D> contour, loClipped, hiClipped;
+    auto finishContour = [&]() {
+        const std::vector<Vec2D>* pts = &contour;
+        if (lo != -std::numeric_limits<float>::infinity())
+        {
+            clip_contour_to_half_plane(*pts, axis, lo, 1, &loClipped);
+            pts = &loClipped;
+        }
+        if (hi != std::numeric_limits<float>::infinity())
+        {
+            clip_contour_to_half_plane(*pts, axis, hi, -1, &hiClipped);
+            pts = &hiClipped;
+        }
+        if (pts->size() >= 3)
+        {
+            band->move((*pts)[0]);
+            for (size_t i = 1; i < pts->size(); ++i)
+            {
+                band->line((*pts)[i]);
+            }
+        }
+        contour.clear();
+    };
+    band->rewind();
+    for (const auto [verb, pts] : polygon)
+    {
+        switch (verb)
+        {
+            case PathVerb::move:
+                finishContour();
+                contour.push_back(pts[0]);
+                break;
+            case PathVerb::line:
+                contour.push_back(pts[1]);
+                break;
+            default:
+                break;
+        }
+    }
+    finishContour();
+}
+} // namespace
+
+PLSDrawUniquePtr PLSPathDraw::Make(PLSRenderContext* context,
+                                   PLSRenderContext::DrawAllocators* allocators,
+                                   RawPath* scratchPath,
+                                   const Mat2D& matrix,
+                                   rcp<const PLSPath> path,
+                                   FillRule fillRule,
+                                   const PLSPaint* paint)
+{
+    PLS_TRACE_SCOPE("PLSPathDraw::Make");
+    assert(path != nullptr);
+    assert(paint != nullptr);
+    AABB mappedBounds = find_mapped_path_bounds(context, matrix, path.get(), paint);
+    if (PLSDrawUniquePtr lodDraw =
+            MakeTinyPathLODDraw(context, allocators, mappedBounds, matrix, path.get(), paint))
+    {
+        return lodDraw;
+    }
+    if (PLSDrawUniquePtr rectDraw = MakeSolidRectDraw(context,
+                                                      allocators,
+                                                      mappedBounds,
+                                                      matrix,
+                                                      path.get(),
+                                                      paint,
+                                                      paint->getColor()))
+    {
+        return rectDraw;
+    }
     IAABB pixelBounds = mappedBounds.roundOut();
-    if (!paint->getIsStroked())
+    if (uses_interior_triangulation(context, matrix, path.get(), paint))
     {
-        // Use interior triangulation to draw filled paths if they're large enough to benefit from
-        // it.
         const AABB& localBounds = path->getBounds();
-        // FIXME! Implement interior triangulation in depthStencil mode.
-        if (context->frameInterlockMode() != pls::InterlockMode::depthStencil &&
-            path->getRawPath().verbs().count() < 1000 &&
-            pls::FindTransformedArea(localBounds, matrix) > 512 * 512)
+        // Retained data lives in the render context, so only draws built on the context's thread
+        // can use it.
+        RetainedInteriorTriangulationData* retainedData =
+            allocators == &context->drawAllocators()
+                ? context->retainedInteriorTriangulationData(path->getRawPathMutationID())
+                : nullptr;
+        return PLSDrawUniquePtr(allocators->perFrameAllocator().make<InteriorTriangulationDraw>(
+            context,
+            allocators,
+            pixelBounds,
+            matrix,
+            std::move(path),
+            fillRule,
+            paint,
+            scratchPath,
+            localBounds.width() > localBounds.height()
+                ? InteriorTriangulationDraw::TriangulatorAxis::horizontal
+                : InteriorTriangulationDraw::TriangulatorAxis::vertical,
+            retainedData));
+    }
+    // Retained data lives in the render context, so only draws built on the context's thread can
+    // use it.
+    RetainedMidpointFanData* retainedData =
+        allocators == &context->drawAllocators()
+            ? context->retainedMidpointFanData(path->getRawPathMutationID())
+            : nullptr;
+    return PLSDrawUniquePtr(
+        allocators->perFrameAllocator().make<MidpointFanPathDraw>(context,
+                                                                  allocators,
+                                                                  pixelBounds,
+                                                                  matrix,
+                                                                  std::move(path),
+                                                                  fillRule,
+                                                                  paint,
+                                                                  retainedData));
+}
+
+void PLSPathDraw::MakeInstances(PLSRenderContext* context,
+                                const Mat2D& viewMatrix,
+                                Span<const Mat2D> instanceMatrices,
+                                Span<const ColorInt> instanceColors,
+                                rcp<const PLSPath> path,
+                                FillRule fillRule,
+                                const PLSPaint* paint,
+                                RawPath* scratchPath,
+                                std::vector<PLSDrawUniquePtr>* draws)
+{
+    assert(path != nullptr);
+    assert(paint != nullptr);
+    assert(instanceColors.empty() || instanceColors.size() == instanceMatrices.size());
+    PLSRenderContext::DrawAllocators* allocators = &context->drawAllocators();
+    const bool overridesColor =
+        !instanceColors.empty() && paint->getType() == pls::PaintType::solidColor;
+
+    // The shared analysis is made at the largest scale of any instance, which yields enough
+    // tessellation segments for all of them. (Wang's formula and the polar segment counts both
+    // grow with scale, regardless of rotation.)
+    float maxScale = 0;
+    for (const Mat2D& instanceMatrix : instanceMatrices)
+    {
+        maxScale = fmaxf(maxScale, (viewMatrix * instanceMatrix).findMaxScale());
+    }
+
+    PLSDrawUniquePtr prototype; // Built lazily, and never pushed.
+    for (size_t i = 0; i < instanceMatrices.size(); ++i)
+    {
+        Mat2D matrix = viewMatrix * instanceMatrices[i];
+        AABB mappedBounds = find_mapped_path_bounds(context, matrix, path.get(), paint);
+        PLSDrawUniquePtr draw =
+            MakeTinyPathLODDraw(context, allocators, mappedBounds, matrix, path.get(), paint);
+        if (draw == nullptr)
         {
-            return PLSDrawUniquePtr(context->make<InteriorTriangulationDraw>(
-                context,
-                pixelBounds,
-                matrix,
-                std::move(path),
-                fillRule,
-                paint,
-                scratchPath,
-                localBounds.width() > localBounds.height()
-                    ? InteriorTriangulationDraw::TriangulatorAxis::horizontal
-                    : InteriorTriangulationDraw::TriangulatorAxis::vertical));
+            // Solid rects get made with the instance's color already.
+            draw = MakeSolidRectDraw(context,
+                                     allocators,
+                                     mappedBounds,
+                                     matrix,
+                                     path.get(),
+                                     paint,
+                                     overridesColor ? instanceColors[i] : paint->getColor());
+            if (draw != nullptr)
+            {
+                draws->push_back(std::move(draw));
+                continue;
+            }
+            if (uses_interior_triangulation(context, matrix, path.get(), paint))
+            {
+                // Interior triangulations depend on the full matrix. Build these individually.
+                draw = Make(context, allocators, scratchPath, matrix, path, fillRule, paint);
+            }
+            else
+            {
+                if (prototype == nullptr)
+                {
+                    prototype = PLSDrawUniquePtr(
+                        allocators->perFrameAllocator().make<MidpointFanPathDraw>(
+                            context,
+                            allocators,
+                            mappedBounds.roundOut(),
+                            Mat2D(maxScale, 0, 0, maxScale, 0, 0),
+                            path,
+                            fillRule,
+                            paint));
+                }
+                draw = PLSDrawUniquePtr(allocators->perFrameAllocator().make<MidpointFanPathDraw>(
+                    context,
+                    static_cast<const MidpointFanPathDraw&>(*prototype),
+                    mappedBounds.roundOut(),
+                    matrix,
+                    paint));
+            }
         }
+        if (overridesColor)
+        {
+            static_cast<PLSPathDraw*>(draw.get())->setSolidColor(instanceColors[i]);
+        }
+        draws->push_back(std::move(draw));
     }
-    return PLSDrawUniquePtr(context->make<MidpointFanPathDraw>(context,
-                                                               pixelBounds,
-                                                               matrix,
-                                                               std::move(path),
-                                                               fillRule,
-                                                               paint));
+}
+
+PLSDrawUniquePtr PLSPathDraw::MakeTinyPathLODDraw(PLSRenderContext* context,
+                                                  PLSRenderContext::DrawAllocators* allocators,
+                                                  const AABB& mappedBounds,
+                                                  const Mat2D& matrix,
+                                                  const PLSPath* path,
+                                                  const PLSPaint* paint)
+{
+    // Past about a pixel, the shape of the path (a circle vs. a box, a diagonal stroke vs. a
+    // square, a stroked outline vs. a fill) becomes visible, so those paths keep their geometry.
+    constexpr static float kMaxDotPixelSize = 1;
+    float tinyPathLODPixelSize =
+        fminf(context->frameDescriptor().tinyPathLODPixelSize, kMaxDotPixelSize);
+    if (tinyPathLODPixelSize <= 0 || paint->getType() != pls::PaintType::solidColor ||
+        fmaxf(mappedBounds.width(), mappedBounds.height()) > tinyPathLODPixelSize)
+    {
+        return nullptr;
+    }
+    // This path covers a pixel or less, so all that's left of its shape is how much of the pixel
+    // it covers. Instead of tessellating it in full (with polar segments, joins, caps, and
+    // padding), draw it as a dot with the same coverage area (counting the stroke, if any),
+    // centered in its bounds. The dot is a single midpoint fan patch. Since the paint is a solid
+    // color, it doesn't matter that the dot is drawn with a different matrix.
+    float coverageArea = find_tiny_path_coverage_area(
+        path->getRawPath(),
+        matrix,
+        paint->getIsStroked() ? paint->getThickness() * matrix.findMaxScale() : 0);
+    float boundsArea = mappedBounds.width() * mappedBounds.height();
+    if (!(coverageArea > 0 && boundsArea > 0))
+    {
+        return nullptr;
+    }
+    float scale = sqrtf(fminf(coverageArea / boundsArea, 1));
+    float w = mappedBounds.width() * scale;
+    float h = mappedBounds.height() * scale;
+    float l = (mappedBounds.left() + mappedBounds.right() - w) * .5f;
+    float t = (mappedBounds.top() + mappedBounds.bottom() - h) * .5f;
+    return PLSDrawUniquePtr(allocators->perFrameAllocator().make<MidpointFanPathDraw>(
+        context,
+        allocators,
+        AABB{l, t, l + w, t + h}.roundOut(),
+        Mat2D(w, 0, 0, h, l, t),
+        ref_rcp(context->m_unitRectPath.get()),
+        FillRule::nonZero,
+        paint,
+        nullptr, // retainedData
+        /*forceFill=*/true));
+}
+
+PLSDrawUniquePtr PLSPathDraw::MakeSolidRectDraw(PLSRenderContext* context,
+                                                PLSRenderContext::DrawAllocators* allocators,
+                                                const AABB& mappedBounds,
+                                                const Mat2D& matrix,
+                                                const PLSPath* path,
+                                                const PLSPaint* paint,
+                                                ColorInt color)
+{
+    AABB rect;
+    if (paint->getType() != pls::PaintType::solidColor || paint->getIsStroked() ||
+        !PLSRenderer::IsAABB(path->getRawPath(), &rect) || !(rect.width() > 0) ||
+        !(rect.height() > 0))
+    {
+        return nullptr;
+    }
+    Mat2D rectMatrix = matrix * Mat2D(rect.width(), 0, 0, rect.height(), rect.left(), rect.top());
+    if (SolidRectDraw::FrameSupports(context))
+    {
+        return PLSDrawUniquePtr(allocators->perFrameAllocator().make<SolidRectDraw>(
+            context,
+            mappedBounds.roundOut(),
+            rectMatrix,
+            paint->getBlendMode(),
+            color));
+    }
+    // A rectangle fill is a single contour of 4 lines, which chops and tessellates the same way at
+    // any scale. So instead of analyzing the path again, draw it as an instance of the unit rect,
+    // mapped onto the rectangle. The paint is a solid color, so the different path matrix doesn't
+    // affect shading.
+    PLSDrawUniquePtr& prototype = allocators->unitRectPrototype();
+    if (prototype == nullptr)
+    {
+        prototype = PLSDrawUniquePtr(allocators->perFrameAllocator().make<MidpointFanPathDraw>(
+            context,
+            allocators,
+            IAABB{0, 0, 1, 1},
+            Mat2D(),
+            ref_rcp(context->m_unitRectPath.get()),
+            FillRule::nonZero,
+            paint));
+    }
+    auto draw = allocators->perFrameAllocator().make<MidpointFanPathDraw>(
+        context,
+        static_cast<const MidpointFanPathDraw&>(*prototype),
+        mappedBounds.roundOut(),
+        rectMatrix,
+        paint);
+    if (color != paint->getColor())
+    {
+        draw->setSolidColor(color);
+    }
+    return PLSDrawUniquePtr(draw);
+}
+
+// Returns the pixels fully contained by 'rect' under 'matrix', or empty if the matrix isn't axis
+// aligned.
+static IAABB find_rect_occluder_bounds(const Mat2D& matrix, const AABB& rect)
+{
+    bool isAxisAligned =
+        (matrix.xy() == 0 && matrix.yx() == 0) || (matrix.xx() == 0 && matrix.yy() == 0);
+    if (!isAxisAligned)
+    {
+        return {0, 0, 0, 0};
+    }
+    // Round in, and clamp to the fullscreen bounds so the integer casts can't overflow.
+    constexpr static float kMaxCoord = PLSDraw::kFullscreenPixelBounds.right;
+    AABB mappedRect = matrix.mapBoundingBox(rect);
+    float l = ceilf(fminf(fmaxf(mappedRect.left(), -kMaxCoord), kMaxCoord));
+    float t = ceilf(fminf(fmaxf(mappedRect.top(), -kMaxCoord), kMaxCoord));
+    float r = floorf(fminf(fmaxf(mappedRect.right(), -kMaxCoord), kMaxCoord));
+    float b = floorf(fminf(fmaxf(mappedRect.bottom(), -kMaxCoord), kMaxCoord));
+    if (!(l < r && t < b))
+    {
+        return {0, 0, 0, 0};
+    }
+    return {static_cast<int>(l), static_cast<int>(t), static_cast<int>(r), static_cast<int>(b)};
 }
 
 PLSPathDraw::PLSPathDraw(IAABB pixelBounds,
@@ -400,20 +950,28 @@ PLSPathDraw::PLSPathDraw(IAABB pixelBounds,
                          FillRule fillRule,
                          const PLSPaint* paint,
                          Type type,
-                         pls::InterlockMode frameInterlockMode) :
+                         pls::InterlockMode frameInterlockMode,
+                         bool forceFill) :
     PLSDraw(pixelBounds, matrix, paint->getBlendMode(), ref_rcp(paint->getImageTexture()), type),
     m_pathRef(path.release()),
-    m_fillRule(paint->getIsStroked() ? FillRule::nonZero : fillRule),
+    m_fillRule(paint->getIsStroked() && !forceFill ? FillRule::nonZero : fillRule),
     m_paintType(paint->getType())
 {
     assert(m_pathRef != nullptr);
     assert(!m_pathRef->getRawPath().empty());
     assert(paint != nullptr);
+    const bool stroked = paint->getIsStroked() && !forceFill;
     if (m_blendMode == BlendMode::srcOver && paint->getIsOpaque())
     {
         m_drawContents |= pls::DrawContents::opaquePaint;
+        // Opaque rectangle fills occlude every pixel they fully contain.
+        AABB rect;
+        if (!stroked && PLSRenderer::IsAABB(m_pathRef->getRawPath(), &rect))
+        {
+            m_occluderBounds = find_rect_occluder_bounds(matrix, rect);
+        }
     }
-    if (paint->getIsStroked())
+    if (stroked)
     {
         m_drawContents |= pls::DrawContents::stroke;
         m_strokeRadius = paint->getThickness() * .5f;
@@ -489,26 +1047,69 @@ void PLSPathDraw::pushToRenderContext(PLSRenderContext::LogicalFlush* flush)
     }
 }
 
+void PLSPathDraw::setSolidColor(ColorInt color)
+{
+    assert(m_paintType == pls::PaintType::solidColor);
+    m_simplePaintValue.color = color;
+    if (m_blendMode == BlendMode::srcOver && colorAlpha(color) == 0xff)
+    {
+        m_drawContents |= pls::DrawContents::opaquePaint;
+    }
+    else
+    {
+        m_drawContents &= ~pls::DrawContents::opaquePaint;
+        m_occluderBounds = {0, 0, 0, 0};
+    }
+}
+
 void PLSPathDraw::releaseRefs()
 {
     PLSDraw::releaseRefs();
-    RIVE_DEBUG_CODE(m_pathRef->unlockRawPathMutations();)
+    RIVE_DEBUG_CODE(unlockRawPathMutations();)
     m_pathRef->unref();
 }
 
+bool PLSPathDraw::hashContent(DrawStreamHash* hash) const
+{
+    // Raw path mutation IDs are unique across all paths, so they also identify the path.
+    hash->write(m_pathRef->getRawPathMutationID())
+        .write(m_fillRule)
+        .write(m_paintType)
+        .write(m_strokeRadius)
+        .write(m_contourDirections);
+    return PLSDraw::hashContent(hash);
+}
+
+#ifdef DEBUG
+void PLSPathDraw::unlockRawPathMutations()
+{
+    if (m_holdsRawPathMutationLock)
+    {
+        m_pathRef->unlockRawPathMutations();
+        m_holdsRawPathMutationLock = false;
+    }
+}
+#endif
+
 MidpointFanPathDraw::MidpointFanPathDraw(PLSRenderContext* context,
+                                         PLSRenderContext::DrawAllocators* allocators,
                                          IAABB pixelBounds,
                                          const Mat2D& matrix,
                                          rcp<const PLSPath> path,
                                          FillRule fillRule,
-                                         const PLSPaint* paint) :
+                                         const PLSPaint* paint,
+                                         RetainedMidpointFanData* retainedData,
+                                         bool forceFill) :
     PLSPathDraw(pixelBounds,
                 matrix,
                 std::move(path),
                 fillRule,
                 paint,
                 Type::midpointFanPath,
-                context->frameInterlockMode())
+                context->frameInterlockMode(),
+                forceFill),
+    m_parametricPrecision(context->frameParametricPrecision()),
+    m_polarPrecision(context->framePolarPrecision())
 {
     if (isStroked())
     {
@@ -517,13 +1118,45 @@ MidpointFanPathDraw::MidpointFanPathDraw(PLSRenderContext* context,
         m_strokeCap = paint->getCap();
     }
 
+    bool restoresRetainedData = false;
+    if (retainedData != nullptr)
+    {
+        if (!matchesRetainedData(*retainedData))
+        {
+            // Don't save the analysis until we've seen the same draw twice in a row. This avoids
+            // the overhead of saving content that is animating.
+            rekeyRetainedData(retainedData);
+            retainedData->framePrototype = this;
+            retainedData = nullptr;
+        }
+        else if (retainedData->framePrototype != nullptr)
+        {
+            // This path was already analyzed earlier in the frame with the same key. (Text draws
+            // the same glyph paths over and over, only with different translations.) Reference
+            // that analysis instead of redoing or copying it.
+            referenceAnalysis(*retainedData->framePrototype);
+            return;
+        }
+        else
+        {
+            retainedData->framePrototype = this;
+            restoresRetainedData = retainedData->hasData;
+        }
+    }
+
     // Count up how much temporary storage this function will need to reserve in CPU buffers.
     const RawPath& rawPath = m_pathRef->getRawPath();
     size_t contourCount = rawPath.countMoveTos();
     assert(contourCount != 0);
 
     m_contours = reinterpret_cast<ContourInfo*>(
-        context->perFrameAllocator().alloc(sizeof(ContourInfo) * contourCount));
+        allocators->perFrameAllocator().alloc(sizeof(ContourInfo) * contourCount));
+
+    if (restoresRetainedData)
+    {
+        restoreFromRetainedData(allocators, *retainedData, contourCount);
+        return;
+    }
 
     size_t maxStrokedCurvesBeforeChops = 0;
     size_t maxCurves = 0;
@@ -562,12 +1195,12 @@ MidpointFanPathDraw::MidpointFanPathDraw(PLSRenderContext* context,
     // Reserve intermediate space for the polar segment counts of each curve and round join.
     if (isStroked())
     {
-        m_numChops.reset(context->numChopsAllocator(), maxChops);
-        m_chopVertices.reset(context->chopVerticesAllocator(), maxChopVertices);
-        m_tangentPairs = context->tangentPairsAllocator().alloc(maxPaddedRotations);
-        m_polarSegmentCounts = context->polarSegmentCountsAllocator().alloc(maxPaddedRotations);
+        m_numChops.reset(allocators->numChopsAllocator(), maxChops);
+        m_chopVertices.reset(allocators->chopVerticesAllocator(), maxChopVertices);
+        m_tangentPairs = allocators->tangentPairsAllocator().alloc(maxPaddedRotations);
+        m_polarSegmentCounts = allocators->polarSegmentCountsAllocator().alloc(maxPaddedRotations);
     }
-    m_parametricSegmentCounts = context->parametricSegmentCountsAllocator().alloc(maxPaddedCurves);
+    m_parametricSegmentCounts = allocators->parametricSegmentCountsAllocator().alloc(maxPaddedCurves);
 
     size_t lineCount = 0;
     size_t unpaddedCurveCount = 0;
@@ -580,7 +1213,7 @@ MidpointFanPathDraw::MidpointFanPathDraw(PLSRenderContext* context,
     size_t curveIdx = 0;
     size_t rotationIdx = 0; // We measure rotations on both curves and round joins.
     bool roundJoinStroked = isStroked() && m_strokeJoin == StrokeJoin::round;
-    wangs_formula::VectorXform vectorXform(m_matrix);
+    CubicSegmentCounter4 cubicSegmentCounter(m_matrix, m_parametricPrecision);
     RawPath::Iter startOfContour = rawPath.begin();
     RawPath::Iter end = rawPath.end();
     int preChopVerbCount = 0; // Original number of lines and curves, before chopping.
@@ -646,6 +1279,7 @@ MidpointFanPathDraw::MidpointFanPathDraw(PLSRenderContext* context,
             0,                 // paddingVertexCount
             RIVE_DEBUG_CODE(0) // tessVertexCount
         };
+        cubicSegmentCounter.flushPartialBatch(curveIdx, m_parametricSegmentCounts);
         unpaddedCurveCount += curveIdx - contourFirstCurveIdx;
         contourFirstCurveIdx = curveIdx = math::round_up_to_multiple_of<4>(curveIdx);
         unpaddedRotationCount += rotationIdx - contourFirstRotationIdx;
@@ -752,7 +1386,8 @@ MidpointFanPathDraw::MidpointFanPathDraw(PLSRenderContext* context,
                                                 localChopBuffer,
                                                 t,
                                                 numChops,
-                                                m_strokeMatrixMaxScale);
+                                                m_strokeMatrixMaxScale,
+                                                m_polarPrecision);
                         p = localChopBuffer;
                         numChops *= 2;
                         break;
@@ -773,10 +1408,9 @@ MidpointFanPathDraw::MidpointFanPathDraw(PLSRenderContext* context,
                 for (const Vec2D* end = p + numChops * 3 + 3; p != end;
                      p += 3, ++curveIdx, ++rotationIdx)
                 {
-                    float n4 = wangs_formula::cubic_pow4(p, kParametricPrecision, vectorXform);
                     // Record n^4 for now. This will get resolved later.
                     assert(curveIdx < maxPaddedCurves);
-                    RIVE_INLINE_MEMCPY(m_parametricSegmentCounts + curveIdx, &n4, sizeof(uint32_t));
+                    cubicSegmentCounter.push(p, curveIdx, m_parametricSegmentCounts);
                     assert(rotationIdx < maxPaddedRotations);
                     find_cubic_tangents(p, m_tangentPairs[rotationIdx].data());
                 }
@@ -787,10 +1421,9 @@ MidpointFanPathDraw::MidpointFanPathDraw(PLSRenderContext* context,
                 const Vec2D* p = iter.cubicPts();
                 ++preChopVerbCount;
                 endpointsSum += p[3];
-                float n4 = wangs_formula::cubic_pow4(p, kParametricPrecision, vectorXform);
                 // Record n^4 for now. This will get resolved later.
                 assert(curveIdx < maxPaddedCurves);
-                RIVE_INLINE_MEMCPY(m_parametricSegmentCounts + curveIdx++, &n4, sizeof(uint32_t));
+                cubicSegmentCounter.push(p, curveIdx++, m_parametricSegmentCounts);
                 break;
             }
         }
@@ -811,13 +1444,13 @@ MidpointFanPathDraw::MidpointFanPathDraw(PLSRenderContext* context,
     // Return any data we conservatively allocated but did not use.
     if (isStroked())
     {
-        m_numChops.shrinkToFit(context->numChopsAllocator(), maxChops);
-        m_chopVertices.shrinkToFit(context->chopVerticesAllocator(), maxChopVertices);
-        context->tangentPairsAllocator().rewindLastAllocation(maxPaddedRotations - rotationIdx);
-        context->polarSegmentCountsAllocator().rewindLastAllocation(maxPaddedRotations -
+        m_numChops.shrinkToFit(allocators->numChopsAllocator(), maxChops);
+        m_chopVertices.shrinkToFit(allocators->chopVerticesAllocator(), maxChopVertices);
+        allocators->tangentPairsAllocator().rewindLastAllocation(maxPaddedRotations - rotationIdx);
+        allocators->polarSegmentCountsAllocator().rewindLastAllocation(maxPaddedRotations -
                                                                     rotationIdx);
     }
-    context->parametricSegmentCountsAllocator().rewindLastAllocation(maxPaddedCurves - curveIdx);
+    allocators->parametricSegmentCountsAllocator().rewindLastAllocation(maxPaddedCurves - curveIdx);
 
     // Iteration pass 2: Finish calculating the numbers of tessellation segments in each contour,
     // using SIMD.
@@ -858,7 +1491,7 @@ MidpointFanPathDraw::MidpointFanPathDraw(PLSRenderContext* context,
             // round join.
             const float r_ = m_strokeRadius * m_strokeMatrixMaxScale;
             const float polarSegmentsPerRad =
-                pathutils::CalcPolarSegmentsPerRadian<kPolarPrecision>(r_);
+                pathutils::CalcPolarSegmentsPerRadian(r_, m_polarPrecision);
             for (j = contour->firstRotationIdx; j < contour->endRotationIdx; j += 4)
             {
                 // Measure the rotations of curves in batches of 4.
@@ -987,26 +1620,187 @@ MidpointFanPathDraw::MidpointFanPathDraw(PLSRenderContext* context,
     }
 
     assert(contourFirstLineIdx == lineCount);
-    RIVE_DEBUG_CODE(m_pendingLineCount = lineCount);
-    RIVE_DEBUG_CODE(m_pendingCurveCount = unpaddedCurveCount);
-    RIVE_DEBUG_CODE(m_pendingRotationCount = unpaddedRotationCount);
-    RIVE_DEBUG_CODE(m_pendingEmptyStrokeCountForCaps = emptyStrokeCountForCaps);
+    PathCounts pathCounts = {lineCount,
+                             unpaddedCurveCount,
+                             unpaddedRotationCount,
+                             curveIdx,
+                             rotationIdx,
+                             emptyStrokeCountForCaps,
+                             tessVertexCount};
+    setPathCounts(contourCount, pathCounts);
+
+    if (retainedData != nullptr)
+    {
+        saveToRetainedData(retainedData, contourCount, pathCounts);
+    }
+}
 
-    if (tessVertexCount > 0)
+MidpointFanPathDraw::MidpointFanPathDraw(PLSRenderContext* context,
+                                         const MidpointFanPathDraw& prototype,
+                                         IAABB pixelBounds,
+                                         const Mat2D& matrix,
+                                         const PLSPaint* paint) :
+    PLSPathDraw(pixelBounds,
+                matrix,
+                ref_rcp(prototype.m_pathRef),
+                prototype.m_fillRule,
+                paint,
+                Type::midpointFanPath,
+                context->frameInterlockMode()),
+    m_parametricPrecision(prototype.m_parametricPrecision),
+    m_polarPrecision(prototype.m_polarPrecision)
+{
+    assert(isStroked() == prototype.isStroked());
+    assert(m_strokeRadius == prototype.m_strokeRadius);
+    // Chop and tessellate exactly like the prototype did. Its scale is at least as large as ours,
+    // so it has enough tessellation segments for this instance too.
+    m_strokeMatrixMaxScale = prototype.m_strokeMatrixMaxScale;
+    m_strokeJoin = prototype.m_strokeJoin;
+    m_strokeCap = prototype.m_strokeCap;
+    referenceAnalysis(prototype);
+}
+
+void MidpointFanPathDraw::referenceAnalysis(const MidpointFanPathDraw& prototype)
+{
+    // The analysis is read-only once it's built and lives in the per-frame allocators, so other
+    // draws can reference the prototype's directly. (Copies of a FixedQueue pop independently.)
+    m_contours = prototype.m_contours;
+    m_numChops = prototype.m_numChops;
+    m_chopVertices = prototype.m_chopVertices;
+    m_tangentPairs = prototype.m_tangentPairs;
+    m_polarSegmentCounts = prototype.m_polarSegmentCounts;
+    m_parametricSegmentCounts = prototype.m_parametricSegmentCounts;
+    setPathCounts(prototype.m_contourCount, prototype.m_pathCounts);
+}
+
+bool MidpointFanPathDraw::matchesRetainedData(const RetainedMidpointFanData& data) const
+{
+    const float matrix2x2[4] = {m_matrix.xx(), m_matrix.xy(), m_matrix.yx(), m_matrix.yy()};
+    // Bit-compare the matrix because we don't want the special equality rules for NaN.
+    if (memcmp(data.matrix2x2, matrix2x2, sizeof(matrix2x2)) != 0 ||
+        data.strokeRadius != m_strokeRadius || data.parametricPrecision != m_parametricPrecision)
+    {
+        return false;
+    }
+    return !isStroked() || (data.strokeJoin == m_strokeJoin && data.strokeCap == m_strokeCap);
+}
+
+void MidpointFanPathDraw::rekeyRetainedData(RetainedMidpointFanData* data) const
+{
+    data->matrix2x2[0] = m_matrix.xx();
+    data->matrix2x2[1] = m_matrix.xy();
+    data->matrix2x2[2] = m_matrix.yx();
+    data->matrix2x2[3] = m_matrix.yy();
+    data->strokeRadius = m_strokeRadius;
+    data->parametricPrecision = m_parametricPrecision;
+    if (isStroked())
+    {
+        data->strokeJoin = m_strokeJoin;
+        data->strokeCap = m_strokeCap;
+    }
+    data->hasData = false;
+    data->framePrototype = nullptr;
+}
+
+void MidpointFanPathDraw::restoreFromRetainedData(PLSRenderContext::DrawAllocators* allocators,
+                                                  const RetainedMidpointFanData& data,
+                                                  size_t contourCount)
+{
+    assert(data.hasData);
+    assert(data.contours.size() == contourCount);
+    const PathCounts& pathCounts = data.counts;
+    std::copy(data.contours.begin(), data.contours.end(), m_contours);
+    if (isStroked())
+    {
+        m_numChops.reset(allocators->numChopsAllocator(), data.numChops.size());
+        std::copy(data.numChops.begin(),
+                  data.numChops.end(),
+                  m_numChops.push_back_n(data.numChops.size()));
+        m_chopVertices.reset(allocators->chopVerticesAllocator(), data.chopVertices.size());
+        std::copy(data.chopVertices.begin(),
+                  data.chopVertices.end(),
+                  m_chopVertices.push_back_n(data.chopVertices.size()));
+        m_tangentPairs = allocators->tangentPairsAllocator().alloc(pathCounts.paddedRotationCount);
+        std::copy(data.tangentPairs.begin(), data.tangentPairs.end(), m_tangentPairs);
+        m_polarSegmentCounts =
+            allocators->polarSegmentCountsAllocator().alloc(pathCounts.paddedRotationCount);
+        std::copy(data.polarSegmentCounts.begin(),
+                  data.polarSegmentCounts.end(),
+                  m_polarSegmentCounts);
+    }
+    m_parametricSegmentCounts =
+        allocators->parametricSegmentCountsAllocator().alloc(pathCounts.paddedCurveCount);
+    std::copy(data.parametricSegmentCounts.begin(),
+              data.parametricSegmentCounts.end(),
+              m_parametricSegmentCounts);
+    setPathCounts(contourCount, pathCounts);
+}
+
+void MidpointFanPathDraw::saveToRetainedData(RetainedMidpointFanData* data,
+                                             size_t contourCount,
+                                             const PathCounts& pathCounts) const
+{
+    assert(matchesRetainedData(*data));
+    data->contours.assign(m_contours, m_contours + contourCount);
+    if (isStroked())
+    {
+        data->numChops.assign(m_numChops.pushedData(),
+                              m_numChops.pushedData() + m_numChops.pushCount());
+        data->chopVertices.assign(m_chopVertices.pushedData(),
+                                  m_chopVertices.pushedData() + m_chopVertices.pushCount());
+        data->tangentPairs.assign(m_tangentPairs,
+                                  m_tangentPairs + pathCounts.paddedRotationCount);
+        data->polarSegmentCounts.assign(m_polarSegmentCounts,
+                                        m_polarSegmentCounts + pathCounts.paddedRotationCount);
+    }
+    else
+    {
+        data->numChops.clear();
+        data->chopVertices.clear();
+        data->tangentPairs.clear();
+        data->polarSegmentCounts.clear();
+    }
+    data->parametricSegmentCounts.assign(m_parametricSegmentCounts,
+                                         m_parametricSegmentCounts + pathCounts.paddedCurveCount);
+    data->counts = pathCounts;
+    data->hasData = true;
+}
+
+void MidpointFanPathDraw::setPathCounts(size_t contourCount, const PathCounts& pathCounts)
+{
+    m_contourCount = contourCount;
+    m_pathCounts = pathCounts;
+    RIVE_DEBUG_CODE(m_pendingLineCount = pathCounts.lineCount);
+    RIVE_DEBUG_CODE(m_pendingCurveCount = pathCounts.unpaddedCurveCount);
+    RIVE_DEBUG_CODE(m_pendingRotationCount = pathCounts.unpaddedRotationCount);
+    RIVE_DEBUG_CODE(m_pendingEmptyStrokeCountForCaps = pathCounts.emptyStrokeCountForCaps);
+
+    if (pathCounts.tessVertexCount > 0)
     {
         m_resourceCounts.pathCount = 1;
         m_resourceCounts.contourCount = contourCount;
         // maxTessellatedSegmentCount does not get doubled when we emit both forward and mirrored
         // contours because the forward and mirrored pair both get packed into a single
         // pls::TessVertexSpan.
-        m_resourceCounts.maxTessellatedSegmentCount =
-            lineCount + unpaddedCurveCount + emptyStrokeCountForCaps;
+        m_resourceCounts.maxTessellatedSegmentCount = pathCounts.lineCount +
+                                                      pathCounts.unpaddedCurveCount +
+                                                      pathCounts.emptyStrokeCountForCaps;
         m_resourceCounts.midpointFanTessVertexCount =
-            m_contourDirections == pls::ContourDirections::reverseAndForward ? tessVertexCount * 2
-                                                                             : tessVertexCount;
+            m_contourDirections == pls::ContourDirections::reverseAndForward
+                ? pathCounts.tessVertexCount * 2
+                : pathCounts.tessVertexCount;
     }
 }
 
+bool MidpointFanPathDraw::hashContent(DrawStreamHash* hash) const
+{
+    if (isStroked())
+    {
+        hash->write(m_strokeJoin).write(m_strokeCap);
+    }
+    return PLSPathDraw::hashContent(hash);
+}
+
 void MidpointFanPathDraw::onPushToRenderContext(PLSRenderContext::LogicalFlush* flush)
 {
     const RawPath& rawPath = m_pathRef->getRawPath();
@@ -1156,7 +1950,8 @@ void MidpointFanPathDraw::onPushToRenderContext(PLSRenderContext::LogicalFlush*
                                                     localChopBuffer,
                                                     &m_chopVertices.pop_front().x,
                                                     chopKey >> 1,
-                                                    m_strokeMatrixMaxScale);
+                                                    m_strokeMatrixMaxScale,
+                                                    m_polarPrecision);
                             p = localChopBuffer;
                             // The bottom bit of chopKey is 1, meaning "areCusps". Clearing the
                             // bottom bit leaves "numChops * 2", which is the number of chops a cusp
@@ -1338,29 +2133,176 @@ void MidpointFanPathDraw::pushEmulatedStrokeCapAsJoinBeforeCubic(
     RIVE_DEBUG_CODE(--m_pendingEmptyStrokeCountForCaps;)
 }
 
-InteriorTriangulationDraw::InteriorTriangulationDraw(PLSRenderContext* context,
-                                                     IAABB pixelBounds,
-                                                     const Mat2D& matrix,
-                                                     rcp<const PLSPath> path,
-                                                     FillRule fillRule,
-                                                     const PLSPaint* paint,
-                                                     RawPath* scratchPath,
-                                                     TriangulatorAxis triangulatorAxis) :
+InteriorTriangulationDraw::InteriorTriangulationDraw(
+    PLSRenderContext* context,
+    PLSRenderContext::DrawAllocators* allocators,
+    IAABB pixelBounds,
+    const Mat2D& matrix,
+    rcp<const PLSPath> path,
+    FillRule fillRule,
+    const PLSPaint* paint,
+    RawPath* scratchPath,
+    TriangulatorAxis triangulatorAxis,
+    RetainedInteriorTriangulationData* retainedData) :
     PLSPathDraw(pixelBounds,
                 matrix,
                 std::move(path),
                 fillRule,
                 paint,
                 Type::interiorTriangulationPath,
-                context->frameInterlockMode())
+                context->frameInterlockMode()),
+    m_triangulatorAxis(triangulatorAxis),
+    m_parametricPrecision(context->frameParametricPrecision()),
+    m_usesStencilThenCover(context->frameInterlockMode() == pls::InterlockMode::depthStencil)
 {
     assert(!isStroked());
     assert(m_strokeRadius == 0);
+    if (retainedData != nullptr)
+    {
+        if (!matchesRetainedData(*retainedData))
+        {
+            // Don't save the triangulation until we've seen the same draw twice in a row. This
+            // avoids the overhead of saving content that is animating.
+            rekeyRetainedData(retainedData);
+            retainedData = nullptr;
+        }
+        else if (retainedData->triangulation != nullptr)
+        {
+            m_retainedTriangulation = safe_ref(retainedData->triangulation.get());
+            m_contourCount = m_retainedTriangulation->contourCount;
+            m_outerCubicPatchCount = m_retainedTriangulation->outerCubicPatchCount;
+            countTriangulatedResources();
+            return;
+        }
+    }
+    m_retainedDataToSave = retainedData;
+    // Triangulating a big shape can take milliseconds. When the draw is built on the context's
+    // thread, triangulate in the background and join once the draw gets pushed. (Recording threads
+    // are already off the context's thread, so they just triangulate inline.)
+    if (allocators == &context->drawAllocators())
+    {
+        m_asyncTriangulator = context->asyncTriangulator();
+    }
     processPath(PathOp::countDataAndTriangulate,
-                &context->perFrameAllocator(),
+                &allocators->perFrameAllocator(),
                 scratchPath,
                 triangulatorAxis,
                 nullptr);
+    if (m_asyncTriangulations == nullptr)
+    {
+        saveToRetainedData();
+    }
+}
+
+void InteriorTriangulationDraw::joinTriangulation()
+{
+    if (m_asyncTriangulations != nullptr)
+    {
+        for (size_t i = 0; i < m_triangulationBandCount; ++i)
+        {
+            m_asyncTriangulator->waitForJob(m_asyncTriangulations[i]);
+            m_triangulators[i] = m_asyncTriangulations[i]->triangulator;
+        }
+        m_asyncTriangulations = nullptr;
+        countTriangulatedResources();
+        saveToRetainedData();
+    }
+}
+
+size_t InteriorTriangulationDraw::pushInteriorTriangles(
+    pls::WriteOnlyMappedMemory<pls::TriangleVertex>* triangleVertexData,
+    uint16_t pathID) const
+{
+    assert(m_asyncTriangulations == nullptr);
+    if (m_retainedTriangulation != nullptr)
+    {
+        const pls::TriangleVertex* triangles = m_retainedTriangulation->triangles.get();
+        for (size_t i = 0; i < m_retainedTriangulation->triangleVertexCount; ++i)
+        {
+            triangleVertexData->emplace_back(triangles[i], pathID);
+        }
+        return m_retainedTriangulation->triangleVertexCount;
+    }
+    size_t vertexCount = 0;
+    for (size_t i = 0; i < m_triangulationBandCount; ++i)
+    {
+        vertexCount += m_triangulators[i]->polysToTriangles(triangleVertexData, pathID);
+    }
+    return vertexCount;
+}
+
+bool InteriorTriangulationDraw::matchesRetainedData(
+    const RetainedInteriorTriangulationData& data) const
+{
+    const float matrix2x2[4] = {m_matrix.xx(), m_matrix.xy(), m_matrix.yx(), m_matrix.yy()};
+    // Bit-compare the matrix because we don't want the special equality rules for NaN.
+    return memcmp(data.matrix2x2, matrix2x2, sizeof(matrix2x2)) == 0 &&
+           data.parametricPrecision == m_parametricPrecision && data.fillRule == m_fillRule &&
+           data.triangulatorAxis == m_triangulatorAxis &&
+           data.usesStencilThenCover == m_usesStencilThenCover;
+}
+
+void InteriorTriangulationDraw::rekeyRetainedData(RetainedInteriorTriangulationData* data) const
+{
+    data->matrix2x2[0] = m_matrix.xx();
+    data->matrix2x2[1] = m_matrix.xy();
+    data->matrix2x2[2] = m_matrix.yx();
+    data->matrix2x2[3] = m_matrix.yy();
+    data->parametricPrecision = m_parametricPrecision;
+    data->fillRule = m_fillRule;
+    data->triangulatorAxis = m_triangulatorAxis;
+    data->usesStencilThenCover = m_usesStencilThenCover;
+    data->triangulation = nullptr;
+}
+
+void InteriorTriangulationDraw::saveToRetainedData()
+{
+    assert(m_triangulators != nullptr);
+    RetainedInteriorTriangulationData* data = m_retainedDataToSave;
+    m_retainedDataToSave = nullptr;
+    // Another draw of the same path may have rekeyed or filled in the data since we were built.
+    if (data == nullptr || !matchesRetainedData(*data) || data->triangulation != nullptr)
+    {
+        return;
+    }
+    auto triangulation = make_rcp<RetainedTriangulation>();
+    size_t maxVertexCount = 0;
+    for (size_t i = 0; i < m_triangulationBandCount; ++i)
+    {
+        maxVertexCount += m_triangulators[i]->maxVertexCount();
+    }
+    triangulation->triangles.reset(new pls::TriangleVertex[maxVertexCount]);
+    pls::WriteOnlyMappedMemory<pls::TriangleVertex> triangleWriter(
+        triangulation->triangles.get(),
+        maxVertexCount);
+    for (size_t i = 0; i < m_triangulationBandCount; ++i)
+    {
+        const GrInnerFanTriangulator* triangulator = m_triangulators[i];
+        triangulation->triangleVertexCount += triangulator->polysToTriangles(&triangleWriter, 0);
+        for (auto* node = triangulator->groutList().head(); node; node = node->fNext)
+        {
+            triangulation->groutTriangles.push_back(
+                {node->fPts[0], node->fPts[1], node->fPts[2]});
+        }
+    }
+    triangulation->contourCount = m_contourCount;
+    triangulation->outerCubicPatchCount = m_outerCubicPatchCount;
+    data->triangulation = std::move(triangulation);
+}
+
+const AABB& InteriorTriangulationDraw::coverBounds() const
+{
+    assert(m_usesStencilThenCover);
+    // Every outer curve and interior triangle lies within the bounds of the path's points.
+    return m_pathRef->getBounds();
+}
+
+void InteriorTriangulationDraw::releaseRefs()
+{
+    // The background thread may still be reading from our path.
+    joinTriangulation();
+    safe_unref(m_retainedTriangulation);
+    PLSPathDraw::releaseRefs();
 }
 
 void InteriorTriangulationDraw::onPushToRenderContext(PLSRenderContext::LogicalFlush* flush)
@@ -1440,7 +2382,8 @@ void InteriorTriangulationDraw::processPath(PathOp op,
                 RIVE_UNREACHABLE();
             case PathVerb::cubic:
             {
-                size_t numSubdivisions = FindSubdivisionCount(pts, vectorXform);
+                size_t numSubdivisions =
+                    FindSubdivisionCount(pts, m_parametricPrecision, vectorXform);
                 if (numSubdivisions == 1)
                 {
                     if (op == PathOp::countDataAndTriangulate)
@@ -1505,43 +2448,15 @@ void InteriorTriangulationDraw::processPath(PathOp op,
 
     if (op == PathOp::countDataAndTriangulate)
     {
-        assert(m_triangulator == nullptr);
-        assert(triangulatorAxis != TriangulatorAxis::dontCare);
-        m_triangulator = allocator->make<GrInnerFanTriangulator>(
-            *scratchPath,
-            m_matrix,
-            triangulatorAxis == TriangulatorAxis::horizontal
-                ? GrTriangulator::Comparator::Direction::kHorizontal
-                : GrTriangulator::Comparator::Direction::kVertical,
-            m_fillRule,
-            allocator);
-        // We also draw each "grout" triangle using an outerCubic patch.
-        patchCount += m_triangulator->groutList().count();
-
-        if (patchCount > 0)
-        {
-            m_resourceCounts.pathCount = 1;
-            m_resourceCounts.contourCount = contourCount;
-            // maxTessellatedSegmentCount does not get doubled when we emit both forward and
-            // mirrored contours because the forward and mirrored pair both get packed into a single
-            // pls::TessVertexSpan.
-            m_resourceCounts.maxTessellatedSegmentCount = patchCount;
-            // outerCubic patches emit their tessellated geometry twice: once forward and once
-            // mirrored.
-            m_resourceCounts.outerCubicTessVertexCount =
-                m_contourDirections == pls::ContourDirections::reverseAndForward
-                    ? patchCount * kOuterCurvePatchSegmentSpan * 2
-                    : patchCount * kOuterCurvePatchSegmentSpan;
-            m_resourceCounts.maxTriangleVertexCount = m_triangulator->maxVertexCount();
-        }
+        m_contourCount = contourCount;
+        m_outerCubicPatchCount = patchCount;
+        triangulateInterior(allocator, *scratchPath, triangulatorAxis);
     }
     else
     {
-        assert(m_triangulator != nullptr);
         // Submit grout triangles, retrofitted into outerCubic patches.
-        for (auto* node = m_triangulator->groutList().head(); node; node = node->fNext)
-        {
-            Vec2D triangleAsCubic[4] = {node->fPts[0], node->fPts[1], {0, 0}, node->fPts[2]};
+        auto pushGroutTriangle = [flush, &patchCount](const Vec2D* pts) {
+            Vec2D triangleAsCubic[4] = {pts[0], pts[1], {0, 0}, pts[2]};
             flush->pushCubic(triangleAsCubic,
                              {0, 0},
                              RETROFITTED_TRIANGLE_CONTOUR_FLAG,
@@ -1549,6 +2464,24 @@ void InteriorTriangulationDraw::processPath(PathOp op,
                              1,
                              kJoinSegmentCount);
             ++patchCount;
+        };
+        if (m_retainedTriangulation != nullptr)
+        {
+            for (const std::array<Vec2D, 3>& triangle : m_retainedTriangulation->groutTriangles)
+            {
+                pushGroutTriangle(triangle.data());
+            }
+        }
+        else
+        {
+            assert(m_triangulators != nullptr);
+            for (size_t i = 0; i < m_triangulationBandCount; ++i)
+            {
+                for (auto* node = m_triangulators[i]->groutList().head(); node; node = node->fNext)
+                {
+                    pushGroutTriangle(node->fPts);
+                }
+            }
         }
         assert(contourCount == m_resourceCounts.contourCount);
         assert(patchCount == m_resourceCounts.maxTessellatedSegmentCount);
@@ -1559,13 +2492,151 @@ void InteriorTriangulationDraw::processPath(PathOp op,
     }
 }
 
+void InteriorTriangulationDraw::triangulateInterior(TrivialBlockAllocator* allocator,
+                                                    const RawPath& interiorPolygon,
+                                                    TriangulatorAxis triangulatorAxis)
+{
+    assert(m_triangulators == nullptr);
+    assert(triangulatorAxis != TriangulatorAxis::dontCare);
+    GrTriangulator::Comparator::Direction direction =
+        triangulatorAxis == TriangulatorAxis::horizontal
+            ? GrTriangulator::Comparator::Direction::kHorizontal
+            : GrTriangulator::Comparator::Direction::kVertical;
+
+    // Split huge interiors into equal-width bands across the triangulator's sweep axis. The bands
+    // only change how the interior polygon gets triangulated: the outer curve patches still attach
+    // to the same chords, because the bands' union is the original polygon.
+    size_t bandCount = 1;
+    if (m_pathRef->getRawPath().verbs().count() >= kMinBandedTriangulationVerbCount)
+    {
+        bandCount = std::clamp<size_t>(
+            (interiorPolygon.points().size() + kTriangulationBandVertexCount - 1) /
+                kTriangulationBandVertexCount,
+            1,
+            kMaxTriangulationBandCount);
+    }
+    int axis = triangulatorAxis == TriangulatorAxis::horizontal ? 0 : 1;
+    const AABB& localBounds = m_pathRef->getBounds();
+    float axisMin = axis == 0 ? localBounds.minX : localBounds.minY;
+    float axisMax = axis == 0 ? localBounds.maxX : localBounds.maxY;
+    auto bandBoundary = [=](size_t k) {
+        if (k == 0)
+        {
+            return -std::numeric_limits<float>::infinity();
+        }
+        if (k == bandCount)
+        {
+            return std::numeric_limits<float>::infinity();
+        }
+        return axisMin + (axisMax - axisMin) * k / bandCount;
+    };
+
+    m_triangulators = static_cast<GrInnerFanTriangulator**>(
+        allocator->alloc(sizeof(GrInnerFanTriangulator*) * bandCount));
+    if (m_asyncTriangulator != nullptr)
+    {
+        m_asyncTriangulations = static_cast<AsyncTriangulationJob**>(
+            allocator->alloc(sizeof(AsyncTriangulationJob*) * bandCount));
+    }
+    m_triangulationBandCount = 0;
+    RawPath bandPolygon;
+    for (size_t i = 0; i < bandCount; ++i)
+    {
+        const RawPath* polygon = &interiorPolygon;
+        if (bandCount > 1)
+        {
+            clip_polygon_to_band(interiorPolygon,
+                                 axis,
+                                 bandBoundary(i),
+                                 bandBoundary(i + 1),
+                                 &bandPolygon);
+            if (bandPolygon.empty())
+            {
+                continue;
+            }
+            polygon = &bandPolygon;
+        }
+        size_t bandIdx = m_triangulationBandCount++;
+        m_triangulators[bandIdx] = nullptr;
+        if (m_asyncTriangulator != nullptr)
+        {
+            AsyncTriangulationJob* job = m_asyncTriangulator->makeJob();
+            job->path = *polygon;
+            job->matrix = m_matrix;
+            job->direction = direction;
+            job->fillRule = m_fillRule;
+            job->emitUnitWindingTriangles = m_usesStencilThenCover;
+            m_asyncTriangulator->pushJob(job);
+            m_asyncTriangulations[bandIdx] = job;
+        }
+        else
+        {
+            m_triangulators[bandIdx] =
+                allocator->make<GrInnerFanTriangulator>(*polygon,
+                                                        m_matrix,
+                                                        direction,
+                                                        m_fillRule,
+                                                        m_usesStencilThenCover,
+                                                        allocator);
+        }
+    }
+    if (m_asyncTriangulator == nullptr)
+    {
+        countTriangulatedResources();
+    }
+}
+
+void InteriorTriangulationDraw::countTriangulatedResources()
+{
+    assert(m_triangulators != nullptr || m_retainedTriangulation != nullptr);
+    size_t groutTriangleCount = 0;
+    size_t maxTriangleVertexCount = 0;
+    if (m_retainedTriangulation != nullptr)
+    {
+        groutTriangleCount = m_retainedTriangulation->groutTriangles.size();
+        maxTriangleVertexCount = m_retainedTriangulation->triangleVertexCount;
+    }
+    else
+    {
+        for (size_t i = 0; i < m_triangulationBandCount; ++i)
+        {
+            groutTriangleCount += m_triangulators[i]->groutList().count();
+            maxTriangleVertexCount += m_triangulators[i]->maxVertexCount();
+        }
+    }
+    // We also draw each "grout" triangle using an outerCubic patch.
+    size_t patchCount = m_outerCubicPatchCount + groutTriangleCount;
+    if (patchCount > 0)
+    {
+        m_resourceCounts.pathCount = 1;
+        m_resourceCounts.contourCount = m_contourCount;
+        // maxTessellatedSegmentCount does not get doubled when we emit both forward and mirrored
+        // contours because the forward and mirrored pair both get packed into a single
+        // pls::TessVertexSpan.
+        m_resourceCounts.maxTessellatedSegmentCount = patchCount;
+        // outerCubic patches emit their tessellated geometry twice: once forward and once
+        // mirrored.
+        m_resourceCounts.outerCubicTessVertexCount =
+            m_contourDirections == pls::ContourDirections::reverseAndForward
+                ? patchCount * kOuterCurvePatchSegmentSpan * 2
+                : patchCount * kOuterCurvePatchSegmentSpan;
+        m_resourceCounts.maxTriangleVertexCount = maxTriangleVertexCount;
+        if (m_usesStencilThenCover)
+        {
+            m_resourceCounts.maxTriangleVertexCount += pls::kStencilCoverVertexCount;
+        }
+    }
+}
+
 ImageRectDraw::ImageRectDraw(PLSRenderContext* context,
                              IAABB pixelBounds,
                              const Mat2D& matrix,
                              BlendMode blendMode,
                              rcp<const PLSTexture> imageTexture,
+                             const AABB& texCoordBounds,
                              float opacity) :
     PLSDraw(pixelBounds, matrix, blendMode, std::move(imageTexture), Type::imageRect),
+    m_texCoordBounds(texCoordBounds),
     m_opacity(opacity)
 {
     // If we support image paints for paths, the client should draw a rectangular path with an
@@ -1579,16 +2650,53 @@ void ImageRectDraw::pushToRenderContext(PLSRenderContext::LogicalFlush* flush)
     flush->pushImageRect(this);
 }
 
+bool SolidRectDraw::FrameSupports(const PLSRenderContext* context)
+{
+    // imageRects are only drawn in atomic mode without bindless textures, which is exactly when
+    // the frame doesn't support image paints for paths.
+    return !context->frameSupportsImagePaintForPaths();
+}
+
+SolidRectDraw::SolidRectDraw(PLSRenderContext* context,
+                             IAABB pixelBounds,
+                             const Mat2D& matrix,
+                             BlendMode blendMode,
+                             ColorInt color) :
+    PLSDraw(pixelBounds, matrix, blendMode, nullptr, Type::solidRect)
+{
+    assert(FrameSupports(context));
+    m_simplePaintValue.color = color;
+    if (m_blendMode == BlendMode::srcOver && colorAlpha(color) == 0xff)
+    {
+        m_drawContents |= pls::DrawContents::opaquePaint;
+        m_occluderBounds = find_rect_occluder_bounds(matrix, AABB{0, 0, 1, 1});
+    }
+    m_resourceCounts.imageDrawCount = 1;
+}
+
+void SolidRectDraw::pushToRenderContext(PLSRenderContext::LogicalFlush* flush)
+{
+    flush->pushSolidRect(this);
+}
+
+bool ImageRectDraw::hashContent(DrawStreamHash* hash) const
+{
+    hash->write(m_texCoordBounds).write(m_opacity);
+    return PLSDraw::hashContent(hash);
+}
+
 ImageMeshDraw::ImageMeshDraw(IAABB pixelBounds,
                              const Mat2D& matrix,
                              BlendMode blendMode,
                              rcp<const PLSTexture> imageTexture,
+                             const AABB& texCoordBounds,
                              rcp<const RenderBuffer> vertexBuffer,
                              rcp<const RenderBuffer> uvBuffer,
                              rcp<const RenderBuffer> indexBuffer,
                              uint32_t indexCount,
                              float opacity) :
     PLSDraw(pixelBounds, matrix, blendMode, std::move(imageTexture), Type::imageMesh),
+    m_texCoordBounds(texCoordBounds),
     m_vertexBufferRef(vertexBuffer.release()),
     m_uvBufferRef(uvBuffer.release()),
     m_indexBufferRef(indexBuffer.release()),
@@ -1636,6 +2744,12 @@ StencilClipReset::StencilClipReset(PLSRenderContext* context,
     m_resourceCounts.maxTriangleVertexCount = 6;
 }
 
+bool StencilClipReset::hashContent(DrawStreamHash* hash) const
+{
+    hash->write(m_previousClipID);
+    return PLSDraw::hashContent(hash);
+}
+
 void StencilClipReset::pushToRenderContext(PLSRenderContext::LogicalFlush* flush)
 {
     flush->pushStencilClipReset(this);
@@ -4,6 +4,10 @@
 
 #include "rive/pls/pls_image.hpp"
 
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
 namespace rive::pls
 {
 PLSTexture::PLSTexture(uint32_t width, uint32_t height) : m_width(width), m_height(height)
@@ -11,4 +15,130 @@ PLSTexture::PLSTexture(uint32_t width, uint32_t height) : m_width(width), m_heig
     static std::atomic_uint32_t textureResourceHashCounter = 0;
     m_textureResourceHash = ++textureResourceHashCounter;
 }
+
+PLSImageAtlasPage::PLSImageAtlasPage() : m_pixels(size_t(kSize) * kSize * 4) {}
+
+bool PLSImageAtlasPage::addImage(uint32_t width,
+                                 uint32_t height,
+                                 const uint8_t imageDataRGBA[],
+                                 AABB* texCoordBounds)
+{
+    assert(width > 0 && height > 0);
+    if (isFrozen() || width > kMaxImageSize || height > kMaxImageSize)
+    {
+        return false;
+    }
+    uint32_t paddedWidth = width + kPadding * 2;
+    uint32_t paddedHeight = height + kPadding * 2;
+
+    // Shelf packing: use the first shelf that's tall enough without wasting more than half the
+    // image's height, otherwise open a new shelf at the bottom.
+    Shelf* shelf = nullptr;
+    for (Shelf& candidate : m_shelves)
+    {
+        if (candidate.height >= paddedHeight && candidate.height <= paddedHeight * 3 / 2 &&
+            candidate.width + paddedWidth <= kSize)
+        {
+            shelf = &candidate;
+            break;
+        }
+    }
+    if (shelf == nullptr)
+    {
+        if (m_shelvesHeight + paddedHeight > kSize)
+        {
+            return false;
+        }
+        m_shelves.push_back({m_shelvesHeight, paddedHeight, 0});
+        shelf = &m_shelves.back();
+        m_shelvesHeight += paddedHeight;
+    }
+    uint32_t x = shelf->width;
+    uint32_t y = shelf->y;
+    shelf->width += paddedWidth;
+
+    // Copy the image in, replicating its edge pixels out into the padding.
+    for (uint32_t row = 0; row < paddedHeight; ++row)
+    {
+        int32_t srcRow = std::clamp<int32_t>(static_cast<int32_t>(row) - kPadding, 0, height - 1);
+        const uint8_t* src = imageDataRGBA + size_t(srcRow) * width * 4;
+        uint8_t* dst = m_pixels.data() + (size_t(y + row) * kSize + x) * 4;
+        for (uint32_t i = 0; i < kPadding; ++i, dst += 4)
+        {
+            memcpy(dst, src, 4);
+        }
+        memcpy(dst, src, size_t(width) * 4);
+        dst += size_t(width) * 4;
+        for (uint32_t i = 0; i < kPadding; ++i, dst += 4)
+        {
+            memcpy(dst, src + size_t(width - 1) * 4, 4);
+        }
+    }
+
+    constexpr static float kInvSize = 1.f / kSize;
+    *texCoordBounds = AABB(static_cast<float>(x + kPadding) * kInvSize,
+                           static_cast<float>(y + kPadding) * kInvSize,
+                           static_cast<float>(x + kPadding + width) * kInvSize,
+                           static_cast<float>(y + kPadding + height) * kInvSize);
+    return true;
+}
+
+const PLSTexture* PLSImageAtlasPage::texture(PLSRenderContextImpl* impl)
+{
+    if (m_texture == nullptr)
+    {
+        m_texture = impl->makeImageTexture(kSize, kSize, kMipLevelCount, m_pixels.data());
+        if (m_texture != nullptr)
+        {
+            m_pixels = {};
+            m_shelves = {};
+        }
+    }
+    return m_texture.get();
+}
+
+PLSImageStreamingState::PLSImageStreamingState(uint32_t width,
+                                               uint32_t height,
+                                               std::vector<uint8_t> encodedBytes,
+                                               rcp<PLSTexture> thumbnailTexture,
+                                               uint32_t thumbnailLevel) :
+    m_width(width),
+    m_height(height),
+    m_encodedBytes(std::move(encodedBytes)),
+    m_thumbnailTexture(std::move(thumbnailTexture)),
+    m_thumbnailLevel(thumbnailLevel),
+    m_requestedLevel(thumbnailLevel + 1)
+{}
+
+size_t PLSImageStreamingState::detailSizeInBytes() const
+{
+    if (m_detailTexture == nullptr)
+    {
+        return 0;
+    }
+    // Add a third for the mipmaps.
+    size_t levelSize = size_t(m_detailTexture->width()) * m_detailTexture->height() * 4;
+    return levelSize + levelSize / 3;
+}
+
+void PLSImageStreamingState::noteDraw(float pixelsPerTexel)
+{
+    // Pick the level whose texels cover at least one pixel each. Pixels per texel doubles with
+    // every level.
+    uint32_t level = 0;
+    if (pixelsPerTexel > 0 && pixelsPerTexel < 1)
+    {
+        level = std::min(static_cast<uint32_t>(-log2f(pixelsPerTexel)), m_thumbnailLevel);
+    }
+    else if (!(pixelsPerTexel > 0))
+    {
+        level = m_thumbnailLevel; // Degenerate matrix.
+    }
+    uint32_t requestedLevel = m_requestedLevel.load(std::memory_order_relaxed);
+    while (level < requestedLevel &&
+           !m_requestedLevel.compare_exchange_weak(requestedLevel,
+                                                   level,
+                                                   std::memory_order_relaxed))
+    {}
+}
 } // namespace rive::pls
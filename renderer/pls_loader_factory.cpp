@@ -0,0 +1,155 @@
+/*
+ * Copyright 2024 Rive
+ */
+
+#include "pls_loader_factory.hpp"
+
+#include "async_image_decoder.hpp"
+#include "ktx2.hpp"
+#include "rive/math/math_types.hpp"
+#include "rive/pls/pls_render_context.hpp"
+#include "rive/pls/pls_render_context_impl.hpp"
+#include "rive/pls/pls_trace.hpp"
+
+#include <string.h>
+
+namespace rive::pls
+{
+bool PLSDeferredRenderBuffer::createBackendBuffer(PLSRenderContext* context)
+{
+    if (m_backendBuffer == nullptr)
+    {
+        m_backendBuffer = context->makeRenderBuffer(type(), flags(), sizeInBytes());
+    }
+    return m_backendBuffer != nullptr;
+}
+
+rcp<RenderBuffer> PLSDeferredRenderBuffer::resolve(PLSRenderContext* context)
+{
+    if (!createBackendBuffer(context))
+    {
+        return nullptr;
+    }
+    std::lock_guard lock(m_stagingMutex);
+    if (m_stagingGeneration != m_uploadedGeneration)
+    {
+        assert(m_stagingData != nullptr);
+        context->waitForPendingSubmission();
+        memcpy(m_backendBuffer->map(), m_stagingData.get(), sizeInBytes());
+        m_backendBuffer->unmap();
+        m_uploadedGeneration = m_stagingGeneration;
+        if (flags() & RenderBufferFlags::mappedOnceAtInitialization)
+        {
+            // The contents can't change anymore.
+            m_stagingData.reset();
+        }
+    }
+    return m_backendBuffer;
+}
+
+rcp<RenderBuffer> PLSLoaderFactory::makeRenderBuffer(RenderBufferType type,
+                                                     RenderBufferFlags flags,
+                                                     size_t sizeInBytes)
+{
+    auto buffer = make_rcp<PLSDeferredRenderBuffer>(type, flags, sizeInBytes);
+    std::lock_guard lock(m_mutex);
+    m_pendingBuffers.push_back(buffer);
+    return buffer;
+}
+
+rcp<RenderImage> PLSLoaderFactory::decodeImage(Span<const uint8_t> encodedBytes)
+{
+    PendingImage pending;
+    uint32_t width, height;
+    if (IsKTX2(encodedBytes))
+    {
+        KTX2Image ktx2;
+        if (!ParseKTX2(encodedBytes, &ktx2) ||
+            !m_platformFeatures.supportsCompressedTextureFormat(ktx2.format) || ktx2.width == 0 ||
+            ktx2.height == 0 || ktx2.mipLevelCount == 0 ||
+            ktx2.mipLevelCount > static_cast<uint32_t>(math::msb(ktx2.height | ktx2.width)))
+        {
+            return nullptr;
+        }
+        width = ktx2.width;
+        height = ktx2.height;
+        pending.mipLevelCount = ktx2.mipLevelCount;
+        pending.isCompressed = true;
+        pending.compressedFormat = ktx2.format;
+        pending.data = std::move(ktx2.data);
+    }
+    else
+    {
+        AsyncImageDecodeJob decoded;
+        if (!AsyncImageDecoder::DecodeRGBA(encodedBytes, &decoded))
+        {
+            return nullptr;
+        }
+        width = decoded.width;
+        height = decoded.height;
+        pending.mipLevelCount = math::msb(height | width);
+        pending.isCompressed = false;
+        pending.data = std::move(decoded.rgbaPixels);
+    }
+    // The texture gets attached once it's created on the context's thread.
+    auto image = rcp<PLSImage>(new PLSImage(width, height));
+    pending.image = image;
+    std::lock_guard lock(m_mutex);
+    m_pendingImages.push_back(std::move(pending));
+    return image;
+}
+
+void PLSLoaderFactory::createPendingResources(PLSRenderContext* context)
+{
+    std::vector<rcp<PLSDeferredRenderBuffer>> pendingBuffers;
+    std::vector<PendingImage> pendingImages;
+    {
+        std::lock_guard lock(m_mutex);
+        pendingBuffers.swap(m_pendingBuffers);
+        pendingImages.swap(m_pendingImages);
+    }
+    if (pendingBuffers.empty() && pendingImages.empty())
+    {
+        return;
+    }
+
+    PLS_TRACE_SCOPE("PLSLoaderFactory::createPendingResources");
+    for (const rcp<PLSDeferredRenderBuffer>& buffer : pendingBuffers)
+    {
+        // The loader may still be mapping this buffer. Its contents get uploaded under the staging
+        // mutex once it's actually drawn with.
+        buffer->createBackendBuffer(context);
+    }
+    if (pendingImages.empty())
+    {
+        return;
+    }
+    context->waitForPendingSubmission();
+    PLSRenderContextImpl* impl = context->impl();
+    for (PendingImage& pending : pendingImages)
+    {
+        uint32_t width = pending.image->width();
+        uint32_t height = pending.image->height();
+        rcp<PLSTexture> texture;
+        if (pending.isCompressed)
+        {
+            if (pending.data.size() ==
+                pls::CompressedTextureSizeInBytes(width, height, pending.mipLevelCount))
+            {
+                texture = impl->makeCompressedImageTexture(width,
+                                                           height,
+                                                           pending.mipLevelCount,
+                                                           pending.compressedFormat,
+                                                           pending.data.data());
+            }
+        }
+        else
+        {
+            texture =
+                impl->makeImageTexture(width, height, pending.mipLevelCount, pending.data.data());
+        }
+        // On failure, the image just keeps drawing nothing.
+        pending.image->resetTexture(std::move(texture));
+    }
+}
+} // namespace rive::pls
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2024 Rive
+ */
+
+#pragma once
+
+#include "rive/pls/pls.hpp"
+#include "rive/pls/pls_factory.hpp"
+#include "rive/pls/pls_image.hpp"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace rive::pls
+{
+class PLSRenderContext;
+
+// RenderBuffer from PLSRenderContext::loaderFactory(). It can be created and mapped on any thread
+// because it only stages its contents on the CPU. The backend buffer gets created on the context's
+// thread, and the staged contents get uploaded whenever they have changed since the last draw.
+//
+// The staging mutex is held from map() until unmap(), so the context's thread never copies out
+// contents that are still being written. Only the mapping thread ever calls map() and unmap() on
+// this object; the context's thread only maps the backend buffer.
+class PLSDeferredRenderBuffer : public lite_rtti_override<RenderBuffer, PLSDeferredRenderBuffer>
+{
+public:
+    PLSDeferredRenderBuffer(RenderBufferType renderBufferType,
+                            RenderBufferFlags renderBufferFlags,
+                            size_t sizeInBytes) :
+        lite_rtti_override(renderBufferType, renderBufferFlags, sizeInBytes),
+        m_stagingData(new uint8_t[sizeInBytes])
+    {}
+
+    // Creates the backend buffer if it doesn't exist yet, without touching the staged contents.
+    // Must be called on the context's thread. Returns false if the backend failed to create it.
+    bool createBackendBuffer(PLSRenderContext*);
+
+    // Returns the backend buffer to draw with, first creating it and uploading the most recently
+    // unmapped contents if needed. Must be called on the context's thread. Blocks if the buffer is
+    // currently mapped on another thread. Null if the backend failed to create the buffer.
+    rcp<RenderBuffer> resolve(PLSRenderContext*);
+
+protected:
+    void* onMap() override
+    {
+        m_stagingMutex.lock(); // Released in onUnmap().
+        assert(m_stagingData != nullptr); // mappedOnceAtInitialization buffers only map once.
+        return m_stagingData.get();
+    }
+
+    void onUnmap() override
+    {
+        ++m_stagingGeneration;
+        m_stagingMutex.unlock();
+    }
+
+private:
+    // Guards m_stagingData and m_stagingGeneration.
+    std::mutex m_stagingMutex;
+    std::unique_ptr<uint8_t[]> m_stagingData;
+    uint32_t m_stagingGeneration = 0; // Incremented on every unmap.
+
+    // Only accessed on the context's thread.
+    uint32_t m_uploadedGeneration = 0;
+    rcp<RenderBuffer> m_backendBuffer;
+};
+
+// Factory that can be used from any thread. (See PLSRenderContext::loaderFactory().)
+class PLSLoaderFactory : public PLSFactory
+{
+public:
+    PLSLoaderFactory(const pls::PlatformFeatures& platformFeatures) :
+        m_platformFeatures(platformFeatures)
+    {}
+
+    rcp<RenderBuffer> makeRenderBuffer(RenderBufferType, RenderBufferFlags, size_t) override;
+
+    // Decodes on the calling thread. The returned image draws nothing until its texture gets
+    // created by createPendingResources().
+    rcp<RenderImage> decodeImage(Span<const uint8_t>) override;
+
+    // Creates the backend resources for every buffer and image made since the last call. Must be
+    // called on the context's thread. Buffer contents aren't uploaded here, since the loader may
+    // still be writing them; that happens when a buffer is first drawn with.
+    void createPendingResources(PLSRenderContext*);
+
+private:
+    // Decoded image whose texture hasn't been created yet.
+    struct PendingImage
+    {
+        rcp<PLSImage> image;
+        uint32_t mipLevelCount;
+        bool isCompressed; // If true, 'data' holds every mip level in 'compressedFormat'.
+        pls::CompressedTextureFormat compressedFormat;
+        std::vector<uint8_t> data;
+    };
+
+    const pls::PlatformFeatures& m_platformFeatures;
+
+    std::mutex m_mutex;
+    std::vector<rcp<PLSDeferredRenderBuffer>> m_pendingBuffers;
+    std::vector<PendingImage> m_pendingImages;
+};
+} // namespace rive::pls
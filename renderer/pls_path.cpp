@@ -12,35 +12,67 @@ namespace rive::pls
 {
 PLSPath::PLSPath(FillRule fillRule, RawPath& rawPath)
 {
-    m_rawPath.swap(rawPath);
-    m_rawPath.pruneEmptySegments();
+    setSharedRawPath(make_rcp<SharedRawPath>());
+    m_sharedRawPath->m_rawPath.swap(rawPath);
+    m_sharedRawPath->m_rawPath.pruneEmptySegments();
+}
+
+void PLSPath::setSharedRawPath(rcp<SharedRawPath> sharedRawPath)
+{
+    if (sharedRawPath != nullptr)
+    {
+        sharedRawPath->m_pathCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (m_sharedRawPath != nullptr)
+    {
+        m_sharedRawPath->m_pathCount.fetch_sub(1, std::memory_order_release);
+    }
+    m_sharedRawPath = std::move(sharedRawPath);
+}
+
+RawPath& PLSPath::mutableRawPath()
+{
+    assert(m_rawPathMutationLockCount == 0);
+    if (m_sharedRawPath->isShared())
+    {
+        // Another path references our storage. Copy it before writing.
+        setSharedRawPath(make_rcp<SharedRawPath>(m_sharedRawPath->m_rawPath));
+    }
+    return m_sharedRawPath->m_rawPath;
 }
 
 void PLSPath::rewind()
 {
     assert(m_rawPathMutationLockCount == 0);
-    m_rawPath.rewind();
+    if (m_sharedRawPath->isShared())
+    {
+        // Don't copy data we're about to throw away; just detach from the shared storage.
+        setSharedRawPath(make_rcp<SharedRawPath>());
+    }
+    else
+    {
+        m_sharedRawPath->m_rawPath.rewind();
+    }
     m_dirt = kAllDirt;
 }
 
 void PLSPath::moveTo(float x, float y)
 {
-    assert(m_rawPathMutationLockCount == 0);
-    m_rawPath.moveTo(x, y);
+    mutableRawPath().moveTo(x, y);
     m_dirt = kAllDirt;
 }
 
 void PLSPath::lineTo(float x, float y)
 {
-    assert(m_rawPathMutationLockCount == 0);
+    RawPath& rawPath = mutableRawPath();
 
     // Make sure to start a new contour, even if this line is empty.
-    m_rawPath.injectImplicitMoveIfNeeded();
+    rawPath.injectImplicitMoveIfNeeded();
 
     Vec2D p1 = {x, y};
-    if (m_rawPath.points().back() != p1)
+    if (rawPath.points().back() != p1)
     {
-        m_rawPath.line(p1);
+        rawPath.line(p1);
     }
 
     m_dirt = kAllDirt;
@@ -48,17 +80,17 @@ void PLSPath::lineTo(float x, float y)
 
 void PLSPath::cubicTo(float ox, float oy, float ix, float iy, float x, float y)
 {
-    assert(m_rawPathMutationLockCount == 0);
+    RawPath& rawPath = mutableRawPath();
 
     // Make sure to start a new contour, even if this cubic is empty.
-    m_rawPath.injectImplicitMoveIfNeeded();
+    rawPath.injectImplicitMoveIfNeeded();
 
     Vec2D p1 = {ox, oy};
     Vec2D p2 = {ix, iy};
     Vec2D p3 = {x, y};
-    if (m_rawPath.points().back() != p1 || p1 != p2 || p2 != p3)
+    if (rawPath.points().back() != p1 || p1 != p2 || p2 != p3)
     {
-        m_rawPath.cubic(p1, p2, p3);
+        rawPath.cubic(p1, p2, p3);
     }
 
     m_dirt = kAllDirt;
@@ -66,8 +98,7 @@ void PLSPath::cubicTo(float ox, float oy, float ix, float iy, float x, float y)
 
 void PLSPath::close()
 {
-    assert(m_rawPathMutationLockCount == 0);
-    m_rawPath.close();
+    mutableRawPath().close();
     m_dirt = kAllDirt;
 }
 
@@ -75,11 +106,20 @@ void PLSPath::addRenderPath(RenderPath* path, const Mat2D& matrix)
 {
     assert(m_rawPathMutationLockCount == 0);
     PLSPath* plsPath = static_cast<PLSPath*>(path);
-    RawPath::Iter transformedPathIter = m_rawPath.addPath(plsPath->m_rawPath, &matrix);
+    if (matrix == Mat2D() && getRawPath().empty())
+    {
+        // Adding an untransformed path to an empty one: share its storage instead of copying the
+        // points. Whichever path mutates first will make its own copy.
+        setSharedRawPath(plsPath->m_sharedRawPath);
+        m_dirt = kAllDirt;
+        return;
+    }
+    RawPath& rawPath = mutableRawPath();
+    RawPath::Iter transformedPathIter = rawPath.addPath(plsPath->getRawPath(), &matrix);
     if (matrix != Mat2D())
     {
         // Prune any segments that became empty after the transform.
-        m_rawPath.pruneEmptySegments(transformedPathIter);
+        rawPath.pruneEmptySegments(transformedPathIter);
     }
     m_dirt = kAllDirt;
 }
@@ -88,7 +128,7 @@ const AABB& PLSPath::getBounds() const
 {
     if (m_dirt & kPathBoundsDirt)
     {
-        m_bounds = m_rawPath.bounds();
+        m_bounds = getRawPath().bounds();
         m_dirt &= ~kPathBoundsDirt;
     }
     return m_bounds;
@@ -100,7 +140,7 @@ float PLSPath::getCoarseArea() const
     {
         float a = 0;
         Vec2D contourP0 = {0, 0}, lastPt = {0, 0};
-        for (auto [verb, pts] : m_rawPath)
+        for (auto [verb, pts] : getRawPath())
         {
             switch (verb)
             {
@@ -5,16 +5,41 @@
 #pragma once
 
 #include "rive/math/raw_path.hpp"
+#include "rive/refcnt.hpp"
 #include "rive/renderer.hpp"
+#include <atomic>
 
 namespace rive::pls
 {
+// Ref-counted RawPath storage that can be shared between PLSPaths. A path with shared storage
+// makes a private copy before its first mutation (copy-on-write), so composite paths built from
+// untransformed sub-paths don't duplicate point arrays.
+class SharedRawPath : public RefCnt<SharedRawPath>
+{
+public:
+    SharedRawPath() = default;
+    explicit SharedRawPath(const RawPath& rawPath) : m_rawPath(rawPath) {}
+
+    const RawPath& rawPath() const { return m_rawPath; }
+
+    // Is this storage referenced by more than one PLSPath?
+    bool isShared() const { return m_pathCount.load(std::memory_order_acquire) > 1; }
+
+private:
+    friend class PLSPath;
+    RawPath m_rawPath;
+    // Number of PLSPaths that currently reference this storage. Maintained by
+    // PLSPath::setSharedRawPath(), independently of the ref count.
+    std::atomic<uint32_t> m_pathCount = 0;
+};
+
 // RenderPath implementation for Rive's pixel local storage renderer.
 class PLSPath : public lite_rtti_override<RenderPath, PLSPath>
 {
 public:
-    PLSPath() = default;
+    PLSPath() { setSharedRawPath(make_rcp<SharedRawPath>()); }
     PLSPath(FillRule fillRule, RawPath& rawPath);
+    ~PLSPath() override { setSharedRawPath(nullptr); }
 
     void rewind() override;
     void fillRule(FillRule rule) override { m_fillRule = rule; }
@@ -27,7 +52,7 @@ public:
     void addPath(CommandPath* p, const Mat2D& m) override { addRenderPath(p->renderPath(), m); }
     void addRenderPath(RenderPath* path, const Mat2D& matrix) override;
 
-    const RawPath& getRawPath() const { return m_rawPath; }
+    const RawPath& getRawPath() const { return m_sharedRawPath->rawPath(); }
     FillRule getFillRule() const { return m_fillRule; }
 
     const AABB& getBounds() const;
@@ -48,8 +73,14 @@ public:
 #endif
 
 private:
+    // Returns the RawPath for writing, first making a private copy if the storage is shared.
+    RawPath& mutableRawPath();
+
+    // Points this path at new storage, updating the path counts of the old and new storage.
+    void setSharedRawPath(rcp<SharedRawPath>);
+
     FillRule m_fillRule = FillRule::nonZero;
-    RawPath m_rawPath;
+    rcp<SharedRawPath> m_sharedRawPath;
     mutable AABB m_bounds;
     mutable float m_coarseArea;
     mutable uint64_t m_rawPathMutationID;
@@ -63,6 +94,6 @@ private:
     };
 
     mutable uint32_t m_dirt = kAllDirt;
-    RIVE_DEBUG_CODE(mutable int m_rawPathMutationLockCount = 0;)
+    RIVE_DEBUG_CODE(mutable std::atomic<int> m_rawPathMutationLockCount = 0;)
 };
 } // namespace rive::pls
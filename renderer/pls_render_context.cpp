@@ -4,15 +4,27 @@
 
 #include "rive/pls/pls_render_context.hpp"
 
+#include "async_image_decoder.hpp"
+#include "async_triangulator.hpp"
 #include "gr_inner_fan_triangulator.hpp"
 #include "intersection_board.hpp"
+#include "ktx2.hpp"
+#include "pls_loader_factory.hpp"
 #include "pls_paint.hpp"
+#include "pls_path.hpp"
+#include "rive/math/math_types.hpp"
+#include "rive/math/raw_path.hpp"
 #include "rive/pls/pls_draw.hpp"
 #include "rive/pls/pls_image.hpp"
 #include "rive/pls/pls_render_context_impl.hpp"
+#include "rive/pls/pls_renderer.hpp"
+#include "rive/pls/pls_trace.hpp"
 #include "shaders/constants.glsl"
+#include "submission_thread.hpp"
 
+#include <algorithm>
 #include <string_view>
+#include <thread>
 
 namespace rive::pls
 {
@@ -20,21 +32,67 @@ constexpr size_t kDefaultSimpleGradientCapacity = 512;
 constexpr size_t kDefaultComplexGradientCapacity = 1024;
 constexpr size_t kDefaultDrawCapacity = 2048;
 
-constexpr size_t kMaxTextureHeight = 2048; // TODO: Move this variable to PlatformFeatures.
-constexpr size_t kMaxTessellationVertexCount = kMaxTextureHeight * kTessTextureWidth;
+// Once a flush runs out of clip IDs, generateClipID() checks at most this many dead clips for one
+// it can recycle before giving up and asking for a logical flush.
+constexpr uint32_t kMaxClipRecycleCandidates = 64;
+
+constexpr size_t kMaxTextureHeight = 2048; // GL_MAX_TEXTURE_SIZE spec minimum on ES3/WebGL2.
+
+// The tessellation texture may grow taller than kMaxTextureHeight on devices that support it, but
+// no taller than this. At full height it holds 16M vertices in 256 MiB, and it only grows that
+// large while frames keep needing it.
+constexpr size_t kMaxTessTextureHeight = 8192;
 constexpr size_t kMaxTessellationPaddingVertexCount =
     pls::kMidpointFanPatchSegmentSpan +      // Padding at the beginning of the tess texture
     (pls::kOuterCurvePatchSegmentSpan - 1) + // Max padding between patch types in the tess texture
     1;                                       // Padding at the end of the tessellation texture
-constexpr size_t kMaxTessellationVertexCountBeforePadding =
-    kMaxTessellationVertexCount - kMaxTessellationPaddingVertexCount;
 
 // Metal requires vertex buffers to be 256-byte aligned.
-constexpr size_t kMaxTessellationAlignmentVertices = pls::kTessVertexBufferAlignmentInElements - 1;
-
-// We can only reorder 32767 draws at a time since the one-based groupIndex returned by
-// IntersectionBoard is a signed 16-bit integer.
-constexpr size_t kMaxReorderedDrawCount = std::numeric_limits<int16_t>::max();
+constexpr size_t kMaxTessellationAlignmentVertices =
+    std::max(pls::kTessVertexBufferAlignmentInElements,
+             pls::kCompactTessVertexBufferAlignmentInElements) -
+    1;
+
+// We can only reorder 2^18 - 1 draws at a time since the sort key addresses them with an 18-bit
+// index (and stores the one-based groupIndex returned by IntersectionBoard in 19 signed bits).
+constexpr static uint32_t kDrawIndexBits = 18;
+constexpr size_t kMaxReorderedDrawCount = (1 << kDrawIndexBits) - 1;
+
+// Bit layout of the keys that LogicalFlush::writeResources() sorts the draw list by, in atomic and
+// depthStencil modes: [draw group, draw type, texture hash, blend mode, draw contents, draw index].
+constexpr static int kDrawGroupShift = 45; // Where in the key does the draw group begin?
+constexpr static int64_t kDrawGroupMask = 0x7ffffllu << kDrawGroupShift;
+constexpr static int kDrawTypeShift = 42;
+constexpr static int64_t kDrawTypeMask RIVE_MAYBE_UNUSED = 7llu << kDrawTypeShift;
+constexpr static int kTextureHashShift = 28;
+constexpr static int64_t kTextureHashMask = 0x3fffllu << kTextureHashShift;
+constexpr static int kBlendModeShift = 24;
+constexpr static int kBlendModeMask = 0xf << kBlendModeShift;
+constexpr static int kDrawContentsShift = kDrawIndexBits;
+constexpr static int64_t kDrawContentsMask = 0x3fllu << kDrawContentsShift;
+constexpr static int64_t kDrawIndexMask = (1 << kDrawIndexBits) - 1;
+// The draw group is signed and goes all the way to the top of the key, so it has one more bit than
+// the draw index.
+static_assert(kDrawGroupShift + kDrawIndexBits + 1 == 64);
+static_assert(kDrawContentsShift + 6 == kBlendModeShift);
+
+// depthStencil mode also derives each draw's Z index from its groupIndex, which the shaders
+// normalize as a 16-bit value.
+constexpr size_t kMaxDepthSortedDrawCount = std::numeric_limits<int16_t>::max();
+
+// Size of a bin in tile-binned rendering. A multiple of the IntersectionBoard's 255x255 tiles, and
+// large enough that the resolve and per-pass overhead stay small relative to the bin's content.
+constexpr int32_t kTileBinSize = 255 * 4;
+
+// Floor on the effective tessellation quality, so precisions never reach zero. (At 1/16, curves
+// get about a quarter of their usual segments.)
+constexpr float kMinTessellationQuality = 1.f / 16;
+
+// Floor on FrameDescriptor::resolutionScale.
+constexpr float kMinResolutionScale = 1.f / 8;
+
+// Size of a tile in the coarse occlusion grid used by LogicalFlush::cullOccludedDraws().
+constexpr int32_t kOcclusionTileSize = 64;
 
 // How tall to make a resource texture in order to support the given number of items.
 template <size_t WidthInItems> constexpr static size_t resource_texture_height(size_t itemCount)
@@ -42,11 +100,14 @@ template <size_t WidthInItems> constexpr static size_t resource_texture_height(s
     return (itemCount + WidthInItems - 1) / WidthInItems;
 }
 
-constexpr static size_t gradient_data_height(size_t simpleRampCount, size_t complexRampCount)
-{
-    return resource_texture_height<pls::kGradTextureWidthInSimpleRamps>(simpleRampCount) +
-           complexRampCount;
-}
+// The top rows of the gradient texture hold simple ramps, which get re-uploaded every flush. The
+// remaining rows are a persistent atlas of complex ramps that survive from frame to frame.
+constexpr size_t kSimpleGradientRows = 64;
+constexpr size_t kMaxSimpleGradientsPerFlush =
+    kSimpleGradientRows * pls::kGradTextureWidthInSimpleRamps;
+constexpr size_t kComplexGradientAtlasRows = 960;
+constexpr size_t kGradTextureHeightWithAtlas = kSimpleGradientRows + kComplexGradientAtlasRows;
+static_assert(kGradTextureHeightWithAtlas <= kMaxTextureHeight);
 
 inline GradientContentKey::GradientContentKey(rcp<const PLSGradient> gradient) :
     m_gradient(std::move(gradient))
@@ -85,22 +146,106 @@ size_t DeepHashGradient::operator()(const GradientContentKey& key) const
     return x ^ y;
 }
 
+PLSRenderContext::DrawAllocators::DrawAllocators() : m_scratchPath(std::make_unique<RawPath>()) {}
+
+PLSRenderContext::DrawAllocators::~DrawAllocators() {}
+
+void PLSRenderContext::DrawAllocators::reset()
+{
+    m_unitRectPrototype.reset();
+    m_perFrameAllocator.reset();
+    m_numChopsAllocator.reset();
+    m_chopVerticesAllocator.reset();
+    m_tangentPairsAllocator.reset();
+    m_polarSegmentCountsAllocator.reset();
+    m_parametricSegmentCountsAllocator.reset();
+}
+
 PLSRenderContext::PLSRenderContext(std::unique_ptr<PLSRenderContextImpl> impl) :
     m_impl(std::move(impl)),
-    // -1 from m_maxPathID so we reserve a path record for the clearColor paint (for atomic mode).
-    // This also allows us to index the storage buffers directly by pathID.
-    m_maxPathID(MaxPathID(m_impl->platformFeatures().pathIDGranularity) - 1)
+    m_maxContourID(m_impl->platformFeatures().supportsWideContourIDs ? kMaxWideContourID
+                                                                      : kMaxContourID),
+    m_maxPathID(MaxPathID(m_impl->platformFeatures().pathIDGranularity) - 1),
+    m_maxTessTextureHeight(std::clamp<size_t>(m_impl->platformFeatures().maxTextureSize,
+                                              kMaxTextureHeight,
+                                              kMaxTessTextureHeight)),
+    m_maxTessVertexCount(m_maxTessTextureHeight * kTessTextureWidth)
 {
     setResourceSizes(ResourceAllocationCounts(), /*forceRealloc =*/true);
     releaseResources();
+
+    m_unitRectPath = make_rcp<PLSPath>();
+    m_unitRectPath->moveTo(0, 0);
+    m_unitRectPath->lineTo(1, 0);
+    m_unitRectPath->lineTo(1, 1);
+    m_unitRectPath->lineTo(0, 1);
+    m_unitRectPath->close();
+    m_unitRectPath->getBounds();
+    m_unitRectPath->getCoarseArea();
+    m_unitRectPath->getRawPathMutationID();
 }
 
 PLSRenderContext::~PLSRenderContext()
 {
     // Always call flush() to avoid deadlock.
     assert(!m_didBeginFrame);
+    waitForPendingSubmission();
     // Delete the logical flushes before the block allocators let go of their allocations.
     m_logicalFlushes.clear();
+    m_pipelinedFrame.logicalFlushes.clear();
+}
+
+RetainedMidpointFanData* PLSRenderContext::retainedMidpointFanData(uint64_t rawPathMutationID)
+{
+    std::unique_ptr<RetainedMidpointFanData>& data = m_retainedMidpointFanData[rawPathMutationID];
+    if (data == nullptr)
+    {
+        data = std::make_unique<RetainedMidpointFanData>();
+    }
+    data->idleFrameCount = 0;
+    return data.get();
+}
+
+RetainedInteriorTriangulationData* PLSRenderContext::retainedInteriorTriangulationData(
+    uint64_t rawPathMutationID)
+{
+    std::unique_ptr<RetainedInteriorTriangulationData>& data =
+        m_retainedInteriorTriangulationData[rawPathMutationID];
+    if (data == nullptr)
+    {
+        data = std::make_unique<RetainedInteriorTriangulationData>();
+    }
+    data->idleFrameCount = 0;
+    return data.get();
+}
+
+void PLSRenderContext::ageRetainedData()
+{
+    for (auto iter = m_retainedInteriorTriangulationData.begin();
+         iter != m_retainedInteriorTriangulationData.end();)
+    {
+        if (++iter->second->idleFrameCount > kMaxRetainedDataIdleFrames)
+        {
+            iter = m_retainedInteriorTriangulationData.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+    for (auto iter = m_retainedMidpointFanData.begin(); iter != m_retainedMidpointFanData.end();)
+    {
+        if (++iter->second->idleFrameCount > kMaxRetainedDataIdleFrames)
+        {
+            iter = m_retainedMidpointFanData.erase(iter);
+        }
+        else
+        {
+            // Prototypes live in the per-frame allocators.
+            iter->second->framePrototype = nullptr;
+            ++iter;
+        }
+    }
 }
 
 const pls::PlatformFeatures& PLSRenderContext::platformFeatures() const
@@ -112,24 +257,455 @@ rcp<RenderBuffer> PLSRenderContext::makeRenderBuffer(RenderBufferType type,
                                                      RenderBufferFlags flags,
                                                      size_t sizeInBytes)
 {
+    waitForPendingSubmission();
     return m_impl->makeRenderBuffer(type, flags, sizeInBytes);
 }
 
 rcp<RenderImage> PLSRenderContext::decodeImage(Span<const uint8_t> encodedBytes)
 {
+    if (IsKTX2(encodedBytes))
+    {
+        KTX2Image ktx2;
+        if (!ParseKTX2(encodedBytes, &ktx2))
+        {
+            return nullptr;
+        }
+        return makeCompressedImage(ktx2.width,
+                                   ktx2.height,
+                                   ktx2.mipLevelCount,
+                                   ktx2.format,
+                                   Span<const uint8_t>(ktx2.data.data(), ktx2.data.size()));
+    }
+    if (m_imageAtlasEnabled || m_imageStreamingEnabled)
+    {
+        // We need the pixels on the CPU to pack them into an atlas page or make a thumbnail.
+        AsyncImageDecodeJob decoded;
+        if (AsyncImageDecoder::DecodeRGBA(encodedBytes, &decoded))
+        {
+            if (m_imageStreamingEnabled &&
+                std::max(decoded.width, decoded.height) > PLSImageStreamingState::kThumbnailSize)
+            {
+                return makeStreamedImage(
+                    std::vector<uint8_t>(encodedBytes.begin(), encodedBytes.end()),
+                    &decoded);
+            }
+            return makeImageFromRGBA(decoded.width, decoded.height, decoded.rgbaPixels.data());
+        }
+    }
+    waitForPendingSubmission();
     rcp<PLSTexture> texture = m_impl->decodeImageTexture(encodedBytes);
     return texture != nullptr ? make_rcp<PLSImage>(std::move(texture)) : nullptr;
 }
 
+Factory* PLSRenderContext::loaderFactory()
+{
+    if (m_loaderFactory == nullptr)
+    {
+        m_loaderFactory = std::make_unique<PLSLoaderFactory>(platformFeatures());
+    }
+    return m_loaderFactory.get();
+}
+
+rcp<RenderImage> PLSRenderContext::makeImageFromRGBA(uint32_t width,
+                                                     uint32_t height,
+                                                     const uint8_t imageDataRGBA[])
+{
+    if (m_imageAtlasEnabled && width <= PLSImageAtlasPage::kMaxImageSize &&
+        height <= PLSImageAtlasPage::kMaxImageSize)
+    {
+        AABB texCoordBounds;
+        for (int attempt = 0; attempt < 2; ++attempt)
+        {
+            if (m_openImageAtlasPage == nullptr || m_openImageAtlasPage->isFrozen())
+            {
+                m_openImageAtlasPage = make_rcp<PLSImageAtlasPage>();
+            }
+            if (m_openImageAtlasPage->addImage(width, height, imageDataRGBA, &texCoordBounds))
+            {
+                return make_rcp<PLSImage>(width, height, m_openImageAtlasPage, texCoordBounds);
+            }
+            // The page is full. Start a new one.
+            m_openImageAtlasPage = nullptr;
+        }
+    }
+    uint32_t mipLevelCount = math::msb(height | width);
+    waitForPendingSubmission();
+    rcp<PLSTexture> texture = m_impl->makeImageTexture(width, height, mipLevelCount, imageDataRGBA);
+    return texture != nullptr ? make_rcp<PLSImage>(std::move(texture)) : nullptr;
+}
+
+rcp<RenderImage> PLSRenderContext::makeCompressedImage(uint32_t width,
+                                                       uint32_t height,
+                                                       uint32_t mipLevelCount,
+                                                       pls::CompressedTextureFormat format,
+                                                       Span<const uint8_t> data)
+{
+    if (!platformFeatures().supportsCompressedTextureFormat(format) || width == 0 || height == 0 ||
+        mipLevelCount == 0 || mipLevelCount > static_cast<uint32_t>(math::msb(height | width)) ||
+        data.size() != pls::CompressedTextureSizeInBytes(width, height, mipLevelCount))
+    {
+        return nullptr;
+    }
+    waitForPendingSubmission();
+    rcp<PLSTexture> texture =
+        m_impl->makeCompressedImageTexture(width, height, mipLevelCount, format, data.data());
+    return texture != nullptr ? make_rcp<PLSImage>(std::move(texture)) : nullptr;
+}
+
+rcp<RenderImage> PLSRenderContext::makeStreamedImage(std::vector<uint8_t> encodedBytes,
+                                                     AsyncImageDecodeJob* decoded)
+{
+    uint32_t width = decoded->width;
+    uint32_t height = decoded->height;
+    uint32_t thumbnailLevel = 0;
+    while (std::max(width >> thumbnailLevel, height >> thumbnailLevel) >
+           PLSImageStreamingState::kThumbnailSize)
+    {
+        ++thumbnailLevel;
+    }
+    AsyncImageDecoder::DownsampleRGBA(decoded, thumbnailLevel);
+    uint32_t mipLevelCount = math::msb(decoded->height | decoded->width);
+    waitForPendingSubmission();
+    rcp<PLSTexture> thumbnail = m_impl->makeImageTexture(decoded->width,
+                                                         decoded->height,
+                                                         mipLevelCount,
+                                                         decoded->rgbaPixels.data());
+    if (thumbnail == nullptr)
+    {
+        return nullptr;
+    }
+    auto streamingState = std::make_shared<PLSImageStreamingState>(width,
+                                                                   height,
+                                                                   std::move(encodedBytes),
+                                                                   std::move(thumbnail),
+                                                                   thumbnailLevel);
+    m_streamedImages.push_back(streamingState);
+    return make_rcp<PLSImage>(std::move(streamingState));
+}
+
+void PLSRenderContext::updateStreamedImages()
+{
+    assert(!m_didBeginFrame);
+    // Drop images that have been deleted and queue decodes for the ones that were drawn larger
+    // than their resident resolution.
+    size_t detailBytes = 0;
+    size_t liveCount = 0;
+    for (size_t i = 0; i < m_streamedImages.size(); ++i)
+    {
+        std::shared_ptr<PLSImageStreamingState> image = m_streamedImages[i].lock();
+        if (image == nullptr)
+        {
+            continue;
+        }
+        m_streamedImages[liveCount++] = image;
+        uint32_t requestedLevel = image->takeRequestedLevel();
+        if (requestedLevel <= image->thumbnailLevel())
+        {
+            image->lastDrawnFrame = m_frameNumber;
+            if (requestedLevel < image->residentLevel() && !image->decodePending)
+            {
+                AsyncImageDecodeJob job;
+                job.streamingState = image;
+                job.downsampleLevel = requestedLevel;
+                asyncImageDecoder()->pushJob(std::move(job));
+                image->decodePending = true;
+            }
+        }
+        detailBytes += image->detailSizeInBytes();
+    }
+    m_streamedImages.resize(liveCount);
+
+    if (detailBytes <= m_imageStreamingMemoryBudget)
+    {
+        return;
+    }
+    // Over budget. Fall back to thumbnails for the least recently drawn images, but never for
+    // images that were drawn in the latest frame.
+    std::vector<std::shared_ptr<PLSImageStreamingState>> evictionCandidates;
+    for (const std::weak_ptr<PLSImageStreamingState>& weakImage : m_streamedImages)
+    {
+        std::shared_ptr<PLSImageStreamingState> image = weakImage.lock();
+        if (image != nullptr && image->detailSizeInBytes() > 0 &&
+            image->lastDrawnFrame < m_frameNumber)
+        {
+            evictionCandidates.push_back(std::move(image));
+        }
+    }
+    std::sort(evictionCandidates.begin(),
+              evictionCandidates.end(),
+              [](const auto& a, const auto& b) { return a->lastDrawnFrame < b->lastDrawnFrame; });
+    for (const std::shared_ptr<PLSImageStreamingState>& image : evictionCandidates)
+    {
+        if (detailBytes <= m_imageStreamingMemoryBudget)
+        {
+            break;
+        }
+        detailBytes -= image->detailSizeInBytes();
+        image->evictDetailTexture();
+    }
+}
+
+AsyncImageDecoder* PLSRenderContext::asyncImageDecoder()
+{
+    if (m_asyncImageDecoder == nullptr)
+    {
+        // Leave a core for the rendering thread.
+        size_t threadCount = std::clamp<size_t>(std::thread::hardware_concurrency(), 2, 5) - 1;
+        m_asyncImageDecoder = std::make_unique<AsyncImageDecoder>(threadCount);
+    }
+    return m_asyncImageDecoder.get();
+}
+
+AsyncTriangulator* PLSRenderContext::asyncTriangulator()
+{
+    if (!m_asyncTriangulationEnabled)
+    {
+        return nullptr;
+    }
+    if (m_asyncTriangulator == nullptr)
+    {
+        // Leave a core for the rendering thread.
+        size_t threadCount = std::clamp<size_t>(std::thread::hardware_concurrency(), 2, 5) - 1;
+        m_asyncTriangulator = std::make_unique<AsyncTriangulator>(threadCount);
+    }
+    return m_asyncTriangulator.get();
+}
+
+void PLSRenderContext::decodeImageAsync(std::vector<uint8_t> encodedBytes,
+                                        ImageDecodedCallback onDecoded)
+{
+    AsyncImageDecodeJob job;
+    job.encodedBytes = std::move(encodedBytes);
+    job.onDecoded = std::move(onDecoded);
+    job.keepEncodedBytes = m_imageStreamingEnabled;
+    asyncImageDecoder()->pushJob(std::move(job));
+}
+
+void PLSRenderContext::pollAsyncImageDecodes(bool waitForAll)
+{
+    assert(!m_didBeginFrame);
+    if (m_asyncImageDecoder == nullptr)
+    {
+        return;
+    }
+    size_t uploadedBytes = 0;
+    AsyncImageDecodeJob job;
+    while ((waitForAll || uploadedBytes < kMaxAsyncImageUploadBytesPerPoll) &&
+           m_asyncImageDecoder->popFinishedJob(&job, waitForAll))
+    {
+        if (job.streamingState != nullptr)
+        {
+            // A sharper texture for a streamed image.
+            PLSImageStreamingState* image = job.streamingState.get();
+            if (!job.rgbaPixels.empty() && job.downsampleLevel < image->residentLevel())
+            {
+                uint32_t mipLevelCount = math::msb(job.height | job.width);
+                waitForPendingSubmission();
+                rcp<PLSTexture> texture = m_impl->makeImageTexture(job.width,
+                                                                   job.height,
+                                                                   mipLevelCount,
+                                                                   job.rgbaPixels.data());
+                if (texture != nullptr)
+                {
+                    image->setDetailTexture(std::move(texture), job.downsampleLevel);
+                }
+                uploadedBytes += job.rgbaPixels.size();
+            }
+            image->decodePending = false;
+            job = {};
+            continue;
+        }
+        rcp<RenderImage> image;
+        if (!job.rgbaPixels.empty())
+        {
+            if (m_imageStreamingEnabled && !job.encodedBytes.empty() &&
+                std::max(job.width, job.height) > PLSImageStreamingState::kThumbnailSize)
+            {
+                image = makeStreamedImage(std::move(job.encodedBytes), &job);
+            }
+            else
+            {
+                image = makeImageFromRGBA(job.width, job.height, job.rgbaPixels.data());
+            }
+            uploadedBytes += job.rgbaPixels.size();
+        }
+        if (job.onDecoded != nullptr)
+        {
+            job.onDecoded(std::move(image));
+        }
+        job = {};
+    }
+}
+
+size_t PLSRenderContext::pendingAsyncImageDecodeCount() const
+{
+    return m_asyncImageDecoder != nullptr ? m_asyncImageDecoder->jobsInFlight() : 0;
+}
+
+void PLSRenderContext::setRecordingThreadCount(size_t count)
+{
+    assert(!m_didBeginFrame);
+    while (m_recordingThreadAllocators.size() < count)
+    {
+        m_recordingThreadAllocators.push_back(std::make_unique<DrawAllocators>());
+    }
+    m_recordingThreadAllocators.resize(count);
+}
+
+void PLSRenderContext::setPipelinedSubmission(bool enabled)
+{
+    assert(!m_didBeginFrame);
+    enabled = enabled && platformFeatures().supportsPipelinedSubmission;
+    if (!enabled)
+    {
+        waitForPendingSubmission();
+        m_submissionThread = nullptr;
+    }
+    else if (m_submissionThread == nullptr)
+    {
+        m_submissionThread = std::make_unique<SubmissionThread>();
+    }
+}
+
+void PLSRenderContext::waitForPendingSubmission()
+{
+    if (!m_hasPendingSubmission)
+    {
+        return;
+    }
+    PLS_TRACE_SCOPE("PLSRenderContext::waitForPendingSubmission");
+    m_submissionThread->wait();
+    m_hasPendingSubmission = false;
+
+    // The backend is done reading the frame's draw batches. Release its PLSDraws and memory.
+    std::vector<std::unique_ptr<LogicalFlush>>& logicalFlushes = m_pipelinedFrame.logicalFlushes;
+    logicalFlushes.resize(1);
+    logicalFlushes.front()->rewind();
+    m_pipelinedFrame.drawAllocators->reset();
+    for (const auto& recordingThreadAllocators : m_pipelinedFrame.recordingThreadAllocators)
+    {
+        recordingThreadAllocators->reset();
+    }
+}
+
 void PLSRenderContext::releaseResources()
 {
     assert(!m_didBeginFrame);
+    waitForPendingSubmission();
     resetContainers();
-    setResourceSizes(ResourceAllocationCounts());
+    m_retainedMidpointFanData.clear();
+    m_retainedInteriorTriangulationData.clear();
+    setResourceSizes(ResourceAllocationCounts()); // Also resets the gradient atlas.
     m_maxRecentResourceRequirements = ResourceAllocationCounts();
     m_lastResourceTrimTimeInSeconds = m_impl->secondsNow();
 }
 
+void PLSRenderContext::setTessellationQualityGovernor(const TessellationQualityGovernor& governor)
+{
+    m_tessellationQualityGovernor = governor;
+    m_governedTessellationQuality = 1;
+    m_lastFlushTimeInSeconds = 0;
+}
+
+void PLSRenderContext::updateTessellationQualityGovernor(double flushTime)
+{
+    const TessellationQualityGovernor& governor = m_tessellationQualityGovernor;
+    double frameSeconds = flushTime - m_lastFlushTimeInSeconds;
+    bool hasPreviousFlush = m_lastFlushTimeInSeconds != 0;
+    m_lastFlushTimeInSeconds = flushTime;
+    if (governor.targetFrameSeconds <= 0 || !hasPreviousFlush)
+    {
+        return;
+    }
+    if (frameSeconds > governor.targetFrameSeconds * governor.overBudgetFactor)
+    {
+        m_governedTessellationQuality =
+            std::max(m_governedTessellationQuality * governor.decreaseFactor, governor.minQuality);
+    }
+    else if (frameSeconds < governor.targetFrameSeconds * governor.underBudgetFactor)
+    {
+        m_governedTessellationQuality =
+            std::min(m_governedTessellationQuality + governor.increaseStep, 1.f);
+    }
+}
+
+void PLSRenderContext::reserveResources(const ResourceAllocationCounts& counts)
+{
+    assert(!m_didBeginFrame);
+    waitForPendingSubmission();
+    m_reservedResourceAllocations = counts;
+    setResourceSizes(simd::max(counts.toVec(), m_currentResourceAllocations.toVec()));
+}
+
+// Multiplies resource counts by a policy factor, in fixed point so we stay in integer vectors.
+static PLSRenderContext::ResourceAllocationCounts::VecType scale_resource_counts(
+    const PLSRenderContext::ResourceAllocationCounts::VecType& counts,
+    float factor)
+{
+    constexpr static size_t kFixedPointOne = 64;
+    return counts * std::max<size_t>(static_cast<size_t>(factor * kFixedPointOne), 1) /
+           kFixedPointOne;
+}
+
+void PLSRenderContext::precompileShaders(Span<const pls::ShaderVariant> variants)
+{
+    std::vector<pls::ShaderVariant> supportedVariants;
+    supportedVariants.reserve(variants.size());
+    for (const pls::ShaderVariant& variant : variants)
+    {
+        switch (variant.interlockMode)
+        {
+            case pls::InterlockMode::rasterOrdering:
+                if (!platformFeatures().supportsRasterOrdering)
+                {
+                    continue;
+                }
+                break;
+            case pls::InterlockMode::atomics:
+                if (!platformFeatures().supportsPixelLocalStorage)
+                {
+                    continue;
+                }
+                break;
+            case pls::InterlockMode::depthStencil:
+                break;
+        }
+        supportedVariants.push_back(variant);
+    }
+    waitForPendingSubmission();
+    m_impl->precompileShaders(supportedVariants);
+}
+
+std::vector<pls::ShaderVariant> PLSRenderContext::recordedShaderVariants() const
+{
+    std::vector<pls::ShaderVariant> variants;
+    variants.reserve(m_recordedShaderVariants.size());
+    for (const auto& [key, variant] : m_recordedShaderVariants)
+    {
+        variants.push_back(variant);
+    }
+    return variants;
+}
+
+void PLSRenderContext::recordShaderVariants(const pls::FlushDescriptor& desc)
+{
+    for (const DrawBatch& batch : *desc.drawList)
+    {
+        // Atomic mode uses the same shader features for every draw in a flush.
+        pls::ShaderFeatures shaderFeatures = desc.interlockMode == pls::InterlockMode::atomics
+                                                 ? desc.combinedShaderFeatures
+                                                 : batch.shaderFeatures;
+        uint32_t key = pls::ShaderUniqueKey(batch.drawType,
+                                            shaderFeatures,
+                                            desc.interlockMode,
+                                            pls::ShaderMiscFlags::none);
+        m_recordedShaderVariants.try_emplace(key,
+                                             pls::ShaderVariant{batch.drawType,
+                                                                shaderFeatures,
+                                                                desc.interlockMode});
+    }
+}
+
 void PLSRenderContext::resetContainers()
 {
     assert(!m_didBeginFrame);
@@ -140,11 +716,132 @@ void PLSRenderContext::resetContainers()
         m_logicalFlushes.resize(1);
         m_logicalFlushes.front()->resetContainers();
     }
+}
 
-    m_indirectDrawList.clear();
-    m_indirectDrawList.shrink_to_fit();
+// Does 'updateBounds' leave out any pixels of the render target?
+static bool is_partial_update(const IAABB& updateBounds, const PLSRenderTarget* renderTarget)
+{
+    return updateBounds.left > 0 || updateBounds.top > 0 ||
+           updateBounds.right < static_cast<int32_t>(renderTarget->width()) ||
+           updateBounds.bottom < static_cast<int32_t>(renderTarget->height());
+}
 
-    m_intersectionBoard = nullptr;
+// Chooses how wide to render a complex color ramp, as a log2 number of texels. Every interval
+// between stops needs to span at least kMinTexelsPerStopInterval texels, so ramps with few, widely
+// spaced stops can be packed several to a row. Hard stops always get the full texture width.
+static uint32_t complex_ramp_width_log2(const PLSGradient* gradient)
+{
+    constexpr static float kMinTexelsPerStopInterval = 16;
+    const float* stops = gradient->stops();
+    float minInterval = 1;
+    for (size_t i = 1; i < gradient->count(); ++i)
+    {
+        minInterval = std::min(stops[i] - stops[i - 1], minInterval);
+    }
+    uint32_t widthLog2 = kMinComplexRampWidthLog2;
+    constexpr static uint32_t kMaxWidthLog2 =
+        kMinComplexRampWidthLog2 + kComplexRampWidthClassCount - 1;
+    while (widthLog2 < kMaxWidthLog2 &&
+           minInterval * ((1u << widthLog2) - 1) < kMinTexelsPerStopInterval)
+    {
+        ++widthLog2;
+    }
+    return widthLog2;
+}
+
+bool PLSRenderContext::allocateComplexGradientAtlasSlot(const PLSGradient* gradient,
+                                                        uint64_t flushID,
+                                                        pls::ColorRampLocation* location,
+                                                        bool* needsRender)
+{
+    GradientContentKey key(ref_rcp(gradient));
+    auto iter = m_complexGradientAtlas.find(key);
+    if (iter != m_complexGradientAtlas.end())
+    {
+        // This gradient is already in the texture. Move its row to the front of the LRU list.
+        *location = iter->second;
+        ComplexGradientAtlasRow& row = m_complexGradientAtlasRows[location->row];
+        m_complexGradientAtlasLRU.splice(m_complexGradientAtlasLRU.begin(),
+                                         m_complexGradientAtlasLRU,
+                                         row.lruIter);
+        row.lastUsedFlushID = flushID;
+        *needsRender = false;
+        return true;
+    }
+
+    uint32_t widthLog2 = complex_ramp_width_log2(gradient);
+    uint32_t widthClass = widthLog2 - kMinComplexRampWidthLog2;
+    uint32_t rampsPerRow = kGradTextureWidth >> widthLog2;
+    int32_t rowIdx = m_openComplexGradientAtlasRows[widthClass];
+    if (rowIdx < 0)
+    {
+        if (m_complexGradientAtlasRows.size() < kComplexGradientAtlasRows)
+        {
+            // Rows are only ever freed all at once, so the atlas is always densely packed.
+            rowIdx = static_cast<int32_t>(m_complexGradientAtlasRows.size());
+            m_complexGradientAtlasRows.emplace_back();
+            m_complexGradientAtlasLRU.push_front(static_cast<uint16_t>(rowIdx));
+            m_complexGradientAtlasRows[rowIdx].lruIter = m_complexGradientAtlasLRU.begin();
+        }
+        else
+        {
+            // Evict the least recently used row. Rows used by the current flush are still
+            // referenced by its draws, so if the LRU row is one of those, the entire atlas is in
+            // use.
+            assert(!m_complexGradientAtlasLRU.empty());
+            rowIdx = m_complexGradientAtlasLRU.back();
+            ComplexGradientAtlasRow& lruRow = m_complexGradientAtlasRows[rowIdx];
+            if (lruRow.lastUsedFlushID == flushID)
+            {
+                return false;
+            }
+            for (uint32_t i = 0; i < lruRow.rampCount; ++i)
+            {
+                // Erase by iterator since the key lives inside the node being erased.
+                m_complexGradientAtlas.erase(m_complexGradientAtlas.find(*lruRow.keys[i]));
+            }
+            uint32_t lruWidthClass = lruRow.rampWidthLog2 - kMinComplexRampWidthLog2;
+            if (m_openComplexGradientAtlasRows[lruWidthClass] == rowIdx)
+            {
+                m_openComplexGradientAtlasRows[lruWidthClass] = -1;
+            }
+        }
+        ComplexGradientAtlasRow& newRow = m_complexGradientAtlasRows[rowIdx];
+        newRow.rampWidthLog2 = widthLog2;
+        newRow.rampCount = 0;
+        if (rampsPerRow > 1)
+        {
+            m_openComplexGradientAtlasRows[widthClass] = rowIdx;
+        }
+    }
+
+    ComplexGradientAtlasRow& row = m_complexGradientAtlasRows[rowIdx];
+    assert(row.rampWidthLog2 == widthLog2);
+    assert(row.rampCount < rampsPerRow);
+    *location = pls::ColorRampLocation::MakeComplex(static_cast<uint16_t>(rowIdx),
+                                                    row.rampCount << widthLog2,
+                                                    widthLog2);
+    auto [newIter, didInsert] = m_complexGradientAtlas.emplace(std::move(key), *location);
+    assert(didInsert);
+    row.keys[row.rampCount] = &newIter->first;
+    if (++row.rampCount == rampsPerRow)
+    {
+        m_openComplexGradientAtlasRows[widthClass] = -1;
+    }
+    m_complexGradientAtlasLRU.splice(m_complexGradientAtlasLRU.begin(),
+                                     m_complexGradientAtlasLRU,
+                                     row.lruIter);
+    row.lastUsedFlushID = flushID;
+    *needsRender = true;
+    return true;
+}
+
+void PLSRenderContext::resetComplexGradientAtlas()
+{
+    m_complexGradientAtlas.clear();
+    m_complexGradientAtlasRows.clear();
+    m_complexGradientAtlasLRU.clear();
+    m_openComplexGradientAtlasRows.fill(-1);
 }
 
 PLSRenderContext::LogicalFlush::LogicalFlush(PLSRenderContext* parent) : m_ctx(parent) { rewind(); }
@@ -156,12 +853,29 @@ void PLSRenderContext::LogicalFlush::rewind()
     m_pendingSimpleGradientWrites.clear();
     m_complexGradients.clear();
     m_pendingComplexColorRampDraws.clear();
+    m_minPendingAtlasRow = std::numeric_limits<uint16_t>::max();
+    m_maxPendingAtlasRow = 0;
+    m_gradientAtlasFlushID = ++m_ctx->m_logicalFlushCount;
     m_clips.clear();
+    m_lastGeneratedClipID = 0;
+    m_nextRecycledClipID = 1;
+    m_recycledClipIDCount = 0;
     m_plsDraws.clear();
+    m_drawPixelBounds.clear();
+    m_drawOccluderBounds.clear();
+    m_drawSortKeyBits.clear();
     m_combinedDrawBounds = {std::numeric_limits<int32_t>::max(),
                             std::numeric_limits<int32_t>::max(),
                             std::numeric_limits<int32_t>::min(),
                             std::numeric_limits<int32_t>::min()};
+    m_renderTarget = nullptr;
+    m_isFirstFlushOfTarget = false;
+    m_culledDrawCount = 0;
+    m_drawPixelArea = 0;
+    m_nonSrcOverDrawCount = 0;
+    m_drawGroupCount = 0;
+    m_blendBarrierCount = 0;
+    m_pendingBlendBarrier = false;
 
     m_pathPaddingCount = 0;
     m_paintPaddingCount = 0;
@@ -173,10 +887,17 @@ void PLSRenderContext::LogicalFlush::rewind()
     m_outerCubicTessVertexIdx = 0;
     m_midpointFanTessVertexIdx = 0;
 
+    m_firstSimpleGrad = 0;
+    m_firstImageDraw = 0;
+    m_tessSpanRegionStart = 0;
+    m_firstTriangleVertex = 0;
+
     m_flushDesc = FlushDescriptor();
 
     m_drawList.reset();
     m_combinedShaderFeatures = pls::ShaderFeatures::NONE;
+    m_tileBinDrawLists.clear();
+    m_tileBinFlushDescs.clear();
 
     m_currentPathIsStroked = false;
     m_currentPathContourDirections = pls::ContourDirections::none;
@@ -188,6 +909,7 @@ void PLSRenderContext::LogicalFlush::rewind()
     RIVE_DEBUG_CODE(m_expectedPathTessLocationAtEndOfPath = 0;)
     RIVE_DEBUG_CODE(m_expectedPathMirroredTessLocationAtEndOfPath = 0;)
     RIVE_DEBUG_CODE(m_pathCurveCount = 0;)
+    m_gpuTessVertexSpanCount = 0;
 
     m_currentZIndex = 0;
 
@@ -201,6 +923,17 @@ void PLSRenderContext::LogicalFlush::resetContainers()
     m_plsDraws.clear();
     m_plsDraws.shrink_to_fit();
     m_plsDraws.reserve(kDefaultDrawCapacity);
+    m_drawPixelBounds.clear();
+    m_drawPixelBounds.shrink_to_fit();
+    m_drawPixelBounds.reserve(kDefaultDrawCapacity);
+    m_drawOccluderBounds.clear();
+    m_drawOccluderBounds.shrink_to_fit();
+    m_drawOccluderBounds.reserve(kDefaultDrawCapacity);
+    m_drawSortKeyBits.clear();
+    m_drawSortKeyBits.shrink_to_fit();
+    m_drawSortKeyBits.reserve(kDefaultDrawCapacity);
+    m_occludedTiles.clear();
+    m_occludedTiles.shrink_to_fit();
 
     m_simpleGradients.rehash(0);
     m_simpleGradients.reserve(kDefaultSimpleGradientCapacity);
@@ -212,17 +945,88 @@ void PLSRenderContext::LogicalFlush::resetContainers()
     m_complexGradients.rehash(0);
     m_complexGradients.reserve(kDefaultComplexGradientCapacity);
 
-    m_pendingComplexColorRampDraws.clear();
-    m_pendingComplexColorRampDraws.shrink_to_fit();
-    m_pendingComplexColorRampDraws.reserve(kDefaultComplexGradientCapacity);
+    m_pendingComplexColorRampDraws.clear();
+    m_pendingComplexColorRampDraws.shrink_to_fit();
+    m_pendingComplexColorRampDraws.reserve(kDefaultComplexGradientCapacity);
+
+    m_indirectDrawList.clear();
+    m_indirectDrawList.shrink_to_fit();
+    m_indirectDrawSortScratch.clear();
+    m_indirectDrawSortScratch.shrink_to_fit();
+
+    m_intersectionBoard = nullptr;
+
+    m_blendPhaseBoard = nullptr;
+    m_drawBlendPhases.clear();
+    m_drawBlendPhases.shrink_to_fit();
+    m_blendPhaseSortScratch.clear();
+    m_blendPhaseSortScratch.shrink_to_fit();
+}
+
+void PLSRenderContext::setMaxFramesInFlight(int maxFramesInFlight)
+{
+    m_maxFramesInFlight = std::clamp(maxFramesInFlight, 0, m_impl->bufferRingSize());
+}
+
+int PLSRenderContext::maxFramesInFlight() const
+{
+    return m_maxFramesInFlight != 0 ? m_maxFramesInFlight : m_impl->bufferRingSize();
+}
+
+void PLSRenderContext::retireFramesInFlight(size_t maxFrames)
+{
+    if (maxFrames == 0 && !m_inFlightFrameFences.empty())
+    {
+        // The newest fence may belong to a frame that hasn't been submitted yet.
+        waitForPendingSubmission();
+    }
+    while (m_inFlightFrameFences.size() > maxFrames)
+    {
+        m_inFlightFrameFences.front()->wait();
+        m_inFlightFrameFences.pop_front();
+    }
+}
+
+void PLSRenderContext::trackFrameCompletionFence(pls::CommandBufferCompletionFence* fence)
+{
+    if (fence != nullptr)
+    {
+        m_inFlightFrameFences.push_back(ref_rcp(fence));
+        // Don't let fences pile up in the deque if the client never begins another frame.
+        retireFramesInFlight(m_impl->bufferRingSize());
+    }
 }
 
 void PLSRenderContext::beginFrame(const FrameDescriptor& frameDescriptor)
 {
     assert(!m_didBeginFrame);
+    // Frame pacing. The buffer rings already keep us from getting more than bufferRingSize()
+    // frames ahead, but the client may have asked for less latency than that.
+    retireFramesInFlight(maxFramesInFlight() - 1);
+    pollAsyncImageDecodes();
+    if (m_loaderFactory != nullptr)
+    {
+        m_loaderFactory->createPendingResources(this);
+    }
+    if (!m_streamedImages.empty())
+    {
+        updateStreamedImages();
+    }
     assert(frameDescriptor.renderTargetWidth > 0);
     assert(frameDescriptor.renderTargetHeight > 0);
+    assert(frameDescriptor.dirtyBounds.empty() ||
+           frameDescriptor.loadAction == pls::LoadAction::preserveRenderTarget);
     m_frameDescriptor = frameDescriptor;
+    m_dirtyBoundsClipRect = nullptr;
+    ++m_frameNumber;
+    m_resolutionScaleRenderTarget = nullptr;
+    m_frameResolutionScaleMatrix = Mat2D();
+    if (m_frameDescriptor.resolutionScale < 1 && platformFeatures().supportsResolutionScaling &&
+        m_frameDescriptor.dirtyBounds.empty() &&
+        m_frameDescriptor.loadAction == pls::LoadAction::clear)
+    {
+        beginResolutionScaledFrame();
+    }
     if (!platformFeatures().supportsPixelLocalStorage)
     {
         // Use 4x MSAA if we don't have pixel local storage and MSAA wasn't specified.
@@ -237,11 +1041,52 @@ void PLSRenderContext::beginFrame(const FrameDescriptor& frameDescriptor)
     {
         m_frameInterlockMode = pls::InterlockMode::atomics;
     }
+    else if (m_frameDescriptor.autoInterlockMode)
+    {
+        m_frameInterlockMode = chooseAutoInterlockMode();
+    }
     else
     {
         m_frameInterlockMode = pls::InterlockMode::rasterOrdering;
     }
     m_frameShaderFeaturesMask = pls::ShaderFeaturesMaskFor(m_frameInterlockMode);
+    // -1 from m_maxPathID so we reserve a path record for the clearColor paint (for atomic mode).
+    // This also allows us to index the storage buffers directly by pathID.
+    m_maxPathID = (m_frameInterlockMode == pls::InterlockMode::atomics
+                       ? kMaxAtomicPathID
+                       : MaxPathID(platformFeatures().pathIDGranularity)) -
+                  1;
+    assert(m_frameDescriptor.tessellationQuality > 0);
+    m_frameTessellationQuality =
+        std::clamp(m_frameDescriptor.tessellationQuality * m_governedTessellationQuality,
+                   kMinTessellationQuality,
+                   1.f);
+    m_frameParametricPrecision = kParametricPrecision * m_frameTessellationQuality;
+    m_framePolarPrecision = kPolarPrecision * m_frameTessellationQuality;
+    m_frameDrawStreamHash = DrawStreamHash();
+    m_frameDrawStreamIsHashable = m_frameDescriptor.skipUnchangedFrames &&
+                                  m_frameDescriptor.loadAction != pls::LoadAction::dontCare;
+    // A cleared frame doesn't depend on what the target held before. A preserved one only doesn't
+    // once an opaque draw has covered every pixel it updates (see pushDrawBatch()).
+    m_frameOverwritesRenderTarget = m_frameDescriptor.loadAction == pls::LoadAction::clear;
+    if (m_frameDrawStreamIsHashable)
+    {
+        // Everything besides the draws that affects the rendered pixels.
+        m_frameDrawStreamHash.write(m_frameDescriptor.renderTargetWidth)
+            .write(m_frameDescriptor.renderTargetHeight)
+            .write(m_frameDescriptor.loadAction)
+            .write(m_frameDescriptor.clearColor)
+            .write(m_frameDescriptor.msaaSampleCount)
+            .write(m_frameInterlockMode)
+            .write(m_frameDescriptor.dirtyBounds)
+            .write(m_frameTessellationQuality)
+            .write(m_frameDescriptor.tinyPathLODPixelSize)
+            .write(m_frameDescriptor.compactTessVertexSpans)
+            .write(m_frameDescriptor.wireframe)
+            .write(m_frameDescriptor.fillsDisabled)
+            .write(m_frameDescriptor.strokesDisabled)
+            .write(m_frameDescriptor.overdrawHeatmap);
+    }
     if (m_logicalFlushes.empty())
     {
         m_logicalFlushes.emplace_back(new LogicalFlush(this));
@@ -255,7 +1100,54 @@ bool PLSRenderContext::isOutsideCurrentFrame(const IAABB& pixelBounds)
     int4 bounds = simd::load4i(&pixelBounds);
     auto renderTargetSize = simd::cast<int32_t>(
         uint2{m_frameDescriptor.renderTargetWidth, m_frameDescriptor.renderTargetHeight});
-    return simd::any(bounds.xy >= renderTargetSize || bounds.zw <= 0 || bounds.xy >= bounds.zw);
+    if (simd::any(bounds.xy >= renderTargetSize || bounds.zw <= 0 || bounds.xy >= bounds.zw))
+    {
+        return true;
+    }
+    if (frameHasDirtyBounds())
+    {
+        int4 dirtyBounds = simd::load4i(&m_frameDescriptor.dirtyBounds);
+        return simd::any(bounds.xy >= dirtyBounds.zw || bounds.zw <= dirtyBounds.xy);
+    }
+    return false;
+}
+
+const pls::ClipRectInverseMatrix* PLSRenderContext::frameDirtyBoundsClipRect()
+{
+    if (!frameHasDirtyBounds() || !frameSupportsClipRects())
+    {
+        return nullptr;
+    }
+    if (m_dirtyBoundsClipRect == nullptr)
+    {
+        m_dirtyBoundsClipRect =
+            make<pls::ClipRectInverseMatrix>(Mat2D(), AABB(m_frameDescriptor.dirtyBounds));
+    }
+    return m_dirtyBoundsClipRect;
+}
+
+bool PLSRenderContext::frameUsesTileBinnedRendering() const
+{
+    assert(m_didBeginFrame);
+    return m_frameDescriptor.tileBinnedRendering &&
+           m_frameInterlockMode == pls::InterlockMode::atomics &&
+           platformFeatures().supportsTileBinnedRendering &&
+           (m_frameDescriptor.renderTargetWidth > kTileBinSize ||
+            m_frameDescriptor.renderTargetHeight > kTileBinSize);
+}
+
+bool PLSRenderContext::frameUsesCompactTessVertexSpans() const
+{
+    assert(m_didBeginFrame);
+    return m_frameDescriptor.compactTessVertexSpans &&
+           platformFeatures().supportsCompactTessVertexSpans;
+}
+
+bool PLSRenderContext::frameUsesGPUTessellationSpans() const
+{
+    assert(m_didBeginFrame);
+    return m_frameDescriptor.gpuTessellationSpans &&
+           platformFeatures().supportsGPUTessellationSpans && !frameUsesCompactTessVertexSpans();
 }
 
 bool PLSRenderContext::frameSupportsClipRects() const
@@ -265,6 +1157,12 @@ bool PLSRenderContext::frameSupportsClipRects() const
            platformFeatures().supportsClipPlanes;
 }
 
+bool PLSRenderContext::frameSupportsRoundedClipRects() const
+{
+    assert(m_didBeginFrame);
+    return m_frameInterlockMode != pls::InterlockMode::depthStencil;
+}
+
 bool PLSRenderContext::frameSupportsImagePaintForPaths() const
 {
     assert(m_didBeginFrame);
@@ -279,13 +1177,42 @@ uint32_t PLSRenderContext::generateClipID(const IAABB& contentBounds)
     return m_logicalFlushes.back()->generateClipID(contentBounds);
 }
 
+static bool intersects(const IAABB& a, const IAABB& b) { return !a.intersect(b).empty(); }
+
 uint32_t PLSRenderContext::LogicalFlush::generateClipID(const IAABB& contentBounds)
 {
     if (m_clips.size() < m_ctx->m_maxPathID) // maxClipID == maxPathID.
     {
         m_clips.emplace_back(contentBounds);
         assert(m_ctx->m_clipContentID != m_clips.size());
-        return m_clips.size();
+        return m_lastGeneratedClipID = m_clips.size();
+    }
+
+    // Every ID has been handed out. Look for one to recycle. The PLSRenderer only ever reads the
+    // clip content ID again, or the clip it generated most recently (while nesting the next one
+    // inside it), so every other clip is dead. A dead clip's ID can be reused as long as the new
+    // clip's writes don't land anywhere the dead clip wrote or read, and (see addClipReadBounds())
+    // the new clip is never read where the dead clip's ID might still be in the clip buffer.
+    // Draws that don't overlap are free to be reordered, so this is all based on bounds.
+    uint32_t clipCount = static_cast<uint32_t>(m_clips.size());
+    for (uint32_t n = std::min(clipCount, kMaxClipRecycleCandidates); n != 0; --n)
+    {
+        uint32_t clipID = m_nextRecycledClipID;
+        m_nextRecycledClipID = clipID % clipCount + 1;
+        if (clipID == m_ctx->m_clipContentID || clipID == m_lastGeneratedClipID)
+        {
+            continue;
+        }
+        ClipInfo& clipInfo = getWritableClipInfo(clipID);
+        IAABB staleBounds = clipInfo.staleBounds.join(clipInfo.contentBounds);
+        if (intersects(staleBounds.join(clipInfo.readBounds), contentBounds))
+        {
+            continue;
+        }
+        clipInfo = ClipInfo(contentBounds);
+        clipInfo.staleBounds = staleBounds;
+        ++m_recycledClipIDCount;
+        return m_lastGeneratedClipID = clipID;
     }
     return 0; // There are no available clip IDs. The caller should flush and try again.
 }
@@ -298,33 +1225,119 @@ PLSRenderContext::LogicalFlush::ClipInfo& PLSRenderContext::LogicalFlush::getWri
     return m_clips[clipID - 1];
 }
 
-void PLSRenderContext::LogicalFlush::addClipReadBounds(uint32_t clipID, const IAABB& bounds)
+bool PLSRenderContext::LogicalFlush::addClipReadBounds(uint32_t clipID, const IAABB& bounds)
 {
     assert(clipID > 0);
     assert(clipID <= m_clips.size());
     ClipInfo& clipInfo = getWritableClipInfo(clipID);
+    if (intersects(clipInfo.staleBounds, bounds))
+    {
+        return false;
+    }
     clipInfo.readBounds = clipInfo.readBounds.join(bounds);
+    return true;
 }
 
 bool PLSRenderContext::pushDrawBatch(PLSDrawUniquePtr draws[], size_t drawCount)
 {
     assert(m_didBeginFrame);
     assert(!m_logicalFlushes.empty());
+    if (m_frameDrawStreamIsHashable)
+    {
+        // Hash before the push moves the draws out of the array. (If the batch doesn't fit, it
+        // gets hashed again on the retry, which an identical frame will do identically.)
+        m_frameDrawStreamHash.write(drawCount);
+        for (size_t i = 0; i < drawCount; ++i)
+        {
+            if (!draws[i]->hashContent(&m_frameDrawStreamHash))
+            {
+                m_frameDrawStreamIsHashable = false;
+                break;
+            }
+            if (!m_frameOverwritesRenderTarget && drawOverwritesRenderTarget(draws[i].get()))
+            {
+                // Everything from here on draws on top of known contents.
+                m_frameOverwritesRenderTarget = true;
+            }
+        }
+    }
     return m_logicalFlushes.back()->pushDrawBatch(draws, drawCount);
 }
 
+// In atomic mode with bindless textures, paths sample their image paints through the handle in
+// PaintAuxData instead of the per-draw texture binding, so different images can share a batch.
+static bool uses_bindless_image_paints(pls::InterlockMode interlockMode,
+                                       const pls::PlatformFeatures& platformFeatures)
+{
+    return interlockMode == pls::InterlockMode::atomics &&
+           platformFeatures.supportsBindlessTextures;
+}
+
+// Packs the fields of a draw's sort key that don't depend on the rest of the draw list. (See
+// kDrawGroupShift.)
+static int64_t draw_sort_key_bits(const PLSDraw* draw, bool bindlessImagePaints)
+{
+    // Within sub-groups of non-overlapping draws, sort similar draw types together.
+    int64_t drawType = static_cast<int64_t>(draw->type());
+    assert(drawType <= kDrawTypeMask >> kDrawTypeShift);
+    int64_t keyBits = drawType << kDrawTypeShift;
+
+    // Within sub-groups of matching draw type, sort by texture binding. (Bindless image paints
+    // don't have a texture binding. Image rects and meshes still do.)
+    const PLSTexture* imageTexture = draw->imageTexture();
+    if (bindlessImagePaints && draw->type() != PLSDraw::Type::imageRect &&
+        draw->type() != PLSDraw::Type::imageMesh)
+    {
+        imageTexture = nullptr;
+    }
+    int64_t textureHash = imageTexture != nullptr ? imageTexture->textureResourceHash() &
+                                                        (kTextureHashMask >> kTextureHashShift)
+                                                  : 0;
+    keyBits |= textureHash << kTextureHashShift;
+
+    // If using KHR_blend_equation_advanced, we need a batching barrier between draws with
+    // different blend modes.
+    // If not using KHR_blend_equation_advanced, sorting by blend mode may still give us better
+    // branching on the GPU.
+    int64_t blendMode = pls::ConvertBlendModeToPLSBlendMode(draw->blendMode());
+    assert(blendMode <= kBlendModeMask >> kBlendModeShift);
+    keyBits |= blendMode << kBlendModeShift;
+
+    // depthStencil mode draws strokes, fills, and even/odd with different stencil settings.
+    int64_t drawContents = static_cast<int64_t>(draw->drawContents());
+    assert(drawContents <= kDrawContentsMask >> kDrawContentsShift);
+    keyBits |= drawContents << kDrawContentsShift;
+
+    assert((keyBits & kDrawTypeMask) >> kDrawTypeShift == drawType);
+    assert((keyBits & kTextureHashMask) >> kTextureHashShift == textureHash);
+    assert((keyBits & kBlendModeMask) >> kBlendModeShift == blendMode);
+    assert((keyBits & kDrawContentsMask) >> kDrawContentsShift == drawContents);
+    return keyBits;
+}
+
 bool PLSRenderContext::LogicalFlush::pushDrawBatch(PLSDrawUniquePtr draws[], size_t drawCount)
 {
     assert(!m_hasDoneLayout);
 
-    if (m_flushDesc.interlockMode == pls::InterlockMode::atomics &&
-        m_drawList.count() + drawCount > kMaxReorderedDrawCount)
+    if ((m_flushDesc.interlockMode == pls::InterlockMode::atomics &&
+         m_plsDraws.size() + drawCount > kMaxReorderedDrawCount) ||
+        (m_flushDesc.interlockMode == pls::InterlockMode::depthStencil &&
+         m_plsDraws.size() + drawCount > kMaxDepthSortedDrawCount))
     {
-        // We can only reorder 64k draws at a time since the sort key addresses them with a 16-bit
-        // index.
+        // We can only reorder so many draws at a time. (See kMaxReorderedDrawCount.)
         return false;
     }
 
+    // Interior triangulations may still be running in the background. Join them all before
+    // counting resources, so the draws within a batch get to triangulate concurrently.
+    for (size_t i = 0; i < drawCount; ++i)
+    {
+        if (draws[i]->type() == PLSDraw::Type::interiorTriangulationPath)
+        {
+            static_cast<InteriorTriangulationDraw*>(draws[i].get())->joinTriangulation();
+        }
+    }
+
     auto countsVector = m_resourceCounts.toVec();
     for (size_t i = 0; i < drawCount; ++i)
     {
@@ -337,10 +1350,10 @@ bool PLSRenderContext::LogicalFlush::pushDrawBatch(PLSDrawUniquePtr draws[], siz
     // Textures have hard size limits. If new batch doesn't fit in one of the textures, the caller
     // needs to flush and try again.
     if (countsWithNewBatch.pathCount > m_ctx->m_maxPathID ||
-        countsWithNewBatch.contourCount > kMaxContourID ||
+        countsWithNewBatch.contourCount > m_ctx->m_maxContourID ||
         countsWithNewBatch.midpointFanTessVertexCount +
                 countsWithNewBatch.outerCubicTessVertexCount >
-            kMaxTessellationVertexCountBeforePadding)
+            m_ctx->m_maxTessVertexCount - kMaxTessellationPaddingVertexCount)
     {
         return false;
     }
@@ -355,10 +1368,21 @@ bool PLSRenderContext::LogicalFlush::pushDrawBatch(PLSDrawUniquePtr draws[], siz
         }
     }
 
+    bool bindlessImagePaints =
+        uses_bindless_image_paints(m_ctx->frameInterlockMode(), m_ctx->platformFeatures());
     for (size_t i = 0; i < drawCount; ++i)
     {
+        const IAABB& pixelBounds = draws[i]->pixelBounds();
+        m_drawPixelArea += static_cast<uint64_t>(pixelBounds.width()) * pixelBounds.height();
+        if (draws[i]->blendMode() != BlendMode::srcOver)
+        {
+            ++m_nonSrcOverDrawCount;
+        }
+        m_combinedDrawBounds = m_combinedDrawBounds.join(pixelBounds);
+        m_drawPixelBounds.push_back(pixelBounds);
+        m_drawOccluderBounds.push_back(draws[i]->occluderBounds());
+        m_drawSortKeyBits.push_back(draw_sort_key_bits(draws[i].get(), bindlessImagePaints));
         m_plsDraws.push_back(std::move(draws[i]));
-        m_combinedDrawBounds = m_combinedDrawBounds.join(m_plsDraws.back()->pixelBounds());
     }
 
     m_resourceCounts = countsWithNewBatch;
@@ -374,7 +1398,15 @@ bool PLSRenderContext::LogicalFlush::allocateGradient(const PLSGradient* gradien
     const float* stops = gradient->stops();
     size_t stopCount = gradient->count();
 
-    if (stopCount == 2 && stops[0] == 0 && stops[1] == 1)
+    if (stopCount == 2 && stops[0] == 0 && stops[1] == 1 &&
+        m_ctx->frameInterlockMode() == pls::InterlockMode::atomics)
+    {
+        // Atomic fragment shaders already fetch the paint's PaintAuxData, so they interpolate
+        // simple gradients directly from the two colors stored there. (The other modes would need
+        // extra varyings on every path for this, so they still use the gradient texture.)
+        *colorRampLocation = pls::ColorRampLocation::MakeAnalytic();
+    }
+    else if (stopCount == 2 && stops[0] == 0 && stops[1] == 1)
     {
         // This is a simple gradient that can be implemented by a two-texel color ramp.
         uint64_t simpleKey;
@@ -388,8 +1420,7 @@ bool PLSRenderContext::LogicalFlush::allocateGradient(const PLSGradient* gradien
         }
         else
         {
-            if (gradient_data_height(m_simpleGradients.size() + 1, m_complexGradients.size()) >
-                kMaxTextureHeight)
+            if (m_simpleGradients.size() >= kMaxSimpleGradientsPerFlush)
             {
                 // We ran out of rows in the gradient texture. Caller has to flush and try again.
                 return false;
@@ -403,32 +1434,36 @@ bool PLSRenderContext::LogicalFlush::allocateGradient(const PLSGradient* gradien
     }
     else
     {
-        // This is a complex gradient. Render it to an entire row of the gradient texture.
+        // This is a complex gradient. It occupies a slot in the gradient atlas.
         GradientContentKey key(ref_rcp(gradient));
         auto iter = m_complexGradients.find(key);
-        uint16_t row;
         if (iter != m_complexGradients.end())
         {
-            row = iter->second; // This gradient is already in the texture.
+            *colorRampLocation = iter->second; // This flush already references the gradient.
         }
         else
         {
-            if (gradient_data_height(m_simpleGradients.size(), m_complexGradients.size() + 1) >
-                kMaxTextureHeight)
+            bool needsRender;
+            if (!m_ctx->allocateComplexGradientAtlasSlot(gradient,
+                                                         m_gradientAtlasFlushID,
+                                                         colorRampLocation,
+                                                         &needsRender))
             {
-                // We ran out of rows in the gradient texture. Caller has to flush and try again.
+                // We ran out of rows in the gradient atlas. Caller has to flush and try again.
                 return false;
             }
 
-            size_t spanCount = stopCount + 1;
-            counters->complexGradientSpanCount += spanCount;
-
-            row = static_cast<uint32_t>(m_complexGradients.size());
-            m_complexGradients.emplace(std::move(key), row);
-            m_pendingComplexColorRampDraws.push_back(gradient);
+            if (needsRender)
+            {
+                // The atlas slot is new or was just evicted. Render the color ramp into it.
+                size_t spanCount = stopCount + 1;
+                counters->complexGradientSpanCount += spanCount;
+                m_pendingComplexColorRampDraws.push_back({gradient, *colorRampLocation});
+                m_minPendingAtlasRow = std::min(m_minPendingAtlasRow, colorRampLocation->row);
+                m_maxPendingAtlasRow = std::max(m_maxPendingAtlasRow, colorRampLocation->row);
+            }
+            m_complexGradients.emplace(std::move(key), *colorRampLocation);
         }
-        colorRampLocation->row = row;
-        colorRampLocation->col = ColorRampLocation::kComplexGradientMarker;
     }
     return true;
 }
@@ -448,12 +1483,52 @@ void PLSRenderContext::logicalFlush()
 
 void PLSRenderContext::flush(const FlushResources& flushResources)
 {
+    PLS_TRACE_SCOPE("PLSRenderContext::flush");
     assert(m_didBeginFrame);
+    if (m_resolutionScaleRenderTarget != nullptr)
+    {
+        // Render into the reduced-resolution layer, then stretch it over the client's target.
+        if (flushResources.renderTarget == m_lastHashedRenderTarget)
+        {
+            m_hasLastFrameHash = false;
+        }
+        rcp<PLSRenderTarget> scaledRenderTarget = std::move(m_resolutionScaleRenderTarget);
+        FlushResources scaledFlushResources = flushResources;
+        scaledFlushResources.renderTarget = scaledRenderTarget.get();
+        flush(scaledFlushResources);
+        waitForPendingSubmission();
+        m_impl->upscaleLayer(m_resolutionScaleTexture.get(),
+                             flushResources.renderTarget,
+                             flushResources.externalCommandBuffer);
+        return;
+    }
     assert(flushResources.renderTarget->width() == m_frameDescriptor.renderTargetWidth);
     assert(flushResources.renderTarget->height() == m_frameDescriptor.renderTargetHeight);
 
+    if (m_frameDescriptor.overdrawHeatmap)
+    {
+        drawOverdrawHeatmap();
+    }
+
     m_clipContentID = 0;
 
+    if (isUnchangedFrame(flushResources.renderTarget))
+    {
+        // The render target already holds this exact frame.
+        m_lastFrameStats.frameNumber = m_frameNumber;
+        m_lastFrameStats.skippedUnchangedFrame = true;
+        // Nothing gets recorded, but the client still submits externalCommandBuffer, which signals
+        // the fence. Track it like any other frame so frame pacing and waitForFramesInFlight()
+        // still account for this one.
+        trackFrameCompletionFence(flushResources.frameCompletionFence);
+        m_firstLogicalFlushOfTarget = 0;
+        releaseFrameDraws();
+        ageRetainedData();
+        m_frameDescriptor = FrameDescriptor();
+        RIVE_DEBUG_CODE(m_didBeginFrame = false;)
+        return;
+    }
+
     // Layout this frame's resource buffers and textures.
     LogicalFlush::ResourceCounters totalFrameResourceCounts;
     LogicalFlush::LayoutCounters layoutCounts;
@@ -466,7 +1541,10 @@ void PLSRenderContext::flush(const FlushResources& flushResources)
                                              &layoutCounts);
     }
     assert(layoutCounts.maxGradTextureHeight <= kMaxTextureHeight);
-    assert(layoutCounts.maxTessTextureHeight <= kMaxTextureHeight);
+    assert(layoutCounts.maxTessTextureHeight <= m_maxTessTextureHeight);
+
+    // The previous frame may still be encoding from the buffers we're about to resize and map.
+    waitForPendingSubmission();
 
     // Determine the minimum required resource allocation sizes to service this flush.
     ResourceAllocationCounts allocs;
@@ -496,76 +1574,140 @@ void PLSRenderContext::flush(const FlushResources& flushResources)
 
     // Grow resources enough to handle this flush.
     // If "allocs" already fits in our current allocations, then don't change them.
-    // If they don't fit, overallocate by 25% in order to create some slack for growth.
+    // If they don't fit, overallocate by the policy's growth factor in order to create some slack
+    // for growth.
+    const ResourceAllocationPolicy& policy = m_resourceAllocationPolicy;
     allocs = simd::if_then_else(allocs.toVec() <= m_currentResourceAllocations.toVec(),
                                 m_currentResourceAllocations.toVec(),
-                                allocs.toVec() * size_t(5) / size_t(4));
+                                scale_resource_counts(allocs.toVec(), policy.growthFactor));
 
-    // Additionally, every 5 seconds, trim resources down to the most recent steady-state usage.
+    // Additionally, every trim interval, trim resources down to the most recent steady-state usage.
     double flushTime = m_impl->secondsNow();
-    bool needsResourceTrim = flushTime - m_lastResourceTrimTimeInSeconds >= 5;
+    updateTessellationQualityGovernor(flushTime);
+    bool needsResourceTrim =
+        flushTime - m_lastResourceTrimTimeInSeconds >= policy.trimIntervalInSeconds;
     if (needsResourceTrim)
     {
-        // Trim GPU resource allocations to 125% of their maximum recent usage, and only if the
-        // recent usage is 2/3 or less of the current allocation.
-        allocs = simd::if_then_else(m_maxRecentResourceRequirements.toVec() <=
-                                        allocs.toVec() * size_t(2) / size_t(3),
-                                    m_maxRecentResourceRequirements.toVec() * size_t(5) / size_t(4),
-                                    allocs.toVec());
+        // Trim GPU resource allocations to a multiple of their maximum recent usage, and only if
+        // the recent usage is a small enough fraction of the current allocation. Never trim below
+        // the client's reservation.
+        allocs = simd::if_then_else(
+            m_maxRecentResourceRequirements.toVec() <=
+                scale_resource_counts(allocs.toVec(), policy.trimThreshold),
+            simd::max(scale_resource_counts(m_maxRecentResourceRequirements.toVec(),
+                                            policy.trimmedSizeFactor),
+                      m_reservedResourceAllocations.toVec()),
+            allocs.toVec());
 
         // Zero out m_maxRecentResourceRequirements for the next interval.
         m_maxRecentResourceRequirements = ResourceAllocationCounts();
         m_lastResourceTrimTimeInSeconds = flushTime;
     }
+    else if (m_impl->isOverMemoryBudget())
+    {
+        // Give up all slack right away. m_maxRecentResourceRequirements keeps accumulating until
+        // the next interval, so frames that stay over budget settle on the same sizes instead of
+        // reallocating every time their needs fluctuate.
+        allocs = simd::max(m_maxRecentResourceRequirements.toVec(),
+                           m_reservedResourceAllocations.toVec());
+    }
 
     setResourceSizes(allocs);
 
     // Write out the GPU buffers for this frame.
     mapResourceBuffers(allocs);
 
-    for (const auto& flush : m_logicalFlushes)
+    // Each logical flush writes to its own ranges of the mapped buffers, so they can write their
+    // resources concurrently if the client gave us the means to. The granularity is a whole
+    // logical flush: path IDs, tessellation locations and span line breaks depend on the sorted
+    // push order that writeResources() decides, so a single flush is always written serially.
+    if (flushResources.parallelFor != nullptr && m_logicalFlushes.size() > 1 &&
+        !m_recordingThreadAllocators.empty())
     {
-        flush->writeResources();
+        flushResources.parallelFor(m_logicalFlushes.size(), [this](size_t threadIdx, size_t i) {
+            m_logicalFlushes[i]->writeResources(&recordingThreadAllocators(threadIdx));
+        });
+    }
+    else
+    {
+        for (const auto& flush : m_logicalFlushes)
+        {
+            flush->writeResources(m_drawAllocators.get());
+        }
     }
-
-    assert(m_flushUniformData.elementsWritten() == m_logicalFlushes.size());
-    assert(m_imageDrawUniformData.elementsWritten() == totalFrameResourceCounts.imageDrawCount);
-    assert(m_pathData.elementsWritten() ==
-           totalFrameResourceCounts.pathCount + layoutCounts.pathPaddingCount);
-    assert(m_paintData.elementsWritten() ==
-           totalFrameResourceCounts.pathCount + layoutCounts.paintPaddingCount);
-    assert(m_paintAuxData.elementsWritten() ==
-           totalFrameResourceCounts.pathCount + layoutCounts.paintAuxPaddingCount);
-    assert(m_contourData.elementsWritten() ==
-           totalFrameResourceCounts.contourCount + layoutCounts.contourPaddingCount);
-    assert(m_simpleColorRampsData.elementsWritten() == layoutCounts.simpleGradCount);
-    assert(m_gradSpanData.elementsWritten() ==
-           totalFrameResourceCounts.complexGradientSpanCount + layoutCounts.gradSpanPaddingCount);
-    assert(m_tessSpanData.elementsWritten() <= totalFrameResourceCounts.maxTessellatedSegmentCount);
-    assert(m_triangleVertexData.elementsWritten() <=
-           totalFrameResourceCounts.maxTriangleVertexCount);
 
     unmapResourceBuffers();
 
+    updateFrameStats(allocs);
+
+    if (m_recordsShaderVariants)
+    {
+        for (const auto& flush : m_logicalFlushes)
+        {
+            recordShaderVariants(flush->desc());
+        }
+    }
+
     // Issue logical flushes to the backend.
-    for (const auto& flush : m_logicalFlushes)
+    bool isPipelined = m_submissionThread != nullptr && !m_logicalFlushes.empty() &&
+                       flushResources.externalCommandBuffer == nullptr;
+    if (isPipelined)
+    {
+        // Freeze the frame and let the submission thread encode it. Recording continues with the
+        // previous frame's (already rewound) containers, or fresh ones the first time around.
+        assert(!m_hasPendingSubmission);
+#ifdef DEBUG
+        for (const auto& flush : m_logicalFlushes)
+        {
+            flush->unlockRawPathMutations();
+        }
+#endif
+        std::swap(m_logicalFlushes, m_pipelinedFrame.logicalFlushes);
+        std::swap(m_drawAllocators, m_pipelinedFrame.drawAllocators);
+        std::swap(m_recordingThreadAllocators, m_pipelinedFrame.recordingThreadAllocators);
+        if (m_drawAllocators == nullptr)
+        {
+            m_drawAllocators = std::make_unique<DrawAllocators>();
+        }
+        m_recordingThreadAllocators.resize(m_pipelinedFrame.recordingThreadAllocators.size());
+        for (auto& recordingThreadAllocators : m_recordingThreadAllocators)
+        {
+            if (recordingThreadAllocators == nullptr)
+            {
+                recordingThreadAllocators = std::make_unique<DrawAllocators>();
+            }
+        }
+        m_submissionThread->post([this]() {
+            for (const auto& flush : m_pipelinedFrame.logicalFlushes)
+            {
+                flush->submit(m_impl.get());
+            }
+        });
+        m_hasPendingSubmission = true;
+    }
+    else
     {
-        m_impl->flush(flush->desc());
+        for (const auto& flush : m_logicalFlushes)
+        {
+            flush->submit(m_impl.get());
+        }
     }
 
-    if (!m_logicalFlushes.empty())
+    trackFrameCompletionFence(flushResources.frameCompletionFence);
+
+    m_firstLogicalFlushOfTarget = 0;
+    if (!isPipelined)
     {
-        m_logicalFlushes.resize(1);
-        m_logicalFlushes.front()->rewind();
+        releaseFrameDraws();
+    }
+    else if (m_asyncTriangulator != nullptr)
+    {
+        // Every triangulation was joined when its draw got pushed, and nothing reads them after
+        // writeResources().
+        m_asyncTriangulator->reset();
     }
 
-    // Drop all memory that was allocated for this frame using TrivialBlockAllocator.
-    m_perFrameAllocator.reset();
-    m_numChopsAllocator.reset();
-    m_chopVerticesAllocator.reset();
-    m_tangentPairsAllocator.reset();
-    m_polarSegmentCountsAllocator.reset();
-    m_parametricSegmentCountsAllocator.reset();
+    ageRetainedData();
 
     m_frameDescriptor = FrameDescriptor();
 
@@ -578,16 +1720,335 @@ void PLSRenderContext::flush(const FlushResources& flushResources)
     }
 }
 
+void PLSRenderContext::releaseFrameDraws()
+{
+    if (!m_logicalFlushes.empty())
+    {
+        m_logicalFlushes.resize(1);
+        m_logicalFlushes.front()->rewind();
+    }
+
+    // Drop all memory that was allocated for this frame using TrivialBlockAllocator.
+    m_drawAllocators->reset();
+    if (m_asyncTriangulator != nullptr)
+    {
+        // Every triangulation was joined when its draw got pushed (or released).
+        m_asyncTriangulator->reset();
+    }
+    for (const auto& recordingThreadAllocators : m_recordingThreadAllocators)
+    {
+        recordingThreadAllocators->reset();
+    }
+}
+
+bool PLSRenderContext::drawOverwritesRenderTarget(const PLSDraw* draw) const
+{
+    // Occluders are opaque, srcOver draws, so they replace whatever was underneath them.
+    const IAABB& occluder = draw->occluderBounds();
+    if (occluder.empty() || draw->clipID() != 0)
+    {
+        return false;
+    }
+    IAABB updateBounds = {0,
+                          0,
+                          static_cast<int32_t>(m_frameDescriptor.renderTargetWidth),
+                          static_cast<int32_t>(m_frameDescriptor.renderTargetHeight)};
+    if (frameHasDirtyBounds())
+    {
+        // Pixels outside the dirty bounds aren't touched at all, so they don't need covering.
+        updateBounds = updateBounds.intersect(m_frameDescriptor.dirtyBounds);
+    }
+    if (draw->hasClipRect() && draw->clipRectInverseMatrix() != m_dirtyBoundsClipRect)
+    {
+        return false;
+    }
+    int4 occluderBounds = simd::load4i(&occluder);
+    int4 targetBounds = simd::load4i(&updateBounds);
+    return simd::all(occluderBounds.xy <= targetBounds.xy && occluderBounds.zw >= targetBounds.zw);
+}
+
+bool PLSRenderContext::isUnchangedFrame(const PLSRenderTarget* renderTarget)
+{
+    if (!m_frameDrawStreamIsHashable)
+    {
+        // Whatever this frame renders invalidates the hash of the target's contents.
+        if (renderTarget == m_lastHashedRenderTarget)
+        {
+            m_hasLastFrameHash = false;
+        }
+        return false;
+    }
+    uint64_t frameHash = m_frameDrawStreamHash.hash();
+    if (m_hasLastFrameHash && renderTarget == m_lastHashedRenderTarget &&
+        frameHash == m_lastFrameHash && m_frameOverwritesRenderTarget)
+    {
+        // The same draws on top of the same starting contents leave the target unchanged. (If any
+        // pixel's starting contents come from the previous frame instead, translucent or
+        // non-srcOver draws would build up on them, so the frame has to actually be drawn.)
+        return true;
+    }
+    m_lastHashedRenderTarget = renderTarget;
+    m_lastFrameHash = frameHash;
+    m_hasLastFrameHash = true;
+    return false;
+}
+
+void PLSRenderContext::nextTarget(PLSRenderTarget* renderTarget)
+{
+    assert(m_didBeginFrame);
+    assert(!frameIsResolutionScaled());
+    assert(m_layerRenderTarget == nullptr);
+    assert(renderTarget->width() == m_frameDescriptor.renderTargetWidth);
+    assert(renderTarget->height() == m_frameDescriptor.renderTargetHeight);
+    m_frameDrawStreamIsHashable = false; // Only one target's contents are tracked.
+    if (renderTarget == m_lastHashedRenderTarget)
+    {
+        m_hasLastFrameHash = false;
+    }
+
+    // Every logical flush since the previous target change (there may be several, if the draws
+    // overflowed a flush's resource limits) renders into renderTarget.
+    for (size_t i = m_firstLogicalFlushOfTarget; i < m_logicalFlushes.size(); ++i)
+    {
+        m_logicalFlushes[i]->setRenderTarget(renderTarget);
+    }
+
+    logicalFlush();
+    m_firstLogicalFlushOfTarget = m_logicalFlushes.size() - 1;
+    m_logicalFlushes.back()->setIsFirstFlushOfTarget();
+}
+
+void PLSRenderContext::beginResolutionScaledFrame()
+{
+    float scale = std::max(m_frameDescriptor.resolutionScale, kMinResolutionScale);
+    uint32_t fullWidth = m_frameDescriptor.renderTargetWidth;
+    uint32_t fullHeight = m_frameDescriptor.renderTargetHeight;
+    uint32_t width = std::max(static_cast<uint32_t>(ceilf(fullWidth * scale)), 1u);
+    uint32_t height = std::max(static_cast<uint32_t>(ceilf(fullHeight * scale)), 1u);
+    if (m_cachedResolutionScaleRenderTarget == nullptr ||
+        m_cachedResolutionScaleRenderTarget->width() != width ||
+        m_cachedResolutionScaleRenderTarget->height() != height)
+    {
+        waitForPendingSubmission();
+        m_cachedResolutionScaleRenderTarget =
+            m_impl->makeLayerRenderTarget(width, height, &m_resolutionScaleTexture);
+        if (m_cachedResolutionScaleRenderTarget == nullptr)
+        {
+            return; // Render at full resolution instead.
+        }
+    }
+    m_resolutionScaleRenderTarget = m_cachedResolutionScaleRenderTarget;
+    m_frameDescriptor.renderTargetWidth = width;
+    m_frameDescriptor.renderTargetHeight = height;
+    m_frameResolutionScaleMatrix = Mat2D(static_cast<float>(width) / fullWidth,
+                                         0,
+                                         0,
+                                         static_cast<float>(height) / fullHeight,
+                                         0,
+                                         0);
+}
+
+bool PLSRenderContext::beginLayer(uint32_t width, uint32_t height, ColorInt clearColor)
+{
+    assert(!m_didBeginFrame);
+    assert(m_layerRenderTarget == nullptr);
+    waitForPendingSubmission();
+    m_layerRenderTarget = m_impl->makeLayerRenderTarget(width, height, &m_layerTexture);
+    if (m_layerRenderTarget == nullptr)
+    {
+        return false;
+    }
+    assert(m_layerTexture != nullptr);
+    beginFrame({
+        .renderTargetWidth = width,
+        .renderTargetHeight = height,
+        .loadAction = LoadAction::clear,
+        .clearColor = clearColor,
+    });
+    return true;
+}
+
+rcp<PLSTexture> PLSRenderContext::endLayer(const FlushResources& flushResources)
+{
+    assert(m_didBeginFrame);
+    assert(m_layerRenderTarget != nullptr);
+    FlushResources layerFlushResources = flushResources;
+    layerFlushResources.renderTarget = m_layerRenderTarget.get();
+    flush(layerFlushResources);
+    m_layerRenderTarget = nullptr;
+    return std::move(m_layerTexture);
+}
+
+void PLSRenderContext::LogicalFlush::cullOccludedDraws()
+{
+    const FrameDescriptor& frameDescriptor = m_ctx->frameDescriptor();
+    const int32_t width = frameDescriptor.renderTargetWidth;
+    const int32_t height = frameDescriptor.renderTargetHeight;
+    const IAABB renderTargetBounds = {0, 0, width, height};
+    const int32_t tilesX = (width + kOcclusionTileSize - 1) / kOcclusionTileSize;
+    const int32_t tilesY = (height + kOcclusionTileSize - 1) / kOcclusionTileSize;
+
+    // Containment in the single largest occluder catches draws that don't line up with the tile
+    // grid (e.g., layers that are exactly the same size as the occluder on top of them).
+    bool hasOccluders = false;
+    IAABB largestOccluder = {0, 0, 0, 0};
+    int64_t largestOccluderArea = 0;
+
+    // Walk the draws back to front, so every occluder seen so far is drawn on top of the current
+    // draw.
+    for (size_t i = m_plsDraws.size() - 1; i != -1; --i)
+    {
+        // Never cull clip updates or stencil clip resets: later draws may still read the clip.
+        const int64_t keyBits = m_drawSortKeyBits[i];
+        auto drawType = static_cast<PLSDraw::Type>((keyBits & kDrawTypeMask) >> kDrawTypeShift);
+        auto drawContents = static_cast<pls::DrawContents>((keyBits & kDrawContentsMask) >>
+                                                           kDrawContentsShift);
+        if (hasOccluders && !(drawContents & pls::DrawContents::clipUpdate) &&
+            drawType != PLSDraw::Type::stencilClipReset)
+        {
+            IAABB bounds = m_drawPixelBounds[i].intersect(renderTargetBounds);
+            bool isOccluded = !bounds.empty() && bounds.left >= largestOccluder.left &&
+                              bounds.top >= largestOccluder.top &&
+                              bounds.right <= largestOccluder.right &&
+                              bounds.bottom <= largestOccluder.bottom;
+            if (!isOccluded && !bounds.empty())
+            {
+                isOccluded = true;
+                for (int32_t y = bounds.top / kOcclusionTileSize;
+                     isOccluded && y <= (bounds.bottom - 1) / kOcclusionTileSize;
+                     ++y)
+                {
+                    for (int32_t x = bounds.left / kOcclusionTileSize;
+                         x <= (bounds.right - 1) / kOcclusionTileSize;
+                         ++x)
+                    {
+                        if (!m_occludedTiles[y * tilesX + x])
+                        {
+                            isOccluded = false;
+                            break;
+                        }
+                    }
+                }
+            }
+            if (isOccluded)
+            {
+                // The draw is completely hidden. Drop it along with the resources it would have
+                // written. (Its gradient, if any, keeps its slot in the gradient texture.)
+                m_resourceCounts =
+                    m_resourceCounts.toVec() - m_plsDraws[i]->resourceCounts().toVec();
+                m_plsDraws[i].reset();
+                ++m_culledDrawCount;
+                continue;
+            }
+        }
+
+        IAABB occluder = m_drawOccluderBounds[i];
+        if (occluder.empty())
+        {
+            continue;
+        }
+        const PLSDraw* draw = m_plsDraws[i].get();
+        if (draw->clipID() != 0)
+        {
+            continue;
+        }
+        if (draw->hasClipRect())
+        {
+            // The only clip rect an occluder can have is the frame's dirty bounds.
+            if (draw->clipRectInverseMatrix() != m_ctx->m_dirtyBoundsClipRect)
+            {
+                continue;
+            }
+            occluder = occluder.intersect(frameDescriptor.dirtyBounds);
+        }
+        occluder = occluder.intersect(renderTargetBounds);
+        if (occluder.empty())
+        {
+            continue;
+        }
+
+        int64_t area = static_cast<int64_t>(occluder.right - occluder.left) *
+                       (occluder.bottom - occluder.top);
+        if (area > largestOccluderArea)
+        {
+            largestOccluder = occluder;
+            largestOccluderArea = area;
+        }
+
+        // Mark every tile whose on-screen portion lies entirely inside the occluder.
+        if (!hasOccluders)
+        {
+            m_occludedTiles.assign(tilesX * tilesY, 0);
+            hasOccluders = true;
+        }
+        int32_t x0 = (occluder.left + kOcclusionTileSize - 1) / kOcclusionTileSize;
+        int32_t y0 = (occluder.top + kOcclusionTileSize - 1) / kOcclusionTileSize;
+        int32_t x1 = occluder.right == width ? tilesX : occluder.right / kOcclusionTileSize;
+        int32_t y1 = occluder.bottom == height ? tilesY : occluder.bottom / kOcclusionTileSize;
+        for (int32_t y = y0; y < y1; ++y)
+        {
+            for (int32_t x = x0; x < x1; ++x)
+            {
+                m_occludedTiles[y * tilesX + x] = 1;
+            }
+        }
+    }
+
+    if (m_culledDrawCount != 0)
+    {
+        // Compact the draw list and its per-draw tables together, so they stay indexed the same.
+        // Also recompute the bounds and statistics that pushDrawBatch() accumulated, so culled
+        // draws don't widen the render target's update bounds or inflate FrameStats.
+        m_combinedDrawBounds = {std::numeric_limits<int32_t>::max(),
+                                std::numeric_limits<int32_t>::max(),
+                                std::numeric_limits<int32_t>::min(),
+                                std::numeric_limits<int32_t>::min()};
+        m_drawPixelArea = 0;
+        m_nonSrcOverDrawCount = 0;
+        size_t drawCount = 0;
+        for (size_t i = 0; i < m_plsDraws.size(); ++i)
+        {
+            if (m_plsDraws[i] == nullptr)
+            {
+                continue;
+            }
+            if (drawCount != i)
+            {
+                m_plsDraws[drawCount] = std::move(m_plsDraws[i]);
+                m_drawPixelBounds[drawCount] = m_drawPixelBounds[i];
+                m_drawSortKeyBits[drawCount] = m_drawSortKeyBits[i];
+            }
+            const IAABB& pixelBounds = m_drawPixelBounds[drawCount];
+            m_drawPixelArea += static_cast<uint64_t>(pixelBounds.width()) * pixelBounds.height();
+            if (m_plsDraws[drawCount]->blendMode() != BlendMode::srcOver)
+            {
+                ++m_nonSrcOverDrawCount;
+            }
+            m_combinedDrawBounds = m_combinedDrawBounds.join(pixelBounds);
+            ++drawCount;
+        }
+        m_plsDraws.resize(drawCount);
+        m_drawPixelBounds.resize(drawCount);
+        m_drawSortKeyBits.resize(drawCount);
+    }
+    // Occluders are only needed for culling.
+    m_drawOccluderBounds.clear();
+}
+
 void PLSRenderContext::LogicalFlush::layoutResources(const FlushResources& flushResources,
                                                      size_t logicalFlushIdx,
                                                      bool isFinalFlushOfFrame,
                                                      ResourceCounters* runningFrameResourceCounts,
                                                      LayoutCounters* runningFrameLayoutCounts)
 {
+    PLS_TRACE_SCOPE("LogicalFlush::layoutResources");
     assert(!m_hasDoneLayout);
 
     const FrameDescriptor& frameDescriptor = m_ctx->frameDescriptor();
 
+    // Drop hidden draws before anything gets allocated for them.
+    cullOccludedDraws();
+
     // Reserve a path record for the clearColor paint (used by atomic mode).
     // This also allows us to index the storage buffers directly by pathID.
     ++m_resourceCounts.pathCount;
@@ -630,7 +2091,7 @@ void PLSRenderContext::LogicalFlush::layoutResources(const FlushResources& flush
         totalTessVertexCountWithPadding = m_outerCubicTessEndLocation + kPostPadding;
 
         assert(kPrePadding + interiorPadding + kPostPadding <= kMaxTessellationPaddingVertexCount);
-        assert(totalTessVertexCountWithPadding <= kMaxTessellationVertexCount);
+        assert(totalTessVertexCountWithPadding <= m_ctx->m_maxTessVertexCount);
     }
 
     uint32_t tessDataHeight =
@@ -649,17 +2110,20 @@ void PLSRenderContext::LogicalFlush::layoutResources(const FlushResources& flush
             maxSpanBreakCount + kPaddingSpanCount + kMaxTessellationAlignmentVertices;
     }
 
-    m_flushDesc.renderTarget = flushResources.renderTarget;
+    m_flushDesc.renderTarget =
+        m_renderTarget != nullptr ? m_renderTarget : flushResources.renderTarget;
     m_flushDesc.interlockMode = m_ctx->frameInterlockMode();
+    m_flushDesc.compactTessVertexSpans = m_ctx->frameUsesCompactTessVertexSpans();
+    m_flushDesc.gpuTessellationSpans = m_ctx->frameUsesGPUTessellationSpans();
     m_flushDesc.msaaSampleCount = frameDescriptor.msaaSampleCount;
 
     // In atomic mode, we may be able to skip the explicit clear of the color buffer and fold it
     // into the atomic "resolve" operation instead.
     bool doClearDuringAtomicResolve = false;
 
-    if (logicalFlushIdx != 0)
+    if (logicalFlushIdx != 0 && !m_isFirstFlushOfTarget)
     {
-        // We always have to preserve the renderTarget between logical flushes.
+        // We always have to preserve the renderTarget between logical flushes of one target.
         m_flushDesc.colorLoadAction = pls::LoadAction::preserveRenderTarget;
     }
     else if (frameDescriptor.loadAction == pls::LoadAction::clear)
@@ -713,11 +2177,19 @@ void PLSRenderContext::LogicalFlush::layoutResources(const FlushResources& flush
         m_flushDesc.renderTargetUpdateBounds =
             m_flushDesc.renderTarget->bounds().intersect(m_combinedDrawBounds);
     }
+    if (m_ctx->frameHasDirtyBounds())
+    {
+        // Dirty-bounds frames never update pixels outside the dirty region.
+        m_flushDesc.renderTargetUpdateBounds =
+            m_flushDesc.renderTargetUpdateBounds.intersect(frameDescriptor.dirtyBounds);
+    }
     if (m_flushDesc.renderTargetUpdateBounds.empty())
     {
         // If this is empty it means there are no draws and no clear.
         m_flushDesc.renderTargetUpdateBounds = {0, 0, 0, 0};
     }
+    m_flushDesc.hasPartialUpdateBounds =
+        is_partial_update(m_flushDesc.renderTargetUpdateBounds, m_flushDesc.renderTarget);
 
     m_flushDesc.flushUniformDataOffsetInBytes = logicalFlushIdx * sizeof(pls::FlushUniforms);
     m_flushDesc.pathCount = m_resourceCounts.pathCount;
@@ -740,18 +2212,36 @@ void PLSRenderContext::LogicalFlush::layoutResources(const FlushResources& flush
         resource_texture_height<pls::kGradTextureWidthInSimpleRamps>(m_simpleGradients.size());
     m_flushDesc.simpleGradDataOffsetInBytes =
         runningFrameLayoutCounts->simpleGradCount * sizeof(pls::TwoTexelRamp);
-    m_flushDesc.complexGradRowsTop = m_flushDesc.simpleGradTexelsHeight;
-    m_flushDesc.complexGradRowsHeight = m_complexGradients.size();
+    // Only render the range of atlas rows that this flush actually needs to update. Rows in
+    // between keep their contents from previous flushes.
+    if (!m_pendingComplexColorRampDraws.empty())
+    {
+        m_flushDesc.complexGradRowsTop = kSimpleGradientRows + m_minPendingAtlasRow;
+        m_flushDesc.complexGradRowsHeight = m_maxPendingAtlasRow - m_minPendingAtlasRow + 1;
+    }
     m_flushDesc.tessDataHeight = tessDataHeight;
 
+    m_firstSimpleGrad = runningFrameLayoutCounts->simpleGradCount;
+    m_firstImageDraw = runningFrameResourceCounts->imageDrawCount;
+    m_tessSpanRegionStart = runningFrameResourceCounts->maxTessellatedSegmentCount;
+    m_firstTriangleVertex = runningFrameResourceCounts->maxTriangleVertexCount;
+
     m_flushDesc.externalCommandBuffer = flushResources.externalCommandBuffer;
     if (isFinalFlushOfFrame)
     {
         m_flushDesc.frameCompletionFence = flushResources.frameCompletionFence;
     }
 
+    m_flushDesc.gpuTimerFrameNumber =
+        frameDescriptor.measureGPUTime ? m_ctx->frameNumber() : 0;
     m_flushDesc.wireframe = frameDescriptor.wireframe;
+    m_flushDesc.isFirstFlushOfFrame = logicalFlushIdx == 0;
     m_flushDesc.isFinalFlushOfFrame = isFinalFlushOfFrame;
+    m_flushDesc.isFirstFlushOfRenderTarget = logicalFlushIdx == 0 || m_isFirstFlushOfTarget;
+    // The next flush either starts a new target, or there is no next flush.
+    m_flushDesc.isFinalFlushOfRenderTarget =
+        isFinalFlushOfFrame ||
+        m_ctx->m_logicalFlushes[logicalFlushIdx + 1]->m_isFirstFlushOfTarget;
 
     *runningFrameResourceCounts = runningFrameResourceCounts->toVec() + m_resourceCounts.toVec();
     runningFrameLayoutCounts->pathPaddingCount += m_pathPaddingCount;
@@ -760,9 +2250,12 @@ void PLSRenderContext::LogicalFlush::layoutResources(const FlushResources& flush
     runningFrameLayoutCounts->contourPaddingCount += m_contourPaddingCount;
     runningFrameLayoutCounts->simpleGradCount += m_simpleGradients.size();
     runningFrameLayoutCounts->gradSpanPaddingCount += m_gradSpanPaddingCount;
+    // The atlas requires the gradient texture to keep a fixed height, so its contents aren't lost
+    // to reallocation while gradients are in steady use.
     runningFrameLayoutCounts->maxGradTextureHeight =
-        std::max(m_flushDesc.simpleGradTexelsHeight + m_flushDesc.complexGradRowsHeight,
-                 runningFrameLayoutCounts->maxGradTextureHeight);
+        std::max<uint32_t>(!m_complexGradients.empty() ? kGradTextureHeightWithAtlas
+                                                       : m_flushDesc.simpleGradTexelsHeight,
+                           runningFrameLayoutCounts->maxGradTextureHeight);
     runningFrameLayoutCounts->maxTessTextureHeight =
         std::max(m_flushDesc.tessDataHeight, runningFrameLayoutCounts->maxTessTextureHeight);
 
@@ -774,72 +2267,235 @@ void PLSRenderContext::LogicalFlush::layoutResources(const FlushResources& flush
     RIVE_DEBUG_CODE(m_hasDoneLayout = true;)
 }
 
-void PLSRenderContext::LogicalFlush::writeResources()
+void PLSRenderContext::LogicalFlush::getStats(FrameStats::LogicalFlushStats* stats) const
+{
+    assert(m_hasDoneLayout);
+    stats->drawBatchCount = m_drawList.count();
+    stats->culledDrawCount = m_culledDrawCount;
+    stats->pathCount = m_resourceCounts.pathCount;
+    stats->contourCount = m_resourceCounts.contourCount;
+    stats->tessVertexCount =
+        m_resourceCounts.midpointFanTessVertexCount + m_resourceCounts.outerCubicTessVertexCount;
+    stats->maxTriangleVertexCount = m_resourceCounts.maxTriangleVertexCount;
+    stats->simpleGradientRowCount = m_flushDesc.simpleGradTexelsHeight;
+    stats->complexGradientRowCount = m_flushDesc.complexGradRowsHeight;
+    stats->drawCount = m_plsDraws.size() - m_culledDrawCount;
+    stats->drawPixelArea = m_drawPixelArea;
+    stats->nonSrcOverDrawCount = m_nonSrcOverDrawCount;
+    stats->drawGroupCount = m_drawGroupCount;
+    stats->blendBarrierCount = m_blendBarrierCount;
+    stats->recycledClipIDCount = m_recycledClipIDCount;
+}
+
+void PLSRenderContext::LogicalFlush::accumulateOverdrawHeatmap(
+    FrameStats::OverdrawHeatmap* heatmap,
+    std::vector<const PLSDraw*>* visibleDraws) const
+{
+    using Heatmap = FrameStats::OverdrawHeatmap;
+    assert(!m_hasDoneLayout);
+    const FrameDescriptor& frameDescriptor = m_ctx->frameDescriptor();
+    const IAABB renderTargetBounds = {0,
+                                      0,
+                                      static_cast<int32_t>(frameDescriptor.renderTargetWidth),
+                                      static_cast<int32_t>(frameDescriptor.renderTargetHeight)};
+    constexpr static int32_t kTileSize = Heatmap::kTileSize;
+    for (size_t i = 0; i < m_plsDraws.size(); ++i)
+    {
+        IAABB bounds = m_drawPixelBounds[i].intersect(renderTargetBounds);
+        if (bounds.empty())
+        {
+            continue;
+        }
+        visibleDraws->push_back(m_plsDraws[i].get());
+
+        // Interior triangulations shade their bounds twice: once for the outer curves and once
+        // for the triangles.
+        pls::DrawType drawTypes[2];
+        size_t drawTypeCount = 0;
+        const int64_t keyBits = m_drawSortKeyBits[i];
+        switch (static_cast<PLSDraw::Type>((keyBits & kDrawTypeMask) >> kDrawTypeShift))
+        {
+            case PLSDraw::Type::midpointFanPath:
+                drawTypes[drawTypeCount++] = pls::DrawType::midpointFanPatches;
+                break;
+            case PLSDraw::Type::interiorTriangulationPath:
+                drawTypes[drawTypeCount++] = pls::DrawType::outerCurvePatches;
+                drawTypes[drawTypeCount++] = pls::DrawType::interiorTriangulation;
+                break;
+            case PLSDraw::Type::imageRect:
+            case PLSDraw::Type::solidRect:
+                drawTypes[drawTypeCount++] = pls::DrawType::imageRect;
+                break;
+            case PLSDraw::Type::imageMesh:
+                drawTypes[drawTypeCount++] = pls::DrawType::imageMesh;
+                break;
+            case PLSDraw::Type::stencilClipReset:
+                drawTypes[drawTypeCount++] = pls::DrawType::stencilClipReset;
+                break;
+        }
+
+        for (size_t j = 0; j < drawTypeCount; ++j)
+        {
+            auto drawTypeIdx = static_cast<size_t>(drawTypes[j]);
+            std::vector<uint32_t>& tiles = heatmap->tileFragmentCounts[drawTypeIdx];
+            if (tiles.empty())
+            {
+                tiles.resize(heatmap->tilesWide * heatmap->tilesTall, 0);
+            }
+            for (int32_t ty = bounds.top / kTileSize; ty * kTileSize < bounds.bottom; ++ty)
+            {
+                int32_t tileTop = std::max(bounds.top, ty * kTileSize);
+                int32_t tileBottom = std::min(bounds.bottom, (ty + 1) * kTileSize);
+                for (int32_t tx = bounds.left / kTileSize; tx * kTileSize < bounds.right; ++tx)
+                {
+                    int32_t tileLeft = std::max(bounds.left, tx * kTileSize);
+                    int32_t tileRight = std::min(bounds.right, (tx + 1) * kTileSize);
+                    tiles[ty * heatmap->tilesWide + tx] +=
+                        (tileRight - tileLeft) * (tileBottom - tileTop);
+                }
+            }
+            heatmap->fragmentCounts[drawTypeIdx] +=
+                static_cast<uint64_t>(bounds.width()) * bounds.height();
+        }
+    }
+}
+
+void PLSRenderContext::LogicalFlush::writeResources(DrawAllocators* allocators)
 {
+    PLS_TRACE_SCOPE("LogicalFlush::writeResources");
     const pls::PlatformFeatures& platformFeatures = m_ctx->platformFeatures();
     assert(m_hasDoneLayout);
-    assert(m_flushDesc.firstPath == m_ctx->m_pathData.elementsWritten());
-    assert(m_flushDesc.firstPaint == m_ctx->m_paintData.elementsWritten());
-    assert(m_flushDesc.firstPaintAux == m_ctx->m_paintAuxData.elementsWritten());
+
+    // Carve out this flush's ranges of the mapped resource buffers.
+    m_flushUniformData = m_ctx->m_flushUniformData.subrange(
+        m_flushDesc.flushUniformDataOffsetInBytes / sizeof(pls::FlushUniforms),
+        1);
+    m_pathData = m_ctx->m_pathData.subrange(m_flushDesc.firstPath,
+                                            m_resourceCounts.pathCount + m_pathPaddingCount);
+    m_paintData = m_ctx->m_paintData.subrange(m_flushDesc.firstPaint,
+                                              m_resourceCounts.pathCount + m_paintPaddingCount);
+    m_paintAuxData =
+        m_ctx->m_paintAuxData.subrange(m_flushDesc.firstPaintAux,
+                                       m_resourceCounts.pathCount + m_paintAuxPaddingCount);
+    m_contourData =
+        m_ctx->m_contourData.subrange(m_flushDesc.firstContour,
+                                      m_resourceCounts.contourCount + m_contourPaddingCount);
+    m_simpleColorRampsData =
+        m_ctx->m_simpleColorRampsData.subrange(m_firstSimpleGrad,
+                                               m_pendingSimpleGradientWrites.size());
+    m_gradSpanData = m_ctx->m_gradSpanData.subrange(m_flushDesc.firstComplexGradSpan,
+                                                    m_resourceCounts.complexGradientSpanCount +
+                                                        m_gradSpanPaddingCount);
+    if (m_flushDesc.compactTessVertexSpans)
+    {
+        m_compactTessSpanData =
+            m_ctx->m_compactTessSpanData.subrange(m_tessSpanRegionStart,
+                                                  m_resourceCounts.maxTessellatedSegmentCount);
+    }
+    else if (m_flushDesc.gpuTessellationSpans)
+    {
+        // There is never more than one TessCurve per span, so the span region fits the curves.
+        m_tessCurveData =
+            m_ctx->m_tessCurveData.subrange(m_tessSpanRegionStart,
+                                            m_resourceCounts.maxTessellatedSegmentCount);
+    }
+    else
+    {
+        m_tessSpanData =
+            m_ctx->m_tessSpanData.subrange(m_tessSpanRegionStart,
+                                           m_resourceCounts.maxTessellatedSegmentCount);
+    }
+    m_triangleVertexData =
+        m_ctx->m_triangleVertexData.subrange(m_firstTriangleVertex,
+                                             m_resourceCounts.maxTriangleVertexCount);
+    m_imageDrawUniformData =
+        m_ctx->m_imageDrawUniformData.subrange(m_firstImageDraw, m_resourceCounts.imageDrawCount);
+    m_drawListAllocator = &allocators->perFrameAllocator();
 
     // Wait until here to layout the gradient texture because the final gradient texture height is
     // not decided until after all LogicalFlushes have run layoutResources().
     m_gradTextureLayout.inverseHeight = 1.f / m_ctx->m_currentResourceAllocations.gradTextureHeight;
-    m_gradTextureLayout.complexOffsetY = m_flushDesc.complexGradRowsTop;
+    m_gradTextureLayout.complexOffsetY = kSimpleGradientRows;
 
     // Exact tessSpan/triangleVertex counts aren't known until after their data is written out.
-    size_t firstTessVertexSpan = m_ctx->m_tessSpanData.elementsWritten();
-    size_t initialTriangleVertexDataSize = m_ctx->m_triangleVertexData.bytesWritten();
-
     // Metal requires vertex buffers to be 256-byte aligned.
-    size_t tessAlignmentPadding =
-        pls::PaddingToAlignUp<pls::kTessVertexBufferAlignmentInElements>(firstTessVertexSpan);
-    assert(tessAlignmentPadding <= kMaxTessellationAlignmentVertices);
-    m_ctx->m_tessSpanData.push_back_n(nullptr, tessAlignmentPadding);
-    m_flushDesc.firstTessVertexSpan = firstTessVertexSpan + tessAlignmentPadding;
-    assert(m_flushDesc.firstTessVertexSpan == m_ctx->m_tessSpanData.elementsWritten());
+    size_t tessAlignmentPadding = 0;
+    if (m_resourceCounts.maxTessellatedSegmentCount != 0)
+    {
+        if (m_flushDesc.compactTessVertexSpans)
+        {
+            tessAlignmentPadding =
+                pls::PaddingToAlignUp<pls::kCompactTessVertexBufferAlignmentInElements>(
+                    m_tessSpanRegionStart);
+            m_compactTessSpanData.push_back_n(nullptr, tessAlignmentPadding);
+        }
+        else if (m_flushDesc.gpuTessellationSpans)
+        {
+            tessAlignmentPadding =
+                pls::PaddingToAlignUp<pls::kTessVertexBufferAlignmentInElements>(
+                    m_tessSpanRegionStart);
+            m_tessCurveData.push_back_n(nullptr, tessAlignmentPadding);
+        }
+        else
+        {
+            tessAlignmentPadding =
+                pls::PaddingToAlignUp<pls::kTessVertexBufferAlignmentInElements>(
+                    m_tessSpanRegionStart);
+            m_tessSpanData.push_back_n(nullptr, tessAlignmentPadding);
+        }
+        assert(tessAlignmentPadding <= kMaxTessellationAlignmentVertices);
+    }
+    m_flushDesc.firstTessVertexSpan = m_tessSpanRegionStart + tessAlignmentPadding;
 
     // Write out the uniforms for this flush.
-    m_ctx->m_flushUniformData.emplace_back(m_flushDesc, platformFeatures);
+    m_flushUniformData.emplace_back(m_flushDesc, platformFeatures);
 
     // Write out the simple gradient data.
     assert(m_simpleGradients.size() == m_pendingSimpleGradientWrites.size());
     if (!m_pendingSimpleGradientWrites.empty())
     {
-        m_ctx->m_simpleColorRampsData.push_back_n(m_pendingSimpleGradientWrites.data(),
-                                                  m_pendingSimpleGradientWrites.size());
+        m_simpleColorRampsData.push_back_n(m_pendingSimpleGradientWrites.data(),
+                                           m_pendingSimpleGradientWrites.size());
     }
 
     // Write out the vertex data for rendering complex gradients.
-    assert(m_complexGradients.size() == m_pendingComplexColorRampDraws.size());
+    assert(m_complexGradients.size() >= m_pendingComplexColorRampDraws.size());
     if (!m_pendingComplexColorRampDraws.empty())
     {
-        // The viewport will start at simpleGradDataHeight when rendering color ramps.
-        for (uint32_t y = 0; y < m_pendingComplexColorRampDraws.size(); ++y)
+        // The viewport will start at complexGradRowsTop when rendering color ramps.
+        for (const PendingColorRampDraw& draw : m_pendingComplexColorRampDraws)
         {
-            const PLSGradient* gradient = m_pendingComplexColorRampDraws[y];
+            const PLSGradient* gradient = draw.gradient;
+            uint32_t y = draw.location.row - m_minPendingAtlasRow;
+            uint32_t left = draw.location.complexCol();
+            uint32_t right = left + draw.location.complexWidth();
             const ColorInt* colors = gradient->colors();
             const float* stops = gradient->stops();
             size_t stopCount = gradient->count();
 
             // Push "GradientSpan" instances that will render each section of the color ramp.
+            constexpr static uint32_t kFixedPerTexel = 65536 / kGradTextureWidth;
             ColorInt lastColor = colors[0];
-            uint32_t lastXFixed = 0;
-            // "stop * w + .5" converts a stop position to an x-coordinate in the gradient texture.
-            // Stops should be aligned (ideally) on pixel centers to prevent bleed.
+            uint32_t lastXFixed = left * kFixedPerTexel;
+            // "left + stop * w + .5" converts a stop position to an x-coordinate in the gradient
+            // texture. Stops should be aligned (ideally) on pixel centers to prevent bleed.
             // Render half-pixel-wide caps at the beginning and end to ensure the boundary pixels
             // get filled.
-            float w = kGradTextureWidth - 1.f;
+            float w = (right - left) - 1.f;
             for (size_t i = 0; i < stopCount; ++i)
             {
-                float x = stops[i] * w + .5f;
+                float x = left + stops[i] * w + .5f;
                 uint32_t xFixed = static_cast<uint32_t>(x * (65536.f / kGradTextureWidth));
                 assert(lastXFixed <= xFixed && xFixed < 65536); // stops[] must be ordered.
-                m_ctx->m_gradSpanData.set_back(lastXFixed, xFixed, y, lastColor, colors[i]);
+                m_gradSpanData.set_back(lastXFixed, xFixed, y, lastColor, colors[i]);
                 lastColor = colors[i];
                 lastXFixed = xFixed;
             }
-            m_ctx->m_gradSpanData.set_back(lastXFixed, 65535u, y, lastColor, lastColor);
+            m_gradSpanData.set_back(lastXFixed,
+                                    std::min(right * kFixedPerTexel, 65535u),
+                                    y,
+                                    lastColor,
+                                    lastColor);
         }
     }
 
@@ -847,15 +2503,15 @@ void PLSRenderContext::LogicalFlush::writeResources()
     // This also allows us to index the storage buffers directly by pathID.
     pls::SimplePaintValue clearColorValue;
     clearColorValue.color = m_ctx->frameDescriptor().clearColor;
-    m_ctx->m_pathData.skip_back();
-    m_ctx->m_paintData.set_back(FillRule::nonZero,
-                                PaintType::solidColor,
-                                clearColorValue,
-                                GradTextureLayout(),
-                                /*clipID =*/0,
-                                /*hasClipRect =*/false,
-                                BlendMode::srcOver);
-    m_ctx->m_paintAuxData.skip_back();
+    m_pathData.skip_back();
+    m_paintData.set_back(FillRule::nonZero,
+                         PaintType::solidColor,
+                         clearColorValue,
+                         GradTextureLayout(),
+                         /*clipID =*/0,
+                         /*hasClipRect =*/false,
+                         BlendMode::srcOver);
+    m_paintAuxData.skip_back();
 
     // Render padding vertices in the tessellation texture.
     if (m_flushDesc.tessDataHeight > 0)
@@ -878,6 +2534,30 @@ void PLSRenderContext::LogicalFlush::writeResources()
     // Write out all the data for our high level draws, and build up a low-level draw list.
     if (m_ctx->frameInterlockMode() == pls::InterlockMode::rasterOrdering)
     {
+        if (m_ctx->m_frameDescriptor.autoInterlockMode && m_ctx->m_autoInterlockEstimatesDrawGroups)
+        {
+            // FrameDescriptor::autoInterlockMode is considering atomic mode, and needs to know how
+            // many draw groups it would have.
+            if (m_intersectionBoard == nullptr)
+            {
+                m_intersectionBoard = std::make_unique<IntersectionBoard>();
+            }
+            m_intersectionBoard->resizeAndReset(m_flushDesc.renderTarget->width(),
+                                                m_flushDesc.renderTarget->height());
+            const int32_t kMax32i = std::numeric_limits<int32_t>::max();
+            const int32_t kMin32i = std::numeric_limits<int32_t>::min();
+            for (size_t i = 0; i < m_plsDraws.size(); ++i)
+            {
+                // Pad the same way atomic mode does below.
+                int4 drawBounds = simd::load4i(&m_drawPixelBounds[i]);
+                drawBounds =
+                    simd::if_then_else(drawBounds != int4{kMin32i, kMin32i, kMax32i, kMax32i},
+                                       drawBounds + int4{-1, -1, 1, 1},
+                                       drawBounds);
+                m_drawGroupCount = std::max<size_t>(m_drawGroupCount,
+                                                    m_intersectionBoard->addRectangle(drawBounds));
+            }
+        }
         for (const PLSDrawUniquePtr& draw : m_plsDraws)
         {
             draw->pushToRenderContext(this);
@@ -886,36 +2566,47 @@ void PLSRenderContext::LogicalFlush::writeResources()
     else
     {
         assert(m_plsDraws.size() <= kMaxReorderedDrawCount);
+        assert(m_flushDesc.interlockMode != pls::InterlockMode::depthStencil ||
+               m_plsDraws.size() <= kMaxDepthSortedDrawCount);
 
         // Sort the draw list to optimize batching, since we can only batch non-overlapping draws.
-        std::vector<int64_t>& indirectDrawList = m_ctx->m_indirectDrawList;
+        std::vector<int64_t>& indirectDrawList = m_indirectDrawList;
         indirectDrawList.resize(m_plsDraws.size());
+        m_indirectDrawSortScratch.resize(m_plsDraws.size());
 
-        if (m_ctx->m_intersectionBoard == nullptr)
+        if (m_intersectionBoard == nullptr)
         {
-            m_ctx->m_intersectionBoard = std::make_unique<IntersectionBoard>();
+            m_intersectionBoard = std::make_unique<IntersectionBoard>();
         }
-        IntersectionBoard* intersectionBoard = m_ctx->m_intersectionBoard.get();
+        IntersectionBoard* intersectionBoard = m_intersectionBoard.get();
         intersectionBoard->resizeAndReset(m_flushDesc.renderTarget->width(),
                                           m_flushDesc.renderTarget->height());
 
-        // Build a list of sort keys that determine the final draw order.
-        constexpr static int kDrawGroupShift = 48; // Where in the key does the draw group begin?
-        constexpr static int64_t kDrawGroupMask = 0xffffllu << kDrawGroupShift;
-        constexpr static int kDrawTypeShift = 45;
-        constexpr static int64_t kDrawTypeMask RIVE_MAYBE_UNUSED = 7llu << kDrawTypeShift;
-        constexpr static int kTextureHashShift = 26;
-        constexpr static int64_t kTextureHashMask = 0x7ffffllu << kTextureHashShift;
-        constexpr static int kBlendModeShift = 22;
-        constexpr static int kBlendModeMask = 0xf << kBlendModeShift;
-        constexpr static int kDrawContentsShift = 16;
-        constexpr static int64_t kDrawContentsMask = 0x3fllu << kDrawContentsShift;
-        constexpr static int64_t kDrawIndexMask = 0xffff;
-        for (size_t i = 0; i < m_plsDraws.size(); ++i)
+        // Non-coherent KHR blend equations need a blend barrier between every advanced blend and
+        // the earlier draws it overlaps. Rather than issuing one at every draw group, give each
+        // draw a "blend phase" that only advances at advanced blends, and submit the phases in
+        // order, with one barrier at the start of each.
+        IntersectionBoard* blendPhaseBoard = nullptr;
+        int32_t maxBlendPhase = 0;
+        if (m_flushDesc.interlockMode == pls::InterlockMode::depthStencil &&
+            platformFeatures.supportsKHRBlendEquations &&
+            platformFeatures.khrBlendEquationsNeedBarriers)
         {
-            PLSDraw* draw = m_plsDraws[i].get();
+            if (m_blendPhaseBoard == nullptr)
+            {
+                m_blendPhaseBoard = std::make_unique<IntersectionBoard>();
+            }
+            blendPhaseBoard = m_blendPhaseBoard.get();
+            blendPhaseBoard->resizeAndReset(m_flushDesc.renderTarget->width(),
+                                            m_flushDesc.renderTarget->height());
+            m_drawBlendPhases.resize(m_plsDraws.size());
+        }
 
-            int4 drawBounds = simd::load4i(&m_plsDraws[i]->pixelBounds());
+        // Build a list of sort keys that determine the final draw order. Only the per-draw tables
+        // are read here, not the PLSDraws themselves.
+        for (size_t i = 0; i < m_plsDraws.size(); ++i)
+        {
+            int4 drawBounds = simd::load4i(&m_drawPixelBounds[i]);
 
             // Add one extra pixel of padding to the draw bounds to make absolutely certain we get
             // no overlapping pixels, which destroy the atomic shader.
@@ -929,7 +2620,20 @@ void PLSRenderContext::LogicalFlush::writeResources()
             // to maximize batching while preserving correctness.
             int64_t drawGroupIdx = intersectionBoard->addRectangle(drawBounds);
             assert(drawGroupIdx > 0);
-            if (m_flushDesc.interlockMode == pls::InterlockMode::depthStencil && draw->isOpaque())
+            m_drawGroupCount = std::max<size_t>(m_drawGroupCount, drawGroupIdx);
+            const int64_t keyBits = m_drawSortKeyBits[i];
+            auto drawContents = static_cast<pls::DrawContents>((keyBits & kDrawContentsMask) >>
+                                                               kDrawContentsShift);
+            if (blendPhaseBoard != nullptr)
+            {
+                bool isAdvancedBlend = drawContents & pls::DrawContents::advancedBlend;
+                int32_t blendPhase =
+                    blendPhaseBoard->addRectangle(drawBounds, isAdvancedBlend ? 1 : 0);
+                m_drawBlendPhases[i] = blendPhase;
+                maxBlendPhase = std::max(maxBlendPhase, blendPhase);
+            }
+            if (m_flushDesc.interlockMode == pls::InterlockMode::depthStencil &&
+                (drawContents & pls::DrawContents::opaquePaint))
             {
                 // In depthStencil mode we can reverse-sort opaque paths front to back, draw them
                 // first, and take advantage of early Z culling.
@@ -937,63 +2641,71 @@ void PLSRenderContext::LogicalFlush::writeResources()
                 // To keep things simple initially, we don't reverse-sort draws that use clipping.
                 // (Otherwise if a clip affects both opaque and transparent content, we would have
                 // to apply it twice.)
-                bool usesClipping = draw->drawContents() &
+                bool usesClipping = drawContents &
                                     (pls::DrawContents::activeClip | pls::DrawContents::clipUpdate);
                 if (!usesClipping)
                 {
                     drawGroupIdx = -drawGroupIdx;
                 }
             }
-            int64_t key = drawGroupIdx << kDrawGroupShift;
-
-            // Within sub-groups of non-overlapping draws, sort similar draw types together.
-            int64_t drawType = static_cast<int64_t>(draw->type());
-            assert(drawType <= kDrawTypeMask >> kDrawTypeShift);
-            key |= drawType << kDrawTypeShift;
-
-            // Within sub-groups of matching draw type, sort by texture binding.
-            int64_t textureHash = draw->imageTexture() != nullptr
-                                      ? draw->imageTexture()->textureResourceHash() &
-                                            (kTextureHashMask >> kTextureHashShift)
-                                      : 0;
-            key |= textureHash << kTextureHashShift;
-
-            // If using KHR_blend_equation_advanced, we need a batching barrier between draws with
-            // different blend modes.
-            // If not using KHR_blend_equation_advanced, sorting by blend mode may still give us
-            // better branching on the GPU.
-            int64_t blendMode = pls::ConvertBlendModeToPLSBlendMode(draw->blendMode());
-            assert(blendMode <= kBlendModeMask >> kBlendModeShift);
-            key |= blendMode << kBlendModeShift;
-
-            // depthStencil mode draws strokes, fills, and even/odd with different stencil settings.
-            int64_t drawContents = static_cast<int64_t>(draw->drawContents());
-            assert(drawContents <= kDrawContentsMask >> kDrawContentsShift);
-            key |= drawContents << kDrawContentsShift;
+            // Within sub-groups of non-overlapping draws, the draw type, texture binding, blend
+            // mode, and draw contents were already packed into keyBits by pushDrawBatch().
+            int64_t key = (drawGroupIdx << kDrawGroupShift) | keyBits;
 
             // Draw index goes at the bottom of the key so we know which PLSDraw it corresponds to.
             assert(i <= kDrawIndexMask);
             key |= i;
 
             assert((key & kDrawGroupMask) >> kDrawGroupShift == drawGroupIdx);
-            assert((key & kDrawTypeMask) >> kDrawTypeShift == drawType);
-            assert((key & kTextureHashMask) >> kTextureHashShift == textureHash);
-            assert((key & kBlendModeMask) >> kBlendModeShift == blendMode);
-            assert((key & kDrawContentsMask) >> kDrawContentsShift == drawContents);
+            assert((key & ~(kDrawGroupMask | kDrawIndexMask)) == keyBits);
             assert((key & kDrawIndexMask) == i);
 
             indirectDrawList[i] = key;
         }
 
-        // Re-order the draws!!
-        std::sort(indirectDrawList.begin(), indirectDrawList.end());
+        // Re-order the draws!! The keys have a fixed bit layout, so a radix sort beats std::sort
+        // by a wide margin at high draw counts. The draw index in the bottom bits is already in
+        // ascending order, so its low bytes don't need sorting.
+        {
+            PLS_TRACE_SCOPE("LogicalFlush::sortDraws");
+            pls::SortInt64Keys(indirectDrawList.data(),
+                               m_indirectDrawSortScratch.data(),
+                               indirectDrawList.size(),
+                               kDrawIndexBits & ~7u);
+        }
+
+        // Stable-partition the sorted draws by blend phase. A draw is never in an earlier phase
+        // than the draws it overlaps beneath it, so this still respects their painter's order.
+        if (maxBlendPhase > 1)
+        {
+            PLS_TRACE_SCOPE("LogicalFlush::sortBlendPhases");
+            std::vector<size_t> phaseOffsets(maxBlendPhase, 0);
+            for (int64_t key : indirectDrawList)
+            {
+                ++phaseOffsets[m_drawBlendPhases[key & kDrawIndexMask] - 1];
+            }
+            size_t offset = 0;
+            for (size_t& phaseOffset : phaseOffsets)
+            {
+                size_t phaseDrawCount = phaseOffset;
+                phaseOffset = offset;
+                offset += phaseDrawCount;
+            }
+            m_blendPhaseSortScratch.resize(indirectDrawList.size());
+            for (int64_t key : indirectDrawList)
+            {
+                int32_t blendPhase = m_drawBlendPhases[key & kDrawIndexMask];
+                m_blendPhaseSortScratch[phaseOffsets[blendPhase - 1]++] = key;
+            }
+            indirectDrawList.swap(m_blendPhaseSortScratch);
+        }
 
         // Atomic mode sometimes needs to initialize PLS with a draw when the backend can't do it
         // with typical clear/load APIs.
         if (m_ctx->frameInterlockMode() == pls::InterlockMode::atomics &&
             platformFeatures.atomicPLSMustBeInitializedAsDraw)
         {
-            m_drawList.emplace_back(m_ctx->perFrameAllocator(),
+            m_drawList.emplace_back(*m_drawListAllocator,
                                     DrawType::plsAtomicInitialize,
                                     nullptr,
                                     1,
@@ -1020,12 +2732,21 @@ void PLSRenderContext::LogicalFlush::writeResources()
         // Write out the draw data from the sorted draw list, and build up a condensed/batched list
         // of low-level draws.
         int64_t priorKey = !indirectDrawList.empty() ? indirectDrawList[0] : 0;
+        int32_t priorBlendPhase = 1;
         for (int64_t key : indirectDrawList)
         {
             if ((priorKey & needsBarrierMask) != (key & needsBarrierMask))
             {
                 pushBarrier();
             }
+            if (blendPhaseBoard != nullptr &&
+                m_drawBlendPhases[key & kDrawIndexMask] != priorBlendPhase)
+            {
+                assert(m_drawBlendPhases[key & kDrawIndexMask] > priorBlendPhase);
+                priorBlendPhase = m_drawBlendPhases[key & kDrawIndexMask];
+                pushBarrier(); // Don't let the new phase merge into the previous batch.
+                m_pendingBlendBarrier = true;
+            }
             // We negate drawGroupIdx on opaque paths in order to draw them first and in reverse
             // order, but their z index should still remain positive.
             m_currentZIndex = abs(key >> kDrawGroupShift);
@@ -1037,7 +2758,7 @@ void PLSRenderContext::LogicalFlush::writeResources()
         if (m_ctx->frameInterlockMode() == pls::InterlockMode::atomics)
         {
             pushBarrier();
-            m_drawList.emplace_back(m_ctx->perFrameAllocator(),
+            m_drawList.emplace_back(*m_drawListAllocator,
                                     DrawType::plsAtomicResolve,
                                     nullptr,
                                     1,
@@ -1046,24 +2767,28 @@ void PLSRenderContext::LogicalFlush::writeResources()
         }
     }
 
-    // Pad our buffers to 256-byte alignment.
-    m_ctx->m_pathData.push_back_n(nullptr, m_pathPaddingCount);
-    m_ctx->m_paintData.push_back_n(nullptr, m_paintPaddingCount);
-    m_ctx->m_paintAuxData.push_back_n(nullptr, m_paintAuxPaddingCount);
-    m_ctx->m_contourData.push_back_n(nullptr, m_contourPaddingCount);
-    m_ctx->m_gradSpanData.push_back_n(nullptr, m_gradSpanPaddingCount);
-
-    assert(m_ctx->m_pathData.elementsWritten() ==
-           m_flushDesc.firstPath + m_resourceCounts.pathCount + m_pathPaddingCount);
-    assert(m_ctx->m_paintData.elementsWritten() ==
-           m_flushDesc.firstPaint + m_resourceCounts.pathCount + m_paintPaddingCount);
-    assert(m_ctx->m_paintAuxData.elementsWritten() ==
-           m_flushDesc.firstPaintAux + m_resourceCounts.pathCount + m_paintAuxPaddingCount);
-    assert(m_ctx->m_contourData.elementsWritten() ==
-           m_flushDesc.firstContour + m_resourceCounts.contourCount + m_contourPaddingCount);
-    assert(m_ctx->m_gradSpanData.elementsWritten() ==
-           m_flushDesc.firstComplexGradSpan + m_resourceCounts.complexGradientSpanCount +
-               m_gradSpanPaddingCount);
+    // Pad our buffers to 256-byte alignment. (The paint aux buffer was laid out with one record
+    // per path, so also skip over the records that deduplication didn't need.)
+    m_pathData.push_back_n(nullptr, m_pathPaddingCount);
+    m_paintData.push_back_n(nullptr, m_paintPaddingCount);
+    assert(m_paintAuxData.elementsWritten() <= m_resourceCounts.pathCount);
+    m_paintAuxData.push_back_n(nullptr,
+                               m_resourceCounts.pathCount - m_paintAuxData.elementsWritten() +
+                                   m_paintAuxPaddingCount);
+    m_contourData.push_back_n(nullptr, m_contourPaddingCount);
+    m_gradSpanData.push_back_n(nullptr, m_gradSpanPaddingCount);
+
+    assert(m_flushUniformData.elementsWritten() == 1);
+    assert(m_pathData.elementsWritten() == m_resourceCounts.pathCount + m_pathPaddingCount);
+    assert(m_paintData.elementsWritten() == m_resourceCounts.pathCount + m_paintPaddingCount);
+    assert(m_paintAuxData.elementsWritten() == m_resourceCounts.pathCount + m_paintAuxPaddingCount);
+    assert(m_contourData.elementsWritten() == m_resourceCounts.contourCount + m_contourPaddingCount);
+    assert(m_simpleColorRampsData.elementsWritten() == m_pendingSimpleGradientWrites.size());
+    assert(m_gradSpanData.elementsWritten() ==
+           m_resourceCounts.complexGradientSpanCount + m_gradSpanPaddingCount);
+    assert(tessVertexSpansWritten() <= m_resourceCounts.maxTessellatedSegmentCount);
+    assert(m_triangleVertexData.elementsWritten() <= m_resourceCounts.maxTriangleVertexCount);
+    assert(m_imageDrawUniformData.elementsWritten() == m_resourceCounts.imageDrawCount);
 
     assert(m_pathTessLocation == m_expectedPathTessLocationAtEndOfPath);
     assert(m_pathMirroredTessLocation == m_expectedPathMirroredTessLocationAtEndOfPath);
@@ -1071,17 +2796,148 @@ void PLSRenderContext::LogicalFlush::writeResources()
     assert(m_outerCubicTessVertexIdx == m_outerCubicTessEndLocation);
 
     // Update the flush descriptor's data counts that aren't known until it's written out.
-    m_flushDesc.tessVertexSpanCount =
-        m_ctx->m_tessSpanData.elementsWritten() - m_flushDesc.firstTessVertexSpan;
-    m_flushDesc.hasTriangleVertices =
-        m_ctx->m_triangleVertexData.bytesWritten() != initialTriangleVertexDataSize;
+    if (m_flushDesc.gpuTessellationSpans)
+    {
+        m_flushDesc.tessCurveCount = tessVertexSpansWritten() - tessAlignmentPadding;
+        m_flushDesc.tessVertexSpanCount = m_gpuTessVertexSpanCount;
+        // The GPU writes its spans into the same region of its own buffer, so it has the same
+        // bound as the CPU spans.
+        assert(m_flushDesc.tessVertexSpanCount + tessAlignmentPadding <=
+               m_resourceCounts.maxTessellatedSegmentCount);
+    }
+    else
+    {
+        m_flushDesc.tessVertexSpanCount = tessVertexSpansWritten() - tessAlignmentPadding;
+    }
+    m_flushDesc.hasTriangleVertices = m_triangleVertexData.bytesWritten() != 0;
 
     m_flushDesc.drawList = &m_drawList;
     m_flushDesc.combinedShaderFeatures = m_combinedShaderFeatures;
+
+    if (m_ctx->frameUsesTileBinnedRendering())
+    {
+        buildTileBins();
+    }
+
+    // Release our views of the mapped buffers before the context unmaps them.
+    m_flushUniformData.reset();
+    m_pathData.reset();
+    m_paintData.reset();
+    m_paintAuxData.reset();
+    m_contourData.reset();
+    m_simpleColorRampsData.reset();
+    m_gradSpanData.reset();
+    m_tessSpanData.reset();
+    m_compactTessSpanData.reset();
+    m_tessCurveData.reset();
+    m_triangleVertexData.reset();
+    m_imageDrawUniformData.reset();
+    m_drawListAllocator = nullptr;
+    m_paintAuxIndices.clear();
+}
+
+void PLSRenderContext::LogicalFlush::buildTileBins()
+{
+    assert(m_flushDesc.interlockMode == pls::InterlockMode::atomics);
+    assert(m_tileBinDrawLists.empty());
+    assert(m_tileBinFlushDescs.empty());
+
+    const IAABB updateBounds = m_flushDesc.renderTargetUpdateBounds;
+    if (updateBounds.empty())
+    {
+        return;
+    }
+
+    // Bins are aligned on the render target's origin so they line up with the IntersectionBoard.
+    for (int32_t t = updateBounds.top / kTileBinSize * kTileBinSize; t < updateBounds.bottom;
+         t += kTileBinSize)
+    {
+        for (int32_t l = updateBounds.left / kTileBinSize * kTileBinSize; l < updateBounds.right;
+             l += kTileBinSize)
+        {
+            IAABB binBounds =
+                IAABB{l, t, l + kTileBinSize, t + kTileBinSize}.intersect(updateBounds);
+            BlockAllocatedLinkedList<DrawBatch>& binDrawList = m_tileBinDrawLists.emplace_back();
+            for (const DrawBatch& batch : m_drawList)
+            {
+                if (batch.pixelBounds.intersect(binBounds).empty())
+                {
+                    // Skip the batch, but keep its barrier so the draw groups on either side of it
+                    // stay ordered.
+                    if (batch.needsBarrier && !binDrawList.empty())
+                    {
+                        binDrawList.tail().needsBarrier = true;
+                    }
+                    continue;
+                }
+                binDrawList.emplace_back(*m_drawListAllocator, batch);
+            }
+
+            pls::FlushDescriptor& binDesc = m_tileBinFlushDescs.emplace_back(m_flushDesc);
+            binDesc.renderTargetUpdateBounds = binBounds;
+            binDesc.hasPartialUpdateBounds = is_partial_update(binBounds, m_flushDesc.renderTarget);
+            binDesc.isTileBinPass = true;
+            binDesc.isFirstTileBinPass = m_tileBinFlushDescs.size() == 1;
+            if (!binDesc.isFirstTileBinPass)
+            {
+                // The first bin already rendered the gradient and tessellation textures.
+                binDesc.complexGradSpanCount = 0;
+                binDesc.simpleGradTexelsWidth = 0;
+                binDesc.simpleGradTexelsHeight = 0;
+                binDesc.tessVertexSpanCount = 0;
+                binDesc.tessCurveCount = 0;
+                binDesc.isFirstFlushOfFrame = false;
+                binDesc.isFirstFlushOfRenderTarget = false;
+            }
+            // Only the final bin completes the flush.
+            binDesc.isFinalFlushOfFrame = false;
+            binDesc.isFinalFlushOfRenderTarget = false;
+            binDesc.frameCompletionFence = nullptr;
+        }
+    }
+
+    // Assign the draw lists last, once m_tileBinDrawLists is done reallocating.
+    for (size_t i = 0; i < m_tileBinFlushDescs.size(); ++i)
+    {
+        m_tileBinFlushDescs[i].drawList = &m_tileBinDrawLists[i];
+    }
+    m_tileBinFlushDescs.back().isFinalFlushOfFrame = m_flushDesc.isFinalFlushOfFrame;
+    m_tileBinFlushDescs.back().isFinalFlushOfRenderTarget = m_flushDesc.isFinalFlushOfRenderTarget;
+    m_tileBinFlushDescs.back().frameCompletionFence = m_flushDesc.frameCompletionFence;
+}
+
+void PLSRenderContext::LogicalFlush::submit(PLSRenderContextImpl* impl)
+{
+    PLS_TRACE_SCOPE("LogicalFlush::submit");
+    assert(m_hasDoneLayout);
+    if (m_tileBinFlushDescs.empty())
+    {
+        impl->flush(m_flushDesc);
+        return;
+    }
+    for (const pls::FlushDescriptor& binDesc : m_tileBinFlushDescs)
+    {
+        impl->flush(binDesc);
+    }
+}
+
+#ifdef DEBUG
+void PLSRenderContext::LogicalFlush::unlockRawPathMutations()
+{
+    for (const PLSDrawUniquePtr& draw : m_plsDraws)
+    {
+        if (draw != nullptr && (draw->type() == PLSDraw::Type::midpointFanPath ||
+                                draw->type() == PLSDraw::Type::interiorTriangulationPath))
+        {
+            static_cast<PLSPathDraw*>(draw.get())->unlockRawPathMutations();
+        }
+    }
 }
+#endif
 
 void PLSRenderContext::setResourceSizes(ResourceAllocationCounts allocs, bool forceRealloc)
 {
+    PLS_TRACE_SCOPE("PLSRenderContext::setResourceSizes");
 #if 0
     class Logger
     {
@@ -1122,7 +2978,7 @@ void PLSRenderContext::setResourceSizes(ResourceAllocationCounts allocs, bool fo
     logger.logSize(#NAME,                                                                          \
                    m_currentResourceAllocations.NAME,                                              \
                    allocs.NAME,                                                                    \
-                   allocs.NAME* ITEM_SIZE_IN_BYTES* pls::kBufferRingSize)
+                   allocs.NAME* ITEM_SIZE_IN_BYTES* m_impl->bufferRingSize())
 #define LOG_TEXTURE_HEIGHT(NAME, BYTES_PER_ROW)                                                    \
     logger.logSize(#NAME,                                                                          \
                    m_currentResourceAllocations.NAME,                                              \
@@ -1219,9 +3075,14 @@ void PLSRenderContext::setResourceSizes(ResourceAllocationCounts allocs, bool fo
     if (allocs.gradTextureHeight != m_currentResourceAllocations.gradTextureHeight || forceRealloc)
     {
         m_impl->resizeGradientTexture(pls::kGradTextureWidth, allocs.gradTextureHeight);
+        // The new texture doesn't have any of the atlas's color ramps. This is only safe because
+        // the atlas always needs the texture to be kGradTextureHeightWithAtlas or taller: the
+        // texture can only grow while the atlas holds nothing from previous frames, and it can only
+        // shrink after gradients have gone unused for an entire trim interval.
+        resetComplexGradientAtlas();
     }
 
-    allocs.tessTextureHeight = std::min(allocs.tessTextureHeight, kMaxTextureHeight);
+    allocs.tessTextureHeight = std::min(allocs.tessTextureHeight, m_maxTessTextureHeight);
     LOG_TEXTURE_HEIGHT(tessTextureHeight, pls::kTessTextureWidth * 4 * 4);
     if (allocs.tessTextureHeight != m_currentResourceAllocations.tessTextureHeight || forceRealloc)
     {
@@ -1231,8 +3092,251 @@ void PLSRenderContext::setResourceSizes(ResourceAllocationCounts allocs, bool fo
     m_currentResourceAllocations = allocs;
 }
 
+bool PLSRenderContext::popGPUFrameTime(pls::GPUFrameTime* gpuFrameTime)
+{
+    waitForPendingSubmission();
+    return m_impl->popGPUFrameTime(gpuFrameTime);
+}
+
+void PLSRenderContext::drawOverdrawHeatmap()
+{
+    PLS_TRACE_SCOPE("PLSRenderContext::drawOverdrawHeatmap");
+    using Heatmap = FrameStats::OverdrawHeatmap;
+    constexpr static uint32_t kTileSize = Heatmap::kTileSize;
+    const uint32_t width = m_frameDescriptor.renderTargetWidth;
+    const uint32_t height = m_frameDescriptor.renderTargetHeight;
+
+    Heatmap& heatmap = m_lastFrameStats.overdrawHeatmap;
+    heatmap.tilesWide = (width + kTileSize - 1) / kTileSize;
+    heatmap.tilesTall = (height + kTileSize - 1) / kTileSize;
+    for (std::vector<uint32_t>& tiles : heatmap.tileFragmentCounts)
+    {
+        tiles.clear();
+    }
+    heatmap.fragmentCounts.fill(0);
+    // Snapshot the draws first, since the overlay pushes new draws (and maybe logical flushes).
+    std::vector<const PLSDraw*> visibleDraws;
+    for (const auto& logicalFlush : m_logicalFlushes)
+    {
+        logicalFlush->accumulateOverdrawHeatmap(&heatmap, &visibleDraws);
+    }
+    heatmap.totalFragmentCount = 0;
+    for (uint64_t fragmentCount : heatmap.fragmentCounts)
+    {
+        heatmap.totalFragmentCount += fragmentCount;
+    }
+
+    heatmap.maxTileFragmentsPerPixel = 0;
+    for (uint32_t ty = 0; ty < heatmap.tilesTall; ++ty)
+    {
+        for (uint32_t tx = 0; tx < heatmap.tilesWide; ++tx)
+        {
+            size_t tileIdx = ty * heatmap.tilesWide + tx;
+            uint32_t fragmentCount = 0;
+            for (const std::vector<uint32_t>& tiles : heatmap.tileFragmentCounts)
+            {
+                if (!tiles.empty())
+                {
+                    fragmentCount += tiles[tileIdx];
+                }
+            }
+            uint32_t tileWidth = std::min(kTileSize, width - tx * kTileSize);
+            uint32_t tileHeight = std::min(kTileSize, height - ty * kTileSize);
+            uint32_t fragmentsPerPixel = fragmentCount / (tileWidth * tileHeight);
+            heatmap.maxTileFragmentsPerPixel =
+                std::max(heatmap.maxTileFragmentsPerPixel, fragmentsPerPixel);
+        }
+    }
+
+    // The tile counts above only bin each draw's bounding box. For the overlay, redraw each draw's
+    // actual geometry instead, in a translucent color, so the opacity of every pixel builds up
+    // with the number of draws that really cover it. Composite it through the regular draw path,
+    // so it works on every backend. It's drawn after the heatmap is measured, so it doesn't count
+    // itself.
+    constexpr static ColorInt kOverdrawLayerColor = 0x30ff2000;
+    // Draw matrices already include the frame's resolution scale, which PLSRenderer applies again.
+    Mat2D inverseResolutionScale;
+    if (!frameIsResolutionScaled() || !m_frameResolutionScaleMatrix.invert(&inverseResolutionScale))
+    {
+        inverseResolutionScale = Mat2D();
+    }
+    PLSRenderer renderer(this);
+    rcp<RenderPaint> fillPaint = makeRenderPaint();
+    fillPaint->color(kOverdrawLayerColor);
+    for (const PLSDraw* draw : visibleDraws)
+    {
+        renderer.save();
+        switch (draw->type())
+        {
+            case PLSDraw::Type::midpointFanPath:
+            case PLSDraw::Type::interiorTriangulationPath:
+            {
+                auto pathDraw = static_cast<const PLSPathDraw*>(draw);
+                // The draw's fill rule may differ from the path's current one.
+                RawPath rawPath = pathDraw->path()->getRawPath();
+                rcp<RenderPath> path = makeRenderPath(rawPath, pathDraw->fillRule());
+                rcp<RenderPaint> paint = fillPaint;
+                if (pathDraw->isStroked())
+                {
+                    // Only midpoint fans draw strokes.
+                    assert(draw->type() == PLSDraw::Type::midpointFanPath);
+                    auto strokeDraw = static_cast<const MidpointFanPathDraw*>(pathDraw);
+                    paint = makeRenderPaint();
+                    paint->style(RenderPaintStyle::stroke);
+                    paint->thickness(strokeDraw->strokeRadius() * 2);
+                    paint->join(strokeDraw->strokeJoin());
+                    paint->cap(strokeDraw->strokeCap());
+                    paint->color(kOverdrawLayerColor);
+                }
+                renderer.transform(inverseResolutionScale * draw->matrix());
+                renderer.drawPath(path.get(), paint.get());
+                break;
+            }
+            case PLSDraw::Type::imageRect:
+            case PLSDraw::Type::solidRect:
+                // Image and solid rects draw the rect [0, 0, 1, 1].
+                renderer.transform(inverseResolutionScale * draw->matrix());
+                renderer.drawPath(m_unitRectPath.get(), fillPaint.get());
+                break;
+            case PLSDraw::Type::imageMesh:
+            case PLSDraw::Type::stencilClipReset:
+            {
+                // These don't keep their geometry on the CPU. Fall back on their pixel bounds.
+                AABB bounds = AABB(draw->pixelBounds().intersect(
+                    {0, 0, static_cast<int32_t>(width), static_cast<int32_t>(height)}));
+                RawPath rawPath;
+                rawPath.moveTo(bounds.left(), bounds.top());
+                rawPath.lineTo(bounds.right(), bounds.top());
+                rawPath.lineTo(bounds.right(), bounds.bottom());
+                rawPath.lineTo(bounds.left(), bounds.bottom());
+                rawPath.close();
+                rcp<RenderPath> path = makeRenderPath(rawPath, FillRule::nonZero);
+                renderer.transform(inverseResolutionScale);
+                renderer.drawPath(path.get(), fillPaint.get());
+                break;
+            }
+        }
+        renderer.restore();
+    }
+}
+
+void PLSRenderContext::updateFrameStats(const ResourceAllocationCounts& mapCounts)
+{
+    FrameStats& stats = m_lastFrameStats;
+    stats.frameNumber = m_frameNumber;
+    stats.skippedUnchangedFrame = false;
+    stats.interlockMode = m_frameInterlockMode;
+    stats.renderTargetPixelArea = static_cast<uint64_t>(m_frameDescriptor.renderTargetWidth) *
+                                  m_frameDescriptor.renderTargetHeight;
+    stats.logicalFlushes.resize(m_logicalFlushes.size());
+    stats.drawBatchCount = 0;
+    stats.culledDrawCount = 0;
+    stats.tessVertexCount = 0;
+    stats.gradientRowCount = 0;
+    stats.drawCount = 0;
+    stats.drawPixelArea = 0;
+    stats.nonSrcOverDrawCount = 0;
+    stats.drawGroupCount = 0;
+    stats.blendBarrierCount = 0;
+    stats.recycledClipIDCount = 0;
+    stats.tessellationQuality = m_frameTessellationQuality;
+    if (!m_frameDescriptor.overdrawHeatmap)
+    {
+        // Don't report a stale heatmap from an earlier frame.
+        stats.overdrawHeatmap = {};
+    }
+    for (size_t i = 0; i < m_logicalFlushes.size(); ++i)
+    {
+        FrameStats::LogicalFlushStats& flushStats = stats.logicalFlushes[i];
+        m_logicalFlushes[i]->getStats(&flushStats);
+        stats.drawBatchCount += flushStats.drawBatchCount;
+        stats.culledDrawCount += flushStats.culledDrawCount;
+        stats.tessVertexCount += flushStats.tessVertexCount;
+        stats.gradientRowCount +=
+            flushStats.simpleGradientRowCount + flushStats.complexGradientRowCount;
+        stats.drawCount += flushStats.drawCount;
+        stats.drawPixelArea += flushStats.drawPixelArea;
+        stats.nonSrcOverDrawCount += flushStats.nonSrcOverDrawCount;
+        stats.drawGroupCount += flushStats.drawGroupCount;
+        stats.blendBarrierCount += flushStats.blendBarrierCount;
+        stats.recycledClipIDCount += flushStats.recycledClipIDCount;
+    }
+
+    // mapResourceBuffers() maps every buffer ring to its full allocation.
+    stats.flushUniformBytes = mapCounts.flushUniformBufferCount * sizeof(pls::FlushUniforms);
+    stats.imageDrawUniformBytes =
+        mapCounts.imageDrawUniformBufferCount * sizeof(pls::ImageDrawUniforms);
+    stats.pathBytes = mapCounts.pathBufferCount * sizeof(pls::PathData);
+    stats.paintBytes = mapCounts.paintBufferCount * sizeof(pls::PaintData);
+    stats.paintAuxBytes = mapCounts.paintAuxBufferCount * sizeof(pls::PaintAuxData);
+    stats.contourBytes = mapCounts.contourBufferCount * sizeof(pls::ContourData);
+    stats.simpleColorRampBytes = mapCounts.simpleGradientBufferCount * sizeof(pls::TwoTexelRamp);
+    stats.gradSpanBytes = mapCounts.complexGradSpanBufferCount * sizeof(pls::GradientSpan);
+    stats.tessSpanBytes =
+        mapCounts.tessSpanBufferCount * (frameUsesCompactTessVertexSpans()
+                                             ? sizeof(pls::CompactTessVertexSpan)
+                                             : sizeof(pls::TessVertexSpan));
+    stats.triangleVertexBytes = mapCounts.triangleVertexBufferCount * sizeof(pls::TriangleVertex);
+    stats.totalMappedBytes = stats.flushUniformBytes + stats.imageDrawUniformBytes +
+                             stats.pathBytes + stats.paintBytes + stats.paintAuxBytes +
+                             stats.contourBytes + stats.simpleColorRampBytes +
+                             stats.gradSpanBytes + stats.tessSpanBytes +
+                             stats.triangleVertexBytes;
+}
+
+pls::InterlockMode PLSRenderContext::chooseAutoInterlockMode()
+{
+    // Thresholds for switching modes. They're far apart, so scenes that land in between don't
+    // flip-flop (and recompile or reallocate PLS resources) from one frame to the next.
+    constexpr static float kMaxAtomicOverdraw = 3;
+    constexpr static float kMinRasterOrderingOverdraw = 1.5f;
+    constexpr static float kMaxAtomicDrawGroupsPerFlush = 16;
+    constexpr static float kMinRasterOrderingDrawGroupsPerFlush = 8;
+    constexpr static float kMaxAtomicNonSrcOverFraction = .5f;
+    constexpr static float kMinRasterOrderingNonSrcOverFraction = .25f;
+
+    const FrameStats& stats = m_lastFrameStats;
+    if (stats.frameNumber == 0 || stats.drawCount == 0 || stats.renderTargetPixelArea == 0)
+    {
+        return m_autoInterlockMode; // Nothing to go on yet.
+    }
+    float overdraw = static_cast<float>(stats.drawPixelArea) / stats.renderTargetPixelArea;
+    float nonSrcOverFraction = static_cast<float>(stats.nonSrcOverDrawCount) / stats.drawCount;
+    // Each group of overlapping draws is separated by a barrier in atomic mode.
+    float drawGroupsPerFlush =
+        static_cast<float>(stats.drawGroupCount) / stats.logicalFlushes.size();
+    m_autoInterlockEstimatesDrawGroups = false;
+    if (stats.interlockMode == pls::InterlockMode::atomics)
+    {
+        if (overdraw > kMaxAtomicOverdraw || drawGroupsPerFlush > kMaxAtomicDrawGroupsPerFlush ||
+            nonSrcOverFraction > kMaxAtomicNonSrcOverFraction)
+        {
+            m_autoInterlockMode = pls::InterlockMode::rasterOrdering;
+        }
+    }
+    else if (stats.interlockMode == pls::InterlockMode::rasterOrdering)
+    {
+        if (overdraw < kMinRasterOrderingOverdraw &&
+            nonSrcOverFraction < kMinRasterOrderingNonSrcOverFraction)
+        {
+            // rasterOrdering doesn't need draw groups, so they only get counted once the other
+            // criteria qualify. Otherwise a scene with too many groups for atomic mode would switch
+            // back and forth every frame.
+            m_autoInterlockEstimatesDrawGroups = true;
+            if (stats.drawGroupCount != 0 &&
+                drawGroupsPerFlush < kMinRasterOrderingDrawGroupsPerFlush)
+            {
+                m_autoInterlockMode = pls::InterlockMode::atomics;
+                m_autoInterlockEstimatesDrawGroups = false;
+            }
+        }
+    }
+    return m_autoInterlockMode;
+}
+
 void PLSRenderContext::mapResourceBuffers(const ResourceAllocationCounts& mapCounts)
 {
+    PLS_TRACE_SCOPE("PLSRenderContext::mapResourceBuffers");
     m_impl->prepareToMapBuffers();
 
     if (mapCounts.flushUniformBufferCount > 0)
@@ -1299,13 +3403,31 @@ void PLSRenderContext::mapResourceBuffers(const ResourceAllocationCounts& mapCou
     }
     assert(m_gradSpanData.hasRoomFor(mapCounts.complexGradSpanBufferCount));
 
+    // The buffer is always allocated for full TessVertexSpans, so either encoding fits.
     if (mapCounts.tessSpanBufferCount > 0)
     {
-        m_tessSpanData.mapElements(m_impl.get(),
-                                   &PLSRenderContextImpl::mapTessVertexSpanBuffer,
-                                   mapCounts.tessSpanBufferCount);
+        if (frameUsesCompactTessVertexSpans())
+        {
+            m_compactTessSpanData.mapElements(m_impl.get(),
+                                              &PLSRenderContextImpl::mapTessVertexSpanBuffer,
+                                              mapCounts.tessSpanBufferCount);
+            assert(m_compactTessSpanData.hasRoomFor(mapCounts.tessSpanBufferCount));
+        }
+        else if (frameUsesGPUTessellationSpans())
+        {
+            m_tessCurveData.mapElements(m_impl.get(),
+                                        &PLSRenderContextImpl::mapTessVertexSpanBuffer,
+                                        mapCounts.tessSpanBufferCount);
+            assert(m_tessCurveData.hasRoomFor(mapCounts.tessSpanBufferCount));
+        }
+        else
+        {
+            m_tessSpanData.mapElements(m_impl.get(),
+                                       &PLSRenderContextImpl::mapTessVertexSpanBuffer,
+                                       mapCounts.tessSpanBufferCount);
+            assert(m_tessSpanData.hasRoomFor(mapCounts.tessSpanBufferCount));
+        }
     }
-    assert(m_tessSpanData.hasRoomFor(mapCounts.tessSpanBufferCount));
 
     if (mapCounts.triangleVertexBufferCount > 0)
     {
@@ -1318,6 +3440,7 @@ void PLSRenderContext::mapResourceBuffers(const ResourceAllocationCounts& mapCou
 
 void PLSRenderContext::unmapResourceBuffers()
 {
+    PLS_TRACE_SCOPE("PLSRenderContext::unmapResourceBuffers");
     if (m_flushUniformData)
     {
         m_impl->unmapFlushUniformBuffer();
@@ -1358,10 +3481,12 @@ void PLSRenderContext::unmapResourceBuffers()
         m_impl->unmapGradSpanBuffer();
         m_gradSpanData.reset();
     }
-    if (m_tessSpanData)
+    if (m_tessSpanData || m_compactTessSpanData || m_tessCurveData)
     {
         m_impl->unmapTessVertexSpanBuffer();
         m_tessSpanData.reset();
+        m_compactTessSpanData.reset();
+        m_tessCurveData.reset();
     }
     if (m_triangleVertexData)
     {
@@ -1382,11 +3507,73 @@ void PLSRenderContext::LogicalFlush::pushPaddingVertices(uint32_t tessLocation,
     assert(m_pathMirroredTessLocation == m_expectedPathMirroredTessLocationAtEndOfPath);
     m_pathTessLocation = tessLocation;
     RIVE_DEBUG_CODE(m_expectedPathTessLocationAtEndOfPath = m_pathTessLocation + count;)
-    assert(m_expectedPathTessLocationAtEndOfPath <= kMaxTessellationVertexCount);
-    pushTessellationSpans(kEmptyCubic, {0, 0}, count, 0, 0, 1, kInvalidContourID);
+    assert(m_expectedPathTessLocationAtEndOfPath <= m_ctx->m_maxTessVertexCount);
+    if (m_flushDesc.gpuTessellationSpans)
+    {
+        pushTessCurve(kEmptyCubic,
+                      {0, 0},
+                      m_pathTessLocation,
+                      TessCurve::kNoMirroredLocation,
+                      count,
+                      0,
+                      0,
+                      1,
+                      kInvalidContourID);
+    }
+    else
+    {
+        pushTessellationSpans(kEmptyCubic, {0, 0}, count, 0, 0, 1, kInvalidContourID);
+    }
     assert(m_pathTessLocation == m_expectedPathTessLocationAtEndOfPath);
 }
 
+size_t PLSRenderContext::LogicalFlush::HashPaintAuxContents::operator()(
+    const PaintAuxContents& contents) const
+{
+    return std::hash<std::string_view>()(
+        std::string_view(reinterpret_cast<const char*>(contents.data()), sizeof(contents)));
+}
+
+uint32_t PLSRenderContext::LogicalFlush::pushPaintAux(const PLSPathDraw* draw)
+{
+    if (m_flushDesc.interlockMode == pls::InterlockMode::atomics)
+    {
+        m_paintAuxData.set_back(draw->matrix(),
+                                draw->paintType(),
+                                draw->simplePaintValue(),
+                                draw->gradient(),
+                                draw->imageTexture(),
+                                draw->clipRectInverseMatrix(),
+                                m_flushDesc.renderTarget,
+                                m_ctx->platformFeatures());
+        assert(m_currentPathID + 1 == m_paintAuxData.elementsWritten());
+        return m_currentPathID;
+    }
+
+    // Build the record locally (zeroed, since set() doesn't write every field for every paint
+    // type), and only copy it out to mapped memory if no other path has already written it.
+    pls::PaintAuxData paintAux{};
+    paintAux.set(draw->matrix(),
+                 draw->paintType(),
+                 draw->simplePaintValue(),
+                 draw->gradient(),
+                 draw->imageTexture(),
+                 draw->clipRectInverseMatrix(),
+                 m_flushDesc.renderTarget,
+                 m_ctx->platformFeatures());
+    PaintAuxContents contents;
+    static_assert(sizeof(contents) == sizeof(paintAux));
+    memcpy(contents.data(), &paintAux, sizeof(contents));
+    auto [iter, isNewRecord] = m_paintAuxIndices.try_emplace(
+        contents,
+        static_cast<uint32_t>(m_paintAuxData.elementsWritten()));
+    if (isNewRecord)
+    {
+        m_paintAuxData.push_back_n(&paintAux, 1);
+    }
+    return iter->second;
+}
+
 void PLSRenderContext::LogicalFlush::pushPath(PLSPathDraw* draw,
                                               pls::PatchType patchType,
                                               uint32_t tessVertexCount)
@@ -1400,27 +3587,19 @@ void PLSRenderContext::LogicalFlush::pushPath(PLSPathDraw* draw,
     ++m_currentPathID;
     assert(0 < m_currentPathID && m_currentPathID <= m_ctx->m_maxPathID);
 
-    m_ctx->m_pathData.set_back(draw->matrix(), draw->strokeRadius(), m_currentZIndex);
-    m_ctx->m_paintData.set_back(draw->fillRule(),
-                                draw->paintType(),
-                                draw->simplePaintValue(),
-                                m_gradTextureLayout,
-                                draw->clipID(),
-                                draw->hasClipRect(),
-                                draw->blendMode());
-    m_ctx->m_paintAuxData.set_back(draw->matrix(),
-                                   draw->paintType(),
-                                   draw->simplePaintValue(),
-                                   draw->gradient(),
-                                   draw->imageTexture(),
-                                   draw->clipRectInverseMatrix(),
-                                   m_flushDesc.renderTarget,
-                                   m_ctx->platformFeatures());
-
-    assert(m_flushDesc.firstPath + m_currentPathID + 1 == m_ctx->m_pathData.elementsWritten());
-    assert(m_flushDesc.firstPaint + m_currentPathID + 1 == m_ctx->m_paintData.elementsWritten());
-    assert(m_flushDesc.firstPaintAux + m_currentPathID + 1 ==
-           m_ctx->m_paintAuxData.elementsWritten());
+    uint32_t paintAuxIdx = pushPaintAux(draw);
+    m_pathData.set_back(draw->matrix(), draw->strokeRadius(), m_currentZIndex, paintAuxIdx);
+    m_paintData.set_back(draw->fillRule(),
+                         draw->paintType(),
+                         draw->simplePaintValue(),
+                         m_gradTextureLayout,
+                         draw->clipID(),
+                         draw->hasClipRect(),
+                         draw->blendMode());
+
+    assert(m_currentPathID + 1 == m_pathData.elementsWritten());
+    assert(m_currentPathID + 1 == m_paintData.elementsWritten());
+    assert(m_currentPathID + 1 >= m_paintAuxData.elementsWritten());
 
     pls::DrawType drawType;
     size_t tessLocation;
@@ -1439,7 +3618,7 @@ void PLSRenderContext::LogicalFlush::pushPath(PLSPathDraw* draw,
 
     RIVE_DEBUG_CODE(m_expectedPathTessLocationAtEndOfPath = tessLocation + tessVertexCount);
     RIVE_DEBUG_CODE(m_expectedPathMirroredTessLocationAtEndOfPath = tessLocation);
-    assert(m_expectedPathTessLocationAtEndOfPath <= kMaxTessellationVertexCount);
+    assert(m_expectedPathTessLocationAtEndOfPath <= m_ctx->m_maxTessVertexCount);
 
     uint32_t patchSize = PatchSegmentSpan(drawType);
     uint32_t baseInstance = tessLocation / patchSize;
@@ -1470,7 +3649,7 @@ void PLSRenderContext::LogicalFlush::pushContour(Vec2D midpoint,
                                                  uint32_t paddingVertexCount)
 {
     assert(m_hasDoneLayout);
-    assert(m_ctx->m_pathData.bytesWritten() > 0);
+    assert(m_pathData.bytesWritten() > 0);
     assert(m_currentPathIsStroked || closed);
     assert(m_currentPathID != 0); // pathID can't be zero.
 
@@ -1482,10 +3661,10 @@ void PLSRenderContext::LogicalFlush::pushContour(Vec2D midpoint,
     uint32_t vertexIndex0 = m_currentPathContourDirections & pls::ContourDirections::forward
                                 ? m_pathTessLocation
                                 : m_pathMirroredTessLocation - 1;
-    m_ctx->m_contourData.emplace_back(midpoint, m_currentPathID, vertexIndex0);
+    m_contourData.emplace_back(midpoint, m_currentPathID, vertexIndex0);
     ++m_currentContourID;
-    assert(0 < m_currentContourID && m_currentContourID <= pls::kMaxContourID);
-    assert(m_flushDesc.firstContour + m_currentContourID == m_ctx->m_contourData.elementsWritten());
+    assert(0 < m_currentContourID && m_currentContourID <= m_ctx->m_maxContourID);
+    assert(m_currentContourID == m_contourData.elementsWritten());
 
     // The first curve of the contour will be pre-padded with 'paddingVertexCount' tessellation
     // vertices, colocated at T=0. The caller must use this argument align the end of the contour on
@@ -1516,7 +3695,21 @@ void PLSRenderContext::LogicalFlush::pushCubic(const Vec2D pts[4],
     // Only the first curve of a contour gets padding vertices.
     m_currentContourPaddingVertexCount = 0;
 
-    if (m_currentPathContourDirections == pls::ContourDirections::reverseAndForward)
+    if (m_flushDesc.gpuTessellationSpans)
+    {
+        bool forward = m_currentPathContourDirections != pls::ContourDirections::reverse;
+        bool mirrored = m_currentPathContourDirections != pls::ContourDirections::forward;
+        pushTessCurve(pts,
+                      joinTangent,
+                      forward ? m_pathTessLocation : TessCurve::kNoForwardLocation,
+                      mirrored ? m_pathMirroredTessLocation : TessCurve::kNoMirroredLocation,
+                      totalVertexCount,
+                      parametricSegmentCount,
+                      polarSegmentCount,
+                      joinSegmentCount,
+                      m_currentContourID | additionalContourFlags);
+    }
+    else if (m_currentPathContourDirections == pls::ContourDirections::reverseAndForward)
     {
         pushMirroredAndForwardTessellationSpans(pts,
                                                 joinTangent,
@@ -1568,15 +3761,15 @@ RIVE_ALWAYS_INLINE void PLSRenderContext::LogicalFlush::pushTessellationSpans(
     int32_t x1 = x0 + totalVertexCount;
     for (;;)
     {
-        m_ctx->m_tessSpanData.set_back(pts,
-                                       joinTangent,
-                                       static_cast<float>(y),
-                                       x0,
-                                       x1,
-                                       parametricSegmentCount,
-                                       polarSegmentCount,
-                                       joinSegmentCount,
-                                       contourIDWithFlags);
+        writeTessVertexSpan(pts,
+                                joinTangent,
+                                static_cast<float>(y),
+                                x0,
+                                x1,
+                                parametricSegmentCount,
+                                polarSegmentCount,
+                                joinSegmentCount,
+                                contourIDWithFlags);
         if (x1 > static_cast<int32_t>(kTessTextureWidth))
         {
             // The span was too long to fit on the current line. Wrap and draw it again, this
@@ -1613,15 +3806,15 @@ RIVE_ALWAYS_INLINE void PLSRenderContext::LogicalFlush::pushMirroredTessellation
 
     for (;;)
     {
-        m_ctx->m_tessSpanData.set_back(pts,
-                                       joinTangent,
-                                       static_cast<float>(reflectionY),
-                                       reflectionX0,
-                                       reflectionX1,
-                                       parametricSegmentCount,
-                                       polarSegmentCount,
-                                       joinSegmentCount,
-                                       contourIDWithFlags);
+        writeTessVertexSpan(pts,
+                                joinTangent,
+                                static_cast<float>(reflectionY),
+                                reflectionX0,
+                                reflectionX1,
+                                parametricSegmentCount,
+                                polarSegmentCount,
+                                joinSegmentCount,
+                                contourIDWithFlags);
         if (reflectionX1 < 0)
         {
             --reflectionY;
@@ -1658,18 +3851,18 @@ RIVE_ALWAYS_INLINE void PLSRenderContext::LogicalFlush::pushMirroredAndForwardTe
 
     for (;;)
     {
-        m_ctx->m_tessSpanData.set_back(pts,
-                                       joinTangent,
-                                       static_cast<float>(y),
-                                       x0,
-                                       x1,
-                                       static_cast<float>(reflectionY),
-                                       reflectionX0,
-                                       reflectionX1,
-                                       parametricSegmentCount,
-                                       polarSegmentCount,
-                                       joinSegmentCount,
-                                       contourIDWithFlags);
+        writeTessVertexSpan(pts,
+                                joinTangent,
+                                static_cast<float>(y),
+                                x0,
+                                x1,
+                                static_cast<float>(reflectionY),
+                                reflectionX0,
+                                reflectionX1,
+                                parametricSegmentCount,
+                                polarSegmentCount,
+                                joinSegmentCount,
+                                contourIDWithFlags);
         if (x1 > static_cast<int32_t>(kTessTextureWidth) || reflectionX1 < 0)
         {
             // Either the span or its reflection was too long to fit on the current line. Wrap and
@@ -1694,15 +3887,71 @@ RIVE_ALWAYS_INLINE void PLSRenderContext::LogicalFlush::pushMirroredAndForwardTe
     assert(m_pathMirroredTessLocation >= m_expectedPathMirroredTessLocationAtEndOfPath);
 }
 
+void PLSRenderContext::LogicalFlush::pushTessCurve(const Vec2D pts[4],
+                                                   Vec2D joinTangent,
+                                                   uint32_t tessLocation,
+                                                   uint32_t mirroredTessLocation,
+                                                   uint32_t totalVertexCount,
+                                                   uint32_t parametricSegmentCount,
+                                                   uint32_t polarSegmentCount,
+                                                   uint32_t joinSegmentCount,
+                                                   uint32_t contourIDWithFlags)
+{
+    assert(m_hasDoneLayout);
+    assert(m_flushDesc.gpuTessellationSpans);
+    assert(totalVertexCount > 0);
+
+    uint32_t spanCount =
+        TessCurve::SpanCount(tessLocation, mirroredTessLocation, totalVertexCount);
+    m_tessCurveData.set_back(pts,
+                             joinTangent,
+                             tessLocation,
+                             mirroredTessLocation,
+                             totalVertexCount,
+                             parametricSegmentCount,
+                             polarSegmentCount,
+                             joinSegmentCount,
+                             contourIDWithFlags,
+                             m_gpuTessVertexSpanCount);
+    m_gpuTessVertexSpanCount += spanCount;
+
+    if (tessLocation != TessCurve::kNoForwardLocation)
+    {
+        assert(tessLocation == m_pathTessLocation);
+        m_pathTessLocation += totalVertexCount;
+        assert(m_pathTessLocation <= m_expectedPathTessLocationAtEndOfPath);
+    }
+    if (mirroredTessLocation != TessCurve::kNoMirroredLocation)
+    {
+        assert(mirroredTessLocation == m_pathMirroredTessLocation);
+        m_pathMirroredTessLocation -= totalVertexCount;
+        assert(m_pathMirroredTessLocation >= m_expectedPathMirroredTessLocationAtEndOfPath);
+    }
+}
+
 void PLSRenderContext::LogicalFlush::pushInteriorTriangulation(InteriorTriangulationDraw* draw)
 {
     assert(m_hasDoneLayout);
 
-    assert(m_ctx->m_triangleVertexData.hasRoomFor(draw->triangulator()->maxVertexCount()));
-    uint32_t baseVertex = m_ctx->m_triangleVertexData.elementsWritten();
+    assert(m_triangleVertexData.hasRoomFor(draw->resourceCounts().maxTriangleVertexCount));
+    uint32_t baseVertex = m_firstTriangleVertex + m_triangleVertexData.elementsWritten();
     size_t actualVertexCount =
-        draw->triangulator()->polysToTriangles(&m_ctx->m_triangleVertexData, m_currentPathID);
-    assert(actualVertexCount <= draw->triangulator()->maxVertexCount());
+        draw->pushInteriorTriangles(&m_triangleVertexData, m_currentPathID);
+    if (draw->usesStencilThenCover())
+    {
+        assert(m_flushDesc.interlockMode == pls::InterlockMode::depthStencil);
+        const AABB& bounds = draw->coverBounds();
+        Vec2D coverPts[] = {{bounds.minX, bounds.minY},
+                            {bounds.maxX, bounds.minY},
+                            {bounds.maxX, bounds.maxY},
+                            {bounds.minX, bounds.maxY}};
+        for (int i : {0, 1, 2, 2, 3, 0})
+        {
+            m_triangleVertexData.emplace_back(coverPts[i], 0, m_currentPathID);
+        }
+        actualVertexCount += pls::kStencilCoverVertexCount;
+    }
+    assert(actualVertexCount <= draw->resourceCounts().maxTriangleVertexCount);
     DrawBatch& batch =
         pushPathDraw(draw, DrawType::interiorTriangulation, actualVertexCount, baseVertex);
     // Interior triangulations are allowed to disable raster ordering since they are guaranteed to
@@ -1718,30 +3967,52 @@ void PLSRenderContext::LogicalFlush::pushImageRect(ImageRectDraw* draw)
     // instead of calling this method.
     assert(!m_ctx->frameSupportsImagePaintForPaths());
 
-    size_t imageDrawDataOffset = m_ctx->m_imageDrawUniformData.bytesWritten();
-    m_ctx->m_imageDrawUniformData.emplace_back(draw->matrix(),
-                                               draw->opacity(),
-                                               draw->clipRectInverseMatrix(),
-                                               draw->clipID(),
-                                               draw->blendMode(),
-                                               m_currentZIndex);
+    size_t imageDrawDataOffset = m_firstImageDraw * sizeof(pls::ImageDrawUniforms) +
+                                 m_imageDrawUniformData.bytesWritten();
+    m_imageDrawUniformData.emplace_back(draw->matrix(),
+                                        draw->opacity(),
+                                        draw->clipRectInverseMatrix(),
+                                        draw->clipID(),
+                                        draw->blendMode(),
+                                        m_currentZIndex,
+                                        draw->texCoordBounds());
 
     DrawBatch& batch = pushDraw(draw, DrawType::imageRect, PaintType::image, 1, 0);
     batch.imageDrawDataOffset = imageDrawDataOffset;
 }
 
+void PLSRenderContext::LogicalFlush::pushSolidRect(SolidRectDraw* draw)
+{
+    assert(m_hasDoneLayout);
+    assert(SolidRectDraw::FrameSupports(m_ctx));
+
+    size_t imageDrawDataOffset = m_firstImageDraw * sizeof(pls::ImageDrawUniforms) +
+                                 m_imageDrawUniformData.bytesWritten();
+    m_imageDrawUniformData.emplace_back(draw->matrix(),
+                                        draw->color(),
+                                        draw->clipRectInverseMatrix(),
+                                        draw->clipID(),
+                                        draw->blendMode(),
+                                        m_currentZIndex);
+
+    DrawBatch& batch = pushDraw(draw, DrawType::imageRect, PaintType::solidColor, 1, 0);
+    batch.imageDrawDataOffset = imageDrawDataOffset;
+}
+
 void PLSRenderContext::LogicalFlush::pushImageMesh(ImageMeshDraw* draw)
 {
 
     assert(m_hasDoneLayout);
 
-    size_t imageDrawDataOffset = m_ctx->m_imageDrawUniformData.bytesWritten();
-    m_ctx->m_imageDrawUniformData.emplace_back(draw->matrix(),
-                                               draw->opacity(),
-                                               draw->clipRectInverseMatrix(),
-                                               draw->clipID(),
-                                               draw->blendMode(),
-                                               m_currentZIndex);
+    size_t imageDrawDataOffset = m_firstImageDraw * sizeof(pls::ImageDrawUniforms) +
+                                 m_imageDrawUniformData.bytesWritten();
+    m_imageDrawUniformData.emplace_back(draw->matrix(),
+                                        draw->opacity(),
+                                        draw->clipRectInverseMatrix(),
+                                        draw->clipID(),
+                                        draw->blendMode(),
+                                        m_currentZIndex,
+                                        draw->texCoordBounds());
 
     DrawBatch& batch = pushDraw(draw, DrawType::imageMesh, PaintType::image, draw->indexCount(), 0);
     batch.vertexBuffer = draw->vertexBuffer();
@@ -1754,18 +4025,19 @@ void PLSRenderContext::LogicalFlush::pushStencilClipReset(StencilClipReset* draw
 {
     assert(m_hasDoneLayout);
 
-    uint32_t baseVertex = m_ctx->m_triangleVertexData.elementsWritten();
-    auto [L, T, R, B] = AABB(getClipInfo(draw->previousClipID()).contentBounds);
+    uint32_t baseVertex = m_firstTriangleVertex + m_triangleVertexData.elementsWritten();
+    // The stencil clip reset covers the previous clip's contentBounds, which were captured in its
+    // pixelBounds. (Its ClipInfo may have been recycled since then.)
+    auto [L, T, R, B] = AABB(draw->pixelBounds());
     uint32_t Z = m_currentZIndex;
-    assert(AABB(L, T, R, B).round() == draw->pixelBounds());
     assert(draw->resourceCounts().maxTriangleVertexCount == 6);
-    assert(m_ctx->m_triangleVertexData.hasRoomFor(6));
-    m_ctx->m_triangleVertexData.emplace_back(Vec2D{L, B}, 0, Z);
-    m_ctx->m_triangleVertexData.emplace_back(Vec2D{L, T}, 0, Z);
-    m_ctx->m_triangleVertexData.emplace_back(Vec2D{R, B}, 0, Z);
-    m_ctx->m_triangleVertexData.emplace_back(Vec2D{R, B}, 0, Z);
-    m_ctx->m_triangleVertexData.emplace_back(Vec2D{L, T}, 0, Z);
-    m_ctx->m_triangleVertexData.emplace_back(Vec2D{R, T}, 0, Z);
+    assert(m_triangleVertexData.hasRoomFor(6));
+    m_triangleVertexData.emplace_back(Vec2D{L, B}, 0, Z);
+    m_triangleVertexData.emplace_back(Vec2D{L, T}, 0, Z);
+    m_triangleVertexData.emplace_back(Vec2D{R, B}, 0, Z);
+    m_triangleVertexData.emplace_back(Vec2D{R, B}, 0, Z);
+    m_triangleVertexData.emplace_back(Vec2D{L, T}, 0, Z);
+    m_triangleVertexData.emplace_back(Vec2D{R, T}, 0, Z);
     pushDraw(draw, DrawType::stencilClipReset, PaintType::clipUpdate, 6, baseVertex);
 }
 
@@ -1806,11 +4078,13 @@ pls::DrawBatch& PLSRenderContext::LogicalFlush::pushPathDraw(PLSPathDraw* draw,
 }
 
 RIVE_ALWAYS_INLINE static bool can_combine_draw_images(const PLSTexture* currentDrawTexture,
-                                                       const PLSTexture* nextDrawTexture)
+                                                       const PLSTexture* nextDrawTexture,
+                                                       bool bindlessImagePaints)
 {
-    if (currentDrawTexture == nullptr || nextDrawTexture == nullptr)
+    if (currentDrawTexture == nullptr || nextDrawTexture == nullptr || bindlessImagePaints)
     {
-        // We can always combine two draws if one or both do not use an image paint.
+        // We can always combine two draws if one or both do not use an image paint, or if image
+        // paints are sampled bindlessly.
         return true;
     }
     // Since the image paint's texture must be bound to a specific slot, we can't combine draws that
@@ -1826,6 +4100,8 @@ pls::DrawBatch& PLSRenderContext::LogicalFlush::pushDraw(PLSDraw* draw,
 {
     assert(m_hasDoneLayout);
 
+    bool bindlessImagePaints =
+        uses_bindless_image_paints(m_flushDesc.interlockMode, m_ctx->platformFeatures());
     bool needsNewBatch;
     switch (drawType)
     {
@@ -1837,7 +4113,9 @@ pls::DrawBatch& PLSRenderContext::LogicalFlush::pushDraw(PLSDraw* draw,
             needsNewBatch =
                 m_drawList.empty() || m_drawList.tail().drawType != drawType ||
                 m_drawList.tail().needsBarrier ||
-                !can_combine_draw_images(m_drawList.tail().imageTexture, draw->imageTexture());
+                !can_combine_draw_images(m_drawList.tail().imageTexture,
+                                         draw->imageTexture(),
+                                         bindlessImagePaints);
             break;
         case DrawType::interiorTriangulation:
         case DrawType::imageRect:
@@ -1847,16 +4125,28 @@ pls::DrawBatch& PLSRenderContext::LogicalFlush::pushDraw(PLSDraw* draw,
             break;
     }
 
-    DrawBatch& batch = needsNewBatch ? m_drawList.emplace_back(m_ctx->perFrameAllocator(),
+    DrawBatch& batch = needsNewBatch ? m_drawList.emplace_back(*m_drawListAllocator,
                                                                drawType,
                                                                draw,
                                                                elementCount,
                                                                baseElement)
                                      : m_drawList.tail();
-    if (!needsNewBatch)
+    if (needsNewBatch)
+    {
+        batch.pixelBounds = draw->pixelBounds();
+        if (m_pendingBlendBarrier)
+        {
+            batch.needsBlendBarrier = true;
+            m_pendingBlendBarrier = false;
+            ++m_blendBarrierCount;
+        }
+    }
+    else
     {
         assert(batch.drawType == drawType);
-        assert(can_combine_draw_images(batch.imageTexture, draw->imageTexture()));
+        assert(can_combine_draw_images(batch.imageTexture,
+                                       draw->imageTexture(),
+                                       bindlessImagePaints));
         assert(!batch.needsBarrier);
         if (m_flushDesc.interlockMode == pls::InterlockMode::depthStencil)
         {
@@ -1872,6 +4162,7 @@ pls::DrawBatch& PLSRenderContext::LogicalFlush::pushDraw(PLSDraw* draw,
         draw->setBatchInternalNeighbor(batch.internalDrawList);
         batch.internalDrawList = draw;
         batch.elementCount += elementCount;
+        batch.pixelBounds = batch.pixelBounds.join(draw->pixelBounds());
     }
 
     if (paintType == PaintType::image)
@@ -1881,7 +4172,9 @@ pls::DrawBatch& PLSRenderContext::LogicalFlush::pushDraw(PLSDraw* draw,
         {
             batch.imageTexture = draw->imageTexture();
         }
-        assert(batch.imageTexture == draw->imageTexture());
+        // With bindless image paints, batch.imageTexture is just the first of the batch's images.
+        // (Backends that upload textures lazily have to walk the batch's draws.)
+        assert(bindlessImagePaints || batch.imageTexture == draw->imageTexture());
     }
 
     auto shaderFeatures = ShaderFeatures::NONE;
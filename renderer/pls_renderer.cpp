@@ -4,11 +4,13 @@
 
 #include "rive/pls/pls_renderer.hpp"
 
+#include "pls_loader_factory.hpp"
 #include "pls_paint.hpp"
 #include "pls_path.hpp"
 #include "rive/math/math_types.hpp"
 #include "rive/math/simd.hpp"
 #include "rive/pls/pls_image.hpp"
+#include "rive/pls/pls_trace.hpp"
 #include "shaders/constants.glsl"
 
 namespace rive::pls
@@ -49,6 +51,133 @@ bool PLSRenderer::IsAABB(const RawPath& path, AABB* result)
     return false;
 }
 
+// Cubic control point offset, as a fraction of the radius, for a quarter circle (or ellipse).
+constexpr static float kCircleConstant = 0.552284749831f;
+
+// Checks if the cubic 'p' is a quarter ellipse that rounds off one of the corners of 'bounds'. If
+// it is, sets the corner's bit in 'cornerMask' and writes its x and y radii into 'radii'.
+static bool is_rounded_corner(const Vec2D p[4],
+                              const AABB& bounds,
+                              Vec2D* radii,
+                              uint32_t* cornerMask)
+{
+    auto isOnVerticalEdge = [&bounds](Vec2D pt) {
+        return pt.x == bounds.left() || pt.x == bounds.right();
+    };
+    auto isOnHorizontalEdge = [&bounds](Vec2D pt) {
+        return pt.y == bounds.top() || pt.y == bounds.bottom();
+    };
+
+    // The corner shares its x coordinate with one endpoint and its y coordinate with the other.
+    Vec2D corner;
+    if (isOnVerticalEdge(p[0]) && isOnHorizontalEdge(p[3]))
+    {
+        corner = {p[0].x, p[3].y};
+    }
+    else if (isOnHorizontalEdge(p[0]) && isOnVerticalEdge(p[3]))
+    {
+        corner = {p[3].x, p[0].y};
+    }
+    else
+    {
+        return false;
+    }
+
+    Vec2D arcRadii = {fabsf(p[3].x - p[0].x), fabsf(p[3].y - p[0].y)};
+    if (arcRadii.x == 0 || arcRadii.y == 0)
+    {
+        return false;
+    }
+
+    // Both control points must pull toward the corner by the circle constant.
+    float tolerance = std::max(arcRadii.x, arcRadii.y) * 1e-2f;
+    Vec2D expectedP1 = p[0] + (corner - p[0]) * kCircleConstant;
+    Vec2D expectedP2 = p[3] + (corner - p[3]) * kCircleConstant;
+    if ((p[1] - expectedP1).length() > tolerance || (p[2] - expectedP2).length() > tolerance)
+    {
+        return false;
+    }
+
+    // Every corner must be rounded exactly once, all by the same amount.
+    uint32_t cornerBit = 1 << ((corner.x == bounds.right() ? 1 : 0) +
+                               (corner.y == bounds.bottom() ? 2 : 0));
+    if (*cornerMask & cornerBit)
+    {
+        return false;
+    }
+    if (*cornerMask != 0 && (fabsf(arcRadii.x - radii->x) > tolerance ||
+                             fabsf(arcRadii.y - radii->y) > tolerance))
+    {
+        return false;
+    }
+    *cornerMask |= cornerBit;
+    *radii = arcRadii;
+    return true;
+}
+
+bool PLSRenderer::IsRoundedRect(const RawPath& path, AABB* rect, Vec2D* cornerRadii)
+{
+    Span<const PathVerb> verbs = path.verbs();
+    Span<const Vec2D> pts = path.points();
+    if (verbs.count() < 5 || verbs[0] != PathVerb::move)
+    {
+        return false;
+    }
+
+    // Accept a single contour of four rounded corners, connected by lines that run along the edges
+    // of the path's bounds.
+    AABB bounds = path.bounds();
+    auto isEdgeLine = [&bounds](Vec2D a, Vec2D b) {
+        return (a.x == b.x && (a.x == bounds.left() || a.x == bounds.right())) ||
+               (a.y == b.y && (a.y == bounds.top() || a.y == bounds.bottom()));
+    };
+    Vec2D radii;
+    uint32_t cornerMask = 0;
+    size_t ptIdx = 1;
+    for (size_t i = 1; i < verbs.count(); ++i)
+    {
+        switch (verbs[i])
+        {
+            case PathVerb::line:
+                if (!isEdgeLine(pts[ptIdx - 1], pts[ptIdx]))
+                {
+                    return false;
+                }
+                ptIdx += 1;
+                break;
+            case PathVerb::cubic:
+                if (!is_rounded_corner(&pts[ptIdx - 1], bounds, &radii, &cornerMask))
+                {
+                    return false;
+                }
+                ptIdx += 3;
+                break;
+            case PathVerb::close:
+                if (i != verbs.count() - 1)
+                {
+                    return false;
+                }
+                break;
+            default:
+                return false;
+        }
+    }
+
+    // The contour closes with an implicit line back to its start point.
+    if (cornerMask != 0xf || !(pts[ptIdx - 1] == pts[0] || isEdgeLine(pts[ptIdx - 1], pts[0])))
+    {
+        return false;
+    }
+    if (radii.x > bounds.width() * .5f + math::EPSILON ||
+        radii.y > bounds.height() * .5f + math::EPSILON)
+    {
+        return false;
+    }
+    *rect = bounds;
+    *cornerRadii = radii;
+    return true;
+}
+
 PLSRenderer::ClipElement::ClipElement(const Mat2D& matrix_,
                                       const PLSPath* path_,
                                       FillRule fillRule_)
@@ -63,6 +192,8 @@ void PLSRenderer::ClipElement::reset(const Mat2D& matrix_, const PLSPath* path_,
     matrix = matrix_;
     rawPathMutationID = path_->getRawPathMutationID();
     pathBounds = path_->getBounds();
+    // Outset by a pixel for antialiasing.
+    pixelBounds = matrix.mapBoundingBox(pathBounds).inset(-1, -1).roundOut();
     path = ref_rcp(path_);
     fillRule = fillRule_;
     clipID = 0; // This gets initialized lazily.
@@ -100,34 +231,120 @@ void PLSRenderer::transform(const Mat2D& matrix)
 
 void PLSRenderer::drawPath(RenderPath* renderPath, RenderPaint* renderPaint)
 {
+    PLS_TRACE_SCOPE("PLSRenderer::drawPath");
     LITE_RTTI_CAST_OR_RETURN(path, PLSPath*, renderPath);
     LITE_RTTI_CAST_OR_RETURN(paint, PLSPaint*, renderPaint);
 
-    if (path->getRawPath().empty())
+    if (!shouldDrawPath(path, paint))
+    {
+        return;
+    }
+
+    clipAndPushDraw(PLSPathDraw::Make(m_context,
+                                      viewMatrix(),
+                                      ref_rcp(path),
+                                      path->getFillRule(),
+                                      paint,
+                                      &m_scratchPath));
+}
+
+void PLSRenderer::drawPathInstanced(RenderPath* renderPath,
+                                    RenderPaint* renderPaint,
+                                    Span<const Mat2D> matrices,
+                                    Span<const ColorInt> colors)
+{
+    LITE_RTTI_CAST_OR_RETURN(path, PLSPath*, renderPath);
+    LITE_RTTI_CAST_OR_RETURN(paint, PLSPaint*, renderPaint);
+    assert(colors.empty() || colors.size() == matrices.size());
+
+    if (matrices.empty() || !shouldDrawPath(path, paint))
     {
         return;
     }
 
+    assert(m_instanceDraws.empty());
+    PLSPathDraw::MakeInstances(m_context,
+                               viewMatrix(),
+                               matrices,
+                               colors,
+                               ref_rcp(path),
+                               path->getFillRule(),
+                               paint,
+                               &m_scratchPath,
+                               &m_instanceDraws);
+    for (PLSDrawUniquePtr& draw : m_instanceDraws)
+    {
+        clipAndPushDraw(std::move(draw));
+    }
+    m_instanceDraws.clear();
+}
+
+bool PLSRenderer::shouldDrawPath(const PLSPath* path, const PLSPaint* paint) const
+{
+    if (path->getRawPath().empty())
+    {
+        return false;
+    }
+
     bool stroked = paint->getIsStroked();
     if (stroked && m_context->frameDescriptor().strokesDisabled)
     {
-        return;
+        return false;
     }
     if (!stroked && m_context->frameDescriptor().fillsDisabled)
     {
-        return;
+        return false;
     }
     if (stroked && !(paint->getThickness() > 0)) // Use inverse logic to ensure we abort when stroke
     {                                            // thickness is NaN.
-        return;
+        return false;
     }
 
-    clipAndPushDraw(PLSPathDraw::Make(m_context,
-                                      m_stack.back().matrix,
-                                      ref_rcp(path),
-                                      path->getFillRule(),
-                                      paint,
-                                      &m_scratchPath));
+    return true;
+}
+
+void PLSRenderer::drawPathsInParallel(RenderPath* const renderPaths[],
+                                      RenderPaint* const renderPaints[],
+                                      size_t count,
+                                      const ParallelForFn& parallelFor)
+{
+    std::vector<PLSPath*> paths;
+    std::vector<PLSPaint*> paints;
+    paths.reserve(count);
+    paints.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto path = lite_rtti_cast<PLSPath*>(renderPaths[i]);
+        auto paint = lite_rtti_cast<PLSPaint*>(renderPaints[i]);
+        if (path == nullptr || paint == nullptr || !shouldDrawPath(path, paint))
+        {
+            continue;
+        }
+        // PLSPath and PLSPaint compute some of their properties lazily. Resolve them up front so
+        // the recording threads only ever read from them.
+        path->getBounds();
+        path->getCoarseArea();
+        path->getRawPathMutationID();
+        paint->getIsOpaque();
+        paths.push_back(path);
+        paints.push_back(paint);
+    }
+
+    const Mat2D matrix = viewMatrix();
+    std::vector<PLSDrawUniquePtr> draws(paths.size());
+    parallelFor(paths.size(), [&](size_t threadIdx, size_t i) {
+        draws[i] = PLSPathDraw::Make(m_context,
+                                     &m_context->recordingThreadAllocators(threadIdx),
+                                     matrix,
+                                     ref_rcp(paths[i]),
+                                     paths[i]->getFillRule(),
+                                     paints[i]);
+    });
+
+    for (PLSDrawUniquePtr& draw : draws)
+    {
+        clipAndPushDraw(std::move(draw));
+    }
 }
 
 void PLSRenderer::clipPath(RenderPath* renderPath)
@@ -144,10 +361,18 @@ void PLSRenderer::clipPath(RenderPath* renderPath)
     // Multiple axis-aligned rectangles can be intersected into a single rectangle if their matrices
     // are compatible.
     AABB clipRectCandidate;
+    Vec2D cornerRadii;
     if (m_context->frameSupportsClipRects() && IsAABB(path->getRawPath(), &clipRectCandidate))
     {
         clipRectImpl(clipRectCandidate, path);
     }
+    // Rounded rects and ellipses can also be clipRects, when the shaders are able to find their
+    // corner coverage analytically.
+    else if (m_context->frameSupportsRoundedClipRects() &&
+             IsRoundedRect(path->getRawPath(), &clipRectCandidate, &cornerRadii))
+    {
+        clipRectImpl(clipRectCandidate, path, cornerRadii);
+    }
     else
     {
         clipPathImpl(path);
@@ -190,7 +415,13 @@ static bool transform_rect_to_new_space(AABB* rect,
     return true;
 }
 
-void PLSRenderer::clipRectImpl(AABB rect, const PLSPath* originalPath)
+static bool rect_contains(const AABB& outer, const AABB& inner)
+{
+    return outer.left() <= inner.left() && outer.top() <= inner.top() &&
+           outer.right() >= inner.right() && outer.bottom() >= inner.bottom();
+}
+
+void PLSRenderer::clipRectImpl(AABB rect, const PLSPath* originalPath, Vec2D cornerRadii)
 {
     bool hasClipRect = m_stack.back().clipRectInverseMatrix != nullptr;
     if (rect.isEmptyOrNaN())
@@ -199,24 +430,58 @@ void PLSRenderer::clipRectImpl(AABB rect, const PLSPath* originalPath)
         return;
     }
 
+    if (!hasClipRect && m_context->frameDirtyBoundsClipRect() != nullptr)
+    {
+        // Every draw is implicitly clipped to the frame's dirty bounds in screen space. Start from
+        // that rect so the new one can be intersected with it.
+        m_stack.back().clipRect = AABB(m_context->frameDescriptor().dirtyBounds);
+        m_stack.back().clipRectMatrix = Mat2D();
+        m_stack.back().clipRectCornerRadii = {0, 0};
+        hasClipRect = true;
+    }
+
     // If there already is a clipRect, we can only accept another one by intersecting it with the
     // existing one. This means the new rect must be axis-aligned with the existing clipRect.
-    if (hasClipRect &&
-        !transform_rect_to_new_space(&rect, m_stack.back().matrix, m_stack.back().clipRectMatrix))
+    AABB rectInClipRectSpace = rect;
+    if (hasClipRect && !transform_rect_to_new_space(&rectInClipRectSpace,
+                                                    viewMatrix(),
+                                                    m_stack.back().clipRectMatrix))
     {
         // 'rect' is not axis-aligned with the existing clipRect. Fall back to clipPath.
         clipPathImpl(originalPath);
         return;
     }
 
+    const bool isRounded = cornerRadii.x > 0 && cornerRadii.y > 0;
+    const bool clipRectIsRounded =
+        hasClipRect && (m_stack.back().clipRectCornerRadii.x > 0 ||
+                        m_stack.back().clipRectCornerRadii.y > 0);
+    if (hasClipRect && (isRounded || clipRectIsRounded))
+    {
+        // Rounded rects can't be intersected geometrically. They only combine when one of the two
+        // rects contains the other one entirely.
+        if (!isRounded && rect_contains(rectInClipRectSpace, m_stack.back().clipRect))
+        {
+            return; // The existing (rounded) clipRect is already inside 'rect'.
+        }
+        if (clipRectIsRounded || !rect_contains(m_stack.back().clipRect, rectInClipRectSpace))
+        {
+            clipPathImpl(originalPath);
+            return;
+        }
+        hasClipRect = false; // The new rounded rect is inside the existing clipRect. Replace it.
+    }
+
     if (!hasClipRect)
     {
         // There wasn't an existing clipRect. This is the one!
         m_stack.back().clipRect = rect;
-        m_stack.back().clipRectMatrix = m_stack.back().matrix;
+        m_stack.back().clipRectMatrix = viewMatrix();
+        m_stack.back().clipRectCornerRadii = isRounded ? cornerRadii : Vec2D{0, 0};
     }
     else
     {
+        rect = rectInClipRectSpace;
         // Both rects are in the same space now. Intersect the two geometrically.
         float4 a = simd::load4f(&m_stack.back().clipRect);
         float4 b = simd::load4f(&rect);
@@ -226,7 +491,12 @@ void PLSRenderer::clipRectImpl(AABB rect, const PLSPath* originalPath)
 
     m_stack.back().clipRectInverseMatrix =
         m_context->make<pls::ClipRectInverseMatrix>(m_stack.back().clipRectMatrix,
-                                                    m_stack.back().clipRect);
+                                                    m_stack.back().clipRect,
+                                                    m_stack.back().clipRectCornerRadii);
+    intersectClipBounds(m_stack.back()
+                            .clipRectMatrix.mapBoundingBox(m_stack.back().clipRect)
+                            .inset(-1, -1)
+                            .roundOut());
 }
 
 void PLSRenderer::clipPathImpl(const PLSPath* path)
@@ -246,17 +516,65 @@ void PLSRenderer::clipPathImpl(const PLSPath* path)
     const size_t clipStackHeight = m_stack.back().clipStackHeight;
     assert(m_clipStack.size() >= clipStackHeight);
     if (m_clipStack.size() == clipStackHeight ||
-        !m_clipStack[clipStackHeight].isEquivalent(m_stack.back().matrix, path))
+        !m_clipStack[clipStackHeight].isEquivalent(viewMatrix(), path))
     {
         m_clipStack.resize(clipStackHeight);
-        m_clipStack.emplace_back(m_stack.back().matrix, path, path->getFillRule());
+        m_clipStack.emplace_back(viewMatrix(), path, path->getFillRule());
     }
     m_stack.back().clipStackHeight = clipStackHeight + 1;
+    intersectClipBounds(m_clipStack[clipStackHeight].pixelBounds);
+}
+
+void PLSRenderer::intersectClipBounds(const IAABB& bounds)
+{
+    RenderState& state = m_stack.back();
+    state.clipBounds = state.hasClipBounds ? state.clipBounds.intersect(bounds) : bounds;
+    state.hasClipBounds = true;
+    if (state.clipBounds.empty())
+    {
+        // Nested clips that don't overlap. Nothing can draw until the next restore().
+        state.clipIsEmpty = true;
+    }
+}
+
+// Returns how many screen pixels a texel covers along its longest axis, when an image is drawn in
+// its own pixel space with the given matrix.
+static float pixels_per_texel(const Mat2D& matrix)
+{
+    return std::max(Vec2D(matrix.xx(), matrix.xy()).length(),
+                    Vec2D(matrix.yx(), matrix.yy()).length());
+}
+
+// Swaps a buffer from PLSRenderContext::loaderFactory() for the backend buffer it stages into.
+static rcp<RenderBuffer> resolve_render_buffer(PLSRenderContext* context, rcp<RenderBuffer> buffer)
+{
+    if (auto deferredBuffer = lite_rtti_cast<PLSDeferredRenderBuffer*>(buffer.get()))
+    {
+        return deferredBuffer->resolve(context);
+    }
+    return buffer;
+}
+
+// Uploading an atlas page touches the backend, which may still be submitting the previous frame
+// (see PLSRenderContext::setPipelinedSubmission()).
+static const PLSTexture* draw_texture(PLSRenderContext* context, const PLSImage* image)
+{
+    if (image->needsUpload())
+    {
+        context->waitForPendingSubmission();
+    }
+    return image->drawTexture(context->impl());
 }
 
 void PLSRenderer::drawImage(const RenderImage* renderImage, BlendMode blendMode, float opacity)
 {
     LITE_RTTI_CAST_OR_RETURN(image, const PLSImage*, renderImage);
+    const PLSTexture* plsTexture = draw_texture(m_context, image);
+    if (plsTexture == nullptr)
+    {
+        return;
+    }
+    image->noteDrawScale(pixels_per_texel(viewMatrix()));
 
     // Scale the view matrix so we can draw this image as the rect [0, 0, 1, 1].
     save();
@@ -266,16 +584,43 @@ void PLSRenderer::drawImage(const RenderImage* renderImage, BlendMode blendMode,
     {
         // Fall back on ImageRectDraw if the current frame doesn't support drawing paths with image
         // paints.
-        const Mat2D& m = m_stack.back().matrix;
-        auto plsImage = static_cast<const PLSImage*>(renderImage);
+        const Mat2D m = viewMatrix();
         clipAndPushDraw(PLSDrawUniquePtr(
             m_context->make<ImageRectDraw>(m_context,
                                            m.mapBoundingBox(AABB{0, 0, 1, 1}).roundOut(),
                                            m,
                                            blendMode,
-                                           plsImage->refTexture(),
+                                           ref_rcp(plsTexture),
+                                           image->texCoordBounds(),
                                            opacity)));
     }
+    else if (image->isAtlased())
+    {
+        // Image paints sample at the path's local coordinates. Draw the image's region of its atlas
+        // page as a rectangle in texture coordinates, and map that region back onto [0, 0, 1, 1].
+        const AABB& uv = image->texCoordBounds();
+        transform(Mat2D(1 / uv.width(),
+                        0,
+                        0,
+                        1 / uv.height(),
+                        -uv.left() / uv.width(),
+                        -uv.top() / uv.height()));
+        if (image->atlasRectPath() == nullptr)
+        {
+            auto path = make_rcp<PLSPath>();
+            path->moveTo(uv.left(), uv.top());
+            path->lineTo(uv.right(), uv.top());
+            path->lineTo(uv.right(), uv.bottom());
+            path->lineTo(uv.left(), uv.bottom());
+            path->close();
+            image->setAtlasRectPath(std::move(path));
+        }
+
+        PLSPaint paint;
+        paint.image(ref_rcp(plsTexture), opacity);
+        paint.blendMode(blendMode);
+        drawPath(image->atlasRectPath(), &paint);
+    }
     else
     {
         // Implement drawImage() as drawPath() with a rectangular path and an image paint.
@@ -288,7 +633,7 @@ void PLSRenderer::drawImage(const RenderImage* renderImage, BlendMode blendMode,
         }
 
         PLSPaint paint;
-        paint.image(image->refTexture(), opacity);
+        paint.image(ref_rcp(plsTexture), opacity);
         paint.blendMode(blendMode);
         drawPath(m_unitRectPath.get(), &paint);
     }
@@ -306,16 +651,31 @@ void PLSRenderer::drawImageMesh(const RenderImage* renderImage,
                                 float opacity)
 {
     LITE_RTTI_CAST_OR_RETURN(image, const PLSImage*, renderImage);
-    const PLSTexture* plsTexture = image->getTexture();
+    const PLSTexture* plsTexture = draw_texture(m_context, image);
+    if (plsTexture == nullptr)
+    {
+        return;
+    }
+    // Mesh vertices are authored in the image's pixel space, so the view matrix alone determines
+    // how many screen pixels each texel covers.
+    image->noteDrawScale(pixels_per_texel(viewMatrix()));
 
     assert(vertices_f32);
     assert(uvCoords_f32);
     assert(indices_u16);
+    vertices_f32 = resolve_render_buffer(m_context, std::move(vertices_f32));
+    uvCoords_f32 = resolve_render_buffer(m_context, std::move(uvCoords_f32));
+    indices_u16 = resolve_render_buffer(m_context, std::move(indices_u16));
+    if (vertices_f32 == nullptr || uvCoords_f32 == nullptr || indices_u16 == nullptr)
+    {
+        return;
+    }
 
     clipAndPushDraw(PLSDrawUniquePtr(m_context->make<ImageMeshDraw>(PLSDraw::kFullscreenPixelBounds,
-                                                                    m_stack.back().matrix,
+                                                                    viewMatrix(),
                                                                     blendMode,
                                                                     ref_rcp(plsTexture),
+                                                                    image->texCoordBounds(),
                                                                     std::move(vertices_f32),
                                                                     std::move(uvCoords_f32),
                                                                     std::move(indices_u16),
@@ -329,6 +689,13 @@ void PLSRenderer::clipAndPushDraw(PLSDrawUniquePtr draw)
     {
         return;
     }
+    if (m_stack.back().hasClipBounds &&
+        draw->pixelBounds().intersect(m_stack.back().clipBounds).empty())
+    {
+        // The draw is entirely clipped out. Skip it, along with the clip updates it would have
+        // needed.
+        return;
+    }
     if (m_context->isOutsideCurrentFrame(draw->pixelBounds()))
     {
         return;
@@ -384,7 +751,11 @@ void PLSRenderer::clipAndPushDraw(PLSDrawUniquePtr draw)
 
 bool PLSRenderer::applyClip(PLSDraw* draw)
 {
-    draw->setClipRect(m_stack.back().clipRectInverseMatrix);
+    // If there is no clipRect, still clip to the frame's dirty bounds (if any), so that draws
+    // overhanging the dirty region don't blend over preserved pixels.
+    draw->setClipRect(m_stack.back().clipRectInverseMatrix != nullptr
+                          ? m_stack.back().clipRectInverseMatrix
+                          : m_context->frameDirtyBoundsClipRect());
 
     const size_t clipStackHeight = m_stack.back().clipStackHeight;
     if (clipStackHeight == 0)
@@ -453,6 +824,15 @@ bool PLSRenderer::applyClip(PLSDraw* draw)
             {
                 return false; // The context is out of clipIDs. We will flush and try again.
             }
+            // The ID may have been recycled from another element that is no longer in the clip
+            // buffer. Forget it there, so that element can't be mistaken for the clip content.
+            for (ClipElement& otherClip : m_clipStack)
+            {
+                if (&otherClip != &clip && otherClip.clipID == clip.clipID)
+                {
+                    otherClip.clipID = 0;
+                }
+            }
             clipDraw->setClipID(clip.clipID);
             if (!m_context->isOutsideCurrentFrame(clipDrawBounds))
             {
@@ -462,7 +842,10 @@ bool PLSRenderer::applyClip(PLSDraw* draw)
 
         if (lastClipID != 0)
         {
-            m_context->addClipReadBounds(lastClipID, clipDrawBounds);
+            if (!m_context->addClipReadBounds(lastClipID, clipDrawBounds))
+            {
+                return false; // lastClipID's ID was recycled. We will flush and try again.
+            }
             if (m_context->frameInterlockMode() == pls::InterlockMode::depthStencil)
             {
                 // When drawing nested stencil clips, we need to intersect them, which involves
@@ -483,7 +866,10 @@ bool PLSRenderer::applyClip(PLSDraw* draw)
     }
     assert(lastClipID == m_clipStack[clipStackHeight - 1].clipID);
     draw->setClipID(lastClipID);
-    m_context->addClipReadBounds(lastClipID, draw->pixelBounds());
+    if (!m_context->addClipReadBounds(lastClipID, draw->pixelBounds()))
+    {
+        return false; // lastClipID's ID was recycled. We will flush and try again.
+    }
     m_context->setClipContentID(lastClipID);
     return true;
 }
@@ -147,7 +147,8 @@ IMAGE_RECT_VERTEX_MAIN(@drawVertexMain, Attrs, attrs, _vertexID, _instanceID)
         }
     }
 
-    v_texCoord = vertexPosition;
+    v_texCoord = vertexPosition * imageDrawUniforms.texCoordTransform.xy +
+                 imageDrawUniforms.texCoordTransform.zw;
     vertexPosition = MUL(M, vertexPosition) + imageDrawUniforms.translate;
 
     if (isOuterVertex)
@@ -210,7 +211,8 @@ IMAGE_MESH_VERTEX_MAIN(@drawVertexMain, PositionAttr, position, UVAttr, uv, _ver
 
     float2x2 M = make_float2x2(imageDrawUniforms.viewMatrix);
     float2 vertexPosition = MUL(M, @a_position) + imageDrawUniforms.translate;
-    v_texCoord = @a_texCoord;
+    v_texCoord = @a_texCoord * imageDrawUniforms.texCoordTransform.xy +
+                 imageDrawUniforms.texCoordTransform.zw;
 
 #ifdef @ENABLE_CLIP_RECT
     if (@ENABLE_CLIP_RECT)
@@ -276,6 +278,9 @@ TEXTURE_RGBA8(PER_FLUSH_BINDINGS_SET, GRAD_TEXTURE_IDX, @gradTexture);
 #ifdef NEEDS_IMAGE_TEXTURE
 TEXTURE_RGBA8(PER_DRAW_BINDINGS_SET, IMAGE_TEXTURE_IDX, @imageTexture);
 #endif
+#ifdef @ENABLE_BINDLESS_TEXTURES
+BINDLESS_TEXTURE_TABLE
+#endif
 FRAG_TEXTURE_BLOCK_END
 
 SAMPLER_LINEAR(GRAD_TEXTURE_IDX, gradSampler)
@@ -371,11 +376,11 @@ half4 resolve_path_color(half coverageCount,
 #ifdef @ENABLE_BINDLESS_TEXTURES
             if (paintType == IMAGE_PAINT_TYPE)
             {
-                color = TEXTURE_SAMPLE_GRAD(sampler2D(floatBitsToUint(translate.zw)),
-                                            imageSampler,
-                                            paintCoord,
-                                            M[0],
-                                            M[1]);
+                color = BINDLESS_TEXTURE_SAMPLE_GRAD(floatBitsToUint(translate.zw),
+                                                     imageSampler,
+                                                     paintCoord,
+                                                     M[0],
+                                                     M[1]);
                 float opacity = uintBitsToFloat(paintData.y);
                 color.a *= opacity;
             }
@@ -385,9 +390,20 @@ half4 resolve_path_color(half coverageCount,
                 float t = paintType == LINEAR_GRADIENT_PAINT_TYPE ? /*linear*/ paintCoord.x
                                                                   : /*radial*/ length(paintCoord);
                 t = clamp(t, .0, 1.);
-                float x = t * translate.z + translate.w;
-                float y = uintBitsToFloat(paintData.y);
-                color = make_half4(TEXTURE_SAMPLE_LOD(@gradTexture, gradSampler, float2(x, y), .0));
+                if ((paintData.x & PAINT_FLAG_ANALYTIC_GRADIENT) != 0u)
+                {
+                    // Two-stop gradient. The colors are packed in translate.zw.
+                    half4 color0 = unpackUnorm4x8(floatBitsToUint(translate.z));
+                    half4 color1 = unpackUnorm4x8(floatBitsToUint(translate.w));
+                    color = mix(color0, color1, make_half4(t));
+                }
+                else
+                {
+                    float x = t * translate.z + translate.w;
+                    float y = uintBitsToFloat(paintData.y);
+                    color = make_half4(
+                        TEXTURE_SAMPLE_LOD(@gradTexture, gradSampler, float2(x, y), .0));
+                }
             }
 #ifdef @ENABLE_CLIPPING
             if (@ENABLE_CLIPPING)
@@ -413,9 +429,20 @@ half4 resolve_path_color(half coverageCount,
         float2x2 M = make_float2x2(STORAGE_BUFFER_LOAD4(@paintAuxBuffer, pathID * 4u + 2u));
         float4 translate = STORAGE_BUFFER_LOAD4(@paintAuxBuffer, pathID * 4u + 3u);
         float2 clipCoord = MUL(M, _fragCoord) + translate.xy;
-        // translate.zw contains -1 / fwidth(clipCoord), which we use to calculate antialiasing.
-        half2 distXY = make_half2(abs(clipCoord) * translate.zw - translate.zw);
-        half clipRectCoverage = clamp(min(distXY.x, distXY.y) + .5, .0, 1.);
+        // Measure edge distances in units of fwidth(clipCoord), for antialiasing.
+        float2 clipRectAAWidth = abs(M[0]) + abs(M[1]);
+        half2 distXY;
+        if (clipRectAAWidth.x != .0 && clipRectAAWidth.y != .0)
+        {
+            distXY = make_half2((1. - abs(clipCoord)) / clipRectAAWidth);
+        }
+        else
+        {
+            // A singular M means translate.xy is a uniform coverage value.
+            distXY = make_half2(translate.xy - .5);
+        }
+        // translate.zw contains the radii of the clipRect's corner ellipses, in the same units.
+        half clipRectCoverage = clamp(clip_rect_coverage(distXY, make_half2(translate.zw)), .0, 1.);
         coverage = min(coverage, clipRectCoverage);
     }
 #endif // ENABLE_CLIP_RECT
@@ -603,7 +630,18 @@ ATOMIC_PLS_MAIN_WITH_IMAGE_UNIFORMS(@drawFragmentMain)
     // get resolved later like other draws because the @imageTexture binding is liable to change,
     // and furthermore in the case of imageMeshes, we can't calculate UV coordinates based on
     // fragment position.
-    half4 imageColor = make_half4(TEXTURE_SAMPLE(@imageTexture, imageSampler, v_texCoord));
+    half4 imageColor;
+#ifdef @DRAW_IMAGE_RECT
+    if (imageDrawUniforms.hasSolidColor != 0u)
+    {
+        // Solid-color rects don't have an image texture.
+        imageColor = make_half4(imageDrawUniforms.solidColor);
+    }
+    else
+#endif
+    {
+        imageColor = make_half4(TEXTURE_SAMPLE(@imageTexture, imageSampler, v_texCoord));
+    }
     half meshCoverage = 1.;
 #ifdef @DRAW_IMAGE_RECT
     meshCoverage = min(v_edgeCoverage, meshCoverage);
@@ -611,7 +649,10 @@ ATOMIC_PLS_MAIN_WITH_IMAGE_UNIFORMS(@drawFragmentMain)
 #ifdef @ENABLE_CLIP_RECT
     if (@ENABLE_CLIP_RECT)
     {
-        half clipRectCoverage = min_value(make_half4(v_clipRect));
+        half2 clipRectEdgeDistances = make_half2(min(v_clipRect.xy, v_clipRect.zw)) - .5;
+        half clipRectCoverage =
+            clip_rect_coverage(clipRectEdgeDistances,
+                               make_half2(imageDrawUniforms.clipRectCornerRadii));
         meshCoverage = clamp(clipRectCoverage, make_half(.0), meshCoverage);
     }
 #endif
@@ -2,6 +2,12 @@
  * Copyright 2024 Rive
  */
 
+#ifdef @ENABLE_UPSCALE
+VARYING_BLOCK_BEGIN
+NO_PERSPECTIVE VARYING(0, float2, v_texCoord);
+VARYING_BLOCK_END
+#endif
+
 #ifdef @VERTEX
 VERTEX_TEXTURE_BLOCK_BEGIN
 VERTEX_TEXTURE_BLOCK_END
@@ -11,11 +17,19 @@ VERTEX_STORAGE_BUFFER_BLOCK_END
 
 VERTEX_MAIN(@blitVertexMain, Attrs, attrs, _vertexID, _instanceID)
 {
+#ifdef @ENABLE_UPSCALE
+    VARYING_INIT(v_texCoord, float2);
+#endif
     // Fill the entire screen. The caller will use a scissor test to control the bounds being drawn.
     float2 coord;
     coord.x = (_vertexID & 1) == 0 ? -1. : 1.;
     coord.y = (_vertexID & 2) == 0 ? -1. : 1.;
     float4 pos = float4(coord, 0, 1);
+#ifdef @ENABLE_UPSCALE
+    // Stretch the entire source texture across the screen.
+    v_texCoord = coord * .5 + .5;
+    VARYING_PACK(v_texCoord);
+#endif
     EMIT_VERTEX(pos);
 }
 #endif
@@ -25,9 +39,18 @@ FRAG_TEXTURE_BLOCK_BEGIN
 TEXTURE_RGBA8(PER_FLUSH_BINDINGS_SET, 0, @blitTextureSource);
 FRAG_TEXTURE_BLOCK_END
 
+#ifdef @ENABLE_UPSCALE
+SAMPLER_LINEAR(0, blitSampler)
+#endif
+
 FRAG_DATA_MAIN(half4, @blitFragmentMain)
 {
+#ifdef @ENABLE_UPSCALE
+    VARYING_UNPACK(v_texCoord, float2);
+    half4 srcColor = TEXTURE_SAMPLE(@blitTextureSource, blitSampler, v_texCoord);
+#else
     half4 srcColor = TEXEL_FETCH(@blitTextureSource, int2(floor(_fragCoord.xy)));
+#endif
     EMIT_FRAG_DATA(srcColor);
 }
 #endif // FRAGMENT
@@ -56,6 +56,29 @@ INLINE half min_value(half4 min4)
 
 INLINE float manhattan_width(float2 x) { return abs(x.x) + abs(x.y); }
 
+#ifdef @FRAGMENT
+// Finds the coverage of a clipRect whose corners may be rounded.
+//
+// 'edgeDistances' are the distances from the pixel center to the nearest vertical and horizontal
+// edges of the clipRect (positive inside), and 'cornerRadii' are the radii of its corner ellipses,
+// both in units of fwidth(clipRect coords). 'cornerRadii' is 0 for a clipRect with sharp corners.
+INLINE half clip_rect_coverage(half2 edgeDistances, half2 cornerRadii)
+{
+    half coverage = min(edgeDistances.x, edgeDistances.y) + .5;
+    if (cornerRadii.x != .0)
+    {
+        // Find how far the pixel is from the center of its nearest corner ellipse, along each axis
+        // toward the corner, and approximate its distance to the ellipse from there. (Exact for
+        // circular corners.)
+        half2 q = max(cornerRadii - edgeDistances, make_half2(.0, .0));
+        half cornerCoverage =
+            (1. - length(q / cornerRadii)) * min(cornerRadii.x, cornerRadii.y) + .5;
+        coverage = min(coverage, cornerCoverage);
+    }
+    return coverage;
+}
+#endif
+
 #ifdef @VERTEX
 UNIFORM_BLOCK_BEGIN(FLUSH_UNIFORM_BUFFER_IDX, @FlushUniforms)
 float gradInverseViewportY;
@@ -149,5 +172,14 @@ float2 clipRectInverseTranslate;
 uint clipID;
 uint blendMode;
 uint zIndex;
+uint hasSolidColor; // imageRect only.
+// Radii of the clipRect's corner ellipses, in units of fwidth(clipRect coords), or 0 if the
+// clipRect has sharp corners.
+float2 clipRectCornerRadii;
+// [scaleX, scaleY, translateX, translateY] from [0, 0, 1, 1] texture coordinates to the region of
+// the texture the image occupies (e.g., its slot in an image atlas).
+float4 texCoordTransform;
+// Unmultiplied color of a solid-color imageRect, if hasSolidColor is nonzero.
+float4 solidColor;
 UNIFORM_BLOCK_END(imageDrawUniforms)
 #endif
@@ -45,7 +45,7 @@
 #define JOIN_TANGENT_INNER_CONTOUR_FLAG (1u << 24u)
 #define LEFT_JOIN_CONTOUR_FLAG (1u << 23u)
 #define RIGHT_JOIN_CONTOUR_FLAG (1u << 22u)
-#define CONTOUR_ID_MASK 0xffffu
+#define CONTOUR_ID_MASK 0x3fffffu
 
 // Says which part of the patch a vertex belongs to.
 #define STROKE_VERTEX 0
@@ -67,6 +67,8 @@
 // Paint flags, found in the x-component value of @paintBuffer.
 #define PAINT_FLAG_EVEN_ODD 0x100u
 #define PAINT_FLAG_HAS_CLIP_RECT 0x200u
+// The gradient's two colors are in @paintAuxBuffer, instead of the gradient texture.
+#define PAINT_FLAG_ANALYTIC_GRADIENT 0x400u
 
 // PLS draw resources are either updated per flush or per draw. They go into set 0
 // or set 1, depending on how often they are updated.
@@ -87,6 +89,10 @@
 #define DST_COLOR_TEXTURE_IDX 10
 #define DEFAULT_BINDINGS_SET_SIZE 11
 
+// Maximum number of sub-draws in a single GL multi-draw call. (Each one consumes a uniform slot for
+// its base instance.)
+#define MAX_MULTI_DRAW_COUNT 16
+
 // Samplers are accessed at the same index as their corresponding texture, so we put them in a
 // separate binding set.
 #define SAMPLER_BINDINGS_SET 2
@@ -97,6 +103,12 @@
 
 #define BINDINGS_SET_COUNT 4
 
+// Vulkan only: the bindless image texture table, which atomic mode indexes with each image paint's
+// texture handle (in place of binding IMAGE_TEXTURE_IDX). Not counted in BINDINGS_SET_COUNT
+// because it's only in the pipeline layout when the device supports descriptor indexing.
+#define BINDLESS_TEXTURES_SET 4
+#define BINDLESS_TEXTURES_IDX 0
+
 // Index of each pixel local storage plane.
 #define COLOR_PLANE_IDX 0
 #define COVERAGE_PLANE_IDX 1
@@ -0,0 +1,198 @@
+import argparse
+import itertools
+import os
+import re
+import subprocess
+import sys
+
+# Compiles the D3D11 draw shaders offline with fxc, so PLSRenderContextD3DImpl can skip D3DCompile
+# for every variant it expects to see at runtime.
+#
+# Each variant is written out as an .hlsl file that #defines the same switches as
+# d3dutil::BuildDrawShaderSource() and #includes the minified glsl. The resulting bytecode headers
+# are then gathered into a table in "d3d/precompiled_draw_shaders.h", which d3d_shaders.cpp
+# searches when RIVE_D3D_PRECOMPILED_SHADERS is defined.
+
+parser = argparse.ArgumentParser(description="Precompile D3D11 PLS draw shaders.")
+parser.add_argument("-o", "--outdir", required=True,
+                    help="generated shader directory (must already contain the minify.py outputs)")
+parser.add_argument("--fxc", default="fxc.exe", help="path to the fxc shader compiler")
+args = parser.parse_args()
+
+# These must stay in sync with pls::ShaderFeatures.
+ENABLE_CLIPPING = 1 << 0
+ENABLE_CLIP_RECT = 1 << 1
+ENABLE_ADVANCED_BLEND = 1 << 2
+ENABLE_EVEN_ODD = 1 << 3
+ENABLE_NESTED_CLIPPING = 1 << 4
+ENABLE_HSL_BLEND_MODES = 1 << 5
+FEATURE_NAMES = {ENABLE_CLIPPING: 'ENABLE_CLIPPING',
+                 ENABLE_CLIP_RECT: 'ENABLE_CLIP_RECT',
+                 ENABLE_ADVANCED_BLEND: 'ENABLE_ADVANCED_BLEND',
+                 ENABLE_EVEN_ODD: 'ENABLE_EVEN_ODD',
+                 ENABLE_NESTED_CLIPPING: 'ENABLE_NESTED_CLIPPING',
+                 ENABLE_HSL_BLEND_MODES: 'ENABLE_HSL_BLEND_MODES'}
+VERTEX_FEATURES = ENABLE_CLIPPING | ENABLE_CLIP_RECT | ENABLE_ADVANCED_BLEND
+
+# These must stay in sync with the capability bits in d3d_shaders.cpp. (Minimum precision is only
+# a hint, so every variant is compiled at full precision and is valid regardless.)
+CAPABILITY_ROV = 1 << 0
+CAPABILITY_TYPED_UAV = 1 << 1
+CAPABILITY_CONFIGURATIONS = [CAPABILITY_ROV | CAPABILITY_TYPED_UAV, CAPABILITY_TYPED_UAV, 0]
+
+# Returns whether a valid program exists for the given feature set.
+def is_valid_feature_set(features):
+    if (features & ENABLE_NESTED_CLIPPING) and not (features & ENABLE_CLIPPING):
+        return False
+    if (features & ENABLE_HSL_BLEND_MODES) and not (features & ENABLE_ADVANCED_BLEND):
+        return False
+    return True
+
+# Mirrors pls::ShaderFeaturesMaskFor(InterlockMode).
+def interlock_features_mask(interlock_mode):
+    if interlock_mode == 'rasterOrdering':
+        return 0x3f
+    assert(interlock_mode == 'atomics')
+    return 0x3f & ~ENABLE_NESTED_CLIPPING
+
+# Mirrors pls::ShaderFeaturesMaskFor(DrawType, InterlockMode).
+def draw_features_mask(draw_type, interlock_mode):
+    mask = 0x3f
+    if draw_type == 'imageMesh' and interlock_mode != 'atomics':
+        mask = ENABLE_CLIPPING | ENABLE_CLIP_RECT | ENABLE_ADVANCED_BLEND | ENABLE_HSL_BLEND_MODES
+    return mask & interlock_features_mask(interlock_mode)
+
+DRAW_TYPES = {'rasterOrdering': ['midpointFanPatches', 'interiorTriangulation', 'imageMesh'],
+              'atomics': ['midpointFanPatches',
+                          'interiorTriangulation',
+                          'imageRect',
+                          'imageMesh',
+                          'plsAtomicResolve']}
+
+def read_exports(outdir):
+    exports = {}
+    for filename in os.listdir(outdir):
+        if not filename.endswith('.exports.h'):
+            continue
+        for line in open(os.path.join(outdir, filename)):
+            match = re.match(r'#define GLSL_(\w+) "(\w+)"', line)
+            if match:
+                exports[match.group(1)] = match.group(2)
+    return exports
+
+def read_scratch_color_plane_idx():
+    constants = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'constants.glsl')
+    for line in open(constants):
+        match = re.match(r'#define SCRATCH_COLOR_PLANE_IDX (\d+)', line)
+        if match:
+            return match.group(1)
+    sys.exit('SCRATCH_COLOR_PLANE_IDX not found in constants.glsl')
+
+# Emits the same source as d3dutil::BuildDrawShaderSource(), but against the minified.glsl files.
+def emit_hlsl(out, stage, draw_type, features, interlock_mode, coalesced, capabilities):
+    out.write('#define %s\n' % ('VERTEX' if stage == 'vertex' else 'FRAGMENT'))
+    for bit, name in FEATURE_NAMES.items():
+        if features & bit:
+            out.write('#define %s 1\n' % name)
+    if ((capabilities & CAPABILITY_ROV) and
+        ((interlock_mode == 'rasterOrdering' and draw_type != 'interiorTriangulation') or
+         draw_type == 'imageMesh')):
+        out.write('#define ENABLE_RASTERIZER_ORDERED_VIEWS\n')
+    if capabilities & CAPABILITY_TYPED_UAV:
+        out.write('#define ENABLE_TYPED_UAV_LOAD_STORE\n')
+    if interlock_mode == 'atomics' and not (features & ENABLE_ADVANCED_BLEND):
+        out.write('#define FIXED_FUNCTION_COLOR_BLEND\n')
+    if coalesced:
+        out.write('#define COALESCED_PLS_RESOLVE_AND_TRANSFER\n')
+        out.write('#define COLOR_PLANE_IDX_OVERRIDE %s\n' % scratch_color_plane_idx)
+    if draw_type == 'midpointFanPatches':
+        out.write('#define DRAW_PATH\n')
+    elif draw_type == 'interiorTriangulation':
+        out.write('#define DRAW_INTERIOR_TRIANGLES\n')
+    elif draw_type == 'imageRect':
+        out.write('#define DRAW_IMAGE\n#define DRAW_IMAGE_RECT\n')
+    elif draw_type == 'imageMesh':
+        out.write('#define DRAW_IMAGE\n#define DRAW_IMAGE_MESH\n')
+    elif draw_type == 'plsAtomicResolve':
+        out.write('#define DRAW_RENDER_TARGET_UPDATE_BOUNDS\n#define RESOLVE_PLS\n')
+    out.write('#include "constants.minified.glsl"\n')
+    out.write('#include "hlsl.minified.glsl"\n')
+    out.write('#include "common.minified.glsl"\n')
+    if features & ENABLE_ADVANCED_BLEND:
+        out.write('#include "advanced_blend.minified.glsl"\n')
+    if draw_type in ('midpointFanPatches', 'interiorTriangulation'):
+        out.write('#include "draw_path_common.minified.glsl"\n')
+    if interlock_mode == 'atomics':
+        out.write('#include "atomic_draw.minified.glsl"\n')
+    elif draw_type == 'imageMesh':
+        out.write('#include "draw_image_mesh.minified.glsl"\n')
+    else:
+        out.write('#include "draw_path.minified.glsl"\n')
+
+# Yields every (stage, draw_type, features, interlock_mode, coalesced, capabilities) to precompile.
+def enumerate_variants():
+    for capabilities in CAPABILITY_CONFIGURATIONS:
+        for interlock_mode, draw_types in DRAW_TYPES.items():
+            if interlock_mode == 'rasterOrdering' and not (capabilities & CAPABILITY_ROV):
+                continue
+            for draw_type in draw_types:
+                mask = draw_features_mask(draw_type, interlock_mode)
+                for features in range(0x40):
+                    if (features & ~mask) or not is_valid_feature_set(features):
+                        continue
+                    if features == features & VERTEX_FEATURES:
+                        yield ('vertex', draw_type, features, interlock_mode, False, capabilities)
+                    yield ('pixel', draw_type, features, interlock_mode, False, capabilities)
+                    if draw_type == 'plsAtomicResolve' and (features & ENABLE_ADVANCED_BLEND):
+                        yield ('pixel', draw_type, features, interlock_mode, True, capabilities)
+
+exports = read_exports(args.outdir)
+scratch_color_plane_idx = read_scratch_color_plane_idx()
+d3d_outdir = os.path.join(args.outdir, 'd3d')
+os.makedirs(d3d_outdir, exist_ok=True)
+
+entries = {'vertex': [], 'pixel': []}
+for stage, draw_type, features, interlock_mode, coalesced, capabilities in enumerate_variants():
+    name = 'g_%s_%s_%s_%02x%s_c%i' % ('vs' if stage == 'vertex' else 'ps',
+                                       draw_type,
+                                       interlock_mode,
+                                       features,
+                                       '_coalesced' if coalesced else '',
+                                       capabilities)
+    hlsl_path = os.path.join(d3d_outdir, name + '.hlsl')
+    with open(hlsl_path, 'w', newline='\n') as out:
+        emit_hlsl(out, stage, draw_type, features, interlock_mode, coalesced, capabilities)
+    header_path = os.path.join(d3d_outdir, name + '.h')
+    subprocess.check_call([args.fxc,
+                           '/nologo',
+                           '/Ges', # D3DCOMPILE_ENABLE_STRICTNESS
+                           '/T', 'vs_5_0' if stage == 'vertex' else 'ps_5_0',
+                           '/E', exports['drawVertexMain' if stage == 'vertex'
+                                         else 'drawFragmentMain'],
+                           '/I', args.outdir,
+                           '/Vn', name,
+                           '/Fh', header_path,
+                           hlsl_path],
+                          stdout=subprocess.DEVNULL)
+    entries[stage].append((name, draw_type, features, interlock_mode, coalesced, capabilities))
+
+with open(os.path.join(d3d_outdir, 'precompiled_draw_shaders.h'), 'w', newline='\n') as out:
+    out.write('#pragma once\n\n')
+    out.write('// Generated by generate_precompiled_shaders.py.\n\n')
+    for stage in ('vertex', 'pixel'):
+        for entry in entries[stage]:
+            out.write('#include "%s.h"\n' % entry[0])
+    for stage, table in (('vertex', 'kPrecompiledDrawVertexShaders'),
+                         ('pixel', 'kPrecompiledDrawPixelShaders')):
+        out.write('\nconstexpr static PrecompiledDrawShader %s[] = {\n' % table)
+        for name, draw_type, features, interlock_mode, coalesced, capabilities in entries[stage]:
+            out.write('    {DrawType::%s, static_cast<ShaderFeatures>(0x%02x), '
+                      'InterlockMode::%s, ShaderMiscFlags::%s, %i, %s, sizeof(%s)},\n' %
+                      (draw_type,
+                       features,
+                       interlock_mode,
+                       'coalescedResolveAndTransfer' if coalesced else 'none',
+                       capabilities,
+                       name,
+                       name))
+        out.write('};\n')
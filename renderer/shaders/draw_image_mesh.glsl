@@ -41,7 +41,8 @@ IMAGE_MESH_VERTEX_MAIN(@drawVertexMain, PositionAttr, position, UVAttr, uv, _ver
 
     float2 vertexPosition =
         MUL(make_float2x2(imageDrawUniforms.viewMatrix), @a_position) + imageDrawUniforms.translate;
-    v_texCoord = @a_texCoord;
+    v_texCoord = @a_texCoord * imageDrawUniforms.texCoordTransform.xy +
+                 imageDrawUniforms.texCoordTransform.zw;
 #ifdef @ENABLE_CLIPPING
     if (@ENABLE_CLIPPING)
     {
@@ -119,7 +120,10 @@ PLS_MAIN_WITH_IMAGE_UNIFORMS(@drawFragmentMain)
 #ifdef @ENABLE_CLIP_RECT
     if (@ENABLE_CLIP_RECT)
     {
-        half clipRectCoverage = min_value(make_half4(v_clipRect));
+        half2 clipRectEdgeDistances = make_half2(min(v_clipRect.xy, v_clipRect.zw)) - .5;
+        half clipRectCoverage =
+            clip_rect_coverage(clipRectEdgeDistances,
+                               make_half2(imageDrawUniforms.clipRectCornerRadii));
         coverage = clamp(clipRectCoverage, make_half(0), coverage);
     }
 #endif
@@ -172,7 +176,11 @@ FRAG_DATA_MAIN(half4, @drawFragmentMain)
 #ifdef @ENABLE_ADVANCED_BLEND
     if (@ENABLE_ADVANCED_BLEND)
     {
+#ifdef @FRAMEBUFFER_FETCH_DST_COLOR
+        half4 dstColor = FRAG_DATA_DST_COLOR;
+#else
         half4 dstColor = TEXEL_FETCH(@dstColorTexture, int2(floor(_fragCoord.xy)));
+#endif
         color = advanced_blend(color, unmultiply(dstColor), imageDrawUniforms.blendMode);
     }
     else
@@ -27,6 +27,7 @@ NO_PERSPECTIVE VARYING(2, half2, v_edgeDistance);
 #endif
 #ifdef @ENABLE_CLIP_RECT
 NO_PERSPECTIVE VARYING(5, float4, v_clipRect);
+@OPTIONALLY_FLAT VARYING(7, half2, v_clipRectCornerRadii);
 #endif
 #endif // !USING_DEPTH_STENCIL
 #ifdef @ENABLE_ADVANCED_BLEND
@@ -45,7 +46,7 @@ VERTEX_MAIN(@drawVertexMain, Attrs, attrs, _vertexID, _instanceID)
 #endif
 
     VARYING_INIT(v_paint, float4);
-#ifndef USING_DEPTH_STENCIL
+#ifndef @USING_DEPTH_STENCIL
 #ifdef @DRAW_INTERIOR_TRIANGLES
     VARYING_INIT(v_windingWeight, half);
 #else
@@ -57,6 +58,7 @@ VERTEX_MAIN(@drawVertexMain, Attrs, attrs, _vertexID, _instanceID)
 #endif
 #ifdef @ENABLE_CLIP_RECT
     VARYING_INIT(v_clipRect, float4);
+    VARYING_INIT(v_clipRectCornerRadii, half2);
 #endif
 #endif // !USING_DEPTH_STENCIL
 #ifdef @ENABLE_ADVANCED_BLEND
@@ -72,8 +74,15 @@ VERTEX_MAIN(@drawVertexMain, Attrs, attrs, _vertexID, _instanceID)
 
 #ifdef @DRAW_INTERIOR_TRIANGLES
     vertexPosition = unpack_interior_triangle_vertex(@a_triangleVertex,
-                                                     pathID,
-                                                     v_windingWeight VERTEX_CONTEXT_UNPACK);
+                                                     pathID
+#ifndef @USING_DEPTH_STENCIL
+                                                     ,
+                                                     v_windingWeight
+#else
+                                                     ,
+                                                     pathZIndex
+#endif
+                                                         VERTEX_CONTEXT_UNPACK);
 #else
     shouldDiscardVertex = !unpack_tessellated_path_vertex(@a_patchVertexData,
                                                           @a_mirroredVertexData,
@@ -91,6 +100,8 @@ VERTEX_MAIN(@drawVertexMain, Attrs, attrs, _vertexID, _instanceID)
 #endif // !DRAW_INTERIOR_TRIANGLES
 
     uint2 paintData = STORAGE_BUFFER_LOAD2(@paintBuffer, pathID);
+    // Paths with identical paints and clipRects share PaintAuxData records.
+    uint paintAuxIdx = STORAGE_BUFFER_LOAD4(@pathBuffer, pathID * 2u + 1u).w >> 16;
 
 #ifndef @USING_DEPTH_STENCIL
     // Encode the integral pathID as a "half" that we know the hardware will see as a unique value
@@ -132,12 +143,14 @@ VERTEX_MAIN(@drawVertexMain, Attrs, attrs, _vertexID, _instanceID)
         // clipRectInverseMatrix transforms from pixel coordinates to a space where the clipRect is
         // the normalized rectangle: [-1, -1, 1, 1].
         float2x2 clipRectInverseMatrix =
-            make_float2x2(STORAGE_BUFFER_LOAD4(@paintAuxBuffer, pathID * 4u + 2u));
-        float4 clipRectInverseTranslate = STORAGE_BUFFER_LOAD4(@paintAuxBuffer, pathID * 4u + 3u);
+            make_float2x2(STORAGE_BUFFER_LOAD4(@paintAuxBuffer, paintAuxIdx * 4u + 2u));
+        float4 clipRectInverseTranslate =
+            STORAGE_BUFFER_LOAD4(@paintAuxBuffer, paintAuxIdx * 4u + 3u);
 #ifndef @USING_DEPTH_STENCIL
         v_clipRect = find_clip_rect_coverage_distances(clipRectInverseMatrix,
                                                        clipRectInverseTranslate.xy,
                                                        fragCoord);
+        v_clipRectCornerRadii = make_half2(clipRectInverseTranslate.zw);
 #else  // USING_DEPTH_STENCIL
         set_clip_rect_plane_distances(clipRectInverseMatrix,
                                       clipRectInverseTranslate.xy,
@@ -161,26 +174,18 @@ VERTEX_MAIN(@drawVertexMain, Attrs, attrs, _vertexID, _instanceID)
 #endif
     else
     {
-        float2x2 paintMatrix = make_float2x2(STORAGE_BUFFER_LOAD4(@paintAuxBuffer, pathID * 4u));
-        float4 paintTranslate = STORAGE_BUFFER_LOAD4(@paintAuxBuffer, pathID * 4u + 1u);
+        float2x2 paintMatrix =
+            make_float2x2(STORAGE_BUFFER_LOAD4(@paintAuxBuffer, paintAuxIdx * 4u));
+        float4 paintTranslate = STORAGE_BUFFER_LOAD4(@paintAuxBuffer, paintAuxIdx * 4u + 1u);
         float2 paintCoord = MUL(paintMatrix, fragCoord) + paintTranslate.xy;
         if (paintType == LINEAR_GRADIENT_PAINT_TYPE || paintType == RADIAL_GRADIENT_PAINT_TYPE)
         {
             // v_paint.a contains "-row" of the gradient ramp at texel center, in normalized space.
             v_paint.a = -uintBitsToFloat(paintData.y);
-            // abs(v_paint.b) contains either:
-            //   - 2 if the gradient ramp spans an entire row.
-            //   - x0 of the gradient ramp in normalized space, if it's a simple 2-texel ramp.
-            if (paintTranslate.z > .9) // paintTranslate.z is either ~1 or ~1/GRAD_TEXTURE_WIDTH.
-            {
-                // Complex ramps span an entire row. Set it to 2 to convey this.
-                v_paint.b = 2.;
-            }
-            else
-            {
-                // This is a simple ramp.
-                v_paint.b = paintTranslate.w;
-            }
+            // abs(v_paint.b) contains the width of the gradient ramp, minus one, in texels (always
+            // a whole number), plus x0 of the gradient ramp in normalized space (always between 0
+            // and 1).
+            v_paint.b = floor(paintTranslate.z * GRAD_TEXTURE_WIDTH + .5) + paintTranslate.w;
             if (paintType == LINEAR_GRADIENT_PAINT_TYPE)
             {
                 // The paint is a linear gradient.
@@ -235,6 +240,7 @@ VERTEX_MAIN(@drawVertexMain, Attrs, attrs, _vertexID, _instanceID)
 #endif
 #ifdef @ENABLE_CLIP_RECT
     VARYING_PACK(v_clipRect);
+    VARYING_PACK(v_clipRectCornerRadii);
 #endif
 #endif // !USING_DEPTH_STENCIL
 #ifdef @ENABLE_ADVANCED_BLEND
@@ -278,9 +284,8 @@ INLINE half4 find_paint_color(float4 paint
         float t = paint.b > .0 ? /*linear*/ paint.r : /*radial*/ length(paint.rg);
         t = clamp(t, .0, 1.);
         float span = abs(paint.b);
-        float x = span > 1. ? /*entire row*/ (1. - 1. / GRAD_TEXTURE_WIDTH) * t +
-                                  (.5 / GRAD_TEXTURE_WIDTH)
-                            : /*two texels*/ (1. / GRAD_TEXTURE_WIDTH) * t + span;
+        float rampWidthMinusOne = floor(span);
+        float x = rampWidthMinusOne * GRAD_TEXTURE_INVERSE_WIDTH * t + (span - rampWidthMinusOne);
         float row = -paint.a;
         // Our gradient texture is not mipmapped. Issue a texture-sample that explicitly does not
         // find derivatives for LOD computation (by specifying derivatives directly).
@@ -330,6 +335,7 @@ PLS_MAIN(@drawFragmentMain)
 #endif
 #ifdef @ENABLE_CLIP_RECT
     VARYING_UNPACK(v_clipRect, float4);
+    VARYING_UNPACK(v_clipRectCornerRadii, half2);
 #endif
 #ifdef @ENABLE_ADVANCED_BLEND
     VARYING_UNPACK(v_blendMode, half);
@@ -442,7 +448,9 @@ PLS_MAIN(@drawFragmentMain)
 #ifdef @ENABLE_CLIP_RECT
         if (@ENABLE_CLIP_RECT)
         {
-            half clipRectCoverage = min_value(make_half4(v_clipRect));
+            half2 clipRectEdgeDistances = make_half2(min(v_clipRect.xy, v_clipRect.zw)) - .5;
+            half clipRectCoverage =
+                clip_rect_coverage(clipRectEdgeDistances, v_clipRectCornerRadii);
             coverage = clamp(clipRectCoverage, make_half(.0), coverage);
         }
 #endif // ENABLE_CLIP_RECT
@@ -514,7 +522,11 @@ FRAG_DATA_MAIN(half4, @drawFragmentMain)
 #ifdef @ENABLE_ADVANCED_BLEND
     if (@ENABLE_ADVANCED_BLEND)
     {
+#ifdef @FRAMEBUFFER_FETCH_DST_COLOR
+        half4 dstColor = FRAG_DATA_DST_COLOR;
+#else
         half4 dstColor = TEXEL_FETCH(@dstColorTexture, int2(floor(_fragCoord.xy)));
+#endif
         color = advanced_blend(color, unmultiply(dstColor), make_ushort(v_blendMode));
     }
     else
@@ -71,7 +71,7 @@ INLINE bool unpack_tessellated_path_vertex(float4 patchVertexData,
 
     float strokeRadius = uintBitsToFloat(pathData.z);
 #ifdef @USING_DEPTH_STENCIL
-    o_pathZIndex = make_ushort(pathData.w);
+    o_pathZIndex = make_ushort(pathData.w & 0xffffu);
 #endif
 
     // Fix the tessellation vertex if we fetched the wrong one in order to guarantee we got the
@@ -91,7 +91,8 @@ INLINE bool unpack_tessellated_path_vertex(float4 patchVertexData,
         tessVertexIdx += localVertexID - vertexIDOnContour;
         uint4 replacementTessVertexData =
             TEXEL_FETCH(@tessVertexTexture, tess_texel_coord(tessVertexIdx));
-        if ((replacementTessVertexData.w & 0xffffu) != (contourIDWithFlags & 0xffffu))
+        if ((replacementTessVertexData.w & CONTOUR_ID_MASK) !=
+            (contourIDWithFlags & CONTOUR_ID_MASK))
         {
             // We crossed over into a new contour. Either wrap to the first vertex in the contour or
             // leave it clamped at the final vertex of the contour.
@@ -284,14 +285,26 @@ INLINE bool unpack_tessellated_path_vertex(float4 patchVertexData,
 
 #ifdef @DRAW_INTERIOR_TRIANGLES
 INLINE float2 unpack_interior_triangle_vertex(float3 triangleVertex,
-                                              OUT(ushort) o_pathID,
-                                              OUT(half) o_windingWeight VERTEX_CONTEXT_DECL)
+                                              OUT(ushort) o_pathID
+#ifndef @USING_DEPTH_STENCIL
+                                              ,
+                                              OUT(half) o_windingWeight
+#else
+                                              ,
+                                              OUT(ushort) o_pathZIndex
+#endif
+                                                  VERTEX_CONTEXT_DECL)
 {
     o_pathID = make_ushort(floatBitsToUint(triangleVertex.z) & 0xffffu);
     float2x2 M = make_float2x2(uintBitsToFloat(STORAGE_BUFFER_LOAD4(@pathBuffer, o_pathID * 2u)));
     uint4 pathData = STORAGE_BUFFER_LOAD4(@pathBuffer, o_pathID * 2u + 1u);
     float2 translate = uintBitsToFloat(pathData.xy);
+#ifndef @USING_DEPTH_STENCIL
     o_windingWeight = make_half(floatBitsToInt(triangleVertex.z) >> 16) * sign(determinant(M));
+#else
+    // depthStencil mode counts windings in the stencil buffer, from the triangle's orientation.
+    o_pathZIndex = make_ushort(pathData.w & 0xffffu);
+#endif
     return MUL(M, triangleVertex.xy) + translate;
 }
 #endif // @DRAW_INTERIOR_TRIANGLES
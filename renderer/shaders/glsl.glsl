@@ -51,14 +51,24 @@
 #extension GL_ANGLE_base_vertex_base_instance_shader_builtin : require
 #endif
 
+#ifdef @ENABLE_MULTI_DRAW
+#extension GL_ANGLE_multi_draw : require
+#endif
+
 #ifdef @ENABLE_BINDLESS_TEXTURES
+#ifndef @TARGET_VULKAN
 #extension GL_ARB_bindless_texture : require
 #endif
+#endif
 
 #ifdef @ENABLE_KHR_BLEND
 #extension GL_KHR_blend_equation_advanced : require
 #endif
 
+#ifdef @FRAMEBUFFER_FETCH_DST_COLOR
+#extension GL_EXT_shader_framebuffer_fetch : require
+#endif
+
 #ifdef @USING_DEPTH_STENCIL
 #ifdef @ENABLE_CLIP_RECT
 #ifdef GL_EXT_clip_cull_distance
@@ -168,6 +178,25 @@
 #define TEXTURE_SAMPLE_GRAD(NAME, SAMPLER_NAME, COORD, DDX, DDY) textureGrad(NAME, COORD, DDX, DDY)
 #endif
 
+#ifdef @ENABLE_BINDLESS_TEXTURES
+#ifdef @TARGET_VULKAN
+// Bindless texture handles are indices into the @bindlessTextures table.
+#define BINDLESS_TEXTURE_TABLE                                                                     \
+    layout(set = BINDLESS_TEXTURES_SET, binding = BINDLESS_TEXTURES_IDX) uniform mediump texture2D \
+        @bindlessTextures[];
+#define BINDLESS_TEXTURE_SAMPLE_GRAD(HANDLE, SAMPLER_NAME, COORD, DDX, DDY)                        \
+    textureGrad(sampler2D(@bindlessTextures[nonuniformEXT(HANDLE.x)], SAMPLER_NAME),               \
+                COORD,                                                                             \
+                DDX,                                                                               \
+                DDY)
+#else
+// Bindless texture handles are 64-bit ARB_bindless_texture handles.
+#define BINDLESS_TEXTURE_TABLE
+#define BINDLESS_TEXTURE_SAMPLE_GRAD(HANDLE, SAMPLER_NAME, COORD, DDX, DDY)                        \
+    TEXTURE_SAMPLE_GRAD(sampler2D(HANDLE), SAMPLER_NAME, COORD, DDX, DDY)
+#endif
+#endif
+
 #define TEXEL_FETCH(NAME, COORD) texelFetch(NAME, COORD, 0)
 
 #define VERTEX_STORAGE_BUFFER_BLOCK_BEGIN
@@ -389,8 +418,14 @@
 #    ifdef @ENABLE_SPIRV_CROSS_BASE_INSTANCE
        // This uniform is specifically named "SPIRV_Cross_BaseInstance" for compatibility with
        // SPIRV-Cross sytems that search for it by name.
-       uniform int $SPIRV_Cross_BaseInstance;
-#      define INSTANCE_INDEX (gl_InstanceID + $SPIRV_Cross_BaseInstance)
+#      ifdef @ENABLE_MULTI_DRAW
+         // Each sub-draw of a multi-draw reads its own base instance.
+         uniform int $SPIRV_Cross_BaseInstance[MAX_MULTI_DRAW_COUNT];
+#        define INSTANCE_INDEX (gl_InstanceID + $SPIRV_Cross_BaseInstance[gl_DrawID])
+#      else
+         uniform int $SPIRV_Cross_BaseInstance;
+#        define INSTANCE_INDEX (gl_InstanceID + $SPIRV_Cross_BaseInstance)
+#      endif
 #    else
 #        define INSTANCE_INDEX (gl_InstanceID + gl_BaseInstance)
 #    endif
@@ -422,9 +457,18 @@
     gl_Position = _pos;                                                                            \
     }
 
+#ifdef @FRAMEBUFFER_FETCH_DST_COLOR
+// depthStencil mode reads the destination color for advanced blending from the fragment output,
+// which EXT_shader_framebuffer_fetch initializes with the framebuffer's current value.
+#define FRAG_DATA_MAIN(DATA_TYPE, NAME)                                                            \
+    layout(location = 0) inout DATA_TYPE _fd;                                                      \
+    void main()
+#define FRAG_DATA_DST_COLOR _fd
+#else
 #define FRAG_DATA_MAIN(DATA_TYPE, NAME)                                                            \
     layout(location = 0) out DATA_TYPE _fd;                                                        \
     void main()
+#endif
 
 #define EMIT_FRAG_DATA(VALUE) _fd = VALUE
 
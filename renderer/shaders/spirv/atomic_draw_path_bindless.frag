@@ -0,0 +1,7 @@
+#version 460
+#extension GL_GOOGLE_include_directive : require
+#extension GL_EXT_nonuniform_qualifier : require
+#define FRAGMENT
+#define DRAW_PATH
+#define ENABLE_BINDLESS_TEXTURES
+#include "atomic_base.glsl"
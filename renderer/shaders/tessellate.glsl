@@ -13,10 +13,17 @@
 
 #ifdef @VERTEX
 ATTR_BLOCK_BEGIN(Attrs)
+#ifdef @COMPACT_TESS_VERTEX_SPANS
+// pls::CompactTessVertexSpan.
+ATTR(0, float4, @a_p0p3_); // End in '_' because D3D interprets the '3' as a semantic index.
+ATTR(1, uint4, @a_deltas_joinTan_ys); // [p1 - p0, p2 - p3, joinTangent, ys] (fp16, fp16, fp16, u16)
+ATTR(2, uint4, @a_args); // [x0x1, reflectionX0X1, segmentCounts, contourIDWithFlags]
+#else
 ATTR(0, float4, @a_p0p1_); // End in '_' because D3D interprets the '1' as a semantic index.
 ATTR(1, float4, @a_p2p3_);
 ATTR(2, float4, @a_joinTan_and_ys); // [joinTangent, y, reflectionY]
 ATTR(3, uint4, @a_args);            // [x0x1, reflectionX0X1, segmentCounts, contourIDWithFlags]
+#endif
 ATTR_BLOCK_END
 #endif
 
@@ -58,9 +65,14 @@ float cosine_between_vectors(float2 a, float2 b)
 VERTEX_MAIN(@tessellateVertexMain, Attrs, attrs, _vertexID, _instanceID)
 {
     // Each instance repeats twice. Once for normal patch(es) and once for reflection(s).
+#ifdef @COMPACT_TESS_VERTEX_SPANS
+    ATTR_UNPACK(_instanceID, attrs, @a_p0p3_, float4);
+    ATTR_UNPACK(_instanceID, attrs, @a_deltas_joinTan_ys, uint4);
+#else
     ATTR_UNPACK(_instanceID, attrs, @a_p0p1_, float4);
     ATTR_UNPACK(_instanceID, attrs, @a_p2p3_, float4);
     ATTR_UNPACK(_instanceID, attrs, @a_joinTan_and_ys, float4);
+#endif
     ATTR_UNPACK(_instanceID, attrs, @a_args, uint4);
 
     VARYING_INIT(v_p0p1, float4);
@@ -69,14 +81,25 @@ VERTEX_MAIN(@tessellateVertexMain, Attrs, attrs, _vertexID, _instanceID)
     VARYING_INIT(v_joinArgs, float3);
     VARYING_INIT(v_contourIDWithFlags, uint);
 
+    // Each instance has two spans, potentially for both a forward copy and and reflection.
+    // (If the second span isn't needed, the client will have placed it offscreen.)
+    bool isFirstSpan = _vertexID < 4;
+#ifdef @COMPACT_TESS_VERTEX_SPANS
+    float2 p0 = @a_p0p3_.xy;
+    float2 p3 = @a_p0p3_.zw;
+    float2 p1 = p0 + unpackHalf2x16(@a_deltas_joinTan_ys.x);
+    float2 p2 = p3 + unpackHalf2x16(@a_deltas_joinTan_ys.y);
+    float2 joinTangent = unpackHalf2x16(@a_deltas_joinTan_ys.z);
+    uint ys = @a_deltas_joinTan_ys.w;
+    float y = float(isFirstSpan ? ys & 0xffffu : ys >> 16);
+#else
     float2 p0 = @a_p0p1_.xy;
     float2 p1 = @a_p0p1_.zw;
     float2 p2 = @a_p2p3_.xy;
     float2 p3 = @a_p2p3_.zw;
-    // Each instance has two spans, potentially for both a forward copy and and reflection.
-    // (If the second span isn't needed, the client will have placed it offscreen.)
-    bool isFirstSpan = _vertexID < 4;
+    float2 joinTangent = @a_joinTan_and_ys.xy;
     float y = isFirstSpan ? @a_joinTan_and_ys.z : @a_joinTan_and_ys.w;
+#endif
     int x0x1 = int(isFirstSpan ? @a_args.x : @a_args.y);
 #ifdef GLSL
     int x1up = x0x1 << 16;
@@ -150,7 +173,7 @@ VERTEX_MAIN(@tessellateVertexMain, Attrs, attrs, _vertexID, _instanceID)
                     radsPerPolarSegment);
     if (joinSegmentCount > 1u)
     {
-        float2x2 joinTangents = float2x2(tangents[1], @a_joinTan_and_ys.xy);
+        float2x2 joinTangents = float2x2(tangents[1], joinTangent);
         float joinTheta = acos(cosine_between_vectors(joinTangents[0], joinTangents[1]));
         float joinSpan = float(joinSegmentCount);
         if ((contourIDWithFlags & (JOIN_TYPE_MASK | EMULATED_STROKE_CAP_CONTOUR_FLAG)) ==
@@ -165,7 +188,7 @@ VERTEX_MAIN(@tessellateVertexMain, Attrs, attrs, _vertexID, _instanceID)
         float radsPerJoinSegment = joinTheta / joinSpan;
         if (determinant(joinTangents) < .0)
             radsPerJoinSegment = -radsPerJoinSegment;
-        v_joinArgs.xy = @a_joinTan_and_ys.xy;
+        v_joinArgs.xy = joinTangent;
         v_joinArgs.z = radsPerJoinSegment;
     }
     v_contourIDWithFlags = contourIDWithFlags;
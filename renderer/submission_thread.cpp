@@ -0,0 +1,68 @@
+/*
+ * Copyright 2024 Rive
+ */
+
+#include "submission_thread.hpp"
+
+#include <cassert>
+
+namespace rive::pls
+{
+SubmissionThread::SubmissionThread() : m_thread(&SubmissionThread::threadMain, this) {}
+
+SubmissionThread::~SubmissionThread()
+{
+    wait();
+    {
+        std::lock_guard lock(m_mutex);
+        m_shouldQuit = true;
+    }
+    m_jobPostedCondition.notify_one();
+    m_thread.join();
+}
+
+void SubmissionThread::post(std::function<void()> job)
+{
+    {
+        std::lock_guard lock(m_mutex);
+        assert(!m_hasJob);
+        m_job = std::move(job);
+        m_hasJob = true;
+    }
+    m_jobPostedCondition.notify_one();
+}
+
+void SubmissionThread::wait()
+{
+    std::unique_lock lock(m_mutex);
+    while (m_hasJob)
+    {
+        m_jobFinishedCondition.wait(lock);
+    }
+}
+
+void SubmissionThread::threadMain()
+{
+    std::unique_lock lock(m_mutex);
+    for (;;)
+    {
+        while (!m_hasJob && !m_shouldQuit)
+        {
+            m_jobPostedCondition.wait(lock);
+        }
+        if (m_shouldQuit)
+        {
+            return;
+        }
+
+        std::function<void()> job = std::move(m_job);
+        lock.unlock();
+        job();
+        lock.lock();
+
+        m_job = nullptr;
+        m_hasJob = false;
+        m_jobFinishedCondition.notify_all();
+    }
+}
+} // namespace rive::pls
@@ -0,0 +1,39 @@
+/*
+ * Copyright 2024 Rive
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace rive::pls
+{
+// Runs one job at a time on a dedicated thread. PLSRenderContext uses it to encode and submit a
+// frame on the backend while the client records the next one (see setPipelinedSubmission()).
+class SubmissionThread
+{
+public:
+    SubmissionThread();
+    ~SubmissionThread();
+
+    // Hands 'job' to the thread. The previous job must have been waited on.
+    void post(std::function<void()> job);
+
+    // Blocks until the posted job (if any) has finished.
+    void wait();
+
+private:
+    void threadMain();
+
+    std::function<void()> m_job; // Guarded by m_mutex.
+    bool m_hasJob = false;
+    bool m_shouldQuit = false;
+    std::mutex m_mutex;
+    std::condition_variable m_jobPostedCondition;
+    std::condition_variable m_jobFinishedCondition;
+    std::thread m_thread;
+};
+} // namespace rive::pls
@@ -4,7 +4,9 @@
 
 #include "rive/pls/vulkan/pls_render_context_vulkan_impl.hpp"
 
+#include "rive/pls/pls_draw.hpp"
 #include "rive/pls/pls_image.hpp"
+#include "rive/pls/pls_trace.hpp"
 #include "shaders/constants.glsl"
 
 namespace spirv
@@ -13,6 +15,7 @@ namespace spirv
 #include "generated/shaders/spirv/color_ramp.frag.h"
 #include "generated/shaders/spirv/tessellate.vert.h"
 #include "generated/shaders/spirv/tessellate.frag.h"
+#include "generated/shaders/spirv/expand_tess_spans.comp.h"
 
 #include "generated/shaders/spirv/draw_path.vert.h"
 #include "generated/shaders/spirv/draw_path.frag.h"
@@ -23,8 +26,10 @@ namespace spirv
 
 #include "generated/shaders/spirv/atomic_draw_path.vert.h"
 #include "generated/shaders/spirv/atomic_draw_path.frag.h"
+#include "generated/shaders/spirv/atomic_draw_path_bindless.frag.h"
 #include "generated/shaders/spirv/atomic_draw_interior_triangles.vert.h"
 #include "generated/shaders/spirv/atomic_draw_interior_triangles.frag.h"
+#include "generated/shaders/spirv/atomic_draw_interior_triangles_bindless.frag.h"
 #include "generated/shaders/spirv/atomic_draw_image_rect.vert.h"
 #include "generated/shaders/spirv/atomic_draw_image_rect.frag.h"
 #include "generated/shaders/spirv/atomic_draw_image_mesh.vert.h"
@@ -37,6 +42,10 @@ namespace spirv
 #include "rive/decoders/bitmap_decoder.hpp"
 #endif
 
+#include <algorithm>
+#include <condition_variable>
+#include <thread>
+
 namespace rive::pls
 {
 static VkBufferUsageFlagBits render_buffer_usage_flags(RenderBufferType renderBufferType)
@@ -57,13 +66,39 @@ public:
     RenderBufferVulkanImpl(rcp<vkutil::Allocator> allocator,
                            RenderBufferType renderBufferType,
                            RenderBufferFlags renderBufferFlags,
-                           size_t sizeInBytes) :
+                           size_t sizeInBytes,
+                           int bufferRingSize,
+                           bool deviceLocal) :
         RenderBuffer(renderBufferType, renderBufferFlags, sizeInBytes),
-        m_bufferRing(std::move(allocator),
+        m_bufferRing(allocator,
                      render_buffer_usage_flags(renderBufferType),
                      vkutil::Mappability::writeOnly,
-                     sizeInBytes)
-    {}
+                     renderBufferFlags & RenderBufferFlags::mappedOnceAtInitialization
+                         ? 1
+                         : bufferRingSize,
+                     0,
+                     vkutil::MemoryCategory::renderBuffers)
+    {
+        if (deviceLocal)
+        {
+            assert(renderBufferFlags & RenderBufferFlags::mappedOnceAtInitialization);
+            m_bufferRing.makeDeviceLocal(allocator.get(), vkutil::MemoryCategory::renderBuffers);
+        }
+        // The ring starts out empty. Each buffer gets its memory from synchronizeSizeAt() the
+        // first time it's mapped, so rarely-updated buffers only ever allocate one or two.
+        m_bufferRing.setTargetSize(sizeInBytes);
+    }
+
+    // Does a device-local buffer still need its contents copied in from the staging buffer?
+    bool hasUpdates() const { return m_bufferRing.hasPendingUpload(); }
+
+    void synchronize(VkCommandBuffer commandBuffer) const
+    {
+        assert(hasUpdates());
+        m_bufferRing.recordUploadAt(commandBuffer, m_bufferRingIdx);
+        // Device-local buffers are only ever mapped once.
+        m_bufferRing.releaseStagingBuffers();
+    }
 
     VkBuffer frontVkBuffer() const
     {
@@ -80,7 +115,7 @@ public:
 protected:
     void* onMap() override
     {
-        m_bufferRingIdx = (m_bufferRingIdx + 1) % pls::kBufferRingSize;
+        m_bufferRingIdx = (m_bufferRingIdx + 1) % m_bufferRing.ringSize();
         m_bufferRing.synchronizeSizeAt(m_bufferRingIdx);
         return m_bufferRing.contentsAt(m_bufferRingIdx);
     }
@@ -88,7 +123,7 @@ protected:
     void onUnmap() override { m_bufferRing.flushMappedContentsAt(m_bufferRingIdx); }
 
 private:
-    vkutil::BufferRing m_bufferRing;
+    mutable vkutil::BufferRing m_bufferRing;
     int m_bufferRingIdx = -1;
 };
 
@@ -96,7 +131,16 @@ rcp<RenderBuffer> PLSRenderContextVulkanImpl::makeRenderBuffer(RenderBufferType
                                                                RenderBufferFlags flags,
                                                                size_t sizeInBytes)
 {
-    return make_rcp<RenderBufferVulkanImpl>(m_allocator, type, flags, sizeInBytes);
+    // Static buffers are worth keeping in device-local memory on discrete GPUs. Dynamic ones get
+    // rewritten too often to justify the extra copy.
+    bool deviceLocal =
+        m_capabilities.discreteGPU && (flags & RenderBufferFlags::mappedOnceAtInitialization);
+    return make_rcp<RenderBufferVulkanImpl>(m_allocator,
+                                            type,
+                                            flags,
+                                            sizeInBytes,
+                                            bufferRingSize(),
+                                            deviceLocal);
 }
 
 class PLSTextureVulkanImpl : public PLSTexture
@@ -107,23 +151,45 @@ public:
                          uint32_t height,
                          uint32_t mipLevelCount,
                          const uint8_t imageDataRGBA[]) :
+        PLSTextureVulkanImpl(std::move(allocator),
+                             width,
+                             height,
+                             mipLevelCount,
+                             VK_FORMAT_R8G8B8A8_UNORM,
+                             imageDataRGBA,
+                             height * width * 4)
+    {}
+
+    // Block-compressed textures can't be blitted, so 'data' contains every mip level, packed
+    // contiguously beginning with the base level.
+    PLSTextureVulkanImpl(rcp<vkutil::Allocator> allocator,
+                         uint32_t width,
+                         uint32_t height,
+                         uint32_t mipLevelCount,
+                         VkFormat format,
+                         const uint8_t data[],
+                         size_t dataSizeInBytes) :
         PLSTexture(width, height),
-        m_texture(allocator->makeTexture({
-            .format = VK_FORMAT_R8G8B8A8_UNORM,
-            .extent = {width, height, 1},
-            .mipLevels = mipLevelCount,
-            .usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
-        })),
+        m_texture(allocator->makeTexture(
+            {
+                .format = format,
+                .extent = {width, height, 1},
+                .mipLevels = mipLevelCount,
+                .usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+            },
+            vkutil::MemoryCategory::imageTextures)),
         m_textureView(allocator->makeTextureView(m_texture)),
         m_imageUploadBuffer(allocator->makeBuffer(
             {
-                .size = height * width * 4,
+                .size = dataSizeInBytes,
                 .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
             },
-            vkutil::Mappability::writeOnly))
+            vkutil::Mappability::writeOnly,
+            vkutil::MemoryCategory::imageTextures)),
+        m_isCompressed(format != VK_FORMAT_R8G8B8A8_UNORM)
     {
         memcpy(vkutil::ScopedBufferFlush(*m_imageUploadBuffer),
-               imageDataRGBA,
+               data,
                m_imageUploadBuffer->info().size);
     }
 
@@ -133,6 +199,12 @@ public:
     {
         assert(hasUpdates());
 
+        if (m_isCompressed)
+        {
+            synchronizeCompressed(commandBuffer);
+            return;
+        }
+
         // Upload the new image.
         VkBufferImageCopy bufferImageCopy = {
             .imageSubresource =
@@ -225,15 +297,66 @@ public:
 private:
     friend class PLSRenderContextVulkanImpl;
 
+    // Copies every mip level straight out of the upload buffer.
+    void synchronizeCompressed(VkCommandBuffer commandBuffer) const
+    {
+        uint32_t mipLevels = m_texture->info().mipLevels;
+        vkutil::insert_image_memory_barrier(commandBuffer,
+                                            *m_texture,
+                                            VK_IMAGE_LAYOUT_UNDEFINED,
+                                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                            0,
+                                            mipLevels);
+
+        std::vector<VkBufferImageCopy> bufferImageCopies(mipLevels);
+        VkDeviceSize bufferOffset = 0;
+        for (uint32_t level = 0; level < mipLevels; ++level)
+        {
+            uint32_t levelWidth = std::max(width() >> level, 1u);
+            uint32_t levelHeight = std::max(height() >> level, 1u);
+            bufferImageCopies[level] = {
+                .bufferOffset = bufferOffset,
+                .imageSubresource =
+                    {
+                        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                        .mipLevel = level,
+                        .layerCount = 1,
+                    },
+                .imageExtent = {levelWidth, levelHeight, 1},
+            };
+            bufferOffset += pls::CompressedTextureLevelSizeInBytes(levelWidth, levelHeight);
+        }
+        assert(bufferOffset == m_imageUploadBuffer->info().size);
+
+        vkCmdCopyBufferToImage(commandBuffer,
+                               *m_imageUploadBuffer,
+                               *m_texture,
+                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               mipLevels,
+                               bufferImageCopies.data());
+
+        vkutil::insert_image_memory_barrier(commandBuffer,
+                                            *m_texture,
+                                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                            0,
+                                            mipLevels);
+
+        m_imageUploadBuffer = nullptr;
+    }
+
     rcp<vkutil::Texture> m_texture;
     rcp<vkutil::TextureView> m_textureView;
 
     mutable rcp<vkutil::Buffer> m_imageUploadBuffer;
+    const bool m_isCompressed;
+
+    // Descriptor set that binds this image texture. Created the first time the texture gets drawn,
+    // and reused by every flush after that. (The texture view never changes.)
+    mutable rcp<PLSRenderContextVulkanImpl::ImageDescriptorSet> m_imageTextureDescriptorSet;
 
-    // Location for PLSRenderContextVulkanImpl to store a descriptor set for the
-    // current flush that binds this image texture.
-    mutable VkDescriptorSet m_imageTextureDescriptorSet = VK_NULL_HANDLE;
-    mutable uint64_t m_descriptorSetFrameIdx = std::numeric_limits<size_t>::max();
+    // This texture's index in the bindless texture table, which is also its bindless handle.
+    rcp<PLSRenderContextVulkanImpl::BindlessTextureSlot> m_bindlessTextureSlot;
 };
 
 rcp<PLSTexture> PLSRenderContextVulkanImpl::decodeImageTexture(Span<const uint8_t> encodedBytes)
@@ -250,21 +373,61 @@ rcp<PLSTexture> PLSRenderContextVulkanImpl::decodeImageTexture(Span<const uint8_
         uint32_t width = bitmap->width();
         uint32_t height = bitmap->height();
         uint32_t mipLevelCount = math::msb(height | width);
-        return make_rcp<PLSTextureVulkanImpl>(m_allocator,
-                                              width,
-                                              height,
-                                              mipLevelCount,
-                                              bitmap->bytes());
+        return makeImageTexture(width, height, mipLevelCount, bitmap->bytes());
     }
 #endif
     return nullptr;
 }
 
+rcp<PLSTexture> PLSRenderContextVulkanImpl::makeImageTexture(uint32_t width,
+                                                             uint32_t height,
+                                                             uint32_t mipLevelCount,
+                                                             const uint8_t imageDataRGBA[])
+{
+    auto texture =
+        make_rcp<PLSTextureVulkanImpl>(m_allocator, width, height, mipLevelCount, imageDataRGBA);
+    assignBindlessTextureSlot(texture.get());
+    return texture;
+}
+
+rcp<PLSTexture> PLSRenderContextVulkanImpl::makeCompressedImageTexture(
+    uint32_t width,
+    uint32_t height,
+    uint32_t mipLevelCount,
+    pls::CompressedTextureFormat format,
+    const uint8_t data[])
+{
+    assert(m_platformFeatures.supportsCompressedTextureFormat(format));
+    VkFormat vkFormat;
+    switch (format)
+    {
+        case pls::CompressedTextureFormat::etc2RGBA8:
+            vkFormat = VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK;
+            break;
+        case pls::CompressedTextureFormat::astc4x4:
+            vkFormat = VK_FORMAT_ASTC_4x4_UNORM_BLOCK;
+            break;
+        case pls::CompressedTextureFormat::bc7:
+            vkFormat = VK_FORMAT_BC7_UNORM_BLOCK;
+            break;
+    }
+    auto texture = make_rcp<PLSTextureVulkanImpl>(
+        m_allocator,
+        width,
+        height,
+        mipLevelCount,
+        vkFormat,
+        data,
+        pls::CompressedTextureSizeInBytes(width, height, mipLevelCount));
+    assignBindlessTextureSlot(texture.get());
+    return texture;
+}
+
 // Renders color ramps to the gradient texture.
 class PLSRenderContextVulkanImpl::ColorRampPipeline
 {
 public:
-    ColorRampPipeline(VkDevice device) : m_device(device)
+    ColorRampPipeline(VkDevice device, VkPipelineCache pipelineCache) : m_device(device)
     {
         VkDescriptorSetLayoutBinding descriptorSetLayoutBinding = {
             .binding = FLUSH_UNIFORM_BUFFER_IDX,
@@ -383,7 +546,8 @@ public:
         VkAttachmentDescription attachment = {
             .format = VK_FORMAT_R8G8B8A8_UNORM,
             .samples = VK_SAMPLE_COUNT_1_BIT,
-            .loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+            // Rows of the gradient atlas that aren't being updated keep their contents.
+            .loadOp = VK_ATTACHMENT_LOAD_OP_LOAD,
             .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
             .initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
             .finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
@@ -433,7 +597,7 @@ public:
         };
 
         VK_CHECK(vkCreateGraphicsPipelines(m_device,
-                                           VK_NULL_HANDLE,
+                                           pipelineCache,
                                            1,
                                            &graphicsPipelineCreateInfo,
                                            nullptr,
@@ -468,7 +632,7 @@ private:
 class PLSRenderContextVulkanImpl::TessellatePipeline
 {
 public:
-    TessellatePipeline(VkDevice device) : m_device(device)
+    TessellatePipeline(VkDevice device, VkPipelineCache pipelineCache) : m_device(device)
     {
         VkDescriptorSetLayoutBinding descriptorSetLayoutBindings[] = {
             {
@@ -672,7 +836,7 @@ public:
         };
 
         VK_CHECK(vkCreateGraphicsPipelines(m_device,
-                                           VK_NULL_HANDLE,
+                                           pipelineCache,
                                            1,
                                            &graphicsPipelineCreateInfo,
                                            nullptr,
@@ -703,6 +867,109 @@ private:
     VkDevice m_device;
 };
 
+// Expands pls::TessCurves into pls::TessVertexSpans (FlushDescriptor::gpuTessellationSpans).
+class PLSRenderContextVulkanImpl::ExpandTessSpansPipeline
+{
+public:
+    constexpr static uint32_t TESS_CURVE_BUFFER_IDX = 0;
+    constexpr static uint32_t TESS_SPAN_BUFFER_IDX = 1;
+    constexpr static uint32_t kWorkgroupSize = 64; // local_size_x in expand_tess_spans.comp.
+
+    ExpandTessSpansPipeline(VkDevice device, VkPipelineCache pipelineCache) : m_device(device)
+    {
+        VkDescriptorSetLayoutBinding descriptorSetLayoutBindings[] = {
+            {
+                .binding = TESS_CURVE_BUFFER_IDX,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .descriptorCount = 1,
+                .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            },
+            {
+                .binding = TESS_SPAN_BUFFER_IDX,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .descriptorCount = 1,
+                .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            },
+        };
+        VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .bindingCount = std::size(descriptorSetLayoutBindings),
+            .pBindings = descriptorSetLayoutBindings,
+        };
+
+        VK_CHECK(vkCreateDescriptorSetLayout(m_device,
+                                             &descriptorSetLayoutCreateInfo,
+                                             nullptr,
+                                             &m_descriptorSetLayout));
+
+        VkPushConstantRange pushConstantRange = {
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            .offset = 0,
+            .size = sizeof(uint32_t), // curveCount
+        };
+
+        VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .setLayoutCount = 1,
+            .pSetLayouts = &m_descriptorSetLayout,
+            .pushConstantRangeCount = 1,
+            .pPushConstantRanges = &pushConstantRange,
+        };
+
+        VK_CHECK(vkCreatePipelineLayout(m_device,
+                                        &pipelineLayoutCreateInfo,
+                                        nullptr,
+                                        &m_pipelineLayout));
+
+        VkShaderModuleCreateInfo shaderModuleCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+            .codeSize = sizeof(spirv::expand_tess_spans_comp),
+            .pCode = spirv::expand_tess_spans_comp,
+        };
+
+        VkShaderModule computeShader;
+        VK_CHECK(vkCreateShaderModule(m_device, &shaderModuleCreateInfo, nullptr, &computeShader));
+
+        VkComputePipelineCreateInfo computePipelineCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+            .stage =
+                {
+                    .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                    .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+                    .module = computeShader,
+                    .pName = "main",
+                },
+            .layout = m_pipelineLayout,
+        };
+
+        VK_CHECK(vkCreateComputePipelines(m_device,
+                                          pipelineCache,
+                                          1,
+                                          &computePipelineCreateInfo,
+                                          nullptr,
+                                          &m_computePipeline));
+
+        vkDestroyShaderModule(m_device, computeShader, nullptr);
+    }
+
+    ~ExpandTessSpansPipeline()
+    {
+        vkDestroyDescriptorSetLayout(m_device, m_descriptorSetLayout, nullptr);
+        vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
+        vkDestroyPipeline(m_device, m_computePipeline, nullptr);
+    }
+
+    const VkDescriptorSetLayout& descriptorSetLayout() const { return m_descriptorSetLayout; }
+    VkPipelineLayout pipelineLayout() const { return m_pipelineLayout; }
+    VkPipeline computePipeline() const { return m_computePipeline; }
+
+private:
+    VkDescriptorSetLayout m_descriptorSetLayout;
+    VkPipelineLayout m_pipelineLayout;
+    VkPipeline m_computePipeline;
+    VkDevice m_device;
+};
+
 class PLSRenderContextVulkanImpl::DrawPipelineLayout
 {
 public:
@@ -748,7 +1015,10 @@ public:
 
     DrawPipelineLayout(PLSRenderContextVulkanImpl* plsImplVulkan,
                        pls::InterlockMode interlockMode) :
-        m_device(plsImplVulkan->m_device), m_interlockMode(interlockMode)
+        m_device(plsImplVulkan->m_device),
+        m_interlockMode(interlockMode),
+        m_usesBindlessTextures(interlockMode == pls::InterlockMode::atomics &&
+                               plsImplVulkan->m_bindlessTextureTable != nullptr)
     {
         assert(interlockMode != pls::InterlockMode::rasterOrdering ||
                plsImplVulkan->m_capabilities.EXT_rasterization_order_attachment_access);
@@ -832,6 +1102,9 @@ public:
 
         VkDescriptorSetLayoutCreateInfo perDrawLayoutInfo = {
             .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .flags = plsImplVulkan->usesPushDescriptors()
+                         ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR
+                         : 0u,
             .bindingCount = std::size(perDrawLayoutBindings),
             .pBindings = perDrawLayoutBindings,
         };
@@ -913,10 +1186,25 @@ public:
                                              nullptr,
                                              m_descriptorSetLayouts + PLS_TEXTURE_BINDINGS_SET));
 
+        // Atomic mode samples image paints out of the bindless texture table, if there is one.
+        // (The table owns its own layout.)
+        VkDescriptorSetLayout pipelineSetLayouts[BINDINGS_SET_COUNT + 1];
+        std::copy(std::begin(m_descriptorSetLayouts),
+                  std::end(m_descriptorSetLayouts),
+                  pipelineSetLayouts);
+        uint32_t pipelineSetLayoutCount = BINDINGS_SET_COUNT;
+        if (m_usesBindlessTextures)
+        {
+            static_assert(BINDLESS_TEXTURES_SET == BINDINGS_SET_COUNT);
+            pipelineSetLayouts[BINDLESS_TEXTURES_SET] =
+                plsImplVulkan->m_bindlessTextureTable->layout();
+            ++pipelineSetLayoutCount;
+        }
+
         VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {
             .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-            .setLayoutCount = BINDINGS_SET_COUNT,
-            .pSetLayouts = m_descriptorSetLayouts,
+            .setLayoutCount = pipelineSetLayoutCount,
+            .pSetLayouts = pipelineSetLayouts,
         };
 
         VK_CHECK(vkCreatePipelineLayout(m_device,
@@ -948,28 +1236,32 @@ public:
                                         nullptr,
                                         &m_staticDescriptorPool));
 
-        VkDescriptorSetAllocateInfo nullImageDescriptorSetInfo = {
-            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-            .descriptorPool = m_staticDescriptorPool,
-            .descriptorSetCount = 1,
-            .pSetLayouts = m_descriptorSetLayouts + PER_DRAW_BINDINGS_SET,
-        };
+        // Push descriptor layouts can't allocate sets. The null image gets pushed instead.
+        if (!plsImplVulkan->usesPushDescriptors())
+        {
+            VkDescriptorSetAllocateInfo nullImageDescriptorSetInfo = {
+                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+                .descriptorPool = m_staticDescriptorPool,
+                .descriptorSetCount = 1,
+                .pSetLayouts = m_descriptorSetLayouts + PER_DRAW_BINDINGS_SET,
+            };
 
-        VK_CHECK(vkAllocateDescriptorSets(m_device,
-                                          &nullImageDescriptorSetInfo,
-                                          &m_nullImageDescriptorSet));
+            VK_CHECK(vkAllocateDescriptorSets(m_device,
+                                              &nullImageDescriptorSetInfo,
+                                              &m_nullImageDescriptorSet));
 
-        vkutil::update_image_descriptor_sets(
-            m_device,
-            m_nullImageDescriptorSet,
-            {
-                .dstBinding = IMAGE_TEXTURE_IDX,
-                .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
-            },
-            {{
-                .imageView = *plsImplVulkan->m_nullImageTexture->m_textureView,
-                .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-            }});
+            vkutil::update_image_descriptor_sets(
+                m_device,
+                m_nullImageDescriptorSet,
+                {
+                    .dstBinding = IMAGE_TEXTURE_IDX,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                },
+                {{
+                    .imageView = *plsImplVulkan->m_nullImageTexture->m_textureView,
+                    .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                }});
+        }
 
         VkDescriptorSetAllocateInfo samplerDescriptorSetInfo = {
             .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
@@ -1149,16 +1441,19 @@ public:
     VkPipelineLayout vkPipelineLayout() const { return m_pipelineLayout; }
     VkDescriptorSet nullImageDescriptorSet() const { return m_nullImageDescriptorSet; }
     VkDescriptorSet samplerDescriptorSet() const { return m_samplerDescriptorSet; }
+    // If true, the bindless texture table must be bound at BINDLESS_TEXTURES_SET.
+    bool usesBindlessTextures() const { return m_usesBindlessTextures; }
 
 private:
     const VkDevice m_device;
     const pls::InterlockMode m_interlockMode;
+    const bool m_usesBindlessTextures;
 
     VkDescriptorSetLayout m_descriptorSetLayouts[BINDINGS_SET_COUNT];
     VkPipelineLayout m_pipelineLayout;
     VkDescriptorPool m_staticDescriptorPool; // For descriptorSets that never
                                              // change between frames.
-    VkDescriptorSet m_nullImageDescriptorSet;
+    VkDescriptorSet m_nullImageDescriptorSet = VK_NULL_HANDLE; // Unless push descriptors.
     VkDescriptorSet m_samplerDescriptorSet;
     std::array<VkRenderPass, kRenderPassVariantCount> m_renderPasses = {};
 };
@@ -1171,7 +1466,8 @@ public:
     DrawShader(VkDevice device,
                pls::DrawType drawType,
                pls::InterlockMode interlockMode,
-               pls::ShaderFeatures shaderFeatures) :
+               pls::ShaderFeatures shaderFeatures,
+               bool bindlessTextures) :
         m_device(device)
     {
         VkShaderModuleCreateInfo vsInfo = {.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
@@ -1212,12 +1508,18 @@ public:
                 case DrawType::midpointFanPatches:
                 case DrawType::outerCurvePatches:
                     vkutil::set_shader_code(vsInfo, spirv::atomic_draw_path_vert);
-                    vkutil::set_shader_code(fsInfo, spirv::atomic_draw_path_frag);
+                    vkutil::set_shader_code(fsInfo,
+                                            bindlessTextures
+                                                ? spirv::atomic_draw_path_bindless_frag
+                                                : spirv::atomic_draw_path_frag);
                     break;
 
                 case DrawType::interiorTriangulation:
                     vkutil::set_shader_code(vsInfo, spirv::atomic_draw_interior_triangles_vert);
-                    vkutil::set_shader_code(fsInfo, spirv::atomic_draw_interior_triangles_frag);
+                    vkutil::set_shader_code(
+                        fsInfo,
+                        bindlessTextures ? spirv::atomic_draw_interior_triangles_bindless_frag
+                                         : spirv::atomic_draw_interior_triangles_frag);
                     break;
 
                 case DrawType::imageRect:
@@ -1285,10 +1587,19 @@ public:
                                                   shaderFeatures,
                                                   interlockMode,
                                                   pls::ShaderMiscFlags::none);
-        const DrawShader& drawShader =
-            plsImplVulkan->m_drawShaders
-                .try_emplace(shaderKey, m_device, drawType, interlockMode, shaderFeatures)
-                .first->second;
+        const DrawShader* drawShader;
+        {
+            std::lock_guard lock(plsImplVulkan->m_drawShadersMutex);
+            drawShader =
+                &plsImplVulkan->m_drawShaders
+                     .try_emplace(shaderKey,
+                                  m_device,
+                                  drawType,
+                                  interlockMode,
+                                  shaderFeatures,
+                                  plsImplVulkan->m_bindlessTextureTable != nullptr)
+                     .first->second;
+        }
 
         VkBool32 shaderPermutationFlags[SPECIALIZATION_COUNT] = {
             shaderFeatures & pls::ShaderFeatures::ENABLE_CLIPPING,
@@ -1327,14 +1638,14 @@ public:
             {
                 .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
                 .stage = VK_SHADER_STAGE_VERTEX_BIT,
-                .module = drawShader.vertexModule(),
+                .module = drawShader->vertexModule(),
                 .pName = "main",
                 .pSpecializationInfo = &specializationInfo,
             },
             {
                 .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
                 .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
-                .module = drawShader.fragmentModule(),
+                .module = drawShader->fragmentModule(),
                 .pName = "main",
                 .pSpecializationInfo = &specializationInfo,
             },
@@ -1539,7 +1850,7 @@ public:
         };
 
         VK_CHECK(vkCreateGraphicsPipelines(m_device,
-                                           VK_NULL_HANDLE,
+                                           plsImplVulkan->m_vkPipelineCache,
                                            1,
                                            &graphicsPipelineCreateInfo,
                                            nullptr,
@@ -1555,115 +1866,715 @@ private:
     VkPipeline m_vkPipeline;
 };
 
-PLSRenderContextVulkanImpl::PLSRenderContextVulkanImpl(rcp<vkutil::Allocator> allocator,
-                                                       VulkanCapabilities capabilities) :
-    m_allocator(std::move(allocator)),
-    m_device(m_allocator->device()),
-    m_capabilities(capabilities),
-    m_flushUniformBufferRing(m_allocator,
-                             VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                             vkutil::Mappability::writeOnly),
-    m_imageDrawUniformBufferRing(m_allocator,
-                                 VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                                 vkutil::Mappability::writeOnly),
-    m_pathBufferRing(m_allocator,
-                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-                     vkutil::Mappability::writeOnly),
-    m_paintBufferRing(m_allocator,
-                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-                      vkutil::Mappability::writeOnly),
-    m_paintAuxBufferRing(m_allocator,
-                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-                         vkutil::Mappability::writeOnly),
-    m_contourBufferRing(m_allocator,
-                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-                        vkutil::Mappability::writeOnly),
-    m_simpleColorRampsBufferRing(m_allocator,
-                                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                                 vkutil::Mappability::writeOnly),
-    m_gradSpanBufferRing(m_allocator,
-                         VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                         vkutil::Mappability::writeOnly),
-    m_tessSpanBufferRing(m_allocator,
-                         VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                         vkutil::Mappability::writeOnly),
-    m_triangleBufferRing(m_allocator,
-                         VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                         vkutil::Mappability::writeOnly),
-    m_colorRampPipeline(std::make_unique<ColorRampPipeline>(m_device)),
-    m_tessellatePipeline(std::make_unique<TessellatePipeline>(m_device))
-{
-    m_allocator->setPLSContextImpl(this);
-    m_platformFeatures.supportsPixelLocalStorage = m_capabilities.fragmentStoresAndAtomics;
-    m_platformFeatures.supportsRasterOrdering =
-        m_capabilities.EXT_rasterization_order_attachment_access;
-    m_platformFeatures.invertOffscreenY = false;
-    m_platformFeatures.uninvertOnScreenY = true;
-}
-
-void PLSRenderContextVulkanImpl::initGPUObjects()
+// Creates DrawPipelines on a background thread, so that a new combination of ShaderFeatures never
+// stalls the render thread.
+class PLSRenderContextVulkanImpl::BackgroundPipelineCompiler
 {
-    constexpr static uint8_t black[] = {0, 0, 0, 1};
-    m_nullImageTexture = make_rcp<PLSTextureVulkanImpl>(m_allocator, 1, 1, 1, black);
-
-    VkSamplerCreateInfo linearSamplerCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
-        .magFilter = VK_FILTER_LINEAR,
-        .minFilter = VK_FILTER_LINEAR,
-        .mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
-        .addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
-        .addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
-        .minLod = 0,
-        .maxLod = 0,
+public:
+    struct Job
+    {
+        uint32_t pipelineKey;
+        pls::DrawType drawType;
+        pls::InterlockMode interlockMode;
+        pls::ShaderFeatures shaderFeatures;
+        DrawPipelineOptions drawPipelineOptions;
+        VkPipelineLayout vkPipelineLayout;
+        VkRenderPass vkRenderPass;
+        std::unique_ptr<DrawPipeline> compiledPipeline;
     };
 
-    VK_CHECK(vkCreateSampler(m_device, &linearSamplerCreateInfo, nullptr, &m_linearSampler));
-
-    VkSamplerCreateInfo mipmapSamplerCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
-        .magFilter = VK_FILTER_LINEAR,
-        .minFilter = VK_FILTER_LINEAR,
-        .mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR,
-        .addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
-        .addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
-        .minLod = 0,
-        .maxLod = VK_LOD_CLAMP_NONE,
-    };
+    BackgroundPipelineCompiler(PLSRenderContextVulkanImpl* plsImplVulkan) :
+        m_plsImplVulkan(plsImplVulkan)
+    {}
 
-    VK_CHECK(vkCreateSampler(m_device, &mipmapSamplerCreateInfo, nullptr, &m_mipmapSampler));
+    ~BackgroundPipelineCompiler()
+    {
+        if (m_compilerThread.joinable())
+        {
+            {
+                std::lock_guard lock(m_mutex);
+                m_shouldQuit = true;
+            }
+            m_workAddedCondition.notify_all();
+            m_compilerThread.join();
+        }
+    }
 
-    m_tessSpanIndexBuffer = m_allocator->makeBuffer(
+    void pushJob(Job&& job)
+    {
         {
-            .size = sizeof(pls::kTessSpanIndices),
-            .usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-        },
-        vkutil::Mappability::writeOnly);
-    memcpy(vkutil::ScopedBufferFlush(*m_tessSpanIndexBuffer),
-           pls::kTessSpanIndices,
-           sizeof(pls::kTessSpanIndices));
+            std::lock_guard lock(m_mutex);
+            if (!m_compilerThread.joinable())
+            {
+                m_compilerThread = std::thread(&BackgroundPipelineCompiler::threadMain, this);
+            }
+            m_pendingJobs.push_back(std::move(job));
+        }
+        m_workAddedCondition.notify_all();
+    }
 
-    m_pathPatchVertexBuffer = m_allocator->makeBuffer(
+    bool popFinishedJob(Job* job)
+    {
+        std::lock_guard lock(m_mutex);
+        if (m_finishedJobs.empty())
         {
-            .size = kPatchVertexBufferCount * sizeof(pls::PatchVertex),
-            .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-        },
-        vkutil::Mappability::writeOnly);
-    m_pathPatchIndexBuffer = m_allocator->makeBuffer(
+            return false;
+        }
+        *job = std::move(m_finishedJobs.back());
+        m_finishedJobs.pop_back();
+        return true;
+    }
+
+    // Blocks until a job finishes, if none are waiting already, and pops it.
+    void waitForFinishedJob(Job* job)
+    {
+        std::unique_lock lock(m_mutex);
+        while (m_finishedJobs.empty())
         {
-            .size = kPatchIndexBufferCount * sizeof(uint16_t),
-            .usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-        },
-        vkutil::Mappability::writeOnly);
-    pls::GeneratePatchBufferData(
-        vkutil::ScopedBufferFlush(*m_pathPatchVertexBuffer).as<PatchVertex*>(),
-        vkutil::ScopedBufferFlush(*m_pathPatchIndexBuffer).as<uint16_t*>());
+            m_workFinishedCondition.wait(lock);
+        }
+        *job = std::move(m_finishedJobs.back());
+        m_finishedJobs.pop_back();
+    }
 
-    m_imageRectVertexBuffer = m_allocator->makeBuffer(
+private:
+    void threadMain()
+    {
+        std::unique_lock lock(m_mutex);
+        for (;;)
         {
-            .size = sizeof(pls::kImageRectVertices),
-            .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-        },
-        vkutil::Mappability::writeOnly);
+            while (m_pendingJobs.empty() && !m_shouldQuit)
+            {
+                m_workAddedCondition.wait(lock);
+            }
+            if (m_shouldQuit)
+            {
+                return;
+            }
+
+            Job job = std::move(m_pendingJobs.front());
+            m_pendingJobs.pop_front();
+
+            lock.unlock();
+            job.compiledPipeline = std::make_unique<DrawPipeline>(m_plsImplVulkan,
+                                                                  job.drawType,
+                                                                  job.interlockMode,
+                                                                  job.shaderFeatures,
+                                                                  job.drawPipelineOptions,
+                                                                  job.vkPipelineLayout,
+                                                                  job.vkRenderPass);
+            lock.lock();
+
+            m_finishedJobs.push_back(std::move(job));
+            m_workFinishedCondition.notify_all();
+        }
+    }
+
+    PLSRenderContextVulkanImpl* const m_plsImplVulkan;
+    std::deque<Job> m_pendingJobs;
+    std::vector<Job> m_finishedJobs;
+    std::mutex m_mutex;
+    std::condition_variable m_workAddedCondition;
+    std::condition_variable m_workFinishedCondition;
+    bool m_shouldQuit = false;
+    std::thread m_compilerThread;
+};
+
+// Records chunks of a draw pass into secondary command buffers on a small pool of worker threads.
+// The calling thread records chunk 0 (and every workerCount()'th chunk after that) itself.
+//
+// Each worker owns one VkCommandPool per buffer ring slot, since command pools can only be used by
+// one thread at a time. A slot's secondary command buffers are recycled once the frame that last
+// used the slot has finished.
+class PLSRenderContextVulkanImpl::ParallelCommandRecorder
+{
+public:
+    ParallelCommandRecorder(VkDevice device,
+                            uint32_t queueFamilyIndex,
+                            int bufferRingSize,
+                            uint32_t threadCount) :
+        m_device(device), m_bufferRingSize(bufferRingSize), m_workers(threadCount + 1)
+    {
+        VkCommandPoolCreateInfo commandPoolCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = queueFamilyIndex,
+        };
+        for (Worker& worker : m_workers)
+        {
+            for (int i = 0; i < m_bufferRingSize; ++i)
+            {
+                VK_CHECK(vkCreateCommandPool(m_device,
+                                             &commandPoolCreateInfo,
+                                             nullptr,
+                                             &worker.commandPools[i]));
+            }
+        }
+        for (uint32_t i = 1; i <= threadCount; ++i)
+        {
+            m_threads.emplace_back(&ParallelCommandRecorder::threadMain, this, i);
+        }
+    }
+
+    ~ParallelCommandRecorder()
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_shouldQuit = true;
+        }
+        m_workAddedCondition.notify_all();
+        for (std::thread& thread : m_threads)
+        {
+            thread.join();
+        }
+        // (PLSRenderContextVulkanImpl already waited for every in-flight frame.)
+        for (Worker& worker : m_workers)
+        {
+            for (int i = 0; i < m_bufferRingSize; ++i)
+            {
+                vkDestroyCommandPool(m_device, worker.commandPools[i], nullptr);
+            }
+        }
+    }
+
+    size_t workerCount() const { return m_workers.size(); }
+
+    // Recycles every secondary command buffer recorded for the given ring slot. The frame that
+    // last used the slot must have finished.
+    void resetCommandBuffers(int bufferRingIdx)
+    {
+        for (Worker& worker : m_workers)
+        {
+            VK_CHECK(vkResetCommandPool(m_device, worker.commandPools[bufferRingIdx], 0));
+            worker.nextCommandBufferIdx[bufferRingIdx] = 0;
+        }
+    }
+
+    // Records 'chunkCount' secondary command buffers, in parallel, calling recordChunk() for
+    // each, and writes them to 'commandBuffers' in chunk order. Blocks until every chunk has been
+    // recorded.
+    void record(int bufferRingIdx,
+                const VkCommandBufferInheritanceInfo& inheritanceInfo,
+                size_t chunkCount,
+                const std::function<void(VkCommandBuffer, size_t chunkIdx)>& recordChunk,
+                std::vector<VkCommandBuffer>* commandBuffers)
+    {
+        commandBuffers->resize(chunkCount);
+        {
+            std::lock_guard lock(m_mutex);
+            m_job = {
+                .bufferRingIdx = bufferRingIdx,
+                .inheritanceInfo = &inheritanceInfo,
+                .chunkCount = chunkCount,
+                .recordChunk = &recordChunk,
+                .commandBuffers = commandBuffers->data(),
+            };
+            ++m_jobID;
+            m_busyThreadCount = m_threads.size();
+        }
+        m_workAddedCondition.notify_all();
+
+        recordChunks(0);
+
+        std::unique_lock lock(m_mutex);
+        while (m_busyThreadCount != 0)
+        {
+            m_workFinishedCondition.wait(lock);
+        }
+    }
+
+private:
+    struct Worker
+    {
+        VkCommandPool commandPools[pls::kMaxBufferRingSize];
+        std::vector<VkCommandBuffer> commandBuffers[pls::kMaxBufferRingSize];
+        size_t nextCommandBufferIdx[pls::kMaxBufferRingSize] = {};
+    };
+
+    struct Job
+    {
+        int bufferRingIdx;
+        const VkCommandBufferInheritanceInfo* inheritanceInfo;
+        size_t chunkCount;
+        const std::function<void(VkCommandBuffer, size_t)>* recordChunk;
+        VkCommandBuffer* commandBuffers;
+    };
+
+    VkCommandBuffer nextCommandBuffer(Worker& worker, int bufferRingIdx)
+    {
+        std::vector<VkCommandBuffer>& commandBuffers = worker.commandBuffers[bufferRingIdx];
+        size_t& nextIdx = worker.nextCommandBufferIdx[bufferRingIdx];
+        if (nextIdx == commandBuffers.size())
+        {
+            VkCommandBufferAllocateInfo commandBufferAllocateInfo = {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                .commandPool = worker.commandPools[bufferRingIdx],
+                .level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+                .commandBufferCount = 1,
+            };
+            VK_CHECK(vkAllocateCommandBuffers(m_device,
+                                              &commandBufferAllocateInfo,
+                                              &commandBuffers.emplace_back()));
+        }
+        return commandBuffers[nextIdx++];
+    }
+
+    // Records this worker's share of the current job's chunks. m_job doesn't change until every
+    // worker has finished, so it's safe to read without the lock.
+    void recordChunks(size_t workerIdx)
+    {
+        Worker& worker = m_workers[workerIdx];
+        for (size_t chunkIdx = workerIdx; chunkIdx < m_job.chunkCount;
+             chunkIdx += m_workers.size())
+        {
+            VkCommandBuffer commandBuffer = nextCommandBuffer(worker, m_job.bufferRingIdx);
+            VkCommandBufferBeginInfo beginInfo = {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+                .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT |
+                         VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+                .pInheritanceInfo = m_job.inheritanceInfo,
+            };
+            VK_CHECK(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+            (*m_job.recordChunk)(commandBuffer, chunkIdx);
+            VK_CHECK(vkEndCommandBuffer(commandBuffer));
+            m_job.commandBuffers[chunkIdx] = commandBuffer;
+        }
+    }
+
+    void threadMain(size_t workerIdx)
+    {
+        uint64_t lastJobID = 0;
+        std::unique_lock lock(m_mutex);
+        for (;;)
+        {
+            while (m_jobID == lastJobID && !m_shouldQuit)
+            {
+                m_workAddedCondition.wait(lock);
+            }
+            if (m_shouldQuit)
+            {
+                return;
+            }
+            lastJobID = m_jobID;
+
+            lock.unlock();
+            recordChunks(workerIdx);
+            lock.lock();
+
+            if (--m_busyThreadCount == 0)
+            {
+                m_workFinishedCondition.notify_one();
+            }
+        }
+    }
+
+    const VkDevice m_device;
+    const int m_bufferRingSize;
+    std::vector<Worker> m_workers; // m_workers[0] belongs to the calling thread.
+    std::vector<std::thread> m_threads;
+    Job m_job = {};
+    uint64_t m_jobID = 0;
+    size_t m_busyThreadCount = 0;
+    std::mutex m_mutex;
+    std::condition_variable m_workAddedCondition;
+    std::condition_variable m_workFinishedCondition;
+    bool m_shouldQuit = false;
+};
+
+static uint32_t draw_pipeline_key(pls::DrawType drawType,
+                                  pls::InterlockMode interlockMode,
+                                  pls::ShaderFeatures shaderFeatures,
+                                  DrawPipelineOptions drawPipelineOptions,
+                                  int renderPassVariantIdx,
+                                  int renderPassVariantCount)
+{
+    uint32_t pipelineKey =
+        pls::ShaderUniqueKey(drawType, shaderFeatures, interlockMode, pls::ShaderMiscFlags::none);
+    assert(pipelineKey << kDrawPipelineOptionCount >> kDrawPipelineOptionCount == pipelineKey);
+    pipelineKey =
+        (pipelineKey << kDrawPipelineOptionCount) | static_cast<uint32_t>(drawPipelineOptions);
+    assert(pipelineKey * renderPassVariantCount / renderPassVariantCount == pipelineKey);
+    return (pipelineKey * renderPassVariantCount) + renderPassVariantIdx;
+}
+
+const PLSRenderContextVulkanImpl::DrawPipeline* PLSRenderContextVulkanImpl::
+    findCompatibleDrawPipeline(pls::DrawType drawType,
+                               pls::InterlockMode interlockMode,
+                               pls::ShaderFeatures shaderFeatures,
+                               DrawPipelineOptions drawPipelineOptions,
+                               int renderPassVariantIdx,
+                               VkPipelineLayout vkPipelineLayout,
+                               VkRenderPass vkRenderPass)
+{
+    uint32_t pipelineKey = draw_pipeline_key(drawType,
+                                             interlockMode,
+                                             shaderFeatures,
+                                             drawPipelineOptions,
+                                             renderPassVariantIdx,
+                                             DrawPipelineLayout::kRenderPassVariantCount);
+
+    auto pipelineIter = m_drawPipelines.find(pipelineKey);
+    if (pipelineIter != m_drawPipelines.end() && pipelineIter->second != nullptr)
+    {
+        // The pipeline is fully created.
+        return pipelineIter->second.get();
+    }
+
+    // Find a fully-featured superset of features whose pipeline we can fall back on while waiting
+    // for this one to be created.
+    ShaderFeatures fullyFeaturedPipelineFeatures =
+        pls::ShaderFeaturesMaskFor(drawType, interlockMode);
+    if (interlockMode == pls::InterlockMode::atomics)
+    {
+        // Never add ENABLE_ADVANCED_BLEND to an atomic pipeline that doesn't use advanced blend,
+        // since in atomic mode, the shaders behave differently depending on whether advanced blend
+        // is enabled.
+        fullyFeaturedPipelineFeatures &= shaderFeatures | ~ShaderFeatures::ENABLE_ADVANCED_BLEND;
+        // Never add ENABLE_CLIPPING to an atomic pipeline that doesn't use clipping; the shader
+        // would access the clip attachment, which is not set up.
+        fullyFeaturedPipelineFeatures &= shaderFeatures | ~ShaderFeatures::ENABLE_CLIPPING;
+    }
+
+    // Fully-featured pipelines are the fallback, so they don't get a fallback of their own.
+    // (depthStencil mode changes fixed function state based on ShaderFeatures, so it can't use a
+    // stand-in either.)
+    bool needsExactPipeline =
+        (shaderFeatures & fullyFeaturedPipelineFeatures) == fullyFeaturedPipelineFeatures ||
+        interlockMode == pls::InterlockMode::depthStencil ||
+        m_contextOptions.synchronousShaderCompilations;
+    if (needsExactPipeline && pipelineIter == m_drawPipelines.end())
+    {
+        // Create it synchronously.
+        return m_drawPipelines
+            .emplace(pipelineKey,
+                     std::make_unique<DrawPipeline>(this,
+                                                    drawType,
+                                                    interlockMode,
+                                                    shaderFeatures,
+                                                    drawPipelineOptions,
+                                                    vkPipelineLayout,
+                                                    vkRenderPass))
+            .first->second.get();
+    }
+
+    if (pipelineIter == m_drawPipelines.end())
+    {
+        // The pipeline hasn't been scheduled yet. Create it in the background.
+        m_backgroundPipelineCompiler->pushJob({
+            .pipelineKey = pipelineKey,
+            .drawType = drawType,
+            .interlockMode = interlockMode,
+            .shaderFeatures = shaderFeatures,
+            .drawPipelineOptions = drawPipelineOptions,
+            .vkPipelineLayout = vkPipelineLayout,
+            .vkRenderPass = vkRenderPass,
+        });
+        pipelineIter = m_drawPipelines.emplace(pipelineKey, nullptr).first;
+    }
+
+    // Collect any pipelines that have finished in the background.
+    BackgroundPipelineCompiler::Job job;
+    while (m_backgroundPipelineCompiler->popFinishedJob(&job))
+    {
+        m_drawPipelines[job.pipelineKey] = std::move(job.compiledPipeline);
+    }
+    if (needsExactPipeline)
+    {
+        // The pipeline was already scheduled in the background (e.g., by precompileShaders()).
+        // Wait for it instead of falling back.
+        while (pipelineIter->second == nullptr)
+        {
+            m_backgroundPipelineCompiler->waitForFinishedJob(&job);
+            m_drawPipelines[job.pipelineKey] = std::move(job.compiledPipeline);
+        }
+    }
+    if (pipelineIter->second != nullptr)
+    {
+        return pipelineIter->second.get();
+    }
+
+    // Use the pipeline that has all features enabled while we wait.
+    return findCompatibleDrawPipeline(drawType,
+                                      interlockMode,
+                                      fullyFeaturedPipelineFeatures,
+                                      drawPipelineOptions,
+                                      renderPassVariantIdx,
+                                      vkPipelineLayout,
+                                      vkRenderPass);
+}
+
+void PLSRenderContextVulkanImpl::precompileShaders(Span<const pls::ShaderVariant> variants)
+{
+    for (const pls::ShaderVariant& variant : variants)
+    {
+        if (variant.interlockMode == pls::InterlockMode::depthStencil)
+        {
+            continue; // TODO: support MSAA.
+        }
+        switch (variant.drawType)
+        {
+            case DrawType::midpointFanPatches:
+            case DrawType::outerCurvePatches:
+            case DrawType::interiorTriangulation:
+            case DrawType::imageMesh:
+                break;
+            case DrawType::imageRect:
+            case DrawType::plsAtomicResolve:
+                if (variant.interlockMode != pls::InterlockMode::atomics)
+                {
+                    continue;
+                }
+                break;
+            case DrawType::plsAtomicInitialize:
+            case DrawType::stencilClipReset:
+                continue;
+        }
+
+        int interlockIdx = static_cast<int>(variant.interlockMode);
+        assert(interlockIdx < m_drawPipelineLayouts.size());
+        if (m_drawPipelineLayouts[interlockIdx] == nullptr)
+        {
+            m_drawPipelineLayouts[interlockIdx] =
+                std::make_unique<DrawPipelineLayout>(this, variant.interlockMode);
+        }
+        DrawPipelineLayout& layout = *m_drawPipelineLayouts[interlockIdx];
+
+        // We don't know which framebuffer format and load action the variant will be drawn with,
+        // so warm up all of them.
+        for (int renderPassVariantIdx = 0;
+             renderPassVariantIdx < DrawPipelineLayout::kRenderPassVariantCount;
+             ++renderPassVariantIdx)
+        {
+            if (m_contextOptions.synchronousShaderCompilations)
+            {
+                findCompatibleDrawPipeline(variant.drawType,
+                                           variant.interlockMode,
+                                           variant.shaderFeatures,
+                                           DrawPipelineOptions::none,
+                                           renderPassVariantIdx,
+                                           layout.vkPipelineLayout(),
+                                           layout.renderPassAt(renderPassVariantIdx));
+                continue;
+            }
+            uint32_t pipelineKey = draw_pipeline_key(variant.drawType,
+                                                     variant.interlockMode,
+                                                     variant.shaderFeatures,
+                                                     DrawPipelineOptions::none,
+                                                     renderPassVariantIdx,
+                                                     DrawPipelineLayout::kRenderPassVariantCount);
+            if (m_drawPipelines.try_emplace(pipelineKey, nullptr).second)
+            {
+                // findCompatibleDrawPipeline() collects the finished pipeline once it's needed.
+                m_backgroundPipelineCompiler->pushJob({
+                    .pipelineKey = pipelineKey,
+                    .drawType = variant.drawType,
+                    .interlockMode = variant.interlockMode,
+                    .shaderFeatures = variant.shaderFeatures,
+                    .drawPipelineOptions = DrawPipelineOptions::none,
+                    .vkPipelineLayout = layout.vkPipelineLayout(),
+                    .vkRenderPass = layout.renderPassAt(renderPassVariantIdx),
+                });
+            }
+        }
+    }
+}
+
+// The VkPipelineCache data header identifies the vendor, device, and driver that produced it, and
+// drivers ignore initial data that doesn't match, so one key suffices.
+constexpr static char kPipelineCacheBlobKey[] = "rive_vulkan_pipeline_cache";
+
+static VkPipelineCache make_pipeline_cache(VkDevice device, PipelineBlobCache* pipelineBlobCache)
+{
+    std::vector<uint8_t> initialData;
+    if (pipelineBlobCache != nullptr)
+    {
+        pipelineBlobCache->loadBlob(kPipelineCacheBlobKey, &initialData);
+    }
+    VkPipelineCacheCreateInfo pipelineCacheCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .initialDataSize = initialData.size(),
+        .pInitialData = initialData.data(),
+    };
+    VkPipelineCache pipelineCache;
+    VK_CHECK(vkCreatePipelineCache(device, &pipelineCacheCreateInfo, nullptr, &pipelineCache));
+    return pipelineCache;
+}
+
+PLSRenderContextVulkanImpl::PLSRenderContextVulkanImpl(rcp<vkutil::Allocator> allocator,
+                                                       VulkanCapabilities capabilities,
+                                                       const ContextOptions& contextOptions) :
+    PLSRenderContextImpl(contextOptions.bufferRingSize),
+    m_allocator(std::move(allocator)),
+    m_device(m_allocator->device()),
+    m_capabilities(capabilities),
+    m_contextOptions(contextOptions),
+    m_vkPipelineCache(make_pipeline_cache(m_device, m_contextOptions.pipelineBlobCache)),
+    m_flushUniformBufferRing(m_allocator,
+                             VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                             vkutil::Mappability::writeOnly,
+                             bufferRingSize()),
+    m_imageDrawUniformBufferRing(m_allocator,
+                                 VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                                 vkutil::Mappability::writeOnly,
+                                 bufferRingSize()),
+    m_pathBufferRing(m_allocator,
+                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                     vkutil::Mappability::writeOnly,
+                     bufferRingSize()),
+    m_paintBufferRing(m_allocator,
+                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                      vkutil::Mappability::writeOnly,
+                      bufferRingSize()),
+    m_paintAuxBufferRing(m_allocator,
+                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                         vkutil::Mappability::writeOnly,
+                         bufferRingSize()),
+    m_contourBufferRing(m_allocator,
+                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                        vkutil::Mappability::writeOnly,
+                        bufferRingSize()),
+    m_simpleColorRampsBufferRing(m_allocator,
+                                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                 vkutil::Mappability::writeOnly,
+                                 bufferRingSize()),
+    m_gradSpanBufferRing(m_allocator,
+                         VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                         vkutil::Mappability::writeOnly,
+                         bufferRingSize()),
+    m_tessSpanBufferRing(m_allocator,
+                         VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                         vkutil::Mappability::writeOnly,
+                         bufferRingSize()),
+    m_triangleBufferRing(m_allocator,
+                         VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                         vkutil::Mappability::writeOnly,
+                         bufferRingSize()),
+    m_bufferArena(m_allocator,
+                  VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                      VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                  vkutil::Mappability::writeOnly,
+                  bufferRingSize()),
+    m_colorRampPipeline(std::make_unique<ColorRampPipeline>(m_device, m_vkPipelineCache)),
+    m_tessellatePipeline(std::make_unique<TessellatePipeline>(m_device, m_vkPipelineCache)),
+    m_expandTessSpansPipeline(
+        std::make_unique<ExpandTessSpansPipeline>(m_device, m_vkPipelineCache)),
+    m_backgroundPipelineCompiler(std::make_unique<BackgroundPipelineCompiler>(this))
+{
+    m_allocator->setPLSContextImpl(this);
+    if (m_capabilities.discreteGPU && !m_contextOptions.singleArenaBuffers)
+    {
+        // The storage buffers get read by every vertex or fragment that touches a path, so keep
+        // them in device-local memory. (The arena, when used, stays host-visible.)
+        for (vkutil::BufferRing* ring :
+             {&m_pathBufferRing, &m_paintBufferRing, &m_paintAuxBufferRing, &m_contourBufferRing})
+        {
+            ring->makeDeviceLocal(m_allocator.get(), vkutil::MemoryCategory::bufferRings);
+        }
+    }
+    if (m_capabilities.KHR_push_descriptor)
+    {
+        m_vkCmdPushDescriptorSetKHR = reinterpret_cast<PFN_vkCmdPushDescriptorSetKHR>(
+            vkGetDeviceProcAddr(m_device, "vkCmdPushDescriptorSetKHR"));
+    }
+#ifdef RIVE_PLS_TRACING
+    // Null unless the instance enabled VK_EXT_debug_utils.
+    m_vkCmdBeginDebugUtilsLabelEXT = reinterpret_cast<PFN_vkCmdBeginDebugUtilsLabelEXT>(
+        vkGetDeviceProcAddr(m_device, "vkCmdBeginDebugUtilsLabelEXT"));
+    m_vkCmdEndDebugUtilsLabelEXT = reinterpret_cast<PFN_vkCmdEndDebugUtilsLabelEXT>(
+        vkGetDeviceProcAddr(m_device, "vkCmdEndDebugUtilsLabelEXT"));
+    if (m_vkCmdBeginDebugUtilsLabelEXT == nullptr || m_vkCmdEndDebugUtilsLabelEXT == nullptr)
+    {
+        m_vkCmdBeginDebugUtilsLabelEXT = nullptr;
+        m_vkCmdEndDebugUtilsLabelEXT = nullptr;
+    }
+#endif
+    m_platformFeatures.supportsPixelLocalStorage = m_capabilities.fragmentStoresAndAtomics;
+    m_platformFeatures.supportsRasterOrdering =
+        m_capabilities.EXT_rasterization_order_attachment_access;
+    m_platformFeatures.invertOffscreenY = false;
+    m_platformFeatures.uninvertOnScreenY = true;
+    m_platformFeatures.supportsTileBinnedRendering = true;
+    m_platformFeatures.supportsGPUTessellationSpans = true;
+    m_platformFeatures.supportsWideContourIDs = true;
+    // Frames can only be submitted off the client's thread if we own the command buffers.
+    m_platformFeatures.supportsPipelinedSubmission =
+        m_contextOptions.internalSubmitQueue != VK_NULL_HANDLE;
+    m_platformFeatures.maxTextureSize = m_capabilities.maxRenderableImageDimension;
+    m_platformFeatures.supportsETC2Textures = m_capabilities.textureCompressionETC2;
+    m_platformFeatures.supportsASTCTextures = m_capabilities.textureCompressionASTC_LDR;
+    m_platformFeatures.supportsBC7Textures = m_capabilities.textureCompressionBC;
+    // Handles are indices into m_bindlessTextureTable, which only atomic mode samples from.
+    m_platformFeatures.supportsBindlessTextures = m_capabilities.descriptorIndexing;
+}
+
+void PLSRenderContextVulkanImpl::initGPUObjects()
+{
+    constexpr static uint8_t black[] = {0, 0, 0, 1};
+    m_nullImageTexture = make_rcp<PLSTextureVulkanImpl>(m_allocator, 1, 1, 1, black);
+    if (m_capabilities.descriptorIndexing)
+    {
+        m_bindlessTextureTable =
+            std::make_unique<BindlessTextureTable>(m_device, *m_nullImageTexture->m_textureView);
+    }
+
+    VkSamplerCreateInfo linearSamplerCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+        .magFilter = VK_FILTER_LINEAR,
+        .minFilter = VK_FILTER_LINEAR,
+        .mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+        .addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .minLod = 0,
+        .maxLod = 0,
+    };
+
+    VK_CHECK(vkCreateSampler(m_device, &linearSamplerCreateInfo, nullptr, &m_linearSampler));
+
+    VkSamplerCreateInfo mipmapSamplerCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+        .magFilter = VK_FILTER_LINEAR,
+        .minFilter = VK_FILTER_LINEAR,
+        .mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR,
+        .addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .minLod = 0,
+        .maxLod = VK_LOD_CLAMP_NONE,
+    };
+
+    VK_CHECK(vkCreateSampler(m_device, &mipmapSamplerCreateInfo, nullptr, &m_mipmapSampler));
+
+    m_tessSpanIndexBuffer = m_allocator->makeBuffer(
+        {
+            .size = sizeof(pls::kTessSpanIndices),
+            .usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+        },
+        vkutil::Mappability::writeOnly);
+    memcpy(vkutil::ScopedBufferFlush(*m_tessSpanIndexBuffer),
+           pls::kTessSpanIndices,
+           sizeof(pls::kTessSpanIndices));
+
+    m_pathPatchVertexBuffer = m_allocator->makeBuffer(
+        {
+            .size = kPatchVertexBufferCount * sizeof(pls::PatchVertex),
+            .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        },
+        vkutil::Mappability::writeOnly);
+    m_pathPatchIndexBuffer = m_allocator->makeBuffer(
+        {
+            .size = kPatchIndexBufferCount * sizeof(uint16_t),
+            .usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+        },
+        vkutil::Mappability::writeOnly);
+    pls::GeneratePatchBufferData(
+        vkutil::ScopedBufferFlush(*m_pathPatchVertexBuffer).as<PatchVertex*>(),
+        vkutil::ScopedBufferFlush(*m_pathPatchIndexBuffer).as<uint16_t*>());
+
+    m_imageRectVertexBuffer = m_allocator->makeBuffer(
+        {
+            .size = sizeof(pls::kImageRectVertices),
+            .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        },
+        vkutil::Mappability::writeOnly);
     memcpy(vkutil::ScopedBufferFlush(*m_imageRectVertexBuffer),
            pls::kImageRectVertices,
            sizeof(pls::kImageRectVertices));
@@ -1676,10 +2587,49 @@ void PLSRenderContextVulkanImpl::initGPUObjects()
     memcpy(vkutil::ScopedBufferFlush(*m_imageRectIndexBuffer),
            pls::kImageRectIndices,
            sizeof(pls::kImageRectIndices));
+
+    if (m_contextOptions.internalSubmitQueue != VK_NULL_HANDLE)
+    {
+        // Our own command buffers are only safe to recycle if we can tell when they finish, which
+        // is what the timeline is for.
+        assert(m_capabilities.timelineSemaphore);
+        m_timeline = make_rcp<VulkanTimeline>(m_device);
+
+        VkCommandPoolCreateInfo commandPoolCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+            .queueFamilyIndex = m_contextOptions.queueFamilyIndex,
+        };
+        VK_CHECK(vkCreateCommandPool(m_device,
+                                     &commandPoolCreateInfo,
+                                     nullptr,
+                                     &m_internalCommandPool));
+
+        VkCommandBufferAllocateInfo commandBufferAllocateInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = m_internalCommandPool,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = static_cast<uint32_t>(bufferRingSize()),
+        };
+        VK_CHECK(vkAllocateCommandBuffers(m_device,
+                                          &commandBufferAllocateInfo,
+                                          m_internalCommandBuffers));
+
+        if (m_contextOptions.asyncComputeQueue != VK_NULL_HANDLE)
+        {
+            m_asyncComputeTimeline = make_rcp<VulkanTimeline>(m_device);
+            VK_CHECK(vkAllocateCommandBuffers(m_device,
+                                              &commandBufferAllocateInfo,
+                                              m_asyncComputeCommandBuffers));
+        }
+    }
 }
 
 PLSRenderContextVulkanImpl::~PLSRenderContextVulkanImpl()
 {
+    // Stop creating pipelines before we tear down the objects they reference.
+    m_backgroundPipelineCompiler.reset();
+
     // Wait for all fences before cleaning up.
     for (const rcp<pls::CommandBufferCompletionFence>& fence : m_frameCompletionFences)
     {
@@ -1695,6 +2645,42 @@ PLSRenderContextVulkanImpl::~PLSRenderContextVulkanImpl()
 
     vkDestroySampler(m_device, m_linearSampler, nullptr);
     vkDestroySampler(m_device, m_mipmapSampler, nullptr);
+    if (m_gpuTimerQueryPool != VK_NULL_HANDLE)
+    {
+        vkDestroyQueryPool(m_device, m_gpuTimerQueryPool, nullptr);
+    }
+    if (m_internalCommandPool != VK_NULL_HANDLE)
+    {
+        // Also frees m_internalCommandBuffers and m_asyncComputeCommandBuffers.
+        vkDestroyCommandPool(m_device, m_internalCommandPool, nullptr);
+    }
+
+    storePipelineCache();
+    vkDestroyPipelineCache(m_device, m_vkPipelineCache, nullptr);
+}
+
+void PLSRenderContextVulkanImpl::storePipelineCache()
+{
+    if (m_contextOptions.pipelineBlobCache == nullptr)
+    {
+        return;
+    }
+    size_t dataSize = 0;
+    VK_CHECK(vkGetPipelineCacheData(m_device, m_vkPipelineCache, &dataSize, nullptr));
+    if (dataSize == 0)
+    {
+        return;
+    }
+    std::vector<uint8_t> data(dataSize);
+    // VK_INCOMPLETE just means the cache grew since we queried its size. The truncated data is
+    // still valid.
+    VkResult result = vkGetPipelineCacheData(m_device, m_vkPipelineCache, &dataSize, data.data());
+    if (result == VK_SUCCESS || result == VK_INCOMPLETE)
+    {
+        m_contextOptions.pipelineBlobCache->storeBlob(kPipelineCacheBlobKey,
+                                                      data.data(),
+                                                      dataSize);
+    }
 }
 
 void PLSRenderContextVulkanImpl::resizeGradientTexture(uint32_t width, uint32_t height)
@@ -1704,14 +2690,17 @@ void PLSRenderContextVulkanImpl::resizeGradientTexture(uint32_t width, uint32_t
     if (m_gradientTexture == nullptr || m_gradientTexture->info().extent.width != width ||
         m_gradientTexture->info().extent.height != height)
     {
-        m_gradientTexture = m_allocator->makeTexture({
-            .format = VK_FORMAT_R8G8B8A8_UNORM,
-            .extent = {width, height, 1},
-            .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT |
-                     VK_IMAGE_USAGE_TRANSFER_DST_BIT,
-        });
+        m_gradientTexture = m_allocator->makeTexture(
+            {
+                .format = VK_FORMAT_R8G8B8A8_UNORM,
+                .extent = {width, height, 1},
+                .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT |
+                         VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+            },
+            vkutil::MemoryCategory::resourceTextures);
 
         m_gradTextureView = m_allocator->makeTextureView(m_gradientTexture);
+        m_gradTextureLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
         m_gradTextureFramebuffer = m_allocator->makeFramebuffer({
             .renderPass = m_colorRampPipeline->renderPass(),
@@ -1731,11 +2720,13 @@ void PLSRenderContextVulkanImpl::resizeTessellationTexture(uint32_t width, uint3
     if (m_tessVertexTexture == nullptr || m_tessVertexTexture->info().extent.width != width ||
         m_tessVertexTexture->info().extent.height != height)
     {
-        m_tessVertexTexture = m_allocator->makeTexture({
-            .format = VK_FORMAT_R32G32B32A32_UINT,
-            .extent = {width, height, 1},
-            .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-        });
+        m_tessVertexTexture = m_allocator->makeTexture(
+            {
+                .format = VK_FORMAT_R32G32B32A32_UINT,
+                .extent = {width, height, 1},
+                .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+            },
+            vkutil::MemoryCategory::resourceTextures);
 
         m_tessVertexTextureView = m_allocator->makeTextureView(m_tessVertexTexture);
 
@@ -1753,7 +2744,7 @@ void PLSRenderContextVulkanImpl::resizeTessellationTexture(uint32_t width, uint3
 void PLSRenderContextVulkanImpl::prepareToMapBuffers()
 {
     ++m_currentFrameIdx;
-    m_bufferRingIdx = (m_bufferRingIdx + 1) % pls::kBufferRingSize;
+    m_bufferRingIdx = (m_bufferRingIdx + 1) % bufferRingSize();
 
     // Wait for the existing resources to finish before we release/recycle them.
     if (rcp<pls::CommandBufferCompletionFence> fence =
@@ -1780,17 +2771,53 @@ void PLSRenderContextVulkanImpl::prepareToMapBuffers()
     m_gradSpanBufferRing.synchronizeSizeAt(m_bufferRingIdx);
     m_tessSpanBufferRing.synchronizeSizeAt(m_bufferRingIdx);
     m_triangleBufferRing.synchronizeSizeAt(m_bufferRingIdx);
+    if (m_contextOptions.singleArenaBuffers)
+    {
+        if (m_bufferArenaLayoutDirty)
+        {
+            layoutBufferArena();
+        }
+        m_bufferArena.synchronizeSizeAt(m_bufferRingIdx);
+    }
+}
+
+void PLSRenderContextVulkanImpl::layoutBufferArena()
+{
+    assert(m_contextOptions.singleArenaBuffers);
+    // 256 is the largest minUniformBufferOffsetAlignment and minStorageBufferOffsetAlignment that
+    // Vulkan allows.
+    constexpr static size_t kArenaAlignment = 256;
+    vkutil::BufferRing* rings[] = {
+        &m_flushUniformBufferRing,
+        &m_imageDrawUniformBufferRing,
+        &m_pathBufferRing,
+        &m_paintBufferRing,
+        &m_paintAuxBufferRing,
+        &m_contourBufferRing,
+        &m_simpleColorRampsBufferRing,
+        &m_gradSpanBufferRing,
+        &m_tessSpanBufferRing,
+        &m_triangleBufferRing,
+    };
+    size_t arenaSize = 0;
+    for (vkutil::BufferRing* ring : rings)
+    {
+        ring->setArena(&m_bufferArena, arenaSize);
+        arenaSize += math::round_up_to_multiple_of<kArenaAlignment>(ring->size());
+    }
+    m_bufferArena.setTargetSize(arenaSize);
+    m_bufferArenaLayoutDirty = false;
 }
 
 namespace descriptor_pool_limits
 {
 constexpr static uint32_t kMaxUniformUpdates = 3;
 constexpr static uint32_t kMaxDynamicUniformUpdates = 1;
-constexpr static uint32_t kMaxImageTextureUpdates = 256;
-constexpr static uint32_t kMaxSampledImageUpdates =
-    2 + kMaxImageTextureUpdates; // tess + grad + imageTextures
-constexpr static uint32_t kMaxStorageBufferUpdates = 6;
-constexpr static uint32_t kMaxDescriptorSets = 3 + kMaxImageTextureUpdates;
+// Image textures are bound through ImageDescriptorSets or push descriptors, not per-flush sets.
+constexpr static uint32_t kMaxSampledImageUpdates = 2; // tess + grad
+constexpr static uint32_t kMaxStorageBufferUpdates = 8;
+// colorRamp + expandTessSpans + tessellate + perFlush + pls
+constexpr static uint32_t kMaxDescriptorSets = 5;
 } // namespace descriptor_pool_limits
 
 PLSRenderContextVulkanImpl::DescriptorSetPool::DescriptorSetPool(PLSRenderContextVulkanImpl* impl) :
@@ -1827,24 +2854,112 @@ PLSRenderContextVulkanImpl::DescriptorSetPool::DescriptorSetPool(PLSRenderContex
     VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {
         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
         .flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT,
-        .maxSets = descriptor_pool_limits::kMaxDescriptorSets,
-        .poolSizeCount = std::size(descriptorPoolSizes),
-        .pPoolSizes = descriptorPoolSizes,
+        .maxSets = descriptor_pool_limits::kMaxDescriptorSets,
+        .poolSizeCount = std::size(descriptorPoolSizes),
+        .pPoolSizes = descriptorPoolSizes,
+    };
+
+    VK_CHECK(
+        vkCreateDescriptorPool(device(), &descriptorPoolCreateInfo, nullptr, &m_vkDescriptorPool));
+}
+
+PLSRenderContextVulkanImpl::DescriptorSetPool::~DescriptorSetPool()
+{
+    freeDescriptorSets();
+    vkDestroyDescriptorPool(device(), m_vkDescriptorPool, nullptr);
+}
+
+VkDescriptorSet PLSRenderContextVulkanImpl::DescriptorSetPool::allocateDescriptorSet(
+    VkDescriptorSetLayout layout)
+{
+    VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool = m_vkDescriptorPool,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &layout,
+    };
+
+    VK_CHECK(vkAllocateDescriptorSets(device(),
+                                      &descriptorSetAllocateInfo,
+                                      &m_descriptorSets.emplace_back()));
+
+    return m_descriptorSets.back();
+}
+
+void PLSRenderContextVulkanImpl::DescriptorSetPool::freeDescriptorSets()
+{
+    vkResetDescriptorPool(device(), m_vkDescriptorPool, 0);
+}
+
+void PLSRenderContextVulkanImpl::DescriptorSetPool::onRefCntReachedZero() const
+{
+    constexpr static uint32_t kMaxDescriptorSetPoolsInPool = 64;
+
+    if (plsImplVulkan() != nullptr &&
+        plsImplVulkan()->m_descriptorSetPoolPool.size() < kMaxDescriptorSetPoolsInPool)
+    {
+        // Hang out in the plsContext's m_descriptorSetPoolPool until in-flight
+        // command buffers have finished using our descriptors.
+        plsImplVulkan()->m_descriptorSetPoolPool.emplace_back(
+            const_cast<DescriptorSetPool*>(this),
+            plsImplVulkan()->m_currentFrameIdx + plsImplVulkan()->bufferRingSize());
+    }
+    else
+    {
+        delete this;
+    }
+}
+
+rcp<PLSRenderContextVulkanImpl::DescriptorSetPool> PLSRenderContextVulkanImpl::
+    makeDescriptorSetPool()
+{
+    rcp<DescriptorSetPool> pool;
+    if (!m_descriptorSetPoolPool.empty() &&
+        m_descriptorSetPoolPool.front().expirationFrameIdx <= m_currentFrameIdx)
+    {
+        pool = ref_rcp(m_descriptorSetPoolPool.front().resource.release());
+        pool->freeDescriptorSets();
+        m_descriptorSetPoolPool.pop_front();
+    }
+    else
+    {
+        pool = make_rcp<DescriptorSetPool>(this);
+    }
+    assert(pool->debugging_refcnt() == 1);
+    return pool;
+}
+
+PLSRenderContextVulkanImpl::PersistentDescriptorPool::PersistentDescriptorPool(
+    rcp<vkutil::Allocator> allocator) :
+    RenderingResource(std::move(allocator))
+{
+    VkDescriptorPoolSize descriptorPoolSize = {
+        .type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+        .descriptorCount = kMaxSets,
+    };
+
+    VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT,
+        .maxSets = kMaxSets,
+        .poolSizeCount = 1,
+        .pPoolSizes = &descriptorPoolSize,
     };
 
     VK_CHECK(
         vkCreateDescriptorPool(device(), &descriptorPoolCreateInfo, nullptr, &m_vkDescriptorPool));
 }
 
-PLSRenderContextVulkanImpl::DescriptorSetPool::~DescriptorSetPool()
+PLSRenderContextVulkanImpl::PersistentDescriptorPool::~PersistentDescriptorPool()
 {
-    freeDescriptorSets();
+    assert(m_liveSetCount == 0);
     vkDestroyDescriptorPool(device(), m_vkDescriptorPool, nullptr);
 }
 
-VkDescriptorSet PLSRenderContextVulkanImpl::DescriptorSetPool::allocateDescriptorSet(
+VkDescriptorSet PLSRenderContextVulkanImpl::PersistentDescriptorPool::allocateDescriptorSet(
     VkDescriptorSetLayout layout)
 {
+    assert(!full());
     VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {
         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
         .descriptorPool = m_vkDescriptorPool,
@@ -1852,144 +2967,803 @@ VkDescriptorSet PLSRenderContextVulkanImpl::DescriptorSetPool::allocateDescripto
         .pSetLayouts = &layout,
     };
 
-    VK_CHECK(vkAllocateDescriptorSets(device(),
-                                      &descriptorSetAllocateInfo,
-                                      &m_descriptorSets.emplace_back()));
+    VkDescriptorSet descriptorSet;
+    VK_CHECK(vkAllocateDescriptorSets(device(), &descriptorSetAllocateInfo, &descriptorSet));
+    ++m_liveSetCount;
+    return descriptorSet;
+}
 
-    return m_descriptorSets.back();
+void PLSRenderContextVulkanImpl::PersistentDescriptorPool::freeDescriptorSet(
+    VkDescriptorSet descriptorSet)
+{
+    assert(m_liveSetCount > 0);
+    VK_CHECK(vkFreeDescriptorSets(device(), m_vkDescriptorPool, 1, &descriptorSet));
+    --m_liveSetCount;
 }
 
-void PLSRenderContextVulkanImpl::DescriptorSetPool::freeDescriptorSets()
+PLSRenderContextVulkanImpl::ImageDescriptorSet::ImageDescriptorSet(
+    rcp<vkutil::Allocator> allocator,
+    rcp<PersistentDescriptorPool> pool,
+    VkDescriptorSetLayout layout,
+    VkImageView imageView) :
+    RenderingResource(std::move(allocator)),
+    m_pool(std::move(pool)),
+    m_vkDescriptorSet(m_pool->allocateDescriptorSet(layout))
 {
-    vkResetDescriptorPool(device(), m_vkDescriptorPool, 0);
+    vkutil::update_image_descriptor_sets(device(),
+                                         m_vkDescriptorSet,
+                                         {
+                                             .dstBinding = IMAGE_TEXTURE_IDX,
+                                             .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                                         },
+                                         {{
+                                             .imageView = imageView,
+                                             .imageLayout =
+                                                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                         }});
 }
 
-void PLSRenderContextVulkanImpl::DescriptorSetPool::onRefCntReachedZero() const
+PLSRenderContextVulkanImpl::ImageDescriptorSet::~ImageDescriptorSet()
 {
-    constexpr static uint32_t kMaxDescriptorSetPoolsInPool = 64;
+    m_pool->freeDescriptorSet(m_vkDescriptorSet);
+}
 
-    if (plsImplVulkan() != nullptr &&
-        plsImplVulkan()->m_descriptorSetPoolPool.size() < kMaxDescriptorSetPoolsInPool)
+rcp<PLSRenderContextVulkanImpl::ImageDescriptorSet> PLSRenderContextVulkanImpl::
+    makeImageDescriptorSet(VkDescriptorSetLayout layout, VkImageView imageView)
+{
+    if (m_persistentDescriptorPool == nullptr || m_persistentDescriptorPool->full())
     {
-        // Hang out in the plsContext's m_descriptorSetPoolPool until in-flight
-        // command buffers have finished using our descriptors.
-        plsImplVulkan()->m_descriptorSetPoolPool.emplace_back(const_cast<DescriptorSetPool*>(this),
-                                                              plsImplVulkan()->m_currentFrameIdx);
+        m_persistentDescriptorPool = make_rcp<PersistentDescriptorPool>(m_allocator);
     }
-    else
+    return make_rcp<ImageDescriptorSet>(m_allocator, m_persistentDescriptorPool, layout, imageView);
+}
+
+class PLSRenderContextVulkanImpl::BindlessTextureTable
+{
+public:
+    // Well under the 500,000 maxPerStageDescriptorUpdateAfterBindSampledImages that devices with
+    // descriptor indexing are required to support.
+    constexpr static uint32_t kMaxTextureCount = 1 << 16;
+
+    // Slot 0 always holds the null image, which is what a bindless handle of 0 samples.
+    BindlessTextureTable(VkDevice device, VkImageView nullImageView) :
+        m_device(device), m_nullImageView(nullImageView)
     {
-        delete this;
+        // The table gets updated while command buffers that bind it are still in flight. Those
+        // command buffers never sample the slots being updated, so UPDATE_UNUSED_WHILE_PENDING is
+        // enough to keep this legal.
+        VkDescriptorSetLayoutBinding binding = {
+            .binding = BINDLESS_TEXTURES_IDX,
+            .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+            .descriptorCount = kMaxTextureCount,
+            .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+        };
+        VkDescriptorBindingFlags bindingFlags =
+            VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+            VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+            VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+        VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+            .bindingCount = 1,
+            .pBindingFlags = &bindingFlags,
+        };
+        VkDescriptorSetLayoutCreateInfo layoutInfo = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .pNext = &bindingFlagsInfo,
+            .flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+            .bindingCount = 1,
+            .pBindings = &binding,
+        };
+        VK_CHECK(vkCreateDescriptorSetLayout(m_device, &layoutInfo, nullptr, &m_layout));
+
+        VkDescriptorPoolSize poolSize = {
+            .type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+            .descriptorCount = kMaxTextureCount,
+        };
+        VkDescriptorPoolCreateInfo poolInfo = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+            .maxSets = 1,
+            .poolSizeCount = 1,
+            .pPoolSizes = &poolSize,
+        };
+        VK_CHECK(vkCreateDescriptorPool(m_device, &poolInfo, nullptr, &m_pool));
+
+        VkDescriptorSetAllocateInfo descriptorSetInfo = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .descriptorPool = m_pool,
+            .descriptorSetCount = 1,
+            .pSetLayouts = &m_layout,
+        };
+        VK_CHECK(vkAllocateDescriptorSets(m_device, &descriptorSetInfo, &m_descriptorSet));
+
+        writeSlot(0, m_nullImageView);
+    }
+
+    ~BindlessTextureTable()
+    {
+        vkDestroyDescriptorPool(m_device, m_pool, nullptr);
+        vkDestroyDescriptorSetLayout(m_device, m_layout, nullptr);
+    }
+
+    VkDescriptorSetLayout layout() const { return m_layout; }
+    VkDescriptorSet descriptorSet() const { return m_descriptorSet; }
+
+    // Returns 0 if the table is full.
+    uint32_t allocateSlot(VkImageView imageView)
+    {
+        uint32_t index;
+        if (!m_freeSlots.empty())
+        {
+            index = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        }
+        else if (m_nextUnusedSlot < kMaxTextureCount)
+        {
+            index = m_nextUnusedSlot++;
+        }
+        else
+        {
+            return 0;
+        }
+        writeSlot(index, imageView);
+        return index;
+    }
+
+    void releaseSlot(uint32_t index)
+    {
+        assert(index != 0);
+        // Don't leave the slot pointing at an image view that's about to be destroyed.
+        writeSlot(index, m_nullImageView);
+        m_freeSlots.push_back(index);
+    }
+
+private:
+    void writeSlot(uint32_t index, VkImageView imageView)
+    {
+        vkutil::update_image_descriptor_sets(m_device,
+                                             m_descriptorSet,
+                                             {
+                                                 .dstBinding = BINDLESS_TEXTURES_IDX,
+                                                 .dstArrayElement = index,
+                                                 .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                                             },
+                                             {{
+                                                 .imageView = imageView,
+                                                 .imageLayout =
+                                                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                             }});
     }
+
+    const VkDevice m_device;
+    const VkImageView m_nullImageView;
+    VkDescriptorSetLayout m_layout;
+    VkDescriptorPool m_pool;
+    VkDescriptorSet m_descriptorSet;
+    std::vector<uint32_t> m_freeSlots;
+    uint32_t m_nextUnusedSlot = 1;
+};
+
+PLSRenderContextVulkanImpl::BindlessTextureSlot::BindlessTextureSlot(
+    rcp<vkutil::Allocator> allocator,
+    uint32_t index) :
+    RenderingResource(std::move(allocator)), m_index(index)
+{
+    assert(m_index != 0);
 }
 
-rcp<PLSRenderContextVulkanImpl::DescriptorSetPool> PLSRenderContextVulkanImpl::
-    makeDescriptorSetPool()
+PLSRenderContextVulkanImpl::BindlessTextureSlot::~BindlessTextureSlot()
 {
-    rcp<DescriptorSetPool> pool;
-    if (!m_descriptorSetPoolPool.empty() &&
-        m_descriptorSetPoolPool.front().expirationFrameIdx <= m_currentFrameIdx)
+    // Once the context is gone, so is the table.
+    if (plsImplVulkan() != nullptr)
     {
-        pool = ref_rcp(m_descriptorSetPoolPool.front().resource.release());
-        pool->freeDescriptorSets();
-        m_descriptorSetPoolPool.pop_front();
+        plsImplVulkan()->m_bindlessTextureTable->releaseSlot(m_index);
     }
-    else
+}
+
+void PLSRenderContextVulkanImpl::assignBindlessTextureSlot(PLSTextureVulkanImpl* texture)
+{
+    if (m_bindlessTextureTable == nullptr)
     {
-        pool = make_rcp<DescriptorSetPool>(this);
+        return;
+    }
+    uint32_t index = m_bindlessTextureTable->allocateSlot(*texture->m_textureView);
+    // If the table is full, the texture keeps a handle of 0 and its image paints sample the null
+    // image.
+    assert(index != 0);
+    if (index != 0)
+    {
+        texture->m_bindlessTextureSlot = make_rcp<BindlessTextureSlot>(m_allocator, index);
+        texture->m_bindlessTextureHandle = index;
     }
-    assert(pool->debugging_refcnt() == 1);
-    return pool;
 }
 
-void PLSRenderTargetVulkan::synchronize(vkutil::Allocator* allocator,
-                                        VkCommandBuffer commandBuffer,
-                                        pls::InterlockMode interlockMode)
+void PLSPlanesVulkan::synchronize(vkutil::Allocator* allocator,
+                                  VkCommandBuffer commandBuffer,
+                                  pls::InterlockMode interlockMode)
 {
-    if (interlockMode == pls::InterlockMode::rasterOrdering && m_coverageTexture == nullptr)
+    if (interlockMode == pls::InterlockMode::rasterOrdering && coverageTexture == nullptr)
     {
-        m_coverageTexture = allocator->makeTexture({
-            .format = VK_FORMAT_R32_UINT,
-            .extent = {width(), height(), 1},
-            .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT |
-                     VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT,
-        });
+        coverageTexture = allocator->makeTexture(
+            {
+                .format = VK_FORMAT_R32_UINT,
+                .extent = {width, height, 1},
+                .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                         VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT |
+                         VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT,
+            },
+            vkutil::MemoryCategory::plsPlanes);
 
         vkutil::insert_image_memory_barrier(commandBuffer,
-                                            *m_coverageTexture,
+                                            *coverageTexture,
                                             VK_IMAGE_LAYOUT_UNDEFINED,
                                             VK_IMAGE_LAYOUT_GENERAL);
 
-        m_coverageTextureView = allocator->makeTextureView(m_coverageTexture);
+        coverageTextureView = allocator->makeTextureView(coverageTexture);
     }
 
-    if (m_clipTexture == nullptr)
+    if (clipTexture == nullptr)
     {
-        m_clipTexture = allocator->makeTexture({
-            .format = VK_FORMAT_R32_UINT,
-            .extent = {width(), height(), 1},
-            .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT |
-                     VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT,
-        });
+        clipTexture = allocator->makeTexture(
+            {
+                .format = VK_FORMAT_R32_UINT,
+                .extent = {width, height, 1},
+                .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                         VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT |
+                         VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT,
+            },
+            vkutil::MemoryCategory::plsPlanes);
+
+        vkutil::insert_image_memory_barrier(commandBuffer,
+                                            *clipTexture,
+                                            VK_IMAGE_LAYOUT_UNDEFINED,
+                                            VK_IMAGE_LAYOUT_GENERAL);
+
+        clipTextureView = allocator->makeTextureView(clipTexture);
+    }
+
+    if (interlockMode == pls::InterlockMode::rasterOrdering && scratchColorTexture == nullptr)
+    {
+        scratchColorTexture = allocator->makeTexture(
+            {
+                .format = VK_FORMAT_R8G8B8A8_UNORM,
+                .extent = {width, height, 1},
+                .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                         VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT |
+                         VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT,
+            },
+            vkutil::MemoryCategory::plsPlanes);
+
+        vkutil::insert_image_memory_barrier(commandBuffer,
+                                            *scratchColorTexture,
+                                            VK_IMAGE_LAYOUT_UNDEFINED,
+                                            VK_IMAGE_LAYOUT_GENERAL);
+
+        scratchColorTextureView = allocator->makeTextureView(scratchColorTexture);
+    }
+
+    if (interlockMode == pls::InterlockMode::atomics && coverageAtomicTexture == nullptr)
+    {
+        coverageAtomicTexture = allocator->makeTexture(
+            {
+                .format = VK_FORMAT_R32_UINT,
+                .extent = {width, height, 1},
+                .usage = VK_IMAGE_USAGE_STORAGE_BIT |
+                         VK_IMAGE_USAGE_TRANSFER_DST_BIT, // For vkCmdClearColorImage
+            },
+            vkutil::MemoryCategory::plsPlanes);
 
         vkutil::insert_image_memory_barrier(commandBuffer,
-                                            *m_clipTexture,
+                                            *coverageAtomicTexture,
                                             VK_IMAGE_LAYOUT_UNDEFINED,
                                             VK_IMAGE_LAYOUT_GENERAL);
 
-        m_clipTextureView = allocator->makeTextureView(m_clipTexture);
+        coverageAtomicTextureView = allocator->makeTextureView(coverageAtomicTexture);
+    }
+}
+
+void PLSPlanesVulkan::reset(uint32_t newWidth, uint32_t newHeight)
+{
+    *this = PLSPlanesVulkan();
+    width = newWidth;
+    height = newHeight;
+}
+
+void PLSRenderTargetVulkan::synchronize(vkutil::Allocator* allocator,
+                                        VkCommandBuffer commandBuffer,
+                                        pls::InterlockMode interlockMode,
+                                        PLSPlanesVulkan* sharedPlanes)
+{
+    if (sharedPlanes != nullptr)
+    {
+        assert(sharedPlanes->width >= width() && sharedPlanes->height >= height());
+        // Don't hold onto our own planes while the shared ones are in use.
+        m_ownPlanes.reset(width(), height());
+        sharedPlanes->synchronize(allocator, commandBuffer, interlockMode);
+        m_planes = sharedPlanes;
+    }
+    else
+    {
+        m_ownPlanes.synchronize(allocator, commandBuffer, interlockMode);
+        m_planes = &m_ownPlanes;
+    }
+}
+
+PLSPlanesVulkan* PLSRenderContextVulkanImpl::sharedPLSPlanes(uint32_t width, uint32_t height)
+{
+    const uint32_t bucket = m_contextOptions.plsPlaneSizeBucket;
+    assert(bucket != 0);
+    uint32_t bucketedWidth = (width + bucket - 1) / bucket * bucket;
+    uint32_t bucketedHeight = (height + bucket - 1) / bucket * bucket;
+    m_sharedPLSPlanesMaxRequestWidth = std::max(m_sharedPLSPlanesMaxRequestWidth, bucketedWidth);
+    m_sharedPLSPlanesMaxRequestHeight =
+        std::max(m_sharedPLSPlanesMaxRequestHeight, bucketedHeight);
+    if (bucketedWidth > m_sharedPLSPlanes.width || bucketedHeight > m_sharedPLSPlanes.height)
+    {
+        // Grow. (Textures in use by earlier flushes stay alive until their command buffers have
+        // finished executing.)
+        m_sharedPLSPlanes.reset(std::max(m_sharedPLSPlanes.width, bucketedWidth),
+                                std::max(m_sharedPLSPlanes.height, bucketedHeight));
+    }
+    else if (++m_sharedPLSPlanesShrinkWindowFlushCount >= kPLSPlaneShrinkFlushCount)
+    {
+        // The size has settled. Shrink to the largest size that got used in this window.
+        if (m_sharedPLSPlanesMaxRequestWidth < m_sharedPLSPlanes.width ||
+            m_sharedPLSPlanesMaxRequestHeight < m_sharedPLSPlanes.height)
+        {
+            m_sharedPLSPlanes.reset(m_sharedPLSPlanesMaxRequestWidth,
+                                    m_sharedPLSPlanesMaxRequestHeight);
+        }
+        m_sharedPLSPlanesMaxRequestWidth = 0;
+        m_sharedPLSPlanesMaxRequestHeight = 0;
+        m_sharedPLSPlanesShrinkWindowFlushCount = 0;
+    }
+    return &m_sharedPLSPlanes;
+}
+
+void PLSRenderTargetVulkan::acquireExternalImage(VkCommandBuffer commandBuffer,
+                                                 uint32_t queueFamilyIndex)
+{
+    VkImageMemoryBarrier imageMemoryBarrier = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        // The release on the other side made the producer's writes available.
+        .srcAccessMask = VK_ACCESS_NONE,
+        .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
+                         VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_INPUT_ATTACHMENT_READ_BIT,
+        .oldLayout = m_externalAccess.acquireLayout,
+        .newLayout = VK_IMAGE_LAYOUT_GENERAL,
+        .srcQueueFamilyIndex = m_externalAccess.queueFamilyIndex,
+        .dstQueueFamilyIndex = queueFamilyIndex,
+        .image = m_targetTextureView->info().image,
+        .subresourceRange = m_targetTextureView->info().subresourceRange,
+    };
+
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         0,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr,
+                         1,
+                         &imageMemoryBarrier);
+}
+
+void PLSRenderTargetVulkan::releaseExternalImage(VkCommandBuffer commandBuffer,
+                                                 uint32_t queueFamilyIndex)
+{
+    VkImageMemoryBarrier imageMemoryBarrier = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+        // The consumer's own acquire makes our writes visible.
+        .dstAccessMask = VK_ACCESS_NONE,
+        .oldLayout = VK_IMAGE_LAYOUT_GENERAL,
+        .newLayout = m_externalAccess.releaseLayout,
+        .srcQueueFamilyIndex = queueFamilyIndex,
+        .dstQueueFamilyIndex = m_externalAccess.queueFamilyIndex,
+        .image = m_targetTextureView->info().image,
+        .subresourceRange = m_targetTextureView->info().subresourceRange,
+    };
+
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                         0,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr,
+                         1,
+                         &imageMemoryBarrier);
+}
+
+void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
+{
+    if (desc.externalCommandBuffer != nullptr)
+    {
+        recordFlush(desc, reinterpret_cast<VkCommandBuffer>(desc.externalCommandBuffer));
+        return;
+    }
+
+    // The client didn't provide a command buffer. Record into our own.
+    assert(m_internalCommandPool != VK_NULL_HANDLE); // Set ContextOptions::internalSubmitQueue.
+    VkCommandBuffer commandBuffer = m_internalCommandBuffers[m_bufferRingIdx];
+    if (desc.isFirstFlushOfFrame)
+    {
+        // prepareToMapBuffers() already waited for this slot's previous frame, so the command
+        // buffer is no longer in use.
+        VK_CHECK(vkResetCommandBuffer(commandBuffer, 0));
+        VkCommandBufferBeginInfo commandBufferBeginInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        };
+        VK_CHECK(vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo));
+        m_internalFrameFence = m_timeline->makeFence();
+    }
+
+    recordFlush(desc, commandBuffer);
+
+    // Binary semaphores handing external render targets back and forth. A frame may render into
+    // several of them (PLSRenderContext::nextTarget()), so gather them up for the submit.
+    auto* renderTarget = static_cast<PLSRenderTargetVulkan*>(desc.renderTarget);
+    if (renderTarget->m_hasExternalAccess)
+    {
+        PLSRenderTargetVulkan::ExternalAccess& access = renderTarget->m_externalAccess;
+        if (desc.isFirstFlushOfRenderTarget && access.acquireSemaphore != VK_NULL_HANDLE)
+        {
+            m_externalWaitSemaphores.push_back(access.acquireSemaphore);
+            access.acquireSemaphore = VK_NULL_HANDLE;
+        }
+        if (desc.isFinalFlushOfRenderTarget && access.releaseSemaphore != VK_NULL_HANDLE)
+        {
+            m_externalSignalSemaphores.push_back(access.releaseSemaphore);
+            access.releaseSemaphore = VK_NULL_HANDLE;
+        }
+    }
+
+    if (desc.isFinalFlushOfFrame)
+    {
+        VK_CHECK(vkEndCommandBuffer(commandBuffer));
+
+        // Submit the frame's compute work first, and make the graphics work wait for it before
+        // consuming any vertices.
+        std::vector<uint64_t> waitValues;
+        std::vector<VkSemaphore> waitSemaphores;
+        std::vector<VkPipelineStageFlags> waitStages;
+        if (m_asyncComputeFence != nullptr)
+        {
+            VkCommandBuffer computeCommandBuffer = m_asyncComputeCommandBuffers[m_bufferRingIdx];
+            VK_CHECK(vkEndCommandBuffer(computeCommandBuffer));
+
+            uint64_t computeSignalValue = m_asyncComputeFence->value();
+            VkSemaphore computeSemaphore = m_asyncComputeTimeline->vkSemaphore();
+            VkTimelineSemaphoreSubmitInfo computeTimelineSubmitInfo = {
+                .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+                .signalSemaphoreValueCount = 1,
+                .pSignalSemaphoreValues = &computeSignalValue,
+            };
+            VkSubmitInfo computeSubmitInfo = {
+                .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+                .pNext = &computeTimelineSubmitInfo,
+                .commandBufferCount = 1,
+                .pCommandBuffers = &computeCommandBuffer,
+                .signalSemaphoreCount = 1,
+                .pSignalSemaphores = &computeSemaphore,
+            };
+            VK_CHECK(vkQueueSubmit(m_contextOptions.asyncComputeQueue,
+                                   1,
+                                   &computeSubmitInfo,
+                                   VK_NULL_HANDLE));
+            // The graphics work waits on this value, so m_timeline also covers the compute
+            // command buffer's lifetime.
+            m_asyncComputeFence = nullptr;
+
+            waitValues.push_back(computeSignalValue);
+            waitSemaphores.push_back(computeSemaphore);
+            waitStages.push_back(VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+        }
+
+        // The external targets' binary semaphores ignore their entries in the timeline values.
+        for (VkSemaphore semaphore : m_externalWaitSemaphores)
+        {
+            waitValues.push_back(0);
+            waitSemaphores.push_back(semaphore);
+            waitStages.push_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                                 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+        }
+        std::vector<uint64_t> signalValues = {m_internalFrameFence->value()};
+        std::vector<VkSemaphore> signalSemaphores = {m_timeline->vkSemaphore()};
+        for (VkSemaphore semaphore : m_externalSignalSemaphores)
+        {
+            signalValues.push_back(0);
+            signalSemaphores.push_back(semaphore);
+        }
+        m_externalWaitSemaphores.clear();
+        m_externalSignalSemaphores.clear();
+
+        VkTimelineSemaphoreSubmitInfo timelineSubmitInfo = {
+            .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+            .waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size()),
+            .pWaitSemaphoreValues = waitValues.data(),
+            .signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size()),
+            .pSignalSemaphoreValues = signalValues.data(),
+        };
+        VkSubmitInfo submitInfo = {
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .pNext = &timelineSubmitInfo,
+            .waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size()),
+            .pWaitSemaphores = waitSemaphores.data(),
+            .pWaitDstStageMask = waitStages.data(),
+            .commandBufferCount = 1,
+            .pCommandBuffers = &commandBuffer,
+            .signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size()),
+            .pSignalSemaphores = signalSemaphores.data(),
+        };
+        VK_CHECK(vkQueueSubmit(m_contextOptions.internalSubmitQueue,
+                               1,
+                               &submitInfo,
+                               VK_NULL_HANDLE));
+
+        // The timeline tells us when this slot's command buffer and PLS buffers can be reused,
+        // whether or not the client also passed a frameCompletionFence.
+        m_frameCompletionFences[m_bufferRingIdx] = std::move(m_internalFrameFence);
+    }
+}
+
+VkCommandBuffer PLSRenderContextVulkanImpl::beginAsyncComputeWork()
+{
+    VkCommandBuffer computeCommandBuffer = m_asyncComputeCommandBuffers[m_bufferRingIdx];
+    if (m_asyncComputeFence == nullptr)
+    {
+        // This slot's previous graphics submission waited on its compute submission, and
+        // prepareToMapBuffers() already waited for that graphics submission.
+        VK_CHECK(vkResetCommandBuffer(computeCommandBuffer, 0));
+        VkCommandBufferBeginInfo commandBufferBeginInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        };
+        VK_CHECK(vkBeginCommandBuffer(computeCommandBuffer, &commandBufferBeginInfo));
+        m_asyncComputeFence = m_asyncComputeTimeline->makeFence();
+    }
+    return computeCommandBuffer;
+}
+
+void PLSRenderContextVulkanImpl::beginDebugLabel(VkCommandBuffer commandBuffer, const char* label)
+{
+#ifdef RIVE_PLS_TRACING
+    if (m_vkCmdBeginDebugUtilsLabelEXT != nullptr)
+    {
+        VkDebugUtilsLabelEXT labelInfo = {
+            .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
+            .pLabelName = label,
+        };
+        m_vkCmdBeginDebugUtilsLabelEXT(commandBuffer, &labelInfo);
+    }
+#endif
+}
+
+void PLSRenderContextVulkanImpl::endDebugLabel(VkCommandBuffer commandBuffer)
+{
+#ifdef RIVE_PLS_TRACING
+    if (m_vkCmdEndDebugUtilsLabelEXT != nullptr)
+    {
+        m_vkCmdEndDebugUtilsLabelEXT(commandBuffer);
+    }
+#endif
+}
+
+void PLSRenderContextVulkanImpl::recordFlush(const FlushDescriptor& desc,
+                                             VkCommandBuffer commandBuffer)
+{
+    PLS_TRACE_SCOPE("PLSRenderContextVulkanImpl::recordFlush");
+    if (m_contextOptions.singleArenaBuffers && desc.isFirstFlushOfFrame)
+    {
+        // Every PLS buffer has been unmapped. Flush all of them at once.
+        m_bufferArena.flushPendingContentsAt(m_bufferRingIdx);
+    }
+
+    if (desc.isFirstFlushOfFrame)
+    {
+        // Copy the frame's storage buffers into device-local memory, if they live there
+        // (VulkanCapabilities::discreteGPU). This covers every logical flush in the frame.
+        bool didUpload = false;
+        for (vkutil::BufferRing* ring :
+             {&m_pathBufferRing, &m_paintBufferRing, &m_paintAuxBufferRing, &m_contourBufferRing})
+        {
+            didUpload |= ring->recordUploadAt(commandBuffer, m_bufferRingIdx);
+        }
+        if (didUpload)
+        {
+            VkMemoryBarrier memoryBarrier = {
+                .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+            };
+            vkCmdPipelineBarrier(commandBuffer,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                                     VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                 0,
+                                 1,
+                                 &memoryBarrier,
+                                 0,
+                                 nullptr,
+                                 0,
+                                 nullptr);
+        }
+    }
+
+    if (desc.interlockMode == pls::InterlockMode::depthStencil)
+    {
+        return; // TODO: support MSAA.
+    }
+
+    rcp<DescriptorSetPool> descriptorSetPool = makeDescriptorSetPool();
+
+    bool timesGPUFrame = desc.gpuTimerFrameNumber != 0 && m_capabilities.timestampPeriod != 0;
+    if (timesGPUFrame && desc.isFirstFlushOfFrame)
+    {
+        if (m_gpuTimerQueryPool == VK_NULL_HANDLE)
+        {
+            VkQueryPoolCreateInfo queryPoolCreateInfo = {
+                .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+                .queryType = VK_QUERY_TYPE_TIMESTAMP,
+                .queryCount = static_cast<uint32_t>(bufferRingSize() * 2),
+            };
+            VK_CHECK(vkCreateQueryPool(m_device,
+                                       &queryPoolCreateInfo,
+                                       nullptr,
+                                       &m_gpuTimerQueryPool));
+        }
+        // The frame that last used this slot has finished (see prepareToMapBuffers()). If the
+        // client never collected its time, drop it.
+        m_pendingGPUTimers.erase(std::remove_if(m_pendingGPUTimers.begin(),
+                                                m_pendingGPUTimers.end(),
+                                                [this](const PendingGPUTimer& timer) {
+                                                    return timer.bufferRingIdx == m_bufferRingIdx;
+                                                }),
+                                 m_pendingGPUTimers.end());
+        vkCmdResetQueryPool(commandBuffer, m_gpuTimerQueryPool, m_bufferRingIdx * 2, 2);
+        vkCmdWriteTimestamp(commandBuffer,
+                            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                            m_gpuTimerQueryPool,
+                            m_bufferRingIdx * 2);
+        m_pendingGPUTimers.push_back({m_bufferRingIdx, desc.gpuTimerFrameNumber});
     }
 
-    if (interlockMode == pls::InterlockMode::rasterOrdering && m_scratchColorTexture == nullptr)
+    // Later passes of a tile-binned flush read the resource textures rendered by the first pass.
+    // (Transitioning them from VK_IMAGE_LAYOUT_UNDEFINED again would discard their contents.)
+    VkImageLayout resourceTextureLayout = desc.isTileBinPass && !desc.isFirstTileBinPass
+                                              ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+                                              : VK_IMAGE_LAYOUT_UNDEFINED;
+
+    // Expand the TessCurves into TessVertexSpans before the tessellation pass reads them.
+    bool asyncCompute = m_asyncComputeTimeline != nullptr && desc.externalCommandBuffer == nullptr;
+    int gpuTessSpanBufferIdx = asyncCompute ? m_bufferRingIdx : 0;
+    rcp<vkutil::Buffer>& gpuTessSpanBuffer = m_gpuTessSpanBuffers[gpuTessSpanBufferIdx];
+    if (desc.gpuTessellationSpans && desc.tessCurveCount > 0)
     {
-        m_scratchColorTexture = allocator->makeTexture({
-            .format = VK_FORMAT_R8G8B8A8_UNORM,
-            .extent = {width(), height(), 1},
-            .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT |
-                     VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT,
-        });
+        if (gpuTessSpanBuffer == nullptr ||
+            gpuTessSpanBuffer->info().size < m_tessSpanBufferRing.size())
+        {
+            gpuTessSpanBuffer = m_allocator->makeBuffer(
+                {
+                    .size = m_tessSpanBufferRing.size(),
+                    .usage =
+                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                },
+                vkutil::Mappability::none);
+        }
 
-        vkutil::insert_image_memory_barrier(commandBuffer,
-                                            *m_scratchColorTexture,
-                                            VK_IMAGE_LAYOUT_UNDEFINED,
-                                            VK_IMAGE_LAYOUT_GENERAL);
+        VkCommandBuffer computeCommandBuffer = commandBuffer;
+        if (asyncCompute)
+        {
+            // The submission in flush() waits on this work before any vertex input, and this
+            // slot's span buffer isn't read by any other in-flight frame, so no barriers needed.
+            computeCommandBuffer = beginAsyncComputeWork();
+        }
+        else
+        {
+            // Don't overwrite spans that a previous flush may still be reading as vertices.
+            vkCmdPipelineBarrier(commandBuffer,
+                                 VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                 0,
+                                 0,
+                                 nullptr,
+                                 0,
+                                 nullptr,
+                                 0,
+                                 nullptr);
+        }
 
-        m_scratchColorTextureView = allocator->makeTextureView(m_scratchColorTexture);
-    }
+        beginDebugLabel(computeCommandBuffer, "PLS expand tessellation spans");
+        vkCmdBindPipeline(computeCommandBuffer,
+                          VK_PIPELINE_BIND_POINT_COMPUTE,
+                          m_expandTessSpansPipeline->computePipeline());
 
-    if (interlockMode == pls::InterlockMode::atomics && m_coverageAtomicTexture == nullptr)
-    {
-        m_coverageAtomicTexture = allocator->makeTexture({
-            .format = VK_FORMAT_R32_UINT,
-            .extent = {width(), height(), 1},
-            .usage = VK_IMAGE_USAGE_STORAGE_BIT |
-                     VK_IMAGE_USAGE_TRANSFER_DST_BIT, // For vkCmdClearColorImage
-        });
+        VkDescriptorSet descriptorSet = descriptorSetPool->allocateDescriptorSet(
+            m_expandTessSpansPipeline->descriptorSetLayout());
 
-        vkutil::insert_image_memory_barrier(commandBuffer,
-                                            *m_coverageAtomicTexture,
-                                            VK_IMAGE_LAYOUT_UNDEFINED,
-                                            VK_IMAGE_LAYOUT_GENERAL);
+        vkutil::update_buffer_descriptor_sets(
+            m_device,
+            descriptorSet,
+            {
+                .dstBinding = ExpandTessSpansPipeline::TESS_CURVE_BUFFER_IDX,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            },
+            {{
+                .buffer = m_tessSpanBufferRing.vkBufferAt(m_bufferRingIdx),
+                .offset = m_tessSpanBufferRing.offset() +
+                          desc.firstTessVertexSpan * sizeof(pls::TessCurve),
+                .range = desc.tessCurveCount * sizeof(pls::TessCurve),
+            }});
 
-        m_coverageAtomicTextureView = allocator->makeTextureView(m_coverageAtomicTexture);
-    }
-}
+        vkutil::update_buffer_descriptor_sets(
+            m_device,
+            descriptorSet,
+            {
+                .dstBinding = ExpandTessSpansPipeline::TESS_SPAN_BUFFER_IDX,
+                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            },
+            {{
+                .buffer = *gpuTessSpanBuffer,
+                .offset = desc.firstTessVertexSpan * sizeof(pls::TessVertexSpan),
+                .range = desc.tessVertexSpanCount * sizeof(pls::TessVertexSpan),
+            }});
 
-void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
-{
-    if (desc.interlockMode == pls::InterlockMode::depthStencil)
-    {
-        return; // TODO: support MSAA.
-    }
+        vkCmdBindDescriptorSets(computeCommandBuffer,
+                                VK_PIPELINE_BIND_POINT_COMPUTE,
+                                m_expandTessSpansPipeline->pipelineLayout(),
+                                PER_FLUSH_BINDINGS_SET,
+                                1,
+                                &descriptorSet,
+                                0,
+                                nullptr);
 
-    auto commandBuffer = reinterpret_cast<VkCommandBuffer>(desc.externalCommandBuffer);
-    rcp<DescriptorSetPool> descriptorSetPool = makeDescriptorSetPool();
+        uint32_t curveCount = static_cast<uint32_t>(desc.tessCurveCount);
+        vkCmdPushConstants(computeCommandBuffer,
+                           m_expandTessSpansPipeline->pipelineLayout(),
+                           VK_SHADER_STAGE_COMPUTE_BIT,
+                           0,
+                           sizeof(curveCount),
+                           &curveCount);
+
+        constexpr static uint32_t kWorkgroupSize = ExpandTessSpansPipeline::kWorkgroupSize;
+        vkCmdDispatch(computeCommandBuffer,
+                      (curveCount + kWorkgroupSize - 1) / kWorkgroupSize,
+                      1,
+                      1);
+        endDebugLabel(computeCommandBuffer);
+
+        if (!asyncCompute)
+        {
+            VkMemoryBarrier memoryBarrier = {
+                .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+                .dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+            };
 
-    constexpr static VkDeviceSize zeroOffset[1] = {0};
-    constexpr static uint32_t zeroOffset32[1] = {0};
+            vkCmdPipelineBarrier(commandBuffer,
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                 VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                                 0,
+                                 1,
+                                 &memoryBarrier,
+                                 0,
+                                 nullptr,
+                                 0,
+                                 nullptr);
+        }
+    }
 
+    // The gradient texture holds a persistent atlas of complex color ramps, so only discard its
+    // contents the first time it gets used.
     vkutil::insert_image_memory_barrier(commandBuffer,
                                         *m_gradientTexture,
-                                        VK_IMAGE_LAYOUT_UNDEFINED,
+                                        m_gradTextureLayout,
                                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
 
     // Render the complex color ramps to the gradient texture.
@@ -2007,6 +3781,7 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
             .renderArea = renderArea,
         };
 
+        beginDebugLabel(commandBuffer, "PLS color ramps");
         vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
         vkCmdBindPipeline(commandBuffer,
@@ -2018,7 +3793,8 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
         vkCmdSetScissor(commandBuffer, 0, 1, &renderArea);
 
         VkBuffer buffer = m_gradSpanBufferRing.vkBufferAt(m_bufferRingIdx);
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, &buffer, zeroOffset);
+        VkDeviceSize offset = m_gradSpanBufferRing.offset();
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, &buffer, &offset);
 
         VkDescriptorSet descriptorSet =
             descriptorSetPool->allocateDescriptorSet(m_colorRampPipeline->descriptorSetLayout());
@@ -2032,7 +3808,7 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
             },
             {{
                 .buffer = m_flushUniformBufferRing.vkBufferAt(m_bufferRingIdx),
-                .offset = desc.flushUniformDataOffsetInBytes,
+                .offset = m_flushUniformBufferRing.offset() + desc.flushUniformDataOffsetInBytes,
                 .range = sizeof(pls::FlushUniforms),
             }});
 
@@ -2048,6 +3824,7 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
         vkCmdDraw(commandBuffer, 4, desc.complexGradSpanCount, 0, desc.firstComplexGradSpan);
 
         vkCmdEndRenderPass(commandBuffer);
+        endDebugLabel(commandBuffer);
     }
 
     vkutil::insert_image_memory_barrier(commandBuffer,
@@ -2059,7 +3836,8 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
     if (desc.simpleGradTexelsHeight > 0)
     {
         VkBufferImageCopy bufferImageCopy{
-            .bufferOffset = desc.simpleGradDataOffsetInBytes,
+            .bufferOffset =
+                m_simpleColorRampsBufferRing.offset() + desc.simpleGradDataOffsetInBytes,
             .bufferRowLength = pls::kGradTextureWidth,
             .imageSubresource =
                 {
@@ -2086,10 +3864,11 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
                                         *m_gradientTexture,
                                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
                                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    m_gradTextureLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
     vkutil::insert_image_memory_barrier(commandBuffer,
                                         *m_tessVertexTexture,
-                                        VK_IMAGE_LAYOUT_UNDEFINED,
+                                        resourceTextureLayout,
                                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
 
     // Tessellate all curves into vertices in the tessellation texture.
@@ -2106,6 +3885,7 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
             .renderArea = renderArea,
         };
 
+        beginDebugLabel(commandBuffer, "PLS tessellate");
         vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
         vkCmdBindPipeline(commandBuffer,
@@ -2116,8 +3896,20 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
 
         vkCmdSetScissor(commandBuffer, 0, 1, &renderArea);
 
-        VkBuffer buffer = m_tessSpanBufferRing.vkBufferAt(m_bufferRingIdx);
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, &buffer, zeroOffset);
+        VkBuffer buffer;
+        VkDeviceSize offset;
+        if (desc.gpuTessellationSpans)
+        {
+            // The compute pass above expanded the TessCurves into this buffer.
+            buffer = *gpuTessSpanBuffer;
+            offset = 0;
+        }
+        else
+        {
+            buffer = m_tessSpanBufferRing.vkBufferAt(m_bufferRingIdx);
+            offset = m_tessSpanBufferRing.offset();
+        }
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, &buffer, &offset);
 
         vkCmdBindIndexBuffer(commandBuffer, *m_tessSpanIndexBuffer, 0, VK_INDEX_TYPE_UINT16);
 
@@ -2133,7 +3925,7 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
             },
             {{
                 .buffer = m_pathBufferRing.vkBufferAt(m_bufferRingIdx),
-                .offset = desc.firstPath * sizeof(pls::PathData),
+                .offset = m_pathBufferRing.offset() + desc.firstPath * sizeof(pls::PathData),
                 .range = VK_WHOLE_SIZE,
             }});
 
@@ -2146,7 +3938,8 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
             },
             {{
                 .buffer = m_contourBufferRing.vkBufferAt(m_bufferRingIdx),
-                .offset = desc.firstContour * sizeof(pls::ContourData),
+                .offset =
+                    m_contourBufferRing.offset() + desc.firstContour * sizeof(pls::ContourData),
                 .range = VK_WHOLE_SIZE,
             }});
 
@@ -2159,7 +3952,7 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
             },
             {{
                 .buffer = m_flushUniformBufferRing.vkBufferAt(m_bufferRingIdx),
-                .offset = desc.flushUniformDataOffsetInBytes,
+                .offset = m_flushUniformBufferRing.offset() + desc.flushUniformDataOffsetInBytes,
                 .range = VK_WHOLE_SIZE,
             }});
 
@@ -2180,6 +3973,7 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
                          desc.firstTessVertexSpan);
 
         vkCmdEndRenderPass(commandBuffer);
+        endDebugLabel(commandBuffer);
     }
 
     vkutil::insert_image_memory_barrier(commandBuffer,
@@ -2192,9 +3986,41 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
     {
         m_nullImageTexture->synchronize(commandBuffer, this);
     }
+    bool bindlessImagePaints = desc.interlockMode == pls::InterlockMode::atomics &&
+                               m_bindlessTextureTable != nullptr;
+    bool didUploadRenderBuffers = false;
     for (const DrawBatch& batch : *desc.drawList)
     {
-        if (auto imageTextureVulkan = static_cast<const PLSTextureVulkanImpl*>(batch.imageTexture))
+        if (batch.drawType == DrawType::imageMesh)
+        {
+            // Copy device-local mesh buffers in from staging the first time they get drawn.
+            for (const RenderBuffer* buffer :
+                 {batch.vertexBuffer, batch.uvBuffer, batch.indexBuffer})
+            {
+                auto bufferVulkan = static_cast<const RenderBufferVulkanImpl*>(buffer);
+                if (bufferVulkan->hasUpdates())
+                {
+                    bufferVulkan->synchronize(commandBuffer);
+                    didUploadRenderBuffers = true;
+                }
+            }
+        }
+        if (bindlessImagePaints && batch.imageTexture != nullptr)
+        {
+            // The batch may sample from a different image in every draw.
+            for (const PLSDraw* draw = batch.internalDrawList; draw != nullptr;
+                 draw = draw->batchInternalNeighbor())
+            {
+                auto imageTextureVulkan =
+                    static_cast<const PLSTextureVulkanImpl*>(draw->imageTexture());
+                if (imageTextureVulkan != nullptr && imageTextureVulkan->hasUpdates())
+                {
+                    imageTextureVulkan->synchronize(commandBuffer, this);
+                }
+            }
+        }
+        else if (auto imageTextureVulkan =
+                     static_cast<const PLSTextureVulkanImpl*>(batch.imageTexture))
         {
             if (imageTextureVulkan->hasUpdates())
             {
@@ -2202,9 +4028,36 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
             }
         }
     }
+    if (didUploadRenderBuffers)
+    {
+        VkMemoryBarrier memoryBarrier = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT,
+        };
+        vkCmdPipelineBarrier(commandBuffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                             0,
+                             1,
+                             &memoryBarrier,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr);
+    }
 
     auto* renderTarget = static_cast<PLSRenderTargetVulkan*>(desc.renderTarget);
-    renderTarget->synchronize(m_allocator.get(), commandBuffer, desc.interlockMode);
+    renderTarget->synchronize(m_allocator.get(),
+                              commandBuffer,
+                              desc.interlockMode,
+                              m_contextOptions.plsPlaneSizeBucket != 0
+                                  ? sharedPLSPlanes(renderTarget->width(), renderTarget->height())
+                                  : nullptr);
+    if (renderTarget->m_hasExternalAccess && desc.isFirstFlushOfRenderTarget)
+    {
+        renderTarget->acquireExternalImage(commandBuffer, m_contextOptions.queueFamilyIndex);
+    }
 
     int interlockIdx = static_cast<int>(desc.interlockMode);
     assert(interlockIdx < m_drawPipelineLayouts.size());
@@ -2222,13 +4075,13 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
     VkImageView imageViews[] = {
         *renderTarget->m_targetTextureView,
         desc.interlockMode == pls::InterlockMode::atomics
-            // Just use m_clipTextureView to have something. TODO: cleanup.
-            ? renderTarget->m_clipTextureView->vkImageView()
-            : renderTarget->m_coverageTextureView->vkImageView(),
-        *renderTarget->m_clipTextureView,
+            // Just use clipTextureView to have something. TODO: cleanup.
+            ? renderTarget->m_planes->clipTextureView->vkImageView()
+            : renderTarget->m_planes->coverageTextureView->vkImageView(),
+        *renderTarget->m_planes->clipTextureView,
         desc.interlockMode == pls::InterlockMode::atomics
             ? VK_NULL_HANDLE
-            : renderTarget->m_scratchColorTextureView->vkImageView(),
+            : renderTarget->m_planes->scratchColorTextureView->vkImageView(),
     };
 
     rcp<vkutil::Framebuffer> framebuffer = m_allocator->makeFramebuffer({
@@ -2240,10 +4093,23 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
         .layers = 1,
     });
 
-    VkRect2D renderArea = {
+    VkRect2D renderTargetRect = {
         .extent = {static_cast<uint32_t>(renderTarget->width()),
                    static_cast<uint32_t>(renderTarget->height())},
     };
+    VkRect2D renderArea = renderTargetRect;
+    if (desc.isTileBinPass ||
+        (desc.interlockMode == pls::InterlockMode::atomics && desc.hasPartialUpdateBounds &&
+         !desc.renderTargetUpdateBounds.empty()))
+    {
+        // Only load, store, rasterize, and resolve the bin (or the pixels this flush updates).
+        const IAABB& bounds = desc.renderTargetUpdateBounds;
+        renderArea = {
+            .offset = {bounds.left, bounds.top},
+            .extent = {static_cast<uint32_t>(bounds.width()),
+                       static_cast<uint32_t>(bounds.height())},
+        };
+    }
 
     VkClearValue clearValues[3] = {
         {.color = vkutil::color_clear_rgba32f(desc.clearColor)},
@@ -2268,10 +4134,16 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
                 pls::ShaderFeatures::ENABLE_ADVANCED_BLEND &&
 #endif
             desc.colorLoadAction == pls::LoadAction::clear;
+    }
 
-        // Clear the coverage texture, which is not an attachment.
+    // Clear the coverage texture, which is not an attachment. (vkCmdClearColorImage() can't be
+    // restricted to a bin, but since bins don't overlap, clearing once during the first bin of a
+    // tile-binned flush leaves every later bin cleared as well.)
+    if (desc.interlockMode == pls::InterlockMode::atomics &&
+        (!desc.isTileBinPass || desc.isFirstTileBinPass))
+    {
         vkutil::insert_image_memory_barrier(commandBuffer,
-                                            *renderTarget->m_coverageAtomicTexture,
+                                            *renderTarget->m_planes->coverageAtomicTexture,
                                             VK_IMAGE_LAYOUT_GENERAL,
                                             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
 
@@ -2282,14 +4154,14 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
         };
 
         vkCmdClearColorImage(commandBuffer,
-                             *renderTarget->m_coverageAtomicTexture,
+                             *renderTarget->m_planes->coverageAtomicTexture,
                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
                              &clearValues[COVERAGE_PLANE_IDX].color,
                              1,
                              &clearRange);
 
         vkutil::insert_image_memory_barrier(commandBuffer,
-                                            *renderTarget->m_coverageAtomicTexture,
+                                            *renderTarget->m_planes->coverageAtomicTexture,
                                             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
                                             VK_IMAGE_LAYOUT_GENERAL);
     }
@@ -2303,12 +4175,6 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
         .pClearValues = clearValues,
     };
 
-    vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-    vkCmdSetViewport(commandBuffer, 0, 1, vkutil::ViewportFromRect2D(renderArea));
-
-    vkCmdSetScissor(commandBuffer, 0, 1, &renderArea);
-
     // Update the per-flush descriptor sets.
     VkDescriptorSet perFlushDescriptorSet =
         descriptorSetPool->allocateDescriptorSet(layout.perFlushLayout());
@@ -2346,7 +4212,7 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
         },
         {{
             .buffer = m_pathBufferRing.vkBufferAt(m_bufferRingIdx),
-            .offset = desc.firstPath * sizeof(pls::PathData),
+            .offset = m_pathBufferRing.offset() + desc.firstPath * sizeof(pls::PathData),
             .range = VK_WHOLE_SIZE,
         }});
 
@@ -2360,12 +4226,13 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
         {
             {
                 .buffer = m_paintBufferRing.vkBufferAt(m_bufferRingIdx),
-                .offset = desc.firstPaint * sizeof(pls::PaintData),
+                .offset = m_paintBufferRing.offset() + desc.firstPaint * sizeof(pls::PaintData),
                 .range = VK_WHOLE_SIZE,
             },
             {
                 .buffer = m_paintAuxBufferRing.vkBufferAt(m_bufferRingIdx),
-                .offset = desc.firstPaintAux * sizeof(pls::PaintAuxData),
+                .offset = m_paintAuxBufferRing.offset() +
+                          desc.firstPaintAux * sizeof(pls::PaintAuxData),
                 .range = VK_WHOLE_SIZE,
             },
         });
@@ -2380,7 +4247,7 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
         },
         {{
             .buffer = m_contourBufferRing.vkBufferAt(m_bufferRingIdx),
-            .offset = desc.firstContour * sizeof(pls::ContourData),
+            .offset = m_contourBufferRing.offset() + desc.firstContour * sizeof(pls::ContourData),
             .range = VK_WHOLE_SIZE,
         }});
 
@@ -2393,7 +4260,7 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
         },
         {{
             .buffer = m_flushUniformBufferRing.vkBufferAt(m_bufferRingIdx),
-            .offset = desc.flushUniformDataOffsetInBytes,
+            .offset = m_flushUniformBufferRing.offset() + desc.flushUniformDataOffsetInBytes,
             .range = sizeof(pls::FlushUniforms),
         }});
 
@@ -2406,7 +4273,7 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
         },
         {{
             .buffer = m_imageDrawUniformBufferRing.vkBufferAt(m_bufferRingIdx),
-            .offset = 0,
+            .offset = m_imageDrawUniformBufferRing.offset(),
             .range = sizeof(pls::ImageDrawUniforms),
         }});
 
@@ -2436,8 +4303,8 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
         },
         {{
             .imageView = desc.interlockMode == pls::InterlockMode::atomics
-                             ? renderTarget->m_coverageAtomicTextureView->vkImageView()
-                             : renderTarget->m_coverageTextureView->vkImageView(),
+                             ? renderTarget->m_planes->coverageAtomicTextureView->vkImageView()
+                             : renderTarget->m_planes->coverageTextureView->vkImageView(),
             .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
         }});
 
@@ -2448,7 +4315,7 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
                                              .descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,
                                          },
                                          {{
-                                             .imageView = *renderTarget->m_clipTextureView,
+                                             .imageView = *renderTarget->m_planes->clipTextureView,
                                              .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
                                          }});
 
@@ -2462,37 +4329,24 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
                 .descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,
             },
             {{
-                .imageView = *renderTarget->m_scratchColorTextureView,
+                .imageView = *renderTarget->m_planes->scratchColorTextureView,
                 .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
             }});
     }
 
-    // Bind the descriptor sets for this draw pass.
-    // (The imageTexture and imageDraw dynamic uniform offsets might have to update
-    // between draws, but this is otherwise all we need to bind!)
-    VkDescriptorSet drawDescriptorSets[] = {
-        perFlushDescriptorSet,
-        layout.nullImageDescriptorSet(),
-        layout.samplerDescriptorSet(),
-        inputAttachmentDescriptorSet,
+    DrawPassState drawPass = {
+        .desc = &desc,
+        .layout = &layout,
+        .perFlushDescriptorSet = perFlushDescriptorSet,
+        .inputAttachmentDescriptorSet = inputAttachmentDescriptorSet,
+        .renderTargetRect = renderTargetRect,
+        .renderArea = renderArea,
     };
-    static_assert(PER_FLUSH_BINDINGS_SET == 0);
-    static_assert(PER_DRAW_BINDINGS_SET == 1);
-    static_assert(SAMPLER_BINDINGS_SET == 2);
-    static_assert(PLS_TEXTURE_BINDINGS_SET == 3);
-    static_assert(BINDINGS_SET_COUNT == 4);
-
-    vkCmdBindDescriptorSets(commandBuffer,
-                            VK_PIPELINE_BIND_POINT_GRAPHICS,
-                            layout.vkPipelineLayout(),
-                            PER_FLUSH_BINDINGS_SET,
-                            std::size(drawDescriptorSets),
-                            drawDescriptorSets,
-                            1,
-                            zeroOffset32);
 
-    // Execute the DrawList.
-    uint32_t imageTextureUpdateCount = 0;
+    // Resolve every batch's pipeline and image descriptor set up front, on this thread. (Neither
+    // the pipeline cache nor the descriptor pools are thread safe.) After this, the draws
+    // themselves can be recorded from any thread.
+    m_resolvedDrawBatches.clear();
     for (const DrawBatch& batch : *desc.drawList)
     {
         if (batch.elementCount == 0)
@@ -2500,96 +4354,269 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
             continue;
         }
 
-        DrawType drawType = batch.drawType;
-
-        if (batch.imageTexture != nullptr)
+        if (batch.imageTexture != nullptr && !usesPushDescriptors())
         {
-            // Update the imageTexture binding and the dynamic offset into the
-            // imageDraw uniform buffer.
             auto imageTexture = static_cast<const PLSTextureVulkanImpl*>(batch.imageTexture);
-            if (imageTexture->m_descriptorSetFrameIdx != m_currentFrameIdx)
+            if (imageTexture->m_imageTextureDescriptorSet == nullptr)
             {
-                // Update the image's "texture binding" descriptor set. (These
-                // expire every frame, so we need to make a new one each frame.)
-                if (imageTextureUpdateCount >= descriptor_pool_limits::kMaxImageTextureUpdates)
-                {
-                    // We ran out of room for image texture updates. Allocate a new
-                    // pool.
-                    descriptorSetPool = makeDescriptorSetPool();
-                    imageTextureUpdateCount = 0;
-                }
-
+                // This is the first time the image has been drawn. Its descriptor set stays valid
+                // for every flush after this one.
                 imageTexture->m_imageTextureDescriptorSet =
-                    descriptorSetPool->allocateDescriptorSet(layout.perDrawLayout());
-
-                vkutil::update_image_descriptor_sets(
-                    m_device,
-                    imageTexture->m_imageTextureDescriptorSet,
-                    {
-                        .dstBinding = IMAGE_TEXTURE_IDX,
-                        .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
-                    },
-                    {{
-                        .imageView = *imageTexture->m_textureView,
-                        .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                    }});
-
-                ++imageTextureUpdateCount;
-                imageTexture->m_descriptorSetFrameIdx = m_currentFrameIdx;
+                    makeImageDescriptorSet(layout.perDrawLayout(), *imageTexture->m_textureView);
             }
-
-            VkDescriptorSet imageDescriptorSets[] = {
-                perFlushDescriptorSet,                     // Dynamic offset to imageDraw uniforms.
-                imageTexture->m_imageTextureDescriptorSet, // imageTexture.
-            };
-            static_assert(PER_DRAW_BINDINGS_SET == PER_FLUSH_BINDINGS_SET + 1);
-
-            vkCmdBindDescriptorSets(commandBuffer,
-                                    VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                    layout.vkPipelineLayout(),
-                                    PER_FLUSH_BINDINGS_SET,
-                                    std::size(imageDescriptorSets),
-                                    imageDescriptorSets,
-                                    1,
-                                    &batch.imageDrawDataOffset);
         }
 
         // Setup the pipeline for this specific drawType and shaderFeatures.
         pls::ShaderFeatures shaderFeatures = desc.interlockMode == pls::InterlockMode::atomics
                                                  ? desc.combinedShaderFeatures
                                                  : batch.shaderFeatures;
-        uint32_t pipelineKey = pls::ShaderUniqueKey(drawType,
-                                                    shaderFeatures,
-                                                    desc.interlockMode,
-                                                    pls::ShaderMiscFlags::none);
         auto drawPipelineOptions = DrawPipelineOptions::none;
         if (m_capabilities.fillModeNonSolid && desc.wireframe)
         {
             drawPipelineOptions |= DrawPipelineOptions::wireframe;
         }
-        assert(pipelineKey << kDrawPipelineOptionCount >> kDrawPipelineOptionCount == pipelineKey);
-        pipelineKey =
-            (pipelineKey << kDrawPipelineOptionCount) | static_cast<uint32_t>(drawPipelineOptions);
-        assert(pipelineKey * DrawPipelineLayout::kRenderPassVariantCount /
-                   DrawPipelineLayout::kRenderPassVariantCount ==
-               pipelineKey);
-        pipelineKey =
-            (pipelineKey * DrawPipelineLayout::kRenderPassVariantCount) + renderPassVariantIdx;
-        const DrawPipeline& drawPipeline = m_drawPipelines
-                                               .try_emplace(pipelineKey,
-                                                            this,
-                                                            drawType,
-                                                            desc.interlockMode,
-                                                            shaderFeatures,
-                                                            drawPipelineOptions,
-                                                            layout.vkPipelineLayout(),
-                                                            drawRenderPass)
-                                               .first->second;
+        const DrawPipeline* drawPipeline = findCompatibleDrawPipeline(batch.drawType,
+                                                                      desc.interlockMode,
+                                                                      shaderFeatures,
+                                                                      drawPipelineOptions,
+                                                                      renderPassVariantIdx,
+                                                                      layout.vkPipelineLayout(),
+                                                                      drawRenderPass);
+        m_resolvedDrawBatches.push_back({
+            .batch = &batch,
+            .vkPipeline = drawPipeline->vkPipeline(),
+            .needsBarrierBeforeDraw = needsBarrierBeforeNextDraw,
+        });
+
+        needsBarrierBeforeNextDraw =
+            desc.interlockMode == pls::InterlockMode::atomics && batch.needsBarrier;
+    }
+
+    // Only split the draw pass if every worker gets enough batches to outweigh the overhead of
+    // a secondary command buffer.
+    constexpr static size_t kMinBatchesPerSecondaryCommandBuffer = 64;
+    size_t chunkCount = 1;
+    if (m_parallelCommandRecorder != nullptr)
+    {
+        chunkCount = std::clamp<size_t>(m_resolvedDrawBatches.size() /
+                                            kMinBatchesPerSecondaryCommandBuffer,
+                                        1,
+                                        m_parallelCommandRecorder->workerCount());
+    }
+
+    beginDebugLabel(commandBuffer, desc.isTileBinPass ? "PLS draw (tile bin)" : "PLS draw");
+    if (chunkCount == 1)
+    {
+        vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+        recordDrawBatches(commandBuffer, drawPass, 0, m_resolvedDrawBatches.size());
+    }
+    else
+    {
+        vkCmdBeginRenderPass(commandBuffer,
+                             &renderPassBeginInfo,
+                             VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+        VkCommandBufferInheritanceInfo inheritanceInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+            .renderPass = drawRenderPass,
+            .subpass = 0,
+            .framebuffer = *framebuffer,
+        };
+        size_t batchCount = m_resolvedDrawBatches.size();
+        m_parallelCommandRecorder->record(
+            m_bufferRingIdx,
+            inheritanceInfo,
+            chunkCount,
+            [&](VkCommandBuffer secondaryCommandBuffer, size_t chunkIdx) {
+                recordDrawBatches(secondaryCommandBuffer,
+                                  drawPass,
+                                  batchCount * chunkIdx / chunkCount,
+                                  batchCount * (chunkIdx + 1) / chunkCount);
+            },
+            &m_secondaryCommandBuffers);
+
+        vkCmdExecuteCommands(commandBuffer,
+                             static_cast<uint32_t>(m_secondaryCommandBuffers.size()),
+                             m_secondaryCommandBuffers.data());
+    }
+
+    vkCmdEndRenderPass(commandBuffer);
+    endDebugLabel(commandBuffer);
+
+    if (renderTarget->m_hasExternalAccess && desc.isFinalFlushOfRenderTarget)
+    {
+        renderTarget->releaseExternalImage(commandBuffer, m_contextOptions.queueFamilyIndex);
+    }
+
+    if (timesGPUFrame && desc.isFinalFlushOfFrame)
+    {
+        vkCmdWriteTimestamp(commandBuffer,
+                            VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                            m_gpuTimerQueryPool,
+                            m_bufferRingIdx * 2 + 1);
+    }
+
+    if (desc.isFinalFlushOfFrame)
+    {
+        m_frameCompletionFences[m_bufferRingIdx] = ref_rcp(desc.frameCompletionFence);
+    }
+}
+
+void PLSRenderContextVulkanImpl::recordDrawBatches(VkCommandBuffer commandBuffer,
+                                                   const DrawPassState& drawPass,
+                                                   size_t begin,
+                                                   size_t end)
+{
+    constexpr static VkDeviceSize zeroOffset[1] = {0};
+    constexpr static uint32_t zeroOffset32[1] = {0};
+
+    const FlushDescriptor& desc = *drawPass.desc;
+    const DrawPipelineLayout& layout = *drawPass.layout;
+
+    // Secondary command buffers don't inherit dynamic state or bindings from the primary, so set
+    // everything up again, even if this is the primary.
+    vkCmdSetViewport(commandBuffer, 0, 1, vkutil::ViewportFromRect2D(drawPass.renderTargetRect));
+
+    vkCmdSetScissor(commandBuffer, 0, 1, &drawPass.renderArea);
+
+    // Binds an image texture to the per-draw set as a push descriptor.
+    auto pushImageTexture = [&](VkImageView imageView) {
+        assert(usesPushDescriptors());
+        VkDescriptorImageInfo imageInfo = {
+            .imageView = imageView,
+            .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        };
+        VkWriteDescriptorSet writeSet = {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstBinding = IMAGE_TEXTURE_IDX,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+            .pImageInfo = &imageInfo,
+        };
+        m_vkCmdPushDescriptorSetKHR(commandBuffer,
+                                    VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                    layout.vkPipelineLayout(),
+                                    PER_DRAW_BINDINGS_SET,
+                                    1,
+                                    &writeSet);
+    };
+
+    // Bind the descriptor sets for this draw pass.
+    // (The imageTexture and imageDraw dynamic uniform offsets might have to update
+    // between draws, but this is otherwise all we need to bind!)
+    static_assert(PER_FLUSH_BINDINGS_SET == 0);
+    static_assert(PER_DRAW_BINDINGS_SET == 1);
+    static_assert(SAMPLER_BINDINGS_SET == 2);
+    static_assert(PLS_TEXTURE_BINDINGS_SET == 3);
+    static_assert(BINDINGS_SET_COUNT == 4);
+    if (usesPushDescriptors())
+    {
+        // The per-draw set can't be bound as a VkDescriptorSet. Bind around it.
+        vkCmdBindDescriptorSets(commandBuffer,
+                                VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                layout.vkPipelineLayout(),
+                                PER_FLUSH_BINDINGS_SET,
+                                1,
+                                &drawPass.perFlushDescriptorSet,
+                                1,
+                                zeroOffset32);
+        pushImageTexture(*m_nullImageTexture->m_textureView);
+        VkDescriptorSet staticDescriptorSets[] = {
+            layout.samplerDescriptorSet(),
+            drawPass.inputAttachmentDescriptorSet,
+        };
+        vkCmdBindDescriptorSets(commandBuffer,
+                                VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                layout.vkPipelineLayout(),
+                                SAMPLER_BINDINGS_SET,
+                                std::size(staticDescriptorSets),
+                                staticDescriptorSets,
+                                0,
+                                nullptr);
+    }
+    else
+    {
+        VkDescriptorSet drawDescriptorSets[] = {
+            drawPass.perFlushDescriptorSet,
+            layout.nullImageDescriptorSet(),
+            layout.samplerDescriptorSet(),
+            drawPass.inputAttachmentDescriptorSet,
+        };
+        vkCmdBindDescriptorSets(commandBuffer,
+                                VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                layout.vkPipelineLayout(),
+                                PER_FLUSH_BINDINGS_SET,
+                                std::size(drawDescriptorSets),
+                                drawDescriptorSets,
+                                1,
+                                zeroOffset32);
+    }
+    if (layout.usesBindlessTextures())
+    {
+        VkDescriptorSet bindlessTexturesDescriptorSet = m_bindlessTextureTable->descriptorSet();
+        vkCmdBindDescriptorSets(commandBuffer,
+                                VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                layout.vkPipelineLayout(),
+                                BINDLESS_TEXTURES_SET,
+                                1,
+                                &bindlessTexturesDescriptorSet,
+                                0,
+                                nullptr);
+    }
+
+    // Execute the DrawList.
+    for (size_t i = begin; i < end; ++i)
+    {
+        const ResolvedDrawBatch& resolved = m_resolvedDrawBatches[i];
+        const DrawBatch& batch = *resolved.batch;
+        DrawType drawType = batch.drawType;
+
+        if (batch.imageTexture != nullptr || drawType == DrawType::imageRect)
+        {
+            // Update the imageTexture binding and the dynamic offset into the
+            // imageDraw uniform buffer. (Solid-color imageRects don't have a texture, so they bind
+            // the null image.)
+            auto imageTexture = static_cast<const PLSTextureVulkanImpl*>(batch.imageTexture);
+            if (usesPushDescriptors())
+            {
+                pushImageTexture(imageTexture != nullptr ? *imageTexture->m_textureView
+                                                         : *m_nullImageTexture->m_textureView);
+                vkCmdBindDescriptorSets(commandBuffer,
+                                        VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                        layout.vkPipelineLayout(),
+                                        PER_FLUSH_BINDINGS_SET,
+                                        1,
+                                        &drawPass.perFlushDescriptorSet,
+                                        1,
+                                        &batch.imageDrawDataOffset);
+            }
+            else
+            {
+                VkDescriptorSet imageTextureDescriptorSet =
+                    imageTexture != nullptr ? *imageTexture->m_imageTextureDescriptorSet
+                                            : layout.nullImageDescriptorSet();
+                VkDescriptorSet imageDescriptorSets[] = {
+                    drawPass.perFlushDescriptorSet, // Dynamic offset to imageDraw uniforms.
+                    imageTextureDescriptorSet,      // imageTexture.
+                };
+                static_assert(PER_DRAW_BINDINGS_SET == PER_FLUSH_BINDINGS_SET + 1);
+
+                vkCmdBindDescriptorSets(commandBuffer,
+                                        VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                        layout.vkPipelineLayout(),
+                                        PER_FLUSH_BINDINGS_SET,
+                                        std::size(imageDescriptorSets),
+                                        imageDescriptorSets,
+                                        1,
+                                        &batch.imageDrawDataOffset);
+            }
+        }
+
         vkCmdBindPipeline(commandBuffer,
                           VK_PIPELINE_BIND_POINT_GRAPHICS,
-                          drawPipeline.vkPipeline());
+                          resolved.vkPipeline);
 
-        if (needsBarrierBeforeNextDraw)
+        if (resolved.needsBarrierBeforeDraw)
         {
             assert(desc.interlockMode == pls::InterlockMode::atomics);
 
@@ -2638,7 +4665,8 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
             case DrawType::interiorTriangulation:
             {
                 VkBuffer buffer = m_triangleBufferRing.vkBufferAt(m_bufferRingIdx);
-                vkCmdBindVertexBuffers(commandBuffer, 0, 1, &buffer, zeroOffset);
+                VkDeviceSize offset = m_triangleBufferRing.offset();
+                vkCmdBindVertexBuffers(commandBuffer, 0, 1, &buffer, &offset);
                 vkCmdDraw(commandBuffer, batch.elementCount, 1, batch.baseElement, 0);
                 break;
             }
@@ -2698,25 +4726,61 @@ void PLSRenderContextVulkanImpl::flush(const FlushDescriptor& desc)
             case DrawType::stencilClipReset:
                 RIVE_UNREACHABLE();
         }
-
-        needsBarrierBeforeNextDraw =
-            desc.interlockMode == pls::InterlockMode::atomics && batch.needsBarrier;
     }
+}
 
-    vkCmdEndRenderPass(commandBuffer);
+bool PLSRenderContextVulkanImpl::isOverMemoryBudget()
+{
+    if (m_contextOptions.memoryBudgetTrimThreshold <= 0)
+    {
+        return false;
+    }
+    vkutil::MemoryBudget memoryBudget = m_allocator->queryDeviceLocalMemoryBudget();
+    if (static_cast<double>(memoryBudget.usageBytes) <
+        static_cast<double>(memoryBudget.budgetBytes) * m_contextOptions.memoryBudgetTrimThreshold)
+    {
+        return false;
+    }
+    if (m_contextOptions.onMemoryBudgetExceeded)
+    {
+        m_contextOptions.onMemoryBudgetExceeded(memoryBudget);
+    }
+    return true;
+}
 
-    if (desc.isFinalFlushOfFrame)
+bool PLSRenderContextVulkanImpl::popGPUFrameTime(pls::GPUFrameTime* gpuFrameTime)
+{
+    if (m_pendingGPUTimers.empty())
     {
-        m_frameCompletionFences[m_bufferRingIdx] = ref_rcp(desc.frameCompletionFence);
+        return false;
+    }
+    const PendingGPUTimer& timer = m_pendingGPUTimers.front();
+    uint64_t timestamps[2];
+    if (vkGetQueryPoolResults(m_device,
+                              m_gpuTimerQueryPool,
+                              timer.bufferRingIdx * 2,
+                              2,
+                              sizeof(timestamps),
+                              timestamps,
+                              sizeof(uint64_t),
+                              VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+    {
+        return false; // VK_NOT_READY.
     }
+    gpuFrameTime->frameNumber = timer.frameNumber;
+    gpuFrameTime->seconds =
+        static_cast<double>(timestamps[1] - timestamps[0]) * m_capabilities.timestampPeriod * 1e-9;
+    m_pendingGPUTimers.pop_front();
+    return true;
 }
 
 std::unique_ptr<PLSRenderContext> PLSRenderContextVulkanImpl::MakeContext(
     rcp<vkutil::Allocator> allocator,
-    VulkanCapabilities capabilities)
+    VulkanCapabilities capabilities,
+    const ContextOptions& contextOptions)
 {
     std::unique_ptr<PLSRenderContextVulkanImpl> impl(
-        new PLSRenderContextVulkanImpl(std::move(allocator), capabilities));
+        new PLSRenderContextVulkanImpl(std::move(allocator), capabilities, contextOptions));
     if (!impl->platformFeatures().supportsPixelLocalStorage)
     {
         return nullptr; // TODO: implement MSAA.
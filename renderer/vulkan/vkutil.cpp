@@ -13,12 +13,19 @@ namespace rive::pls::vkutil
 Allocator::Allocator(VkInstance instance,
                      VkPhysicalDevice physicalDevice,
                      VkDevice device,
-                     uint32_t vulkanApiVersion) :
+                     uint32_t vulkanApiVersion,
+                     bool EXT_memory_budget) :
     m_device(device)
 {
+    VmaAllocatorCreateFlags flags = 0;
+    // This all runs in one thread.
+    flags |= VMA_ALLOCATOR_CREATE_EXTERNALLY_SYNCHRONIZED_BIT;
+    if (EXT_memory_budget)
+    {
+        flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+    }
     VmaAllocatorCreateInfo vmaCreateInfo = {
-        // This all runs in one thread.
-        .flags = VMA_ALLOCATOR_CREATE_EXTERNALLY_SYNCHRONIZED_BIT,
+        .flags = flags,
         .physicalDevice = physicalDevice,
         .device = m_device,
         .instance = instance,
@@ -36,14 +43,22 @@ Allocator::~Allocator()
     vmaDestroyAllocator(m_vmaAllocator);
 }
 
-rcp<Buffer> Allocator::makeBuffer(const VkBufferCreateInfo& info, Mappability mappability)
+rcp<Buffer> Allocator::makeBuffer(const VkBufferCreateInfo& info,
+                                  Mappability mappability,
+                                  MemoryCategory memoryCategory)
+{
+    return rcp(new Buffer(ref_rcp(this), info, mappability, memoryCategory));
+}
+
+rcp<Texture> Allocator::makeTexture(const VkImageCreateInfo& info, MemoryCategory memoryCategory)
 {
-    return rcp(new Buffer(ref_rcp(this), info, mappability));
+    return rcp(new Texture(ref_rcp(this), info, memoryCategory));
 }
 
-rcp<Texture> Allocator::makeTexture(const VkImageCreateInfo& info)
+rcp<Texture> Allocator::importTexture(const VkImageCreateInfo& info,
+                                      const ExternalMemoryHandle& handle)
 {
-    return rcp(new Texture(ref_rcp(this), info));
+    return rcp(new Texture(ref_rcp(this), info, handle));
 }
 
 rcp<Framebuffer> Allocator::makeFramebuffer(const VkFramebufferCreateInfo& info)
@@ -51,6 +66,52 @@ rcp<Framebuffer> Allocator::makeFramebuffer(const VkFramebufferCreateInfo& info)
     return rcp(new Framebuffer(ref_rcp(this), info));
 }
 
+MemoryBudget Allocator::queryDeviceLocalMemoryBudget()
+{
+    vmaSetCurrentFrameIndex(m_vmaAllocator, ++m_vmaFrameIndex);
+
+    const VkPhysicalDeviceMemoryProperties* memoryProperties;
+    vmaGetMemoryProperties(m_vmaAllocator, &memoryProperties);
+    VmaBudget heapBudgets[VK_MAX_MEMORY_HEAPS];
+    vmaGetHeapBudgets(m_vmaAllocator, heapBudgets);
+
+    MemoryBudget memoryBudget;
+    for (uint32_t i = 0; i < memoryProperties->memoryHeapCount; ++i)
+    {
+        if (memoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+        {
+            memoryBudget.usageBytes += heapBudgets[i].usage;
+            memoryBudget.budgetBytes += heapBudgets[i].budget;
+        }
+    }
+    return memoryBudget;
+}
+
+void Allocator::didAllocate(MemoryCategory memoryCategory,
+                            VmaAllocation vmaAllocation,
+                            bool isLazilyAllocated)
+{
+    VmaAllocationInfo allocationInfo;
+    vmaGetAllocationInfo(m_vmaAllocator, vmaAllocation, &allocationInfo);
+    uint64_t& allocatedBytes = isLazilyAllocated
+                                   ? m_lazilyAllocatedBytes
+                                   : m_allocatedBytes[static_cast<size_t>(memoryCategory)];
+    allocatedBytes += allocationInfo.size;
+}
+
+void Allocator::willFree(MemoryCategory memoryCategory,
+                         VmaAllocation vmaAllocation,
+                         bool isLazilyAllocated)
+{
+    VmaAllocationInfo allocationInfo;
+    vmaGetAllocationInfo(m_vmaAllocator, vmaAllocation, &allocationInfo);
+    uint64_t& allocatedBytes = isLazilyAllocated
+                                   ? m_lazilyAllocatedBytes
+                                   : m_allocatedBytes[static_cast<size_t>(memoryCategory)];
+    assert(allocatedBytes >= allocationInfo.size);
+    allocatedBytes -= allocationInfo.size;
+}
+
 static VkImageViewType image_view_type_for_image_type(VkImageType type)
 {
     switch (type)
@@ -104,8 +165,14 @@ void RenderingResource::onRefCntReachedZero() const
     }
 }
 
-Buffer::Buffer(rcp<Allocator> allocator, const VkBufferCreateInfo& info, Mappability mappability) :
-    RenderingResource(std::move(allocator)), m_mappability(mappability), m_info(info)
+Buffer::Buffer(rcp<Allocator> allocator,
+               const VkBufferCreateInfo& info,
+               Mappability mappability,
+               MemoryCategory memoryCategory) :
+    RenderingResource(std::move(allocator)),
+    m_mappability(mappability),
+    m_memoryCategory(memoryCategory),
+    m_info(info)
 {
     m_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     init();
@@ -119,7 +186,11 @@ void Buffer::resizeImmediately(size_t sizeInBytes)
     {
         if (m_vmaAllocation != VK_NULL_HANDLE)
         {
-            vmaUnmapMemory(m_allocator->vmaAllocator(), m_vmaAllocation);
+            if (m_contents != nullptr)
+            {
+                vmaUnmapMemory(m_allocator->vmaAllocator(), m_vmaAllocation);
+            }
+            m_allocator->willFree(m_memoryCategory, m_vmaAllocation);
             vmaDestroyBuffer(m_allocator->vmaAllocator(), m_vkBuffer, m_vmaAllocation);
         }
         m_info.size = sizeInBytes;
@@ -156,10 +227,19 @@ void Buffer::init()
                                  &m_vkBuffer,
                                  &m_vmaAllocation,
                                  nullptr));
+        m_allocator->didAllocate(m_memoryCategory, m_vmaAllocation);
 
-        // Leave the buffer constantly mapped and let the OS/drivers handle the
-        // rest.
-        VK_CHECK(vmaMapMemory(m_allocator->vmaAllocator(), m_vmaAllocation, &m_contents));
+        if (m_mappability != Mappability::none)
+        {
+            // Leave the buffer constantly mapped and let the OS/drivers handle the
+            // rest.
+            VK_CHECK(vmaMapMemory(m_allocator->vmaAllocator(), m_vmaAllocation, &m_contents));
+        }
+        else
+        {
+            // Nothing to map. (VMA may have picked memory that isn't even host-visible.)
+            m_contents = nullptr;
+        }
     }
     else
     {
@@ -176,36 +256,42 @@ void Buffer::flushMappedContents(size_t updatedSizeInBytes)
     vmaFlushAllocation(m_allocator->vmaAllocator(), m_vmaAllocation, 0, updatedSizeInBytes);
 }
 
-Texture::Texture(rcp<Allocator> allocator, const VkImageCreateInfo& info) :
-    RenderingResource(std::move(allocator)), m_info(info)
+static void set_image_create_info_defaults(VkImageCreateInfo* info)
 {
-    m_info = info;
-    m_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    info->sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
 
-    if (m_info.imageType == 0)
+    if (info->imageType == 0)
     {
-        m_info.imageType = VK_IMAGE_TYPE_2D;
+        info->imageType = VK_IMAGE_TYPE_2D;
     }
 
-    if (m_info.mipLevels == 0)
+    if (info->mipLevels == 0)
     {
-        m_info.mipLevels = 1;
+        info->mipLevels = 1;
     }
-    else if (m_info.mipLevels > 1)
+    else if (info->mipLevels > 1)
     {
         // We generate mipmaps internally with image blits.
-        m_info.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        info->usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
     }
 
-    if (m_info.arrayLayers == 0)
+    if (info->arrayLayers == 0)
     {
-        m_info.arrayLayers = 1;
+        info->arrayLayers = 1;
     }
 
-    if (m_info.samples == 0)
+    if (info->samples == 0)
     {
-        m_info.samples = VK_SAMPLE_COUNT_1_BIT;
+        info->samples = VK_SAMPLE_COUNT_1_BIT;
     }
+}
+
+Texture::Texture(rcp<Allocator> allocator,
+                 const VkImageCreateInfo& info,
+                 MemoryCategory memoryCategory) :
+    RenderingResource(std::move(allocator)), m_memoryCategory(memoryCategory), m_info(info)
+{
+    set_image_create_info_defaults(&m_info);
 
     if (m_info.usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT)
     {
@@ -222,7 +308,8 @@ Texture::Texture(rcp<Allocator> allocator, const VkImageCreateInfo& info) :
                            &m_vmaAllocation,
                            nullptr) == VK_SUCCESS)
         {
-            printf("SUCCESS AT TRANSIENT LAZY!\n");
+            m_isLazilyAllocated = true;
+            m_allocator->didAllocate(m_memoryCategory, m_vmaAllocation, m_isLazilyAllocated);
             return;
         }
     }
@@ -237,14 +324,137 @@ Texture::Texture(rcp<Allocator> allocator, const VkImageCreateInfo& info) :
                             &m_vkImage,
                             &m_vmaAllocation,
                             nullptr));
+    m_allocator->didAllocate(m_memoryCategory, m_vmaAllocation);
+}
+
+Texture::Texture(rcp<Allocator> allocator,
+                 const VkImageCreateInfo& info,
+                 const ExternalMemoryHandle& handle) :
+    RenderingResource(std::move(allocator)), m_memoryCategory(MemoryCategory::other), m_info(info)
+{
+    set_image_create_info_defaults(&m_info);
+
+    VkExternalMemoryImageCreateInfo externalMemoryImageCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO,
+        .pNext = m_info.pNext,
+        .handleTypes = static_cast<VkExternalMemoryHandleTypeFlags>(handle.handleType),
+    };
+    VkImageCreateInfo externalInfo = m_info;
+    externalInfo.pNext = &externalMemoryImageCreateInfo;
+    VK_CHECK(vkCreateImage(device(), &externalInfo, nullptr, &m_vkImage));
+
+    VkMemoryRequirements memoryRequirements;
+    vkGetImageMemoryRequirements(device(), m_vkImage, &memoryRequirements);
+    VkDeviceSize allocationSize = memoryRequirements.size;
+    uint32_t memoryTypeBits = memoryRequirements.memoryTypeBits;
+
+    // Imported memory is always bound to exactly one image.
+    VkMemoryDedicatedAllocateInfo dedicatedAllocateInfo = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+        .image = m_vkImage,
+    };
+
+    VkImportMemoryFdInfoKHR importMemoryFdInfo;
+#ifdef VK_USE_PLATFORM_ANDROID_KHR
+    VkImportAndroidHardwareBufferInfoANDROID importHardwareBufferInfo;
+    if (handle.handleType == VK_EXTERNAL_MEMORY_HANDLE_TYPE_ANDROID_HARDWARE_BUFFER_BIT_ANDROID)
+    {
+        assert(handle.hardwareBuffer != nullptr);
+        auto vkGetAndroidHardwareBufferPropertiesANDROID =
+            reinterpret_cast<PFN_vkGetAndroidHardwareBufferPropertiesANDROID>(
+                vkGetDeviceProcAddr(device(), "vkGetAndroidHardwareBufferPropertiesANDROID"));
+        assert(vkGetAndroidHardwareBufferPropertiesANDROID != nullptr);
+        VkAndroidHardwareBufferPropertiesANDROID hardwareBufferProperties = {
+            .sType = VK_STRUCTURE_TYPE_ANDROID_HARDWARE_BUFFER_PROPERTIES_ANDROID,
+        };
+        VK_CHECK(vkGetAndroidHardwareBufferPropertiesANDROID(device(),
+                                                             handle.hardwareBuffer,
+                                                             &hardwareBufferProperties));
+        // The hardware buffer's own size takes precedence over the image's requirements.
+        allocationSize = hardwareBufferProperties.allocationSize;
+        memoryTypeBits &= hardwareBufferProperties.memoryTypeBits;
+
+        importHardwareBufferInfo = {
+            .sType = VK_STRUCTURE_TYPE_IMPORT_ANDROID_HARDWARE_BUFFER_INFO_ANDROID,
+            .buffer = handle.hardwareBuffer,
+        };
+        dedicatedAllocateInfo.pNext = &importHardwareBufferInfo;
+    }
+    else
+#endif
+    {
+        assert(handle.handleType == VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT ||
+               handle.handleType == VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT);
+        assert(handle.fd >= 0);
+        // Opaque fds can only come from this same driver, so they don't need a compatibility
+        // query (and aren't allowed one).
+        if (handle.handleType != VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT)
+        {
+            auto vkGetMemoryFdPropertiesKHR = reinterpret_cast<PFN_vkGetMemoryFdPropertiesKHR>(
+                vkGetDeviceProcAddr(device(), "vkGetMemoryFdPropertiesKHR"));
+            assert(vkGetMemoryFdPropertiesKHR != nullptr);
+            VkMemoryFdPropertiesKHR memoryFdProperties = {
+                .sType = VK_STRUCTURE_TYPE_MEMORY_FD_PROPERTIES_KHR,
+            };
+            VK_CHECK(vkGetMemoryFdPropertiesKHR(device(),
+                                                handle.handleType,
+                                                handle.fd,
+                                                &memoryFdProperties));
+            memoryTypeBits &= memoryFdProperties.memoryTypeBits;
+        }
+
+        importMemoryFdInfo = {
+            .sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_FD_INFO_KHR,
+            .handleType = handle.handleType,
+            .fd = handle.fd,
+        };
+        dedicatedAllocateInfo.pNext = &importMemoryFdInfo;
+    }
+
+    // Prefer device-local memory types, but take whatever the external buffer is compatible with.
+    assert(memoryTypeBits != 0);
+    const VkPhysicalDeviceMemoryProperties* memoryProperties;
+    vmaGetMemoryProperties(m_allocator->vmaAllocator(), &memoryProperties);
+    uint32_t memoryTypeIndex = ~0u;
+    for (uint32_t i = 0; i < memoryProperties->memoryTypeCount; ++i)
+    {
+        if (!(memoryTypeBits & (1u << i)))
+        {
+            continue;
+        }
+        if (memoryTypeIndex == ~0u ||
+            (memoryProperties->memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))
+        {
+            memoryTypeIndex = i;
+        }
+        if (memoryProperties->memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+        {
+            break;
+        }
+    }
+
+    VkMemoryAllocateInfo memoryAllocateInfo = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .pNext = &dedicatedAllocateInfo,
+        .allocationSize = allocationSize,
+        .memoryTypeIndex = memoryTypeIndex,
+    };
+    VK_CHECK(vkAllocateMemory(device(), &memoryAllocateInfo, nullptr, &m_importedMemory));
+    VK_CHECK(vkBindImageMemory(device(), m_vkImage, m_importedMemory, 0));
 }
 
 Texture::~Texture()
 {
     if (m_vmaAllocation != VK_NULL_HANDLE)
     {
+        m_allocator->willFree(m_memoryCategory, m_vmaAllocation, m_isLazilyAllocated);
         vmaDestroyImage(m_allocator->vmaAllocator(), m_vkImage, m_vmaAllocation);
     }
+    else if (m_importedMemory != VK_NULL_HANDLE)
+    {
+        vkDestroyImage(device(), m_vkImage, nullptr);
+        vkFreeMemory(device(), m_importedMemory, nullptr);
+    }
 }
 
 TextureView::TextureView(rcp<Allocator> allocator,
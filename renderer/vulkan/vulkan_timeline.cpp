@@ -0,0 +1,51 @@
+/*
+ * Copyright 2024 Rive
+ */
+
+#include "rive/pls/vulkan/vulkan_timeline.hpp"
+
+#include "rive/pls/vulkan/vkutil.hpp"
+
+namespace rive::pls
+{
+void VulkanTimelineFence::wait() { m_timeline->wait(m_value); }
+
+VulkanTimeline::VulkanTimeline(VkDevice device) : m_device(device)
+{
+    VkSemaphoreTypeCreateInfo semaphoreTypeInfo = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+        .initialValue = 0,
+    };
+    VkSemaphoreCreateInfo semaphoreInfo = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &semaphoreTypeInfo,
+    };
+    VK_CHECK(vkCreateSemaphore(m_device, &semaphoreInfo, nullptr, &m_vkSemaphore));
+}
+
+VulkanTimeline::~VulkanTimeline() { vkDestroySemaphore(m_device, m_vkSemaphore, nullptr); }
+
+rcp<VulkanTimelineFence> VulkanTimeline::makeFence()
+{
+    return make_rcp<VulkanTimelineFence>(ref_rcp(this), ++m_lastReservedValue);
+}
+
+uint64_t VulkanTimeline::completedValue() const
+{
+    uint64_t value;
+    VK_CHECK(vkGetSemaphoreCounterValue(m_device, m_vkSemaphore, &value));
+    return value;
+}
+
+void VulkanTimeline::wait(uint64_t value) const
+{
+    VkSemaphoreWaitInfo waitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+        .semaphoreCount = 1,
+        .pSemaphores = &m_vkSemaphore,
+        .pValues = &value,
+    };
+    VK_CHECK(vkWaitSemaphores(m_device, &waitInfo, UINT64_MAX));
+}
+} // namespace rive::pls
@@ -28,6 +28,7 @@
 #include "generated/shaders/draw_path_common.glsl.hpp"
 #include "generated/shaders/draw_image_mesh.glsl.hpp"
 
+#include <algorithm>
 #include <sstream>
 #include <string>
 
@@ -760,6 +761,7 @@ PLSRenderContextWebGPUImpl::PLSRenderContextWebGPUImpl(
     m_colorRampPipeline(std::make_unique<ColorRampPipeline>(m_device)),
     m_tessellatePipeline(std::make_unique<TessellatePipeline>(m_device, m_contextOptions))
 {
+    setBufferRingSize(m_contextOptions.bufferRingSize);
     m_platformFeatures = baselinePlatformFeatures;
     m_platformFeatures.invertOffscreenY = true;
 
@@ -816,6 +818,7 @@ void PLSRenderContextWebGPUImpl::initGPUObjects()
                 .buffer =
                     {
                         .type = wgpu::BufferBindingType::ReadOnlyStorage,
+                        .hasDynamicOffset = true,
                     },
             },
         m_contextOptions.disableStorageBuffers ?
@@ -834,6 +837,7 @@ void PLSRenderContextWebGPUImpl::initGPUObjects()
                 .buffer =
                     {
                         .type = wgpu::BufferBindingType::ReadOnlyStorage,
+                        .hasDynamicOffset = true,
                     },
             },
         m_contextOptions.disableStorageBuffers ?
@@ -852,6 +856,7 @@ void PLSRenderContextWebGPUImpl::initGPUObjects()
                 .buffer =
                     {
                         .type = wgpu::BufferBindingType::ReadOnlyStorage,
+                        .hasDynamicOffset = true,
                     },
             },
         m_contextOptions.disableStorageBuffers ?
@@ -870,6 +875,7 @@ void PLSRenderContextWebGPUImpl::initGPUObjects()
                 .buffer =
                     {
                         .type = wgpu::BufferBindingType::ReadOnlyStorage,
+                        .hasDynamicOffset = true,
                     },
             },
         {
@@ -878,6 +884,8 @@ void PLSRenderContextWebGPUImpl::initGPUObjects()
             .buffer =
                 {
                     .type = wgpu::BufferBindingType::Uniform,
+                    .hasDynamicOffset = true,
+                    .minBindingSize = sizeof(pls::FlushUniforms),
                 },
         },
         {
@@ -1108,6 +1116,32 @@ rcp<PLSRenderTargetWebGPU> PLSRenderContextWebGPUImpl::makeRenderTarget(
                                          wgpu::TextureUsage::None));
 }
 
+rcp<PLSRenderTarget> PLSRenderContextWebGPUImpl::makeLayerRenderTarget(
+    uint32_t width,
+    uint32_t height,
+    rcp<PLSTexture>* layerTexture)
+{
+    if (m_contextOptions.plsType == PixelLocalStorageType::subpassLoad)
+    {
+        // The target would also need to be a Vulkan input attachment.
+        return nullptr;
+    }
+
+    wgpu::TextureDescriptor desc = {
+        .usage = wgpu::TextureUsage::RenderAttachment | wgpu::TextureUsage::TextureBinding,
+        .dimension = wgpu::TextureDimension::e2D,
+        .size = {width, height},
+        .format = wgpu::TextureFormat::RGBA8Unorm,
+    };
+    wgpu::Texture texture = m_device.CreateTexture(&desc);
+
+    rcp<PLSRenderTargetWebGPU> renderTarget =
+        makeRenderTarget(wgpu::TextureFormat::RGBA8Unorm, width, height);
+    renderTarget->setTargetTextureView(texture.CreateView());
+    *layerTexture = make_rcp<PLSTextureWebGPUImpl>(std::move(texture), width, height);
+    return ref_rcp<PLSRenderTarget>(renderTarget.get());
+}
+
 class RenderBufferWebGPUImpl : public RenderBuffer
 {
 public:
@@ -1115,13 +1149,14 @@ public:
                            wgpu::Queue queue,
                            RenderBufferType renderBufferType,
                            RenderBufferFlags renderBufferFlags,
-                           size_t sizeInBytes) :
+                           size_t sizeInBytes,
+                           int bufferRingSize) :
         RenderBuffer(renderBufferType, renderBufferFlags, sizeInBytes),
         m_device(device),
         m_queue(queue)
     {
         bool mappedOnceAtInitialization = flags() & RenderBufferFlags::mappedOnceAtInitialization;
-        int bufferCount = mappedOnceAtInitialization ? 1 : pls::kBufferRingSize;
+        m_bufferCount = mappedOnceAtInitialization ? 1 : bufferRingSize;
         wgpu::BufferDescriptor desc = {
             .usage = type() == RenderBufferType::index ? wgpu::BufferUsage::Index
                                                        : wgpu::BufferUsage::Vertex,
@@ -1133,7 +1168,7 @@ public:
         {
             desc.usage |= wgpu::BufferUsage::CopyDst;
         }
-        for (int i = 0; i < bufferCount; ++i)
+        for (int i = 0; i < m_bufferCount; ++i)
         {
             m_buffers[i] = device.CreateBuffer(&desc);
         }
@@ -1144,7 +1179,7 @@ public:
 protected:
     void* onMap() override
     {
-        m_submittedBufferIdx = (m_submittedBufferIdx + 1) % pls::kBufferRingSize;
+        m_submittedBufferIdx = (m_submittedBufferIdx + 1) % m_bufferCount;
         assert(m_buffers[m_submittedBufferIdx] != nullptr);
         if (flags() & RenderBufferFlags::mappedOnceAtInitialization)
         {
@@ -1178,7 +1213,8 @@ protected:
 private:
     const wgpu::Device m_device;
     const wgpu::Queue m_queue;
-    wgpu::Buffer m_buffers[pls::kBufferRingSize];
+    int m_bufferCount;
+    wgpu::Buffer m_buffers[pls::kMaxBufferRingSize];
     int m_submittedBufferIdx = -1;
     std::unique_ptr<uint8_t[]> m_stagingBuffer;
 };
@@ -1187,7 +1223,12 @@ rcp<RenderBuffer> PLSRenderContextWebGPUImpl::makeRenderBuffer(RenderBufferType
                                                                RenderBufferFlags flags,
                                                                size_t sizeInBytes)
 {
-    return make_rcp<RenderBufferWebGPUImpl>(m_device, m_queue, type, flags, sizeInBytes);
+    return make_rcp<RenderBufferWebGPUImpl>(m_device,
+                                            m_queue,
+                                            type,
+                                            flags,
+                                            sizeInBytes,
+                                            bufferRingSize());
 }
 
 class PLSTextureWebGPUImpl : public PLSTexture
@@ -1224,6 +1265,13 @@ public:
                       height * width * 4);
     }
 
+    // Wraps a texture that was rendered on the GPU (e.g., an offscreen layer).
+    PLSTextureWebGPUImpl(wgpu::Texture texture, uint32_t width, uint32_t height) :
+        PLSTexture(width, height), m_texture(std::move(texture))
+    {
+        m_textureView = m_texture.CreateView();
+    }
+
     wgpu::TextureView textureView() const { return m_textureView; }
 
 private:
@@ -1250,22 +1298,24 @@ public:
     static std::unique_ptr<BufferWebGPU> Make(wgpu::Device device,
                                               wgpu::Queue queue,
                                               size_t capacityInBytes,
-                                              wgpu::BufferUsage usage)
+                                              wgpu::BufferUsage usage,
+                                              int ringSize)
     {
-        return std::make_unique<BufferWebGPU>(device, queue, capacityInBytes, usage);
+        return std::make_unique<BufferWebGPU>(device, queue, capacityInBytes, usage, ringSize);
     }
 
     BufferWebGPU(wgpu::Device device,
                  wgpu::Queue queue,
                  size_t capacityInBytes,
-                 wgpu::BufferUsage usage) :
-        BufferRing(std::max<size_t>(capacityInBytes, 1)), m_queue(queue)
+                 wgpu::BufferUsage usage,
+                 int ringSize) :
+        BufferRing(std::max<size_t>(capacityInBytes, 1), ringSize), m_queue(queue)
     {
         wgpu::BufferDescriptor desc = {
             .usage = wgpu::BufferUsage::CopyDst | usage,
             .size = capacityInBytes,
         };
-        for (int i = 0; i < pls::kBufferRingSize; ++i)
+        for (int i = 0; i < ringSize; ++i)
         {
             m_buffers[i] = device.CreateBuffer(&desc);
         }
@@ -1282,7 +1332,7 @@ protected:
     }
 
     const wgpu::Queue m_queue;
-    wgpu::Buffer m_buffers[kBufferRingSize];
+    wgpu::Buffer m_buffers[kMaxBufferRingSize];
 };
 
 // GL TextureFormat to use for a texture that polyfills a storage buffer.
@@ -1307,11 +1357,13 @@ public:
     StorageTextureBufferWebGPU(wgpu::Device device,
                                wgpu::Queue queue,
                                size_t capacityInBytes,
-                               pls::StorageBufferStructure bufferStructure) :
+                               pls::StorageBufferStructure bufferStructure,
+                               int ringSize) :
         BufferWebGPU(device,
                      queue,
                      pls::StorageTextureBufferSize(capacityInBytes, bufferStructure),
-                     wgpu::BufferUsage::CopySrc),
+                     wgpu::BufferUsage::CopySrc,
+                     ringSize),
         m_bufferStructure(bufferStructure)
     {
         // Create a texture to mirror the buffer contents.
@@ -1371,7 +1423,8 @@ std::unique_ptr<BufferRing> PLSRenderContextWebGPUImpl::makeUniformBufferRing(
     return std::make_unique<BufferWebGPU>(m_device,
                                           m_queue,
                                           capacityInBytes,
-                                          wgpu::BufferUsage::Uniform);
+                                          wgpu::BufferUsage::Uniform,
+                                          bufferRingSize());
 }
 
 std::unique_ptr<BufferRing> PLSRenderContextWebGPUImpl::makeStorageBufferRing(
@@ -1383,14 +1436,16 @@ std::unique_ptr<BufferRing> PLSRenderContextWebGPUImpl::makeStorageBufferRing(
         return std::make_unique<StorageTextureBufferWebGPU>(m_device,
                                                             m_queue,
                                                             capacityInBytes,
-                                                            bufferStructure);
+                                                            bufferStructure,
+                                                            bufferRingSize());
     }
     else
     {
         return std::make_unique<BufferWebGPU>(m_device,
                                               m_queue,
                                               capacityInBytes,
-                                              wgpu::BufferUsage::Storage);
+                                              wgpu::BufferUsage::Storage,
+                                              bufferRingSize());
     }
 }
 
@@ -1399,7 +1454,8 @@ std::unique_ptr<BufferRing> PLSRenderContextWebGPUImpl::makeVertexBufferRing(siz
     return std::make_unique<BufferWebGPU>(m_device,
                                           m_queue,
                                           capacityInBytes,
-                                          wgpu::BufferUsage::Vertex);
+                                          wgpu::BufferUsage::Vertex,
+                                          bufferRingSize());
 }
 
 std::unique_ptr<BufferRing> PLSRenderContextWebGPUImpl::makeTextureTransferBufferRing(
@@ -1408,7 +1464,8 @@ std::unique_ptr<BufferRing> PLSRenderContextWebGPUImpl::makeTextureTransferBuffe
     return std::make_unique<BufferWebGPU>(m_device,
                                           m_queue,
                                           capacityInBytes,
-                                          wgpu::BufferUsage::CopySrc);
+                                          wgpu::BufferUsage::CopySrc,
+                                          bufferRingSize());
 }
 
 void PLSRenderContextWebGPUImpl::resizeGradientTexture(uint32_t width, uint32_t height)
@@ -1655,6 +1712,351 @@ wgpu::TextureView webgpu_storage_texture_view(const BufferRing* bufferRing)
     return static_cast<const StorageTextureBufferWebGPU*>(bufferRing)->textureView();
 }
 
+void PLSRenderContextWebGPUImpl::precompileShaders(Span<const pls::ShaderVariant> variants)
+{
+    for (const pls::ShaderVariant& variant : variants)
+    {
+        // WebGPU only draws in rasterOrdering mode.
+        if (variant.interlockMode != pls::InterlockMode::rasterOrdering ||
+            (variant.drawType != DrawType::midpointFanPatches &&
+             variant.drawType != DrawType::outerCurvePatches &&
+             variant.drawType != DrawType::interiorTriangulation &&
+             variant.drawType != DrawType::imageMesh))
+        {
+            continue;
+        }
+        m_drawPipelines.try_emplace(pls::ShaderUniqueKey(variant.drawType,
+                                                         variant.shaderFeatures,
+                                                         pls::InterlockMode::rasterOrdering,
+                                                         pls::ShaderMiscFlags::none),
+                                    this,
+                                    variant.drawType,
+                                    variant.shaderFeatures,
+                                    m_contextOptions);
+    }
+}
+
+// Storage bindings cover exactly "count" elements, rounded up to one so they're never empty.
+template <typename T> static uint64_t storage_binding_size(size_t count)
+{
+    return std::max<size_t>(count, 1) * sizeof(T);
+}
+
+wgpu::BindGroup PLSRenderContextWebGPUImpl::findOrCreatePerFlushBindGroup(
+    const FlushDescriptor& desc)
+{
+    // Offsets are all dynamic, so the same bind group serves every flush that binds the same
+    // buffers with the same sizes (e.g., each frame of a looping animation in a given ring slot).
+    auto handle = [](const auto& object) {
+        return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(object.Get()));
+    };
+    std::array<uint64_t, 8> key = {
+        handle(m_tessVertexTextureView),
+        handle(m_gradientTextureView),
+        handle(webgpu_buffer(pathBufferRing())),
+        handle(webgpu_buffer(paintBufferRing())),
+        handle(webgpu_buffer(paintAuxBufferRing())),
+        handle(webgpu_buffer(contourBufferRing())),
+        handle(webgpu_buffer(flushUniformBufferRing())),
+        handle(webgpu_buffer(imageDrawUniformBufferRing())),
+    };
+    // The storage-texture polyfill always binds its whole texture.
+    size_t pathCount = m_contextOptions.disableStorageBuffers ? 0 : desc.pathCount;
+    size_t contourCount = m_contextOptions.disableStorageBuffers ? 0 : desc.contourCount;
+
+    auto it = std::find_if(m_perFlushBindGroups.begin(),
+                           m_perFlushBindGroups.end(),
+                           [&](const CachedPerFlushBindGroup& cached) {
+                               return cached.key == key && cached.pathCount == pathCount &&
+                                      cached.contourCount == contourCount;
+                           });
+    if (it != m_perFlushBindGroups.end())
+    {
+        std::rotate(m_perFlushBindGroups.begin(), it, it + 1);
+        return m_perFlushBindGroups.front().bindGroup;
+    }
+
+    wgpu::BindGroupEntry perFlushBindingEntries[] = {
+        {
+            .binding = TESS_VERTEX_TEXTURE_IDX,
+            .textureView = m_tessVertexTextureView,
+        },
+        {
+            .binding = GRAD_TEXTURE_IDX,
+            .textureView = m_gradientTextureView,
+        },
+        m_contextOptions.disableStorageBuffers ?
+            wgpu::BindGroupEntry{
+                .binding = PATH_BUFFER_IDX,
+                .textureView = webgpu_storage_texture_view(pathBufferRing())
+            } :
+            wgpu::BindGroupEntry{
+                .binding = PATH_BUFFER_IDX,
+                .buffer = webgpu_buffer(pathBufferRing()),
+                .size = storage_binding_size<pls::PathData>(pathCount),
+            },
+        m_contextOptions.disableStorageBuffers ?
+            wgpu::BindGroupEntry{
+                .binding = PAINT_BUFFER_IDX,
+                .textureView = webgpu_storage_texture_view(paintBufferRing()),
+            } :
+            wgpu::BindGroupEntry{
+                .binding = PAINT_BUFFER_IDX,
+                .buffer = webgpu_buffer(paintBufferRing()),
+                .size = storage_binding_size<pls::PaintData>(pathCount),
+            },
+        m_contextOptions.disableStorageBuffers ?
+            wgpu::BindGroupEntry{
+                .binding = PAINT_AUX_BUFFER_IDX,
+                .textureView = webgpu_storage_texture_view(paintAuxBufferRing()),
+            } :
+            wgpu::BindGroupEntry{
+                .binding = PAINT_AUX_BUFFER_IDX,
+                .buffer = webgpu_buffer(paintAuxBufferRing()),
+                .size = storage_binding_size<pls::PaintAuxData>(pathCount),
+            },
+        m_contextOptions.disableStorageBuffers ?
+            wgpu::BindGroupEntry{
+                .binding = CONTOUR_BUFFER_IDX,
+                .textureView = webgpu_storage_texture_view(contourBufferRing()),
+            } :
+            wgpu::BindGroupEntry{
+                .binding = CONTOUR_BUFFER_IDX,
+                .buffer = webgpu_buffer(contourBufferRing()),
+                .size = storage_binding_size<pls::ContourData>(contourCount),
+            },
+        {
+            .binding = FLUSH_UNIFORM_BUFFER_IDX,
+            .buffer = webgpu_buffer(flushUniformBufferRing()),
+            .size = sizeof(pls::FlushUniforms),
+        },
+        {
+            .binding = IMAGE_DRAW_UNIFORM_BUFFER_IDX,
+            .buffer = webgpu_buffer(imageDrawUniformBufferRing()),
+            .size = sizeof(pls::ImageDrawUniforms),
+        },
+    };
+
+    wgpu::BindGroupDescriptor perFlushBindGroupDesc = {
+        .layout = m_drawBindGroupLayouts[PER_FLUSH_BINDINGS_SET],
+        .entryCount = std::size(perFlushBindingEntries),
+        .entries = perFlushBindingEntries,
+    };
+
+    if (m_perFlushBindGroups.size() >= kMaxCachedPerFlushBindGroups)
+    {
+        m_perFlushBindGroups.pop_back();
+    }
+    m_perFlushBindGroups.insert(m_perFlushBindGroups.begin(),
+                                {key,
+                                 pathCount,
+                                 contourCount,
+                                 m_device.CreateBindGroup(&perFlushBindGroupDesc)});
+    return m_perFlushBindGroups.front().bindGroup;
+}
+
+template <typename DrawEncoder>
+void PLSRenderContextWebGPUImpl::encodeDrawList(DrawEncoder drawEncoder,
+                                                const FlushDescriptor& desc,
+                                                wgpu::TextureFormat framebufferFormat)
+{
+    drawEncoder.SetBindGroup(SAMPLER_BINDINGS_SET, m_samplerBindings);
+
+    wgpu::BindGroup perFlushBindings = findOrCreatePerFlushBindGroup(desc);
+
+    // Dynamic offsets, in binding order. The image draw offset goes last and changes per batch.
+    uint32_t perFlushOffsets[6];
+    uint32_t perFlushOffsetCount = 0;
+    if (!m_contextOptions.disableStorageBuffers)
+    {
+        perFlushOffsets[perFlushOffsetCount++] =
+            static_cast<uint32_t>(desc.firstPath * sizeof(pls::PathData));
+        perFlushOffsets[perFlushOffsetCount++] =
+            static_cast<uint32_t>(desc.firstPaint * sizeof(pls::PaintData));
+        perFlushOffsets[perFlushOffsetCount++] =
+            static_cast<uint32_t>(desc.firstPaintAux * sizeof(pls::PaintAuxData));
+        perFlushOffsets[perFlushOffsetCount++] =
+            static_cast<uint32_t>(desc.firstContour * sizeof(pls::ContourData));
+    }
+    perFlushOffsets[perFlushOffsetCount++] =
+        static_cast<uint32_t>(desc.flushUniformDataOffsetInBytes);
+    uint32_t& imageDrawOffset = perFlushOffsets[perFlushOffsetCount++];
+
+    // Execute the DrawList.
+    bool needsNewBindings = true;
+    for (const DrawBatch& batch : *desc.drawList)
+    {
+        if (batch.elementCount == 0)
+        {
+            continue;
+        }
+
+        DrawType drawType = batch.drawType;
+
+        // Bind the appropriate image texture, if any.
+        wgpu::TextureView imageTextureView = m_nullImagePaintTextureView;
+        if (auto imageTexture = static_cast<const PLSTextureWebGPUImpl*>(batch.imageTexture))
+        {
+            imageTextureView = imageTexture->textureView();
+            needsNewBindings = true;
+        }
+
+        if (needsNewBindings ||
+            // Image draws always re-bind because they update the dynamic offset to their uniforms.
+            drawType == DrawType::imageRect || drawType == DrawType::imageMesh)
+        {
+            imageDrawOffset = batch.imageDrawDataOffset;
+            drawEncoder.SetBindGroup(PER_FLUSH_BINDINGS_SET,
+                                     perFlushBindings,
+                                     perFlushOffsetCount,
+                                     perFlushOffsets);
+
+            wgpu::BindGroupEntry perDrawBindingEntries[] = {
+                {
+                    .binding = IMAGE_TEXTURE_IDX,
+                    .textureView = imageTextureView,
+                },
+            };
+
+            wgpu::BindGroupDescriptor perDrawBindGroupDesc = {
+                .layout = m_drawBindGroupLayouts[PER_DRAW_BINDINGS_SET],
+                .entryCount = std::size(perDrawBindingEntries),
+                .entries = perDrawBindingEntries,
+            };
+
+            wgpu::BindGroup perDrawBindings = m_device.CreateBindGroup(&perDrawBindGroupDesc);
+            drawEncoder.SetBindGroup(PER_DRAW_BINDINGS_SET, perDrawBindings, 0, nullptr);
+        }
+
+        // Setup the pipeline for this specific drawType and shaderFeatures.
+        const DrawPipeline& drawPipeline =
+            m_drawPipelines
+                .try_emplace(pls::ShaderUniqueKey(drawType,
+                                                  batch.shaderFeatures,
+                                                  pls::InterlockMode::rasterOrdering,
+                                                  pls::ShaderMiscFlags::none),
+                             this,
+                             drawType,
+                             batch.shaderFeatures,
+                             m_contextOptions)
+                .first->second;
+        drawEncoder.SetPipeline(drawPipeline.renderPipeline(framebufferFormat));
+
+        switch (drawType)
+        {
+            case DrawType::midpointFanPatches:
+            case DrawType::outerCurvePatches:
+            {
+                // Draw PLS patches that connect the tessellation vertices.
+                drawEncoder.SetVertexBuffer(0, m_pathPatchVertexBuffer);
+                drawEncoder.SetIndexBuffer(m_pathPatchIndexBuffer, wgpu::IndexFormat::Uint16);
+                drawEncoder.DrawIndexed(pls::PatchIndexCount(drawType),
+                                     batch.elementCount,
+                                     pls::PatchBaseIndex(drawType),
+                                     0,
+                                     batch.baseElement);
+                break;
+            }
+            case DrawType::interiorTriangulation:
+            {
+                drawEncoder.SetVertexBuffer(0, webgpu_buffer(triangleBufferRing()));
+                drawEncoder.Draw(batch.elementCount, 1, batch.baseElement);
+                break;
+            }
+            case DrawType::imageRect:
+                RIVE_UNREACHABLE();
+            case DrawType::imageMesh:
+            {
+                auto vertexBuffer = static_cast<const RenderBufferWebGPUImpl*>(batch.vertexBuffer);
+                auto uvBuffer = static_cast<const RenderBufferWebGPUImpl*>(batch.uvBuffer);
+                auto indexBuffer = static_cast<const RenderBufferWebGPUImpl*>(batch.indexBuffer);
+                drawEncoder.SetVertexBuffer(0, vertexBuffer->submittedBuffer());
+                drawEncoder.SetVertexBuffer(1, uvBuffer->submittedBuffer());
+                drawEncoder.SetIndexBuffer(indexBuffer->submittedBuffer(),
+                                           wgpu::IndexFormat::Uint16);
+                drawEncoder.DrawIndexed(batch.elementCount, 1, batch.baseElement);
+                break;
+            }
+            case DrawType::plsAtomicInitialize:
+            case DrawType::plsAtomicResolve:
+            case DrawType::stencilClipReset:
+                RIVE_UNREACHABLE();
+        }
+    }
+
+}
+
+void PLSRenderContextWebGPUImpl::buildDrawBundleKey(const FlushDescriptor& desc,
+                                                    wgpu::TextureFormat framebufferFormat)
+{
+    auto handle = [](const auto& object) {
+        return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(object.Get()));
+    };
+
+    m_drawBundleKey.clear();
+    m_drawBundleKey.push_back(static_cast<uint64_t>(framebufferFormat));
+    m_drawBundleKey.push_back(handle(m_tessVertexTextureView));
+    m_drawBundleKey.push_back(handle(m_gradientTextureView));
+    if (m_contextOptions.disableStorageBuffers)
+    {
+        m_drawBundleKey.push_back(handle(webgpu_storage_texture_view(pathBufferRing())));
+        m_drawBundleKey.push_back(handle(webgpu_storage_texture_view(paintBufferRing())));
+        m_drawBundleKey.push_back(handle(webgpu_storage_texture_view(paintAuxBufferRing())));
+        m_drawBundleKey.push_back(handle(webgpu_storage_texture_view(contourBufferRing())));
+    }
+    else
+    {
+        m_drawBundleKey.push_back(handle(webgpu_buffer(pathBufferRing())));
+        m_drawBundleKey.push_back(desc.firstPath);
+        m_drawBundleKey.push_back(handle(webgpu_buffer(paintBufferRing())));
+        m_drawBundleKey.push_back(desc.firstPaint);
+        m_drawBundleKey.push_back(handle(webgpu_buffer(paintAuxBufferRing())));
+        m_drawBundleKey.push_back(desc.firstPaintAux);
+        m_drawBundleKey.push_back(handle(webgpu_buffer(contourBufferRing())));
+        m_drawBundleKey.push_back(desc.firstContour);
+    }
+    m_drawBundleKey.push_back(handle(webgpu_buffer(flushUniformBufferRing())));
+    m_drawBundleKey.push_back(desc.flushUniformDataOffsetInBytes);
+    m_drawBundleKey.push_back(handle(webgpu_buffer(imageDrawUniformBufferRing())));
+    m_drawBundleKey.push_back(desc.pathCount);
+    m_drawBundleKey.push_back(desc.contourCount);
+
+    for (const DrawBatch& batch : *desc.drawList)
+    {
+        if (batch.elementCount == 0)
+        {
+            continue;
+        }
+        m_drawBundleKey.push_back(static_cast<uint64_t>(batch.drawType));
+        m_drawBundleKey.push_back(static_cast<uint64_t>(batch.shaderFeatures));
+        m_drawBundleKey.push_back(batch.elementCount);
+        m_drawBundleKey.push_back(batch.baseElement);
+        m_drawBundleKey.push_back(batch.imageDrawDataOffset);
+        auto imageTexture = static_cast<const PLSTextureWebGPUImpl*>(batch.imageTexture);
+        m_drawBundleKey.push_back(imageTexture != nullptr ? handle(imageTexture->textureView())
+                                                          : 0);
+        switch (batch.drawType)
+        {
+            case DrawType::interiorTriangulation:
+                m_drawBundleKey.push_back(handle(webgpu_buffer(triangleBufferRing())));
+                break;
+            case DrawType::imageMesh:
+                m_drawBundleKey.push_back(handle(
+                    static_cast<const RenderBufferWebGPUImpl*>(batch.vertexBuffer)
+                        ->submittedBuffer()));
+                m_drawBundleKey.push_back(handle(
+                    static_cast<const RenderBufferWebGPUImpl*>(batch.uvBuffer)
+                        ->submittedBuffer()));
+                m_drawBundleKey.push_back(handle(
+                    static_cast<const RenderBufferWebGPUImpl*>(batch.indexBuffer)
+                        ->submittedBuffer()));
+                break;
+            default:
+                break;
+        }
+    }
+}
+
 void PLSRenderContextWebGPUImpl::flush(const FlushDescriptor& desc)
 {
     auto* renderTarget = static_cast<const PLSRenderTargetWebGPU*>(desc.renderTarget);
@@ -1708,7 +2110,8 @@ void PLSRenderContextWebGPUImpl::flush(const FlushDescriptor& desc)
 
         wgpu::RenderPassColorAttachment attachment = {
             .view = m_gradientTextureView,
-            .loadOp = wgpu::LoadOp::Clear,
+            // Load the existing contents so the rest of the gradient atlas survives this pass.
+            .loadOp = wgpu::LoadOp::Load,
             .storeOp = wgpu::StoreOp::Store,
             .clearValue = {},
         };
@@ -1914,175 +2317,50 @@ void PLSRenderContextWebGPUImpl::flush(const FlushDescriptor& desc)
         drawPass.Draw(4);
     }
 
-    drawPass.SetBindGroup(SAMPLER_BINDINGS_SET, m_samplerBindings);
-
-    wgpu::BindGroupEntry perFlushBindingEntries[] = {
-        {
-            .binding = TESS_VERTEX_TEXTURE_IDX,
-            .textureView = m_tessVertexTextureView,
-        },
-        {
-            .binding = GRAD_TEXTURE_IDX,
-            .textureView = m_gradientTextureView,
-        },
-        m_contextOptions.disableStorageBuffers ?
-            wgpu::BindGroupEntry{
-                .binding = PATH_BUFFER_IDX,
-                .textureView = webgpu_storage_texture_view(pathBufferRing())
-            } :
-            wgpu::BindGroupEntry{
-                .binding = PATH_BUFFER_IDX,
-                .buffer = webgpu_buffer(pathBufferRing()),
-                .offset = desc.firstPath * sizeof(pls::PathData),
-            },
-        m_contextOptions.disableStorageBuffers ?
-            wgpu::BindGroupEntry{
-                .binding = PAINT_BUFFER_IDX,
-                .textureView = webgpu_storage_texture_view(paintBufferRing()),
-            } :
-            wgpu::BindGroupEntry{
-                .binding = PAINT_BUFFER_IDX,
-                .buffer = webgpu_buffer(paintBufferRing()),
-                .offset = desc.firstPaint * sizeof(pls::PaintData),
-            },
-        m_contextOptions.disableStorageBuffers ?
-            wgpu::BindGroupEntry{
-                .binding = PAINT_AUX_BUFFER_IDX,
-                .textureView = webgpu_storage_texture_view(paintAuxBufferRing()),
-            } :
-            wgpu::BindGroupEntry{
-                .binding = PAINT_AUX_BUFFER_IDX,
-                .buffer = webgpu_buffer(paintAuxBufferRing()),
-                .offset = desc.firstPaintAux * sizeof(pls::PaintAuxData),
-            },
-        m_contextOptions.disableStorageBuffers ?
-            wgpu::BindGroupEntry{
-                .binding = CONTOUR_BUFFER_IDX,
-                .textureView = webgpu_storage_texture_view(contourBufferRing()),
-            } :
-            wgpu::BindGroupEntry{
-                .binding = CONTOUR_BUFFER_IDX,
-                .buffer = webgpu_buffer(contourBufferRing()),
-                .offset = desc.firstContour * sizeof(pls::ContourData),
-            },
-        {
-            .binding = FLUSH_UNIFORM_BUFFER_IDX,
-            .buffer = webgpu_buffer(flushUniformBufferRing()),
-            .offset = desc.flushUniformDataOffsetInBytes,
-        },
-        {
-            .binding = IMAGE_DRAW_UNIFORM_BUFFER_IDX,
-            .buffer = webgpu_buffer(imageDrawUniformBufferRing()),
-            .size = sizeof(pls::ImageDrawUniforms),
-        },
-    };
-
-    wgpu::BindGroupDescriptor perFlushBindGroupDesc = {
-        .layout = m_drawBindGroupLayouts[PER_FLUSH_BINDINGS_SET],
-        .entryCount = std::size(perFlushBindingEntries),
-        .entries = perFlushBindingEntries,
-    };
-
-    wgpu::BindGroup perFlushBindings = m_device.CreateBindGroup(&perFlushBindGroupDesc);
-
-    // Execute the DrawList.
-    bool needsNewBindings = true;
-    for (const DrawBatch& batch : *desc.drawList)
+    // Render bundles can't contain the EXT_shader_pixel_local_storage toggles, and the Vulkan
+    // implementation's input attachments aren't expressible in a bundle's attachment formats.
+    if (m_contextOptions.disableRenderBundles ||
+        m_contextOptions.plsType != PixelLocalStorageType::none)
     {
-        if (batch.elementCount == 0)
-        {
-            continue;
-        }
-
-        DrawType drawType = batch.drawType;
-
-        // Bind the appropriate image texture, if any.
-        wgpu::TextureView imageTextureView = m_nullImagePaintTextureView;
-        if (auto imageTexture = static_cast<const PLSTextureWebGPUImpl*>(batch.imageTexture))
-        {
-            imageTextureView = imageTexture->textureView();
-            needsNewBindings = true;
-        }
-
-        if (needsNewBindings ||
-            // Image draws always re-bind because they update the dynamic offset to their uniforms.
-            drawType == DrawType::imageRect || drawType == DrawType::imageMesh)
+        encodeDrawList(drawPass, desc, renderTarget->framebufferFormat());
+    }
+    else
+    {
+        buildDrawBundleKey(desc, renderTarget->framebufferFormat());
+        auto it = std::find_if(m_drawBundles.begin(),
+                               m_drawBundles.end(),
+                               [this](const CachedDrawBundle& cached) {
+                                   return cached.key == m_drawBundleKey;
+                               });
+        if (it == m_drawBundles.end())
         {
-            drawPass.SetBindGroup(PER_FLUSH_BINDINGS_SET,
-                                  perFlushBindings,
-                                  1,
-                                  &batch.imageDrawDataOffset);
-
-            wgpu::BindGroupEntry perDrawBindingEntries[] = {
-                {
-                    .binding = IMAGE_TEXTURE_IDX,
-                    .textureView = imageTextureView,
-                },
+            // Record a new bundle with the same attachment formats as makePLSRenderPass().
+            wgpu::TextureFormat colorFormats[4] = {
+                renderTarget->framebufferFormat(), // framebuffer
+                wgpu::TextureFormat::R32Uint,      // coverage
+                wgpu::TextureFormat::R32Uint,      // clip
+                renderTarget->framebufferFormat(), // scratchColor
             };
-
-            wgpu::BindGroupDescriptor perDrawBindGroupDesc = {
-                .layout = m_drawBindGroupLayouts[PER_DRAW_BINDINGS_SET],
-                .entryCount = std::size(perDrawBindingEntries),
-                .entries = perDrawBindingEntries,
+            wgpu::RenderBundleEncoderDescriptor bundleEncoderDesc = {
+                .colorFormatCount = std::size(colorFormats),
+                .colorFormats = colorFormats,
             };
-
-            wgpu::BindGroup perDrawBindings = m_device.CreateBindGroup(&perDrawBindGroupDesc);
-            drawPass.SetBindGroup(PER_DRAW_BINDINGS_SET, perDrawBindings, 0, nullptr);
-        }
-
-        // Setup the pipeline for this specific drawType and shaderFeatures.
-        const DrawPipeline& drawPipeline =
-            m_drawPipelines
-                .try_emplace(pls::ShaderUniqueKey(drawType,
-                                                  batch.shaderFeatures,
-                                                  pls::InterlockMode::rasterOrdering,
-                                                  pls::ShaderMiscFlags::none),
-                             this,
-                             drawType,
-                             batch.shaderFeatures,
-                             m_contextOptions)
-                .first->second;
-        drawPass.SetPipeline(drawPipeline.renderPipeline(renderTarget->framebufferFormat()));
-
-        switch (drawType)
-        {
-            case DrawType::midpointFanPatches:
-            case DrawType::outerCurvePatches:
+            wgpu::RenderBundleEncoder bundleEncoder =
+                m_device.CreateRenderBundleEncoder(&bundleEncoderDesc);
+            encodeDrawList(bundleEncoder, desc, renderTarget->framebufferFormat());
+            if (m_drawBundles.size() >= kMaxCachedDrawBundles)
             {
-                // Draw PLS patches that connect the tessellation vertices.
-                drawPass.SetVertexBuffer(0, m_pathPatchVertexBuffer);
-                drawPass.SetIndexBuffer(m_pathPatchIndexBuffer, wgpu::IndexFormat::Uint16);
-                drawPass.DrawIndexed(pls::PatchIndexCount(drawType),
-                                     batch.elementCount,
-                                     pls::PatchBaseIndex(drawType),
-                                     0,
-                                     batch.baseElement);
-                break;
-            }
-            case DrawType::interiorTriangulation:
-            {
-                drawPass.SetVertexBuffer(0, webgpu_buffer(triangleBufferRing()));
-                drawPass.Draw(batch.elementCount, 1, batch.baseElement);
-                break;
-            }
-            case DrawType::imageRect:
-                RIVE_UNREACHABLE();
-            case DrawType::imageMesh:
-            {
-                auto vertexBuffer = static_cast<const RenderBufferWebGPUImpl*>(batch.vertexBuffer);
-                auto uvBuffer = static_cast<const RenderBufferWebGPUImpl*>(batch.uvBuffer);
-                auto indexBuffer = static_cast<const RenderBufferWebGPUImpl*>(batch.indexBuffer);
-                drawPass.SetVertexBuffer(0, vertexBuffer->submittedBuffer());
-                drawPass.SetVertexBuffer(1, uvBuffer->submittedBuffer());
-                drawPass.SetIndexBuffer(indexBuffer->submittedBuffer(), wgpu::IndexFormat::Uint16);
-                drawPass.DrawIndexed(batch.elementCount, 1, batch.baseElement);
-                break;
+                m_drawBundles.pop_back();
             }
-            case DrawType::plsAtomicInitialize:
-            case DrawType::plsAtomicResolve:
-            case DrawType::stencilClipReset:
-                RIVE_UNREACHABLE();
+            m_drawBundles.insert(m_drawBundles.begin(),
+                                 {m_drawBundleKey, bundleEncoder.Finish()});
+        }
+        else if (it != m_drawBundles.begin())
+        {
+            // Move to the front so looping content keeps its bundles resident.
+            std::rotate(m_drawBundles.begin(), it, it + 1);
         }
+        drawPass.ExecuteBundles(1, &m_drawBundles.front().bundle);
     }
 
     if (m_contextOptions.plsType == PixelLocalStorageType::EXT_shader_pixel_local_storage)
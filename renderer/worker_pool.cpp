@@ -0,0 +1,105 @@
+/*
+ * Copyright 2024 Rive
+ */
+
+#include "rive/pls/worker_pool.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace rive::pls
+{
+WorkerPool::WorkerPool(size_t threadCount)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    m_workers.reserve(threadCount - 1);
+    for (size_t threadIdx = 1; threadIdx < threadCount; ++threadIdx)
+    {
+        m_workers.emplace_back(&WorkerPool::workerMain, this, threadIdx);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_shouldQuit = true;
+    }
+    m_jobPostedCondition.notify_all();
+    for (std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+void WorkerPool::parallelFor(size_t count,
+                             const std::function<void(size_t threadIdx, size_t i)>& fn)
+{
+    if (m_workers.empty() || count <= 1)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            fn(0, i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+        assert(m_busyWorkerCount == 0);
+        m_jobFn = &fn;
+        m_jobCount = count;
+        m_nextJobIdx.store(0, std::memory_order_relaxed);
+        m_busyWorkerCount = m_workers.size();
+        ++m_jobID;
+    }
+    m_jobPostedCondition.notify_all();
+
+    runJob(0);
+
+    std::unique_lock lock(m_mutex);
+    while (m_busyWorkerCount != 0)
+    {
+        m_jobFinishedCondition.wait(lock);
+    }
+    m_jobFn = nullptr;
+}
+
+void WorkerPool::workerMain(size_t threadIdx)
+{
+    uint64_t lastJobID = 0;
+    std::unique_lock lock(m_mutex);
+    for (;;)
+    {
+        while (m_jobID == lastJobID && !m_shouldQuit)
+        {
+            m_jobPostedCondition.wait(lock);
+        }
+        if (m_shouldQuit)
+        {
+            return;
+        }
+        lastJobID = m_jobID;
+
+        lock.unlock();
+        runJob(threadIdx);
+        lock.lock();
+
+        if (--m_busyWorkerCount == 0)
+        {
+            m_jobFinishedCondition.notify_one();
+        }
+    }
+}
+
+void WorkerPool::runJob(size_t threadIdx)
+{
+    for (size_t i; (i = m_nextJobIdx.fetch_add(1, std::memory_order_relaxed)) < m_jobCount;)
+    {
+        (*m_jobFn)(threadIdx, i);
+    }
+}
+} // namespace rive::pls
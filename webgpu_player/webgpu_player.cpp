@@ -13,6 +13,7 @@
 #include "rive/pls/pls_renderer.hpp"
 #include "rive/pls/webgpu/pls_render_context_webgpu_impl.hpp"
 #include "rive/pls/webgpu/em_js_handle.hpp"
+#include "rive/pls/worker_pool.hpp"
 
 #include <cmath>
 #include <iterator>
@@ -37,6 +38,10 @@ using PixelLocalStorageType = PLSRenderContextWebGPUImpl::PixelLocalStorageType;
 static std::unique_ptr<PLSRenderContext> s_plsContext;
 static rcp<PLSRenderTargetWebGPU> s_renderTarget;
 static std::unique_ptr<Renderer> s_renderer;
+#ifdef RIVE_WASM_THREADS
+// Writes the GPU buffers of a frame's logical flushes in parallel, on Web Workers.
+static std::unique_ptr<pls::WorkerPool> s_workerPool;
+#endif
 
 void riveInitPlayer(int w,
                     int h,
@@ -57,6 +62,19 @@ void riveInitPlayer(int w,
         w,
         h);
     s_renderer = std::make_unique<PLSRenderer>(s_plsContext.get());
+#ifdef RIVE_WASM_THREADS
+    s_workerPool = std::make_unique<pls::WorkerPool>();
+    s_plsContext->setRecordingThreadCount(s_workerPool->threadCount());
+#endif
+}
+
+static void flushPLSContext()
+{
+    PLSRenderContext::FlushResources flushResources = {.renderTarget = s_renderTarget.get()};
+#ifdef RIVE_WASM_THREADS
+    flushResources.parallelFor = s_workerPool->parallelForFn();
+#endif
+    s_plsContext->flush(flushResources);
 }
 
 #ifdef RIVE_WEBGPU
@@ -114,7 +132,7 @@ extern "C"
     void EMSCRIPTEN_KEEPALIVE RiveFlushRendering()
     {
         s_renderer->restore();
-        s_plsContext->flush({.renderTarget = s_renderTarget.get()});
+        flushPLSContext();
         s_textureViewHandle = EmJsHandle();
     }
 
@@ -551,7 +569,7 @@ int main(int argc, const char** argv)
         scene->draw(s_renderer.get());
         s_renderer->restore();
 
-        s_plsContext->flush({.renderTarget = s_renderTarget.get()});
+        flushPLSContext();
         s_swapchain.Present();
         device.Tick();
         glfwPollEvents();